@@ -0,0 +1,31 @@
+# CMake module to search for libnghttp2
+#
+# If it's found it sets nghttp2_FOUND to TRUE
+# and following variables are set:
+# nghttp2_INCLUDE_DIRS
+# nghttp2_LIBRARIES
+find_path(nghttp2_INCLUDE_DIR
+  nghttp2/nghttp2.h
+  PATHS
+  /usr/include
+  /usr/local/include)
+find_library(nghttp2_LIBRARY NAMES nghttp2 libnghttp2 PATHS
+  /usr/local/lib
+  /usr/lib)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(nghttp2 DEFAULT_MSG nghttp2_LIBRARY nghttp2_INCLUDE_DIR)
+
+mark_as_advanced(nghttp2_LIBRARY nghttp2_INCLUDE_DIR)
+
+if(nghttp2_FOUND)
+  set(nghttp2_INCLUDE_DIRS "${nghttp2_INCLUDE_DIR}")
+  set(nghttp2_LIBRARIES "${nghttp2_LIBRARY}")
+  if(NOT TARGET nghttp2::nghttp2)
+    add_library(nghttp2::nghttp2 UNKNOWN IMPORTED)
+  endif()
+  set_target_properties(nghttp2::nghttp2 PROPERTIES
+    INTERFACE_INCLUDE_DIRECTORIES "${nghttp2_INCLUDE_DIRS}"
+    IMPORTED_LINK_INTERFACE_LANGUAGES "C"
+    IMPORTED_LOCATION "${nghttp2_LIBRARIES}")
+endif()
@@ -89,7 +89,11 @@ KernelDevice::KernelDevice(CephContext* cct, aio_callback_t cb, void *cbpriv, ai
   if (use_ioring && ioring_queue_t::supported()) {
     bool use_ioring_hipri = cct->_conf.get_val<bool>("bdev_ioring_hipri");
     bool use_ioring_sqthread_poll = cct->_conf.get_val<bool>("bdev_ioring_sqthread_poll");
-    io_queue = std::make_unique<ioring_queue_t>(iodepth, use_ioring_hipri, use_ioring_sqthread_poll);
+    io_queue = std::make_unique<ioring_queue_t>(
+      iodepth, use_ioring_hipri, use_ioring_sqthread_poll,
+      cct->_conf.get_val<int64_t>("bdev_ioring_sqthread_cpu"),
+      cct->_conf.get_val<uint64_t>("bdev_ioring_fixed_buffers"),
+      cct->_conf.get_val<Option::size_t>("bdev_ioring_fixed_buffer_size"));
   } else {
     static bool once;
     if (use_ioring && !once) {
@@ -1376,6 +1380,14 @@ ceph::unique_leakable_ptr<buffer::raw> KernelDevice::create_custom_aligned(
   if (len < CEPH_PAGE_SIZE) {
     return ceph::buffer::create_small_page_aligned(len);
   } else {
+    if (aio && dio) {
+      // buffers registered with io_uring avoid per-io page pinning
+      if (auto fixed_raw = io_queue->create_fixed_buffer(len); fixed_raw) {
+	dout(20) << __func__ << " allocated from io queue fixed buffers"
+		 << dendl;
+	return fixed_raw;
+      }
+    }
     static HugePagePoolOfPools hp_pools = HugePagePoolOfPools::from_desc(
       cct->_conf.get_val<std::string>("bdev_read_preallocated_huge_buffers")
     );
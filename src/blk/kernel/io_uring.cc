@@ -7,17 +7,94 @@
 
 #include "liburing.h"
 #include <sys/epoll.h>
+#include <sys/mman.h>
 #include <map>
 
+#include <boost/lockfree/queue.hpp>
+
+#include "include/buffer_raw.h"
+
 using std::list;
 using std::make_unique;
 
+/*
+ * A single mmap()ed region carved into equally sized buffers, each one
+ * registered with the ring as its own iovec so that I/O on them can use
+ * IORING_OP_{READ,WRITE}_FIXED and skip the per-I/O page pinning.
+ */
+struct ioring_fixed_buffers {
+  char *region = nullptr;
+  const size_t buffer_size;
+  const unsigned nbuffers;
+  boost::lockfree::queue<unsigned> free_q;
+
+  struct fixed_buffer_raw : public ceph::buffer::raw {
+    std::shared_ptr<ioring_fixed_buffers> parent;
+    const unsigned index;
+
+    fixed_buffer_raw(std::shared_ptr<ioring_fixed_buffers> p, unsigned i,
+		     unsigned len)
+      : raw(p->region + i * p->buffer_size, len),
+	parent(std::move(p)), index(i) {
+    }
+    ~fixed_buffer_raw() override {
+      // memory belongs to the region; recycle the slot instead
+      parent->free_q.push(index);
+    }
+  };
+
+  ioring_fixed_buffers(size_t buffer_size, unsigned nbuffers)
+    : buffer_size(buffer_size), nbuffers(nbuffers), free_q(nbuffers) {
+  }
+  ~ioring_fixed_buffers() {
+    if (region) {
+      ::munmap(region, buffer_size * nbuffers);
+    }
+  }
+
+  int init() {
+    void *p = ::mmap(nullptr, buffer_size * nbuffers, PROT_READ | PROT_WRITE,
+		     MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (p == MAP_FAILED) {
+      return -errno;
+    }
+    region = static_cast<char*>(p);
+    for (unsigned i = 0; i < nbuffers; ++i) {
+      free_q.push(i);
+    }
+    return 0;
+  }
+
+  std::vector<struct iovec> get_iovecs() const {
+    std::vector<struct iovec> iovs(nbuffers);
+    for (unsigned i = 0; i < nbuffers; ++i) {
+      iovs[i].iov_base = region + i * buffer_size;
+      iovs[i].iov_len = buffer_size;
+    }
+    return iovs;
+  }
+
+  /// registered buffer index covering the iovec, or -1
+  int find(const struct iovec& iov) const {
+    const char *base = static_cast<const char*>(iov.iov_base);
+    if (base < region || base >= region + buffer_size * nbuffers) {
+      return -1;
+    }
+    size_t index = (base - region) / buffer_size;
+    if (base + iov.iov_len > region + (index + 1) * buffer_size) {
+      return -1;
+    }
+    return index;
+  }
+};
+
 struct ioring_data {
   struct io_uring io_uring;
   pthread_mutex_t cq_mutex;
   pthread_mutex_t sq_mutex;
   int epoll_fd = -1;
   std::map<int, int> fixed_fds_map;
+  std::shared_ptr<ioring_fixed_buffers> fixed_buffers;
 };
 
 static int ioring_get_cqe(struct ioring_data *d, unsigned int max,
@@ -58,7 +135,18 @@ static void init_sqe(struct ioring_data *d, struct io_uring_sqe *sqe,
 
   ceph_assert(fixed_fd != -1);
 
-  if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV)
+  int buf_index = -1;
+  if (d->fixed_buffers && io->iov.size() == 1) {
+    buf_index = d->fixed_buffers->find(io->iov[0]);
+  }
+
+  if (buf_index >= 0 && io->iocb.aio_lio_opcode == IO_CMD_PWRITEV)
+    io_uring_prep_write_fixed(sqe, fixed_fd, io->iov[0].iov_base,
+			      io->iov[0].iov_len, io->offset, buf_index);
+  else if (buf_index >= 0 && io->iocb.aio_lio_opcode == IO_CMD_PREADV)
+    io_uring_prep_read_fixed(sqe, fixed_fd, io->iov[0].iov_base,
+			     io->iov[0].iov_len, io->offset, buf_index);
+  else if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV)
     io_uring_prep_writev(sqe, fixed_fd, &io->iov[0],
 			 io->iov.size(), io->offset);
   else if (io->iocb.aio_lio_opcode == IO_CMD_PREADV)
@@ -107,11 +195,17 @@ static void build_fixed_fds_map(struct ioring_data *d,
   }
 }
 
-ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_) :
+ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_,
+			       int sq_thread_cpu_,
+			       unsigned fixed_buffers_,
+			       size_t fixed_buffer_size_) :
   d(make_unique<ioring_data>()),
   iodepth(iodepth_),
   hipri(hipri_),
-  sq_thread(sq_thread_)
+  sq_thread(sq_thread_),
+  sq_thread_cpu(sq_thread_cpu_),
+  fixed_buffers(fixed_buffers_),
+  fixed_buffer_size(fixed_buffer_size_)
 {
 }
 
@@ -121,17 +215,22 @@ ioring_queue_t::~ioring_queue_t()
 
 int ioring_queue_t::init(std::vector<int> &fds)
 {
-  unsigned flags = 0;
+  struct io_uring_params params = {};
 
   pthread_mutex_init(&d->cq_mutex, NULL);
   pthread_mutex_init(&d->sq_mutex, NULL);
 
   if (hipri)
-    flags |= IORING_SETUP_IOPOLL;
-  if (sq_thread)
-    flags |= IORING_SETUP_SQPOLL;
+    params.flags |= IORING_SETUP_IOPOLL;
+  if (sq_thread) {
+    params.flags |= IORING_SETUP_SQPOLL;
+    if (sq_thread_cpu >= 0) {
+      params.flags |= IORING_SETUP_SQ_AFF;
+      params.sq_thread_cpu = sq_thread_cpu;
+    }
+  }
 
-  int ret = io_uring_queue_init(iodepth, &d->io_uring, flags);
+  int ret = io_uring_queue_init_params(iodepth, &d->io_uring, &params);
   if (ret < 0)
     return ret;
 
@@ -144,6 +243,20 @@ int ioring_queue_t::init(std::vector<int> &fds)
 
   build_fixed_fds_map(d.get(), fds);
 
+  if (fixed_buffers && fixed_buffer_size) {
+    auto bufs = std::make_shared<ioring_fixed_buffers>(fixed_buffer_size,
+						       fixed_buffers);
+    if (bufs->init() == 0) {
+      auto iovs = bufs->get_iovecs();
+      // failure (e.g. RLIMIT_MEMLOCK too low) is not fatal: we simply
+      // keep using regular readv/writev
+      if (io_uring_register_buffers(&d->io_uring, iovs.data(),
+				    iovs.size()) == 0) {
+	d->fixed_buffers = std::move(bufs);
+      }
+    }
+  }
+
   d->epoll_fd = epoll_create1(0);
   if (d->epoll_fd < 0) {
     ret = -errno;
@@ -163,6 +276,10 @@ int ioring_queue_t::init(std::vector<int> &fds)
 close_epoll_fd:
   close(d->epoll_fd);
 unregister_files:
+  if (d->fixed_buffers) {
+    io_uring_unregister_buffers(&d->io_uring);
+    d->fixed_buffers.reset();
+  }
   io_uring_unregister_files(&d->io_uring);
 close_ring_fd:
   io_uring_queue_exit(&d->io_uring);
@@ -175,6 +292,11 @@ void ioring_queue_t::shutdown()
   d->fixed_fds_map.clear();
   close(d->epoll_fd);
   d->epoll_fd = -1;
+  if (d->fixed_buffers) {
+    io_uring_unregister_buffers(&d->io_uring);
+    // outstanding buffers keep the region alive until they're released
+    d->fixed_buffers.reset();
+  }
   io_uring_unregister_files(&d->io_uring);
   io_uring_queue_exit(&d->io_uring);
 }
@@ -212,6 +334,21 @@ get_cqe:
   return events;
 }
 
+ceph::unique_leakable_ptr<ceph::buffer::raw>
+ioring_queue_t::create_fixed_buffer(size_t len)
+{
+  auto& bufs = d->fixed_buffers;
+  if (!bufs || len > bufs->buffer_size) {
+    return nullptr;
+  }
+  unsigned index;
+  if (!bufs->free_q.pop(index)) {
+    return nullptr;
+  }
+  return ceph::unique_leakable_ptr<ceph::buffer::raw>{
+    new ioring_fixed_buffers::fixed_buffer_raw(bufs, index, len)};
+}
+
 bool ioring_queue_t::supported()
 {
   struct io_uring ring;
@@ -227,7 +364,10 @@ bool ioring_queue_t::supported()
 
 struct ioring_data {};
 
-ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_)
+ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_,
+			       int sq_thread_cpu_,
+			       unsigned fixed_buffers_,
+			       size_t fixed_buffer_size_)
 {
   ceph_assert(0);
 }
@@ -259,6 +399,12 @@ int ioring_queue_t::get_next_completed(int timeout_ms, aio_t **paio, int max)
   ceph_assert(0);
 }
 
+ceph::unique_leakable_ptr<ceph::buffer::raw>
+ioring_queue_t::create_fixed_buffer(size_t len)
+{
+  ceph_assert(0);
+}
+
 bool ioring_queue_t::supported()
 {
   return false;
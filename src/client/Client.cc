@@ -683,6 +683,13 @@ void Client::_finish_init()
     plb.add_time(l_c_wr_avg, "writeavg", "Average latency for processing write requests");
     plb.add_u64(l_c_wr_sqsum, "writesqsum", "Sum of squares ((to calculate variability/stdev) for write requests");
     plb.add_u64(l_c_wr_ops, "wrops", "Total write IO operations");
+    plb.add_u64_counter(l_c_ra_strided, "readahead_strided",
+                        "Strided readahead reads started");
+    plb.add_u64_counter(l_c_ra_strided_hit, "readahead_strided_hit",
+                        "Reads prefetched by strided readahead");
+    plb.add_u64_counter(l_c_ra_strided_wasted, "readahead_strided_wasted",
+                        "Bytes prefetched by strided readahead and never read",
+                        NULL, 0, unit_t(UNIT_BYTES));
     logger.reset(plb.create_perf_counters());
     cct->get_perfcounters_collection()->add(logger.get());
   }
@@ -1465,6 +1472,22 @@ void Client::clear_dir_complete_and_ordered(Inode *diri, bool complete)
   }
 }
 
+void Client::invalidate_frag_cache(Dir *dir, const std::string& name)
+{
+  if (dir->frag_cache.empty())
+    return;
+  unsigned hash = ceph_frag_value(dir->parent_inode->hash_dentry_name(name));
+  for (auto p = dir->frag_cache.begin(); p != dir->frag_cache.end(); ) {
+    if (p->first.contains(hash)) {
+      ldout(cct, 15) << __func__ << " '" << name << "' drops frag " << p->first
+		     << " of " << *dir->parent_inode << dendl;
+      p = dir->frag_cache.erase(p);
+    } else {
+      ++p;
+    }
+  }
+}
+
 /*
  * insert results from readdir or lssnap into the metadata cache.
  */
@@ -1530,6 +1553,27 @@ void Client::insert_readdir_results(MetaRequest *request, MetaSession *session,
     string readdir_start = dirp->last_name;
     ceph_assert(!readdir_start.empty() || readdir_offset == 2);
 
+    // keep whole frags for readdir, if this reply starts or continues a pass
+    // over frag fg
+    std::optional<Dir::frag_cache_t> frag_fill;
+    if (request->head.op == CEPH_MDS_OP_READDIR && fg == dst.frag &&
+	cct->_conf.get_val<bool>("client_readdir_frag_cache")) {
+      auto it = dir->frag_cache.find(fg);
+      if (dirp->at_frag_start(fg)) {
+	frag_fill.emplace();
+	frag_fill->shared_gen = diri->shared_gen;
+      } else if (it != dir->frag_cache.end() &&
+		 !it->second.complete &&
+		 !it->second.dentries.empty() &&
+		 it->second.dentries.back()->name == readdir_start &&
+		 it->second.shared_gen == diri->shared_gen) {
+	frag_fill = std::move(it->second);
+      }
+      // out of the map while its dentries are linked below
+      if (it != dir->frag_cache.end())
+	dir->frag_cache.erase(it);
+    }
+
     unsigned last_hash = 0;
     if (hash_order) {
       if (!readdir_start.empty()) {
@@ -1640,6 +1684,8 @@ void Client::insert_readdir_results(MetaRequest *request, MetaSession *session,
 	}
 	dirp->cache_index++;
       }
+      if (frag_fill)
+	frag_fill->dentries.push_back(dn);
       // add to cached result list
       dirp->buffer.push_back(dir_result_t::dentry(dn->offset, dname, dn->alternate_name, in));
       ldout(cct, 15) << __func__ << "  " << hex << dn->offset << dec << ": '" << dname << "' -> " << in->ino << dendl;
@@ -1652,6 +1698,14 @@ void Client::insert_readdir_results(MetaRequest *request, MetaSession *session,
     else
       dirp->next_offset = readdir_offset;
 
+    if (frag_fill && diri->shared_gen == frag_fill->shared_gen) {
+      frag_fill->complete = end;
+      ldout(cct, 15) << __func__ << " frag " << fg << " cached "
+		     << frag_fill->dentries.size() << " dentries, complete="
+		     << frag_fill->complete << dendl;
+      dir->frag_cache[fg] = std::move(*frag_fill);
+    }
+
     if (dir->is_empty())
       close_dir(dir);
     if (dir_other && dir_other->is_empty())
@@ -1687,6 +1741,7 @@ Inode* Client::insert_trace(MetaRequest *request, MetaSession *session)
     if (d) {
       Inode *diri = d->dir->parent_inode;
       clear_dir_complete_and_ordered(diri, true);
+      invalidate_frag_cache(d->dir, d->name);
     }
 
     if (d && reply->get_result() == 0) {
@@ -3681,6 +3736,7 @@ Dentry* Client::link(Dir *dir, const string& name, Inode *in, Dentry *dn)
   }
 
   if (in) {    // link to inode
+    invalidate_frag_cache(dir, name);
     InodeRef tmp_ref;
     // only one parent for directories!
     if (in->is_dir() && !in->dentries.empty()) {
@@ -3706,6 +3762,8 @@ void Client::unlink(Dentry *dn, bool keepdir, bool keepdentry)
   ldout(cct, 15) << "unlink dir " << dn->dir->parent_inode << " '" << dn->name << "' dn " << dn
 		 << " inode " << dn->inode << dendl;
 
+  invalidate_frag_cache(dn->dir, dn->name);
+
   // unlink from inode
   if (dn->inode) {
     dn->unlink();
@@ -3930,7 +3988,8 @@ int Client::get_caps_used(Inode *in)
 {
   unsigned used = in->caps_used();
   if (!(used & CEPH_CAP_FILE_CACHE) &&
-      !objectcacher->set_is_empty(&in->oset))
+      (!objectcacher->set_is_empty(&in->oset) ||
+       in->small_file_data.length()))
     used |= CEPH_CAP_FILE_CACHE;
   return used;
 }
@@ -4509,10 +4568,18 @@ void Client::_schedule_invalidate_callback(Inode *in, int64_t off, int64_t len)
     async_ino_invalidator.queue(new C_Client_CacheInvalidate(this, in, off, len));
 }
 
+void Client::_drop_small_file_data(Inode *in)
+{
+  in->small_file_data.clear();
+  ++in->small_file_gen;
+}
+
 void Client::_invalidate_inode_cache(Inode *in)
 {
   ldout(cct, 10) << __func__ << " " << *in << dendl;
 
+  _drop_small_file_data(in);
+
   // invalidate our userspace inode cache
   if (cct->_conf->client_oc) {
     objectcacher->release_set(&in->oset);
@@ -4527,6 +4594,8 @@ void Client::_invalidate_inode_cache(Inode *in, int64_t off, int64_t len)
 {
   ldout(cct, 10) << __func__ << " " << *in << " " << off << "~" << len << dendl;
 
+  _drop_small_file_data(in);
+
   // invalidate our userspace inode cache
   if (cct->_conf->client_oc) {
     vector<ObjectExtent> ls;
@@ -4619,8 +4688,11 @@ void Client::check_cap_issue(Inode *in, unsigned issued)
       (had & CEPH_CAP_FILE_SHARED)) {
     if (issued & CEPH_CAP_FILE_SHARED)
       in->shared_gen++;
-    if (in->is_dir())
+    if (in->is_dir()) {
       clear_dir_complete_and_ordered(in, true);
+      if (in->dir)
+	in->dir->frag_cache.clear();
+    }
   }
 }
 
@@ -9482,6 +9554,60 @@ void Client::_readdir_rechoose_frag(dir_result_t *dirp)
   }
 }
 
+/*
+ * fill the dirp buffer with the next frag from the frag cache of the dir,
+ * if we have all of it. the dentries are checked as the buffer is returned,
+ * like those of the readdir cache.
+ */
+bool Client::_readdir_get_cached_frag(dir_result_t *dirp)
+{
+  InodeRef& diri = dirp->inode;
+  Dir *dir = diri->dir;
+  if (!dir || diri->snapid == CEPH_SNAPDIR ||
+      !diri->caps_issued_mask(CEPH_CAP_FILE_SHARED, true))
+    return false;
+
+  frag_t fg;
+  if (dirp->hash_order())
+    fg = diri->dirfragtree[dirp->offset_high()];
+  else
+    fg = frag_t(dirp->offset_high());
+  if (!dirp->at_frag_start(fg))
+    return false;
+
+  auto it = dir->frag_cache.find(fg);
+  if (it == dir->frag_cache.end())
+    return false;
+  auto& fc = it->second;
+  if (!fc.complete || fc.shared_gen != diri->shared_gen ||
+      diri->dirfragtree[fg.value()] != fg) {
+    return false;
+  }
+
+  _readdir_drop_dirp_buffer(dirp);
+  dirp->buffer.reserve(fc.dentries.size());
+  for (Dentry *dn : fc.dentries) {
+    if (!dn->inode) {
+      ldout(cct, 10) << __func__ << " frag " << fg << " has null dentry '"
+		     << dn->name << "', dropping it" << dendl;
+      dir->frag_cache.erase(it);
+      _readdir_drop_dirp_buffer(dirp);
+      return false;
+    }
+    dirp->buffer.push_back(dir_result_t::dentry(dn->offset, dn->name,
+						dn->alternate_name, dn->inode));
+  }
+  ldout(cct, 10) << __func__ << " " << dirp << " frag " << fg << " has "
+		 << dirp->buffer.size() << " cached dentries" << dendl;
+
+  dirp->buffer_frag = fg;
+  dirp->next_offset = 2;
+  if (!fc.dentries.empty())
+    dirp->last_name = fc.dentries.back()->name;
+  dirp->release_count = 0; // the readdir cache missed these
+  return true;
+}
+
 void Client::_readdir_drop_dirp_buffer(dir_result_t *dirp)
 {
   ldout(cct, 10) << __func__ << " " << dirp << dendl;
@@ -9795,7 +9921,8 @@ int Client::_readdir_r_cb(int op,
       return 0;
 
     bool check_caps = true;
-    if (!dirp->is_cached()) {
+    if (!dirp->is_cached() &&
+	(bypass_cache || !_readdir_get_cached_frag(dirp))) {
       int r = _readdir_get_frag(op, dirp, fill_cb);
       if (r)
 	return r;
@@ -10560,6 +10687,9 @@ Fh *Client::_create_fh(Inode *in, int flags, int cmode, const UserPerm& perms)
   alignments.push_back(in->layout.get_period());
   alignments.push_back(in->layout.stripe_unit);
   f->readahead.set_alignments(alignments);
+  f->strided_readahead.set_max_streams(
+    conf.get_val<uint64_t>("client_readahead_strided_streams"));
+  f->strided_readahead.set_max_readahead_size(max_readahead);
 
   return f;
 }
@@ -11132,6 +11262,9 @@ int64_t Client::_read(Fh *f, int64_t offset, uint64_t size, bufferlist *bl,
   utime_t lat;
   utime_t start = mono_clock_now();
   CRF_iofinish *crf_iofinish = nullptr;
+  const uint64_t small_file_max =
+    cct->_conf.get_val<Option::size_t>("client_small_file_cache_size");
+  uint64_t small_file_gen = 0;
 
   if ((f->mode & CEPH_FILE_MODE_RD) == 0)
     return -EBADF;
@@ -11168,6 +11301,25 @@ retry:
   if (f->flags & O_DIRECT)
     have &= ~(CEPH_CAP_FILE_CACHE | CEPH_CAP_FILE_LAZYIO);
 
+  if (in->small_file_data.length()) {
+    if (!(have & CEPH_CAP_FILE_CACHE) ||
+	in->small_file_data.length() != in->size) {
+      _drop_small_file_data(in);
+    } else {
+      uint64_t endoff = std::min<uint64_t>(offset + size, in->size);
+      if ((uint64_t)offset < endoff) {
+	bl->substr_of(in->small_file_data, offset, endoff - offset);
+	rc = endoff - offset;
+      } else {
+	rc = 0;
+      }
+      ldout(cct, 10) << __func__ << " " << *in << " " << offset << "~" << size
+		     << " from small file cache = " << rc << dendl;
+      goto success;
+    }
+  }
+  small_file_gen = in->small_file_gen;
+
   if (in->inline_version < CEPH_INLINE_NONE) {
     uint32_t len = in->inline_data.length();
     uint64_t endoff = offset + size;
@@ -11307,6 +11459,15 @@ retry:
     }
   }
 
+  // keep a small file that was read whole, unless it changed meanwhile
+  if (start_pos == 0 && (uint64_t)rc == in->size && in->size > 0 &&
+      in->size <= small_file_max && bl->length() == in->size &&
+      (have & CEPH_CAP_FILE_CACHE) && in->small_file_gen == small_file_gen &&
+      in->inline_version == CEPH_INLINE_NONE && !in->is_fscrypt_enabled()) {
+    in->small_file_data = *bl;
+    in->small_file_data.rebuild();
+  }
+
 success:
   ceph_assert(rc >= 0);
   update_read_io_size(bl->length());
@@ -11354,24 +11515,39 @@ void Client::C_Readahead::finish(int r) {
 
 void Client::do_readahead(Fh *f, Inode *in, uint64_t off, uint64_t len)
 {
+  auto start_readahead = [&](const pair<uint64_t, uint64_t>& readahead_extent) {
+    ldout(cct, 20) << "readahead " << readahead_extent.first << "~" << readahead_extent.second
+		   << " (caller wants " << off << "~" << len << ")" << dendl;
+    Context *onfinish2 = new C_Readahead(this, f);
+    int r2 = objectcacher->file_read(&in->oset, &in->layout, in->snapid,
+				     readahead_extent.first, readahead_extent.second,
+				     NULL, 0, onfinish2);
+    if (r2 == 0) {
+      ldout(cct, 20) << "readahead initiated, c " << onfinish2 << dendl;
+      get_cap_ref(in, CEPH_CAP_FILE_RD | CEPH_CAP_FILE_CACHE);
+      return true;
+    }
+    ldout(cct, 20) << "readahead was no-op, already cached" << dendl;
+    delete onfinish2;
+    return false;
+  };
+
   if(f->readahead.get_min_readahead_size() > 0) {
     pair<uint64_t, uint64_t> readahead_extent = f->readahead.update(off, len, in->size);
     if (readahead_extent.second > 0) {
-      ldout(cct, 20) << "readahead " << readahead_extent.first << "~" << readahead_extent.second
-		     << " (caller wants " << off << "~" << len << ")" << dendl;
-      Context *onfinish2 = new C_Readahead(this, f);
-      int r2 = objectcacher->file_read(&in->oset, &in->layout, in->snapid,
-				       readahead_extent.first, readahead_extent.second,
-				       NULL, 0, onfinish2);
-      if (r2 == 0) {
-	ldout(cct, 20) << "readahead initiated, c " << onfinish2 << dendl;
-	get_cap_ref(in, CEPH_CAP_FILE_RD | CEPH_CAP_FILE_CACHE);
-      } else {
-	ldout(cct, 20) << "readahead was no-op, already cached" << dendl;
-	delete onfinish2;
-      }
+      start_readahead(readahead_extent);
     }
   }
+
+  // reads with a fixed stride, which the above doesn't see as sequential
+  uint64_t hits = f->strided_readahead.get_hits();
+  uint64_t wasted = f->strided_readahead.get_wasted_bytes();
+  for (const auto& readahead_extent : f->strided_readahead.update(off, len, in->size)) {
+    if (start_readahead(readahead_extent))
+      logger->inc(l_c_ra_strided);
+  }
+  logger->inc(l_c_ra_strided_hit, f->strided_readahead.get_hits() - hits);
+  logger->inc(l_c_ra_strided_wasted, f->strided_readahead.get_wasted_bytes() - wasted);
 }
 
 void Client::C_Read_Async_Finisher::finish(int r)
@@ -11535,11 +11711,19 @@ int Client::_read_sync(Fh *f, uint64_t off, uint64_t len, bufferlist *bl,
     bufferlist tbl;
 
     int wanted = left;
-    filer->read_trunc(in->ino, &in->layout, in->snapid,
+    // the read of each object goes out at once, and a read larger than the
+    // objecter's in-flight budget waits for it while submitting, so don't
+    // hold client_lock for that
+    file_layout_t layout = in->layout;
+    inodeno_t ino = in->ino;
+    snapid_t snapid = in->snapid;
+    uint64_t truncate_size = in->truncate_size;
+    __u32 truncate_seq = in->truncate_seq;
+    client_lock.unlock();
+    filer->read_trunc(ino, &layout, snapid,
 		      pos, left, &tbl, 0,
-		      in->truncate_size, in->truncate_seq,
+		      truncate_size, truncate_seq,
 		      &onfinish);
-    client_lock.unlock();
     int r = wait_and_copy(onfinish, tbl, wanted);
     client_lock.lock();
     if (!r)
@@ -11561,6 +11745,12 @@ int Client::write(int fd, const char *buf, loff_t size, loff_t offset)
   tout(cct) << size << std::endl;
   tout(cct) << offset << std::endl;
 
+  /* We can't return bytes written larger than INT_MAX, clamp size to that */
+  size = std::min(size, (loff_t)INT_MAX);
+  // copy the data before taking client_lock
+  bufferlist bl;
+  bl.append(buf, size);
+
   std::scoped_lock lock(client_lock);
   Fh *fh = get_filehandle(fd);
   if (!fh)
@@ -11569,10 +11759,6 @@ int Client::write(int fd, const char *buf, loff_t size, loff_t offset)
   if (fh->flags & O_PATH)
     return -EBADF;
 #endif
-  /* We can't return bytes written larger than INT_MAX, clamp size to that */
-  size = std::min(size, (loff_t)INT_MAX);
-  bufferlist bl;
-  bl.append(buf, size);
   int r = _write(fh, offset, size, std::move(bl));
   ldout(cct, 3) << "write(" << fd << ", \"...\", " << size << ", " << offset << ") = " << r << dendl;
   return r;
@@ -11608,30 +11794,25 @@ int64_t Client::_preadv_pwritev_locked(Fh *fh, const struct iovec *iov,
      * 32-bit signed integers. Clamp the I/O sizes in those functions so that
      * we don't do I/Os larger than the values we can return.
      */
-    bufferlist data;
     if (clamp_to_int) {
       totallen = std::min(totallen, (size_t)INT_MAX);
-      size_t total_appended = 0;
-      for (int i = 0; i < iovcnt; i++) {
-        if (iov[i].iov_len > 0) {
-          if (total_appended + iov[i].iov_len >= totallen) {
-            data.append((const char *)iov[i].iov_base, totallen - total_appended);
-            break;
-          } else {
-            data.append((const char *)iov[i].iov_base, iov[i].iov_len);
-            total_appended += iov[i].iov_len;
-          }
-        }
-      }
-    } else {
-      for (int i = 0; i < iovcnt; i++) {
-        data.append((const char *)iov[i].iov_base, iov[i].iov_len);
-      }
     }
 
     if (write) {
+        // copy the caller's buffers without client_lock, the ref keeps fh
+        bufferlist data;
+        fh->get();
+        client_lock.unlock();
+        size_t total_appended = 0;
+        for (int i = 0; i < iovcnt && total_appended < totallen; i++) {
+          size_t len = std::min(iov[i].iov_len, totallen - total_appended);
+          data.append((const char *)iov[i].iov_base, len);
+          total_appended += len;
+        }
+        client_lock.lock();
         int64_t w = _write(fh, offset, totallen, std::move(data), onfinish, do_fsync, syncdataonly);
         ldout(cct, 3) << "pwritev(" << fh << ", \"...\", " << totallen << ", " << offset << ") = " << w << dendl;
+        _put_fh(fh);
         return w;
     } else {
         bufferlist bl;
@@ -11907,6 +12088,8 @@ int64_t Client::_write(Fh *f, int64_t offset, uint64_t size, bufferlist bl,
   if (f->flags & O_DIRECT)
     have &= ~(CEPH_CAP_FILE_BUFFER | CEPH_CAP_FILE_LAZYIO);
 
+  _drop_small_file_data(in);
+
   ldout(cct, 10) << " snaprealm " << *in->snaprealm << dendl;
 
   std::unique_ptr<Context> iofinish = nullptr;
@@ -12046,12 +12229,12 @@ int64_t Client::_write(Fh *f, int64_t offset, uint64_t size, bufferlist bl,
     }
 
     ldout(cct, 10) << " _write_filer" << dendl;
-    filer->write_trunc(in->ino, &in->layout, in->snaprealm->get_snap_context(),
-		       offset, size, bl, ceph::real_clock::now(), 0,
-		       in->truncate_size, in->truncate_seq,
-		       filer_iofinish.get());
-
     if (onfinish) {
+      filer->write_trunc(in->ino, &in->layout, in->snaprealm->get_snap_context(),
+		         offset, size, bl, ceph::real_clock::now(), 0,
+		         in->truncate_size, in->truncate_seq,
+		         filer_iofinish.get());
+
       // handle non-blocking caller (onfinish != nullptr), we can now safely
       // release all the managed pointers
       filer_iofinish.release();
@@ -12064,7 +12247,20 @@ int64_t Client::_write(Fh *f, int64_t offset, uint64_t size, bufferlist bl,
       return 0;
     }
 
-    client_lock.unlock();
+    // like _read_sync(), submit without client_lock, the objecter may wait
+    // for in-flight budget before sending the writes of a large range
+    {
+      file_layout_t layout = in->layout;
+      SnapContext snapc = in->snaprealm->get_snap_context();
+      inodeno_t ino = in->ino;
+      uint64_t truncate_size = in->truncate_size;
+      __u32 truncate_seq = in->truncate_seq;
+      client_lock.unlock();
+      filer->write_trunc(ino, &layout, snapc,
+		         offset, size, bl, ceph::real_clock::now(), 0,
+		         truncate_size, truncate_seq,
+		         filer_iofinish.get());
+    }
     r = cond_iofinish->wait();
     client_lock.lock();
     put_cap_ref(in, CEPH_CAP_FILE_BUFFER);
@@ -16270,14 +16466,28 @@ int Client::ll_commit_blocks(Inode *in,
 }
 
 int Client::ll_write(Fh *fh, loff_t off, loff_t len, const char *data)
+{
+  /* We can't return bytes written larger than INT_MAX, clamp len to that */
+  len = std::min(len, (loff_t)INT_MAX);
+  // copy the data before taking client_lock
+  bufferlist bl;
+  bl.append(data, len);
+  return ll_write(fh, off, std::move(bl));
+}
+
+int Client::ll_write(Fh *fh, loff_t off, bufferlist&& bl)
 {
   RWRef_t mref_reader(mount_state, CLIENT_MOUNTING);
   if (!mref_reader.is_state_satisfied()) {
     return -ENOTCONN;
   }
 
-  /* We can't return bytes written larger than INT_MAX, clamp len to that */
-  len = std::min(len, (loff_t)INT_MAX);
+  if (bl.length() > INT_MAX) {
+    bufferlist head;
+    head.substr_of(bl, 0, INT_MAX);
+    bl = std::move(head);
+  }
+  loff_t len = bl.length();
 
   std::scoped_lock lock(client_lock);
   if (fh == NULL || !_ll_fh_exists(fh)) {
@@ -16292,8 +16502,6 @@ int Client::ll_write(Fh *fh, loff_t off, loff_t len, const char *data)
   tout(cct) << off << std::endl;
   tout(cct) << len << std::endl;
 
-  bufferlist bl;
-  bl.append(data, len);
   int r = _write(fh, off, len, std::move(bl));
   ldout(cct, 3) << "ll_write " << fh << " " << off << "~" << len << " = " << r
 		<< dendl;
@@ -97,6 +97,9 @@ enum {
   l_c_wr_avg,
   l_c_wr_sqsum,
   l_c_wr_ops,
+  l_c_ra_strided,
+  l_c_ra_strided_hit,
+  l_c_ra_strided_wasted,
   l_c_last,
 };
 
@@ -218,6 +221,15 @@ struct dir_result_t {
   void set_hash_order() { offset |= HASH; }
   bool hash_order() { return (offset & HASH) == HASH; }
 
+  // next entry is the first of frag fg
+  bool at_frag_start(frag_t fg) {
+    if (offset_low() != 2)
+      return false;
+    if (hash_order())
+      return offset_high() == fg.value();
+    return frag_t(offset_high()) == fg;
+  }
+
   bool is_cached() {
     if (buffer.empty())
       return false;
@@ -714,6 +726,7 @@ public:
 
   int ll_read(Fh *fh, loff_t off, loff_t len, bufferlist *bl);
   int ll_write(Fh *fh, loff_t off, loff_t len, const char *data);
+  int ll_write(Fh *fh, loff_t off, bufferlist&& bl);
   int64_t ll_readv(struct Fh *fh, const struct iovec *iov, int iovcnt, int64_t off);
   int64_t ll_writev(struct Fh *fh, const struct iovec *iov, int iovcnt, int64_t off);
   int64_t ll_preadv_pwritev(struct Fh *fh, const struct iovec *iov, int iovcnt,
@@ -862,6 +875,7 @@ public:
   void _try_to_trim_inode(Inode *in, bool sched_inval);
 
   void _schedule_invalidate_callback(Inode *in, int64_t off, int64_t len);
+  void _drop_small_file_data(Inode *in);
   void _invalidate_inode_cache(Inode *in);
   void _invalidate_inode_cache(Inode *in, int64_t off, int64_t len);
   void _async_invalidate(vinodeno_t ino, int64_t off, int64_t len);
@@ -897,6 +911,7 @@ public:
   void update_dir_dist(Inode *in, DirStat *st, mds_rank_t from);
 
   void clear_dir_complete_and_ordered(Inode *diri, bool complete);
+  void invalidate_frag_cache(Dir *dir, const std::string& name);
   void insert_readdir_results(MetaRequest *request, MetaSession *session,
                               Inode *diri, Inode *diri_other);
   Inode* insert_trace(MetaRequest *request, MetaSession *session);
@@ -1710,6 +1725,7 @@ private:
   bool _readdir_have_frag(dir_result_t *dirp);
   void _readdir_next_frag(dir_result_t *dirp);
   void _readdir_rechoose_frag(dir_result_t *dirp);
+  bool _readdir_get_cached_frag(dir_result_t *dirp);
   int _readdir_get_frag(int op, dir_result_t *dirp,
     fill_readdir_args_cb_t fill_req_cb);
   int _readdir_cache_cb(dir_result_t *dirp, add_dirent_cb_t cb, void *p, int caps, bool getref);
@@ -1,6 +1,9 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
 // vim: ts=8 sw=2 sts=2 expandtab
 
+#include <algorithm>
+#include <functional>
+
 #include "ClientSnapRealm.h"
 #include "common/Formatter.h"
 
@@ -9,33 +12,30 @@ using std::vector;
 
 void SnapRealm::build_snap_context()
 {
-  set<snapid_t> snaps;
   snapid_t max_seq = seq;
+  vector<snapid_t>& snaps = cached_snap_context.snaps;
+  snaps.clear();
 
-  // start with prior_parents?
-  for (unsigned i=0; i<prior_parent_snaps.size(); i++)
-    snaps.insert(prior_parent_snaps[i]);
-
-  // current parent's snaps
+  // current parent's snaps, which are already sorted newest first.  only
+  // the ones since parent_since are ours.
   if (pparent) {
     const SnapContext& psnapc = pparent->get_snap_context();
-    for (unsigned i=0; i<psnapc.snaps.size(); i++)
-      if (psnapc.snaps[i] >= parent_since)
-	snaps.insert(psnapc.snaps[i]);
+    auto end = std::partition_point(psnapc.snaps.begin(), psnapc.snaps.end(),
+				    [this](snapid_t s) { return s >= parent_since; });
+    snaps.reserve((end - psnapc.snaps.begin()) +
+		  prior_parent_snaps.size() + my_snaps.size());
+    snaps.assign(psnapc.snaps.begin(), end);
     if (psnapc.seq > max_seq)
       max_seq = psnapc.seq;
   }
 
-  // my snaps
-  for (unsigned i=0; i<my_snaps.size(); i++)
-    snaps.insert(my_snaps[i]);
+  // prior parents' and my snaps
+  snaps.insert(snaps.end(), prior_parent_snaps.begin(), prior_parent_snaps.end());
+  snaps.insert(snaps.end(), my_snaps.begin(), my_snaps.end());
+  std::sort(snaps.begin(), snaps.end(), std::greater<snapid_t>());
+  snaps.erase(std::unique(snaps.begin(), snaps.end()), snaps.end());
 
-  // ok!
   cached_snap_context.seq = max_seq;
-  cached_snap_context.snaps.resize(0);
-  cached_snap_context.snaps.reserve(snaps.size());
-  for (set<snapid_t>::reverse_iterator p = snaps.rbegin(); p != snaps.rend(); ++p)
-    cached_snap_context.snaps.push_back(*p);
 }
 
 void SnapRealm::dump(Formatter *f) const
@@ -1,10 +1,13 @@
 #ifndef CEPH_CLIENT_DIR_H
 #define CEPH_CLIENT_DIR_H
 
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "include/frag.h"
+
 class Dentry;
 struct Inode;
 
@@ -16,6 +19,16 @@ class Dir {
 
   std::vector<Dentry*> readdir_cache;
 
+  // the dentries of a dirfrag in readdir order, read from the mds in one
+  // pass. a complete frag is served by readdir without asking the mds until
+  // one of its dentries changes.
+  struct frag_cache_t {
+    std::vector<Dentry*> dentries;
+    int shared_gen = 0;  // dir shared_gen at the start of the pass
+    bool complete = false;
+  };
+  std::map<frag_t, frag_cache_t> frag_cache;
+
   explicit Dir(Inode* in) { parent_inode = in; }
 
   bool is_empty() {  return dentries.empty(); }
@@ -2,6 +2,7 @@
 #define CEPH_CLIENT_FH_H
 
 #include "common/Readahead.h"
+#include "common/StridedReadahead.h"
 #include "include/types.h"
 #include "InodeRef.h"
 #include "UserPerm.h"
@@ -29,6 +30,7 @@ struct Fh {
   std::list<ceph::condition_variable*> pos_waiters;   // waiters for pos
 
   Readahead readahead;
+  StridedReadahead strided_readahead;
 
   // file lock
   std::unique_ptr<ceph_lock_state_t> fcntl_locks;
@@ -164,6 +164,10 @@ struct Inode : RefCountedObject {
   version_t  inline_version = 0;
   bufferlist inline_data;
 
+  // whole contents of a small file, valid while Fc is held
+  bufferlist small_file_data;
+  uint64_t small_file_gen = 0;  // bumped whenever small_file_data is dropped
+
   std::vector<uint8_t> fscrypt_auth;
   std::vector<uint8_t> fscrypt_file;
 
@@ -880,9 +880,6 @@ static void fuse_ll_read(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
     size_t len;
     struct fuse_bufvec *bufv;
 
-    if (bl.get_num_buffers() > IOV_MAX)
-      bl.rebuild();
-
     bl.prepare_iov(&iov);
     len = sizeof(struct fuse_bufvec) + sizeof(struct fuse_buf) * (iov.size() - 1);
     bufv = (struct fuse_bufvec *)calloc(1, len);
@@ -897,6 +894,12 @@ static void fuse_ll_read(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
       free(bufv);
       return;
     }
+    // only writev() limits the number of segments
+    if (iov.size() >= IOV_MAX) {
+      bl.rebuild();
+      iov.clear();
+      bl.prepare_iov(&iov);
+    }
     iov.insert(iov.begin(), {0}); // the first one is reserved for fuse_out_header
     fuse_reply_iov(req, &iov[0], iov.size());
   } else
@@ -915,6 +918,38 @@ static void fuse_ll_write(fuse_req_t req, fuse_ino_t ino, const char *buf,
     fuse_reply_err(req, get_sys_errno(-r));
 }
 
+#if FUSE_VERSION >= FUSE_MAKE_VERSION(2, 9)
+/*
+ * With splice_read the data to write is still in a pipe: read it straight
+ * into a page aligned buffer handed over to the client, instead of having
+ * libfuse copy it out of the request and then copying it again.
+ */
+static void fuse_ll_write_buf(fuse_req_t req, fuse_ino_t ino,
+			      struct fuse_bufvec *in_buf, off_t off,
+			      struct fuse_file_info *fi)
+{
+  CephFuse::Handle *cfuse = fuse_ll_req_prepare(req);
+  Fh *fh = reinterpret_cast<Fh*>(fi->fh);
+  size_t size = fuse_buf_size(in_buf);
+  bufferptr bp = buffer::create_page_aligned(size);
+  struct fuse_bufvec out_buf = FUSE_BUFVEC_INIT(size);
+  out_buf.buf[0].mem = bp.c_str();
+  ssize_t copied = fuse_buf_copy(&out_buf, in_buf, (fuse_buf_copy_flags)0);
+  if (copied < 0) {
+    fuse_reply_err(req, -copied);
+    return;
+  }
+  bp.set_length(copied);
+  bufferlist bl;
+  bl.append(std::move(bp));
+  int r = cfuse->client->ll_write(fh, off, std::move(bl));
+  if (r >= 0)
+    fuse_reply_write(req, r);
+  else
+    fuse_reply_err(req, get_sys_errno(-r));
+}
+#endif
+
 static void fuse_ll_flush(fuse_req_t req, fuse_ino_t ino,
 			  struct fuse_file_info *fi)
 {
@@ -1371,7 +1406,7 @@ const static struct fuse_lowlevel_ops fuse_ll_oper = {
  poll: 0,
 #endif
 #if FUSE_VERSION >= FUSE_MAKE_VERSION(2, 9)
- write_buf: 0,
+ write_buf: fuse_ll_write_buf,
  retrieve_reply: 0,
  forget_multi: 0,
  flock: fuse_ll_flock,
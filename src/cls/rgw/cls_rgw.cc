@@ -557,6 +557,13 @@ int rgw_bucket_list(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
   // wanting to slow down this op with too many omap reads
   constexpr int max_attempts = 8;
 
+  // with a delimiter, one read can be used up entirely by the
+  // children of a single common prefix; the read after that only
+  // needs to seek past the prefix, so it asks for a few entries and
+  // is counted against its own budget rather than max_attempts
+  constexpr int max_prefix_seeks = 256;
+  constexpr uint32_t prefix_seek_entries = 16;
+
   auto iter = in->cbegin();
 
   rgw_cls_list_op op;
@@ -619,25 +626,39 @@ int rgw_bucket_list(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
     start_after_omap_key = cls_rgw_after_delim(start_after_omap_key);
   }
 
-  for (int attempt = 0;
-       attempt < max_attempts &&
-	 more &&
-	 !done &&
-	 name_entry_map.size() < op.num_entries;
-       ++attempt) {
+  int attempt = 0;
+  int prefix_seeks = 0;
+  // whether the previous read ended inside a common prefix
+  bool seeking = false;
+  while (more && !done && name_entry_map.size() < op.num_entries) {
+    uint32_t num_wanted = op.num_entries - name_entry_map.size();
+    if (seeking) {
+      if (prefix_seeks >= max_prefix_seeks) {
+	break;
+      }
+      ++prefix_seeks;
+      num_wanted = std::min(num_wanted, prefix_seek_entries);
+    } else {
+      if (attempt >= max_attempts) {
+	break;
+      }
+      ++attempt;
+    }
+    seeking = false;
+
     std::map<std::string, bufferlist> keys;
 
     // note: get_obj_vals skips past the "ugly namespace" (i.e.,
     // entries that start with the BI_PREFIX_CHAR), so no need to
     // check for such entries
     rc = get_obj_vals(hctx, start_after_omap_key, op.filter_prefix,
-		      op.num_entries - name_entry_map.size(),
-		      &keys, &more);
+		      num_wanted, &keys, &more);
     if (rc < 0) {
       return rc;
     }
-    CLS_LOG(20, "%s: on attempt %d get_obj_vls returned %ld entries, more=%d",
-	    __func__, attempt, keys.size(), more);
+    CLS_LOG(20, "%s: on attempt %d (prefix seek %d) get_obj_vls returned "
+	    "%ld entries, more=%d",
+	    __func__, attempt, prefix_seeks, keys.size(), more);
 
     done = keys.empty();
 
@@ -723,6 +744,11 @@ int rgw_bucket_list(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
 	  // advance past this subdirectory, but then back up one,
 	  // so the loop increment will put us in the right place
 	  kiter = keys.lower_bound(start_after_omap_key);
+	  if (kiter == keys.cend()) {
+	    // the rest of this read belongs to the subdirectory, so
+	    // seek past it rather than read another full batch of it
+	    seeking = true;
+	  }
 	  --kiter;
 
           continue;
@@ -741,7 +767,7 @@ int rgw_bucket_list(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
 		int(name_entry_map.size()));
       }
     } // for (auto kiter...
-  } // for (int attempt...
+  } // while (more...
 
   ret.is_truncated = more && !done;
   if (ret.is_truncated) {
@@ -1123,7 +1149,7 @@ static int read_key_entry(cls_method_context_t hctx, const cls_rgw_obj_key& key,
   return 0;
 }
 
-// called by rgw_bucket_complete_op() for each item in op.remove_objs
+// called by complete_op() for each item in op.remove_objs
 static int complete_remove_obj(cls_method_context_t hctx,
                                rgw_bucket_dir_header& header,
                                const cls_rgw_obj_key& key)
@@ -1149,48 +1175,15 @@ static int complete_remove_obj(cls_method_context_t hctx,
   return ret;
 }
 
-int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+/*
+ * Applies a single complete op to the index entries, accumulating the
+ * stats changes in header. The caller reads the header before and writes
+ * it back after, so several ops can share one header update.
+ */
+static int complete_op(cls_method_context_t hctx, rgw_cls_obj_complete_op& op,
+                       rgw_bucket_dir_header& header, bool bitx_inst)
 {
-  const ConfigProxy& conf = cls_get_config(hctx);
-  const object_info_t& oi = cls_get_object_info(hctx);
-
-  // bucket index transaction instrumentation
-  const bool bitx_inst =
-    conf->rgw_bucket_index_transaction_instrumentation;
-
-  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
-	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
-
-  // decode request
-  rgw_cls_obj_complete_op op;
-  auto iter = in->cbegin();
-  try {
-    decode(op, iter);
-  } catch (ceph::buffer::error& err) {
-    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to decode request", __func__);
-    return -EINVAL;
-  }
-
-  CLS_LOG_BITX(bitx_inst, 1,
-	       "INFO: %s: request: op=%s name=%s ver=%lu:%llu tag=%s",
-	       __func__,
-	       modify_op_str(op.op).c_str(), op.key.to_string().c_str(),
-	       (unsigned long)op.ver.pool, (unsigned long long)op.ver.epoch,
-	       op.tag.c_str());
-
-  rgw_bucket_dir_header header;
-  int rc = read_bucket_header(hctx, &header);
-  if (rc < 0) {
-    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to read header, rc=%d",
-		 __func__, rc);
-    return -EINVAL;
-  }
-
-  rc = guard_bucket_resharding(hctx, header);
-  if (rc < 0) {
-    return rc;
-  }
-
+  int rc;
   rgw_bucket_dir_entry entry;
   bool ondisk = true;
 
@@ -1373,6 +1366,57 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
     }
   } // remove loop
 
+  return 0;
+} // complete_op
+
+int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  const ConfigProxy& conf = cls_get_config(hctx);
+  const object_info_t& oi = cls_get_object_info(hctx);
+
+  // bucket index transaction instrumentation
+  const bool bitx_inst =
+    conf->rgw_bucket_index_transaction_instrumentation;
+
+  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
+	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
+
+  // decode request
+  rgw_cls_obj_complete_op op;
+  auto iter = in->cbegin();
+  try {
+    decode(op, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  CLS_LOG_BITX(bitx_inst, 1,
+	       "INFO: %s: request: op=%s name=%s ver=%lu:%llu tag=%s",
+	       __func__,
+	       modify_op_str(op.op).c_str(), op.key.to_string().c_str(),
+	       (unsigned long)op.ver.pool, (unsigned long long)op.ver.epoch,
+	       op.tag.c_str());
+
+  rgw_bucket_dir_header header;
+  int rc = read_bucket_header(hctx, &header);
+  if (rc < 0) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to read header, rc=%d",
+		 __func__, rc);
+    return -EINVAL;
+  }
+
+  rc = guard_bucket_resharding(hctx, header);
+  if (rc < 0) {
+    return rc;
+  }
+
+  rc = complete_op(hctx, op, header, bitx_inst);
+  if (rc < 0) {
+    return rc;
+  }
+
+
   CLS_LOG_BITX(bitx_inst, 20,
 	       "INFO: %s: writing bucket header", __func__);
   rc = write_bucket_header(hctx, &header);
@@ -1387,6 +1431,89 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
   return rc;
 } // rgw_bucket_complete_op
 
+int rgw_bucket_complete_op_batch(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  const ConfigProxy& conf = cls_get_config(hctx);
+  const object_info_t& oi = cls_get_object_info(hctx);
+
+  // bucket index transaction instrumentation
+  const bool bitx_inst =
+    conf->rgw_bucket_index_transaction_instrumentation;
+
+  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
+	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
+
+  // decode request
+  rgw_cls_obj_complete_batch_op op;
+  auto iter = in->cbegin();
+  try {
+    decode(op, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  CLS_LOG_BITX(bitx_inst, 1, "INFO: %s: request: %d ops",
+	       __func__, (int)op.ops.size());
+
+  // omap reads don't see the writes made earlier in the same method call,
+  // so two ops touching the same key would lose one of the updates
+  std::set<cls_rgw_obj_key> keys;
+  for (const auto& o : op.ops) {
+    if (!keys.insert(o.key).second) {
+      CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: duplicate key=%s in batch",
+		   __func__, escape_str(o.key.to_string()).c_str());
+      return -EINVAL;
+    }
+    for (const auto& remove_key : o.remove_objs) {
+      if (!keys.insert(remove_key).second) {
+        CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: duplicate key=%s in batch",
+		     __func__, escape_str(remove_key.to_string()).c_str());
+        return -EINVAL;
+      }
+    }
+  }
+
+  rgw_bucket_dir_header header;
+  int rc = read_bucket_header(hctx, &header);
+  if (rc < 0) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to read header, rc=%d",
+		 __func__, rc);
+    return -EINVAL;
+  }
+
+  rc = guard_bucket_resharding(hctx, header);
+  if (rc < 0) {
+    return rc;
+  }
+
+  for (auto& o : op.ops) {
+    CLS_LOG_BITX(bitx_inst, 20,
+		 "INFO: %s: op=%s name=%s ver=%lu:%llu tag=%s",
+		 __func__,
+		 modify_op_str(o.op).c_str(), o.key.to_string().c_str(),
+		 (unsigned long)o.ver.pool, (unsigned long long)o.ver.epoch,
+		 o.tag.c_str());
+    rc = complete_op(hctx, o, header, bitx_inst);
+    if (rc < 0) {
+      return rc;
+    }
+  }
+
+  CLS_LOG_BITX(bitx_inst, 20,
+	       "INFO: %s: writing bucket header", __func__);
+  rc = write_bucket_header(hctx, &header);
+  if (rc < 0) {
+    CLS_LOG_BITX(bitx_inst, 0,
+		 "ERROR: %s: failed to write bucket header ret=%d",
+		 __func__, rc);
+  }
+
+  CLS_LOG_BITX(bitx_inst, 10,
+	       "EXITING %s: returning %d", __func__, rc);
+  return rc;
+} // rgw_bucket_complete_op_batch
+
 static int read_olh(cls_method_context_t hctx,cls_rgw_obj_key& obj_key, rgw_bucket_olh_entry *olh_data_entry, string *index_key, bool *found)
 {
   cls_rgw_obj_key olh_key;
@@ -3955,6 +4082,116 @@ static int rgw_reshard_log_trim_op(cls_method_context_t hctx, bufferlist *in, bu
   return 0;
 }
 
+static int rgw_reshard_log_trim_entries_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  rgw_cls_reshard_log_trim_entries_op op;
+  try {
+    auto iter = in->cbegin();
+    decode(op, iter);
+  } catch (const ceph::buffer::error&) {
+    CLS_LOG(0, "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  const size_t limit = cls_get_config(hctx)->osd_max_omap_entries_per_request;
+  if (op.entries.size() > limit) {
+    int r = -E2BIG;
+    CLS_LOG(0, "ERROR: %s: got too many entries (%zu > %zu), returning %d",
+            __func__, op.entries.size(), limit, r);
+    return r;
+  }
+
+  rgw_bucket_dir_header header;
+  int r = read_bucket_header(hctx, &header);
+  if (r < 0) {
+    CLS_LOG(1, "ERROR: %s: failed to read header", __func__);
+    return r;
+  }
+
+  std::set<std::string> keys;
+  for (const auto& entry : op.entries) {
+    string key;
+    bi_reshard_log_key(hctx, key, entry.idx);
+    keys.insert(std::move(key));
+  }
+
+  std::map<std::string, ceph::buffer::list> vals;
+  r = cls_cxx_map_get_vals_by_keys(hctx, keys, &vals);
+  if (r < 0) {
+    CLS_LOG(0, "ERROR: %s: cls_cxx_map_get_vals_by_keys() returned r=%d",
+            __func__, r);
+    return r;
+  }
+
+  uint32_t removed = 0;
+  for (const auto& entry : op.entries) {
+    string key;
+    bi_reshard_log_key(hctx, key, entry.idx);
+    auto v = vals.find(key);
+    if (v == vals.end()) {
+      continue;
+    }
+
+    rgw_cls_bi_entry logged;
+    try {
+      auto iter = v->second.cbegin();
+      decode(logged, iter);
+    } catch (const ceph::buffer::error&) {
+      CLS_LOG(0, "ERROR: %s: failed to decode reshard log entry %s",
+              __func__, escape_str(key).c_str());
+      return -EIO;
+    }
+
+    // the type of a listed entry is recomputed from its key unless it
+    // was a deletion, so compare the deletion flag and the data only
+    const bool deleted = entry.type == BIIndexType::ReshardDeleted;
+    if (deleted != (logged.type == BIIndexType::ReshardDeleted) ||
+        !logged.data.contents_equal(entry.data)) {
+      CLS_LOG(20, "%s: reshard log entry %s was overwritten, keeping it",
+              __func__, escape_str(key).c_str());
+      continue;
+    }
+
+    r = cls_cxx_map_remove_key(hctx, key);
+    if (r < 0) {
+      CLS_LOG(0, "ERROR: %s: cls_cxx_map_remove_key(%s) returned r=%d",
+              __func__, escape_str(key).c_str(), r);
+      return r;
+    }
+    vals.erase(v); // in case the same entry is passed twice
+    ++removed;
+  }
+
+  if (removed == 0) {
+    return 0;
+  }
+
+  // reshardlog_entries counts log writes rather than distinct keys, so
+  // it's only reset once the log is found to be empty
+  header.reshardlog_entries -= std::min(header.reshardlog_entries, removed);
+  if (header.reshardlog_entries > 0) {
+    string key_begin;
+    bi_reshard_log_prefix(key_begin);
+    string key_end = string(1, BI_PREFIX_CHAR) +
+      bucket_index_prefixes[BI_BUCKET_RESHARD_LOG_INDEX + 1];
+
+    std::set<std::string> first;
+    bool more = false;
+    r = cls_cxx_map_get_keys(hctx, key_begin, 1, &first, &more);
+    if (r < 0) {
+      CLS_LOG(1, "ERROR: %s: cls_cxx_map_get_keys failed r=%d", __func__, r);
+      return r;
+    }
+    if (first.empty() || *first.begin() >= key_end) {
+      header.reshardlog_entries = 0;
+    }
+  }
+  CLS_LOG(20, "%s: removed %u reshard log entries, %u log writes remain",
+          __func__, removed, header.reshardlog_entries);
+
+  return write_bucket_header(hctx, &header);
+}
+
 static void usage_record_prefix_by_time(uint64_t epoch, string& key)
 {
   char buf[32];
@@ -5091,6 +5328,7 @@ CLS_INIT(rgw)
   cls_method_handle_t h_rgw_bucket_update_stats;
   cls_method_handle_t h_rgw_bucket_prepare_op;
   cls_method_handle_t h_rgw_bucket_complete_op;
+  cls_method_handle_t h_rgw_bucket_complete_op_batch;
   cls_method_handle_t h_rgw_bucket_link_olh;
   cls_method_handle_t h_rgw_bucket_unlink_instance_op;
   cls_method_handle_t h_rgw_bucket_read_olh_log;
@@ -5105,6 +5343,7 @@ CLS_INIT(rgw)
   cls_method_handle_t h_rgw_bi_put_entries_op;
   cls_method_handle_t h_rgw_bi_list_op;
   cls_method_handle_t h_rgw_reshard_log_trim_op;
+  cls_method_handle_t h_rgw_reshard_log_trim_entries_op;
   cls_method_handle_t h_rgw_bi_log_list_op;
   cls_method_handle_t h_rgw_bi_log_trim_op;
   cls_method_handle_t h_rgw_bi_log_resync_op;
@@ -5147,6 +5386,7 @@ CLS_INIT(rgw)
   cls_register_cxx_method(h_class, RGW_BUCKET_UPDATE_STATS, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_update_stats, &h_rgw_bucket_update_stats);
   cls_register_cxx_method(h_class, RGW_BUCKET_PREPARE_OP, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_prepare_op, &h_rgw_bucket_prepare_op);
   cls_register_cxx_method(h_class, RGW_BUCKET_COMPLETE_OP, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_complete_op, &h_rgw_bucket_complete_op);
+  cls_register_cxx_method(h_class, RGW_BUCKET_COMPLETE_OP_BATCH, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_complete_op_batch, &h_rgw_bucket_complete_op_batch);
   cls_register_cxx_method(h_class, RGW_BUCKET_LINK_OLH, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_link_olh, &h_rgw_bucket_link_olh);
   cls_register_cxx_method(h_class, RGW_BUCKET_UNLINK_INSTANCE, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_unlink_instance, &h_rgw_bucket_unlink_instance_op);
   cls_register_cxx_method(h_class, RGW_BUCKET_READ_OLH_LOG, CLS_METHOD_RD, rgw_bucket_read_olh_log, &h_rgw_bucket_read_olh_log);
@@ -5163,6 +5403,7 @@ CLS_INIT(rgw)
   cls_register_cxx_method(h_class, RGW_BI_PUT_ENTRIES, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bi_put_entries, &h_rgw_bi_put_entries_op);
   cls_register_cxx_method(h_class, RGW_BI_LIST, CLS_METHOD_RD, rgw_bi_list_op, &h_rgw_bi_list_op);
   cls_register_cxx_method(h_class, RGW_RESHARD_LOG_TRIM, CLS_METHOD_RD | CLS_METHOD_WR, rgw_reshard_log_trim_op, &h_rgw_reshard_log_trim_op);
+  cls_register_cxx_method(h_class, RGW_RESHARD_LOG_TRIM_ENTRIES, CLS_METHOD_RD | CLS_METHOD_WR, rgw_reshard_log_trim_entries_op, &h_rgw_reshard_log_trim_entries_op);
 
   cls_register_cxx_method(h_class, RGW_BI_LOG_LIST, CLS_METHOD_RD, rgw_bi_log_list, &h_rgw_bi_log_list_op);
   cls_register_cxx_method(h_class, RGW_BI_LOG_TRIM, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bi_log_trim, &h_rgw_bi_log_trim_op);
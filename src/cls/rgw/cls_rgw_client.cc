@@ -127,6 +127,16 @@ void cls_rgw_bucket_complete_op(ObjectWriteOperation& o, RGWModifyOp op, const s
   o.exec(RGW_CLASS, RGW_BUCKET_COMPLETE_OP, in);
 }
 
+void cls_rgw_bucket_complete_op_batch(ObjectWriteOperation& o,
+                                      const std::vector<rgw_cls_obj_complete_op>& ops)
+{
+  bufferlist in;
+  rgw_cls_obj_complete_batch_op call;
+  call.ops = ops;
+  encode(call, in);
+  o.exec(RGW_CLASS, RGW_BUCKET_COMPLETE_OP_BATCH, in);
+}
+
 void cls_rgw_bucket_list_op(librados::ObjectReadOperation& op,
                             const cls_rgw_obj_key& start_obj,
                             const std::string& filter_prefix,
@@ -443,6 +453,19 @@ void cls_rgw_bucket_reshard_log_trim(librados::ObjectWriteOperation& op)
   op.exec(RGW_CLASS, RGW_RESHARD_LOG_TRIM, in);
 }
 
+void cls_rgw_bucket_reshard_log_trim_entries(librados::ObjectWriteOperation& op,
+                                             std::vector<rgw_cls_bi_entry> entries)
+{
+  const auto call = rgw_cls_reshard_log_trim_entries_op{
+    .entries = std::move(entries)
+  };
+
+  bufferlist in;
+  encode(call, in);
+
+  op.exec(RGW_CLASS, RGW_RESHARD_LOG_TRIM_ENTRIES, in);
+}
+
 void cls_rgw_bucket_check_index(librados::ObjectReadOperation& op,
                                 bufferlist& out)
 {
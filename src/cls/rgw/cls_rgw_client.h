@@ -148,6 +148,10 @@ void cls_rgw_bucket_complete_op(librados::ObjectWriteOperation& o, RGWModifyOp o
                                 uint16_t bilog_op, const rgw_zone_set *zones_trace,
 				const std::string& obj_locator = ""); // ignored if it's the empty string
 
+// ops must all be on distinct keys of the same index shard
+void cls_rgw_bucket_complete_op_batch(librados::ObjectWriteOperation& o,
+                                      const std::vector<rgw_cls_obj_complete_op>& ops);
+
 void cls_rgw_remove_obj(librados::ObjectWriteOperation& o, std::list<std::string>& keep_attr_prefixes);
 void cls_rgw_obj_store_pg_ver(librados::ObjectWriteOperation& o, const std::string& attr);
 void cls_rgw_obj_check_attrs_prefix(librados::ObjectOperation& o, const std::string& prefix, bool fail_if_exist);
@@ -308,3 +312,9 @@ void cls_rgw_get_bucket_resharding_decode(const bufferlist& out,
 // Try to remove all reshard log entries from the bucket index. Return success
 // if any entries were removed, and -ENODATA once they're all gone.
 void cls_rgw_bucket_reshard_log_trim(librados::ObjectWriteOperation& op);
+
+// Remove the given reshard log entries, as returned by bi_list, from the
+// bucket index. Entries that were overwritten since they were listed are
+// left in place.
+void cls_rgw_bucket_reshard_log_trim_entries(librados::ObjectWriteOperation& op,
+                                             std::vector<rgw_cls_bi_entry> entries);
@@ -181,6 +181,23 @@ void rgw_cls_obj_complete_op::dump(Formatter *f) const
   encode_json("zones_trace", zones_trace, f);
 }
 
+list<rgw_cls_obj_complete_batch_op> rgw_cls_obj_complete_batch_op::generate_test_instances()
+{
+  list<rgw_cls_obj_complete_batch_op> o;
+  rgw_cls_obj_complete_batch_op op;
+  for (auto& c : rgw_cls_obj_complete_op::generate_test_instances()) {
+    op.ops.push_back(std::move(c));
+  }
+  o.push_back(std::move(op));
+  o.emplace_back();
+  return o;
+}
+
+void rgw_cls_obj_complete_batch_op::dump(Formatter *f) const
+{
+  encode_json("ops", ops, f);
+}
+
 list<rgw_cls_link_olh_op> rgw_cls_link_olh_op::generate_test_instances()
 {
   list<rgw_cls_link_olh_op> o;
@@ -627,3 +644,8 @@ void rgw_cls_bi_put_entries_op::dump(Formatter *f) const
   encode_json("entries", entries, f);
   encode_json("check_existing", check_existing, f);
 }
+
+void rgw_cls_reshard_log_trim_entries_op::dump(Formatter *f) const
+{
+  encode_json("entries", entries, f);
+}
@@ -162,6 +162,27 @@ struct rgw_cls_obj_complete_op
 };
 WRITE_CLASS_ENCODER(rgw_cls_obj_complete_op)
 
+// several complete ops on distinct keys of the same index shard, applied
+// with a single header update
+struct rgw_cls_obj_complete_batch_op
+{
+  std::vector<rgw_cls_obj_complete_op> ops;
+
+  void encode(ceph::buffer::list &bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(ops, bl);
+    ENCODE_FINISH(bl);
+  }
+  void decode(ceph::buffer::list::const_iterator &bl) {
+    DECODE_START(1, bl);
+    decode(ops, bl);
+    DECODE_FINISH(bl);
+  }
+  void dump(ceph::Formatter *f) const;
+  static std::list<rgw_cls_obj_complete_batch_op> generate_test_instances();
+};
+WRITE_CLASS_ENCODER(rgw_cls_obj_complete_batch_op)
+
 struct rgw_cls_link_olh_op {
   cls_rgw_obj_key key;
   std::string olh_tag;
@@ -810,6 +831,35 @@ struct rgw_cls_bi_put_entries_op {
 };
 WRITE_CLASS_ENCODER(rgw_cls_bi_put_entries_op)
 
+struct rgw_cls_reshard_log_trim_entries_op {
+  // reshard log entries as returned by bi_list, each removed only if
+  // it hasn't been overwritten since
+  std::vector<rgw_cls_bi_entry> entries;
+
+  void encode(ceph::buffer::list& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(entries, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(ceph::buffer::list::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(entries, bl);
+    DECODE_FINISH(bl);
+  }
+
+  void dump(ceph::Formatter *f) const;
+
+  static std::list<rgw_cls_reshard_log_trim_entries_op> generate_test_instances() {
+    std::list<rgw_cls_reshard_log_trim_entries_op> o;
+    o.emplace_back();
+    o.emplace_back();
+    o.back().entries.push_back({.idx = "entry"});
+    return o;
+  }
+};
+WRITE_CLASS_ENCODER(rgw_cls_reshard_log_trim_entries_op)
+
 struct rgw_cls_bi_list_op {
   uint32_t max;
   std::string name_filter; // limit result to one object and its instances
@@ -14,11 +14,22 @@ AsyncOpTracker::~AsyncOpTracker() {
 }
 
 void AsyncOpTracker::start_op() {
-  std::lock_guard locker(m_lock);
-  ++m_pending_ops;
+  m_pending_ops.fetch_add(1, std::memory_order_acquire);
 }
 
 void AsyncOpTracker::finish_op() {
+  // ops that don't drop the count to zero can't complete a waiter
+  auto pending_ops = m_pending_ops.load(std::memory_order_relaxed);
+  while (pending_ops > 1) {
+    if (m_pending_ops.compare_exchange_weak(pending_ops, pending_ops - 1,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+      return;
+    }
+  }
+
+  // the last op is finished under the lock: once a waiter can see no
+  // pending ops, it may complete and destroy the tracker
   Context *on_finish = nullptr;
   {
     std::lock_guard locker(m_lock);
@@ -46,7 +57,5 @@ void AsyncOpTracker::wait_for_ops(Context *on_finish) {
 }
 
 bool AsyncOpTracker::empty() {
-  std::lock_guard locker(m_lock);
   return (m_pending_ops == 0);
 }
-
@@ -4,6 +4,8 @@
 #ifndef CEPH_ASYNC_OP_TRACKER_H
 #define CEPH_ASYNC_OP_TRACKER_H
 
+#include <atomic>
+
 #include "common/ceph_mutex.h"
 #include "include/Context.h"
 
@@ -20,8 +22,10 @@ public:
   bool empty();
 
 private:
+  // starting and finishing ops only take the lock when the count may
+  // drop to zero and complete a waiter
   ceph::mutex m_lock = ceph::make_mutex("AsyncOpTracker::m_lock");
-  uint32_t m_pending_ops = 0;
+  std::atomic<uint32_t> m_pending_ops = {0};
   Context *m_on_finish = nullptr;
 
 };
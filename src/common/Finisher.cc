@@ -4,7 +4,6 @@
 #include "Finisher.h"
 #include "common/Clock.h" // for ceph_clock_now()
 #include "common/perf_counters.h"
-#include "include/types.h" // for operator<<(std::vector)
 
 #ifdef WITH_CRIMSON
 #include "crimson/common/perf_counters_collection.h"
@@ -42,6 +41,10 @@ Finisher::~Finisher() {
     cct->get_perfcounters_collection()->remove(logger);
     delete logger;
   }
+  queue_item *i = finisher_queue.exchange(nullptr);
+  while (i) {
+    delete std::exchange(i, i->next);
+  }
 }
 
 void Finisher::start()
@@ -66,7 +69,7 @@ void Finisher::stop()
 void Finisher::wait_for_empty()
 {
   std::unique_lock ul(finisher_lock);
-  while (!finisher_queue.empty() || finisher_running) {
+  while (finisher_queue.load() != nullptr || finisher_running) {
     ldout(cct, 10) << "wait_for_empty waiting" << dendl;
     finisher_empty_wait = true;
     finisher_empty_cond.wait(ul);
@@ -77,56 +80,66 @@ void Finisher::wait_for_empty()
 
 bool Finisher::is_empty()
 {
-  const std::lock_guard l{finisher_lock};
-  return finisher_queue.empty();
+  return finisher_queue.load() == nullptr;
 }
 
 void *Finisher::finisher_thread_entry()
 {
-  std::unique_lock ul(finisher_lock);
   ldout(cct, 10) << "finisher_thread start" << dendl;
 
   utime_t start;
-  uint64_t count = 0;
-  while (!finisher_stop) {
+  while (true) {
     /// Every time we are woken up, we process the queue until it is empty.
-    while (!finisher_queue.empty()) {
-      // To reduce lock contention, we swap out the queue to process.
-      // This way other threads can submit new contexts to complete
-      // while we are working.
-      in_progress_queue.swap(finisher_queue);
-      finisher_running = true;
-      ul.unlock();
-      ldout(cct, 10) << "finisher_thread doing " << in_progress_queue << dendl;
+    finisher_running = true;
+    while (queue_item *ls = finisher_queue.exchange(nullptr,
+						     std::memory_order_acquire)) {
+      // Producers push at the front, so put the batch back in queue order.
+      queue_item *in_progress = nullptr;
+      uint64_t count = 0;
+      do {
+	queue_item *next = ls->next;
+	ls->next = in_progress;
+	in_progress = ls;
+	ls = next;
+	++count;
+      } while (ls);
+      ldout(cct, 10) << "finisher_thread doing " << count << " contexts"
+		     << dendl;
 
       if (logger) {
 	start = ceph_clock_now();
-	count = in_progress_queue.size();
       }
 
       // Now actually process the contexts.
-      for (auto p : in_progress_queue) {
-	p.first->complete(p.second);
+      while (in_progress) {
+	queue_item *i = std::exchange(in_progress, in_progress->next);
+	i->c->complete(i->r);
+	delete i;
       }
-      ldout(cct, 10) << "finisher_thread done with " << in_progress_queue
-                     << dendl;
-      in_progress_queue.clear();
+      ldout(cct, 10) << "finisher_thread done with " << count << " contexts"
+		     << dendl;
       if (logger) {
 	logger->dec(l_finisher_queue_len, count);
 	logger->tinc(l_finisher_complete_lat, ceph_clock_now() - start);
       }
-
-      ul.lock();
-      finisher_running = false;
     }
+
+    std::unique_lock ul(finisher_lock);
+    finisher_running = false;
     ldout(cct, 10) << "finisher_thread empty" << dendl;
     if (unlikely(finisher_empty_wait))
       finisher_empty_cond.notify_all();
-    if (finisher_stop)
+    if (finisher_stop && finisher_queue.load() == nullptr)
       break;
-    
-    ldout(cct, 10) << "finisher_thread sleeping" << dendl;
-    finisher_cond.wait(ul);
+
+    // Producers only take finisher_lock to wake us if they see
+    // finisher_sleeping, so set it before the last look at the queue.
+    finisher_sleeping = true;
+    while (!finisher_stop && finisher_queue.load() == nullptr) {
+      ldout(cct, 10) << "finisher_thread sleeping" << dendl;
+      finisher_cond.wait(ul);
+    }
+    finisher_sleeping = false;
   }
   // If we are exiting, we signal the thread waiting in stop(),
   // otherwise it would never unblock
@@ -136,4 +149,3 @@ void *Finisher::finisher_thread_entry()
   finisher_stop = false;
   return 0;
 }
-
@@ -20,6 +20,7 @@
 #include <list>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "include/Context.h"
@@ -40,19 +41,42 @@ enum {
  * Finisher asynchronously completes Contexts, which are simple classes
  * representing callbacks, in a dedicated worker thread. Enqueuing
  * contexts to complete is thread-safe.
+ *
+ * Producers push onto a lock-free list and only take finisher_lock to
+ * wake the worker when they find it asleep on an empty queue; the worker
+ * takes everything queued so far in one go.
  */
 class Finisher {
   CephContext *const cct;
-  ceph::mutex finisher_lock; ///< Protects access to queues and finisher_running.
+  ceph::mutex finisher_lock; ///< Protects sleeping, waking and finisher_stop.
   ceph::condition_variable finisher_cond; ///< Signaled when there is something to process.
   ceph::condition_variable finisher_empty_cond; ///< Signaled when the finisher has nothing more to process.
   bool         finisher_stop = false; ///< Set when the finisher should stop.
-  bool         finisher_running = false; ///< True when the finisher is currently executing contexts.
+  std::atomic<bool> finisher_running = false; ///< True when the finisher is currently executing contexts.
+  std::atomic<bool> finisher_sleeping = false; ///< True when the finisher is waiting on finisher_cond.
   bool	       finisher_empty_wait = false; ///< True mean someone wait finisher empty.
 
-  /// Queue for contexts for which complete(0) will be called.
-  std::vector<std::pair<Context*,int>> finisher_queue;
-  std::vector<std::pair<Context*,int>> in_progress_queue;
+  struct queue_item {
+    Context *c;
+    int r;
+    queue_item *next;
+  };
+  /// Contexts for which complete(r) will be called, most recent first.
+  std::atomic<queue_item*> finisher_queue = nullptr;
+
+  /// link first..last in front of the queue, waking the worker if needed
+  void push(queue_item *first, queue_item *last) {
+    queue_item *prev = finisher_queue.load(std::memory_order_relaxed);
+    do {
+      last->next = prev;
+    } while (!finisher_queue.compare_exchange_weak(prev, first));
+    // pairs with the worker setting finisher_sleeping before it looks at
+    // the queue one last time
+    if (prev == nullptr && finisher_sleeping) {
+      const std::lock_guard l{finisher_lock};
+      finisher_cond.notify_one();
+    }
+  }
 
   const std::string thread_name;
 
@@ -71,14 +95,8 @@ class Finisher {
  public:
   /// Add a context to complete, optionally specifying a parameter for the complete function.
   void queue(Context *c, int r = 0) {
-    {
-      const std::lock_guard l{finisher_lock};
-      const bool should_notify = finisher_queue.empty() && !finisher_running;
-      finisher_queue.push_back(std::make_pair(c, r));
-      if (should_notify) {
-	finisher_cond.notify_one();
-      }
-    }
+    auto i = new queue_item{c, r, nullptr};
+    push(i, i);
 
     if (logger)
       logger->inc(l_finisher_queue_len);
@@ -87,18 +105,20 @@ class Finisher {
   // TODO use C++20 concept checks instead of SFINAE
   template<typename T>
   auto queue(T &ls) -> decltype(std::distance(ls.begin(), ls.end()), void()) {
-    {
-      const std::lock_guard l{finisher_lock};
-      const bool should_notify = finisher_queue.empty() && !finisher_running;
-      for (Context *i : ls) {
-	finisher_queue.push_back(std::make_pair(i, 0));
-      }
-      if (should_notify) {
-	finisher_cond.notify_one();
+    queue_item *first = nullptr, *last = nullptr;
+    size_t n = 0;
+    for (Context *c : ls) {
+      first = new queue_item{c, 0, first};
+      if (!last) {
+	last = first;
       }
+      ++n;
+    }
+    if (first) {
+      push(first, last);
     }
     if (logger)
-      logger->inc(l_finisher_queue_len, ls.size());
+      logger->inc(l_finisher_queue_len, n);
     ls.clear();
   }
 
@@ -156,31 +176,40 @@ public:
   }
 };
 
+/// Lists of contexts queued by many threads for one consumer, which is
+/// woken through the given mutex and cond when the queue becomes
+/// non-empty.
 class ContextQueue {
-  std::list<Context *> q;
-  std::mutex q_mutex;
+  struct batch {
+    std::list<Context *> ls;
+    batch *next;
+  };
+  /// queued lists, most recent first
+  std::atomic<batch*> q = nullptr;
   ceph::mutex& mutex;
   ceph::condition_variable& cond;
-  std::atomic_bool q_empty = true;
 public:
   ContextQueue(ceph::mutex& mut,
 	       ceph::condition_variable& con)
     : mutex(mut), cond(con) {}
+  ~ContextQueue() {
+    batch *b = q.exchange(nullptr);
+    while (b) {
+      delete std::exchange(b, b->next);
+    }
+  }
 
   void queue(std::list<Context *>& ls) {
-    bool was_empty = false;
-    {
-      std::scoped_lock l(q_mutex);
-      if (q.empty()) {
-	q.swap(ls);
-	was_empty = true;
-      } else {
-	q.insert(q.end(), ls.begin(), ls.end());
-      }
-      q_empty = q.empty();
+    if (ls.empty()) {
+      return;
     }
+    auto b = new batch{std::move(ls), nullptr};
+    batch *prev = q.load(std::memory_order_relaxed);
+    do {
+      b->next = prev;
+    } while (!q.compare_exchange_weak(prev, b));
 
-    if (was_empty) {
+    if (prev == nullptr) {
       std::scoped_lock l{mutex};
       cond.notify_all();
     }
@@ -190,15 +219,15 @@ public:
 
   void move_to(std::list<Context *>& ls) {
     ls.clear();
-    std::scoped_lock l(q_mutex);
-    if (!q.empty()) {
-      q.swap(ls);
+    batch *b = q.exchange(nullptr, std::memory_order_acquire);
+    while (b) {
+      ls.splice(ls.begin(), b->ls);
+      delete std::exchange(b, b->next);
     }
-    q_empty = true;
   }
 
   bool empty() {
-    return q_empty;
+    return q.load(std::memory_order_relaxed) == nullptr;
   }
 };
 
@@ -0,0 +1,70 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include "common/FrequencySketch.h"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+namespace ceph {
+
+void FrequencySketch::init(uint64_t entries)
+{
+  width = std::bit_ceil(std::max<uint64_t>(entries, 1024));
+  table.assign(depth * width, 0);
+  additions = 0;
+  sample_size = 10 * width;
+}
+
+void FrequencySketch::increment(const std::string& key)
+{
+  if (table.empty()) {
+    return;
+  }
+  const uint64_t hash = std::hash<std::string>{}(key);
+  bool added = false;
+  for (unsigned row = 0; row < depth; row++) {
+    auto& counter = table[index(hash, row)];
+    if (counter < max_count) {
+      ++counter;
+      added = true;
+    }
+  }
+  if (added && ++additions >= sample_size) {
+    age();
+  }
+}
+
+uint8_t FrequencySketch::estimate(const std::string& key) const
+{
+  if (table.empty()) {
+    return 0;
+  }
+  const uint64_t hash = std::hash<std::string>{}(key);
+  uint8_t frequency = max_count;
+  for (unsigned row = 0; row < depth; row++) {
+    frequency = std::min(frequency, table[index(hash, row)]);
+  }
+  return frequency;
+}
+
+void FrequencySketch::age()
+{
+  for (auto& counter : table) {
+    counter >>= 1;
+  }
+  additions /= 2;
+}
+
+} // namespace ceph
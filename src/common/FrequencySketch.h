@@ -0,0 +1,61 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#ifndef CEPH_COMMON_FREQUENCYSKETCH_H
+#define CEPH_COMMON_FREQUENCYSKETCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ceph {
+
+/*
+ * An estimate of how often each key was seen recently, for TinyLFU style
+ * cache admission: a count-min sketch of 4-bit counters that are all halved
+ * every sample_size additions so that past popularity fades.
+ *
+ * Not thread safe; callers serialize access.
+ */
+class FrequencySketch {
+  static constexpr unsigned depth = 4;
+  static constexpr uint8_t max_count = 15;
+
+  std::vector<uint8_t> table; // depth rows of width counters
+  uint64_t width = 0;
+  uint64_t additions = 0;
+  uint64_t sample_size = 0;
+
+  uint64_t index(uint64_t hash, unsigned row) const {
+    hash = (hash + row) * 0x9e3779b97f4a7c15ull;
+    hash ^= hash >> 29;
+    return row * width + (hash & (width - 1));
+  }
+  void age();
+
+public:
+  FrequencySketch() = default;
+  explicit FrequencySketch(uint64_t entries) {
+    init(entries);
+  }
+
+  // size the sketch for about this many keys. until then the sketch is
+  // empty and every estimate is 0
+  void init(uint64_t entries);
+  void increment(const std::string& key);
+  uint8_t estimate(const std::string& key) const;
+};
+
+} // namespace ceph
+
+#endif
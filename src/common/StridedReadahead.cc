@@ -0,0 +1,150 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include "common/StridedReadahead.h"
+
+#include <algorithm>
+#include <iterator>
+
+using std::vector;
+
+/// Upper bound of the strides prefetched ahead of a stream
+static const unsigned MAX_DEPTH = 64;
+
+StridedReadahead::StridedReadahead()
+  : m_max_streams(4),
+    m_readahead_max_bytes(UINT64_MAX),
+    m_initial_depth(2),
+    m_tick(0),
+    m_hits(0),
+    m_wasted_bytes(0) {
+}
+
+void StridedReadahead::set_max_streams(unsigned max_streams) {
+  m_max_streams = max_streams;
+  while (m_streams.size() > m_max_streams) {
+    _drop(m_streams.back());
+    m_streams.pop_back();
+  }
+  while (m_history.size() > 4 * m_max_streams) {
+    m_history.pop_front();
+  }
+}
+
+void StridedReadahead::set_max_readahead_size(uint64_t max_readahead_size) {
+  m_readahead_max_bytes = max_readahead_size;
+}
+
+void StridedReadahead::_drop(stream_t& s) {
+  if (s.ahead) {
+    m_wasted_bytes += s.ahead * s.length;
+    m_initial_depth = std::max(1u, m_initial_depth / 2);
+  }
+  s = stream_t();
+}
+
+bool StridedReadahead::_stride_offset(const stream_t& s, unsigned n,
+                                      uint64_t limit, uint64_t *offset) {
+  if (s.stride > 0) {
+    uint64_t d = (uint64_t)s.stride * n;
+    if (d >= limit || s.last >= limit - d) {
+      return false;
+    }
+    *offset = s.last + d;
+  } else {
+    uint64_t d = (uint64_t)(-s.stride) * n;
+    if (d > s.last) {
+      return false;
+    }
+    *offset = s.last - d;
+  }
+  return true;
+}
+
+vector<StridedReadahead::extent_t> StridedReadahead::update(uint64_t offset,
+                                                            uint64_t length,
+                                                            uint64_t limit) {
+  vector<extent_t> prefetch;
+  if (m_max_streams == 0 || length == 0) {
+    return prefetch;
+  }
+  ++m_tick;
+
+  stream_t *s = nullptr;
+  for (auto& t : m_streams) {
+    if (t.length == length && (int64_t)(offset - t.last) == t.stride) {
+      s = &t;
+      break;
+    }
+  }
+
+  if (s) {
+    if (s->ahead) {
+      ++m_hits;
+      --s->ahead;
+    }
+    s->last = offset;
+    s->used = m_tick;
+  } else {
+    // a new stream needs two earlier reads of the same length, evenly
+    // spaced with this one. sequential reads are left to Readahead
+    int64_t stride = 0;
+    for (auto i = m_history.rbegin(); i != m_history.rend() && !stride; ++i) {
+      int64_t delta = (int64_t)(offset - i->first);
+      if (i->second != length || delta == 0 || delta == (int64_t)length) {
+        continue;
+      }
+      for (auto j = std::next(i); j != m_history.rend(); ++j) {
+        if (j->second == length && (int64_t)(i->first - j->first) == delta) {
+          stride = delta;
+          break;
+        }
+      }
+    }
+    m_history.emplace_back(offset, length);
+    if (m_history.size() > 4 * m_max_streams) {
+      m_history.pop_front();
+    }
+    if (!stride) {
+      return prefetch;
+    }
+
+    if (m_streams.size() < m_max_streams) {
+      s = &m_streams.emplace_back();
+    } else {
+      s = &*std::min_element(m_streams.begin(), m_streams.end(),
+                             [](const stream_t& a, const stream_t& b) {
+                               return a.used < b.used;
+                             });
+      _drop(*s);
+    }
+    s->last = offset;
+    s->length = length;
+    s->stride = stride;
+    s->depth = m_initial_depth;
+    s->used = m_tick;
+  }
+
+  // refill once half of the prefetched strides were read
+  const unsigned max_depth = std::clamp<uint64_t>(m_readahead_max_bytes / length,
+                                                  1, MAX_DEPTH);
+  const unsigned depth = std::min(s->depth, max_depth);
+  if (s->ahead > depth / 2) {
+    return prefetch;
+  }
+  for (unsigned n = s->ahead + 1; n <= depth; ++n) {
+    uint64_t o;
+    if (!_stride_offset(*s, n, limit, &o)) {
+      break;
+    }
+    prefetch.emplace_back(o, std::min(length, limit - o));
+    s->ahead = n;
+  }
+
+  // all that was prefetched so far was read: go further next time
+  s->depth = std::min(depth * 2, max_depth);
+  if (s->depth == max_depth) {
+    m_initial_depth = std::min(m_initial_depth * 2, max_depth);
+  }
+  return prefetch;
+}
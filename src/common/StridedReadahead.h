@@ -0,0 +1,93 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#ifndef CEPH_STRIDEDREADAHEAD_H
+#define CEPH_STRIDEDREADAHEAD_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+   Readahead for reads that follow a fixed stride, forward or backward,
+   which Readahead doesn't see as sequential.
+
+   A stream is a run of reads of the same length whose offsets differ by
+   the same stride. Several streams may be interleaved, such as the reads
+   of different columns of a table. Once three recent reads show the
+   stride of a stream, the reads of its next strides are returned for
+   prefetch.
+   The number of strides prefetched ahead of a stream doubles while its
+   prefetches are read, up to a maximum. When streams are dropped with
+   prefetched strides that were never read, new streams start with fewer
+   strides ahead.
+
+   Not thread-safe: callers serialize calls to update().
+ */
+class StridedReadahead {
+public:
+  typedef std::pair<uint64_t, uint64_t> extent_t;
+
+  StridedReadahead();
+
+  /**
+     Update state with a new read and return the reads to prefetch, which
+     don't pass \c limit.
+
+     @param offset offset of the read operation
+     @param length length of the read operation
+     @param limit size of the thing readahead is being applied to
+   */
+  std::vector<extent_t> update(uint64_t offset, uint64_t length, uint64_t limit);
+
+  /**
+     Sets the number of streams tracked at once. 0 disables readahead.
+   */
+  void set_max_streams(unsigned max_streams);
+
+  /**
+     Sets the maximum number of bytes prefetched ahead of a stream.
+   */
+  void set_max_readahead_size(uint64_t max_readahead_size);
+
+  /// Number of reads that were prefetched before they were made
+  uint64_t get_hits() const { return m_hits; }
+
+  /// Bytes prefetched for streams that ended before reading them
+  uint64_t get_wasted_bytes() const { return m_wasted_bytes; }
+
+private:
+  struct stream_t {
+    uint64_t last = 0;    ///< offset of the last read
+    uint64_t length = 0;  ///< length of each read
+    int64_t stride = 0;   ///< signed distance between reads
+    unsigned ahead = 0;   ///< strides after the last read that were prefetched
+    unsigned depth = 0;   ///< strides to prefetch ahead on the next refill
+    uint64_t used = 0;    ///< tick of the last read, for eviction
+  };
+
+  /// Ends a stream, counting its unread prefetches as waste
+  void _drop(stream_t& s);
+
+  /// Offset of the nth stride after the last read of a stream, or false if
+  /// it falls outside of [0, limit)
+  static bool _stride_offset(const stream_t& s, unsigned n, uint64_t limit,
+                             uint64_t *offset);
+
+  unsigned m_max_streams;
+  uint64_t m_readahead_max_bytes;
+
+  /// Strides to prefetch ahead of a newly triggered stream
+  unsigned m_initial_depth;
+
+  uint64_t m_tick;
+  std::vector<stream_t> m_streams;
+
+  /// Recent reads that didn't continue a stream, oldest first
+  std::deque<extent_t> m_history;
+
+  uint64_t m_hits;
+  uint64_t m_wasted_bytes;
+};
+
+#endif
@@ -39,6 +39,7 @@ enum {
   l_throttle_put,
   l_throttle_put_sum,
   l_throttle_wait,
+  l_throttle_get_fast,
   l_throttle_last,
 };
 
@@ -66,6 +67,7 @@ Throttle::Throttle(CephContext *cct, const std::string& n, int64_t m,
     b.add_u64_counter(l_throttle_put, "put", "Puts");
     b.add_u64_counter(l_throttle_put_sum, "put_sum", "Put data");
     b.add_time_avg(l_throttle_wait, "wait", "Waiting latency");
+    b.add_u64_counter(l_throttle_get_fast, "get_fast", "Gets that did not take the lock");
 
     logger = { b.create_perf_counters(), cct };
     cct->get_perfcounters_collection()->add(logger.get());
@@ -97,9 +99,13 @@ bool Throttle::_wait(int64_t c, std::unique_lock<std::mutex>& l)
   bool waited = false;
   if (_should_wait(c) || !conds.empty()) { // always wait behind other waiters.
     {
+      // announced before the count is checked again, so that a put that
+      // takes no lock either sees this waiter or leaves room for it
+      ++waiters;
       auto cv = conds.emplace(conds.end());
       auto w = make_scope_guard([this, cv]() {
 	  conds.erase(cv);
+	  --waiters;
 	});
       waited = true;
       ldout(cct, 2) << "_wait waiting..." << dendl;
@@ -120,6 +126,25 @@ bool Throttle::_wait(int64_t c, std::unique_lock<std::mutex>& l)
   return waited;
 }
 
+bool Throttle::_try_get(int64_t c)
+{
+  if (waiters) {
+    return false;
+  }
+  return _claim(c);
+}
+
+bool Throttle::_claim(int64_t c)
+{
+  int64_t cur = count;
+  while (!_should_wait(c, cur)) {
+    if (count.compare_exchange_weak(cur, cur + c)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool Throttle::wait(int64_t m)
 {
   if (0 == max && 0 == m) {
@@ -163,6 +188,15 @@ bool Throttle::get(int64_t c, int64_t m)
   if (logger) {
     logger->inc(l_throttle_get_started);
   }
+  if ((m == 0 || m == max) && _try_get(c)) {
+    if (logger) {
+      logger->inc(l_throttle_get_fast);
+      logger->inc(l_throttle_get);
+      logger->inc(l_throttle_get_sum, c);
+      logger->set(l_throttle_val, count);
+    }
+    return false;
+  }
   bool waited = false;
   {
     std::unique_lock l(lock);
@@ -170,8 +204,11 @@ bool Throttle::get(int64_t c, int64_t m)
       ceph_assert(m > 0);
       _reset_max(m);
     }
-    waited = _wait(c, l);
-    count += c;
+    // a lockless get may take the room between _wait() and the claim;
+    // queue up again if it did
+    do {
+      waited |= _wait(c, l);
+    } while (!_claim(c));
   }
   if (logger) {
     logger->inc(l_throttle_get);
@@ -192,18 +229,12 @@ bool Throttle::get_or_fail(int64_t c)
   }
 
   assert (c >= 0);
-  bool result = false;
-  {
-    std::lock_guard l(lock);
-    if (_should_wait(c) || !conds.empty()) {
-      ldout(cct, 10) << "get_or_fail " << c << " failed" << dendl;
-      result = false;
-    } else {
-      ldout(cct, 10) << "get_or_fail " << c << " success (" << count.load()
-	<< " -> " << (count.load() + c) << ")" << dendl;
-      count += c;
-      result = true;
-    }
+  bool result = _try_get(c);
+  if (result) {
+    ldout(cct, 10) << "get_or_fail " << c << " success (" << count.load()
+      << ")" << dendl;
+  } else {
+    ldout(cct, 10) << "get_or_fail " << c << " failed" << dendl;
   }
 
   if (logger) {
@@ -229,17 +260,13 @@ int64_t Throttle::put(int64_t c)
   ceph_assert(c >= 0);
   ldout(cct, 10) << "put " << c << " (" << count.load() << " -> "
 		 << (count.load()-c) << ")" << dendl;
-  int64_t new_count;
-  {
+  int64_t new_count = count -= c;
+  // if count goes negative, we failed somewhere!
+  ceph_assert(new_count >= 0);
+  if (c && waiters) {
     std::lock_guard l(lock);
-    new_count = count;
-    if (c) {
-      if (!conds.empty())
-	conds.front().notify_one();
-      // if count goes negative, we failed somewhere!
-      ceph_assert(count >= c);
-      new_count = count -= c;
-    }
+    if (!conds.empty())
+      conds.front().notify_one();
   }
   if (logger) {
     logger->inc(l_throttle_put);
@@ -36,6 +36,9 @@ class Throttle final : public ThrottleInterface {
   std::atomic<int64_t> count = { 0 }, max = { 0 };
   std::mutex lock;
   std::list<std::condition_variable> conds;
+  /// size of conds, readable without the lock. gets and puts skip the lock
+  /// while nobody waits
+  std::atomic<unsigned> waiters = { 0 };
   const bool use_perf;
 
 public:
@@ -45,8 +48,10 @@ public:
 private:
   void _reset_max(int64_t m);
   bool _should_wait(int64_t c) const {
+    return _should_wait(c, count);
+  }
+  bool _should_wait(int64_t c, int64_t cur) const {
     int64_t m = max;
-    int64_t cur = count;
     return
       m &&
       ((c <= m && cur + c > m) || // normally stay under max
@@ -54,6 +59,10 @@ private:
   }
 
   bool _wait(int64_t c, std::unique_lock<std::mutex>& l);
+  /// take c slots if that doesn't make anyone wait, without the lock
+  bool _try_get(int64_t c);
+  /// take c slots if they are free, racing with _try_get()
+  bool _claim(int64_t c);
 
 public:
   /**
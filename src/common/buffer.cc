@@ -51,7 +51,9 @@ using std::string;
 using namespace ceph;
 
 #define CEPH_BUFFER_ALLOC_UNIT  4096u
-#define CEPH_BUFFER_APPEND_SIZE (CEPH_BUFFER_ALLOC_UNIT - sizeof(raw_combined))
+// sized so that append buffers fill a whole page, or a whole slab block
+#define CEPH_BUFFER_APPEND_SIZE \
+  (CEPH_BUFFER_ALLOC_UNIT - std::max(sizeof(raw_combined), sizeof(raw_slab)))
 
 // 256K is the maximum "small" object size in tcmalloc above which allocations come from
 // the central heap.  For now let's keep this below that threshold.
@@ -86,6 +88,246 @@ static ceph::spinlock debug_lock;
     return buffer_missed_crc;
   }
 
+  /*
+   * buffer_slab is a per-thread cache of the single allocations behind
+   * small raw buffers (see raw_slab below), so that the headers, footers
+   * and small payloads the messengers churn through are recycled without
+   * a trip through the allocator.  Blocks come in power-of-two size
+   * classes.  A block freed by the thread that allocated it goes back on
+   * that thread's free list; one freed elsewhere is pushed onto its owner's
+   * lock-free remote list and picked up the next time the owner runs dry.
+   * Idle blocks are accounted in mempool_buffer_slab.
+   *
+   * A cache outlives its thread for as long as any of its blocks are
+   * handed out: nref counts the thread plus every block that is in use
+   * or sitting on the remote list.
+   */
+  namespace {
+  class buffer_slab {
+  public:
+    static constexpr size_t MIN_BLOCK = 256;
+    static constexpr unsigned NUM_CLASSES = 5;
+    static constexpr size_t MAX_BLOCK = MIN_BLOCK << (NUM_CLASSES - 1);
+    static constexpr size_t BLOCK_ALIGN = 64;
+    /// idle blocks kept per thread and size class
+    static constexpr unsigned MAX_CACHED = 128;
+
+    struct cache;
+
+    static int size_class(size_t size) {
+      if (size > MAX_BLOCK) {
+	return -1;
+      }
+      int cls = 0;
+      for (size_t s = MIN_BLOCK; s < size; s <<= 1) {
+	++cls;
+      }
+      return cls;
+    }
+    static size_t block_size(unsigned cls) {
+      return MIN_BLOCK << cls;
+    }
+
+    /// a block of block_size(cls) bytes, or nullptr if this thread has
+    /// no cache (it is exiting)
+    static char *alloc(unsigned cls, cache **owner);
+    static void free(char *block, cache *owner, unsigned cls);
+
+  private:
+    struct free_block {
+      free_block *next;
+      unsigned cls;
+    };
+
+    struct thread_cache {
+      cache *c = nullptr;
+      ~thread_cache();
+    };
+    static thread_local thread_cache tls;
+    // trivially destructible, so still readable while the thread exits
+    static thread_local bool tls_gone;
+
+    static void account(int blocks, ssize_t bytes) {
+      mempool::get_pool(mempool::mempool_buffer_slab).adjust_count(
+	blocks, bytes);
+    }
+    static void release(free_block *b) {
+      account(-1, -(ssize_t)block_size(b->cls));
+      aligned_free(b);
+    }
+    static unsigned release_remote(cache *c);
+  };
+
+  struct buffer_slab::cache {
+    free_block *local[NUM_CLASSES] = {};
+    unsigned num_local[NUM_CLASSES] = {};
+    std::atomic<free_block*> remote = {nullptr};
+    std::atomic<uint64_t> nref = {1};
+    std::atomic<bool> exited = {false};
+
+    void put(uint64_t n = 1) {
+      if (n && nref.fetch_sub(n) == n) {
+	delete this;
+      }
+    }
+    bool push_local(free_block *b) {
+      if (num_local[b->cls] >= MAX_CACHED) {
+	return false;
+      }
+      b->next = local[b->cls];
+      local[b->cls] = b;
+      ++num_local[b->cls];
+      return true;
+    }
+  };
+
+  thread_local buffer_slab::thread_cache buffer_slab::tls;
+  thread_local bool buffer_slab::tls_gone = false;
+
+  buffer_slab::thread_cache::~thread_cache()
+  {
+    if (!c) {
+      return;
+    }
+    tls_gone = true;
+    c->exited = true;
+    for (unsigned cls = 0; cls < NUM_CLASSES; ++cls) {
+      while (free_block *b = c->local[cls]) {
+	c->local[cls] = b->next;
+	release(b);
+      }
+    }
+    // blocks freed remotely from now on are released by whoever frees them
+    c->put(release_remote(c) + 1);
+    c = nullptr;
+  }
+
+  unsigned buffer_slab::release_remote(cache *c)
+  {
+    unsigned n = 0;
+    free_block *b = c->remote.exchange(nullptr);
+    while (b) {
+      free_block *next = b->next;
+      release(b);
+      b = next;
+      ++n;
+    }
+    return n;
+  }
+
+  char *buffer_slab::alloc(unsigned cls, cache **owner)
+  {
+    if (tls_gone) {
+      return nullptr;
+    }
+    cache *c = tls.c;
+    if (!c) {
+      c = tls.c = new cache;
+    }
+    if (!c->local[cls] && c->remote.load(std::memory_order_relaxed)) {
+      // bring home what other threads freed
+      unsigned n = 0;
+      free_block *b = c->remote.exchange(nullptr, std::memory_order_acquire);
+      while (b) {
+	free_block *next = b->next;
+	if (!c->push_local(b)) {
+	  release(b);
+	}
+	b = next;
+	++n;
+      }
+      c->nref.fetch_sub(n, std::memory_order_relaxed);
+    }
+    char *block;
+    if (free_block *b = c->local[cls]) {
+      c->local[cls] = b->next;
+      --c->num_local[cls];
+      account(-1, -(ssize_t)block_size(cls));
+      block = (char*)b;
+    } else {
+      int r = ::posix_memalign((void**)(void*)&block, BLOCK_ALIGN,
+			       block_size(cls));
+      if (r) {
+	throw buffer::bad_alloc();
+      }
+    }
+    c->nref.fetch_add(1, std::memory_order_relaxed);
+    *owner = c;
+    return block;
+  }
+
+  void buffer_slab::free(char *block, cache *owner, unsigned cls)
+  {
+    free_block *b = (free_block*)block;
+    b->cls = cls;
+    account(1, block_size(cls));
+    if (!tls_gone && tls.c == owner) {
+      if (!owner->push_local(b)) {
+	release(b);
+      }
+      owner->nref.fetch_sub(1, std::memory_order_relaxed);
+      return;
+    }
+    // hold a ref of our own: once b is on the list, whoever drains it
+    // may drop the last of the block refs
+    owner->nref.fetch_add(1, std::memory_order_relaxed);
+    b->next = owner->remote.load(std::memory_order_relaxed);
+    while (!owner->remote.compare_exchange_weak(b->next, b)) ;
+    if (owner->exited) {
+      owner->put(release_remote(owner));
+    }
+    owner->put();
+  }
+  } // anonymous namespace
+
+  static bool buffer_use_slab = get_env_bool("CEPH_BUFFER_SLAB");
+
+  void buffer::use_slab(bool b) {
+    buffer_use_slab = b;
+  }
+
+  /*
+   * raw_slab is the raw_combined layout, data first and the control
+   * block at the end, in a block from the allocating thread's buffer_slab.
+   */
+  class raw_slab : public buffer::raw {
+    buffer_slab::cache *owner;
+    unsigned cls;
+
+    raw_slab(char *dataptr, unsigned l, int mempool,
+	     buffer_slab::cache *owner, unsigned cls)
+      : raw(dataptr, l, mempool), owner(owner), cls(cls) {
+    }
+
+  public:
+    /// nullptr if len or align does not fit a slab block
+    static ceph::unique_leakable_ptr<buffer::raw>
+    create(unsigned len, unsigned align, int mempool)
+    {
+      if (align > buffer_slab::BLOCK_ALIGN) {
+	return nullptr;
+      }
+      size_t rawlen = round_up_to(sizeof(raw_slab), alignof(raw_slab));
+      size_t datalen = round_up_to(len, alignof(raw_slab));
+      int cls = buffer_slab::size_class(rawlen + datalen);
+      if (cls < 0) {
+	return nullptr;
+      }
+      buffer_slab::cache *owner;
+      char *ptr = buffer_slab::alloc(cls, &owner);
+      if (!ptr) {
+	return nullptr;
+      }
+      return ceph::unique_leakable_ptr<buffer::raw>(
+	new (ptr + datalen) raw_slab(ptr, len, mempool, owner, cls));
+    }
+
+    static void operator delete(void *ptr) {
+      raw_slab *raw = (raw_slab *)ptr;
+      buffer_slab::free(raw->data, raw->owner, raw->cls);
+    }
+  };
+
   /*
    * raw_combined is always placed within a single allocation along
    * with the data buffer.  the data goes at the beginning, and
@@ -125,6 +367,11 @@ static ceph::spinlock debug_lock;
 	   unsigned align,
 	   int mempool = mempool::mempool_buffer_anon)
     {
+      if (buffer_use_slab) {
+	if (auto r = raw_slab::create(len, align, mempool); r) {
+	  return r;
+	}
+      }
       const auto [ptr, datalen] = alloc_data_n_controlblock(len, align);
       // actual data first, since it has presumably larger alignment restriction
       // then put the raw_combined at the end
@@ -2081,12 +2328,59 @@ __u32 buffer::list::crc32c(__u32 crc) const
   int cache_hits = 0;
   int cache_adjusts = 0;
 
+  // Uncached buffers no smaller than this are gathered up and their crcs
+  // computed side by side, each from 0, then chained in with
+  // ceph_crc32c_combine().  That only wins where both are accelerated.
+  static constexpr unsigned MULTI_MIN_LEN = 64;
+  static constexpr unsigned MULTI_WIDTH = 3;
+  const bool multi = _num > 1 && ceph_crc32c_multi_accelerated();
+  const ptr_node* pending[MULTI_WIDTH];
+  unsigned num_pending = 0;
+  auto flush_pending = [&] {
+    uint32_t crcs[MULTI_WIDTH] = {};
+    unsigned char const *data[MULTI_WIDTH];
+    unsigned lens[MULTI_WIDTH];
+    for (unsigned i = 0; i < num_pending; ++i) {
+      data[i] = (unsigned char*)pending[i]->c_str();
+      lens[i] = pending[i]->length();
+    }
+    const bool full = num_pending == MULTI_WIDTH;
+    if (full) {
+      ceph_crc32c_multi(crcs, data, lens, num_pending);
+    }
+    for (unsigned i = 0; i < num_pending; ++i) {
+      const ptr_node& node = *pending[i];
+      uint32_t base = crc;
+      if (full) {
+	crc = ceph_crc32c_combine(crc, crcs[i], lens[i]);
+      } else {
+	crc = ceph_crc32c(crc, data[i], lens[i]);
+      }
+      node._raw->set_crc(
+	make_pair(node.offset(), node.offset() + node.length()),
+	make_pair(base, crc));
+    }
+    cache_misses += num_pending;
+    num_pending = 0;
+  };
+
   for (const auto& node : _buffers) {
     if (node.length()) {
       raw* const r = node._raw;
       pair<size_t, size_t> ofs(node.offset(), node.offset() + node.length());
       pair<uint32_t, uint32_t> ccrc;
-      if (r->get_crc(ofs, &ccrc)) {
+      const bool cached = r->get_crc(ofs, &ccrc);
+      if (multi && !cached && node.length() >= MULTI_MIN_LEN) {
+	pending[num_pending++] = &node;
+	if (num_pending == MULTI_WIDTH) {
+	  flush_pending();
+	}
+	continue;
+      }
+      if (num_pending) {
+	flush_pending();
+      }
+      if (cached) {
 	if (ccrc.first == crc) {
 	  // got it already
 	  crc = ccrc.second;
@@ -2111,6 +2405,9 @@ __u32 buffer::list::crc32c(__u32 crc) const
       }
     }
   }
+  if (num_pending) {
+    flush_pending();
+  }
 
   if (buffer_track_crc) {
     if (cache_adjusts)
@@ -2133,6 +2430,19 @@ void buffer::list::invalidate_crc()
   }
 }
 
+void buffer::list::set_crc32c(uint32_t seed, uint32_t crc)
+{
+  if (_num != 1) {
+    return;
+  }
+  const auto& node = _buffers.front();
+  if (node._raw && node.length()) {
+    node._raw->set_crc(
+      make_pair(node.offset(), node.offset() + node.length()),
+      make_pair(seed, crc));
+  }
+}
+
 /**
  * Binary write all contents to a C++ stream
  */
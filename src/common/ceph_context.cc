@@ -44,6 +44,8 @@
 #include "common/Graylog.h"
 #ifdef CEPH_DEBUG_MUTEX
 #include "common/lockdep.h"
+#elif !defined(WITH_CRIMSON)
+#include "common/mutex_contention.h"
 #endif
 
 #include "log/Log.h"
@@ -204,6 +206,70 @@ public:
   }
 };
 
+#ifndef CEPH_DEBUG_MUTEX
+class MutexContentionObs : public md_config_obs_t,
+			   public AdminSocketHook {
+  CephContext *cct;
+
+public:
+  explicit MutexContentionObs(CephContext *cct)
+    : cct(cct) {
+    cct->_conf.add_observer(this);
+    int r = cct->get_admin_socket()->register_command(
+      "dump_mutex_contention",
+      this,
+      "dump adaptive mutex wait and hold time histograms");
+    ceph_assert(r == 0);
+    r = cct->get_admin_socket()->register_command(
+      "reset_mutex_contention",
+      this,
+      "reset adaptive mutex contention stats");
+    ceph_assert(r == 0);
+    ceph::adaptive_mutex::set_spin_count(cct->_conf->mutex_spin_count);
+    ceph::adaptive_mutex::set_profiling(cct->_conf->mutex_contention_profile);
+  }
+  ~MutexContentionObs() override {
+    cct->_conf.remove_observer(this);
+    cct->get_admin_socket()->unregister_commands(this);
+  }
+
+  // md_config_obs_t
+  std::vector<std::string> get_tracked_keys() const noexcept override {
+    return {"mutex_spin_count"s, "mutex_contention_profile"s};
+  }
+
+  void handle_conf_change(const ConfigProxy& conf,
+                          const std::set <std::string> &changed) override {
+    if (changed.count("mutex_spin_count")) {
+      ceph::adaptive_mutex::set_spin_count(conf->mutex_spin_count);
+    }
+    if (changed.count("mutex_contention_profile")) {
+      ceph::adaptive_mutex::set_profiling(conf->mutex_contention_profile);
+    }
+  }
+
+  // AdminSocketHook
+  int call(std::string_view command, const cmdmap_t& cmdmap,
+	   const bufferlist& inbl,
+	   ceph::Formatter *f,
+	   std::ostream& errss,
+	   bufferlist& out) override {
+    if (command == "dump_mutex_contention") {
+      f->open_object_section("mutex_contention");
+      f->dump_bool("enabled", cct->_conf->mutex_contention_profile);
+      ceph::mutex_contention::dump(f);
+      f->close_section();
+      return 0;
+    }
+    if (command == "reset_mutex_contention") {
+      ceph::mutex_contention::reset();
+      return 0;
+    }
+    return -ENOSYS;
+  }
+};
+#endif // CEPH_DEBUG_MUTEX
+
 } // anonymous namespace
 
 namespace ceph::common {
@@ -787,6 +853,10 @@ CephContext::CephContext(uint32_t module_type_,
   _crypto_random.reset(new CryptoRandom());
 
   lookup_or_create_singleton_object<MempoolObs>("mempool_obs", false, this);
+#ifndef CEPH_DEBUG_MUTEX
+  lookup_or_create_singleton_object<MutexContentionObs>(
+    "mutex_contention_obs", false, this);
+#endif
 }
 
 void CephContext::modify_msgr_hook(
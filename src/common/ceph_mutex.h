@@ -66,7 +66,9 @@ namespace ceph {
   using mutex = dummy_mutex;
   using recursive_mutex = dummy_mutex;
   using shared_mutex = dummy_shared_mutex;
+  using adaptive_mutex = dummy_mutex;
   using condition_variable = green_condition_variable;
+  using adaptive_condition_variable = green_condition_variable;
 
   template <typename ...Args>
   dummy_mutex make_mutex(Args&& ...args) {
@@ -83,6 +85,11 @@ namespace ceph {
     return {};
   }
 
+  template <typename ...Args>
+  adaptive_mutex make_adaptive_mutex(Args&& ...args) {
+    return {};
+  }
+
   #define ceph_mutex_is_locked(m) true
   #define ceph_mutex_is_locked_by_me(m) true
 }
@@ -111,6 +118,9 @@ namespace ceph {
   typedef ceph::mutex_recursive_debug recursive_mutex;
   typedef ceph::condition_variable_debug condition_variable;
   typedef ceph::shared_mutex_debug shared_mutex;
+  // lockdep already instruments every lock, so no spinning here
+  typedef ceph::mutex_debug adaptive_mutex;
+  typedef ceph::condition_variable_debug adaptive_condition_variable;
 
   // pass arguments to mutex_debug ctor
   template <typename ...Args>
@@ -130,6 +140,12 @@ namespace ceph {
     return {std::forward<Args>(args)...};
   }
 
+  // pass arguments to mutex_debug ctor
+  template <typename ...Args>
+  adaptive_mutex make_adaptive_mutex(Args&& ...args) {
+    return {std::forward<Args>(args)...};
+  }
+
   // debug methods
   #define ceph_mutex_is_locked(m) ((m).is_locked())
   #define ceph_mutex_is_not_locked(m) (!(m).is_locked())
@@ -145,8 +161,11 @@ namespace ceph {
 // release (fast and minimal)
 // ============================================================================
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
+#include <string_view>
 
 // The winpthreads shared mutex implementation is broken.
 // We'll use boost::shared_mutex instead.
@@ -163,6 +182,65 @@ namespace ceph {
   typedef std::recursive_mutex recursive_mutex;
   typedef std::condition_variable condition_variable;
 
+  struct mutex_contention_stats;
+
+  // A mutex for short, hot critical sections.  A contended lock() spins
+  // with exponential backoff for up to mutex_spin_count pause iterations
+  // before sleeping in the kernel.  While mutex_contention_profile is
+  // on, wait and hold times are recorded per mutex name; see
+  // common/mutex_contention.h.
+  class adaptive_mutex {
+  public:
+    explicit adaptive_mutex(std::string_view name);
+    adaptive_mutex(const adaptive_mutex&) = delete;
+    adaptive_mutex& operator=(const adaptive_mutex&) = delete;
+
+    void lock() {
+      if (!m.try_lock()) {
+        _lock_contended();
+      } else if (profiling.load(std::memory_order_relaxed)) {
+        _note_locked(0);
+      }
+    }
+    bool try_lock() {
+      if (!m.try_lock()) {
+        return false;
+      }
+      if (profiling.load(std::memory_order_relaxed)) {
+        _note_locked(0);
+      }
+      return true;
+    }
+    void unlock() {
+      if (locked_at) {
+        _note_unlock();
+      }
+      m.unlock();
+    }
+
+    static void set_spin_count(unsigned n) {
+      spin_count.store(n, std::memory_order_relaxed);
+    }
+    static void set_profiling(bool on) {
+      profiling.store(on, std::memory_order_relaxed);
+    }
+
+  private:
+    static inline std::atomic<unsigned> spin_count = 100;
+    static inline std::atomic<bool> profiling = false;
+
+    std::mutex m;
+    mutex_contention_stats *stats;
+    uint64_t locked_at = 0;  ///< ns, if profiled; protected by m
+
+    void _lock_contended();
+    void _note_locked(uint64_t wait_start);
+    void _note_unlock();
+  };
+  // wait() drops the lock through adaptive_mutex::unlock(), so hold
+  // times do not include the time spent waiting
+  typedef std::condition_variable_any adaptive_condition_variable;
+
 #if defined(__MINGW32__) && !defined(__clang__)
   typedef boost::shared_mutex shared_mutex;
 #else
@@ -182,6 +260,11 @@ namespace ceph {
   shared_mutex make_shared_mutex(Args&& ...args) {
     return {};
   }
+  // keep only the name, which contention stats are grouped by
+  template <typename ...Args>
+  adaptive_mutex make_adaptive_mutex(std::string_view name, Args&& ...args) {
+    return adaptive_mutex{name};
+  }
 
   // debug methods.  Note that these can blindly return true
   // because any code that does anything other than assert these
@@ -9,6 +9,7 @@
 #include "arch/s390x.h"
 #include "common/sctp_crc32.h"
 #include "common/crc32c_intel_fast.h"
+#include "common/crc32c_intel_clmul.h"
 #include "common/crc32c_aarch64.h"
 #include "common/crc32c_ppc.h"
 #include "common/crc32c_s390x.h"
@@ -222,8 +223,38 @@ static uint32_t crc_turbo_table[32][32] =
      0x00010000, 0x00020000, 0x00040000, 0x00080000, 0x00100000, 0x00200000, 0x00400000, 0x00800000}
 };
 
+int ceph_crc32c_multi_accelerated(void)
+{
+#if defined(__x86_64__)
+  return ceph_arch_intel_sse42 && ceph_arch_intel_pclmul;
+#else
+  return 0;
+#endif
+}
+
+void ceph_crc32c_multi(uint32_t *crc, unsigned char const **data,
+                       unsigned const *length, unsigned count)
+{
+  unsigned i = 0;
+#if defined(__x86_64__)
+  if (ceph_arch_intel_sse42) {
+    for (; i + 3 <= count; i += 3) {
+      ceph_crc32c_intel_multi3(crc + i, data + i, length + i);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    crc[i] = ceph_crc32c_func(crc[i], data[i], length[i]);
+  }
+}
+
 uint32_t ceph_crc32c_zeros(uint32_t crc, unsigned len)
 {
+#if defined(__x86_64__)
+  if (ceph_arch_intel_sse42 && ceph_arch_intel_pclmul) {
+    return ceph_crc32c_intel_zeros_clmul(crc, len);
+  }
+#endif
   int range = 0;
   unsigned remainder = len & 15;
   len = len >> 4;
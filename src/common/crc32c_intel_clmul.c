@@ -0,0 +1,103 @@
+#include "common/crc32c_intel_clmul.h"
+
+#ifdef __x86_64__
+
+#include <string.h>
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+
+/*
+ * With K = x^(n-33) mod P (bit-reflected), the crc32 instruction reduces
+ * the 64-bit carry-less product crc * K to crc * x^n mod P, which is what
+ * running the crc register over n zero bits does.  Entry i holds K for
+ * n = 64 << i, i.e. for 8 << i zero bytes.
+ */
+static const uint32_t crc32c_clmul_shift[29] = {
+	0x00000001, 0x493c7d27, 0xba4fc28e, 0x9e4addf8,
+	0x0d3b6092, 0xb9e02b86, 0xdd7e3b0c, 0x170076fa,
+	0xa51b6135, 0x82f89c77, 0x54a86326, 0x1dc403cc,
+	0x5ae703ab, 0xc5013a36, 0xac2ac6dd, 0x9b4615a9,
+	0x688d1c61, 0xf6af14e6, 0xb6ffe386, 0xb717425b,
+	0x478b0d30, 0x54cc62e5, 0x7b2102ee, 0x8a99adef,
+	0xa7568c8f, 0xd610d67e, 0x6b086b3f, 0xd94f3c0b,
+	0xbf818109,
+};
+
+__attribute__((target("sse4.2,pclmul")))
+static inline uint32_t crc32c_clmul_mul(uint32_t crc, uint32_t k)
+{
+	__m128i p = _mm_clmulepi64_si128(_mm_cvtsi32_si128(crc),
+					 _mm_cvtsi32_si128(k), 0);
+	return _mm_crc32_u64(0, _mm_cvtsi128_si64(p));
+}
+
+__attribute__((target("sse4.2,pclmul")))
+uint32_t ceph_crc32c_intel_zeros_clmul(uint32_t crc, unsigned len)
+{
+	const uint32_t *k = crc32c_clmul_shift;
+
+	if (len & 1)
+		crc = _mm_crc32_u8(crc, 0);
+	if (len & 2)
+		crc = _mm_crc32_u16(crc, 0);
+	if (len & 4)
+		crc = _mm_crc32_u32(crc, 0);
+	for (len >>= 3; len; len >>= 1, k++) {
+		if (len & 1)
+			crc = crc32c_clmul_mul(crc, *k);
+	}
+	return crc;
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_tail(uint64_t crc, unsigned char const *p, unsigned len)
+{
+	uint64_t v;
+
+	while (len >= 8) {
+		memcpy(&v, p, 8);
+		crc = _mm_crc32_u64(crc, v);
+		p += 8;
+		len -= 8;
+	}
+	while (len--)
+		crc = _mm_crc32_u8(crc, *p++);
+	return crc;
+}
+
+/*
+ * The crc32 instruction has a latency of three cycles and a throughput
+ * of one, so a single dependent chain leaves two thirds of it idle.
+ * Feeding three buffers in lockstep keeps it busy; whatever is left of
+ * the longer buffers is finished one at a time.
+ */
+__attribute__((target("sse4.2")))
+void ceph_crc32c_intel_multi3(uint32_t crc[3],
+			      unsigned char const *buffer[3],
+			      unsigned const len[3])
+{
+	uint64_t c0 = crc[0], c1 = crc[1], c2 = crc[2];
+	unsigned char const *p0 = buffer[0], *p1 = buffer[1], *p2 = buffer[2];
+	unsigned n = len[0];
+	unsigned i;
+	uint64_t v0, v1, v2;
+
+	if (len[1] < n)
+		n = len[1];
+	if (len[2] < n)
+		n = len[2];
+	n &= ~7u;
+	for (i = 0; i < n; i += 8) {
+		memcpy(&v0, p0 + i, 8);
+		memcpy(&v1, p1 + i, 8);
+		memcpy(&v2, p2 + i, 8);
+		c0 = _mm_crc32_u64(c0, v0);
+		c1 = _mm_crc32_u64(c1, v1);
+		c2 = _mm_crc32_u64(c2, v2);
+	}
+	crc[0] = crc32c_tail(c0, p0 + n, len[0] - n);
+	crc[1] = crc32c_tail(c1, p1 + n, len[1] - n);
+	crc[2] = crc32c_tail(c2, p2 + n, len[2] - n);
+}
+
+#endif
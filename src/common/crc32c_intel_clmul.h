@@ -0,0 +1,39 @@
+#ifndef CEPH_COMMON_CRC32C_INTEL_CLMUL_H
+#define CEPH_COMMON_CRC32C_INTEL_CLMUL_H
+
+#include "include/int_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __x86_64__
+
+/* crc32c of len zero bytes, using sse4.2 crc32 and pclmulqdq */
+extern uint32_t ceph_crc32c_intel_zeros_clmul(uint32_t crc, unsigned len);
+
+/* crc32c of three independent buffers, interleaved on the crc32 unit */
+extern void ceph_crc32c_intel_multi3(uint32_t crc[3],
+				     unsigned char const *buffer[3],
+				     unsigned const len[3]);
+
+#else
+
+static inline uint32_t ceph_crc32c_intel_zeros_clmul(uint32_t crc, unsigned len)
+{
+	return 0;
+}
+
+static inline void ceph_crc32c_intel_multi3(uint32_t crc[3],
+					    unsigned char const *buffer[3],
+					    unsigned const len[3])
+{
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -13,6 +13,8 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <functional>
 
@@ -143,6 +145,35 @@ const dmc::ClientInfo *ClientRegistry::get_info(
   }
 }
 
+bool CapacityEstimator::maybe_close_window(ceph::mono_time now,
+					   double interval)
+{
+  if (ceph::mono_clock::is_zero(window_start)) {
+    window_start = now;
+    return false;
+  }
+  double elapsed = ceph::to_seconds<double>(now - window_start);
+  if (elapsed < interval || elapsed <= 0) {
+    return false;
+  }
+
+  achieved.clear();
+  for (auto &[c, cost] : window_cost) {
+    achieved[c] = cost / elapsed;
+  }
+  bool sampled = window_saturated && window_total > 0;
+  if (sampled) {
+    double measured = window_total / elapsed;
+    estimate = estimate ? (1 - alpha) * estimate + alpha * measured : measured;
+  }
+
+  window_start = now;
+  window_total = 0.0;
+  window_saturated = true;
+  window_cost.clear();
+  return sampled;
+}
+
 static std::ostream &operator<<(
   std::ostream &lhs, const profile_t::client_config_t &rhs)
 {
@@ -185,9 +216,13 @@ void MclockConfig::set_from_config()
 
   osd_bandwidth_cost_per_io =
     static_cast<double>(osd_bandwidth_capacity) / osd_iop_capacity;
-  osd_bandwidth_capacity_per_shard =
+  configured_capacity_per_shard =
     static_cast<double>(osd_bandwidth_capacity) /
     static_cast<double>(num_shards);
+  osd_bandwidth_capacity_per_shard = configured_capacity_per_shard;
+  adaptive_capacity = cct->_conf.get_val<bool>("osd_mclock_adaptive_capacity");
+  adaptive_capacity_interval =
+    cct->_conf.get_val<double>("osd_mclock_adaptive_capacity_interval");
   dout(1) << __func__ << ": osd_bandwidth_cost_per_io: "
           << std::fixed << std::setprecision(2)
           << osd_bandwidth_cost_per_io << " bytes/io"
@@ -233,10 +268,84 @@ void MclockConfig::set_from_config()
     ceph_assert("Invalid choice of mclock profile" == 0);
     return;
   }
+  if (adaptive_capacity && capacity_estimator.get_estimate() > 0) {
+    apply_capacity(capacity_estimator.get_estimate());
+  } else {
+    client_registry.update_from_profile(
+      current_profile, osd_bandwidth_capacity_per_shard);
+  }
+}
+
+void MclockConfig::apply_capacity(double capacity_per_shard)
+{
+  // don't let a skewed sample (e.g. a burst of cache hits) move the
+  // allocations too far from what the device was benchmarked at
+  capacity_per_shard = std::clamp(capacity_per_shard,
+				  configured_capacity_per_shard / 4,
+				  configured_capacity_per_shard * 4);
+  dout(10) << __func__ << ": capacity per shard "
+	   << std::fixed << std::setprecision(2)
+	   << osd_bandwidth_capacity_per_shard << " -> "
+	   << capacity_per_shard << " bytes/second" << dendl;
+  osd_bandwidth_capacity_per_shard = capacity_per_shard;
   client_registry.update_from_profile(
     current_profile, osd_bandwidth_capacity_per_shard);
 }
 
+void MclockConfig::note_dequeue(scheduler_id_t id, uint32_t cost,
+				bool backlogged)
+{
+  capacity_estimator.note_dequeue(id.class_id, cost, backlogged);
+  if (!capacity_estimator.maybe_close_window(
+	ceph::mono_clock::now(), adaptive_capacity_interval) ||
+      !adaptive_capacity) {
+    return;
+  }
+  // only re-derive the allocations if the estimate moved noticeably
+  double estimate = capacity_estimator.get_estimate();
+  if (std::abs(estimate - osd_bandwidth_capacity_per_shard) >
+      osd_bandwidth_capacity_per_shard / 20) {
+    apply_capacity(estimate);
+  }
+}
+
+void MclockConfig::note_throttled()
+{
+  capacity_estimator.note_throttled();
+}
+
+void MclockConfig::dump(ceph::Formatter &f) const
+{
+  // 0 for a limit means none, as in the profiles
+  auto rate = [](double r) {
+    return std::isinf(r) ? 0.0 : r;
+  };
+  f.open_object_section("capacity");
+  f.dump_bool("adaptive", adaptive_capacity);
+  f.dump_float("configured_per_shard", configured_capacity_per_shard);
+  f.dump_float("estimated_per_shard", capacity_estimator.get_estimate());
+  f.dump_float("in_use_per_shard", osd_bandwidth_capacity_per_shard);
+  f.close_section();
+
+  f.open_array_section("classes");
+  for (auto [c, name] : {
+	 std::pair{SchedulerClass::client, "client"},
+	 std::pair{SchedulerClass::background_recovery, "background_recovery"},
+	 std::pair{SchedulerClass::background_best_effort,
+		   "background_best_effort"}}) {
+    auto info = client_registry.get_info(
+      scheduler_id_t{c, client_profile_id_t()});
+    f.open_object_section("class");
+    f.dump_string("name", name);
+    f.dump_float("reservation", rate(info->reservation));
+    f.dump_float("weight", info->weight);
+    f.dump_float("limit", rate(info->limit));
+    f.dump_float("achieved", capacity_estimator.get_achieved(c));
+    f.close_section();
+  }
+  f.close_section();
+}
+
 void MclockConfig::init_logger()
 {
   PerfCountersBuilder m(cct, "mclock-shard-queue-" + std::to_string(shard_id),
@@ -15,8 +15,12 @@
 
 
 #pragma once
+#include <map>
+
 #include "config.h"
 #include "ceph_context.h"
+#include "ceph_time.h"
+#include "Formatter.h"
 #include "dmclock/src/dmclock_server.h"
 #ifndef WITH_CRIMSON
  #include "mon/MonClient.h"
@@ -189,6 +193,53 @@ class ClientRegistry {
       const scheduler_id_t &id) const;
 };
 
+/**
+ * CapacityEstimator
+ *
+ * Estimates the cost (bytes) per second a shard really gets through by
+ * watching what mClock hands out.  Only windows in which the queue never
+ * ran dry and mClock never held work back for a limit count as samples:
+ * only then is the dequeue rate set by how fast the OSD completes work
+ * rather than by how much work there is.  The rate each class achieved
+ * over the last window is kept as well.
+ */
+class CapacityEstimator {
+  ceph::mono_time window_start = ceph::mono_clock::zero();
+  double window_total = 0.0;
+  bool window_saturated = true;
+  std::map<SchedulerClass, double> window_cost;
+  std::map<SchedulerClass, double> achieved;  ///< cost/s over last window
+  double estimate = 0.0;                      ///< 0 until the first sample
+
+public:
+  /// weight of a new sample in the running estimate
+  static constexpr double alpha = 0.25;
+
+  /// backlogged: there was still work queued after this item
+  void note_dequeue(SchedulerClass c, uint32_t cost, bool backlogged) {
+    window_cost[c] += cost;
+    window_total += cost;
+    if (!backlogged) {
+      window_saturated = false;
+    }
+  }
+  void note_throttled() {
+    window_saturated = false;
+  }
+
+  /// close the window once it is interval seconds old; returns true if
+  /// the window was a sample and the estimate moved
+  bool maybe_close_window(ceph::mono_time now, double interval);
+
+  double get_estimate() const {
+    return estimate;
+  }
+  double get_achieved(SchedulerClass c) const {
+    auto p = achieved.find(c);
+    return p == achieved.end() ? 0.0 : p->second;
+  }
+};
+
 class MclockConfig final : public md_config_obs_t {
 private:
   CephContext *cct;
@@ -199,8 +250,15 @@ private:
   int whoami;
   double osd_bandwidth_cost_per_io = 0.0;
   double osd_bandwidth_capacity_per_shard = 0.0;
+  /// capacity per shard derived from osd_mclock_max_* alone
+  double configured_capacity_per_shard = 0.0;
+  bool adaptive_capacity = false;
+  double adaptive_capacity_interval = 0.0;
+  CapacityEstimator capacity_estimator;
   ClientRegistry& client_registry;
 
+  void apply_capacity(double capacity_per_shard);
+
   // currently active profile, will be overridden from config on startup
   // and upon config change
   profile_t current_profile = BALANCED;
@@ -223,8 +281,17 @@ public:
   void init_logger();
   void get_mclock_counter(scheduler_id_t id);
   void put_mclock_counter(scheduler_id_t id);
+  /// feed the capacity estimator with an item mClock handed out
+  void note_dequeue(scheduler_id_t id, uint32_t cost, bool backlogged);
+  /// mClock held work back because of a limit
+  void note_throttled();
   double get_cost_per_io() const;
   double get_capacity_per_shard() const;
+  double get_estimated_capacity_per_shard() const {
+    return capacity_estimator.get_estimate();
+  }
+  /// allocation vs. achieved rate of each class
+  void dump(ceph::Formatter &f) const;
   void handle_conf_change(const ConfigProxy& conf,
 			  const std::set<std::string> &changed) final;
   std::vector<std::string> get_tracked_keys() const noexcept final {
@@ -243,7 +310,9 @@ public:
       "osd_mclock_max_capacity_iops_ssd"s,
       "osd_mclock_max_sequential_bandwidth_hdd"s,
       "osd_mclock_max_sequential_bandwidth_ssd"s,
-      "osd_mclock_profile"s
+      "osd_mclock_profile"s,
+      "osd_mclock_adaptive_capacity"s,
+      "osd_mclock_adaptive_capacity_interval"s
     };
   }
   uint32_t calc_scaled_cost(int item_cost);
@@ -0,0 +1,162 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include "common/mutex_contention.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include "common/Formatter.h"
+#include "include/intarith.h"
+
+namespace ceph {
+
+namespace {
+
+std::mutex registry_lock;
+std::map<std::string, std::unique_ptr<mutex_contention_stats>, std::less<>>
+  registry;
+
+uint64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+/// longest run of pauses between two try_lock()s
+constexpr unsigned MAX_BACKOFF = 64;
+
+/// spinning only helps if the holder can run meanwhile
+const bool smp = std::thread::hardware_concurrency() > 1;
+
+} // anonymous namespace
+
+unsigned mutex_contention_stats::bucket(uint64_t ns)
+{
+  return std::min(cbits(ns), NUM_BUCKETS - 1);
+}
+
+void mutex_contention_stats::dump(ceph::Formatter *f) const
+{
+  auto dump_histogram = [f](const char *label, const auto& h) {
+    f->open_array_section(label);
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+      f->dump_unsigned("count", h[i].load(std::memory_order_relaxed));
+    }
+    f->close_section();
+  };
+  f->dump_string("name", name);
+  f->dump_unsigned("locks", locks.load(std::memory_order_relaxed));
+  f->dump_unsigned("contended", contended.load(std::memory_order_relaxed));
+  dump_histogram("wait_ns_log2", wait_ns);
+  dump_histogram("hold_ns_log2", hold_ns);
+}
+
+void mutex_contention_stats::reset()
+{
+  locks = 0;
+  contended = 0;
+  for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+    wait_ns[i] = 0;
+    hold_ns[i] = 0;
+  }
+}
+
+namespace mutex_contention {
+
+mutex_contention_stats *get(std::string_view name)
+{
+  std::lock_guard l(registry_lock);
+  auto p = registry.find(name);
+  if (p == registry.end()) {
+    p = registry.emplace(
+      std::string(name),
+      std::make_unique<mutex_contention_stats>(name)).first;
+  }
+  return p->second.get();
+}
+
+void dump(ceph::Formatter *f)
+{
+  std::lock_guard l(registry_lock);
+  f->open_array_section("mutexes");
+  for (auto& [name, stats] : registry) {
+    if (stats->locks.load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    f->open_object_section("mutex");
+    stats->dump(f);
+    f->close_section();
+  }
+  f->close_section();
+}
+
+void reset()
+{
+  std::lock_guard l(registry_lock);
+  for (auto& [name, stats] : registry) {
+    stats->reset();
+  }
+}
+
+} // namespace mutex_contention
+
+adaptive_mutex::adaptive_mutex(std::string_view name)
+  : stats(mutex_contention::get(name))
+{}
+
+void adaptive_mutex::_lock_contended()
+{
+  const bool profile = profiling.load(std::memory_order_relaxed);
+  const uint64_t start = profile ? now_ns() : 0;
+  const unsigned limit = smp ? spin_count.load(std::memory_order_relaxed) : 0;
+  bool locked = false;
+  for (unsigned spun = 0, backoff = 1; spun < limit; spun += backoff) {
+    for (unsigned i = 0; i < backoff; ++i) {
+      cpu_relax();
+    }
+    if (m.try_lock()) {
+      locked = true;
+      break;
+    }
+    backoff = std::min(backoff * 2, MAX_BACKOFF);
+  }
+  if (!locked) {
+    m.lock();
+  }
+  if (profile) {
+    stats->contended.fetch_add(1, std::memory_order_relaxed);
+    _note_locked(start);
+  }
+}
+
+void adaptive_mutex::_note_locked(uint64_t wait_start)
+{
+  locked_at = now_ns();
+  stats->locks.fetch_add(1, std::memory_order_relaxed);
+  if (wait_start) {
+    stats->wait_ns[mutex_contention_stats::bucket(locked_at - wait_start)]
+      .fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void adaptive_mutex::_note_unlock()
+{
+  stats->hold_ns[mutex_contention_stats::bucket(now_ns() - locked_at)]
+    .fetch_add(1, std::memory_order_relaxed);
+  locked_at = 0;
+}
+
+} // namespace ceph
@@ -0,0 +1,44 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "common/ceph_mutex.h"
+
+namespace ceph {
+class Formatter;
+
+/// contention seen by all ceph::adaptive_mutex instances of one name
+struct mutex_contention_stats {
+  /// bucket i counts durations in [2^(i-1), 2^i) ns; the last one is
+  /// open-ended
+  static constexpr unsigned NUM_BUCKETS = 32;
+
+  const std::string name;
+  std::atomic<uint64_t> locks = 0;      ///< profiled acquisitions
+  std::atomic<uint64_t> contended = 0;  ///< ... that had to wait
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> wait_ns = {};
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> hold_ns = {};
+
+  explicit mutex_contention_stats(std::string_view name)
+    : name(name) {}
+
+  static unsigned bucket(uint64_t ns);
+  void dump(ceph::Formatter *f) const;
+  void reset();
+};
+
+namespace mutex_contention {
+/// the stats shared by mutexes called name; never freed
+mutex_contention_stats *get(std::string_view name);
+/// dump the mutexes that have been locked while profiling was on
+void dump(ceph::Formatter *f);
+void reset();
+}
+} // namespace ceph
@@ -227,6 +227,32 @@ int set_cpu_affinity_all_threads(size_t cpu_set_size, cpu_set_t *cpu_set)
   return 0;
 }
 
+int get_numa_node_count()
+{
+  int fd = ::open("/sys/devices/system/node/online", O_RDONLY);
+  if (fd < 0) {
+    return -errno;
+  }
+  char buf[1024];
+  int r = safe_read(fd, &buf, sizeof(buf) - 1);
+  ::close(fd);
+  if (r < 0) {
+    return r;
+  }
+  buf[r] = 0;
+  while (r > 0 && ::isspace(buf[--r])) {
+    buf[r] = 0;
+  }
+  // the node list uses the same format as a cpu list
+  cpu_set_t nodes;
+  size_t count = 0;
+  r = parse_cpu_set_list(buf, &count, &nodes);
+  if (r < 0) {
+    return r;
+  }
+  return count;
+}
+
 #else
 int parse_cpu_set_list(const char *s,
 		       size_t *cpu_set_size,
@@ -260,4 +286,9 @@ int set_cpu_affinity_all_threads(size_t cpu_set_size,
   return -ENOTSUP;
 }
 
+int get_numa_node_count()
+{
+  return -ENOTSUP;
+}
+
 #endif
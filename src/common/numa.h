@@ -26,3 +26,6 @@ int get_numa_node_cpu_set(int node,
 
 int set_cpu_affinity_all_threads(size_t cpu_set_size,
 				 cpu_set_t *cpu_set);
+
+/// number of numa nodes known to the kernel (highest online node + 1)
+int get_numa_node_count();
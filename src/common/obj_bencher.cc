@@ -22,6 +22,8 @@
 #include "common/ceph_mutex.h"
 #include "common/Clock.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iomanip>
 
 #include <pthread.h>
@@ -103,6 +105,46 @@ ostream& ObjBencher::out(ostream& os)
   return out(os, cur_time);
 }
 
+void bench_latency_histogram::add(std::chrono::duration<double> latency)
+{
+  uint64_t us = std::max(latency.count(), 0.0) * 1000000;
+  size_t i;
+  if (us < 32) {
+    i = us;
+  } else {
+    // keep the 5 most significant bits
+    unsigned shift = 64 - __builtin_clzll(us) - 5;
+    i = shift * 16 + (us >> shift);
+  }
+  ++buckets[std::min(i, buckets.size() - 1)];
+  ++count;
+}
+
+double bench_latency_histogram::percentile(double p) const
+{
+  if (!count) {
+    return 0;
+  }
+  uint64_t rank = std::max<uint64_t>(1, std::ceil(p * count));
+  uint64_t seen = 0;
+  size_t i = 0;
+  for (; i < buckets.size() - 1; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      break;
+    }
+  }
+  // report the upper bound of the bucket
+  uint64_t upper;
+  if (i < 32) {
+    upper = i + 1;
+  } else {
+    unsigned shift = i / 16 - 1;
+    upper = (i % 16 + 17) << shift;
+  }
+  return upper / 1000000.0;
+}
+
 void *ObjBencher::status_printer(void *_bencher) {
   ceph_pthread_setname("OB::stat_print");
   ObjBencher *bencher = static_cast<ObjBencher *>(_bencher);
@@ -300,6 +342,7 @@ int ObjBencher::aio_bench(
   data.min_latency = 9999.0; // this better be higher than initial latency!
   data.max_latency = 0;
   data.avg_latency = 0;
+  data.latency_hist.reset();
   data.latency_diff_sum = 0;
   data.object_contents = contentsChars;
   lock.unlock();
@@ -520,6 +563,7 @@ int ObjBencher::write_bench(int secondsToRun,
       data.max_latency = data.cur_latency.count();
     if (data.cur_latency.count() < data.min_latency)
       data.min_latency = data.cur_latency.count();
+    data.latency_hist.add(data.cur_latency);
     ++data.finished;
     double delta = data.cur_latency.count() - data.avg_latency;
     data.avg_latency = total_latency / data.finished;
@@ -613,7 +657,10 @@ int ObjBencher::write_bench(int secondsToRun,
        << "Average Latency(s):     " << data.avg_latency << std::endl
        << "Stddev Latency(s):      " << latency_stddev << std::endl
        << "Max latency(s):         " << data.max_latency << std::endl
-       << "Min latency(s):         " << data.min_latency << std::endl;
+       << "Min latency(s):         " << data.min_latency << std::endl
+       << "Latency p50(s):         " << data.latency_hist.percentile(0.5) << std::endl
+       << "Latency p99(s):         " << data.latency_hist.percentile(0.99) << std::endl
+       << "Latency p99.9(s):       " << data.latency_hist.percentile(0.999) << std::endl;
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_writes_made", "%d", data.finished);
@@ -631,6 +678,9 @@ int ObjBencher::write_bench(int secondsToRun,
     formatter->dump_format("stddev_latency", "%f", latency_stddev);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    formatter->dump_format("p50_latency", "%f", data.latency_hist.percentile(0.5));
+    formatter->dump_format("p99_latency", "%f", data.latency_hist.percentile(0.99));
+    formatter->dump_format("p999_latency", "%f", data.latency_hist.percentile(0.999));
   }
   //write object size/number data for read benchmarks
   encode(data.object_size, b_write);
@@ -780,6 +830,7 @@ int ObjBencher::seq_read_bench(
       data.max_latency = data.cur_latency.count();
     if (data.cur_latency.count() < data.min_latency)
       data.min_latency = data.cur_latency.count();
+    data.latency_hist.add(data.cur_latency);
     ++data.finished;
     data.avg_latency = total_latency / data.finished;
     --data.in_flight;
@@ -834,7 +885,10 @@ int ObjBencher::seq_read_bench(
        << "Min IOPS:             " << data.idata.min_iops << std::endl
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
-       << "Min latency(s):       " << data.min_latency << std::endl;
+       << "Min latency(s):       " << data.min_latency << std::endl
+       << "Latency p50(s):       " << data.latency_hist.percentile(0.5) << std::endl
+       << "Latency p99(s):       " << data.latency_hist.percentile(0.99) << std::endl
+       << "Latency p99.9(s):     " << data.latency_hist.percentile(0.999) << std::endl;
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -848,6 +902,9 @@ int ObjBencher::seq_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    formatter->dump_format("p50_latency", "%f", data.latency_hist.percentile(0.5));
+    formatter->dump_format("p99_latency", "%f", data.latency_hist.percentile(0.99));
+    formatter->dump_format("p999_latency", "%f", data.latency_hist.percentile(0.999));
   }
 
   completions_done();
@@ -974,6 +1031,7 @@ int ObjBencher::rand_read_bench(
       data.max_latency = data.cur_latency.count();
     if (data.cur_latency.count() < data.min_latency)
       data.min_latency = data.cur_latency.count();
+    data.latency_hist.add(data.cur_latency);
     ++data.finished;
     data.avg_latency = total_latency / data.finished;
     --data.in_flight;
@@ -1046,7 +1104,10 @@ int ObjBencher::rand_read_bench(
        << "Min IOPS:             " << data.idata.min_iops << std::endl
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
-       << "Min latency(s):       " << data.min_latency << std::endl;
+       << "Min latency(s):       " << data.min_latency << std::endl
+       << "Latency p50(s):       " << data.latency_hist.percentile(0.5) << std::endl
+       << "Latency p99(s):       " << data.latency_hist.percentile(0.99) << std::endl
+       << "Latency p99.9(s):     " << data.latency_hist.percentile(0.999) << std::endl;
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -1060,6 +1121,9 @@ int ObjBencher::rand_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    formatter->dump_format("p50_latency", "%f", data.latency_hist.percentile(0.5));
+    formatter->dump_format("p99_latency", "%f", data.latency_hist.percentile(0.99));
+    formatter->dump_format("p999_latency", "%f", data.latency_hist.percentile(0.999));
   }
   completions_done();
 
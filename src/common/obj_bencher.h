@@ -21,6 +21,7 @@
 #include "include/utime.h"
 #include "ceph_time.h"
 
+#include <array>
 #include <cfloat>
 #include <chrono>
 #include <iosfwd>
@@ -41,6 +42,21 @@ struct bench_interval_data {
   double iops_diff_sum = 0;
 };
 
+// log-linear histogram of latencies in microseconds: 16 buckets per power
+// of two, so a percentile is within ~6% of the measured latency
+struct bench_latency_histogram {
+  std::array<uint64_t, 1024> buckets{};
+  uint64_t count = 0;
+
+  void reset() {
+    buckets.fill(0);
+    count = 0;
+  }
+  void add(std::chrono::duration<double> latency);
+  // latency in seconds below which the fraction p of ops completed
+  double percentile(double p) const;
+};
+
 struct bench_data {
   bool done; //is the benchmark is done
   uint64_t object_size; //the size of the objects
@@ -55,6 +71,7 @@ struct bench_data {
   double avg_latency;
   struct bench_interval_data idata; // data that is updated by time intervals and not by events
   double latency_diff_sum;
+  bench_latency_histogram latency_hist;
   std::chrono::duration<double> cur_latency; //latency of last completed transaction - in seconds by default
   mono_time start_time; //start time for benchmark - use the monotonic clock as we'll measure the passage of time
   char *object_contents; //pointer to the contents written to each object
@@ -19,8 +19,10 @@
 #include "common/dout.h"
 #include "common/valgrind.h"
 #include "include/common_fwd.h"
+#include "include/intarith.h"
 #include "include/utime.h"
 
+#include <algorithm>
 #include <sstream>
 
 using std::ostringstream;
@@ -176,11 +178,9 @@ void PerfCounters::inc(int idx, uint64_t amt)
   if (!(data.type & PERFCOUNTER_U64))
     return;
   if (data.type & PERFCOUNTER_LONGRUNAVG) {
-    data.avgcount++;
-    data.u64 += amt;
-    data.avgcount2++;
+    data.add_avg(amt);
   } else {
-    data.u64 += amt;
+    data.add(amt);
   }
 }
 
@@ -197,15 +197,13 @@ void PerfCounters::inc_with_max(int idx, uint64_t amt)
   if (!(data.type & PERFCOUNTER_U64))
     return;
   if (data.type & PERFCOUNTER_LONGRUNAVG) {
-    data.avgcount++;
-    data.u64 += amt;
+    data.add_avg(amt);
     uint64_t m;
     do {
       m = data.max_u64_inc.load();
     } while(amt > m && !data.max_u64_inc.compare_exchange_weak(m, amt));
-    data.avgcount2++;
   } else {
-    data.u64 += amt;
+    data.add(amt);
   }
 }
 
@@ -222,7 +220,7 @@ void PerfCounters::dec(int idx, uint64_t amt)
   ceph_assert(!(data.type & PERFCOUNTER_LONGRUNAVG));
   if (!(data.type & PERFCOUNTER_U64))
     return;
-  data.u64 -= amt;
+  data.add(-amt);
 }
 
 void PerfCounters::set(int idx, uint64_t amt)
@@ -240,13 +238,7 @@ void PerfCounters::set(int idx, uint64_t amt)
 
   ANNOTATE_BENIGN_RACE_SIZED(&data.u64, sizeof(data.u64),
                              "perf counter atomic");
-  if (data.type & PERFCOUNTER_LONGRUNAVG) {
-    data.avgcount++;
-    data.u64 = amt;
-    data.avgcount2++;
-  } else {
-    data.u64 = amt;
-  }
+  data.set(amt);
 }
 
 uint64_t PerfCounters::get(int idx) const
@@ -261,7 +253,7 @@ uint64_t PerfCounters::get(int idx) const
   const perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_U64))
     return 0;
-  return data.u64;
+  return data.read_u64();
 }
 
 void PerfCounters::tinc(int idx, utime_t amt)
@@ -277,11 +269,9 @@ void PerfCounters::tinc(int idx, utime_t amt)
   if (!(data.type & PERFCOUNTER_TIME))
     return;
   if (data.type & PERFCOUNTER_LONGRUNAVG) {
-    data.avgcount++;
-    data.u64 += amt.to_nsec();
-    data.avgcount2++;
+    data.add_avg(amt.to_nsec());
   } else {
-    data.u64 += amt.to_nsec();
+    data.add(amt.to_nsec());
   }
 }
 
@@ -299,15 +289,13 @@ void PerfCounters::tinc_with_max(int idx, utime_t amt)
     return;
   if (data.type & PERFCOUNTER_LONGRUNAVG) {
     uint64_t new_m = amt.to_nsec();
-    data.avgcount++;
-    data.u64 += new_m;
+    data.add_avg(new_m);
     uint64_t m;
     do {
       m = data.max_u64_inc.load();
     } while(new_m > m && !data.max_u64_inc.compare_exchange_weak(m, new_m));
-    data.avgcount2++;
   } else {
-    data.u64 += amt.to_nsec();
+    data.add(amt.to_nsec());
   }
 }
 
@@ -324,11 +312,9 @@ void PerfCounters::tinc(int idx, ceph::timespan amt)
   if (!(data.type & PERFCOUNTER_TIME))
     return;
   if (data.type & PERFCOUNTER_LONGRUNAVG) {
-    data.avgcount++;
-    data.u64 += amt.count();
-    data.avgcount2++;
+    data.add_avg(amt.count());
   } else {
-    data.u64 += amt.count();
+    data.add(amt.count());
   }
 }
 
@@ -346,15 +332,13 @@ void PerfCounters::tinc_with_max(int idx, ceph::timespan amt)
     return;
   if (data.type & PERFCOUNTER_LONGRUNAVG) {
     uint64_t new_m = amt.count();
-    data.avgcount++;
-    data.u64 += new_m;
+    data.add_avg(new_m);
     uint64_t m;
     do {
       m = data.max_u64_inc.load();
     } while(new_m > m && !data.max_u64_inc.compare_exchange_weak(m, new_m));
-    data.avgcount2++;
   } else {
-    data.u64 += amt.count();
+    data.add(amt.count());
   }
 }
 
@@ -370,7 +354,7 @@ void PerfCounters::tset(int idx, utime_t amt)
   perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return;
-  data.u64 = amt.to_nsec();
+  data.set(amt.to_nsec());
   if (data.type & PERFCOUNTER_LONGRUNAVG)
     ceph_abort();
 }
@@ -387,7 +371,7 @@ void PerfCounters::tset(int idx, ceph::timespan amt)
   perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return;
-  data.u64 = amt.count();
+  data.set(amt.count());
   if (data.type & PERFCOUNTER_LONGRUNAVG)
     ceph_abort();
 }
@@ -404,7 +388,7 @@ utime_t PerfCounters::tget(int idx) const
   const perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return utime_t();
-  uint64_t v = data.u64;
+  uint64_t v = data.read_u64();
   return utime_t(v / 1000000000ull, v % 1000000000ull);
 }
 
@@ -594,7 +578,7 @@ void PerfCounters::dump_formatted_generic(Formatter *f, bool schema,
         Formatter::ObjectSection histogram_section{*f, d->name};
         d->histogram->dump_formatted(f);
       } else {
-	uint64_t v = d->u64;
+	uint64_t v = d->read_u64();
 	if (d->type & PERFCOUNTER_U64) {
 	  f->dump_unsigned(d->name, v);
 	} else if (d->type & PERFCOUNTER_TIME) {
@@ -629,6 +613,35 @@ PerfCounters::PerfCounters(CephContext *cct, const std::string &name,
   m_data.resize(upper_bound - lower_bound - 1);
 }
 
+void PerfCounters::shard_counters()
+{
+  // only counters and averages, which are only ever added to; gauges and
+  // histograms stay as they are
+  auto sharded = [](const perf_counter_data_any_d& d) {
+    return (d.type & (PERFCOUNTER_COUNTER | PERFCOUNTER_LONGRUNAVG)) &&
+      !(d.type & PERFCOUNTER_HISTOGRAM);
+  };
+  size_t num = std::count_if(m_data.begin(), m_data.end(), sharded);
+  if (num == 0) {
+    return;
+  }
+  // give each shard whole cache lines of its own
+  constexpr size_t line = 128;
+  constexpr size_t slot = sizeof(perf_counter_shard_d);
+  static_assert(line % slot == 0);
+  const size_t stride = round_up_to(num, line / slot);
+  const size_t num_shards = mempool::get_num_shards();
+  m_shards.reset(new perf_counter_shard_d[stride * num_shards + line / slot]);
+  auto base = reinterpret_cast<perf_counter_shard_d*>(
+    round_up_to(reinterpret_cast<uintptr_t>(m_shards.get()), line));
+  for (auto& d : m_data) {
+    if (sharded(d)) {
+      d.shard_base = base++;
+      d.shard_stride = stride;
+    }
+  }
+}
+
 PerfCountersBuilder::PerfCountersBuilder(CephContext *cct, const std::string &name,
                   int first, int last)
   : m_perf_counters(new PerfCounters(cct, name, first, last))
@@ -724,6 +737,12 @@ PerfCounters *PerfCountersBuilder::create_perf_counters()
     ceph_assert(d->type & (PERFCOUNTER_U64 | PERFCOUNTER_TIME));
   }
 
+#ifndef WITH_CRIMSON
+  if (m_perf_counters->m_cct->_conf.get_val<bool>("perf_counters_sharded")) {
+    m_perf_counters->shard_counters();
+  }
+#endif
+
   PerfCounters *ret = m_perf_counters;
   m_perf_counters = NULL;
   return ret;
@@ -32,6 +32,7 @@
 #include "include/common_fwd.h"
 #include "common/ceph_mutex.h"
 #include "common/ceph_time.h"
+#include "include/mempool.h"
 
 class utime_t;
 
@@ -166,6 +167,13 @@ private:
 class PerfCounters
 {
 public:
+  /// one shard's share of a sharded counter, see perf_counter_data_any_d
+  struct alignas(32) perf_counter_shard_d {
+    std::atomic<uint64_t> u64 = { 0 };
+    std::atomic<uint64_t> avgcount = { 0 };
+    std::atomic<uint64_t> avgcount2 = { 0 };
+  };
+
   /** Represents a PerfCounters data element. */
   struct perf_counter_data_any_d {
     perf_counter_data_any_d()
@@ -201,6 +209,68 @@ public:
     std::atomic<uint64_t> avgcount2 = { 0 };
     std::unique_ptr<PerfHistogram<>> histogram;
 
+    // With perf_counters_sharded, counters and averages are not updated
+    // in u64/avgcount above but in one slot per mempool shard, so that
+    // threads on different cpus do not bounce the cache line.  The slots
+    // of shard i are at shard_base + i * shard_stride; reads add them up.
+    perf_counter_shard_d *shard_base = nullptr;
+    size_t shard_stride = 0;
+
+    perf_counter_shard_d& my_shard() const {
+      return shard_base[mempool::pick_a_shard_int() * shard_stride];
+    }
+    template <typename F>
+    void for_each_shard(F&& f) const {
+      for (size_t i = 0; i < mempool::get_num_shards(); ++i) {
+        f(shard_base[i * shard_stride]);
+      }
+    }
+
+    void add(uint64_t amt) {
+      if (shard_base) {
+        my_shard().u64 += amt;
+      } else {
+        u64 += amt;
+      }
+    }
+    void add_avg(uint64_t amt) {
+      if (shard_base) {
+        auto& s = my_shard();
+        s.avgcount++;
+        s.u64 += amt;
+        s.avgcount2++;
+      } else {
+        avgcount++;
+        u64 += amt;
+        avgcount2++;
+      }
+    }
+    /// not atomic with respect to concurrent updates of a sharded counter
+    void set(uint64_t amt) {
+      const bool avg = type & PERFCOUNTER_LONGRUNAVG;
+      if (shard_base) {
+        for_each_shard([](auto& s) { s.u64 = 0; });
+      }
+      auto& count = shard_base ? shard_base[0].avgcount : avgcount;
+      auto& sum = shard_base ? shard_base[0].u64 : u64;
+      auto& count2 = shard_base ? shard_base[0].avgcount2 : avgcount2;
+      if (avg) {
+        count++;
+      }
+      sum = amt;
+      if (avg) {
+        count2++;
+      }
+    }
+    uint64_t read_u64() const {
+      if (!shard_base) {
+        return u64;
+      }
+      uint64_t sum = 0;
+      for_each_shard([&](auto& s) { sum += s.u64; });
+      return sum;
+    }
+
     void reset()
     {
       if (type != PERFCOUNTER_U64) {
@@ -208,6 +278,13 @@ public:
 	    max_u64_inc = 0;
 	    avgcount = 0;
 	    avgcount2 = 0;
+	    if (shard_base) {
+	      for_each_shard([](auto& s) {
+	        s.u64 = 0;
+	        s.avgcount = 0;
+	        s.avgcount2 = 0;
+	      });
+	    }
       }
       if (histogram) {
         histogram->reset();
@@ -219,6 +296,19 @@ public:
     // without any intervening calls to inc, set, or tinc.
     std::pair<uint64_t,uint64_t> read_avg() const {
       uint64_t sum, count;
+      if (shard_base) {
+        sum = count = 0;
+        for_each_shard([&](auto& s) {
+          uint64_t shard_sum, shard_count;
+          do {
+            shard_count = s.avgcount2;
+            shard_sum = s.u64;
+          } while (s.avgcount != shard_count);
+          sum += shard_sum;
+          count += shard_count;
+        });
+        return { sum, count };
+      }
       do {
 	count = avgcount2;
 	sum = u64;
@@ -226,6 +316,10 @@ public:
       return { sum, count };
     }
     std::tuple<uint64_t,uint64_t, uint64_t> read_avg_ex() const {
+      if (shard_base) {
+        auto [sum, count] = read_avg();
+        return { sum, count, max_u64_inc };
+      }
       uint64_t _sum, _count, _max;
       do {
 	_count = avgcount2;
@@ -310,6 +404,8 @@ private:
   void dump_formatted_generic(ceph::Formatter *f, bool schema, bool histograms,
                               select_labeled_t dump_labeled,
                               const std::string &counter = "") const;
+  /// move counters and averages to per-shard slots
+  void shard_counters();
 
   typedef std::vector<perf_counter_data_any_d> perf_counter_data_vec_t;
 
@@ -328,6 +424,9 @@ private:
 
   perf_counter_data_vec_t m_data;
 
+  /// backing store of the shard slots, see perf_counter_data_any_d
+  std::unique_ptr<perf_counter_shard_d[]> m_shards;
+
   friend class PerfCountersBuilder;
   friend class PerfCountersCollectionImpl;
 };
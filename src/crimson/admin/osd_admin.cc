@@ -262,6 +262,175 @@ private:
 template std::unique_ptr<AdminSocketHook> make_asok_hook<DumpPGStateHistory>(
   const crimson::osd::PGShardManager &);
 
+static void dump_pg_migration(
+  Formatter *f,
+  std::string_view name,
+  const std::optional<crimson::osd::PGShardManager::pg_migration_t> &m)
+{
+  f->open_object_section(name);
+  if (m) {
+    f->dump_stream("pgid") << m->pgid;
+    f->dump_unsigned("from", m->from);
+    f->dump_unsigned("to", m->to);
+  }
+  f->close_section();
+}
+
+/// dump the client request rate of each PG and the load of each reactor
+class DumpPGShardLoadHook final: public AdminSocketHook {
+public:
+  explicit DumpPGShardLoadHook(const crimson::osd::PGShardManager &pg_shard_manager) :
+    AdminSocketHook{"dump_pg_shard_load",
+                    "",
+                    "dump per-core and per-PG client op rates since the last sample"},
+    pg_shard_manager{pg_shard_manager}
+  {}
+  seastar::future<tell_result_t> call(const cmdmap_t&,
+                                      std::string_view format,
+                                      ceph::bufferlist&& input) const final
+  {
+    LOG_PREFIX(AdminSocketHook::DumpPGShardLoadHook);
+    DEBUG("");
+    auto loads = co_await pg_shard_manager.get_pg_load();
+    std::unique_ptr<Formatter> f{
+      Formatter::create(format, "json-pretty", "json-pretty")};
+    f->open_object_section("pg_shard_load");
+    f->dump_bool("migration_supported",
+                 pg_shard_manager.is_pg_migration_supported());
+    f->open_array_section("cores");
+    for (const auto &load : loads) {
+      f->open_object_section("core");
+      f->dump_unsigned("core", load.core);
+      f->dump_float("reactor_utilization", load.reactor_utilization);
+      f->dump_float("op_rate", load.op_rate);
+      f->open_array_section("pgs");
+      for (const auto &pg : load.pgs) {
+        f->open_object_section("pg");
+        f->dump_stream("pgid") << pg.pgid;
+        f->dump_float("op_rate", pg.op_rate);
+        f->dump_bool("movable", pg.movable);
+        f->close_section();
+      }
+      f->close_section();
+      f->close_section();
+    }
+    f->close_section();
+    dump_pg_migration(
+      f.get(), "candidate",
+      crimson::osd::PGShardManager::choose_pg_migration(
+        loads,
+        local_conf().get_val<double>("crimson_osd_pg_rebalance_min_utilization"),
+        local_conf().get_val<double>("crimson_osd_pg_rebalance_min_imbalance")));
+    f->close_section();
+    co_return std::move(f);
+  }
+
+private:
+  const crimson::osd::PGShardManager &pg_shard_manager;
+};
+template std::unique_ptr<AdminSocketHook> make_asok_hook<DumpPGShardLoadHook>(
+  const crimson::osd::PGShardManager &);
+
+/// move the hottest movable PG off the busiest reactor, if worthwhile
+class RebalancePGShardsHook final: public AdminSocketHook {
+public:
+  explicit RebalancePGShardsHook(crimson::osd::OSD& osd) :
+    AdminSocketHook{"rebalance_pg_shards",
+                    "name=dryrun,type=CephBool,req=false",
+                    "move one PG from the busiest to the least busy core"},
+    osd(osd)
+  {}
+  seastar::future<tell_result_t> call(const cmdmap_t& cmdmap,
+                                      std::string_view format,
+                                      ceph::bufferlist&& input) const final
+  {
+    LOG_PREFIX(AdminSocketHook::RebalancePGShardsHook);
+    DEBUG("");
+    auto &pg_shard_manager = osd.get_pg_shard_manager();
+    if (!pg_shard_manager.is_pg_migration_supported()) {
+      co_return tell_result_t{
+        -EOPNOTSUPP, "pg migration is not supported by this objectstore"};
+    }
+    bool dryrun = cmd_getval_or<bool>(cmdmap, "dryrun", false);
+    auto migration = co_await pg_shard_manager.rebalance_pgs(dryrun);
+    std::unique_ptr<Formatter> f{
+      Formatter::create(format, "json-pretty", "json-pretty")};
+    f->open_object_section("rebalance_pg_shards");
+    f->dump_bool("dryrun", dryrun);
+    dump_pg_migration(f.get(), "migration", migration);
+    f->close_section();
+    co_return std::move(f);
+  }
+
+private:
+  crimson::osd::OSD& osd;
+};
+template std::unique_ptr<AdminSocketHook>
+make_asok_hook<RebalancePGShardsHook>(crimson::osd::OSD& osd);
+
+/// move a PG to the given core
+class MigratePGShardHook final: public AdminSocketHook {
+public:
+  explicit MigratePGShardHook(crimson::osd::OSD& osd) :
+    AdminSocketHook{"migrate_pg_shard",
+                    "name=pgid,type=CephPgid "
+                    "name=core,type=CephInt,range=0",
+                    "move a PG this OSD is primary for to another core"},
+    osd(osd)
+  {}
+  seastar::future<tell_result_t> call(const cmdmap_t& cmdmap,
+                                      std::string_view format,
+                                      ceph::bufferlist&& input) const final
+  {
+    LOG_PREFIX(AdminSocketHook::MigratePGShardHook);
+    DEBUG("");
+    auto &pg_shard_manager = osd.get_pg_shard_manager();
+    if (!pg_shard_manager.is_pg_migration_supported()) {
+      co_return tell_result_t{
+        -EOPNOTSUPP, "pg migration is not supported by this objectstore"};
+    }
+    std::string pgid_str;
+    pg_t pgid;
+    if (!cmd_getval(cmdmap, "pgid", pgid_str) ||
+        !pgid.parse(pgid_str.c_str())) {
+      co_return tell_result_t{
+        -EINVAL, fmt::format("couldn't parse pgid '{}'", pgid_str)};
+    }
+    spg_t spgid;
+    if (!osd.get_shard_services().get_map()->get_primary_shard(pgid, &spgid)) {
+      co_return tell_result_t{
+        -ENOENT, fmt::format("pgid '{}' does not exist", pgid_str)};
+    }
+    int64_t core = cmd_getval_or<int64_t>(cmdmap, "core", 0);
+    if (static_cast<uint64_t>(core) >= seastar::smp::count) {
+      co_return tell_result_t{
+        -EINVAL, fmt::format("no such core {}", core)};
+    }
+    auto from = pg_shard_manager.get_pg_to_shard_mapping().get_pg_mapping(spgid);
+    if (from == NULL_CORE) {
+      co_return tell_result_t{
+        -ENOENT, fmt::format("don't have pgid '{}'", spgid)};
+    }
+    bool moved = co_await pg_shard_manager.migrate_pg(spgid, core);
+    if (!moved) {
+      co_return tell_result_t{
+        -EAGAIN, fmt::format("pg {} stays on core {}, see the osd log", spgid, from)};
+    }
+    std::unique_ptr<Formatter> f{
+      Formatter::create(format, "json-pretty", "json-pretty")};
+    dump_pg_migration(
+      f.get(), "migration",
+      crimson::osd::PGShardManager::pg_migration_t{
+        spgid, from, static_cast<core_id_t>(core)});
+    co_return std::move(f);
+  }
+
+private:
+  crimson::osd::OSD& osd;
+};
+template std::unique_ptr<AdminSocketHook>
+make_asok_hook<MigratePGShardHook>(crimson::osd::OSD& osd);
+
 //dump the contents of perfcounters in osd and store
 class DumpPerfCountersHook final: public AdminSocketHook {
 public:
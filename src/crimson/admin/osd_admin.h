@@ -12,6 +12,9 @@ class AdminSocketHook;
 class AssertAlwaysHook;
 class DumpMetricsHook;
 class DumpPGStateHistory;
+class DumpPGShardLoadHook;
+class RebalancePGShardsHook;
+class MigratePGShardHook;
 class DumpPerfCountersHook;
 class FlushPgStatsHook;
 class InjectDataErrorHook;
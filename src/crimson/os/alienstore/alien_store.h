@@ -83,6 +83,7 @@ public:
   seastar::future<CollectionRef> create_new_collection(const coll_t& cid) final;
   seastar::future<CollectionRef> open_collection(const coll_t& cid) final;
   seastar::future<std::vector<coll_core_t>> list_collections() final;
+  bool collections_are_core_local() const final { return false; }
   seastar::future<> set_collection_opts(CollectionRef c,
                                         const pool_opts_t& opts) final;
 
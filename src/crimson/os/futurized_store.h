@@ -236,6 +236,9 @@ public:
   using coll_core_t = std::pair<coll_t, core_id_t>;
   virtual seastar::future<std::vector<coll_core_t>> list_collections() = 0;
 
+  /// true if a collection can only be accessed from the core it lives on
+  virtual bool collections_are_core_local() const { return true; }
+
   virtual seastar::future<std::string> get_default_device_class() = 0;
 protected:
   const core_id_t primary_core;
@@ -1,6 +1,7 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
 // vim: ts=8 sw=2 sts=2 expandtab
 
+#include <boost/iterator/counting_iterator.hpp>
 #include <fmt/chrono.h>
 #include <seastar/core/metrics.hh>
 
@@ -1025,6 +1026,13 @@ void SegmentCleaner::register_metrics()
 		     sm::description("rewritten bytes due to reclaim")),
     sm::make_counter("reclaimed_segment_bytes", stats.reclaimed_segment_bytes,
 		     sm::description("rewritten bytes due to reclaim")),
+    sm::make_counter("reclaim_cycles", stats.reclaim_cycles,
+		     sm::description("the number of reclaim cycles")),
+    sm::make_counter("reclaim_cycle_segments", stats.reclaim_cycle_segments,
+		     sm::description("the sum of victim segments of all reclaim cycles")),
+    sm::make_gauge("reclaiming_segments",
+		   [this] { return reclaim_states.size(); },
+		   sm::description("the number of segments being reclaimed")),
     sm::make_counter("closed_journal_used_bytes", stats.closed_journal_used_bytes,
 		     sm::description("used bytes when close a journal segment")),
     sm::make_counter("closed_journal_total_bytes", stats.closed_journal_total_bytes,
@@ -1040,6 +1048,9 @@ void SegmentCleaner::register_metrics()
     sm::make_gauge("reclaim_ratio",
                    [this] { return get_reclaim_ratio(); },
                    sm::description("ratio of reclaimable space to unavailable space")),
+    sm::make_gauge("reclaim_write_amplification",
+                   [this] { return get_reclaim_write_amplification(); },
+                   sm::description("bytes written per byte of space freed by reclaim")),
 
     sm::make_histogram("segment_utilization_distribution",
 		       [this]() -> seastar::metrics::histogram& {
@@ -1148,11 +1159,11 @@ double SegmentCleaner::calc_gc_benefit_cost(
 
 SegmentCleaner::do_reclaim_space_ret
 SegmentCleaner::do_reclaim_space(
-    const std::vector<CachedExtentRef> &backref_extents,
-    const backref_mapping_list_t &pin_list,
-    std::size_t &reclaimed,
+    const std::vector<reclaim_range_t> &ranges,
+    std::vector<std::size_t> &reclaimed,
     std::size_t &runs)
 {
+  assert(ranges.size() == reclaim_states.size());
   auto& shard_stats = extent_callback->get_shard_stats();
   if (is_cold) {
     ++(shard_stats.cleaner_cold_num);
@@ -1170,9 +1181,12 @@ SegmentCleaner::do_reclaim_space(
   // 	tree doesn't match the extent's paddr
   // 3. the extent is physical and doesn't exist in the
   // 	lba tree, backref tree or backref cache;
-  return repeat_eagain([this, &backref_extents, &shard_stats,
-                        &pin_list, &reclaimed, &runs] {
-    reclaimed = 0;
+  //
+  // The live extents of all the victim segments are looked up in parallel
+  // and rewritten by the same transaction, each with the target generation
+  // of the segment it comes from.
+  return repeat_eagain([this, &ranges, &shard_stats, &reclaimed, &runs] {
+    std::fill(reclaimed.begin(), reclaimed.end(), 0);
     runs++;
     transaction_type_t src;
     if (is_cold) {
@@ -1186,19 +1200,24 @@ SegmentCleaner::do_reclaim_space(
       src,
       "clean_reclaim_space",
       CACHE_HINT_NOCACHE,
-      [this, &backref_extents, &pin_list, &reclaimed](auto &t)
+      [this, &ranges, &reclaimed](auto &t)
     {
-      return seastar::do_with(
-        std::vector<CachedExtentRef>(backref_extents),
-        [this, &t, &reclaimed, &pin_list](auto &extents)
-      {
-        LOG_PREFIX(SegmentCleaner::do_reclaim_space);
-        // calculate live extents
+      LOG_PREFIX(SegmentCleaner::do_reclaim_space);
+      // calculate live extents
+      std::vector<std::vector<CachedExtentRef>> extents_by_range;
+      std::vector<backref_entry_query_set_t> entries_by_range;
+      extents_by_range.reserve(ranges.size());
+      entries_by_range.reserve(ranges.size());
+      std::size_t num_entries = 0;
+      for (std::size_t i = 0; i < ranges.size(); ++i) {
+        auto &state = reclaim_states[i];
+        auto &range = ranges[i];
+        extents_by_range.emplace_back(range.backref_extents);
         auto cached_backref_entries =
           backref_manager.get_cached_backref_entries_in_range(
-            reclaim_state->start_pos, reclaim_state->end_pos);
+            state.start_pos, state.end_pos);
         backref_entry_query_set_t backref_entries;
-        for (auto &pin : pin_list) {
+        for (auto &pin : range.pin_list) {
           backref_entries.emplace(
             pin.get_key(),
             pin.get_val(),
@@ -1214,45 +1233,65 @@ SegmentCleaner::do_reclaim_space(
             backref_entries.emplace(cached_backref);
           }
         }
-        // retrieve live extents
-        DEBUGT("start, backref_entries={}, backref_extents={}",
-               t, backref_entries.size(), extents.size());
-	return seastar::do_with(
-	  std::move(backref_entries),
-	  [this, &extents, &t](auto &backref_entries) {
-	  return trans_intr::parallel_for_each(
-	    backref_entries,
-	    [this, &extents, &t](auto &ent)
-	  {
-	    LOG_PREFIX(SegmentCleaner::do_reclaim_space);
-	    TRACET("getting extent of type {} at {}~0x{:x}",
-	      t,
-	      ent.type,
-	      ent.paddr,
-	      ent.len);
-	    return extent_callback->get_extents_if_live(
-	      t, ent.type, ent.paddr, ent.laddr, ent.len
-	    ).si_then([FNAME, &extents, &ent, &t](auto list) {
-	      if (list.empty()) {
-		TRACET("addr {} dead, skipping", t, ent.paddr);
-	      } else {
-		for (auto &e : list) {
-		  extents.emplace_back(std::move(e));
-		}
-	      }
-	    });
-	  });
-	}).si_then([FNAME, &extents, this, &reclaimed, &t] {
-          DEBUGT("reclaim {} extents", t, extents.size());
+        num_entries += backref_entries.size();
+        entries_by_range.emplace_back(std::move(backref_entries));
+      }
+      // retrieve live extents
+      DEBUGT("start, {} segments, backref_entries={}",
+             t, ranges.size(), num_entries);
+      return seastar::do_with(
+        std::move(extents_by_range),
+        std::move(entries_by_range),
+        [this, &t, &reclaimed](auto &extents_by_range, auto &entries_by_range)
+      {
+        return trans_intr::parallel_for_each(
+          boost::make_counting_iterator<std::size_t>(0),
+          boost::make_counting_iterator(entries_by_range.size()),
+          [this, &t, &extents_by_range, &entries_by_range](auto i)
+        {
+          return trans_intr::parallel_for_each(
+            entries_by_range[i],
+            [this, &t, &extents = extents_by_range[i]](auto &ent)
+          {
+            LOG_PREFIX(SegmentCleaner::do_reclaim_space);
+            TRACET("getting extent of type {} at {}~0x{:x}",
+              t,
+              ent.type,
+              ent.paddr,
+              ent.len);
+            return extent_callback->get_extents_if_live(
+              t, ent.type, ent.paddr, ent.laddr, ent.len
+            ).si_then([FNAME, &extents, &ent, &t](auto list) {
+              if (list.empty()) {
+                TRACET("addr {} dead, skipping", t, ent.paddr);
+              } else {
+                for (auto &e : list) {
+                  extents.emplace_back(std::move(e));
+                }
+              }
+            });
+          });
+        }).si_then([this, &t, &extents_by_range, &reclaimed] {
           // rewrite live extents
-          auto modify_time = segments[reclaim_state->get_segment_id()].modify_time;
           return trans_intr::do_for_each(
-            extents,
-            [this, modify_time, &t, &reclaimed](auto ext)
+            boost::make_counting_iterator<std::size_t>(0),
+            boost::make_counting_iterator(extents_by_range.size()),
+            [this, &t, &extents_by_range, &reclaimed](auto i)
           {
-            reclaimed += ext->get_length();
-            return extent_callback->rewrite_extent(
-                t, ext, reclaim_state->target_generation, modify_time);
+            LOG_PREFIX(SegmentCleaner::do_reclaim_space);
+            auto &state = reclaim_states[i];
+            DEBUGT("reclaim {} extents from {}",
+                   t, extents_by_range[i].size(), state.get_segment_id());
+            auto modify_time = segments[state.get_segment_id()].modify_time;
+            return trans_intr::do_for_each(
+              extents_by_range[i],
+              [this, &t, &state, modify_time,
+               &reclaimed = reclaimed[i]](auto ext)
+            {
+              reclaimed += ext->get_length();
+              return extent_callback->rewrite_extent(
+                  t, ext, state.target_generation, modify_time);
+            });
           });
         });
       }).si_then([this, &t] {
@@ -1265,32 +1304,67 @@ SegmentCleaner::do_reclaim_space(
   });
 }
 
+SegmentCleaner::release_reclaimed_segment_ret
+SegmentCleaner::release_reclaimed_segment(segment_id_t segment_to_release)
+{
+  LOG_PREFIX(SegmentCleaner::release_reclaimed_segment);
+  return sm_group->release_segment(segment_to_release
+  ).handle_error(
+    release_reclaimed_segment_ertr::pass_further{},
+    crimson::ct_error::assert_all{
+      "SegmentCleaner::clean_space encountered invalid error in release_segment"
+    }
+  ).safe_then([this, FNAME, segment_to_release] {
+    auto old_usage = calc_utilization(segment_to_release);
+    if(unlikely(old_usage != 0)) {
+      space_tracker->dump_usage(segment_to_release);
+      ERROR("segment {} old_usage {} != 0",
+             segment_to_release, old_usage);
+      ceph_abort();
+    }
+    segments.mark_empty(segment_to_release);
+    auto new_usage = calc_utilization(segment_to_release);
+    adjust_segment_util(old_usage, new_usage);
+    INFO("reclaim released {}, {}",
+         segment_to_release, stat_printer_t{*this, false});
+    background_callback->maybe_wake_blocked_io();
+  });
+}
+
 SegmentCleaner::clean_space_ret SegmentCleaner::clean_space()
 {
   LOG_PREFIX(SegmentCleaner::clean_space);
   assert(background_callback->is_ready());
   ceph_assert(can_clean_space());
-  if (!reclaim_state) {
-    segment_id_t seg_id = get_next_reclaim_segment();
-    auto &segment_info = segments[seg_id];
-    INFO("reclaim start... {} {}, usage={}, time_bound={}",
-         seg_id, segment_info,
-         space_tracker->calc_utilization(seg_id),
-         sea_time_point_printer_t{segments.get_time_bound()});
-    ceph_assert(segment_info.is_closed());
-    ceph_assert(is_rewrite_generation(
-	segment_info.generation, max_rewrite_generation));
-    reclaim_state = reclaim_state_t::create(
-        seg_id, segment_info.generation, segments.get_segment_size());
-    assert(is_target_rewrite_generation(
-	reclaim_state->target_generation, max_rewrite_generation));
+  auto parallelism = get_reclaim_parallelism();
+  if (reclaim_states.size() < parallelism) {
+    auto seg_ids = get_next_reclaim_segments(
+      parallelism - reclaim_states.size());
+    for (auto seg_id : seg_ids) {
+      auto &segment_info = segments[seg_id];
+      INFO("reclaim start... {} {}, usage={}, time_bound={}",
+           seg_id, segment_info,
+           space_tracker->calc_utilization(seg_id),
+           sea_time_point_printer_t{segments.get_time_bound()});
+      ceph_assert(segment_info.is_closed());
+      ceph_assert(is_rewrite_generation(
+          segment_info.generation, max_rewrite_generation));
+      auto &state = reclaim_states.emplace_back(reclaim_state_t::create(
+          seg_id, segment_info.generation, segments.get_segment_size()));
+      assert(is_target_rewrite_generation(
+          state.target_generation, max_rewrite_generation));
+    }
   }
-  reclaim_state->advance(config.reclaim_bytes_per_cycle);
-
-  DEBUG("reclaiming {} {}~{}",
-        rewrite_gen_printer_t{reclaim_state->generation},
-        reclaim_state->start_pos,
-        reclaim_state->end_pos);
+  ceph_assert(!reclaim_states.empty());
+  for (auto &state : reclaim_states) {
+    state.advance(config.reclaim_bytes_per_cycle);
+    DEBUG("reclaiming {} {}~{}",
+          rewrite_gen_printer_t{state.generation},
+          state.start_pos,
+          state.end_pos);
+  }
+  ++stats.reclaim_cycles;
+  stats.reclaim_cycle_segments += reclaim_states.size();
   double pavail_ratio = get_projected_available_ratio();
   sea_time_point start = seastar::lowres_system_clock::now();
 
@@ -1298,7 +1372,7 @@ SegmentCleaner::clean_space_ret SegmentCleaner::clean_space()
   // transactions.  So, concurrent transactions between trim and reclaim are
   // not allowed right now.
   return seastar::do_with(
-    std::pair<std::vector<CachedExtentRef>, backref_mapping_list_t>(),
+    std::vector<reclaim_range_t>(reclaim_states.size()),
     [this](auto &weak_read_ret) {
     return repeat_eagain([this, &weak_read_ret] {
       // Note: not tracked by shard_stats_t intentionally.
@@ -1307,28 +1381,35 @@ SegmentCleaner::clean_space_ret SegmentCleaner::clean_space()
 	  "retrieve_from_backref_tree",
 	  CACHE_HINT_NOCACHE,
 	  [this, &weak_read_ret](auto &t) {
-	return backref_manager.get_mappings(
-	  t,
-	  reclaim_state->start_pos,
-	  reclaim_state->end_pos
-	).si_then([this, &t, &weak_read_ret](auto pin_list) {
-	  if (!pin_list.empty()) {
-	    auto it = pin_list.begin();
-	    auto &first_pin = *it;
-	    if (first_pin.get_key() < reclaim_state->start_pos) {
-	      // BackrefManager::get_mappings may include a entry before
-	      // reclaim_state->start_pos, which is semantically inconsistent
-	      // with the requirements of the cleaner
-	      pin_list.erase(it);
-	    }
-	  }
-	  return backref_manager.retrieve_backref_extents_in_range(
+	return trans_intr::parallel_for_each(
+	  boost::make_counting_iterator<std::size_t>(0),
+	  boost::make_counting_iterator(reclaim_states.size()),
+	  [this, &t, &weak_read_ret](auto i) {
+	  auto &state = reclaim_states[i];
+	  return backref_manager.get_mappings(
 	    t,
-	    reclaim_state->start_pos,
-	    reclaim_state->end_pos
-	  ).si_then([pin_list=std::move(pin_list),
-		    &weak_read_ret](auto extents) mutable {
-	    weak_read_ret = std::make_pair(std::move(extents), std::move(pin_list));
+	    state.start_pos,
+	    state.end_pos
+	  ).si_then([this, &t, &state, &range=weak_read_ret[i]](auto pin_list) {
+	    if (!pin_list.empty()) {
+	      auto it = pin_list.begin();
+	      auto &first_pin = *it;
+	      if (first_pin.get_key() < state.start_pos) {
+		// BackrefManager::get_mappings may include a entry before
+		// state.start_pos, which is semantically inconsistent
+		// with the requirements of the cleaner
+		pin_list.erase(it);
+	      }
+	    }
+	    return backref_manager.retrieve_backref_extents_in_range(
+	      t,
+	      state.start_pos,
+	      state.end_pos
+	    ).si_then([pin_list=std::move(pin_list),
+		      &range](auto extents) mutable {
+	      range.backref_extents = std::move(extents);
+	      range.pin_list = std::move(pin_list);
+	    });
 	  });
 	});
       });
@@ -1337,56 +1418,48 @@ SegmentCleaner::clean_space_ret SegmentCleaner::clean_space()
     });
   }).safe_then([this, FNAME, pavail_ratio, start](auto weak_read_ret) {
     return seastar::do_with(
-      std::move(weak_read_ret.first),
-      std::move(weak_read_ret.second),
-      (size_t)0,
+      std::move(weak_read_ret),
+      std::vector<std::size_t>(reclaim_states.size(), 0),
       (size_t)0,
       [this, FNAME, pavail_ratio, start](
-        auto &backref_extents, auto &pin_list, auto &reclaimed, auto &runs)
+        auto &ranges, auto &reclaimed, auto &runs)
     {
       return do_reclaim_space(
-          backref_extents,
-          pin_list,
+          ranges,
           reclaimed,
           runs
       ).safe_then([this, FNAME, pavail_ratio, start, &reclaimed, &runs] {
-        stats.reclaiming_bytes += reclaimed;
+        std::vector<segment_id_t> segments_to_release;
+        for (std::size_t i = 0; i < reclaim_states.size(); ++i) {
+          reclaim_states[i].reclaimed_bytes += reclaimed[i];
+        }
         auto d = seastar::lowres_system_clock::now() - start;
-        DEBUG("duration: {}, pavail_ratio before: {}, repeats: {}",
-              d, pavail_ratio, runs);
-        if (reclaim_state->is_complete()) {
-          auto segment_to_release = reclaim_state->get_segment_id();
-          INFO("reclaim finish {}, reclaimed alive/total={}",
-               segment_to_release,
-               stats.reclaiming_bytes/(double)segments.get_segment_size());
-          stats.reclaimed_bytes += stats.reclaiming_bytes;
-          stats.reclaimed_segment_bytes += segments.get_segment_size();
-          stats.reclaiming_bytes = 0;
-          reclaim_state.reset();
-          return sm_group->release_segment(segment_to_release
-          ).handle_error(
-            clean_space_ertr::pass_further{},
-            crimson::ct_error::assert_all{
-              "SegmentCleaner::clean_space encountered invalid error in release_segment"
-            }
-          ).safe_then([this, FNAME, segment_to_release] {
-            auto old_usage = calc_utilization(segment_to_release);
-            if(unlikely(old_usage != 0)) {
-              space_tracker->dump_usage(segment_to_release);
-              ERROR("segment {} old_usage {} != 0",
-                     segment_to_release, old_usage);
-              ceph_abort();
-            }
-            segments.mark_empty(segment_to_release);
-            auto new_usage = calc_utilization(segment_to_release);
-            adjust_segment_util(old_usage, new_usage);
-            INFO("reclaim released {}, {}",
-                 segment_to_release, stat_printer_t{*this, false});
-            background_callback->maybe_wake_blocked_io();
-          });
-        } else {
-          return clean_space_ertr::now();
+        DEBUG("duration: {}, pavail_ratio before: {}, segments: {}, repeats: {}",
+              d, pavail_ratio, reclaim_states.size(), runs);
+        auto it = reclaim_states.begin();
+        while (it != reclaim_states.end()) {
+          if (it->is_complete()) {
+            auto segment_to_release = it->get_segment_id();
+            INFO("reclaim finish {}, reclaimed alive/total={}",
+                 segment_to_release,
+                 it->reclaimed_bytes/(double)segments.get_segment_size());
+            stats.reclaimed_bytes += it->reclaimed_bytes;
+            stats.reclaimed_segment_bytes += segments.get_segment_size();
+            segments_to_release.push_back(segment_to_release);
+            it = reclaim_states.erase(it);
+          } else {
+            ++it;
+          }
         }
+        return seastar::do_with(
+          std::move(segments_to_release),
+          [this](auto &segments_to_release) {
+          return crimson::do_for_each(
+            segments_to_release,
+            [this](auto segment_to_release) {
+            return release_reclaimed_segment(segment_to_release);
+          });
+        });
       });
     });
   });
@@ -1676,11 +1749,36 @@ void SegmentCleaner::mark_space_free(
         space_tracker->get_usage(seg_addr.get_segment_id()));
 }
 
-segment_id_t SegmentCleaner::get_next_reclaim_segment() const
+std::size_t SegmentCleaner::get_reclaim_parallelism() const
 {
-  LOG_PREFIX(SegmentCleaner::get_next_reclaim_segment);
-  segment_id_t id = NULL_SEG_ID;
-  double max_benefit_cost = 0;
+  auto max_segments = config.max_reclaim_segments_per_cycle;
+  if (max_segments <= 1) {
+    return 1;
+  }
+  auto aratio = get_projected_available_ratio();
+  if (aratio >= config.available_ratio_gc_max) {
+    return 1;
+  }
+  if (aratio <= config.available_ratio_hard_limit) {
+    return max_segments;
+  }
+  double pressure = (config.available_ratio_gc_max - aratio) /
+    (config.available_ratio_gc_max - config.available_ratio_hard_limit);
+  return 1 + static_cast<std::size_t>(pressure * (max_segments - 1));
+}
+
+std::vector<segment_id_t>
+SegmentCleaner::get_next_reclaim_segments(std::size_t num) const
+{
+  LOG_PREFIX(SegmentCleaner::get_next_reclaim_segments);
+  assert(num > 0);
+  // min-heap by benefit_cost, holding the best num candidates
+  using candidate_t = std::pair<double, segment_id_t>;
+  std::vector<candidate_t> candidates;
+  candidates.reserve(num + 1);
+  auto cmp = [](const candidate_t &l, const candidate_t &r) {
+    return l.first > r.first;
+  };
   sea_time_point now_time;
   if (gc_formula != gc_formula_t::GREEDY) {
     now_time = seastar::lowres_system_clock::now();
@@ -1699,24 +1797,34 @@ segment_id_t SegmentCleaner::get_next_reclaim_segment() const
   for (auto& [_id, segment_info] : segments) {
     if (segment_info.is_closed() &&
         (trimmer == nullptr ||
-         !segment_info.is_in_journal(trimmer->get_journal_tail()))) {
+         !segment_info.is_in_journal(trimmer->get_journal_tail())) &&
+        !is_reclaiming(_id)) {
       double benefit_cost = calc_gc_benefit_cost(_id, now_time, bound_time);
-      if (benefit_cost > max_benefit_cost) {
-        id = _id;
-        max_benefit_cost = benefit_cost;
+      if (benefit_cost <= 0) {
+        continue;
+      }
+      candidates.emplace_back(benefit_cost, _id);
+      std::push_heap(candidates.begin(), candidates.end(), cmp);
+      if (candidates.size() > num) {
+        std::pop_heap(candidates.begin(), candidates.end(), cmp);
+        candidates.pop_back();
       }
     }
   }
-  if (id != NULL_SEG_ID) {
-    DEBUG("segment {}, benefit_cost {}",
-          id, max_benefit_cost);
-    return id;
-  } else {
+  // best first
+  std::sort_heap(candidates.begin(), candidates.end(), cmp);
+  std::vector<segment_id_t> ret;
+  ret.reserve(candidates.size());
+  for (auto &[benefit_cost, id] : candidates) {
+    DEBUG("segment {}, benefit_cost {}", id, benefit_cost);
+    ret.push_back(id);
+  }
+  if (ret.empty() && reclaim_states.empty()) {
     ceph_assert(get_segments_reclaimable() == 0);
     // see should_clean_space()
     ceph_abort_msg("impossible!");
-    return NULL_SEG_ID;
   }
+  return ret;
 }
 
 bool SegmentCleaner::try_reserve_projected_usage(std::size_t projected_usage)
@@ -1752,7 +1860,10 @@ void SegmentCleaner::print(std::ostream &os, bool is_detailed) const
   }
   os << ", projected_avail_ratio=" << get_projected_available_ratio()
      << ", reclaim_ratio=" << get_reclaim_ratio()
-     << ", alive_ratio=" << get_alive_ratio();
+     << ", alive_ratio=" << get_alive_ratio()
+     << ", reclaiming_segments=" << reclaim_states.size()
+     << ", reclaim_write_amplification="
+     << get_reclaim_write_amplification();
   if (is_detailed) {
     os << ", unavailable_unreclaimable=0x" << std::hex
        << get_unavailable_unreclaimable_bytes() << "B"
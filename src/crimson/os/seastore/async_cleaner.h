@@ -1254,29 +1254,35 @@ public:
     double available_ratio_hard_limit = 0;
     /// Ratio of minimum reclaimable space to stop reclaiming.
     double reclaim_ratio_gc_threshold = 0;
-    /// Number of bytes to reclaim per cycle
+    /// Number of bytes to reclaim per cycle from each victim segment
     std::size_t reclaim_bytes_per_cycle = 0;
+    /// Maximum number of victim segments to reclaim in one cycle, reached
+    /// when the available ratio drops to available_ratio_hard_limit.
+    std::size_t max_reclaim_segments_per_cycle = 0;
 
     void validate() const {
       ceph_assert(available_ratio_gc_max > available_ratio_hard_limit);
       ceph_assert(reclaim_bytes_per_cycle > 0);
+      ceph_assert(max_reclaim_segments_per_cycle > 0);
     }
 
     static config_t get_default() {
       return config_t{
-        .15,  // available_ratio_gc_max
-        .1,   // available_ratio_hard_limit
-        .1,   // reclaim_ratio_gc_threshold
-        1<<20 // reclaim_bytes_per_cycle
+        .15,   // available_ratio_gc_max
+        .1,    // available_ratio_hard_limit
+        .1,    // reclaim_ratio_gc_threshold
+        1<<20, // reclaim_bytes_per_cycle
+        4      // max_reclaim_segments_per_cycle
       };
     }
 
     static config_t get_test() {
       return config_t{
-        .99,  // available_ratio_gc_max
-        .2,   // available_ratio_hard_limit
-        .6,   // reclaim_ratio_gc_threshold
-        1<<20 // reclaim_bytes_per_cycle
+        .99,   // available_ratio_gc_max
+        .2,    // available_ratio_hard_limit
+        .6,    // reclaim_ratio_gc_threshold
+        1<<20, // reclaim_bytes_per_cycle
+        2      // max_reclaim_segments_per_cycle
       };
     }
   };
@@ -1417,7 +1423,8 @@ public:
   }
 
   std::size_t get_reclaim_size_per_cycle() const final {
-    return config.reclaim_bytes_per_cycle;
+    return config.reclaim_bytes_per_cycle *
+      config.max_reclaim_segments_per_cycle;
   }
 
   // Testing interfaces
@@ -1457,7 +1464,16 @@ private:
       const sea_time_point &now_time,
       const sea_time_point &bound_time) const;
 
-  segment_id_t get_next_reclaim_segment() const;
+  /*
+   * Number of victim segments to reclaim in parallel, scaled linearly
+   * from 1 at available_ratio_gc_max up to max_reclaim_segments_per_cycle
+   * at available_ratio_hard_limit.
+   */
+  std::size_t get_reclaim_parallelism() const;
+
+  /// Pick up to num closed segments with the highest benefit-cost that are
+  /// not already being reclaimed, best first.
+  std::vector<segment_id_t> get_next_reclaim_segments(std::size_t num) const;
 
   struct reclaim_state_t {
     rewrite_gen_t generation;
@@ -1465,6 +1481,8 @@ private:
     segment_off_t segment_size;
     paddr_t start_pos;
     paddr_t end_pos;
+    /// alive bytes rewritten from this segment so far
+    std::size_t reclaimed_bytes = 0;
 
     static reclaim_state_t create(
         segment_id_t segment_id,
@@ -1507,16 +1525,36 @@ private:
       }
     }
   };
-  std::optional<reclaim_state_t> reclaim_state;
+  /// victim segments being reclaimed, at most max_reclaim_segments_per_cycle
+  std::vector<reclaim_state_t> reclaim_states;
+
+  bool is_reclaiming(segment_id_t id) const {
+    return std::any_of(
+      reclaim_states.begin(), reclaim_states.end(),
+      [id](const auto &state) { return state.get_segment_id() == id; });
+  }
+
+  /// backref extents and mappings of the current range of a victim segment
+  struct reclaim_range_t {
+    std::vector<CachedExtentRef> backref_extents;
+    backref_mapping_list_t pin_list;
+  };
 
   using do_reclaim_space_ertr = base_ertr;
   using do_reclaim_space_ret = do_reclaim_space_ertr::future<>;
+  /// rewrite the live extents of all ranges, ranges[i] belonging to
+  /// reclaim_states[i], within a single transaction
   do_reclaim_space_ret do_reclaim_space(
-    const std::vector<CachedExtentRef> &backref_extents,
-    const backref_mapping_list_t &pin_list,
-    std::size_t &reclaimed,
+    const std::vector<reclaim_range_t> &ranges,
+    std::vector<std::size_t> &reclaimed,
     std::size_t &runs);
 
+  using release_reclaimed_segment_ertr = clean_space_ertr;
+  using release_reclaimed_segment_ret =
+    release_reclaimed_segment_ertr::future<>;
+  release_reclaimed_segment_ret release_reclaimed_segment(
+    segment_id_t segment_to_release);
+
   /*
    * Segments calculations
    */
@@ -1569,6 +1607,13 @@ private:
   double get_alive_ratio() const {
     return stats.used_bytes / (double)segments.get_total_bytes();
   }
+  /// device bytes written by reclaim per byte of space it freed, plus one
+  double get_reclaim_write_amplification() const {
+    assert(stats.reclaimed_segment_bytes >= stats.reclaimed_bytes);
+    auto freed = stats.reclaimed_segment_bytes - stats.reclaimed_bytes;
+    if (freed == 0) return 1;
+    return 1 + (double)stats.reclaimed_bytes / (double)freed;
+  }
 
   /*
    * Space calculations (projected)
@@ -1649,9 +1694,11 @@ private:
     uint64_t closed_ool_used_bytes = 0;
     uint64_t closed_ool_total_bytes = 0;
 
-    uint64_t reclaiming_bytes = 0;
     uint64_t reclaimed_bytes = 0;
     uint64_t reclaimed_segment_bytes = 0;
+    uint64_t reclaim_cycles = 0;
+    /// sum of the victim segments of every cycle
+    uint64_t reclaim_cycle_segments = 0;
 
     seastar::metrics::histogram segment_util;
   } stats;
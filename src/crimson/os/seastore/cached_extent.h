@@ -265,6 +265,8 @@ private:
   map_t buffer_map;
 };
 
+// Also used by ExtentPinboardARC, where WarmIn is the recency list (T1)
+// and Hot the frequency list (T2).
 enum class extent_2q_state_t : uint8_t {
   Fresh = 0,
   WarmIn,
@@ -825,18 +827,27 @@ public:
   is_viewable_by_trans(Transaction &t);
 
   extent_2q_state_t get_2q_state() const {
-    assert("2Q" == crimson::common::get_conf<std::string>
+    assert("LRU" != crimson::common::get_conf<std::string>
 	   ("seastore_cachepin_type"));
     return cache_state;
   }
 
   void set_2q_state(extent_2q_state_t state) {
-    assert("2Q" == crimson::common::get_conf<std::string>
+    assert("LRU" != crimson::common::get_conf<std::string>
 	   ("seastore_cachepin_type"));
     assert(state < extent_2q_state_t::Max);
     cache_state = state;
   }
 
+  /// see ExtentPinboardARC
+  bool is_scan_admitted() const {
+    return scan_admitted;
+  }
+
+  void set_scan_admitted(bool scan) {
+    scan_admitted = scan;
+  }
+
   extent_len_t get_last_touch_end() const {
     return last_touch_end;
   }
@@ -959,6 +970,9 @@ private:
   // This field is unused when the ExtentPinboard use LRU algorithm
   extent_2q_state_t cache_state = extent_2q_state_t::Fresh;
 
+  // set if ExtentPinboardARC admitted the extent for a scan
+  bool scan_admitted = false;
+
 protected:
   trans_view_set_t mutation_pending_extents;
   trans_view_set_t retired_transactions;
@@ -99,11 +99,37 @@ public:
   std::list<CachedExtentRef> add_to_top(
     CachedExtent &extent,
     const Transaction::src_t* p_src) {
+    return add(extent, p_src, true);
+  }
+
+  // the extent will be the next one to be evicted
+  std::list<CachedExtentRef> add_to_bottom(
+    CachedExtent &extent,
+    const Transaction::src_t* p_src) {
+    return add(extent, p_src, false);
+  }
+
+  bool empty() const {
+    return list.empty();
+  }
+
+  CachedExtentRef evict_bottom(const Transaction::src_t* p_src) {
+    assert(!list.empty());
+    CachedExtentRef ret = &list.front();
+    do_remove_from_list(list.front(), p_src);
+    return ret;
+  }
+
+private:
+  std::list<CachedExtentRef> add(
+    CachedExtent &extent,
+    const Transaction::src_t* p_src,
+    bool top) {
     assert(extent.is_stable_clean());
     assert(!extent.is_placeholder());
     assert(!extent.is_linked_to_list());
 
-    // absent, add to top (back)
+    // absent, add to top (back) or bottom (front)
     auto extent_loaded_length = extent.get_loaded_length();
     if (extent_loaded_length > 0) {
       current_size += extent_loaded_length;
@@ -118,10 +144,15 @@ public:
       //       account the io later in increase_cached_size() upon read_extent()
     get_by_ext(sizes_by_ext, extent.get_type()).account_in(extent_loaded_length);
     intrusive_ptr_add_ref(&extent);
-    list.push_back(extent);
+    if (top) {
+      list.push_back(extent);
+    } else {
+      list.push_front(extent);
+    }
     return trim_to_capacity(p_src);
   }
 
+public:
   void move_to_top(
     CachedExtent &extent,
     const Transaction::src_t* p_src) {
@@ -847,6 +878,463 @@ void ExtentPinboardTwoQ::register_metrics() {
   );
 }
 
+/**
+ * ARCPartition
+ *
+ * Adaptive replacement cache over a byte budget:
+ * - t1: LRU of extents referenced once since they were admitted
+ * - t2: LRU of extents referenced at least twice
+ * - b1/b2: ghosts (laddr and size) of logical extents recently evicted
+ *   from t1/t2
+ * - target: the size t1 is steered to.  A miss found in b1 means t1 is
+ *   too small and grows it, a miss found in b2 shrinks it.
+ *
+ * Scan accesses (background transactions, or a read continuing where the
+ * previous read of the extent ended, see IndexedFifoQueue) neither
+ * promote extents to t2 nor refresh them.  A scan miss is admitted at
+ * the bottom of t1 and leaves no ghost when evicted, so a large scan
+ * cannot push the working set in t2 out.
+ *
+ * Physical extents (lba and backref nodes) have no stable identity
+ * after being evicted, so like in the 2Q pinboard they go straight to t2
+ * unless admitted by a scan.
+ *
+ * The extent_2q_state_t of an extent tells which list it is in:
+ * WarmIn is t1 and Hot is t2.
+ */
+class ARCPartition {
+public:
+  explicit ARCPartition(std::size_t capacity)
+    : capacity(capacity),
+      t1(capacity),
+      t2(capacity),
+      b1(capacity),
+      b2(capacity) {}
+
+  std::size_t get_capacity_bytes() const {
+    return capacity;
+  }
+
+  std::size_t get_current_size_bytes() const {
+    return t1.get_current_size_bytes() + t2.get_current_size_bytes();
+  }
+
+  std::size_t get_current_num_extents() const {
+    return t1.get_current_num_extents() + t2.get_current_num_extents();
+  }
+
+  std::size_t get_target_bytes() const {
+    return target;
+  }
+
+  const ExtentQueue &get_t1() const {
+    return t1;
+  }
+
+  const ExtentQueue &get_t2() const {
+    return t2;
+  }
+
+  const IndexedFifoQueue &get_b1() const {
+    return b1;
+  }
+
+  const IndexedFifoQueue &get_b2() const {
+    return b2;
+  }
+
+  // returns true if the extent was pinned already
+  bool touch(
+    CachedExtent &extent,
+    const Transaction::src_t* p_src,
+    extent_len_t load_start,
+    extent_len_t load_length,
+    bool scan) {
+    auto end = load_start + load_length;
+    assert(end != 0);
+    // a ghost left by this extent must record where this access ended
+    extent.set_last_touch_end(end);
+
+    auto state = extent.get_2q_state();
+    if (extent.is_linked_to_list()) {
+      if (state == extent_2q_state_t::WarmIn) {
+        if (!scan) {
+          t1.remove(extent);
+          extent.set_scan_admitted(false);
+          extent.set_2q_state(extent_2q_state_t::Hot);
+          auto trimmed_extents = t2.add_to_top(extent, p_src);
+          on_evicted(trimmed_extents, b2);
+          replace(p_src, false);
+        }
+      } else {
+        ceph_assert(state == extent_2q_state_t::Hot);
+        if (!scan) {
+          t2.move_to_top(extent, p_src);
+        }
+      }
+      return true;
+    }
+
+    ceph_assert(state == extent_2q_state_t::Fresh);
+    bool b2_hit = false;
+    bool frequent = !is_logical_type(extent.get_type());
+    if (!frequent) {
+      using AccessMode = IndexedFifoQueue::AccessMode;
+      auto laddr = extent.cast<LogicalCachedExtent>()->get_laddr();
+      auto m = b1.accessed_recently(laddr, load_start);
+      bool in_b1 = m != AccessMode::Missing;
+      if (!in_b1) {
+        m = b2.accessed_recently(laddr, load_start);
+      }
+      if (m == AccessMode::ContinueFromLastEnd) {
+        scan = true;
+      } else if (m == AccessMode::Again && !scan) {
+        adapt(in_b1, load_length);
+        b2_hit = !in_b1;
+        frequent = true;
+      }
+    }
+
+    if (scan) {
+      extent.set_scan_admitted(true);
+      extent.set_2q_state(extent_2q_state_t::WarmIn);
+      auto trimmed_extents = t1.add_to_bottom(extent, p_src);
+      on_evicted(trimmed_extents, b1);
+    } else if (frequent) {
+      extent.set_2q_state(extent_2q_state_t::Hot);
+      auto trimmed_extents = t2.add_to_top(extent, p_src);
+      on_evicted(trimmed_extents, b2);
+    } else {
+      extent.set_2q_state(extent_2q_state_t::WarmIn);
+      auto trimmed_extents = t1.add_to_top(extent, p_src);
+      on_evicted(trimmed_extents, b1);
+    }
+    replace(p_src, b2_hit);
+    return false;
+  }
+
+  void remove(CachedExtent &extent) {
+    auto state = extent.get_2q_state();
+    if (extent.is_linked_to_list()) {
+      if (state == extent_2q_state_t::WarmIn) {
+        t1.remove(extent);
+      } else {
+        ceph_assert(state == extent_2q_state_t::Hot);
+        t2.remove(extent);
+      }
+      extent.set_2q_state(extent_2q_state_t::Fresh);
+      extent.set_scan_admitted(false);
+    } else {
+      ceph_assert(state == extent_2q_state_t::Fresh);
+    }
+  }
+
+  void increase_cached_size(
+    CachedExtent &extent,
+    extent_len_t increased_length,
+    const Transaction::src_t* p_src) {
+    if (!extent.is_linked_to_list()) {
+      return;
+    }
+    if (extent.get_2q_state() == extent_2q_state_t::WarmIn) {
+      auto trimmed_extents = t1.increase_cached_size(
+        extent, increased_length, p_src);
+      on_evicted(trimmed_extents, b1);
+    } else {
+      ceph_assert(extent.get_2q_state() == extent_2q_state_t::Hot);
+      auto trimmed_extents = t2.increase_cached_size(
+        extent, increased_length, p_src);
+      on_evicted(trimmed_extents, b2);
+    }
+    replace(p_src, false);
+  }
+
+  void get_stats(
+    std::string_view name,
+    cache_stats_t &stats,
+    bool report_detail,
+    double seconds) const {
+    t2.get_stats(fmt::format("ARC_{}_T2", name), stats, report_detail, seconds);
+    cache_stats_t recent;
+    t1.get_stats(fmt::format("ARC_{}_T1", name), recent, report_detail, seconds);
+    stats.add(recent);
+  }
+
+  void clear() {
+    t1.clear();
+    t2.clear();
+    b1.clear();
+    b2.clear();
+    target = 0;
+  }
+
+private:
+  void adapt(bool in_b1, extent_len_t length) {
+    auto b1_size = std::max<std::size_t>(b1.get_tracked_size_bytes(), 1);
+    auto b2_size = std::max<std::size_t>(b2.get_tracked_size_bytes(), 1);
+    if (in_b1) {
+      auto delta = static_cast<std::size_t>(
+        length * std::max(1.0, double(b2_size) / b1_size));
+      target = std::min(capacity, target + delta);
+    } else {
+      auto delta = static_cast<std::size_t>(
+        length * std::max(1.0, double(b1_size) / b2_size));
+      target = target > delta ? target - delta : 0;
+    }
+  }
+
+  // evict from t1 or t2 until the pinned extents fit in the budget
+  void replace(const Transaction::src_t* p_src, bool b2_hit) {
+    while (get_current_size_bytes() > capacity) {
+      auto t1_size = t1.get_current_size_bytes();
+      if (!t1.empty() &&
+          (t1_size > target || (b2_hit && t1_size == target) || t2.empty())) {
+        on_evicted(t1.evict_bottom(p_src), b1);
+      } else {
+        assert(!t2.empty());
+        on_evicted(t2.evict_bottom(p_src), b2);
+      }
+    }
+  }
+
+  void on_evicted(CachedExtentRef extent, IndexedFifoQueue &ghosts) {
+    extent->set_2q_state(extent_2q_state_t::Fresh);
+    bool scan = extent->is_scan_admitted();
+    extent->set_scan_admitted(false);
+    if (scan || !is_logical_type(extent->get_type())) {
+      return;
+    }
+    auto len = extent->get_loaded_length();
+    if (len == 0) {
+      // see ExtentPinboardTwoQ::on_update_warm_in()
+      return;
+    }
+    auto laddr = extent->cast<LogicalCachedExtent>()->get_laddr();
+    // another extent at laddr may have left a ghost behind
+    b1.accessed_recently(laddr, 0);
+    b2.accessed_recently(laddr, 0);
+    ghosts.add(laddr, len, extent->get_last_touch_end());
+  }
+
+  void on_evicted(
+    std::list<CachedExtentRef> &extents,
+    IndexedFifoQueue &ghosts) {
+    for (auto &extent : extents) {
+      on_evicted(extent, ghosts);
+    }
+  }
+
+  const std::size_t capacity;
+  std::size_t target = 0;
+  ExtentQueue t1;
+  ExtentQueue t2;
+  IndexedFifoQueue b1;
+  IndexedFifoQueue b2;
+};
+
+/**
+ * ExtentPinboardARC
+ *
+ * Two ARCPartitions with separate budgets, one for data extents and one
+ * for metadata (lba, backref, onode, omap, ...) extents, so that reading
+ * large objects cannot evict the trees needed to find them.
+ */
+class ExtentPinboardARC : public ExtentPinboard {
+public:
+  ExtentPinboardARC(std::size_t data_capacity, std::size_t mdat_capacity)
+    : data(data_capacity), mdat(mdat_capacity)
+  {
+    LOG_PREFIX(ExtentPinboardARC::ExtentPinboardARC);
+    INFO("created, data_capacity=0x{:x}B, mdat_capacity=0x{:x}B",
+         data_capacity, mdat_capacity);
+  }
+
+  std::size_t get_capacity_bytes() const {
+    return data.get_capacity_bytes() + mdat.get_capacity_bytes();
+  }
+
+  std::size_t get_current_size_bytes() const final {
+    return data.get_current_size_bytes() + mdat.get_current_size_bytes();
+  }
+
+  std::size_t get_current_num_extents() const final {
+    return data.get_current_num_extents() + mdat.get_current_num_extents();
+  }
+
+  void register_metrics() final;
+
+  void get_stats(
+    cache_stats_t &stats,
+    bool report_detail,
+    double seconds) const final;
+
+  void remove(CachedExtent &extent) final {
+    get_partition(extent.get_type()).remove(extent);
+  }
+
+  void move_to_top(
+    CachedExtent &extent,
+    const Transaction::src_t* p_src,
+    extent_len_t load_start,
+    extent_len_t load_length) final {
+    auto type = extent.get_type();
+    bool scan = p_src && is_background_transaction(*p_src);
+    if (get_partition(type).touch(
+          extent, p_src, load_start, load_length, scan)) {
+      ++get_by_ext(hits, type);
+    } else {
+      ++get_by_ext(misses, type);
+    }
+  }
+
+  void increase_cached_size(
+    CachedExtent &extent,
+    extent_len_t increased_length,
+    const Transaction::src_t* p_src) final {
+    get_partition(extent.get_type()).increase_cached_size(
+      extent, increased_length, p_src);
+  }
+
+  void clear() final {
+    LOG_PREFIX(ExtentPinboardARC::clear);
+    INFO("close with data: {}({}B), mdat: {}({}B)",
+         data.get_current_num_extents(), data.get_current_size_bytes(),
+         mdat.get_current_num_extents(), mdat.get_current_size_bytes());
+    data.clear();
+    mdat.clear();
+  }
+
+  ~ExtentPinboardARC() {
+    clear();
+  }
+
+private:
+  ARCPartition &get_partition(extent_types_t type) {
+    return is_data_type(type) ? data : mdat;
+  }
+
+  ARCPartition data;
+  ARCPartition mdat;
+  seastar::metrics::metric_group metrics;
+
+  // whether an extent was pinned when touching it, by extent type
+  counter_by_extent_t<uint64_t> hits = {};
+  counter_by_extent_t<uint64_t> misses = {};
+  mutable counter_by_extent_t<uint64_t> last_hits = {};
+  mutable counter_by_extent_t<uint64_t> last_misses = {};
+};
+
+void ExtentPinboardARC::get_stats(
+  cache_stats_t &stats,
+  bool report_detail,
+  double seconds) const
+{
+  LOG_PREFIX(ExtentPinboardARC::get_stats);
+  data.get_stats("data", stats, report_detail, seconds);
+  cache_stats_t mdat_stats;
+  mdat.get_stats("mdat", mdat_stats, report_detail, seconds);
+  stats.add(mdat_stats);
+
+  if (!report_detail || seconds == 0) {
+    return;
+  }
+
+  std::ostringstream oss;
+  auto dump_partition = [&oss](std::string_view name, const ARCPartition &p) {
+    oss << "\nARC " << name
+        << ": t1=" << p.get_t1().get_current_size_bytes()
+        << "B/target=" << p.get_target_bytes()
+        << "B, t2=" << p.get_t2().get_current_size_bytes()
+        << "B, b1=" << p.get_b1().get_tracked_size_bytes()
+        << "B, b2=" << p.get_b2().get_tracked_size_bytes()
+        << "B, capacity=" << p.get_capacity_bytes() << "B";
+  };
+  dump_partition("data", data);
+  dump_partition("mdat", mdat);
+  for (uint8_t _ext = 0; _ext < EXTENT_TYPES_MAX; ++_ext) {
+    auto ext = static_cast<extent_types_t>(_ext);
+    auto hit = get_by_ext(hits, ext) - get_by_ext(last_hits, ext);
+    auto miss = get_by_ext(misses, ext) - get_by_ext(last_misses, ext);
+    if (hit + miss == 0) {
+      continue;
+    }
+    oss << "\n  " << ext << ": hit_ratio=" << double(hit) / (hit + miss)
+        << ", " << double(hit + miss) / seconds << "ps";
+  }
+  INFO("{}", oss.str());
+  last_hits = hits;
+  last_misses = misses;
+}
+
+void ExtentPinboardARC::register_metrics() {
+  namespace sm = seastar::metrics;
+  auto partition_label = sm::label("partition");
+  for (auto [name, p] : {std::make_pair("data", &data),
+                         std::make_pair("mdat", &mdat)}) {
+    metrics.add_group(
+      "cache",
+      {
+        sm::make_counter(
+          "arc_t1_size_bytes",
+          [p] {
+            return p->get_t1().get_current_size_bytes();
+          },
+          sm::description("total bytes pinned by the arc recency list"),
+          {partition_label(name)}
+        ),
+        sm::make_counter(
+          "arc_t2_size_bytes",
+          [p] {
+            return p->get_t2().get_current_size_bytes();
+          },
+          sm::description("total bytes pinned by the arc frequency list"),
+          {partition_label(name)}
+        ),
+        sm::make_counter(
+          "arc_t1_target_bytes",
+          [p] {
+            return p->get_target_bytes();
+          },
+          sm::description("adaptive target size of the arc recency list"),
+          {partition_label(name)}
+        ),
+        sm::make_counter(
+          "arc_num_extents",
+          [p] {
+            return p->get_current_num_extents();
+          },
+          sm::description("total extents pinned by the arc"),
+          {partition_label(name)}
+        ),
+      }
+    );
+  }
+  auto ext_label = sm::label("ext");
+  for (uint8_t _ext = 0; _ext < EXTENT_TYPES_MAX; ++_ext) {
+    auto ext = static_cast<extent_types_t>(_ext);
+    if (is_retired_placeholder_type(ext)) {
+      continue;
+    }
+    std::ostringstream oss;
+    oss << ext;
+    metrics.add_group(
+      "cache",
+      {
+        sm::make_counter(
+          "arc_hit", get_by_ext(hits, ext),
+          sm::description("total count of the extents that are pinned by the arc when touching them"),
+          {ext_label(oss.str())}
+        ),
+        sm::make_counter(
+          "arc_miss", get_by_ext(misses, ext),
+          sm::description("total count of the extents that are not pinned by the arc when touching them"),
+          {ext_label(oss.str())}
+        ),
+      }
+    );
+  }
+}
+
 ExtentPinboardRef create_extent_pinboard(std::size_t capacity) {
   using crimson::common::get_conf;
   auto algorithm = get_conf<std::string>("seastore_cachepin_type");
@@ -861,8 +1349,14 @@ ExtentPinboardRef create_extent_pinboard(std::size_t capacity) {
       capacity * warm_in_ratio,
       capacity * warm_out_ratio,
       capacity * (1 - warm_in_ratio));
+  } else if (algorithm == "ARC") {
+    auto data_ratio = get_conf<double>("seastore_cachepin_arc_data_ratio");
+    ceph_assert(0 < data_ratio && data_ratio < 1);
+    return std::make_unique<ExtentPinboardARC>(
+      capacity * data_ratio,
+      capacity * (1 - data_ratio));
   } else {
-    ceph_abort("invalid seastore_cachepin_type(LRU or 2Q)");
+    ceph_abort("invalid seastore_cachepin_type(LRU, 2Q or ARC)");
     return nullptr;
   }
 }
@@ -187,6 +187,53 @@ SegmentedOolWriter::alloc_write_ool_extents(
   });
 }
 
+void ExtentPlacementManager::note_committed_writes(const Transaction &t)
+{
+  if (!temperature_tracker.is_enabled() ||
+      !is_user_transaction(t.get_src())) {
+    return;
+  }
+  t.for_each_finalized_fresh_block([this](const CachedExtentRef &extent) {
+    if (is_data_type(extent->get_type())) {
+      auto &lextent = static_cast<const LogicalCachedExtent&>(*extent);
+      temperature_tracker.note_write(
+        lextent.get_laddr(), lextent.get_length());
+    }
+  });
+}
+
+rewrite_gen_t ExtentPlacementManager::adjust_rewrite_generation_by_temperature(
+  laddr_t laddr,
+  extent_len_t len,
+  rewrite_gen_t gen)
+{
+  LOG_PREFIX(ExtentPlacementManager::adjust_rewrite_generation_by_temperature);
+  assert(is_target_rewrite_generation(gen, dynamic_max_rewrite_generation));
+  if (!temperature_tracker.is_enabled() || gen == INIT_GENERATION) {
+    return gen;
+  }
+  bool in_cold_tier = background_process.has_cold_tier() &&
+    gen > hot_tier_generations;
+  auto temperature = temperature_tracker.get_temperature(laddr, len);
+  auto ret = gen;
+  if (temperature == extent_temperature_t::HOT) {
+    // don't move extents from the cold tier back, the cold cleaner only
+    // reserves space there.
+    ret = in_cold_tier ? hot_tier_generations : MIN_REWRITE_GENERATION;
+  } else if (temperature == extent_temperature_t::COLD) {
+    if (background_process.has_cold_tier()) {
+      ret = std::max(gen, hot_tier_generations);
+    } else {
+      ret = dynamic_max_rewrite_generation;
+    }
+  }
+  TRACE("{}~0x{:x} is {}, gen {} -> {}",
+        laddr, len, temperature,
+        rewrite_gen_printer_t{gen}, rewrite_gen_printer_t{ret});
+  assert(is_target_rewrite_generation(ret, dynamic_max_rewrite_generation));
+  return ret;
+}
+
 void ExtentPlacementManager::init(
     JournalTrimmerImplRef &&trimmer,
     AsyncCleanerRef &&cleaner,
@@ -8,6 +8,7 @@
 
 #include "crimson/os/seastore/async_cleaner.h"
 #include "crimson/os/seastore/cached_extent.h"
+#include "crimson/os/seastore/extent_temperature_tracker.h"
 #include "crimson/os/seastore/journal/segment_allocator.h"
 #include "crimson/os/seastore/journal/record_submitter.h"
 #include "crimson/os/seastore/transaction.h"
@@ -275,12 +276,14 @@ public:
       ool_segment_seq_allocator(
           std::make_unique<SegmentSeqAllocator>(segment_type_t::OOL)),
       max_data_allocation_size(crimson::common::get_conf<Option::size_t>(
-	  "seastore_max_data_allocation_size"))
+	  "seastore_max_data_allocation_size")),
+      temperature_tracker(ExtentTemperatureTracker::config_t::load())
   {
     LOG_PREFIX(ExtentPlacementManager::ExtentPlacementManager);
     devices_by_id.resize(DEVICE_ID_MAX, nullptr);
     SUBINFO(seastore_epm, "cold_tier_generations={}, hot_tier_generations={}",
       cold_tier_generations, hot_tier_generations);
+    temperature_tracker.register_metrics();
   }
 
   void init(JournalTrimmerImplRef &&, AsyncCleanerRef &&, AsyncCleanerRef &&);
@@ -295,6 +298,23 @@ public:
     background_process.set_extent_callback(cb);
   }
 
+  /// note the data extents written by a committed user transaction
+  void note_committed_writes(const Transaction &t);
+
+  /**
+   * adjust_rewrite_generation_by_temperature
+   *
+   * Hot data extents are likely to be overwritten again soon, so they are
+   * rewritten to the youngest generation of their tier instead of aging
+   * with the rest.  Cold ones skip the remaining generations of the hot
+   * tier and go to the cold tier if there is one.  Otherwise gen is
+   * returned as is.
+   */
+  rewrite_gen_t adjust_rewrite_generation_by_temperature(
+    laddr_t laddr,
+    extent_len_t len,
+    rewrite_gen_t gen);
+
   bool can_inplace_rewrite(Transaction& t, CachedExtentRef extent) {
     auto writer = get_writer(placement_hint_t::REWRITE,
       get_extent_category(extent->get_type()),
@@ -1127,6 +1147,7 @@ private:
   // TODO: drop once paddr->journal_seq_t is introduced
   SegmentSeqAllocatorRef ool_segment_seq_allocator;
   extent_len_t max_data_allocation_size = 0;
+  ExtentTemperatureTracker temperature_tracker;
 
   friend class ::transaction_manager_test_t;
   friend class Cache;
@@ -0,0 +1,144 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include "crimson/os/seastore/extent_temperature_tracker.h"
+
+#include <seastar/core/metrics.hh>
+
+#include "crimson/common/config_proxy.h"
+#include "crimson/os/seastore/logging.h"
+
+SET_SUBSYS(seastore_epm);
+
+namespace crimson::os::seastore {
+
+std::ostream &operator<<(std::ostream &out, extent_temperature_t t)
+{
+  switch (t) {
+  case extent_temperature_t::HOT:
+    return out << "HOT";
+  case extent_temperature_t::WARM:
+    return out << "WARM";
+  case extent_temperature_t::COLD:
+    return out << "COLD";
+  default:
+    return out << "INVALID_TEMPERATURE!";
+  }
+}
+
+ExtentTemperatureTracker::config_t
+ExtentTemperatureTracker::config_t::load()
+{
+  config_t ret;
+  ret.max_entries = crimson::common::get_conf<uint64_t>(
+    "seastore_extent_temperature_max_entries");
+  ret.chunk_size = crimson::common::get_conf<Option::size_t>(
+    "seastore_extent_temperature_chunk_size");
+  ret.hot_threshold = crimson::common::get_conf<uint64_t>(
+    "seastore_extent_temperature_hot_threshold");
+  return ret;
+}
+
+ExtentTemperatureTracker::ExtentTemperatureTracker(config_t _config)
+  : config(_config)
+{
+  LOG_PREFIX(ExtentTemperatureTracker::ExtentTemperatureTracker);
+  if (is_enabled()) {
+    ceph_assert(config.chunk_size > 0);
+    ceph_assert(config.chunk_size % laddr_t::UNIT_SIZE == 0);
+    ceph_assert(config.hot_threshold > 0);
+    INFO("max_entries={}, chunk_size=0x{:x}, hot_threshold={}",
+         config.max_entries, config.chunk_size, config.hot_threshold);
+    entries.reserve(config.max_entries);
+  }
+}
+
+void ExtentTemperatureTracker::note_write(laddr_t laddr, extent_len_t len)
+{
+  assert(is_enabled());
+  for_each_chunk(laddr, len, [this](laddr_t chunk) {
+    auto [it, inserted] = entries.try_emplace(chunk);
+    auto &entry = it->second;
+    entry.writes = get_decayed_writes(entry) + 1;
+    entry.epoch = epoch;
+    ++stats.chunk_writes;
+    if (++writes_in_epoch >= std::max<std::size_t>(config.max_entries / 2, 1)) {
+      ++epoch;
+      writes_in_epoch = 0;
+    }
+  });
+  if (entries.size() > config.max_entries) {
+    shrink();
+  }
+}
+
+extent_temperature_t
+ExtentTemperatureTracker::get_temperature(laddr_t laddr, extent_len_t len)
+{
+  assert(is_enabled());
+  uint32_t max_writes = 0;
+  for_each_chunk(laddr, len, [this, &max_writes](laddr_t chunk) {
+    auto it = entries.find(chunk);
+    if (it != entries.end()) {
+      max_writes = std::max(max_writes, get_decayed_writes(it->second));
+    }
+  });
+  if (max_writes >= config.hot_threshold) {
+    ++stats.num_hot;
+    return extent_temperature_t::HOT;
+  } else if (max_writes == 0 && epoch > 0) {
+    // untracked chunks are either forgotten after aging to zero, or haven't
+    // been written since the tracker started a full write window ago.
+    ++stats.num_cold;
+    return extent_temperature_t::COLD;
+  } else {
+    ++stats.num_warm;
+    return extent_temperature_t::WARM;
+  }
+}
+
+void ExtentTemperatureTracker::shrink()
+{
+  LOG_PREFIX(ExtentTemperatureTracker::shrink);
+  // leave some room so that shrink() isn't called on every new chunk
+  auto target = config.max_entries - config.max_entries / 4;
+  auto size_before = entries.size();
+  while (entries.size() > target) {
+    ++epoch;
+    writes_in_epoch = 0;
+    std::erase_if(entries, [this](const auto &p) {
+      return get_decayed_writes(p.second) == 0;
+    });
+  }
+  stats.forgotten += size_before - entries.size();
+  DEBUG("forgot {} chunks, {} remain, epoch={}",
+        size_before - entries.size(), entries.size(), epoch);
+}
+
+void ExtentTemperatureTracker::register_metrics()
+{
+  if (!is_enabled()) {
+    return;
+  }
+  namespace sm = seastar::metrics;
+  metrics.add_group("extent_temperature", {
+    sm::make_gauge("tracked_chunks",
+                   [this] { return entries.size(); },
+                   sm::description("the number of tracked logical address chunks")),
+    sm::make_counter("chunk_writes", stats.chunk_writes,
+                     sm::description("the number of noted chunk writes")),
+    sm::make_counter("forgotten_chunks", stats.forgotten,
+                     sm::description("the number of chunks forgotten after aging")),
+    sm::make_counter("lookups", stats.num_hot,
+                     sm::description("the number of temperature lookups"),
+                     {sm::label_instance("temperature", "hot")}),
+    sm::make_counter("lookups", stats.num_warm,
+                     sm::description("the number of temperature lookups"),
+                     {sm::label_instance("temperature", "warm")}),
+    sm::make_counter("lookups", stats.num_cold,
+                     sm::description("the number of temperature lookups"),
+                     {sm::label_instance("temperature", "cold")}),
+  });
+}
+
+} // namespace crimson::os::seastore
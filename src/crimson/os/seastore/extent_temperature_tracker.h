@@ -0,0 +1,111 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#pragma once
+
+#include <unordered_map>
+
+#include <seastar/core/metrics_types.hh>
+
+#include "crimson/os/seastore/seastore_types.h"
+
+namespace crimson::os::seastore {
+
+enum class extent_temperature_t : uint8_t {
+  HOT,   // overwritten at least hot_threshold times recently
+  WARM,  // written recently, or not enough history to tell
+  COLD,  // not written within the recent write window
+};
+
+std::ostream &operator<<(std::ostream &out, extent_temperature_t t);
+
+/**
+ * ExtentTemperatureTracker
+ *
+ * Tracks how often the logical address space of data extents is written by
+ * user transactions, at the granularity of chunk_size.  Each chunk holds a
+ * write counter which is halved every time max_entries / 2 chunk writes
+ * have been noted, so the counters reflect the recent write window only.
+ *
+ * The number of tracked chunks is bounded by max_entries; when it is
+ * exceeded, the counters are aged until enough of them drop to zero and
+ * can be forgotten.
+ */
+class ExtentTemperatureTracker {
+public:
+  struct config_t {
+    /// maximum number of tracked chunks, 0 disables the tracker
+    std::size_t max_entries = 0;
+    /// bytes of logical address space per tracked chunk
+    extent_len_t chunk_size = 0;
+    /// decayed write count from which a chunk is considered hot
+    uint32_t hot_threshold = 0;
+
+    static config_t load();
+  };
+
+  explicit ExtentTemperatureTracker(config_t config);
+
+  bool is_enabled() const {
+    return config.max_entries > 0;
+  }
+
+  /// note a committed user write to laddr~len
+  void note_write(laddr_t laddr, extent_len_t len);
+
+  /// temperature of laddr~len, that of its hottest chunk
+  extent_temperature_t get_temperature(laddr_t laddr, extent_len_t len);
+
+  std::size_t get_num_entries() const {
+    return entries.size();
+  }
+
+  void register_metrics();
+
+private:
+  struct entry_t {
+    uint32_t writes = 0;
+    uint32_t epoch = 0;
+  };
+
+  uint32_t get_decayed_writes(const entry_t &entry) const {
+    auto age = epoch - entry.epoch;
+    if (age >= 32) {
+      return 0;
+    }
+    return entry.writes >> age;
+  }
+
+  template <typename F>
+  void for_each_chunk(laddr_t laddr, extent_len_t len, F &&f) const {
+    assert(len > 0);
+    auto chunk = laddr_offset_t(laddr).get_aligned_laddr(config.chunk_size);
+    auto end = laddr + len;
+    while (chunk < end) {
+      f(chunk);
+      chunk = (chunk + config.chunk_size).checked_to_laddr();
+    }
+  }
+
+  void shrink();
+
+  const config_t config;
+  std::unordered_map<laddr_t, entry_t, laddr_t::laddr_hash_t> entries;
+  uint32_t epoch = 0;
+  std::size_t writes_in_epoch = 0;
+
+  struct {
+    uint64_t chunk_writes = 0;
+    uint64_t num_hot = 0;
+    uint64_t num_warm = 0;
+    uint64_t num_cold = 0;
+    uint64_t forgotten = 0;
+  } stats;
+  seastar::metrics::metric_group metrics;
+};
+
+} // namespace crimson::os::seastore
+
+#if FMT_VERSION >= 90000
+template <> struct fmt::formatter<crimson::os::seastore::extent_temperature_t> : fmt::ostream_formatter {};
+#endif
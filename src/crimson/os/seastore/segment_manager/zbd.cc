@@ -776,7 +776,11 @@ Segment::write_ertr::future<> ZBDSegment::write_padding_bytes(
   DEBUG("Writing 0x{:x} padding bytes to segment {} at wp 0x{:x}",
         padding_bytes, id, write_pointer);
 
-  return crimson::repeat([FNAME, padding_bytes, this] () mutable {
+  // every chunk is written from the same zeroed buffer
+  bufferptr zeros(ceph::buffer::create_page_aligned(
+    std::min<size_t>(padding_bytes, MAX_PADDING_SIZE)));
+  zeros.zero();
+  return crimson::repeat([FNAME, padding_bytes, zeros, this] () mutable {
     size_t bufsize = 0;
     if (padding_bytes >= MAX_PADDING_SIZE) {
       bufsize = MAX_PADDING_SIZE;
@@ -785,10 +789,8 @@ Segment::write_ertr::future<> ZBDSegment::write_padding_bytes(
     }
 
     padding_bytes -= bufsize;
-    bufferptr bp(ceph::buffer::create_page_aligned(bufsize));
-    bp.zero();
     bufferlist padd_bl;
-    padd_bl.append(bp);
+    padd_bl.append(bufferptr(zeros, 0, bufsize));
     return write(write_pointer, padd_bl).safe_then([FNAME, padding_bytes, this]() {
       if (padding_bytes == 0) {
         return write_ertr::make_ready_future<seastar::stop_iteration>(seastar::stop_iteration::yes);
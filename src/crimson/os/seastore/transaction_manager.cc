@@ -612,6 +612,7 @@ TransactionManager::do_submit_transaction(
       tref,
       submit_result.record_block_base,
       start_seq);
+    epm->note_committed_writes(tref);
     journal->get_trimmer().update_journal_tails(
       cache->get_oldest_dirty_from().value_or(start_seq),
       cache->get_oldest_backref_dirty_from().value_or(start_seq));
@@ -717,7 +718,10 @@ TransactionManager::rewrite_logical_extent(
         extent->get_length(),
         extent->get_user_hint(),
         // get target rewrite generation
-        extent->get_rewrite_generation());
+        epm->adjust_rewrite_generation_by_temperature(
+          extent->get_laddr(),
+          extent->get_length(),
+          extent->get_rewrite_generation()));
       return seastar::do_with(
         std::move(extents),
         0,
@@ -1057,6 +1061,9 @@ TransactionManagerRef make_transaction_manager(
   } else {
     cleaner_is_detailed = false;
     cleaner_config = SegmentCleaner::config_t::get_default();
+    cleaner_config.max_reclaim_segments_per_cycle =
+      crimson::common::get_conf<uint64_t>(
+        "seastore_segment_cleaner_max_parallel_segments");
     trimmer_config = JournalTrimmerImpl::config_t::get_default(
         roll_size, backend_type);
   }
@@ -511,6 +511,24 @@ seastar::future<> OSD::start()
       stats_timer.arm_periodic(std::chrono::seconds(stats_seconds));
     }
 
+    pg_shard_manager.set_pg_migration_supported(
+      !store.collections_are_core_local());
+    auto rebalance_seconds = local_conf().get_val<uint64_t>(
+      "crimson_osd_pg_rebalance_interval");
+    if (rebalance_seconds > 0 &&
+        pg_shard_manager.is_pg_migration_supported()) {
+      pg_rebalance_timer.set_callback([this] {
+        if (!pg_shard_manager.is_active()) {
+          return;
+        }
+        gate.dispatch_in_background("pg_rebalance", *this, [this] {
+          return pg_shard_manager.rebalance_pgs(false).discard_result();
+        });
+      });
+      pg_rebalance_timer.arm_periodic(
+        std::chrono::seconds(rebalance_seconds));
+    }
+
     return open_meta_coll();
   }).then([this] {
     return pg_shard_manager.get_meta_coll().load_superblock(
@@ -792,6 +810,10 @@ seastar::future<> OSD::start_asok_admin()
     asok->register_command(make_asok_hook<FlushPgStatsHook>(*this));
     asok->register_command(
       make_asok_hook<DumpPGStateHistory>(std::as_const(pg_shard_manager)));
+    asok->register_command(
+      make_asok_hook<DumpPGShardLoadHook>(std::as_const(pg_shard_manager)));
+    asok->register_command(make_asok_hook<RebalancePGShardsHook>(*this));
+    asok->register_command(make_asok_hook<MigratePGShardHook>(*this));
     asok->register_command(make_asok_hook<DumpMetricsHook>());
     asok->register_command(make_asok_hook<DumpPerfCountersHook>());
     asok->register_command(make_asok_hook<InjectDataErrorHook>(get_shard_services()));
@@ -822,6 +844,7 @@ seastar::future<> OSD::stop()
   INFO();
   beacon_timer.cancel();
   tick_timer.cancel();
+  pg_rebalance_timer.cancel();
   // see also OSD::shutdown()
   return prepare_to_stop().then([this] {
     return pg_shard_manager.set_stopping();
@@ -132,6 +132,8 @@ class OSD final : public crimson::net::Dispatcher,
   seastar::timer<seastar::lowres_clock> stats_timer;
   std::vector<ShardServices::shard_stats_t> shard_stats;
 
+  seastar::timer<seastar::lowres_clock> pg_rebalance_timer;
+
   std::vector<std::string> get_tracked_keys() const noexcept final;
   void handle_conf_change(const ConfigProxy& conf,
                           const std::set<std::string> &changed) final;
@@ -274,6 +274,7 @@ seastar::future<> ClientRequest::with_pg(
 {
   shard_services = &_shard_services;
   pgref->client_request_orderer.add_request(*this);
+  pgref->note_client_request();
 
   if (m->finish_decode()) {
     m->clear_payload();
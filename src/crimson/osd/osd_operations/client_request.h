@@ -202,6 +202,9 @@ public:
       list.erase(list_t::s_iterator_to(request));
       intrusive_ptr_release(&request);
     }
+    bool empty() const {
+      return list.empty();
+    }
     void requeue(Ref<PG> pg);
     void clear_and_cancel(PG &pg);
   };
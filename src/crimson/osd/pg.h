@@ -156,6 +156,16 @@ public:
     return coll_ref;
   }
 
+  void note_client_request() {
+    ++client_requests;
+  }
+  /// client requests per second since the previous call
+  double sample_client_request_rate(double elapsed) {
+    auto n = client_requests - client_requests_sampled;
+    client_requests_sampled = client_requests;
+    return elapsed > 0 ? n / elapsed : 0;
+  }
+
   // PeeringListener
   void prepare_write(
     pg_info_t &info,
@@ -536,6 +546,16 @@ public:
   bool is_active_clean() const {
     return peering_state.is_active() && peering_state.is_clean();
   }
+  /**
+   * true if this pg could be unloaded and reloaded from its persisted
+   * state: a clean primary that is not scrubbing and has no client
+   * requests queued or in progress.
+   */
+  bool is_quiescent() const {
+    return is_primary() && is_active_clean() &&
+      !peering_state.state_test(PG_STATE_SCRUBBING) &&
+      client_request_orderer.empty();
+  }
   bool is_primary() const final {
     return peering_state.is_primary();
   }
@@ -966,6 +986,10 @@ private:
   // continuations here.
   bool stopping = false;
 
+  // for the per-pg load reported to the PG rebalancer
+  uint64_t client_requests = 0;
+  uint64_t client_requests_sampled = 0;
+
   PGActivationBlocker wait_for_active_blocker;
   PglogBasedRecovery* pglog_based_recovery_op = nullptr;
 
@@ -17,6 +17,13 @@ seastar::future<core_id_t> PGShardMapping::get_or_create_pg_mapping(
   core_id_t core_expected)
 {
   LOG_PREFIX(PGShardMapping::get_or_create_pg_mapping);
+  if (auto m = migrating.find(pgid); m != migrating.end()) {
+    DEBUG("pg {} is migrating, waiting", pgid);
+    return m->second.get_shared_future(
+    ).then([this, pgid, core_expected] {
+      return get_or_create_pg_mapping(pgid, core_expected);
+    });
+  }
   auto find_iter = pg_to_core.find(pgid);
   if (find_iter != pg_to_core.end()) {
     auto core_found = find_iter->second;
@@ -156,6 +163,49 @@ seastar::future<> PGShardMapping::remove_pg_mapping(spg_t pgid) {
   });
 }
 
+seastar::future<> PGShardMapping::start_pg_migration(spg_t pgid)
+{
+  LOG_PREFIX(PGShardMapping::start_pg_migration);
+  ceph_assert_always(seastar::this_shard_id() == 0);
+  DEBUG("pg {}", pgid);
+  return container().invoke_on_all([pgid](auto &local_mapping) {
+    [[maybe_unused]] auto [iter, inserted] =
+      local_mapping.migrating.try_emplace(pgid);
+    assert(inserted);
+  });
+}
+
+seastar::future<> PGShardMapping::finish_pg_migration(
+  spg_t pgid, core_id_t core)
+{
+  LOG_PREFIX(PGShardMapping::finish_pg_migration);
+  ceph_assert_always(seastar::this_shard_id() == 0);
+  auto find_iter = pg_to_core.find(pgid);
+  if (find_iter != pg_to_core.end() && find_iter->second != core) {
+    auto from_iter = core_to_num_pgs.find(find_iter->second);
+    auto to_iter = core_to_num_pgs.find(core);
+    ceph_assert_always(from_iter != core_to_num_pgs.end());
+    ceph_assert_always(to_iter != core_to_num_pgs.end());
+    assert(from_iter->second > 0);
+    --(from_iter->second);
+    ++(to_iter->second);
+    DEBUG("pg {} moved from core {} to core {}",
+          pgid, find_iter->second, core);
+  }
+  return container().invoke_on_all([pgid, core](auto &local_mapping) {
+    // the pg may have been removed in the meantime
+    if (auto iter = local_mapping.pg_to_core.find(pgid);
+        iter != local_mapping.pg_to_core.end()) {
+      iter->second = core;
+    }
+    auto m = local_mapping.migrating.find(pgid);
+    ceph_assert_always(m != local_mapping.migrating.end());
+    auto promise = std::move(m->second);
+    local_mapping.migrating.erase(m);
+    promise.set_value();
+  });
+}
+
 PGMap::PGCreationState::PGCreationState(spg_t pgid) : pgid(pgid) {}
 PGMap::PGCreationState::~PGCreationState() {}
 
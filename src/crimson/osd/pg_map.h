@@ -24,6 +24,10 @@ class PG;
  * Maintains a mapping from spg_t to the core containing that PG.  Internally, each
  * core has a local copy of the mapping to enable core-local lookups.  Updates
  * are proxied to core 0, and the back out to all other cores -- see get_or_create_pg_mapping.
+ *
+ * While a pg is being moved to another core, get_or_create_pg_mapping holds
+ * back lookups for it on every core until the move is done -- see
+ * start_pg_migration and finish_pg_migration.
  */
 class PGShardMapping : public seastar::peering_sharded_service<PGShardMapping> {
 public:
@@ -42,8 +46,29 @@ public:
   /// Remove pgid mapping
   seastar::future<> remove_pg_mapping(spg_t pgid);
 
+  /// Hold back get_or_create_pg_mapping for pgid on all cores, primary only
+  seastar::future<> start_pg_migration(spg_t pgid);
+
+  /// Map pgid to core on all cores and release the held back lookups,
+  /// primary only
+  seastar::future<> finish_pg_migration(spg_t pgid, core_id_t core);
+
+  bool is_migrating(spg_t pgid) const {
+    return migrating.contains(pgid);
+  }
+
+  bool is_mapped_core(core_id_t core) const {
+    return core_to_num_pgs.contains(core);
+  }
+
   size_t get_num_pgs() const { return pg_to_core.size(); }
 
+  /// only meaningful in shard 0
+  unsigned get_num_pgs(core_id_t core) const {
+    auto iter = core_to_num_pgs.find(core);
+    return iter == core_to_num_pgs.end() ? 0 : iter->second;
+  }
+
   /// Map to cores in [min_core_mapping, core_mapping_limit)
   PGShardMapping(core_id_t min_core_mapping, core_id_t core_mapping_limit) {
     ceph_assert_always(min_core_mapping < core_mapping_limit);
@@ -64,6 +89,8 @@ private:
   std::map<core_id_t, unsigned> core_to_num_pgs;
   // per-shard, updated by shard 0
   std::map<spg_t, core_id_t> pg_to_core;
+  // per-shard, updated by shard 0
+  std::map<spg_t, seastar::shared_promise<>> migrating;
 };
 
 /**
@@ -1,6 +1,10 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
 // vim: ts=8 sw=2 sts=2 expandtab
 
+#include <algorithm>
+#include <cmath>
+
+#include "crimson/common/config_proxy.h"
 #include "crimson/osd/pg_shard_manager.h"
 #include "crimson/osd/pg.h"
 
@@ -79,6 +83,140 @@ PGShardManager::get_pg_stats() const
     });
 }
 
+seastar::future<std::vector<PGShardManager::shard_load_t>>
+PGShardManager::get_pg_load() const
+{
+  ceph_assert(seastar::this_shard_id() == PRIMARY_CORE);
+  return shard_services.map_reduce0(
+    [](auto &local) {
+      return std::vector<shard_load_t>{local.report_pg_load()};
+    },
+    std::vector<shard_load_t>(),
+    [](auto &&left, auto &&right) {
+      std::move(right.begin(), right.end(), std::back_inserter(left));
+      return std::move(left);
+    }).then([](auto &&loads) {
+      std::sort(loads.begin(), loads.end(),
+                [](const auto &l, const auto &r) { return l.core < r.core; });
+      return std::move(loads);
+    });
+}
+
+std::optional<PGShardManager::pg_migration_t>
+PGShardManager::choose_pg_migration(
+  const std::vector<shard_load_t> &loads,
+  double min_utilization,
+  double min_imbalance)
+{
+  if (loads.size() < 2) {
+    return std::nullopt;
+  }
+  auto [cold, hot] = std::minmax_element(
+    loads.begin(), loads.end(),
+    [](const auto &l, const auto &r) { return l.op_rate < r.op_rate; });
+  if (hot->reactor_utilization < min_utilization) {
+    return std::nullopt;
+  }
+  const double gap = hot->op_rate - cold->op_rate;
+  if (gap <= 0 || gap < hot->op_rate * min_imbalance) {
+    return std::nullopt;
+  }
+  // moving a pg with rate r leaves the two cores at (hot - r, cold + r):
+  // r closest to gap / 2 evens them out best, and r >= gap just moves
+  // the hot spot to the other core
+  const ShardServices::pg_load_t *best = nullptr;
+  for (const auto &pg : hot->pgs) {
+    if (!pg.movable || pg.op_rate <= 0 || pg.op_rate >= gap) {
+      continue;
+    }
+    if (!best ||
+        std::abs(pg.op_rate - gap / 2) < std::abs(best->op_rate - gap / 2)) {
+      best = &pg;
+    }
+  }
+  if (!best) {
+    return std::nullopt;
+  }
+  return pg_migration_t{best->pgid, hot->core, cold->core};
+}
+
+seastar::future<bool> PGShardManager::migrate_pg(spg_t pgid, core_id_t core)
+{
+  ceph_assert(seastar::this_shard_id() == PRIMARY_CORE);
+  auto &mapping = get_pg_to_shard_mapping();
+  const auto from = mapping.get_pg_mapping(pgid);
+  if (!is_pg_migration_supported() ||
+      from == NULL_CORE || from == core ||
+      !mapping.is_mapped_core(core) ||
+      mapping.is_migrating(pgid)) {
+    logger().debug("migrate_pg: not moving {} from core {} to core {}",
+                   pgid, from, core);
+    co_return false;
+  }
+  const auto timeout = local_conf().get_val<std::chrono::milliseconds>(
+    "crimson_osd_pg_migration_timeout");
+  logger().info("migrate_pg: moving {} from core {} to core {}",
+                pgid, from, core);
+  co_await mapping.start_pg_migration(pgid);
+  bool unloaded = false;
+  try {
+    unloaded = co_await shard_services.invoke_on(
+      from, [pgid, timeout](auto &local) {
+        return local.unload_pg_for_migration(pgid, timeout);
+      });
+  } catch (...) {
+    logger().warn("migrate_pg: failed to unload {}: {}",
+                  pgid, std::current_exception());
+  }
+  std::exception_ptr eptr;
+  if (unloaded) {
+    try {
+      co_await shard_services.invoke_on(
+        core, [pgid](auto &local) {
+          return local.load_migrated_pg(pgid);
+        });
+    } catch (...) {
+      eptr = std::current_exception();
+    }
+  }
+  // always release the ops held back for pgid
+  co_await mapping.finish_pg_migration(pgid, unloaded ? core : from);
+  if (eptr) {
+    std::rethrow_exception(eptr);
+  }
+  logger().info("migrate_pg: {} {} core {}",
+                pgid, unloaded ? "moved to" : "stays on",
+                unloaded ? core : from);
+  co_return unloaded;
+}
+
+seastar::future<std::optional<PGShardManager::pg_migration_t>>
+PGShardManager::rebalance_pgs(bool dry_run)
+{
+  ceph_assert(seastar::this_shard_id() == PRIMARY_CORE);
+  if (rebalancing) {
+    co_return std::nullopt;
+  }
+  rebalancing = true;
+  std::optional<pg_migration_t> migration;
+  try {
+    auto loads = co_await get_pg_load();
+    migration = choose_pg_migration(
+      loads,
+      local_conf().get_val<double>("crimson_osd_pg_rebalance_min_utilization"),
+      local_conf().get_val<double>("crimson_osd_pg_rebalance_min_imbalance"));
+    if (migration && !dry_run &&
+        !co_await migrate_pg(migration->pgid, migration->to)) {
+      migration.reset();
+    }
+  } catch (...) {
+    rebalancing = false;
+    throw;
+  }
+  rebalancing = false;
+  co_return migration;
+}
+
 seastar::future<> PGShardManager::broadcast_map_to_pgs(epoch_t epoch)
 {
   ceph_assert(seastar::this_shard_id() == PRIMARY_CORE);
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <optional>
+#include <vector>
+
 #include <seastar/core/future.hh>
 #include <seastar/core/shared_future.hh>
 #include <seastar/core/sharded.hh>
@@ -31,6 +34,10 @@ class PGShardManager {
   seastar::sharded<ShardServices> &shard_services;
   seastar::sharded<PGShardMapping> &pg_to_shard_mapping;
 
+  /// set if pg collections can be opened on any core
+  bool pg_migration_supported = false;
+  bool rebalancing = false;
+
 #define FORWARD_CONST(FROM_METHOD, TO_METHOD, TARGET)		\
   template <typename... Args>					\
   auto FROM_METHOD(Args&&... args) const {			\
@@ -299,6 +306,51 @@ public:
 
   seastar::future<std::map<pg_t, pg_stat_t>> get_pg_stats() const;
 
+  using shard_load_t = ShardServices::shard_load_t;
+  struct pg_migration_t {
+    spg_t pgid;
+    core_id_t from = NULL_CORE;
+    core_id_t to = NULL_CORE;
+  };
+
+  void set_pg_migration_supported(bool supported) {
+    pg_migration_supported = supported;
+  }
+  bool is_pg_migration_supported() const {
+    return pg_migration_supported && seastar::smp::count > 1;
+  }
+
+  /// Per-core client request rates since the previous call, by core
+  seastar::future<std::vector<shard_load_t>> get_pg_load() const;
+
+  /**
+   * choose_pg_migration
+   *
+   * Picks the movable pg on the core with the highest op rate that, once
+   * moved to the core with the lowest op rate, best evens out the two.
+   * Nothing is picked unless the busier core's reactor utilization is at
+   * least min_utilization and the op rate gap between the cores is at
+   * least min_imbalance of the busier core's op rate.
+   */
+  static std::optional<pg_migration_t> choose_pg_migration(
+    const std::vector<shard_load_t> &loads,
+    double min_utilization,
+    double min_imbalance);
+
+  /**
+   * migrate_pg
+   *
+   * Moves pgid to core between ops: new ops for the pg are held back,
+   * the ones in progress are allowed to finish, then the pg is stopped
+   * and reloaded from the object store on core.  The pg peers again
+   * after the move, as it would after an OSD restart.  Returns false if
+   * the pg was left where it was.
+   */
+  seastar::future<bool> migrate_pg(spg_t pgid, core_id_t core);
+
+  /// Samples pg load and, unless dry_run, performs the chosen migration
+  seastar::future<std::optional<pg_migration_t>> rebalance_pgs(bool dry_run);
+
   /**
    * invoke_method_on_each_shard_seq
    *
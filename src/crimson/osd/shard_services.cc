@@ -2,6 +2,7 @@
 // vim: ts=8 sw=2 sts=2 expandtab
 
 #include <boost/smart_ptr/make_local_shared.hpp>
+#include <seastar/core/sleep.hh>
 
 #include "crimson/osd/shard_services.h"
 
@@ -777,6 +778,65 @@ seastar::future<Ref<PG>> ShardServices::load_pg(spg_t pgid)
   });
 }
 
+ShardServices::shard_load_t ShardServices::report_pg_load()
+{
+  auto now = seastar::lowres_clock::now();
+  double elapsed = std::chrono::duration<double>(
+    now - local_state.pg_load_sampled_at).count();
+  local_state.pg_load_sampled_at = now;
+
+  shard_load_t ret;
+  ret.core = seastar::this_shard_id();
+  ret.reactor_utilization = get_reactor_utilization();
+  for (auto &[pgid, pg] : local_state.pg_map.get_pgs()) {
+    double rate = pg->sample_client_request_rate(elapsed);
+    ret.op_rate += rate;
+    ret.pgs.push_back({pgid, rate, pg->is_primary() && pg->is_active_clean()});
+  }
+  return ret;
+}
+
+seastar::future<bool> ShardServices::unload_pg_for_migration(
+  spg_t pgid, std::chrono::milliseconds timeout)
+{
+  LOG_PREFIX(ShardServices::unload_pg_for_migration);
+  auto pg = local_state.pg_map.get_pg(pgid);
+  if (!pg) {
+    DEBUG("pg {} is not here", pgid);
+    co_return false;
+  }
+  // new ops for pgid are held back in get_pg_mapping, so only the ones
+  // already routed here need to drain
+  auto deadline = seastar::lowres_clock::now() + timeout;
+  while (!pg->is_quiescent()) {
+    if (seastar::lowres_clock::now() >= deadline) {
+      INFO("pg {} did not quiesce within {}ms", pgid, timeout.count());
+      co_return false;
+    }
+    co_await seastar::sleep(std::chrono::milliseconds(1));
+  }
+  co_await get_store().flush(pg->get_collection_ref());
+  if (!pg->is_quiescent()) {
+    INFO("pg {} got busy while flushing", pgid);
+    co_return false;
+  }
+  local_state.pg_map.remove_pg(pgid);
+  co_await pg->stop();
+  INFO("pg {} unloaded", pgid);
+  co_return true;
+}
+
+seastar::future<> ShardServices::load_migrated_pg(spg_t pgid)
+{
+  LOG_PREFIX(ShardServices::load_migrated_pg);
+  auto pg = co_await load_pg(pgid);
+  local_state.pg_map.pg_loaded(pgid, pg);
+  INFO("pg {} loaded", pgid);
+  // catch up with the maps this shard has seen since the pg was persisted
+  co_await start_operation<PGAdvanceMap>(
+    pg, *this, get_map()->get_epoch(), PeeringCtx{}, false).second;
+}
+
 seastar::future<> ShardServices::dispatch_context_transaction(
   crimson::os::CollectionRef col, PeeringCtx &ctx) {
   LOG_PREFIX(OSDSingletonState::dispatch_context_transaction);
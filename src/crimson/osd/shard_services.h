@@ -3,10 +3,13 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <vector>
 
 #include <boost/intrusive_ptr.hpp>
 #include <seastar/core/future.hh>
+#include <seastar/core/lowres_clock.hh>
 
 #include "include/common_fwd.h"
 #include "osd_operation.h"
@@ -120,6 +123,9 @@ class PerShardState {
 
   // PGMap state
   PGMap pg_map;
+  /// when the per-pg client request rates were last sampled
+  seastar::lowres_clock::time_point pg_load_sampled_at =
+    seastar::lowres_clock::now();
 
   seastar::future<> stop_pgs();
   std::map<pg_t, pg_stat_t> get_pg_stats();
@@ -481,6 +487,31 @@ public:
     return {get_reactor_utilization()};
   }
 
+  struct pg_load_t {
+    spg_t pgid;
+    double op_rate = 0;   ///< client requests per second
+    bool movable = false; ///< may be migrated to another core right now
+  };
+  struct shard_load_t {
+    core_id_t core = NULL_CORE;
+    double reactor_utilization = 0;
+    double op_rate = 0;   ///< sum of pgs[].op_rate
+    std::vector<pg_load_t> pgs;
+  };
+  /// client request rate of each local pg since the previous call
+  shard_load_t report_pg_load();
+
+  /**
+   * Wait for pgid to become quiescent (see PG::is_quiescent), then stop
+   * it and drop it from the local pg_map.  Returns false, leaving the pg
+   * in place, if that does not happen within timeout.  The caller must
+   * have stopped new ops from being routed to the pg.
+   */
+  seastar::future<bool> unload_pg_for_migration(
+    spg_t pgid, std::chrono::milliseconds timeout);
+  /// Load pgid unloaded by unload_pg_for_migration on another core
+  seastar::future<> load_migrated_pg(spg_t pgid);
+
   auto create_split_pg_mapping(spg_t pgid, core_id_t core) {
     return pg_to_shard_mapping.get_or_create_pg_mapping(pgid, core);
   }
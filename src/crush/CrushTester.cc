@@ -10,6 +10,7 @@
 #include <boost/icl/interval_map.hpp>
 #include <boost/algorithm/string/join.hpp>
 
+#include "common/ceph_time.h"
 #include "common/SubProcess.h"
 #include "common/fork_function.h"
 
@@ -613,6 +614,25 @@ int CrushTester::test(CephContext* cct)
         batch_max = batch_min + objects_per_batch - 1;
       }
 
+      if (output_bench && use_crush) {
+        // time the mappings alone, without the bookkeeping above
+        vector<int> out;
+        auto start = ceph::mono_clock::now();
+        for (int x = min_x; x <= max_x; x++) {
+          uint32_t real_x = x;
+          if (pool_id != -1) {
+            real_x = crush_hash32_2(CRUSH_HASH_RJENKINS1, x, (uint32_t)pool_id);
+          }
+          crush.do_rule(r, real_x, out, nr, weight, 0);
+        }
+        double secs = ceph::to_seconds<double>(ceph::mono_clock::now() - start);
+        err << "rule " << r << " (" << crush.get_rule_name(r) << ") num_rep " << nr
+            << " mappings " << num_objects << " in " << secs << "s: "
+            << (secs > 0 ? num_objects / secs : 0) << " mappings/s"
+            << (crush_get_straw2_simd() ? " (straw2 simd)" : "")
+            << std::endl;
+      }
+
       for (unsigned i = 0; i < per.size(); i++)
         if (output_utilization && !output_statistics)
           err << "  device " << i
@@ -31,6 +31,7 @@ class CrushTester {
   bool output_mappings;
   bool output_bad_mappings;
   bool output_choose_tries;
+  bool output_bench;
 
   bool output_data_file;
   bool output_csv;
@@ -182,6 +183,7 @@ public:
       output_mappings(false),
       output_bad_mappings(false),
       output_choose_tries(false),
+      output_bench(false),
       output_data_file(false),
       output_csv(false),
       output_data_file_name("")
@@ -251,6 +253,13 @@ public:
     return output_choose_tries;
   }
 
+  void set_output_bench(bool b) {
+    output_bench = b;
+  }
+  bool get_output_bench() const {
+    return output_bench;
+  }
+
   void set_batches(int b) {
     num_batches = b;
   }
@@ -312,10 +312,8 @@ static inline __s32 *get_choose_arg_ids(const struct crush_bucket_straw2 *bucket
  * for reference, see the exponential distribution example at:  
  * https://en.wikipedia.org/wiki/Inverse_transform_sampling#Examples
  */
-static inline __s64 generate_exponential_distribution(int type, int x, int y, int z, 
-                                                      int weight)
+static inline __s64 straw2_draw(unsigned int u, int weight)
 {
-	unsigned int u = crush_hash32_3(type, x, y, z);
 	u &= 0xffff;
 
 	/*
@@ -339,15 +337,169 @@ static inline __s64 generate_exponential_distribution(int type, int x, int y, in
 	return div64_s64(ln, weight);
 }
 
+static inline __s64 generate_exponential_distribution(int type, int x, int y, int z,
+                                                      int weight)
+{
+	return straw2_draw(crush_hash32_3(type, x, y, z), weight);
+}
+
+/*
+ * straw2 hashes the same (x, r) pair against every item in the
+ * bucket, so for wide buckets the rjenkins mixing of several items
+ * can be done at once in vector registers.  Only the hash is
+ * vectorized; crush_ln() and the weight division stay scalar, so the
+ * draws (and thus the mappings) are bit-identical to the scalar path.
+ */
+#if !defined(__KERNEL__) && (defined(__GNUC__) || defined(__clang__)) && \
+	(defined(__x86_64__) || defined(__aarch64__))
+# define CRUSH_STRAW2_SIMD 1
+#endif
+
+#ifdef CRUSH_STRAW2_SIMD
+
+#if defined(__x86_64__)
+# include <immintrin.h>
+# define STRAW2_SIMD_ATTR __attribute__((target("avx2")))
+typedef __m256i straw2_vec;
+# define STRAW2_LANES 8
+# define V_SET1(v) _mm256_set1_epi32((int)(v))
+# define V_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+# define V_STORE(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+# define V_SUB(a, b) _mm256_sub_epi32((a), (b))
+# define V_XOR(a, b) _mm256_xor_si256((a), (b))
+# define V_SHR(a, n) _mm256_srli_epi32((a), (n))
+# define V_SHL(a, n) _mm256_slli_epi32((a), (n))
+#else
+# include <arm_neon.h>
+# define STRAW2_SIMD_ATTR
+typedef uint32x4_t straw2_vec;
+# define STRAW2_LANES 4
+# define V_SET1(v) vdupq_n_u32((__u32)(v))
+# define V_LOAD(p) vld1q_u32((const uint32_t *)(p))
+# define V_STORE(p, v) vst1q_u32((uint32_t *)(p), (v))
+# define V_SUB(a, b) vsubq_u32((a), (b))
+# define V_XOR(a, b) veorq_u32((a), (b))
+# define V_SHR(a, n) vshrq_n_u32((a), (n))
+# define V_SHL(a, n) vshlq_n_u32((a), (n))
+#endif
+
+/* items hashed per iteration; a multiple of STRAW2_LANES */
+#define STRAW2_BATCH 16
+
+/* must match crush_hash_seed in hash.c */
+#define STRAW2_HASH_SEED 1315423911
+
+/* lane-wise crush_hashmix() */
+#define straw2_hashmix(a, b, c) do {					\
+		a = V_SUB(a, b); a = V_SUB(a, c); a = V_XOR(a, V_SHR(c, 13)); \
+		b = V_SUB(b, c); b = V_SUB(b, a); b = V_XOR(b, V_SHL(a, 8)); \
+		c = V_SUB(c, a); c = V_SUB(c, b); c = V_XOR(c, V_SHR(b, 13)); \
+		a = V_SUB(a, b); a = V_SUB(a, c); a = V_XOR(a, V_SHR(c, 12)); \
+		b = V_SUB(b, c); b = V_SUB(b, a); b = V_XOR(b, V_SHL(a, 16)); \
+		c = V_SUB(c, a); c = V_SUB(c, b); c = V_XOR(c, V_SHR(b, 5)); \
+		a = V_SUB(a, b); a = V_SUB(a, c); a = V_XOR(a, V_SHR(c, 3)); \
+		b = V_SUB(b, c); b = V_SUB(b, a); b = V_XOR(b, V_SHL(a, 10)); \
+		c = V_SUB(c, a); c = V_SUB(c, b); c = V_XOR(c, V_SHR(b, 15)); \
+	} while (0)
+
+/* crush_hash32_rjenkins1_3(x, ids[i], r) for STRAW2_BATCH ids */
+STRAW2_SIMD_ATTR
+static void straw2_hash_batch(__u32 x, const __s32 *ids, __u32 r, __u32 *out)
+{
+	int k;
+
+	for (k = 0; k < STRAW2_BATCH; k += STRAW2_LANES) {
+		straw2_vec a = V_SET1(x);
+		straw2_vec b = V_LOAD(ids + k);
+		straw2_vec c = V_SET1(r);
+		straw2_vec hash = V_XOR(V_SET1(STRAW2_HASH_SEED ^ x ^ r), b);
+		straw2_vec vx = V_SET1(231232);
+		straw2_vec vy = V_SET1(1232);
+
+		straw2_hashmix(a, b, hash);
+		straw2_hashmix(c, vx, hash);
+		straw2_hashmix(vy, a, hash);
+		straw2_hashmix(b, vx, hash);
+		straw2_hashmix(vy, c, hash);
+		V_STORE(out + k, hash);
+	}
+}
+
+/* -1: not probed yet, 0: scalar, 1: vector */
+static int straw2_simd = -1;
+
+static int straw2_simd_enabled(void)
+{
+	int v = __atomic_load_n(&straw2_simd, __ATOMIC_RELAXED);
+
+	if (v < 0) {
+#if defined(__x86_64__)
+		v = __builtin_cpu_supports("avx2") ? 1 : 0;
+#else
+		v = 1;  /* NEON is mandatory on aarch64 */
+#endif
+		__atomic_store_n(&straw2_simd, v, __ATOMIC_RELAXED);
+	}
+	return v;
+}
+
+void crush_set_straw2_simd(int enable)
+{
+	__atomic_store_n(&straw2_simd, enable ? -1 : 0, __ATOMIC_RELAXED);
+}
+
+int crush_get_straw2_simd(void)
+{
+	return straw2_simd_enabled();
+}
+
+#else
+
+void crush_set_straw2_simd(int enable)
+{
+}
+
+int crush_get_straw2_simd(void)
+{
+	return 0;
+}
+
+#endif /* CRUSH_STRAW2_SIMD */
+
 static int bucket_straw2_choose(const struct crush_bucket_straw2 *bucket,
 				int x, int r, const struct crush_choose_arg *arg,
                                 int position)
 {
-	unsigned int i, high = 0;
+	unsigned int i = 0, high = 0;
 	__s64 draw, high_draw = 0;
         __u32 *weights = get_choose_arg_weights(bucket, arg, position);
         __s32 *ids = get_choose_arg_ids(bucket, arg);
-	for (i = 0; i < bucket->h.size; i++) {
+#ifdef CRUSH_STRAW2_SIMD
+	if (bucket->h.size >= STRAW2_BATCH &&
+	    bucket->h.hash == CRUSH_HASH_RJENKINS1 &&
+	    straw2_simd_enabled()) {
+		unsigned int end = bucket->h.size - bucket->h.size % STRAW2_BATCH;
+		__u32 u[STRAW2_BATCH];
+
+		for (; i < end; i += STRAW2_BATCH) {
+			unsigned int j;
+
+			straw2_hash_batch(x, ids + i, r, u);
+			for (j = 0; j < STRAW2_BATCH; j++) {
+				if (weights[i + j])
+					draw = straw2_draw(u[j], weights[i + j]);
+				else
+					draw = S64_MIN;
+
+				if (i + j == 0 || draw > high_draw) {
+					high = i + j;
+					high_draw = draw;
+				}
+			}
+		}
+	}
+#endif
+	for (; i < bucket->h.size; i++) {
                 dprintk("weight 0x%x item %d\n", weights[i], ids[i]);
 		if (weights[i]) {
 			draw = generate_exponential_distribution(bucket->h.hash, x, ids[i], r, weights[i]);
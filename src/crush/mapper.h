@@ -102,4 +102,13 @@ extern size_t crush_work_size(const struct crush_map *map,
 
 extern void crush_init_workspace(const struct crush_map *m, void *v);
 
+/* Enable (the default, subject to cpu support) or disable the vectorized
+   straw2 bucket hash.  Mappings are identical either way; this exists for
+   testing and benchmarking. */
+extern void crush_set_straw2_simd(int enable);
+
+/* Returns 1 if straw2 buckets are currently hashed with vector
+   instructions. */
+extern int crush_get_straw2_simd(void);
+
 #endif
@@ -148,6 +148,7 @@
 #include <memory>
 #include <string>
 #include "include/buffer_fwd.h"
+#include "include/ceph_assert.h"
 #include "osd/osd_types.h"
 
 #define IGNORE_DEPRECATED \
@@ -448,6 +449,33 @@ namespace ceph {
     virtual int encode_chunks(const shard_id_map<bufferptr> &in,
                               shard_id_map<bufferptr> &out) = 0;
 
+    /**
+     * Encode a batch of independent ranges, each of them as described for
+     * encode_chunks(in[i], out[i]). All buffers within one element have the
+     * same size but sizes may differ between elements, as may the set of
+     * shards present. This lets callers holding scatter-gather buffers (e.g.
+     * a fragmented bufferlist from the messenger) hand over all of them in
+     * one call, so that plugins can hoist per-call setup out of the loop.
+     *
+     * The default implementation simply calls encode_chunks for every
+     * element.
+     *
+     * @param [in] in one map of data shards per range
+     * @param [out] out one map of empty parity buffers per range
+     * @return **0** on success or a negative errno on error.
+     */
+    virtual int encode_chunks_batch(
+      const std::vector<shard_id_map<bufferptr>> &in,
+      std::vector<shard_id_map<bufferptr>> &out) {
+      ceph_assert(in.size() == out.size());
+      for (size_t i = 0; i < in.size(); ++i) {
+        if (int r = encode_chunks(in[i], out[i]); r) {
+          return r;
+        }
+      }
+      return 0;
+    }
+
     /**
      * Calculate the delta between the old_data and new_data buffers using xor,
      * (or plugin-specific implementation) and returns the result in the
@@ -571,6 +599,31 @@ namespace ceph {
                               shard_id_map<bufferptr> &in,
                               shard_id_map<bufferptr> &out) = 0;
 
+    /**
+     * Decode a batch of independent ranges, each of them as described for
+     * decode_chunks(want_to_read, in[i], out[i]).
+     *
+     * The default implementation simply calls decode_chunks for every
+     * element.
+     *
+     * @param [in] want_to_read shard indexes to be decoded
+     * @param [in] in one map of available shards per range
+     * @param [out] out one map of buffers to decode into per range
+     * @return **0** on success or a negative errno on error.
+     */
+    virtual int decode_chunks_batch(
+      const shard_id_set &want_to_read,
+      std::vector<shard_id_map<bufferptr>> &in,
+      std::vector<shard_id_map<bufferptr>> &out) {
+      ceph_assert(in.size() == out.size());
+      for (size_t i = 0; i < in.size(); ++i) {
+        if (int r = decode_chunks(want_to_read, in[i], out[i]); r) {
+          return r;
+        }
+      }
+      return 0;
+    }
+
     [[deprecated]]
     virtual int decode_chunks(const std::set<int> &want_to_read,
                               const std::map<int, bufferlist> &chunks,
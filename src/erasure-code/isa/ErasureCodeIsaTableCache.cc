@@ -254,13 +254,16 @@ ErasureCodeIsaTableCache::getDecodingTableFromCache(std::string &signature,
   lru_list_t* decode_tbls_lru =
     getDecodingTablesLru(matrixtype);
 
-  if (decode_tbls_map->count(signature)) {
+  auto entry = decode_tbls_map->find(signature);
+  if (entry != decode_tbls_map->end()) {
     dout(12) << "[ cached table ] = " << signature << dendl;
     // copy the table out of the cache
-    memcpy(table, (*decode_tbls_map)[signature].second.c_str(), k * (m + k)*32);
+    memcpy(table, entry->second.second.c_str(), k * (m + k)*32);
     // find item in LRU queue and push back
     dout(12) << "[ cache size   ] = " << decode_tbls_lru->size() << dendl;
-    decode_tbls_lru->splice( (decode_tbls_lru->begin()), *decode_tbls_lru, (*decode_tbls_map)[signature].first);
+    if (entry->second.first != decode_tbls_lru->begin()) {
+      decode_tbls_lru->splice( (decode_tbls_lru->begin()), *decode_tbls_lru, entry->second.first);
+    }
     found = true;
   }
 
@@ -114,10 +114,10 @@ int ErasureCodeJerasure::encode_chunks(const set<int> &want_to_encode,
   return 0;
 }
 
-int ErasureCodeJerasure::encode_chunks(const shard_id_map<bufferptr> &in,
-                                       shard_id_map<bufferptr> &out)
+uint64_t ErasureCodeJerasure::set_chunk_pointers(const shard_id_map<bufferptr> &in,
+                                                 shard_id_map<bufferptr> &out,
+                                                 char **chunks)
 {
-  char *chunks[k + m]; //TODO don't use variable length arrays
   memset(chunks, 0, sizeof(char*) * (k + m));
   uint64_t size = 0;
 
@@ -138,6 +138,14 @@ int ErasureCodeJerasure::encode_chunks(const shard_id_map<bufferptr> &in,
     }
     chunks[static_cast<int>(shard)] = ptr.c_str();
   }
+  return size;
+}
+
+int ErasureCodeJerasure::encode_chunks(const shard_id_map<bufferptr> &in,
+                                       shard_id_map<bufferptr> &out)
+{
+  char *chunks[k + m]; //TODO don't use variable length arrays
+  uint64_t size = set_chunk_pointers(in, out, chunks);
 
   char *zeros = nullptr;
 
@@ -159,6 +167,36 @@ int ErasureCodeJerasure::encode_chunks(const shard_id_map<bufferptr> &in,
   return 0;
 }
 
+int ErasureCodeJerasure::encode_chunks_batch(
+  const std::vector<shard_id_map<bufferptr>> &in,
+  std::vector<shard_id_map<bufferptr>> &out)
+{
+  ceph_assert(in.size() == out.size());
+  std::vector<char*> chunks(k + m);
+  // one zero buffer, grown as needed, stands in for absent shards
+  std::vector<char> zeros;
+
+  for (size_t b = 0; b < in.size(); ++b) {
+    uint64_t size = set_chunk_pointers(in[b], out[b], chunks.data());
+
+    for (shard_id_t i; i < k + m; ++i) {
+      if (in[b].contains(i) || out[b].contains(i)) {
+        continue;
+      }
+
+      if (zeros.size() < size) {
+        zeros.resize(size);
+      }
+
+      chunks[static_cast<int>(i)] = zeros.data();
+    }
+
+    jerasure_encode(&chunks[0], &chunks[k], size);
+  }
+
+  return 0;
+}
+
 [[deprecated]]
 int ErasureCodeJerasure::decode_chunks(const set<int> &want_to_read,
 				       const map<int, bufferlist> &chunks,
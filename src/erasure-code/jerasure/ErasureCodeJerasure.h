@@ -81,6 +81,9 @@ public:
         std::map<int, ceph::buffer::list> *encoded) override;
   int encode_chunks(const shard_id_map<bufferptr> &in,
                     shard_id_map<bufferptr> &out) override;
+  int encode_chunks_batch(
+    const std::vector<shard_id_map<bufferptr>> &in,
+    std::vector<shard_id_map<bufferptr>> &out) override;
 
   [[deprecated]]
   int decode_chunks(const std::set<int> &want_to_read,
@@ -123,6 +126,12 @@ public:
 
 protected:
   virtual int parse(ceph::ErasureCodeProfile &profile, std::ostream *ss);
+
+private:
+  /// fill chunks[] for the shards in in and out, return the buffer size
+  uint64_t set_chunk_pointers(const shard_id_map<bufferptr> &in,
+                              shard_id_map<bufferptr> &out,
+                              char **chunks);
 };
 class ErasureCodeJerasureReedSolomonVandermonde : public ErasureCodeJerasure {
 public:
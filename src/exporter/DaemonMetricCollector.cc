@@ -325,12 +325,14 @@ void DaemonMetricCollector::dump_asok_metrics(bool sort_metrics, int64_t counter
   add_metric(builder, timer.get_ms(), "ceph_exporter_scrape_time", scrap_desc,
              "gauge", scrap_labels);
 
-  const std::lock_guard<std::mutex> lock(metrics_mutex);
   // only get metrics if there's pid path for some or all daemons isn't empty
   if (daemon_pids.size() != 0) {
     get_process_metrics(daemon_pids);
   }
-  metrics = builder->dump();
+  // render outside of the lock, so that scrapes only wait for the swap
+  std::string rendered = builder->dump();
+  const std::lock_guard<std::mutex> lock(metrics_mutex);
+  metrics.swap(rendered);
 }
 
 std::vector<std::string> read_proc_stat_file(std::string path) {
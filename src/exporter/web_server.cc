@@ -75,8 +75,7 @@ protected:
     } else if (request_.target() == "/metrics") {
       response_.set(http::field::content_type, "text/plain; charset=utf-8");
       DaemonMetricCollector &collector = collector_instance();
-      std::string metrics = collector.get_metrics();
-      response_.body() = metrics;
+      response_.body() = collector.get_metrics();
     } else {
       response_.result(http::status::method_not_allowed);
       response_.set(http::field::content_type, "text/plain");
@@ -8,31 +8,42 @@
 #include "include/cpp-btree/btree_map.h"
 #include "include/ceph_assert.h"   // cpp-btree uses system assert, blech
 #include "include/encoding.h"
+#include "include/mempool.h"
 
-template<class T, class U>
-inline void encode(const btree::btree_map<T,U>& m, ceph::buffer::list& bl)
+// mempool::<pool>::btree_map
+#define P(x)								\
+  namespace mempool::x {						\
+    template<typename k, typename v, typename cmp = std::less<k> >	\
+    using btree_map = btree::btree_map<k, v, cmp,			\
+				       pool_allocator<std::pair<const k,v>>>; \
+  }
+DEFINE_MEMORY_POOLS_HELPER(P)
+#undef P
+
+template<class T, class U, class C, class A>
+inline void encode(const btree::btree_map<T,U,C,A>& m, ceph::buffer::list& bl)
 {
   using ceph::encode;
   __u32 n = (__u32)(m.size());
   encode(n, bl);
-  for (typename btree::btree_map<T,U>::const_iterator p = m.begin(); p != m.end(); ++p) {
+  for (typename btree::btree_map<T,U,C,A>::const_iterator p = m.begin(); p != m.end(); ++p) {
     encode(p->first, bl);
     encode(p->second, bl);
   }
 }
-template<class T, class U>
-inline void encode(const btree::btree_map<T,U>& m, ceph::buffer::list& bl, uint64_t features)
+template<class T, class U, class C, class A>
+inline void encode(const btree::btree_map<T,U,C,A>& m, ceph::buffer::list& bl, uint64_t features)
 {
   using ceph::encode;
   __u32 n = (__u32)(m.size());
   encode(n, bl);
-  for (typename btree::btree_map<T,U>::const_iterator p = m.begin(); p != m.end(); ++p) {
+  for (typename btree::btree_map<T,U,C,A>::const_iterator p = m.begin(); p != m.end(); ++p) {
     encode(p->first, bl, features);
     encode(p->second, bl, features);
   }
 }
-template<class T, class U>
-inline void decode(btree::btree_map<T,U>& m, ceph::buffer::list::const_iterator& p)
+template<class T, class U, class C, class A>
+inline void decode(btree::btree_map<T,U,C,A>& m, ceph::buffer::list::const_iterator& p)
 {
   using ceph::decode;
   __u32 n;
@@ -44,17 +55,17 @@ inline void decode(btree::btree_map<T,U>& m, ceph::buffer::list::const_iterator&
     decode(m[k], p);
   }
 }
-template<class T, class U>
-inline void encode_nohead(const btree::btree_map<T,U>& m, ceph::buffer::list& bl)
+template<class T, class U, class C, class A>
+inline void encode_nohead(const btree::btree_map<T,U,C,A>& m, ceph::buffer::list& bl)
 {
   using ceph::encode;
-  for (typename btree::btree_map<T,U>::const_iterator p = m.begin(); p != m.end(); ++p) {
+  for (typename btree::btree_map<T,U,C,A>::const_iterator p = m.begin(); p != m.end(); ++p) {
     encode(p->first, bl);
     encode(p->second, bl);
   }
 }
-template<class T, class U>
-inline void decode_nohead(int n, btree::btree_map<T,U>& m, ceph::buffer::list::const_iterator& p)
+template<class T, class U, class C, class A>
+inline void decode_nohead(int n, btree::btree_map<T,U,C,A>& m, ceph::buffer::list::const_iterator& p)
 {
   using ceph::decode;
   m.clear();
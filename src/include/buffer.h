@@ -118,6 +118,8 @@ struct error_code;
   int get_missed_crc();
   /// enable/disable tracking of cached crcs
   void track_cached_crc(bool b);
+  /// enable/disable the per-thread cache for small buffers
+  void use_slab(bool b);
 
   /*
    * an abstract raw buffer.  with a reference count.
@@ -1231,6 +1233,9 @@ struct error_code;
 
     uint32_t crc32c(uint32_t crc) const;
     void invalidate_crc();
+    /// remember crc as crc32c(seed) of a single-buffer list, so that a
+    /// checksum the caller already verified does not get recomputed
+    void set_crc32c(uint32_t seed, uint32_t crc);
 
     // These functions return a bufferlist with a pointer to a single
     // static buffer. They /must/ not outlive the memory they
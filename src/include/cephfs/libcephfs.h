@@ -2087,6 +2087,48 @@ int ceph_ll_mknod(struct ceph_mount_info *cmount, Inode *parent,
 		  const char *name, mode_t mode, dev_t rdev, Inode **out,
 		  struct ceph_statx *stx, unsigned want, unsigned flags,
 		  const UserPerm *perms);
+
+/**
+ * Batched metadata operations.
+ *
+ * Each of these runs count operations of one kind with up to max_inflight
+ * of them outstanding at the MDS at once, and returns when all of them
+ * completed. The result of each operation (0 or a negative error code) is
+ * stored in results[i]; the call itself returns 0, -EINVAL for bad
+ * arguments, or -EAGAIN without running any operation if its threads
+ * could not be started. At most 64 operations are outstanding, whatever
+ * max_inflight asks for.
+ */
+
+/**
+ * Create count files (or other nodes, as per mode) in a directory.
+ *
+ * @param names the names of the nodes to create
+ * @param outs inodes of the created nodes, NULL where the create failed.
+ *        Each created inode must be released with ceph_ll_put().
+ */
+int ceph_ll_mknod_batch(struct ceph_mount_info *cmount, Inode *parent,
+			const char * const *names, size_t count, mode_t mode,
+			dev_t rdev, unsigned max_inflight, Inode **outs,
+			int *results, const UserPerm *perms);
+
+/**
+ * Get the attributes of count inodes, into stxs[i] for ins[i].
+ */
+int ceph_ll_getattr_batch(struct ceph_mount_info *cmount, Inode **ins,
+			  size_t count, struct ceph_statx *stxs,
+			  unsigned int want, unsigned int flags,
+			  unsigned max_inflight, int *results,
+			  const UserPerm *perms);
+
+/**
+ * Set the attributes of count inodes, stxs[i] on ins[i], with the same
+ * mask for all of them.
+ */
+int ceph_ll_setattr_batch(struct ceph_mount_info *cmount, Inode **ins,
+			  size_t count, struct ceph_statx *stxs, int mask,
+			  unsigned max_inflight, int *results,
+			  const UserPerm *perms);
 int ceph_ll_mkdir(struct ceph_mount_info *cmount, Inode *parent,
 		  const char *name, mode_t mode, Inode **out,
 		  struct ceph_statx *stx, unsigned want,
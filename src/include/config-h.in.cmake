@@ -345,6 +345,9 @@
 /* Defined if OpenSSL is available for the rgw beast frontend */
 #cmakedefine WITH_RADOSGW_BEAST_OPENSSL
 
+/* Defined if nghttp2 is available for HTTP/2 in the rgw beast frontend */
+#cmakedefine WITH_RADOSGW_BEAST_HTTP2
+
 /* Defined if rabbitmq-c is available for rgw amqp push endpoint */
 #cmakedefine WITH_RADOSGW_AMQP_ENDPOINT
 
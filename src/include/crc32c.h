@@ -30,6 +30,41 @@ extern ceph_crc32c_func_t ceph_choose_crc32(void);
  */
 uint32_t ceph_crc32c_zeros(uint32_t crc, unsigned length);
 
+/**
+ * combine the crc32c of two adjacent buffers
+ *
+ * @param crc crc32c of the first buffer, for any initial value
+ * @param crc2 crc32c of the second buffer with initial value 0
+ * @param length2 length of the second buffer
+ * @return crc32c of both buffers for the first buffer's initial value
+ */
+static inline uint32_t ceph_crc32c_combine(uint32_t crc, uint32_t crc2,
+                                           unsigned length2)
+{
+  return ceph_crc32c_zeros(crc, length2) ^ crc2;
+}
+
+/**
+ * calculate crc32c of several independent buffers
+ *
+ * On CPUs that can overlap the work this is faster than one buffer at a
+ * time when the buffers are small; see ceph_crc32c_multi_accelerated().
+ *
+ * @param crc initial values on input, results on output
+ * @param data pointers to the data buffers (none may be NULL)
+ * @param length lengths of the buffers
+ * @param count number of buffers
+ */
+void ceph_crc32c_multi(uint32_t *crc, unsigned char const **data,
+                       unsigned const *length, unsigned count);
+
+/**
+ * true if ceph_crc32c_multi() and ceph_crc32c_zeros() are hardware
+ * accelerated, so that splitting a crc32c over small buffers into
+ * independent crcs and combining them pays off
+ */
+int ceph_crc32c_multi_accelerated(void);
+
 /**
  * calculate crc32c
  *
@@ -66,6 +66,16 @@ struct denc_traits {
 template<typename T>
 inline constexpr bool denc_supported = denc_traits<T>::supported;
 
+/// true if T is encoded as its in-memory representation
+template<typename T>
+inline constexpr bool denc_flat = [] {
+  if constexpr (requires { denc_traits<T>::flat; }) {
+    return denc_traits<T>::flat;
+  } else {
+    return false;
+  }
+}();
+
 
 // hack for debug only; FIXME
 //#include <iostream>
@@ -227,6 +237,17 @@ template<typename T> int DencDumper<T>::i = 0;
   - denc_traits<std::foo<T>>-like traits are declared for standard container
   types.
 
+  - a trait may also declare
+
+      static constexpr bool flat = true;
+
+  if T is trivially copyable and its encoding is exactly its in-memory
+  representation (fixed size, no padding, little-endian fields in
+  declaration order).  Vectors of such types are then encoded and decoded
+  with a single memcpy.  The raw le/integer types are flat on little-endian
+  hosts; WRITE_CLASS_DENC_FLAT(type) is the WRITE_CLASS_DENC variant for
+  structs whose DENC is nothing but their members in order.
+
 
   class methods look like so
   ==========================
@@ -315,6 +336,7 @@ struct denc_traits<T> {
   static constexpr bool featured = false;
   static constexpr bool bounded = true;
   static constexpr bool need_contiguous = false;
+  static constexpr bool flat = true;
   static void bound_encode(const T &o, size_t& p, uint64_t f=0) {
     p += sizeof(T);
   }
@@ -388,6 +410,9 @@ struct denc_traits<T>
   static constexpr bool bounded = true;
   static constexpr bool need_contiguous = false;
   using etype = _denc::ExtType_t<T>;
+  static constexpr bool flat = (sizeof(T) == sizeof(etype) &&
+				!std::is_same_v<T, bool> &&
+				std::endian::native == std::endian::little);
   static void bound_encode(const T &o, size_t& p, uint64_t f=0) {
     p += sizeof(etype);
   }
@@ -428,8 +453,41 @@ inline void denc_varint(T v, ceph::buffer::list::contiguous_appender& p) {
   get_pos_add<__u8>(p) = byte;
 }
 
+// Decode a varint of up to 8 bytes (56 bits of payload) from the 8 bytes
+// at @pos in one go: find the terminating byte from the continuation bits
+// and squeeze the 7-bit groups together within the word.  Returns the
+// encoded length, or 0 if the value continues past those 8 bytes.
+inline unsigned denc_varint_decode_word(const char *pos, uint64_t *v) {
+  uint64_t w;
+  memcpy(&w, pos, sizeof(w));
+  w = boost::endian::little_to_native(w);
+  uint64_t stop = ~w & 0x8080808080808080ull;
+  if (!stop) {
+    return 0;
+  }
+  unsigned len = (std::countr_zero(stop) >> 3) + 1;
+  if (len < 8) {
+    w &= (1ull << (len * 8)) - 1;
+  }
+  w = ((w & 0x7f007f007f007f00ull) >> 1) | (w & 0x007f007f007f007full);
+  w = ((w & 0x3fff00003fff0000ull) >> 2) | (w & 0x00003fff00003fffull);
+  w = ((w & 0x0fffffff00000000ull) >> 4) | (w & 0x000000000fffffffull);
+  *v = w;
+  return len;
+}
+
 template<typename T>
 inline void denc_varint(T& v, ceph::buffer::ptr::const_iterator& p) {
+  // most varints sit well inside a contiguous buffer; avoid the per-byte
+  // bounds-checked advance when we can look at a whole word
+  if (p.get_end() - p.get_pos() >= (ptrdiff_t)sizeof(uint64_t)) {
+    uint64_t w;
+    if (unsigned len = denc_varint_decode_word(p.get_pos(), &w); len) {
+      v = (T)w;
+      p += len;
+      return;
+    }
+  }
   uint8_t byte = *(__u8*)p.get_pos_add(1);
   v = byte & 0x7f;
   int shift = 7;
@@ -995,6 +1053,12 @@ namespace _denc {
     // nohead
     static void encode_nohead(const container& s, ceph::buffer::list::contiguous_appender& p,
 			      uint64_t f = 0) {
+      if constexpr (bulk) {
+        if (const size_t len = s.size() * sizeof(T); len > 0) {
+          memcpy(p.get_pos_add(len), s.data(), len);
+        }
+        return;
+      }
       for (const T& e : s) {
         if constexpr (traits::featured) {
           denc(e, p, f);
@@ -1006,6 +1070,17 @@ namespace _denc {
     static void decode_nohead(size_t num, container& s,
 			      ceph::buffer::ptr::const_iterator& p,
 			      uint64_t f=0) {
+      if constexpr (bulk) {
+        // get_pos_add() checks the length before we size the container
+        const size_t len = num * sizeof(T);
+        const char *src = p.get_pos_add(len);
+        s.clear();
+        s.resize(num);
+        if (len > 0) {
+          memcpy(static_cast<void*>(s.data()), src, len);
+        }
+        return;
+      }
       s.clear();
       Details::reserve(s, num);
       while (num--) {
@@ -1018,6 +1093,18 @@ namespace _denc {
     static std::enable_if_t<!!sizeof(U) && !need_contiguous>
     decode_nohead(size_t num, container& s,
 		  ceph::buffer::list::const_iterator& p) {
+      if constexpr (bulk) {
+        const size_t len = num * sizeof(T);
+        if (p.get_remaining() < len) {
+          throw ceph::buffer::end_of_buffer();
+        }
+        s.clear();
+        s.resize(num);
+        if (len > 0) {
+          p.copy(len, reinterpret_cast<char*>(s.data()));
+        }
+        return;
+      }
       s.clear();
       Details::reserve(s, num);
       while (num--) {
@@ -1026,6 +1113,12 @@ namespace _denc {
 	Details::insert(s, std::move(t));
       }
     }
+
+  private:
+    /// flat elements in contiguous storage go in and out with one memcpy
+    static constexpr bool bulk = denc_flat<T> &&
+      std::contiguous_iterator<typename container::iterator> &&
+      requires(container& c, size_t n) { c.resize(n); };
   };
 
   template<typename T>
@@ -1612,6 +1705,31 @@ struct denc_traits<std::nullopt_t> {
     }									\
   };
 
+// For fixed-size structs whose DENC encodes each member in declaration
+// order and nothing else; see "flat" above.
+#define WRITE_CLASS_DENC_FLAT(T)					\
+  template<> struct denc_traits<T> {					\
+    static_assert(std::is_trivially_copyable_v<T>);			\
+    static_assert(std::has_unique_object_representations_v<T>,		\
+		  "flat types must not have padding");			\
+    static constexpr bool supported = true;				\
+    static constexpr bool featured = false;				\
+    static constexpr bool bounded = true;				\
+    static constexpr bool need_contiguous = !_denc::has_legacy_denc<T>::value;\
+    static constexpr bool flat =					\
+      std::endian::native == std::endian::little;			\
+    static void bound_encode(const T& v, size_t& p, uint64_t f=0) {	\
+      v.bound_encode(p);						\
+    }									\
+    static void encode(const T& v, ::ceph::buffer::list::contiguous_appender& p, \
+		       uint64_t f=0) {					\
+      v.encode(p);							\
+    }									\
+    static void decode(T& v, ::ceph::buffer::ptr::const_iterator& p, uint64_t f=0) { \
+      v.decode(p);							\
+    }									\
+  };
+
 #define WRITE_CLASS_DENC_FEATURED(T) _DECLARE_CLASS_DENC_FEATURED(T, false)
 #define WRITE_CLASS_DENC_FEATURED_BOUNDED(T) _DECLARE_CLASS_DENC_FEATURED(T, true)
 #define _DECLARE_CLASS_DENC_FEATURED(T, b)				\
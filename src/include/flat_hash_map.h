@@ -0,0 +1,46 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#ifndef CEPH_INCLUDE_FLAT_HASH_MAP_H
+#define CEPH_INCLUDE_FLAT_HASH_MAP_H
+
+#include <functional>
+#include <utility>
+
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include "include/mempool.h"
+
+namespace ceph {
+
+/*
+ * flat_hash_map - an open addressing hash map
+ *
+ * Entries live in a single array, so compared to std::unordered_map there
+ * is no allocation per entry and a lookup usually touches one or two cache
+ * lines.  The price is weaker stability guarantees: insertion may rehash,
+ * which invalidates all iterators and references, and there is no node
+ * handle or bucket interface.
+ */
+template <typename K, typename V,
+          typename Hash = boost::hash<K>,
+          typename Eq = std::equal_to<K>,
+          typename Alloc = std::allocator<std::pair<const K, V>>>
+using flat_hash_map = boost::unordered_flat_map<K, V, Hash, Eq, Alloc>;
+
+} // namespace ceph
+
+// mempool::<pool>::flat_hash_map
+#define P(x)                                                            \
+  namespace mempool::x {                                                \
+    template <typename k, typename v,                                   \
+              typename h = boost::hash<k>,                              \
+              typename eq = std::equal_to<k>>                           \
+    using flat_hash_map =                                               \
+      ceph::flat_hash_map<k, v, h, eq,                                  \
+                          pool_allocator<std::pair<const k, v>>>;       \
+  }
+DEFINE_MEMORY_POOLS_HELPER(P)
+#undef P
+
+#endif
@@ -172,6 +172,7 @@ namespace mempool {
   f(bluefs_file_writer)              \
   f(buffer_anon)		      \
   f(buffer_meta)		      \
+  f(buffer_slab)		      \
   f(osd)			      \
   f(osd_mapbl)			      \
   f(osd_pglog)			      \
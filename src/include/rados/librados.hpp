@@ -1,6 +1,7 @@
 #ifndef __LIBRADOS_HPP
 #define __LIBRADOS_HPP
 
+#include <functional>
 #include <string>
 #include <list>
 #include <map>
@@ -1035,6 +1036,44 @@ inline namespace v14_2_0 {
         ObjectCursor *split_start,
         ObjectCursor *split_finish);
 
+    /**
+     * Callback for object_list_parallel()
+     *
+     * @param slice [in] index of the slice the batch belongs to
+     * @param items [in] the batch; the callee may consume it
+     * @param next [in] cursor the slice continues from; at the end once
+     *             the slice is done (see object_list_is_end())
+     * @returns 0 to continue, anything else to stop the listing
+     */
+    typedef std::function<int(size_t slice,
+                              std::vector<ObjectItem>& items,
+                              const ObjectCursor& next)> object_list_cb_t;
+
+    /**
+     * List objects between two cursors, several slices of the pool at once
+     *
+     * The range is cut into @slices parts as with object_list_slice(), and
+     * up to @concurrency of them are listed at a time, @result_count objects
+     * per request.  Batches are passed to @cb from the calling thread as
+     * they arrive, so at most @concurrency batches are held in memory and
+     * the order between slices is unspecified.
+     *
+     * To continue an interrupted listing, pass the same range and @slices
+     * and, in @resume, the last @next cursor seen for each slice (or the
+     * slice start for a slice that was never reported).
+     *
+     * @returns 0 on success, negative error code on failure, or the
+     *          non-zero value @cb returned
+     */
+    int object_list_parallel(const ObjectCursor& start,
+                             const ObjectCursor& finish,
+                             size_t slices,
+                             size_t concurrency,
+                             size_t result_count,
+                             const bufferlist& filter,
+                             const std::vector<ObjectCursor> *resume,
+                             object_list_cb_t cb);
+
     /**
      * List available hit set objects
      *
@@ -270,7 +270,7 @@ public:
   }
 };
 WRITE_CLASS_ENCODER(utime_t)
-WRITE_CLASS_DENC(utime_t)
+WRITE_CLASS_DENC_FLAT(utime_t)
 
 // arithmetic operators
 inline utime_t operator+(const utime_t& l, const utime_t& r) {
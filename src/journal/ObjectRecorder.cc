@@ -189,6 +189,15 @@ void ObjectRecorder::handle_append_flushed(uint64_t tid, int r) {
   ceph_assert(tid_iter != m_in_flight_tids.end());
   m_in_flight_tids.erase(tid_iter);
 
+  auto time_iter = m_in_flight_times.find(tid);
+  ceph_assert(time_iter != m_in_flight_times.end());
+  if (r >= 0) {
+    double latency = double(ceph_clock_now() - time_iter->second);
+    m_append_latency = (m_append_latency == 0 ? latency :
+                        0.875 * m_append_latency + 0.125 * latency);
+  }
+  m_in_flight_times.erase(time_iter);
+
   InFlightAppends::iterator iter = m_in_flight_appends.find(tid);
   ceph_assert(iter != m_in_flight_appends.end());
 
@@ -299,6 +308,16 @@ bool ObjectRecorder::send_appends(bool force, ceph::ref_t<FutureImpl> flush_futu
     if (!force && max_in_flight_appends == 0) {
       ldout(m_cct, 20) << "attempting to batch AIO appends" << dendl;
       max_in_flight_appends = 1;
+
+      // entries batched behind an append wait for it to complete. when
+      // that is more than half an append latency away, send a second
+      // append instead of holding them that long
+      if (m_in_flight_times.size() == 1 && m_append_latency > 0 &&
+          double(ceph_clock_now() - m_in_flight_times.begin()->second) <
+            m_append_latency / 2) {
+        ldout(m_cct, 20) << "not batching behind a recent append" << dendl;
+        max_in_flight_appends = 2;
+      }
     }
   } else if (max_in_flight_appends < 0) {
     max_in_flight_appends = 0;
@@ -357,6 +376,7 @@ bool ObjectRecorder::send_appends(bool force, ceph::ref_t<FutureImpl> flush_futu
 
     uint64_t append_tid = m_append_tid++;
     m_in_flight_tids.insert(append_tid);
+    m_in_flight_times[append_tid] = m_last_flush_time;
     m_in_flight_appends[append_tid].swap(append_buffers);
     m_in_flight_bytes += append_bytes;
 
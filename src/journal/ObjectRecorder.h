@@ -133,6 +133,8 @@ private:
 
   InFlightTids m_in_flight_tids;
   InFlightAppends m_in_flight_appends;
+  std::map<uint64_t, utime_t> m_in_flight_times;
+  double m_append_latency = 0; // moving average, in seconds
   uint64_t m_object_bytes = 0;
 
   bool m_overflowed = false;
@@ -608,8 +608,7 @@ int RocksDBStore::load_rocksdb_options(bool create_if_missing, rocksdb::Options&
   dout(10) << __func__ << " block size " << cct->_conf->rocksdb_block_size
            << ", block_cache size " << byte_u_t(block_cache_size)
 	   << ", row_cache size " << byte_u_t(row_cache_size)
-	   << "; shards "
-	   << (1 << cct->_conf->rocksdb_cache_shard_bits)
+	   << "; shard bits " << cct->_conf->rocksdb_cache_shard_bits
 	   << ", type " << cct->_conf->rocksdb_cache_type
 	   << dendl;
 
@@ -1264,6 +1263,12 @@ int RocksDBStore::do_open(ostream &out,
   plb.add_time_avg(l_rocksdb_write_delay_time, "rocksdb_write_delay_time", "Rocksdb write delay time");
   plb.add_time_avg(l_rocksdb_write_pre_and_post_process_time, 
       "rocksdb_write_pre_and_post_time", "total time spent on writing a record, excluding write process");
+  plb.add_time_avg(l_rocksdb_iter_create_lat, "iter_create_lat",
+    "Time to create a pooled column family iterator");
+  plb.add_time_avg(l_rocksdb_iter_reuse_lat, "iter_reuse_lat",
+    "Time to hand out a column family iterator from the pool");
+  plb.add_u64_counter(l_rocksdb_iter_refresh, "iter_refresh",
+    "Pooled iterators refreshed before reuse");
   logger = plb.create_perf_counters();
   cct->get_perfcounters_collection()->add(logger);
 
@@ -1309,6 +1314,9 @@ void RocksDBStore::close()
     compact_queue_lock.unlock();
   }
 
+  // pooled iterators must go before their column families
+  clear_iterator_pool();
+
   if (logger) {
     cct->get_perfcounters_collection()->remove(logger);
     delete logger;
@@ -2366,6 +2374,11 @@ public:
   ~CFIteratorImpl() {
     delete dbiter;
   }
+protected:
+  // wrap an iterator whose bounds are maintained by the caller
+  CFIteratorImpl(const std::string& p, rocksdb::Iterator *it)
+    : prefix(p), dbiter(it) {}
+public:
 
   int seek_to_first() override {
     dbiter->SeekToFirst();
@@ -2430,6 +2443,108 @@ public:
   }
 };
 
+// CFIteratorImpl on an iterator borrowed from the pool; gives it back
+// when the last reference goes away.
+class PooledCFIteratorImpl : public CFIteratorImpl {
+  RocksDBStore *db;
+  std::unique_ptr<RocksDBStore::PooledIterator> pooled;
+public:
+  PooledCFIteratorImpl(RocksDBStore *db,
+                       const std::string& p,
+                       std::unique_ptr<RocksDBStore::PooledIterator> pi)
+    : CFIteratorImpl(p, pi->it.get()), db(db), pooled(std::move(pi)) {}
+  ~PooledCFIteratorImpl() {
+    dbiter = nullptr; // owned by pooled
+    db->put_pooled_iterator(std::move(pooled));
+  }
+};
+
+std::unique_ptr<RocksDBStore::PooledIterator>
+RocksDBStore::get_pooled_iterator(rocksdb::ColumnFamilyHandle *cf,
+                                  const IteratorBounds& bounds)
+{
+  auto start = ceph::mono_clock::now();
+  auto max_age = ceph::make_timespan(cct->_conf->rocksdb_iterator_pool_max_age);
+  std::unique_ptr<PooledIterator> p;
+  std::vector<std::unique_ptr<PooledIterator>> expired;
+  {
+    std::lock_guard l(iterator_pool_lock);
+    auto q = iterator_pool.find(cf);
+    if (q != iterator_pool.end() && !q->second.empty()) {
+      auto& v = q->second;
+      // most recently used at the back; if that one already idled too
+      // long, so did all the others
+      if (start - v.back()->last_used > max_age) {
+        expired.swap(v);
+      } else {
+        p = std::move(v.back());
+        v.pop_back();
+      }
+    }
+  }
+  expired.clear();
+
+  auto seq = db->GetLatestSequenceNumber();
+  if (p) {
+    p->lower = *bounds.lower_bound;
+    p->upper = *bounds.upper_bound;
+    p->lower_slice = rocksdb::Slice(p->lower);
+    p->upper_slice = rocksdb::Slice(p->upper);
+    if (p->seq != seq || start - p->refreshed > max_age) {
+      if (p->it->Refresh().ok()) {
+        p->seq = seq;
+        p->refreshed = start;
+        logger->inc(l_rocksdb_iter_refresh);
+      } else {
+        p.reset();
+      }
+    }
+    if (p) {
+      logger->tinc(l_rocksdb_iter_reuse_lat, ceph::mono_clock::now() - start);
+      return p;
+    }
+  }
+
+  p = std::make_unique<PooledIterator>();
+  p->cf = cf;
+  p->lower = *bounds.lower_bound;
+  p->upper = *bounds.upper_bound;
+  p->lower_slice = rocksdb::Slice(p->lower);
+  p->upper_slice = rocksdb::Slice(p->upper);
+  rocksdb::ReadOptions options;
+  options.iterate_lower_bound = &p->lower_slice;
+  options.iterate_upper_bound = &p->upper_slice;
+  // seq is sampled first so that we never skip a refresh we need
+  p->seq = seq;
+  p->refreshed = start;
+  p->it.reset(db->NewIterator(options, cf));
+  logger->tinc(l_rocksdb_iter_create_lat, ceph::mono_clock::now() - start);
+  return p;
+}
+
+void RocksDBStore::put_pooled_iterator(std::unique_ptr<PooledIterator> p)
+{
+  auto max = cct->_conf->rocksdb_iterator_pool_size;
+  if (!p->it->status().ok() || max == 0) {
+    return;
+  }
+  p->last_used = ceph::mono_clock::now();
+  std::unique_ptr<PooledIterator> drop;
+  std::lock_guard l(iterator_pool_lock);
+  auto& v = iterator_pool[p->cf];
+  if (v.size() >= max) {
+    drop = std::move(p);
+    return;
+  }
+  v.push_back(std::move(p));
+}
+
+void RocksDBStore::clear_iterator_pool()
+{
+  std::lock_guard l(iterator_pool_lock);
+  iterator_pool.clear();
+}
+
 
 //merge column iterators and rest iterator
 class WholeMergeIteratorImpl : public KeyValueDB::WholeSpaceIteratorImpl {
@@ -3146,7 +3261,14 @@ KeyValueDB::Iterator RocksDBStore::get_iterator(const std::string& prefix, Itera
     } else if (cct->_conf->osd_rocksdb_iterator_bounds_enabled) {
       cf = check_cf_handle_bounds(cf_it, bounds);
     }
-    if (cf) {
+    if (cf && bounds.lower_bound && bounds.upper_bound &&
+        cct->_conf->osd_rocksdb_iterator_bounds_enabled &&
+        cct->_conf->rocksdb_iterator_pool_size > 0) {
+      return std::make_shared<PooledCFIteratorImpl>(
+              this,
+              prefix,
+              get_pooled_iterator(cf, bounds));
+    } else if (cf) {
       return std::make_shared<CFIteratorImpl>(
               this,
               prefix,
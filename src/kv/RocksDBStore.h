@@ -30,6 +30,7 @@
 #include "common/Formatter.h"
 #include "common/Cond.h"
 #include "common/ceph_context.h"
+#include "common/ceph_time.h"
 #include "common/PriorityCache.h"
 #include "common/pretty_binary.h"
 
@@ -48,6 +49,9 @@ enum {
   l_rocksdb_write_memtable_time,
   l_rocksdb_write_delay_time,
   l_rocksdb_write_pre_and_post_process_time,
+  l_rocksdb_iter_create_lat,
+  l_rocksdb_iter_reuse_lat,
+  l_rocksdb_iter_refresh,
   l_rocksdb_last,
 };
 
@@ -98,6 +102,7 @@ class RocksDBStore : public KeyValueDB {
   bool set_cache_flag = false;
   friend class ShardMergeIteratorImpl;
   friend class CFIteratorImpl;
+  friend class PooledCFIteratorImpl;
   friend class WholeMergeIteratorImpl;
   /*
    *  See RocksDB's definition of a column family(CF) and how to use it.
@@ -147,6 +152,35 @@ private:
   int do_open(std::ostream &out, bool create_if_missing, bool open_readonly,
 	      const std::string& cfs="");
   int load_rocksdb_options(bool create_if_missing, rocksdb::Options& opt);
+
+  /*
+   * Bounded iterators on a single column family are kept around after
+   * use and handed out again for the next bounded scan of the same cf.
+   * The bounds live next to the iterator, so reusing it only rewrites the
+   * slices the ReadOptions point at.  An iterator is refreshed before
+   * reuse if the db advanced past the sequence it was built at, or if it
+   * is older than rocksdb_iterator_pool_max_age; idle iterators past that
+   * age are dropped so they don't pin memtables and sst files.
+   */
+  struct PooledIterator {
+    rocksdb::ColumnFamilyHandle *cf = nullptr;
+    std::unique_ptr<rocksdb::Iterator> it;
+    std::string lower, upper;
+    rocksdb::Slice lower_slice, upper_slice;
+    rocksdb::SequenceNumber seq = 0;      //< db sequence it reflects
+    ceph::mono_time refreshed;            //< created or last refreshed
+    ceph::mono_time last_used;            //< returned to the pool
+  };
+  ceph::mutex iterator_pool_lock =
+    ceph::make_mutex("RocksDBStore::iterator_pool_lock");
+  std::unordered_map<rocksdb::ColumnFamilyHandle*,
+		     std::vector<std::unique_ptr<PooledIterator>>> iterator_pool;
+
+  std::unique_ptr<PooledIterator> get_pooled_iterator(
+    rocksdb::ColumnFamilyHandle *cf,
+    const IteratorBounds& bounds);
+  void put_pooled_iterator(std::unique_ptr<PooledIterator> p);
+  void clear_iterator_pool();
 public:
   static bool parse_sharding_def(const std::string_view text_def,
 				std::vector<ColumnFamily>& sharding_def,
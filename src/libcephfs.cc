@@ -13,10 +13,16 @@
  *
  */
 
+#include <algorithm>
+#include <atomic>
 #include <fcntl.h>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <string.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "include/Context.h"
 #include "auth/Crypto.h"
@@ -27,6 +33,7 @@
 #include "common/ceph_argparse.h"
 #include "common/common_init.h"
 #include "common/config.h"
+#include "common/Thread.h"
 #include "common/version.h"
 #include "mon/MonClient.h"
 #include "include/str_list.h"
@@ -2267,6 +2274,101 @@ extern "C" int ceph_ll_mknod(class ceph_mount_info *cmount, Inode *parent,
 					   out, stx, want, flags, *perms);
 }
 
+// the most threads a batch call starts, whatever max_inflight asks for
+static constexpr unsigned max_batch_threads = 64;
+
+/*
+ * run op(i) for every i in [0, count) on up to max_inflight threads. the
+ * client sends the mds request of each thread while the others wait for
+ * their replies, so that many requests are in flight at once. returns
+ * -EAGAIN, before running any op, if the threads can't be started.
+ */
+static int run_batch(size_t count, unsigned max_inflight,
+		     const std::function<void(size_t)>& op)
+{
+  std::atomic<size_t> next{0};
+  // the workers start once all of them exist
+  std::promise<bool> started;
+  auto go = started.get_future().share();
+  auto worker = [&, go] {
+    if (!go.get()) {
+      return;
+    }
+    for (size_t i; (i = next++) < count; ) {
+      op(i);
+    }
+  };
+  size_t nthreads = std::min<size_t>(
+    std::clamp(max_inflight, 1u, max_batch_threads), count);
+  std::vector<std::thread> threads;
+  try {
+    threads.reserve(nthreads);
+    for (size_t t = 1; t < nthreads; t++) {
+      threads.push_back(make_named_thread("ll_batch", worker));
+    }
+  } catch (const std::system_error&) {
+    started.set_value(false);
+    for (auto& t : threads) {
+      t.join();
+    }
+    return -EAGAIN;
+  }
+  started.set_value(true);
+  worker();
+  for (auto& t : threads) {
+    t.join();
+  }
+  return 0;
+}
+
+extern "C" int ceph_ll_mknod_batch(class ceph_mount_info *cmount,
+				   Inode *parent, const char * const *names,
+				   size_t count, mode_t mode, dev_t rdev,
+				   unsigned max_inflight, Inode **outs,
+				   int *results, const UserPerm *perms)
+{
+  if (count && (!names || !outs || !results))
+    return -EINVAL;
+  Client *client = cmount->get_client();
+  return run_batch(count, max_inflight, [&](size_t i) {
+    struct ceph_statx stx;
+    outs[i] = nullptr;
+    results[i] = client->ll_mknodx(parent, names[i], mode, rdev, &outs[i],
+                                   &stx, 0, 0, *perms);
+  });
+}
+
+extern "C" int ceph_ll_getattr_batch(class ceph_mount_info *cmount,
+				     Inode **ins, size_t count,
+				     struct ceph_statx *stxs,
+				     unsigned int want, unsigned int flags,
+				     unsigned max_inflight, int *results,
+				     const UserPerm *perms)
+{
+  if (flags & ~CEPH_REQ_FLAG_MASK)
+    return -EINVAL;
+  if (count && (!ins || !stxs || !results))
+    return -EINVAL;
+  Client *client = cmount->get_client();
+  return run_batch(count, max_inflight, [&](size_t i) {
+    results[i] = client->ll_getattrx(ins[i], &stxs[i], want, flags, *perms);
+  });
+}
+
+extern "C" int ceph_ll_setattr_batch(class ceph_mount_info *cmount,
+				     Inode **ins, size_t count,
+				     struct ceph_statx *stxs, int mask,
+				     unsigned max_inflight, int *results,
+				     const UserPerm *perms)
+{
+  if (count && (!ins || !stxs || !results))
+    return -EINVAL;
+  Client *client = cmount->get_client();
+  return run_batch(count, max_inflight, [&](size_t i) {
+    results[i] = client->ll_setattrx(ins[i], &stxs[i], mask, *perms);
+  });
+}
+
 extern "C" int ceph_ll_mkdir(class ceph_mount_info *cmount, Inode *parent,
 			     const char *name, mode_t mode, Inode **out,
 			     struct ceph_statx *stx, unsigned want,
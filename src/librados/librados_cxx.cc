@@ -43,6 +43,7 @@
 #include <set>
 #include <vector>
 #include <list>
+#include <deque>
 #include <stdexcept>
 #include <system_error>
 
@@ -3159,6 +3160,119 @@ void librados::IoCtx::object_list_slice(
       (hobject_t*)(split_finish->c_cursor));
 }
 
+int librados::IoCtx::object_list_parallel(
+    const ObjectCursor& start,
+    const ObjectCursor& finish,
+    size_t slices,
+    size_t concurrency,
+    size_t result_count,
+    const bufferlist& filter,
+    const std::vector<ObjectCursor> *resume,
+    object_list_cb_t cb)
+{
+  if (slices == 0 || concurrency == 0 || result_count == 0 ||
+      (resume && resume->size() != slices)) {
+    return -EINVAL;
+  }
+
+  struct slice_t {
+    hobject_t pos, end;
+    bool done() const {
+      return pos.is_max() || (!end.is_max() && pos >= end);
+    }
+  };
+  std::vector<slice_t> sl(slices);
+  for (size_t i = 0; i < slices; ++i) {
+    io_ctx_impl->object_list_slice(
+      *(hobject_t*)start.c_cursor, *(hobject_t*)finish.c_cursor,
+      i, slices, &sl[i].pos, &sl[i].end);
+    if (resume) {
+      sl[i].pos = *(hobject_t*)(*resume)[i].c_cursor;
+    }
+  }
+
+  struct batch_t {
+    size_t slice;
+    boost::system::error_code ec;
+    std::vector<librados::ListObjectImpl> items;
+    hobject_t next;
+  };
+  ceph::mutex lock = ceph::make_mutex("IoCtx::object_list_parallel");
+  ceph::condition_variable cond;
+  std::deque<batch_t> ready;
+  size_t in_flight = 0;
+
+  // only this thread issues and consumes; completions just queue
+  auto issue = [&](size_t i) {
+    ++in_flight;
+    io_ctx_impl->objecter->enumerate_objects<librados::ListObjectImpl>(
+      io_ctx_impl->poolid, io_ctx_impl->oloc.nspace,
+      sl[i].pos, sl[i].end, result_count, filter,
+      [&, i](boost::system::error_code ec,
+	     std::vector<librados::ListObjectImpl> items,
+	     hobject_t next) {
+	std::lock_guard l{lock};
+	ready.push_back({i, ec, std::move(items), std::move(next)});
+	cond.notify_one();
+      });
+  };
+
+  // slices that still need a request, in order; a slice has at most one
+  // request outstanding
+  std::deque<size_t> pending;
+  for (size_t i = 0; i < slices; ++i) {
+    if (!sl[i].done()) {
+      pending.push_back(i);
+    }
+  }
+
+  int r = 0;
+  std::vector<ObjectItem> items;
+  while (true) {
+    while (r == 0 && in_flight < concurrency && !pending.empty()) {
+      issue(pending.front());
+      pending.pop_front();
+    }
+    if (in_flight == 0) {
+      break;
+    }
+    batch_t b;
+    {
+      std::unique_lock l{lock};
+      cond.wait(l, [&] { return !ready.empty(); });
+      b = std::move(ready.front());
+      ready.pop_front();
+    }
+    --in_flight;
+    if (r != 0) {
+      continue;  // draining after an error or stop
+    }
+    if (b.ec) {
+      r = ceph::from_error_code(b.ec);
+      continue;
+    }
+    auto& s = sl[b.slice];
+    s.pos = std::move(b.next);
+    if (s.done()) {
+      s.pos = hobject_t::get_max();
+    } else {
+      pending.push_back(b.slice);
+    }
+    items.clear();
+    items.reserve(b.items.size());
+    for (auto& i : b.items) {
+      ObjectItem oi;
+      oi.oid = std::move(i.oid);
+      oi.nspace = std::move(i.nspace);
+      oi.locator = std::move(i.locator);
+      items.push_back(std::move(oi));
+    }
+    ObjectCursor next((rados_object_list_cursor)&s.pos);
+    r = cb(b.slice, items, next);
+  }
+  return r;
+}
+
 int librados::IoCtx::application_enable(const std::string& app_name,
                                         bool force)
 {
@@ -846,6 +846,7 @@ librados::IoCtx duplicate_io_ctx(librados::IoCtx& io_ctx) {
     ASSIGN_OPTION(skip_partial_discard, bool);
     ASSIGN_OPTION(discard_granularity_bytes, uint64_t);
     ASSIGN_OPTION(blkin_trace_all, bool);
+    ASSIGN_OPTION(coalesce_event_notify, bool);
 
     auto cache_policy = config.get_val<std::string>("rbd_cache_policy");
     if (cache_policy == "writethrough" || cache_policy == "writeback") {
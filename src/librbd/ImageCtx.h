@@ -209,6 +209,9 @@ namespace librbd {
 
     Completions event_socket_completions;
     EventSocket event_socket;
+    // set while the event socket was notified of completions that
+    // weren't polled yet (rbd_coalesce_event_notify)
+    std::atomic<bool> event_socket_notified = {false};
 
     bool ignore_migrating = false;
     bool disable_zero_copy = false;
@@ -226,6 +229,7 @@ namespace librbd {
     uint32_t read_flags = 0U;  // librados::OPERATION_*
     uint32_t discard_granularity_bytes = 0;
     bool blkin_trace_all;
+    bool coalesce_event_notify;
     uint64_t mirroring_replay_delay;
     uint64_t mtime_update_interval;
     uint64_t atime_update_interval;
@@ -553,6 +553,7 @@ void ImageWatcher<I>::notify_acquired_lock() {
   {
     std::lock_guard owner_client_id_locker{m_owner_client_id_lock};
     set_owner_client_id(client_id);
+    m_lock_acquired_time = ceph_clock_now();
   }
 
   send_notify(new AcquiredLockPayload(client_id));
@@ -1067,10 +1068,39 @@ bool ImageWatcher<I>::handle_payload(const RequestLockPayload &payload,
         return true;
       }
 
-      ldout(m_image_ctx.cct, 10) << this << " queuing release of exclusive lock"
-                                 << dendl;
-      r = m_image_ctx.get_exclusive_lock_policy()->lock_requested(
-        payload.force);
+      // hand over a lock that was just acquired only once the minimum hold
+      // time passes, so that writers sharing an image don't bounce it back
+      // and forth with every other write. the requester keeps waiting for
+      // the release since the request is acked
+      auto policy = m_image_ctx.get_exclusive_lock_policy();
+      double held = ceph_clock_now() - m_lock_acquired_time;
+      double min_hold = m_image_ctx.config.template get_val<double>(
+        "rbd_exclusive_lock_min_hold_time");
+      if (!payload.force && held < min_hold &&
+          policy->may_auto_request_lock()) {
+        ldout(m_image_ctx.cct, 10) << this << " delaying release of exclusive "
+                                   << "lock for " << min_hold - held << "s"
+                                   << dendl;
+        auto ctx = new LambdaContext([this](int r) {
+            if (r == -ECANCELED) {
+              return;
+            }
+            std::shared_lock owner_locker{m_image_ctx.owner_lock};
+            if (m_image_ctx.exclusive_lock != nullptr &&
+                m_image_ctx.exclusive_lock->is_lock_owner()) {
+              ldout(m_image_ctx.cct, 10) << this << " queuing delayed release "
+                                         << "of exclusive lock" << dendl;
+              m_image_ctx.get_exclusive_lock_policy()->lock_requested(false);
+            }
+          });
+        // no-op if a delayed release is already scheduled
+        m_task_finisher->add_event_after(TASK_CODE_RELEASE_LOCK,
+                                         min_hold - held, ctx);
+      } else {
+        ldout(m_image_ctx.cct, 10) << this << " queuing release of exclusive "
+                                   << "lock" << dendl;
+        r = policy->lock_requested(payload.force);
+      }
     }
     encode(ResponseMessage(r), ack_ctx->out);
   }
@@ -102,6 +102,7 @@ private:
     TASK_CODE_ASYNC_REQUEST,
     TASK_CODE_ASYNC_PROGRESS,
     TASK_CODE_QUIESCE,
+    TASK_CODE_RELEASE_LOCK,
   };
 
   typedef std::pair<Context *, ProgressContext *> AsyncRequest;
@@ -191,6 +192,7 @@ private:
 
   ceph::mutex m_owner_client_id_lock;
   watch_notify::ClientId m_owner_client_id;
+  utime_t m_lock_acquired_time;
 
   AsyncOpTracker m_async_op_tracker;
 
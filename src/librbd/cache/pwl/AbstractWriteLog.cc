@@ -268,6 +268,7 @@ void AbstractWriteLog<I>::perf_start(std::string name) {
 
   plb.add_u64_counter(l_librbd_pwl_internal_flush, "internal_flush", "Flush RWL (write back to OSD)");
   plb.add_time_avg(l_librbd_pwl_writeback_latency, "writeback_lat", "write back to OSD latency");
+  plb.add_u64_counter(l_librbd_pwl_writeback_skipped, "writeback_skipped", "Overwritten log entries not written back to OSD");
   plb.add_u64_counter(l_librbd_pwl_invalidate_cache, "invalidate", "Invalidate RWL");
   plb.add_u64_counter(l_librbd_pwl_invalidate_discard_cache, "discard", "Discard and invalidate RWL");
 
@@ -1666,6 +1667,38 @@ bool AbstractWriteLog<I>::can_flush_entry(std::shared_ptr<GenericLogEntry> log_e
          (m_flush_bytes_in_flight <= IN_FLIGHT_FLUSH_BYTES_LIMIT));
 }
 
+/**
+ * A write entry need not be written back when later writes of the same
+ * sync gen have replaced all of it in the map. Writes of one sync gen are
+ * flushed in any order anyway, so the image still goes from one sync
+ * point to the next. An entry overwritten by a later gen is still written
+ * back, as the image may be left at its sync point before the next.
+ */
+template <typename I>
+bool AbstractWriteLog<I>::is_superseded(std::shared_ptr<GenericLogEntry> log_entry) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+
+  if (m_invalidating || !log_entry->is_write_entry()) {
+    return false;
+  }
+  auto write_entry = static_pointer_cast<GenericWriteLogEntry>(log_entry);
+  if (write_entry->get_map_ref()) {
+    return false;
+  }
+  auto extent = write_entry->block_extent();
+  uint64_t covered = 0;
+  for (auto &map_entry : m_blocks_to_log_entries.find_map_entries(extent)) {
+    if (map_entry.log_entry->ram_entry.sync_gen_number !=
+        write_entry->ram_entry.sync_gen_number) {
+      return false;
+    }
+    /* map entries don't overlap, but may extend past this extent */
+    covered += std::min(map_entry.block_extent.block_end, extent.block_end) -
+               std::max(map_entry.block_extent.block_start, extent.block_start);
+  }
+  return covered == extent.block_end - extent.block_start;
+}
+
 template <typename I>
 void AbstractWriteLog<I>::detain_flush_guard_request(std::shared_ptr<GenericLogEntry> log_entry,
 						     GuardedRequestFunctionContext *guarded_ctx) {
@@ -1790,6 +1823,18 @@ void AbstractWriteLog<I>::process_writeback_dirty_entries() {
 
       auto candidate = m_dirty_log_entries.front();
       bool flushable = can_flush_entry(candidate);
+      if (flushable && is_superseded(candidate)) {
+        /* Completes like a flushed entry without reading or writing its
+         * data, and without taking an in-flight flush slot */
+        ldout(cct, 20) << "skipping overwritten entry: " << candidate << dendl;
+        ceph_assert(m_bytes_dirty >= candidate->bytes_dirty());
+        candidate->set_flushed(true);
+        m_bytes_dirty -= candidate->bytes_dirty();
+        sync_point_writer_flushed(candidate->get_sync_point_entry());
+        m_dirty_log_entries.pop_front();
+        m_perfcounter->inc(l_librbd_pwl_writeback_skipped, 1);
+        continue;
+      }
       if (flushable) {
         entries_to_flush.push_back(candidate);
         flushed++;
@@ -140,6 +140,7 @@ enum {
 
   l_librbd_pwl_internal_flush,
   l_librbd_pwl_writeback_latency,
+  l_librbd_pwl_writeback_skipped,
   l_librbd_pwl_invalidate_cache,
   l_librbd_pwl_invalidate_discard_cache,
 
@@ -152,14 +152,16 @@ void ImageCopyRequest<I>::send_object_copies() {
   bool complete;
   {
     std::lock_guard locker{m_lock};
-    auto max_ops = m_src_image_ctx->config.template get_val<uint64_t>(
+    m_min_ops = m_src_image_ctx->config.template get_val<uint64_t>(
       "rbd_concurrent_management_ops");
+    m_ops_limit = std::max(m_min_ops,
+                           m_src_image_ctx->config.template get_val<uint64_t>(
+                             "rbd_deep_copy_max_concurrent_ops"));
+    m_max_ops = m_min_ops;
 
     // attempt to schedule at least 'max_ops' initial requests where
     // some objects might be skipped if fast-diff notes no change
-    for (uint64_t i = 0; i < max_ops; i++) {
-      send_next_object_copy();
-    }
+    while (m_current_ops < m_max_ops && send_next_object_copy());
 
     complete = (m_current_ops == 0) && !m_updating_progress;
   }
@@ -170,7 +172,7 @@ void ImageCopyRequest<I>::send_object_copies() {
 }
 
 template <typename I>
-void ImageCopyRequest<I>::send_next_object_copy() {
+bool ImageCopyRequest<I>::send_next_object_copy() {
   ceph_assert(ceph_mutex_is_locked(m_lock));
 
   if (m_canceled && m_ret_val == 0) {
@@ -179,15 +181,10 @@ void ImageCopyRequest<I>::send_next_object_copy() {
   }
 
   if (m_ret_val < 0 || m_object_no >= m_end_object_no) {
-    return;
+    return false;
   }
 
   uint64_t ono = m_object_no++;
-  Context *ctx = new LambdaContext(
-    [this, ono](int r) {
-      handle_object_copy(ono, r);
-    });
-
   ldout(m_cct, 20) << "object_num=" << ono << dendl;
   ++m_current_ops;
 
@@ -213,11 +210,21 @@ void ImageCopyRequest<I>::send_next_object_copy() {
 
     if (object_diff_state == object_map::DIFF_STATE_HOLE) {
       ldout(m_cct, 20) << "skipping non-existent object " << ono << dendl;
+      Context *ctx = new LambdaContext(
+        [this, ono](int r) {
+          handle_object_copy(ono, r, std::nullopt);
+        });
       create_async_context_callback(*m_src_image_ctx, ctx)->complete(0);
-      return;
+      return true;
     }
   }
 
+  // only copied objects tell how loaded the OSDs are
+  Context *ctx = new LambdaContext(
+    [this, ono, start=ceph::mono_clock::now()](int r) {
+      handle_object_copy(ono, r, ceph::mono_clock::now() - start);
+    });
+
   uint32_t flags = 0;
   if (m_flatten) {
     flags |= OBJECT_COPY_REQUEST_FLAG_FLATTEN;
@@ -231,10 +238,43 @@ void ImageCopyRequest<I>::send_next_object_copy() {
     m_src_image_ctx, m_dst_image_ctx, m_src_snap_id_start, m_dst_snap_id_start,
     m_snap_map, ono, flags, m_handler, ctx);
   req->send();
+  return true;
 }
 
 template <typename I>
-void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
+void ImageCopyRequest<I>::update_max_ops(ceph::timespan latency) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+
+  if (m_ops_limit <= m_min_ops) {
+    return;
+  }
+
+  // add an op per window of copies while they stay close to the fastest
+  // seen, and halve the window once they take twice as long. the base
+  // latency is raised on each back off since objects differ in size
+  ++m_ops_since_resize;
+  if (m_base_latency == ceph::timespan::zero() || latency < m_base_latency) {
+    m_base_latency = latency;
+  } else if (latency > 2 * m_base_latency) {
+    if (m_ops_since_resize >= m_max_ops && m_max_ops > m_min_ops) {
+      m_max_ops = std::max(m_min_ops, m_max_ops / 2);
+      m_ops_since_resize = 0;
+      m_base_latency += (latency - m_base_latency) / 8;
+      ldout(m_cct, 10) << "max_ops=" << m_max_ops << dendl;
+    }
+    return;
+  }
+
+  if (m_ops_since_resize >= m_max_ops && m_max_ops < m_ops_limit) {
+    ++m_max_ops;
+    m_ops_since_resize = 0;
+    ldout(m_cct, 15) << "max_ops=" << m_max_ops << dendl;
+  }
+}
+
+template <typename I>
+void ImageCopyRequest<I>::handle_object_copy(
+    uint64_t object_no, int r, std::optional<ceph::timespan> latency) {
   ldout(m_cct, 20) << "object_no=" << object_no << ", r=" << r << dendl;
 
   bool complete;
@@ -243,6 +283,10 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
     ceph_assert(m_current_ops > 0);
     --m_current_ops;
 
+    if (latency && r >= 0) {
+      update_max_ops(*latency);
+    }
+
     if (r < 0 && r != -ENOENT) {
       lderr(m_cct) << "object copy failed: " << cpp_strerror(r) << dendl;
       if (m_ret_val == 0) {
@@ -265,7 +309,7 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
       }
     }
 
-    send_next_object_copy();
+    while (m_current_ops < m_max_ops && send_next_object_copy());
     complete = (m_current_ops == 0) && !m_updating_progress;
   }
 
@@ -8,11 +8,13 @@
 #include "include/rados/librados.hpp"
 #include "common/bit_vector.hpp"
 #include "common/ceph_mutex.h"
+#include "common/ceph_time.h"
 #include "common/RefCountedObj.h"
 #include "librbd/Types.h"
 #include "librbd/deep_copy/Types.h"
 #include <functional>
 #include <map>
+#include <optional>
 #include <queue>
 #include <set>
 #include <vector>
@@ -95,6 +97,14 @@ private:
   uint64_t m_object_no = 0;
   uint64_t m_end_object_no = 0;
   uint64_t m_current_ops = 0;
+
+  // object copies in flight, adapted to their latency between
+  // rbd_concurrent_management_ops and rbd_deep_copy_max_concurrent_ops
+  uint64_t m_max_ops = 0;
+  uint64_t m_min_ops = 0;
+  uint64_t m_ops_limit = 0;
+  uint64_t m_ops_since_resize = 0;
+  ceph::timespan m_base_latency = ceph::timespan::zero();
   std::priority_queue<
     uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> m_copied_objects;
   bool m_updating_progress = false;
@@ -109,8 +119,10 @@ private:
   void handle_compute_diff(int r);
 
   void send_object_copies();
-  void send_next_object_copy();
-  void handle_object_copy(uint64_t object_no, int r);
+  bool send_next_object_copy();
+  void handle_object_copy(uint64_t object_no, int r,
+                          std::optional<ceph::timespan> latency);
+  void update_max_ops(ceph::timespan latency);
 
   void finish(int r);
 };
@@ -1664,11 +1664,19 @@ int validate_pool(IoCtx &io_ctx, CephContext *cct) {
     CephContext *cct = ictx->cct;
     ldout(cct, 20) << __func__ << " " << ictx << " numcomp = " << numcomp
                    << dendl;
+    // completions pushed from here on notify the event socket again
+    ictx->event_socket_notified.store(false);
     int i = 0;
     while (i < numcomp && ictx->event_socket_completions.pop(comps[i])) {
       ++i;
     }
 
+    // the caller may not poll again until it is notified
+    if (ictx->coalesce_event_notify && i == numcomp &&
+        !ictx->event_socket_completions.empty() &&
+        !ictx->event_socket_notified.exchange(true)) {
+      ictx->event_socket.notify();
+    }
     return i;
   }
 
@@ -261,7 +261,10 @@ void AioCompletion::mark_complete_and_notify() {
 
   if (ictx != nullptr && event_notify && ictx->event_socket.is_valid()) {
     ictx->event_socket_completions.push(this);
-    ictx->event_socket.notify();
+    if (!ictx->coalesce_event_notify ||
+        !ictx->event_socket_notified.exchange(true)) {
+      ictx->event_socket.notify();
+    }
   }
 
   completed.notify_all();
@@ -22,6 +22,30 @@ namespace object_map {
 
 using util::create_rados_callback;
 
+namespace {
+
+// objects (2-bit entries) per byte of an object map or object diff state
+constexpr uint64_t OBJECTS_PER_BYTE = 4;
+
+// whether applying a byte of object map states leaves a byte of object
+// diff states as is, for the overlap of the two. objects that are clean
+// in a snapshot weren't written since the previous one, which leaves
+// DATA and DATA_UPDATED alone, and HOLE and HOLE_UPDATED stay with
+// objects that don't exist
+bool is_byte_unchanged(uint8_t object_map_byte, uint8_t diff_state_byte) {
+  static_assert(OBJECT_EXISTS_CLEAN == 3 && OBJECT_NONEXISTENT == 0);
+  static_assert(DIFF_STATE_DATA == 1 && DIFF_STATE_DATA_UPDATED == 3);
+  static_assert(DIFF_STATE_HOLE == 0 && DIFF_STATE_HOLE_UPDATED == 2);
+  if (object_map_byte == 0xff) {
+    return (diff_state_byte & 0x55) == 0x55;
+  } else if (object_map_byte == 0x00) {
+    return (diff_state_byte & 0x55) == 0x00;
+  }
+  return false;
+}
+
+} // anonymous namespace
+
 template <typename I>
 DiffRequest<I>::DiffRequest(I* image_ctx,
                             uint64_t snap_id_start, uint64_t snap_id_end,
@@ -118,10 +142,45 @@ int DiffRequest<I>::process_object_map(const BitVector<2>& object_map) {
 
   uint64_t overlap = std::min(m_object_diff_state->size(),
                               prev_object_diff_state_size);
+  uint64_t overlap_end = start_object_no + overlap;
+
+  // most objects don't change between snapshots: compare whole bytes of
+  // both bit vectors to skip runs of them, when they are equally aligned
+  bufferlist object_map_bl;
+  bufferlist diff_state_bl;
+  const char* object_map_data = nullptr;
+  const char* diff_state_data = nullptr;
+  if (start_object_no % OBJECTS_PER_BYTE == 0 &&
+      std::min(overlap_end, num_objs) >= start_object_no + OBJECTS_PER_BYTE) {
+    object_map_bl = object_map.get_data();
+    diff_state_bl = m_object_diff_state->get_data();
+    object_map_data = object_map_bl.c_str();
+    diff_state_data = diff_state_bl.c_str();
+  }
+
   auto it = object_map.begin() + start_object_no;
   auto diff_it = m_object_diff_state->begin();
   uint64_t ono = start_object_no;
-  for (; ono < start_object_no + overlap; ++diff_it, ++ono) {
+  for (; ono < overlap_end; ++diff_it, ++ono) {
+    if (object_map_data != nullptr && ono % OBJECTS_PER_BYTE == 0) {
+      uint64_t run_end = ono;
+      while (run_end + OBJECTS_PER_BYTE <= std::min(overlap_end, num_objs) &&
+             is_byte_unchanged(
+               object_map_data[run_end / OBJECTS_PER_BYTE],
+               diff_state_data[(run_end - start_object_no) /
+                               OBJECTS_PER_BYTE])) {
+        run_end += OBJECTS_PER_BYTE;
+      }
+      if (run_end > ono) {
+        it += run_end - ono;
+        diff_it += run_end - ono;
+        ono = run_end;
+        if (ono == overlap_end) {
+          break;
+        }
+      }
+    }
+
     uint8_t object_map_state = (ono < num_objs ? *it++ : OBJECT_NONEXISTENT);
     uint8_t prev_object_diff_state = *diff_it;
     switch (prev_object_diff_state) {
@@ -263,8 +263,13 @@ void Log::submit_entry(Entry&& e)
     m_cond_loggers.wait(lock);
   }
 
+  // the flusher only sleeps on an empty queue, so it has already been
+  // woken for anything queued before this entry
+  const bool was_empty = m_new.empty();
   m_new.emplace_back(std::move(e));
-  m_cond_flusher.notify_all();
+  if (was_empty) {
+    m_cond_flusher.notify_all();
+  }
   m_queue_mutex_holder = 0;
 }
 
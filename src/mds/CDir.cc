@@ -1775,12 +1775,9 @@ class C_IO_Dir_OMAP_FetchedMore : public CDirIOContext {
 public:
   const version_t omap_version;
   bufferlist hdrbl;
-  bool more = false;
-  map<string, bufferlist> omap;      ///< carry-over from before
-  map<string, bufferlist> omap_more; ///< new batch
-  int ret;
+  map<string, bufferlist> omap;      ///< all the rounds
   C_IO_Dir_OMAP_FetchedMore(CDir *d, version_t v, MDSContext *f) :
-    CDirIOContext(d), fin(f), omap_version(v), ret(0) { }
+    CDirIOContext(d), fin(f), omap_version(v) { }
   void finish(int r) {
     if (omap_version < dir->get_committed_version()) {
       omap.clear();
@@ -1788,25 +1785,59 @@ public:
       return;
     }
 
-    // merge results
-    if (omap.empty()) {
-      omap.swap(omap_more);
-    } else {
-      omap.insert(omap_more.begin(), omap_more.end());
-    }
-    if (more) {
-      dir->_omap_fetch_more(omap_version, hdrbl, omap, fin);
-    } else {
-      dir->_omap_fetched(hdrbl, omap, true, {}, r);
-      if (fin)
-	fin->complete(r);
-    }
+    dir->_omap_fetched(hdrbl, omap, true, {}, r);
+    if (fin)
+      fin->complete(r);
   }
   void print(ostream& out) const override {
     out << "dirfrag_fetch_more(" << dir->dirfrag() << ")";
   }
 };
 
+/*
+ * One round of reading the remaining omap keys of a big dirfrag. The rounds
+ * only depend on the last key of the previous one, so they follow each other
+ * from the finisher without mds_lock; only the last round takes it, to load
+ * the dentries.
+ */
+class C_Dir_OMAP_FetchRound : public Context {
+  C_IO_Dir_OMAP_FetchedMore *fetched;
+  Objecter *objecter;
+  Finisher *finisher;
+  object_t oid;
+  object_locator_t oloc;
+public:
+  bool more = false;
+  map<string, bufferlist> omap_more; ///< new batch
+  int ret = 0;
+  C_Dir_OMAP_FetchRound(C_IO_Dir_OMAP_FetchedMore *f, Objecter *o, Finisher *fin,
+			const object_t& oid, const object_locator_t& oloc) :
+    fetched(f), objecter(o), finisher(fin), oid(oid), oloc(oloc) { }
+
+  void send() {
+    ObjectOperation rd;
+    rd.omap_get_vals(fetched->omap.rbegin()->first,
+		     "", /* filter prefix */
+		     g_conf()->mds_dir_keys_per_op,
+		     &omap_more,
+		     &more,
+		     &ret);
+    objecter->read(oid, oloc, rd, CEPH_NOSNAP, NULL, 0,
+		   new C_OnFinisher(this, finisher));
+  }
+  void finish(int r) override {
+    // merge results; the keys of the batch all sort after the ones we have
+    auto& omap = fetched->omap;
+    for (auto& [key, bl] : omap_more)
+      omap.emplace_hint(omap.end(), key, std::move(bl));
+    if (r >= 0 && more && !omap_more.empty()) {
+      (new C_Dir_OMAP_FetchRound(fetched, objecter, finisher, oid, oloc))->send();
+    } else {
+      fetched->complete(r);
+    }
+  }
+};
+
 class C_IO_Dir_OMAP_Fetched : public CDirIOContext {
   MDSContext *fin;
 public:
@@ -1885,15 +1916,8 @@ void CDir::_omap_fetch_more(version_t omap_version, bufferlist& hdrbl,
   auto fin = new C_IO_Dir_OMAP_FetchedMore(this, omap_version, c);
   fin->hdrbl = std::move(hdrbl);
   fin->omap.swap(omap);
-  ObjectOperation rd;
-  rd.omap_get_vals(fin->omap.rbegin()->first,
-		   "", /* filter prefix */
-		   g_conf()->mds_dir_keys_per_op,
-		   &fin->omap_more,
-		   &fin->more,
-		   &fin->ret);
-  mdcache->mds->objecter->read(oid, oloc, rd, CEPH_NOSNAP, NULL, 0,
-			     new C_OnFinisher(fin, mdcache->mds->finisher));
+  (new C_Dir_OMAP_FetchRound(fin, mdcache->mds->objecter, mdcache->mds->finisher,
+			     oid, oloc))->send();
 }
 
 CDentry *CDir::_load_dentry(
@@ -2694,9 +2718,15 @@ void CDir::_omap_commit_ops(int r, int op_prio, int64_t metapool, version_t vers
       op.omap_set(_set);
     if (!_rm.empty())
       op.omap_rm_keys(_rm);
+    // wait for room in the in-flight budget of all dirfrag commits
+    mdcache->dir_commit_throttle.get(1);
+    auto fin = new LambdaContext([mdc=mdcache, sub=gather.new_sub()](int r) {
+      mdc->dir_commit_throttle.put(1);
+      sub->complete(r);
+    });
     mdcache->mds->objecter->mutate(oid, oloc, op, snapc,
                                    ceph::real_clock::now(),
-                                   0, gather.new_sub());
+                                   0, fin);
     write_size = 0;
     _set.clear();
     _rm.clear();
@@ -2874,7 +2904,7 @@ void CDir::_omap_commit(int op_prio)
   auto c = new C_IO_Dir_Commit_Ops(this, op_prio, std::move(to_set), std::move(dfts),
                                    std::move(to_remove), std::move(stale_items));
   stale_items.clear(); /* in CDir */
-  mdcache->mds->finisher->queue(c);
+  mdcache->mds->get_dir_commit_finisher(dirfrag())->queue(c);
 }
 
 void CDir::_parse_dentry(CDentry *dn, dentry_commit_item &item,
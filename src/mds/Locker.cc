@@ -2584,6 +2584,14 @@ int Locker::issue_caps(CInode *in, Capability *only_cap)
 
   ceph_assert(in->is_head());
 
+  // the realm is the same for every client, find it once for all messages
+  inodeno_t realm_ino;
+  auto get_realm_ino = [in, &realm_ino] {
+    if (!realm_ino)
+      realm_ino = in->find_snaprealm()->inode->ino();
+    return realm_ino;
+  };
+
   // client caps
   map<client_t, Capability>::iterator it;
   if (only_cap)
@@ -2630,7 +2638,7 @@ int Locker::issue_caps(CInode *in, Capability *only_cap)
         if (mds->logger) mds->logger->inc(l_mdss_ceph_cap_op_grant);
 
 	auto m = make_message<MClientCaps>(CEPH_CAP_OP_GRANT, in->ino(),
-					   in->find_snaprealm()->inode->ino(),
+					   get_realm_ino(),
 					   cap->get_cap_id(), cap->get_last_seq(),
 					   pending, wanted, 0, cap->get_mseq(),
                                            cap->get_last_issue(),
@@ -2681,7 +2689,7 @@ int Locker::issue_caps(CInode *in, Capability *only_cap)
       }
 
       auto m = make_message<MClientCaps>(op, in->ino(),
-					 in->find_snaprealm()->inode->ino(),
+					 get_realm_ino(),
 					 cap->get_cap_id(), cap->get_last_seq(),
 					 after, wanted, 0, cap->get_mseq(),
                                          cap->get_last_issue(),
@@ -2702,12 +2710,13 @@ void Locker::issue_truncate(CInode *in)
 {
   dout(7) << "issue_truncate on " << *in << dendl;
   
+  const inodeno_t realm_ino = in->find_snaprealm()->inode->ino();
   for (auto &p : in->client_caps) {
     if (mds->logger) mds->logger->inc(l_mdss_ceph_cap_op_trunc);
     Capability *cap = &p.second;
     auto m = make_message<MClientCaps>(CEPH_CAP_OP_TRUNC,
                                        in->ino(),
-                                       in->find_snaprealm()->inode->ino(),
+                                       realm_ino,
                                        cap->get_cap_id(), cap->get_last_seq(),
                                        cap->pending(), cap->wanted(), 0,
                                        cap->get_mseq(),
@@ -3185,6 +3194,7 @@ void Locker::share_inode_max_size(CInode *in, Capability *only_cap)
     it = in->client_caps.find(only_cap->get_client());
   else
     it = in->client_caps.begin();
+  inodeno_t realm_ino;
   for (; it != in->client_caps.end(); ++it) {
     const client_t client = it->first;
     Capability *cap = &it->second;
@@ -3194,9 +3204,11 @@ void Locker::share_inode_max_size(CInode *in, Capability *only_cap)
       dout(10) << "share_inode_max_size with client." << client << dendl;
       if (mds->logger) mds->logger->inc(l_mdss_ceph_cap_op_grant);
       cap->inc_last_seq();
+      if (!realm_ino)
+        realm_ino = in->find_snaprealm()->inode->ino();
       auto m = make_message<MClientCaps>(CEPH_CAP_OP_GRANT,
                                          in->ino(),
-                                         in->find_snaprealm()->inode->ino(),
+                                         realm_ino,
                                          cap->get_cap_id(),
                                          cap->get_last_seq(),
                                          cap->pending(),
@@ -89,6 +89,7 @@ MDBalancer::MDBalancer(MDSRank *m, Messenger *msgr, MonClient *monc) :
   bal_export_pin = g_conf().get_val<bool>("mds_bal_export_pin");
   bal_fragment_dirs = g_conf().get_val<bool>("mds_bal_fragment_dirs");
   bal_fragment_fast_factor = g_conf().get_val<double>("mds_bal_fragment_fast_factor");
+  bal_migration_cooldown = g_conf().get_val<double>("mds_bal_migration_cooldown");
   bal_fragment_interval = g_conf().get_val<int64_t>("mds_bal_fragment_interval");
   bal_interval = g_conf().get_val<int64_t>("mds_bal_interval");
   bal_max_until = g_conf().get_val<int64_t>("mds_bal_max_until");
@@ -114,6 +115,8 @@ void MDBalancer::handle_conf_change(const std::set<std::string>& changed, const
     bal_fragment_fast_factor = g_conf().get_val<double>("mds_bal_fragment_fast_factor");
   if (changed.count("mds_bal_fragment_interval"))
     bal_fragment_interval = g_conf().get_val<int64_t>("mds_bal_fragment_interval");
+  if (changed.count("mds_bal_migration_cooldown"))
+    bal_migration_cooldown = g_conf().get_val<double>("mds_bal_migration_cooldown");
   if (changed.count("mds_bal_interval"))
     bal_interval = g_conf().get_val<int64_t>("mds_bal_interval");
   if (changed.count("mds_bal_max_until"))
@@ -989,6 +992,15 @@ void MDBalancer::try_rebalance(balance_state_t& state)
     return;
   }
 
+  // forget the migrations that are out of their cooldown
+  const auto now = clock::now();
+  for (auto p = last_migrated.begin(); p != last_migrated.end(); ) {
+    if (chrono::duration<double>(now - p->second).count() >= bal_migration_cooldown)
+      p = last_migrated.erase(p);
+    else
+      ++p;
+  }
+
   // make a sorted list of my imports
   multimap<double, CDir*> import_pop_map;
   multimap<mds_rank_t, pair<CDir*, double> > import_from_map;
@@ -1008,10 +1020,11 @@ void MDBalancer::try_rebalance(balance_state_t& state)
     if (bal_idle_threshold > 0 &&
 	pop < bal_idle_threshold &&
 	diri != mds->mdcache->get_root() &&
-	from != mds->get_nodeid()) {
+	from != mds->get_nodeid() &&
+	!in_cooldown(dir, now)) {
       dout(5) << " exporting idle (" << pop << ") import " << *dir
 	      << " back to mds." << from << dendl;
-      mds->mdcache->migrator->export_dir_nicely(dir, from);
+      export_dir(dir, from, pop, "idle");
       continue;
     }
 
@@ -1057,10 +1070,12 @@ void MDBalancer::try_rebalance(balance_state_t& state)
 	  continue;
 	ceph_assert(dir->inode->authority().first == target);  // cuz that's how i put it in the map, dummy
 
-	if (pop <= amount-have) {
+	if (in_cooldown(dir, now)) {
+	  dout(7) << "not reexporting " << *dir << ", imported too recently" << dendl;
+	} else if (pop <= amount-have) {
 	  dout(7) << "reexporting " << *dir << " pop " << pop
 		  << " back to mds." << target << dendl;
-	  mds->mdcache->migrator->export_dir_nicely(dir, target);
+	  export_dir(dir, target, pop, "reexport back");
 	  have += pop;
 	  import_from_map.erase(plast);
 	  for (auto q = import_pop_map.equal_range(pop);
@@ -1100,11 +1115,11 @@ void MDBalancer::try_rebalance(balance_state_t& state)
       }
 
       double pop = p->first;
-      if (pop <= amount-have && pop > MIN_REEXPORT) {
+      if (pop <= amount-have && pop > MIN_REEXPORT && !in_cooldown(dir, now)) {
 	dout(5) << "reexporting " << *dir << " pop " << pop
 		<< " to mds." << target << dendl;
 	have += pop;
-	mds->mdcache->migrator->export_dir_nicely(dir, target);
+	export_dir(dir, target, pop, "reexport");
 	import_pop_map.erase(p++);
       } else {
 	++p;
@@ -1143,7 +1158,7 @@ void MDBalancer::try_rebalance(balance_state_t& state)
       dout(5) << "   - exporting " << dir->pop_auth_subtree
 	      << " " << dir->pop_auth_subtree.meta_load()
 	      << " to mds." << target << " " << *dir << dendl;
-      mds->mdcache->migrator->export_dir_nicely(dir, target);
+      export_dir(dir, target, dir->pop_auth_subtree.meta_load(), "export");
     }
   }
 
@@ -1151,6 +1166,24 @@ void MDBalancer::try_rebalance(balance_state_t& state)
   mds->mdcache->show_subtrees();
 }
 
+bool MDBalancer::in_cooldown(const CDir *dir, time now) const
+{
+  auto p = last_migrated.find(dir->dirfrag());
+  return p != last_migrated.end() &&
+    chrono::duration<double>(now - p->second).count() < bal_migration_cooldown;
+}
+
+void MDBalancer::export_dir(CDir *dir, mds_rank_t target, double pop,
+                            std::string_view reason)
+{
+  const auto now = clock::now();
+  last_migrated[dir->dirfrag()] = now;
+  decisions.push_back({now, dir->dirfrag(), target, pop, reason});
+  if (decisions.size() > MAX_DECISIONS)
+    decisions.pop_front();
+  mds->mdcache->migrator->export_dir_nicely(dir, target);
+}
+
 void MDBalancer::find_exports(CDir *dir,
                               double amount,
                               std::vector<CDir*>* exports,
@@ -1204,6 +1237,8 @@ void MDBalancer::find_exports(CDir *dir,
       if (subdir->is_frozen_dir() || subdir->is_frozen_tree_root() ||
 	  subdir->is_freezing_dir() || subdir->is_freezing_tree_root())
 	continue;  // can't export this right now!
+      if (in_cooldown(subdir, now))
+	continue;  // just moved here, let it settle
 
       // how popular?
       double pop = subdir->pop_auth_subtree.meta_load();
@@ -1432,6 +1467,8 @@ void MDBalancer::subtract_export(CDir *dir)
 
 void MDBalancer::add_import(CDir *dir)
 {
+  last_migrated[dir->dirfrag()] = clock::now();
+
   dirfrag_load_vec_t subload = dir->pop_auth_subtree;
 
   while (true) {
@@ -1482,6 +1519,34 @@ void MDBalancer::handle_mds_failure(mds_rank_t who)
   }
 }
 
+void MDBalancer::dump_decisions(Formatter *f) const
+{
+  const auto now = clock::now();
+  f->dump_float("migration_cooldown", bal_migration_cooldown);
+  f->open_array_section("decisions");
+  for (const auto& d : decisions) {
+    f->open_object_section("decision");
+    f->dump_float("age", chrono::duration<double>(now - d.stamp).count());
+    f->dump_stream("dirfrag") << d.dirfrag;
+    f->dump_int("target", d.target);
+    f->dump_float("pop", d.pop);
+    f->dump_string("reason", d.reason);
+    f->close_section();
+  }
+  f->close_section();
+  f->open_array_section("cooldowns");
+  for (const auto& [df, stamp] : last_migrated) {
+    const double age = chrono::duration<double>(now - stamp).count();
+    if (age >= bal_migration_cooldown)
+      continue;
+    f->open_object_section("cooldown");
+    f->dump_stream("dirfrag") << df;
+    f->dump_float("remaining", bal_migration_cooldown - age);
+    f->close_section();
+  }
+  f->close_section();
+}
+
 int MDBalancer::dump_loads(Formatter *f, int64_t depth) const
 {
   std::deque<pair<CDir*, int>> dfs;
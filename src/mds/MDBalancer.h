@@ -17,8 +17,10 @@
 
 #include <cstdint>
 #include <map>
+#include <deque>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "mdstypes.h" // for dirfrag_t, mds_load_t
@@ -82,6 +84,7 @@ public:
   void handle_mds_failure(mds_rank_t who);
 
   int dump_loads(Formatter *f, int64_t depth = -1) const;
+  void dump_decisions(Formatter *f) const;
 
   bool get_bal_export_pin() const {
     return bal_export_pin;
@@ -141,6 +144,10 @@ private:
   void try_rebalance(balance_state_t& state);
   bool test_rank_mask(mds_rank_t rank);
 
+  // whether a subtree was migrated less than bal_migration_cooldown ago
+  bool in_cooldown(const CDir *dir, time now) const;
+  void export_dir(CDir *dir, mds_rank_t target, double pop, std::string_view reason);
+
   bool bal_fragment_dirs;
   int64_t bal_fragment_interval;
   int64_t bal_interval;
@@ -153,6 +160,7 @@ private:
   double bal_replicate_threshold;
   double bal_unreplicate_threshold;
   double bal_fragment_fast_factor;
+  double bal_migration_cooldown;
   int64_t bal_split_bits;
   int64_t bal_split_size;
   int64_t bal_merge_size;
@@ -182,6 +190,20 @@ private:
   // dirfrags that already have one in flight.
   std::set<dirfrag_t> split_pending, merge_pending;
 
+  // when subtrees were last imported or exported
+  std::map<dirfrag_t, time> last_migrated;
+
+  // the most recent export decisions, for the admin socket
+  struct decision_t {
+    time stamp;
+    dirfrag_t dirfrag;
+    mds_rank_t target;
+    double pop;
+    std::string_view reason;
+  };
+  static const size_t MAX_DECISIONS = 100;
+  std::deque<decision_t> decisions;
+
   // per-epoch scatter/gathered info
   std::map<mds_rank_t, mds_load_t> mds_load;
   std::map<mds_rank_t, double> mds_meta_load;
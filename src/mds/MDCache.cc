@@ -288,10 +288,47 @@ void MDCache::handle_conf_change(const std::set<std::string>& changed, const MDS
     dout(20) << __func__ << " mds_use_global_snaprealm_seq_for_subvol now " << use_global_snaprealm_seq << dendl;
   }
 
+  if (changed.count("mds_dir_commit_ops_per_pg") ||
+      changed.count("mds_max_dir_commit_ops"))
+    update_dir_commit_limit(mdsmap);
+
   migrator->handle_conf_change(changed, mdsmap);
   mds->balancer->handle_conf_change(changed, mdsmap);
 }
 
+void MDCache::update_dir_commit_limit(const MDSMap& mds_map)
+{
+  uint64_t pg_count = 0;
+  mds->objecter->with_osdmap([&](const OSDMap& o) {
+    const int64_t metapool = mds_map.get_metadata_pool();
+    if (o.get_pg_pool(metapool) == NULL) {
+      // we may have an older OSDMap than MDSMap
+      dout(4) << " metadata pool " << metapool << " not found in OSDMap" << dendl;
+      return;
+    }
+    pg_count = o.get_pg_num(metapool);
+  });
+  if (!pg_count) {
+    return;
+  }
+
+  // n_pgs / n_mdss, multiplied by the user's preference for how many ops
+  // per PG, but always allow one write per dirfrag commit thread
+  uint64_t max_ops = uint64_t(((double)pg_count / (double)mds_map.get_max_mds()) *
+                              g_conf().get_val<double>("mds_dir_commit_ops_per_pg"));
+  const auto hard_limit = g_conf().get_val<uint64_t>("mds_max_dir_commit_ops");
+  if (hard_limit) {
+    max_ops = std::min(max_ops, hard_limit);
+  }
+  max_ops = std::max<uint64_t>(max_ops, g_conf().get_val<uint64_t>("mds_dir_commit_threads"));
+
+  if ((int64_t)max_ops != dir_commit_throttle.get_max()) {
+    dout(10) << __func__ << " " << max_ops << " dirfrag commit ops over "
+             << pg_count << " metadata pool PGs" << dendl;
+    dir_commit_throttle.reset_max(max_ops);
+  }
+}
+
 void MDCache::log_stat()
 {
   mds->logger->set(l_mds_inodes, lru.lru_get_size());
@@ -13211,6 +13248,13 @@ void MDCache::cache_status(Formatter *f)
   mempool::get_pool(mempool::mds_co::id).dump(f);
   f->close_section();
 
+  // what the cache costs per inode, with its dentries, caps and locks
+  const uint64_t num_inodes = inode_map.size() + snap_inode_map.size();
+  f->dump_unsigned("inodes", num_inodes);
+  f->dump_unsigned("dentries", lru.lru_get_size() + bottom_lru.lru_get_size());
+  f->dump_unsigned("caps", Capability::count());
+  f->dump_unsigned("bytes_per_inode", num_inodes ? cache_size() / num_inodes : 0);
+
   f->close_section();
 }
 
@@ -23,6 +23,7 @@
 
 #include "common/DecayCounter.h"
 #include "common/MemoryModel.h"
+#include "common/Throttle.h"
 #include "include/common_fwd.h"
 #include "include/types.h"
 #include "include/filepath.h"
@@ -785,6 +786,8 @@ private:
   void _queued_file_recover_cow(CInode *in, MutationRef& mut);
 
   void handle_conf_change(const std::set<std::string>& changed, const MDSMap& mds_map);
+  // size the dirfrag commit writes in flight to the metadata pool's PGs
+  void update_dir_commit_limit(const MDSMap& mds_map);
   
   // debug
   void log_stat();
@@ -1158,6 +1161,8 @@ private:
   int num_inodes_with_caps = 0;
 
   unsigned max_dir_commit_size;
+  // dirfrag commit writes in flight, see update_dir_commit_limit()
+  Throttle dir_commit_throttle{g_ceph_context, "mds_dir_commit_ops"};
 
   file_layout_t default_file_layout;
   file_layout_t default_log_layout;
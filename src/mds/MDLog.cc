@@ -55,6 +55,7 @@ MDLog::MDLog(MDSRank* m)
   event_large_threshold = g_conf().get_val<uint64_t>("mds_log_event_large_threshold");
   events_per_segment = g_conf().get_val<uint64_t>("mds_log_events_per_segment");
   pause = g_conf().get_val<bool>("mds_log_pause");
+  submit_batch_max = g_conf().get_val<uint64_t>("mds_log_submit_batch_max");
   max_segments = g_conf().get_val<uint64_t>("mds_log_max_segments");
   max_events = g_conf().get_val<int64_t>("mds_log_max_events");
   skip_corrupt_events = g_conf().get_val<bool>("mds_log_skip_corrupt_events");
@@ -95,6 +96,27 @@ void MDLog::create_logger()
   plb.add_u64_counter(l_mdl_replayed, "replayed", "Events replayed",
 		      "repl", PerfCountersBuilder::PRIO_INTERESTING);
   plb.add_time_avg(l_mdl_jlat, "jlat", "Journaler flush latency");
+  plb.add_u64_avg(l_mdl_batch, "batch", "Events journaled per submit batch");
+  {
+    PerfHistogramCommon::axis_config_d lat_axis{
+      "Latency (usec)",
+      PerfHistogramCommon::SCALE_LOG2,
+      0,
+      100000, // 100usec
+      32,
+    };
+    PerfHistogramCommon::axis_config_d bytes_axis{
+      "Batch size (bytes)",
+      PerfHistogramCommon::SCALE_LOG2,
+      0,
+      512,
+      32,
+    };
+    plb.add_u64_counter_histogram(l_mdl_batch_lat_bytes_hist,
+                                  "batch_latency_bytes_histogram",
+                                  lat_axis, bytes_axis,
+                                  "Histogram of submit batch latency until safe + batch size");
+  }
   plb.add_u64_counter(l_mdl_evex, "evex", "Total expired events");
   plb.add_u64_counter(l_mdl_evtrm, "evtrm", "Trimmed events");
   plb.add_u64_counter(l_mdl_segadd, "segadd", "Segments added");
@@ -512,72 +534,110 @@ void MDLog::_submit_thread()
     }
 
     int64_t features = mdsmap_up_features;
-    PendingEvent data = it->second.front();
-    it->second.pop_front();
+    // take the events that are ready in one go, so that they are journaled
+    // back to back and flushed once for the whole batch
+    std::list<PendingEvent> batch;
+    {
+      auto last = it->second.begin();
+      for (uint64_t n = 0; last != it->second.end() && n < submit_batch_max; ++n) {
+        ++last;
+      }
+      batch.splice(batch.end(), it->second, it->second.begin(), last);
+    }
 
     locker.unlock();
 
-    if (data.le) {
-      LogEvent *le = data.le;
-      auto&& ls = le->_segment;
-      // encode it, with event type
-      bufferlist bl;
-      le->encode_with_header(bl, features);
-
-      uint64_t write_pos = journaler->get_write_pos();
+    const auto batch_start = ceph::mono_clock::now();
+    uint64_t batch_events = 0;
+    uint64_t batch_bytes = 0;
+    bool do_flush = false;
+    bool flushed = false;
+    uint64_t unflushed_events = 0;
+    for (auto& data : batch) {
+      if (data.le) {
+        LogEvent *le = data.le;
+        auto&& ls = le->_segment;
+        // encode it, with event type
+        bufferlist bl;
+        le->encode_with_header(bl, features);
+
+        uint64_t write_pos = journaler->get_write_pos();
+
+        le->set_start_off(write_pos);
+        if (dynamic_cast<SegmentBoundary*>(le)) {
+	  ls->offset = write_pos;
+        }
 
-      le->set_start_off(write_pos);
-      if (dynamic_cast<SegmentBoundary*>(le)) {
-	ls->offset = write_pos;
-      }
+        if (bl.length() >= event_large_threshold.load()) {
+          dout(5) << "large event detected!" << dendl;
+          logger->inc(l_mdl_evlrg);
+        }
 
-      if (bl.length() >= event_large_threshold.load()) {
-        dout(5) << "large event detected!" << dendl;
-        logger->inc(l_mdl_evlrg);
-      }
+        dout(5) << "_submit_thread " << write_pos << "~" << bl.length()
+	        << " : " << *le << dendl;
 
-      dout(5) << "_submit_thread " << write_pos << "~" << bl.length()
-	      << " : " << *le << dendl;
+        ++batch_events;
+        batch_bytes += bl.length();
 
-      // journal it.
-      const uint64_t new_write_pos = journaler->append_entry(bl);  // bl is destroyed.
-      ls->end = new_write_pos;
+        // journal it.
+        const uint64_t new_write_pos = journaler->append_entry(bl);  // bl is destroyed.
+        ls->end = new_write_pos;
 
-      MDSLogContextBase *fin;
-      if (data.fin) {
-	fin = dynamic_cast<MDSLogContextBase*>(data.fin);
-	ceph_assert(fin);
-	fin->set_write_pos(new_write_pos);
-      } else {
-	fin = new C_MDL_Flushed(this, new_write_pos);
-      }
+        MDSLogContextBase *fin;
+        if (data.fin) {
+	  fin = dynamic_cast<MDSLogContextBase*>(data.fin);
+	  ceph_assert(fin);
+	  fin->set_write_pos(new_write_pos);
+        } else {
+	  fin = new C_MDL_Flushed(this, new_write_pos);
+        }
 
-      journaler->wait_for_flush(fin);
+        journaler->wait_for_flush(fin);
 
-      if (data.flush)
-	journaler->flush();
+        if (logger)
+	  logger->set(l_mdl_wrpos, ls->end);
 
-      if (logger)
-	logger->set(l_mdl_wrpos, ls->end);
+        delete le;
+      } else {
+        if (data.fin) {
+	  Context* fin = dynamic_cast<Context*>(data.fin);
+	  ceph_assert(fin);
+	  C_MDL_Flushed *fin2 = new C_MDL_Flushed(this, fin);
+	  fin2->set_write_pos(journaler->get_write_pos());
+	  journaler->wait_for_flush(fin2);
+        }
+      }
 
-      delete le;
-    } else {
-      if (data.fin) {
-	Context* fin = dynamic_cast<Context*>(data.fin);
-	ceph_assert(fin);
-	C_MDL_Flushed *fin2 = new C_MDL_Flushed(this, fin);
-	fin2->set_write_pos(journaler->get_write_pos());
-	journaler->wait_for_flush(fin2);
+      if (data.flush) {
+        // flushing after the last event of the batch covers this one too
+        do_flush = true;
+        flushed = true;
+        unflushed_events = 0;
+      } else if (data.le) {
+        unflushed_events++;
       }
-      if (data.flush)
-	journaler->flush();
     }
 
+    if (batch_events > 0 && logger) {
+      logger->inc(l_mdl_batch, batch_events);
+      // the time until the whole batch is safe, for the batch's size
+      journaler->wait_for_flush(new LambdaContext(
+        [this, batch_start, batch_bytes] (int r) {
+          if (r == 0 && logger) {
+            const auto lat = ceph::mono_clock::now() - batch_start;
+            logger->hinc(l_mdl_batch_lat_bytes_hist,
+                         std::chrono::nanoseconds(lat).count(), batch_bytes);
+          }
+        }));
+    }
+    if (do_flush)
+      journaler->flush();
+
     locker.lock();
-    if (data.flush)
-      unflushed = 0;
-    else if (data.le)
-      unflushed++;
+    if (flushed)
+      unflushed = unflushed_events;
+    else
+      unflushed += unflushed_events;
   }
 }
 
@@ -1419,6 +1479,21 @@ void MDLog::_replay_thread()
   dout(10) << __func__ << ": start time: " << replay_start_time << ", now: "
            << ceph::coarse_mono_clock::now() << dendl;
 
+  // events that were read and decoded, waiting to be replayed under mds_lock
+  std::vector<std::unique_ptr<LogEvent>> pending;
+  auto replay_pending = [this, &pending] {
+    std::lock_guard l(mds->mds_lock);
+    if (mds->is_daemon_stopping()) {
+      return false;
+    }
+    for (auto& le : pending) {
+      logger->inc(l_mdl_replayed);
+      le->replay(mds);
+    }
+    pending.clear();
+    return true;
+  };
+
   // loop
   int r = 0;
   while (1) {
@@ -1427,6 +1502,14 @@ void MDLog::_replay_thread()
       dout(10) << __func__ << ": sleeping for " << sleep_time << "ms" << dendl;
       std::this_thread::sleep_for(sleep_time);
     }
+    // replay what we have before waiting, or failing, to read further
+    if (!pending.empty() &&
+        (pending.size() >= g_conf().get_val<uint64_t>("mds_log_replay_batch_max") ||
+         !journaler->is_readable())) {
+      if (!replay_pending()) {
+        return;
+      }
+    }
     // wait for read?
     journaler->check_isreadable(); 
     if (journaler->get_error()) {
@@ -1531,6 +1614,10 @@ void MDLog::_replay_thread()
     le->set_start_off(pos);
 
     if (auto sb = dynamic_cast<SegmentBoundary*>(le.get()); sb) {
+      // the events of a batch all belong to the current segment
+      if (!pending.empty() && !replay_pending()) {
+        return;
+      }
       auto seq = sb->get_seq();
       if (seq > 0) {
         event_seq = seq;
@@ -1574,20 +1661,17 @@ void MDLog::_replay_thread()
     num_events++;
     logger->set(l_mdl_ev, num_events);
 
-    {
-      std::lock_guard l(mds->mds_lock);
-      if (mds->is_daemon_stopping()) {
-        return;
-      }
-      logger->inc(l_mdl_replayed);
-      le->replay(mds);
-    }
+    pending.push_back(std::move(le));
 
     logger->set(l_mdl_rdpos, pos);
     logger->set(l_mdl_expos, journaler->get_expire_pos());
     logger->set(l_mdl_wrpos, journaler->get_write_pos());
   }
 
+  if (!pending.empty() && !replay_pending()) {
+    return;
+  }
+
   // done!
   if (r == 0) {
     ceph_assert(journaler->get_read_pos() == journaler->get_write_pos());
@@ -1681,6 +1765,9 @@ void MDLog::handle_conf_change(const std::set<std::string>& changed, const MDSMa
   if (changed.count("mds_log_max_segments")) {
     max_segments = g_conf().get_val<uint64_t>("mds_log_max_segments");
   }
+  if (changed.count("mds_log_submit_batch_max")) {
+    submit_batch_max = g_conf().get_val<uint64_t>("mds_log_submit_batch_max");
+  }
   if (changed.count("mds_log_pause")) {
     pause = g_conf().get_val<bool>("mds_log_pause");
     if (!pause) {
@@ -39,6 +39,8 @@ enum {
   l_mdl_rdpos,
   l_mdl_jlat,
   l_mdl_replayed,
+  l_mdl_batch,
+  l_mdl_batch_lat_bytes_hist,
   l_mdl_last,
 };
 
@@ -316,6 +318,7 @@ private:
   bool debug_subtrees;
   std::atomic_uint64_t event_large_threshold; // accessed by submit thread
   uint64_t events_per_segment;
+  std::atomic_uint64_t submit_batch_max; // accessed by submit thread
   int64_t max_events;
   uint64_t max_segments;
   uint64_t minor_segments_per_major_segment;
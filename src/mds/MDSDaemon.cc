@@ -37,6 +37,7 @@
 #include "global/signal_handler.h"
 #include "log/Log.h"
 
+#include "messages/MClientRequest.h"
 #include "messages/MCommand.h"
 #include "messages/MCommandReply.h"
 #include "messages/MGenericMessage.h"
@@ -420,6 +421,10 @@ void MDSDaemon::set_up_admin_socket()
                                      asok_hook,
                                      "dump metadata loads");
   ceph_assert(r == 0);
+  r = admin_socket->register_command("dump balancer",
+                                     asok_hook,
+                                     "dump recent balancer export decisions and cooldowns");
+  ceph_assert(r == 0);
   r = admin_socket->register_command("dump snaps name=server,type=CephChoices,strings=--server,req=false",
                                      asok_hook,
                                      "dump snapshots");
@@ -1025,7 +1030,30 @@ void MDSDaemon::respawn()
 Dispatcher::dispatch_result_t MDSDaemon::ms_dispatch2(const ref_t<Message> &m)
 {
   dout(25) << __func__ << ": processing " << m << dendl;
+  const auto start = ceph::mono_clock::now();
   std::lock_guard l(mds_lock);
+  const auto locked = ceph::mono_clock::now();
+
+  const auto result = dispatch_locked(m);
+
+  // measure how much of the dispatch is serialized on mds_lock, and how
+  // much of that is spent on client requests that don't modify metadata
+  if (mds_rank && mds_rank->logger) {
+    const auto held = ceph::mono_clock::now() - locked;
+    mds_rank->logger->tinc(l_mds_lock_wait, locked - start);
+    mds_rank->logger->tinc(l_mds_lock_hold, held);
+    if (m->get_type() == CEPH_MSG_CLIENT_REQUEST) {
+      const auto op = ref_cast<MClientRequest>(m)->get_op();
+      if (!(op & CEPH_MDS_OP_WRITE)) {
+        mds_rank->logger->tinc(l_mds_lock_hold_read, held);
+      }
+    }
+  }
+  return result;
+}
+
+Dispatcher::dispatch_result_t MDSDaemon::dispatch_locked(const ref_t<Message> &m)
+{
   if (stopping) {
     return false;
   }
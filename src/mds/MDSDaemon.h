@@ -144,6 +144,7 @@ class MDSDaemon : public Dispatcher {
 
  private:
   Dispatcher::dispatch_result_t ms_dispatch2(const ref_t<Message> &m) override;
+  Dispatcher::dispatch_result_t dispatch_locked(const ref_t<Message> &m);
   bool ms_handle_fast_authentication(Connection *con) override;
   void ms_handle_accept(Connection *con) override;
   void ms_handle_connect(Connection *con) override;
@@ -508,6 +508,11 @@ MDSRank::MDSRank(
   objecter->unset_honor_pool_full();
 
   finisher = new Finisher(cct, "MDSRank", "mds-rank-fin");
+  const auto dir_commit_threads = g_conf().get_val<uint64_t>("mds_dir_commit_threads");
+  for (uint64_t i = 0; i < dir_commit_threads; ++i) {
+    dir_commit_finishers.push_back(
+      new Finisher(cct, "MDSRank-dir-commit-" + std::to_string(i), "mds-dir-commit"));
+  }
 
   mdcache = new MDCache(this, purge_queue);
   mdlog = new MDLog(this);
@@ -565,6 +570,11 @@ MDSRank::~MDSRank()
     mlogger = 0;
   }
 
+  for (auto f : dir_commit_finishers) {
+    delete f;
+  }
+  dir_commit_finishers.clear();
+
   delete finisher;
   finisher = NULL;
 
@@ -597,6 +607,9 @@ void MDSRankDispatcher::init()
   purge_queue.init();
 
   finisher->start();
+  for (auto f : dir_commit_finishers) {
+    f->start();
+  }
 }
 
 void MDSRank::update_targets()
@@ -825,6 +838,11 @@ void MDSRankDispatcher::shutdown()
   }
 
   mds_lock.unlock();
+  // dirfrag commits wait for their writes to be throttled, not for the
+  // finisher, so stop them first
+  for (auto f : dir_commit_finishers) {
+    f->stop();
+  }
   finisher->stop(); // no flushing
   mds_lock.lock();
 
@@ -3057,6 +3075,11 @@ void MDSRankDispatcher::handle_asok_command(
       dout(10) << "no depth limit when dirfrags dump_load" << dendl;
     }
     r = balancer->dump_loads(f, depth);
+  } else if (command == "dump balancer") {
+    std::lock_guard l(mds_lock);
+    f->open_object_section("balancer");
+    balancer->dump_decisions(f);
+    f->close_section();
   } else if (command == "dump snaps") {
     std::lock_guard l(mds_lock);
     string server;
@@ -3759,6 +3782,13 @@ void MDSRank::create_logger()
     mds_plb.add_u64(l_mds_load_cent, "load_cent", "Load per cent");
     mds_plb.add_u64_counter(l_mds_openino_dir_fetch, "openino_dir_fetch",
                             "OpenIno incomplete directory fetchings");
+    // serialization of message dispatch on mds_lock
+    mds_plb.add_time_avg(l_mds_lock_wait, "mds_lock_wait",
+                         "Time messages waited for mds_lock before dispatch");
+    mds_plb.add_time_avg(l_mds_lock_hold, "mds_lock_hold",
+                         "Time mds_lock was held to dispatch a message");
+    mds_plb.add_time_avg(l_mds_lock_hold_read, "mds_lock_hold_read",
+                         "Time mds_lock was held to dispatch a read-only client request");
 
     // low prio stats
     mds_plb.set_prio_default(PerfCountersBuilder::PRIO_DEBUGONLY);
@@ -3870,6 +3900,7 @@ void MDSRankDispatcher::handle_osd_map()
   server->handle_osd_map();
 
   purge_queue.update_op_limit(*mdsmap);
+  mdcache->update_dir_commit_limit(*mdsmap);
 
   // it's ok if replay state is reached via standby-replay, the
   // reconnect state will journal blocklisted clients (journal
@@ -4110,6 +4141,7 @@ std::vector<std::string> MDSRankDispatcher::get_tracked_keys()
     "mds_bal_max",
     "mds_bal_max_until",
     "mds_bal_merge_size",
+    "mds_bal_migration_cooldown",
     "mds_bal_mode",
     "mds_bal_replicate_threshold",
     "mds_bal_sample_interval",
@@ -4128,6 +4160,7 @@ std::vector<std::string> MDSRankDispatcher::get_tracked_keys()
     "mds_cap_acquisition_throttle_retry_request_time",
     "mds_cap_revoke_eviction_timeout",
     "mds_debug_subtrees",
+    "mds_dir_commit_ops_per_pg",
     "mds_dir_max_entries",
     "mds_dump_cache_threshold_file",
     "mds_dump_cache_threshold_formatter",
@@ -4153,9 +4186,11 @@ std::vector<std::string> MDSRankDispatcher::get_tracked_keys()
     "mds_log_pause",
     "mds_log_skip_corrupt_events",
     "mds_log_skip_unbounded_events",
+    "mds_log_submit_batch_max",
     "mds_log_trim_decay_rate",
     "mds_log_trim_threshold",
     "mds_max_caps_per_client",
+    "mds_max_dir_commit_ops",
     "mds_max_export_size",
     "mds_max_purge_files",
     "mds_max_purge_ops",
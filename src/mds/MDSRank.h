@@ -103,6 +103,9 @@ enum {
   l_mdss_handle_client_caps_dirty,
   l_mdss_handle_client_cap_release,
   l_mdss_process_request_cap_release,
+  l_mds_lock_wait,
+  l_mds_lock_hold,
+  l_mds_lock_hold_read,
   l_mds_last,
 };
 
@@ -442,6 +445,12 @@ class MDSRank {
     std::shared_ptr<QuiesceAgent> quiesce_agent;
 
     Finisher *finisher;
+
+    // encode and issue dirfrag commits; a dirfrag always maps to the same one
+    Finisher *get_dir_commit_finisher(dirfrag_t df) const {
+      return dir_commit_finishers[std::hash<dirfrag_t>()(df) %
+                                  dir_commit_finishers.size()];
+    }
   protected:
     typedef enum {
       // The MDSMap is available, configure default layouts and structures
@@ -646,6 +655,8 @@ class MDSRank {
     bool standby_replaying = false;  // true if current replay pass is in standby-replay mode
     uint64_t extraordinary_events_dump_interval = 0;
     double inject_journal_corrupt_dentry_first = 0.0;
+
+    std::vector<Finisher*> dir_commit_finishers;
 private:
     bool send_status = true;
 
@@ -33,6 +33,9 @@ enum {
   l_oft_omap_total_kv_pairs,
   l_oft_omap_total_updates,
   l_oft_omap_total_removes,
+  l_oft_omap_journaled_commits,
+  l_oft_prefetch_dirfrags,
+  l_oft_prefetch_time,
   l_oft_last
 };
 
@@ -54,6 +57,12 @@ OpenFileTable::OpenFileTable(MDSRank *m) : mds(m) {
   b.add_u64(l_oft_omap_total_kv_pairs, "omap_total_kv_pairs");
   b.add_u64(l_oft_omap_total_updates, "omap_total_updates");
   b.add_u64(l_oft_omap_total_removes, "omap_total_removes");
+  b.add_u64_counter(l_oft_omap_journaled_commits, "omap_journaled_commits",
+		    "Commits that journaled their updates before applying them");
+  b.add_u64(l_oft_prefetch_dirfrags, "prefetch_dirfrags",
+	    "Dirfrags fetched by the last prefetch");
+  b.add_time(l_oft_prefetch_time, "prefetch_time",
+	     "Duration of the last prefetch of open inodes");
   logger.reset(b.create_perf_counters());
   mds->cct->get_perfcounters_collection()->add(logger.get());
   logger->set(l_oft_omap_total_objs, 0);
@@ -612,6 +621,9 @@ void OpenFileTable::commit(MDSContext *c, uint64_t log_seq, int op_prio)
       ceph_assert(!gather.has_subs());
 
       unsigned omap_idx = objs_to_write.empty() ? 0 : objs_to_write.front();
+      logger->set(l_oft_omap_total_kv_pairs, total_items);
+      logger->inc(l_oft_omap_total_updates, omap_updates[omap_idx].to_update.size());
+      logger->inc(l_oft_omap_total_removes, omap_updates[omap_idx].to_remove.size());
       create_op_func(omap_idx, true);
       submit_ops_func();
       return;
@@ -629,6 +641,7 @@ void OpenFileTable::commit(MDSContext *c, uint64_t log_seq, int op_prio)
   if (journal_state == JOURNAL_START) {
     ceph_assert(gather.has_subs());
     journal_state = JOURNAL_FINISH;
+    logger->inc(l_oft_omap_journaled_commits);
   } else {
     // only object count changes
     ceph_assert(journal_state == JOURNAL_NONE);
@@ -1057,6 +1070,7 @@ void OpenFileTable::_open_ino_finish(inodeno_t ino, int r)
       }
     } else if (prefetch_state == FILE_INODES) {
       prefetch_state = DONE;
+      logger->tset(l_oft_prefetch_time, ceph::mono_clock::now() - prefetch_start);
       logseg_destroyed_inos.clear();
       destroyed_inos_set.clear();
       finish_contexts(g_ceph_context, waiting_for_prefetch);
@@ -1121,6 +1135,7 @@ void OpenFileTable::_prefetch_dirfrags()
     if (!(++num_opening_dirfrags % mds->heartbeat_reset_grace()))
       mds->heartbeat_reset();
   }
+  logger->set(l_oft_prefetch_dirfrags, num_opening_dirfrags);
 
   auto finish_func = [this](int r) {
     prefetch_state = FILE_INODES;
@@ -1208,6 +1223,7 @@ bool OpenFileTable::prefetch_inodes()
   dout(10) << __func__ << dendl;
   ceph_assert(!prefetch_state);
   prefetch_state = DIR_INODES;
+  prefetch_start = ceph::mono_clock::now();
 
   if (!load_done) {
     wait_for_load(
@@ -24,6 +24,7 @@
 
 #include "mdstypes.h"
 
+#include "common/ceph_time.h"
 #include "common/config_proxy.h" // for class ConfigProxy
 #include "global/global_context.h" // for g_conf()
 #include "include/buffer_fwd.h"
@@ -159,6 +160,7 @@ protected:
     DONE = 4,
   };
   unsigned prefetch_state = 0;
+  ceph::mono_time prefetch_start;
   unsigned num_opening_inodes = 0;
   std::vector<MDSContext*> waiting_for_prefetch;
 
@@ -184,6 +184,8 @@ void PurgeQueue::create_logger()
   pcb.add_u64(l_pq_executing, "pq_executing", "Purge queue tasks in flight");
   pcb.add_u64(l_pq_executing_high_water, "pq_executing_high_water", "Maximum number of executing file purges");
   pcb.add_u64(l_pq_item_in_journal, "pq_item_in_journal", "Purge item left in journal");
+  pcb.add_time_avg(l_pq_item_latency, "pq_item_latency", "Purge queue task latency");
+  pcb.add_u64(l_pq_op_limit, "pq_op_limit", "Purge queue ops allowed in flight");
 
   logger.reset(pcb.create_perf_counters());
   g_ceph_context->get_perfcounters_collection()->add(logger.get());
@@ -433,7 +435,8 @@ bool PurgeQueue::_can_consume()
     return false;
   }
 
-  dout(20) << ops_in_flight << "/" << max_purge_ops << " ops, "
+  const uint64_t op_limit = _get_op_limit();
+  dout(20) << ops_in_flight << "/" << op_limit << " ops, "
            << in_flight.size() << "/" << g_conf()->mds_max_purge_files
            << " files" << dendl;
 
@@ -445,9 +448,9 @@ bool PurgeQueue::_can_consume()
     return true;
   }
 
-  if (ops_in_flight >= max_purge_ops) {
+  if (ops_in_flight >= op_limit) {
     dout(20) << "Throttling on op limit " << ops_in_flight << "/"
-             << max_purge_ops << dendl;
+             << op_limit << dendl;
     return false;
   }
 
@@ -602,7 +605,7 @@ void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_ve
   ceph_assert(gather.has_subs());
 
   gather.set_finisher(new C_OnFinisher(
-	              new LambdaContext([this, expire_to](int r) {
+	              new LambdaContext([this, expire_to, start=ceph::mono_clock::now()](int r) {
     std::lock_guard l(lock);
 
     if (r == -EBLOCKLISTED) {
@@ -611,6 +614,9 @@ void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_ve
       return;
     }
 
+    const auto latency = ceph::mono_clock::now() - start;
+    logger->tinc(l_pq_item_latency, latency);
+    _update_op_scale(latency);
     _execute_item_complete(expire_to);
     _consume();
 
@@ -628,6 +634,42 @@ void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_ve
   gather.activate();
 }
 
+uint64_t PurgeQueue::_get_op_limit() const
+{
+  return std::max<uint64_t>(1, max_purge_ops * op_scale);
+}
+
+/*
+ * Back off when the OSDs are slow to complete purges: halve the share of
+ * the op limit when a purge takes longer than mds_purge_slow_threshold, at
+ * most once per threshold so that the completions of a slow burst count
+ * once, and grow it back slowly with each purge that is fast again.
+ */
+void PurgeQueue::_update_op_scale(ceph::timespan latency)
+{
+  ceph_assert(ceph_mutex_is_locked_by_me(lock));
+
+  const double threshold = cct->_conf.get_val<double>("mds_purge_slow_threshold");
+  double scale = op_scale;
+  if (threshold == 0) {
+    scale = 1.0;
+  } else if (std::chrono::duration<double>(latency).count() > threshold) {
+    const auto now = ceph::mono_clock::now();
+    if (std::chrono::duration<double>(now - last_backoff).count() > threshold) {
+      last_backoff = now;
+      scale = std::max(op_scale / 2, 1.0 / 64);
+      dout(4) << "purge took " << latency << ", backing off to "
+              << scale << " of the op limit" << dendl;
+    }
+  } else if (op_scale < 1.0) {
+    scale = std::min(op_scale + 1.0 / 64, 1.0);
+  }
+  if (scale != op_scale) {
+    op_scale = scale;
+    logger->set(l_pq_op_limit, _get_op_limit());
+  }
+}
+
 void PurgeQueue::_execute_item(
     const PurgeItem &item,
     uint64_t expire_to)
@@ -813,6 +855,9 @@ void PurgeQueue::update_op_limit(const MDSMap &mds_map)
   if (cct->_conf->mds_max_purge_ops) {
     max_purge_ops = std::min(max_purge_ops, cct->_conf->mds_max_purge_ops);
   }
+  if (logger) {
+    logger->set(l_pq_op_limit, _get_op_limit());
+  }
 }
 
 void PurgeQueue::handle_conf_change(const std::set<std::string>& changed, const MDSMap& mds_map)
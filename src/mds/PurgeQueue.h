@@ -16,6 +16,7 @@
 #ifndef PURGE_QUEUE_H_
 #define PURGE_QUEUE_H_
 
+#include "common/ceph_time.h"
 #include "common/Finisher.h"
 #include "common/snap_types.h" // for class SnapContext
 #include "include/cephfs/types.h" // for mds_rank_t
@@ -91,6 +92,8 @@ enum {
   l_pq_executed_ops,
   l_pq_executed,
   l_pq_item_in_journal,
+  l_pq_item_latency,
+  l_pq_op_limit,
   l_pq_last
 };
 
@@ -154,6 +157,8 @@ public:
   void push(const PurgeItem &pi, Context *completion);
 
   void _commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_vec, uint64_t expire_to);
+  uint64_t _get_op_limit() const;
+  void _update_op_scale(ceph::timespan latency);
 
   // If the on-disk queue is empty and we are not currently processing
   // anything.
@@ -228,6 +233,11 @@ private:
   // Dynamic op limit per MDS based on PG count
   uint64_t max_purge_ops = 0;
 
+  // Share of max_purge_ops allowed while the OSDs are slow to purge, see
+  // _update_op_scale()
+  double op_scale = 1.0;
+  ceph::mono_time last_backoff;
+
   // How many bytes were remaining when drain() was first called,
   // used for indicating progress.
   uint64_t drain_initial = 0;
@@ -239,6 +239,28 @@ private:
   MDSCacheObject *obj;
 };
 
+void ScrubStack::note_request_latency(double lat)
+{
+  auto now = ceph::coarse_mono_clock::now();
+  if (now - request_latency_stamp > std::chrono::seconds(5)) {
+    request_latency = lat;
+  } else {
+    request_latency = request_latency * 0.9 + lat * 0.1;
+  }
+  request_latency_stamp = now;
+}
+
+int ScrubStack::get_max_scrub_ops() const
+{
+  int max_ops = g_conf()->mds_max_scrub_ops_in_progress;
+  double target = g_conf().get_val<double>("mds_scrub_throttle_latency");
+  if (target <= 0 || request_latency <= target ||
+      ceph::coarse_mono_clock::now() - request_latency_stamp > std::chrono::seconds(5)) {
+    return max_ops;
+  }
+  return std::max(1, (int)(max_ops * target / request_latency));
+}
+
 void ScrubStack::kick_off_scrubs()
 {
   ceph_assert(ceph_mutex_is_locked(mdcache->mds->mds_lock));
@@ -265,10 +287,12 @@ void ScrubStack::kick_off_scrubs()
     return;
   }
 
+  const int max_ops = get_max_scrub_ops();
   dout(20) << __func__ << " entering with " << scrubs_in_progress << " in "
-              "progress and " << stack_size << " in the stack" << dendl;
+              "progress (max " << max_ops << ") and " << stack_size
+	   << " in the stack" << dendl;
   elist<MDSCacheObject*>::iterator it = scrub_stack.begin();
-  while (g_conf()->mds_max_scrub_ops_in_progress > scrubs_in_progress) {
+  while (max_ops > scrubs_in_progress) {
     if (it.end()) {
       if (scrubs_in_progress == 0) {
         set_state(STATE_IDLE);
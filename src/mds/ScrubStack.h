@@ -113,6 +113,12 @@ public:
   void purge_old_scrub_counters(); // on tick
   void handle_conf_change(const std::set<std::string>& changed);
 
+  /**
+   * Note the latency of a client request. Scrub runs fewer operations
+   * in parallel while requests are slower than mds_scrub_throttle_latency.
+   */
+  void note_request_latency(double lat);
+
 
   MDCache *mdcache;
 
@@ -131,6 +137,10 @@ protected:
   int scrubs_in_progress = 0;
   int stack_size = 0;
 
+  /// moving average of client request latency, in seconds
+  double request_latency = 0;
+  ceph::coarse_mono_time request_latency_stamp;
+
   struct scrub_remote_t {
     std::string tag;
     std::set<mds_rank_t> gather_set;
@@ -181,6 +191,11 @@ private:
   friend class MDCache;
 
   int _enqueue(MDSCacheObject *obj, ScrubHeaderRef& header, bool top);
+  /**
+   * The number of scrub operations allowed in progress, given the
+   * recent latency of client requests.
+   */
+  int get_max_scrub_ops() const;
   /**
    * Remove the inode/dirfrag from the stack.
    */
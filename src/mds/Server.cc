@@ -39,6 +39,7 @@
 #include "SnapRealm.h"
 #include "Mutation.h"
 #include "MetricsHandler.h"
+#include "ScrubStack.h"
 #include "cephfs_features.h"
 #include "MDSContext.h"
 
@@ -2342,6 +2343,7 @@ void Server::early_reply(const MDRequestRef& mdr, CInode *tracei, CDentry *trace
   mds->logger->inc(l_mds_reply);
   utime_t lat = ceph_clock_now() - req->get_recv_stamp();
   mds->logger->tinc(l_mds_reply_latency, lat);
+  mds->scrubstack->note_request_latency(lat);
   if (lat >= g_conf()->mds_op_complaint_time) {
     mds->logger->inc(l_mds_slow_reply);
   }
@@ -2403,6 +2405,7 @@ void Server::reply_client_request(const MDRequestRef& mdr, const ref_t<MClientRe
     mds->logger->inc(l_mds_reply);
     utime_t lat = ceph_clock_now() - mdr->client_request->get_recv_stamp();
     mds->logger->tinc(l_mds_reply_latency, lat);
+    mds->scrubstack->note_request_latency(lat);
     if (lat >= g_conf()->mds_op_complaint_time) {
       mds->logger->inc(l_mds_slow_reply);
     }
@@ -4177,6 +4180,25 @@ Server::rdlock_two_paths_xlock_destdn(const MDRequestRef& mdr, bool xlock_srcdn)
  * @param mdr request
  * @returns the pointer, or NULL if it had to be delayed (but mdr is taken care of)
  */
+void Server::prefetch_next_dirfrags(CInode *diri, frag_t fg)
+{
+  auto count = g_conf().get_val<uint64_t>("mds_readdir_prefetch_frags");
+  for (frag_t f = fg; count > 0 && !f.is_rightmost(); --count) {
+    f = diri->dirfragtree[f.next().value()];
+    CDir *dir = diri->get_dirfrag(f);
+    if (!dir) {
+      if (!diri->is_auth() || diri->is_frozen())
+	continue;
+      dir = diri->get_or_open_dirfrag(mdcache, f);
+    }
+    if (!dir->is_auth() || dir->is_complete() ||
+	dir->state_test(CDir::STATE_FETCHING) || !dir->can_auth_pin())
+      continue;
+    dout(10) << __func__ << " " << *dir << dendl;
+    dir->fetch(nullptr);
+  }
+}
+
 CDir* Server::try_open_auth_dirfrag(CInode *diri, frag_t fg, const MDRequestRef& mdr)
 {
   CDir *dir = diri->get_dirfrag(fg);
@@ -5112,6 +5134,9 @@ void Server::handle_client_readdir(const MDRequestRef& mdr)
   dout(10) << "handle_client_readdir on " << *dir << dendl;
   ceph_assert(dir->is_auth());
 
+  // the client reads the frags in order: fetch the next ones meanwhile
+  prefetch_next_dirfrags(diri, fg);
+
   if (!dir->is_complete()) {
     if (dir->is_frozen()) {
       dout(7) << "dir is frozen " << *dir << dendl;
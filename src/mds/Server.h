@@ -246,6 +246,8 @@ public:
 	    rdlock_two_paths_xlock_destdn(const MDRequestRef& mdr, bool xlock_srcdn);
 
   CDir* try_open_auth_dirfrag(CInode *diri, frag_t fg, const MDRequestRef& mdr);
+  // start fetching the dirfrags a readdir of fg will continue with
+  void prefetch_next_dirfrags(CInode *diri, frag_t fg);
 
   // requests on existing inodes.
   void handle_client_getattr(const MDRequestRef& mdr, bool is_lookup);
@@ -124,9 +124,16 @@ void SnapRealm::check_cache() const
     last_created = srnode.last_created;
     seq = srnode.seq;
   }
-  if (cached_seq >= seq &&
-      cached_last_destroyed == last_destroyed)
-    return;
+  if (cached_seq >= seq) {
+    if (cached_last_destroyed == last_destroyed)
+      return;
+    // a snap destroyed in another realm doesn't change ours unless it
+    // may be one of the past parent snaps we or our ancestors filter
+    if (!uses_destroyed_snaps()) {
+      cached_last_destroyed = last_destroyed;
+      return;
+    }
+  }
 
   cached_snap_context.clear();
 
@@ -152,6 +159,21 @@ void SnapRealm::check_cache() const
 	   << ")" << dendl;
 }
 
+/*
+ * whether our snap set is derived from the set of snaps the snap server
+ * still knows of, rather than only from the snaps of this realm and of
+ * its ancestors, whose removal invalidates it explicitly.
+ */
+bool SnapRealm::uses_destroyed_snaps() const
+{
+  for (const SnapRealm *r = this; r; r = r->parent) {
+    if (r->global || r->srnode.is_parent_global() ||
+	!r->srnode.past_parent_snaps.empty())
+      return true;
+  }
+  return false;
+}
+
 const set<snapid_t>& SnapRealm::get_snaps() const
 {
   check_cache();
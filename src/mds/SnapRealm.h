@@ -139,6 +139,7 @@ public:
 
 protected:
   void check_cache() const;
+  bool uses_destroyed_snaps() const;
 
 private:
   bool global;
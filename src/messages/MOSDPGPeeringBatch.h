@@ -0,0 +1,99 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#pragma once
+
+#include "msg/Message.h"
+#include "MOSDPeeringOp.h"
+
+/*
+ * PGPeeringBatch - the queries, notifies and infos one OSD has for
+ * many PGs on another OSD, sent as a single message.  Each sub-op is
+ * turned into its own peering event on the receiving side, exactly as
+ * if it had arrived on its own.
+ */
+
+class MOSDPGPeeringBatch final : public Message {
+private:
+  static constexpr int HEAD_VERSION = 1;
+  static constexpr int COMPAT_VERSION = 1;
+
+public:
+  /// map epoch of the sender when the batch was sent
+  epoch_t epoch = 0;
+
+  std::vector<ceph::ref_t<MOSDPeeringOp>> ops;
+
+  static bool can_batch(int type) {
+    switch (type) {
+    case MSG_OSD_PG_NOTIFY2:
+    case MSG_OSD_PG_QUERY2:
+    case MSG_OSD_PG_INFO2:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  epoch_t get_epoch() const { return epoch; }
+
+  MOSDPGPeeringBatch()
+    : MOSDPGPeeringBatch(0, {})
+  {}
+  MOSDPGPeeringBatch(epoch_t e, std::vector<ceph::ref_t<MOSDPeeringOp>>&& ops)
+    : Message{MSG_OSD_PG_PEERING_BATCH, HEAD_VERSION, COMPAT_VERSION},
+      epoch(e),
+      ops(std::move(ops)) {
+    set_priority(CEPH_MSG_PRIO_HIGH);
+  }
+private:
+  ~MOSDPGPeeringBatch() final {}
+
+public:
+  std::string_view get_type_name() const override { return "PGpeering"; }
+  void print(std::ostream& out) const override {
+    out << "pg_peering_batch(" << ops.size() << " ops epoch " << epoch << ")";
+  }
+
+  void encode_payload(uint64_t features) override {
+    using ceph::encode;
+    encode(epoch, payload);
+    encode((uint32_t)ops.size(), payload);
+    for (auto& op : ops) {
+      encode_message(op.get(), features, payload);
+    }
+  }
+  void decode_payload() override {
+    using ceph::decode;
+    auto p = payload.cbegin();
+    decode(epoch, p);
+    uint32_t n;
+    decode(n, p);
+    ops.clear();
+    ops.reserve(n);
+    while (n--) {
+      Message *m = decode_message(nullptr, 0, p);
+      if (!m) {
+	throw ceph::buffer::malformed_input("failed to decode sub-op");
+      }
+      if (!can_batch(m->get_type())) {
+	m->put();
+	throw ceph::buffer::malformed_input("unexpected sub-op type");
+      }
+      ops.emplace_back(static_cast<MOSDPeeringOp*>(m), false);
+    }
+  }
+private:
+  template<class T, typename... Args>
+  friend boost::intrusive_ptr<T> ceph::make_message(Args&&... args);
+};
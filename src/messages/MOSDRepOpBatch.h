@@ -0,0 +1,121 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#pragma once
+
+#include "MOSDFastDispatchOp.h"
+#include "MOSDRepOp.h"
+
+/*
+ * A run of MOSDRepOps from one primary to one replica of a PG, in the
+ * order they were issued.  The replica applies them in a single object
+ * store transaction and still acks each of them individually.
+ */
+
+class MOSDRepOpBatch final : public MOSDFastDispatchOp {
+private:
+  static constexpr int HEAD_VERSION = 1;
+  static constexpr int COMPAT_VERSION = 1;
+
+public:
+  /// map epoch of the oldest sub-op
+  epoch_t map_epoch = 0;
+
+  /// start epoch of the interval in which the sub-ops were sent
+  epoch_t min_epoch = 0;
+
+  /// target pg
+  spg_t pgid;
+
+  std::vector<ceph::ref_t<MOSDRepOp>> ops;
+
+  epoch_t get_map_epoch() const override {
+    return map_epoch;
+  }
+  epoch_t get_min_epoch() const override {
+    return min_epoch;
+  }
+  spg_t get_spg() const override {
+    return pgid;
+  }
+
+  int get_cost() const override {
+    int cost = 0;
+    for (const auto& op : ops) {
+      cost += op->get_cost();
+    }
+    return cost;
+  }
+
+  MOSDRepOpBatch()
+    : MOSDFastDispatchOp{MSG_OSD_REPOP_BATCH, HEAD_VERSION,
+			 COMPAT_VERSION} {}
+  MOSDRepOpBatch(
+    spg_t pgid,
+    epoch_t epoch,
+    epoch_t min_epoch,
+    std::vector<ceph::ref_t<MOSDRepOp>>&& ops)
+    : MOSDFastDispatchOp{MSG_OSD_REPOP_BATCH, HEAD_VERSION,
+			 COMPAT_VERSION},
+      map_epoch(epoch),
+      min_epoch(min_epoch),
+      pgid(pgid),
+      ops(std::move(ops))
+  {}
+
+private:
+  ~MOSDRepOpBatch() final {}
+
+public:
+  std::string_view get_type_name() const override { return "osd_repop_batch"; }
+  void print(std::ostream& out) const override {
+    out << "osd_repop_batch(" << pgid << " e" << map_epoch
+	<< "/" << min_epoch << " " << ops.size() << " ops)";
+  }
+
+  void encode_payload(uint64_t features) override {
+    using ceph::encode;
+    encode(map_epoch, payload);
+    encode(min_epoch, payload);
+    encode(pgid, payload);
+    encode((uint32_t)ops.size(), payload);
+    for (auto& op : ops) {
+      encode_message(op.get(), features, payload);
+    }
+  }
+  void decode_payload() override {
+    using ceph::decode;
+    auto p = payload.cbegin();
+    decode(map_epoch, p);
+    decode(min_epoch, p);
+    decode(pgid, p);
+    uint32_t n;
+    decode(n, p);
+    ops.clear();
+    ops.reserve(n);
+    while (n--) {
+      Message *m = decode_message(nullptr, 0, p);
+      if (!m) {
+	throw ceph::buffer::malformed_input("failed to decode sub-op");
+      }
+      if (m->get_type() != MSG_OSD_REPOP) {
+	m->put();
+	throw ceph::buffer::malformed_input("unexpected sub-op type");
+      }
+      ops.emplace_back(static_cast<MOSDRepOp*>(m), false);
+    }
+  }
+private:
+  template<class T, typename... Args>
+  friend boost::intrusive_ptr<T> ceph::make_message(Args&&... args);
+};
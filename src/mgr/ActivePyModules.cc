@@ -190,11 +190,40 @@ void ActivePyModules::update_cache_metrics() {
     perfcounter->set(l_mgr_cache_miss, hit_miss_ratio.second);
 }
 
+uint64_t ActivePyModules::get_cache_version(const std::string &what)
+{
+  without_gil_t no_gil;
+  if (what == "osd_map") {
+    return cluster_state.with_osdmap([](const OSDMap &osd_map) {
+      return uint64_t(osd_map.get_epoch());
+    });
+  } else if (what == "pg_dump" || what == "pg_stats") {
+    return cluster_state.with_pgmap([](const PGMap &pg_map) {
+      return uint64_t(pg_map.version);
+    });
+  }
+  return 0;
+}
+
 PyObject *ActivePyModules::cacheable_get_python(const std::string &what)
 {
   uint64_t ttl_seconds = g_conf().get_val<uint64_t>("mgr_ttl_cache_expire_seconds");
+  uint64_t version = 0;
   if(ttl_seconds > 0) {
     ttl_cache.set_ttl(ttl_seconds);
+    // the cached objects are snapshots of a map: drop them once the map
+    // changes, and keep them past their ttl for as long as it doesn't
+    if (ttl_cache.is_cacheable(what)) {
+      version = get_cache_version(what);
+    }
+    auto cached_version = ttl_cache_versions.find(what);
+    if (cached_version != ttl_cache_versions.end() && ttl_cache.exists(what)) {
+      if (cached_version->second != version) {
+        ttl_cache.erase(what);
+      } else if (version) {
+        ttl_cache.renew(what);
+      }
+    }
     try{
       PyObject* cached = ttl_cache.get(what);
       update_cache_metrics();
@@ -205,6 +234,7 @@ PyObject *ActivePyModules::cacheable_get_python(const std::string &what)
   PyObject *obj = get_python(what);
   if(ttl_seconds && ttl_cache.is_cacheable(what)) {
     ttl_cache.insert(what, obj);
+    ttl_cache_versions[what] = version;
     Py_INCREF(obj);
   }
   update_cache_metrics();
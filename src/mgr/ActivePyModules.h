@@ -62,6 +62,8 @@ class ActivePyModules
   Objecter &objecter;
   Finisher &finisher;
   TTLCache<std::string, PyObject*> ttl_cache;
+  /// map version each ttl_cache entry was built from
+  std::map<std::string, uint64_t> ttl_cache_versions;
 public:
   Finisher cmd_finisher;
 private:
@@ -254,5 +256,7 @@ public:
 
   bool inject_python_on() const;
   void update_cache_metrics();
+  /// version of the map a cacheable object is built from, or 0
+  uint64_t get_cache_version(const std::string &what);
 };
 
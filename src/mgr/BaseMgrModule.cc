@@ -905,6 +905,7 @@ ceph_add_osd_perf_query(BaseMgrModule *self, PyObject *args)
     {"latency", PerformanceCounterType::LATENCY},
     {"write_latency", PerformanceCounterType::WRITE_LATENCY},
     {"read_latency", PerformanceCounterType::READ_LATENCY},
+    {"slow_ops", PerformanceCounterType::SLOW_OPS},
   };
 
   PyObject *py_query = nullptr;
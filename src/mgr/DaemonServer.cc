@@ -722,10 +722,10 @@ bool DaemonServer::handle_report(const ref_t<MMgrReport>& m)
   }
 
 
+  DaemonStatePtr daemon;
   {
     std::unique_lock locker(lock);
 
-    DaemonStatePtr daemon;
     // Look up the DaemonState
     if (daemon = daemon_state.get(key); daemon != nullptr) {
       dout(20) << "updating existing DaemonState for " << key << dendl;
@@ -763,43 +763,51 @@ bool DaemonServer::handle_report(const ref_t<MMgrReport>& m)
       return false;
     }
 
-    // Update the DaemonState
+    // the types are shared by all daemons: declare them under our lock
     ceph_assert(daemon != nullptr);
-    {
-      std::lock_guard l(daemon->lock);
-      auto &daemon_counters = daemon->perf_counters;
-      daemon_counters.update(*m.get());
+    std::lock_guard l(daemon->lock);
+    daemon->perf_counters.declare(*m.get());
+  }
 
-      auto p = m->config_bl.cbegin();
-      if (p != m->config_bl.end()) {
-        decode(daemon->config, p);
-        decode(daemon->ignored_mon_config, p);
-        dout(20) << " got config " << daemon->config
-                 << " ignored " << daemon->ignored_mon_config << dendl;
-      }
+  // Update the DaemonState. Decoding the counter values is the bulk of a
+  // report, so it only holds the lock of this daemon
+  {
+    std::lock_guard l(daemon->lock);
+    daemon->perf_counters.update(*m.get());
 
-      utime_t now = ceph_clock_now();
-      if (daemon->service_daemon) {
-        if (m->daemon_status) {
-          daemon->service_status_stamp = now;
-          daemon->service_status = *m->daemon_status;
-        }
-        daemon->last_service_beacon = now;
-      } else if (m->daemon_status) {
-        derr << "got status from non-daemon " << key << dendl;
-      }
-      // update task status
-      if (m->task_status) {
-        update_task_status(key, *m->task_status);
-        daemon->last_service_beacon = now;
-      }
-      if (m->get_connection()->peer_is_osd() || m->get_connection()->peer_is_mon()) {
-        // only OSD and MON send health_checks to me now
-        daemon->daemon_health_metrics = std::move(m->daemon_health_metrics);
-        dout(10) << "daemon_health_metrics " << daemon->daemon_health_metrics
-                 << dendl;
+    auto p = m->config_bl.cbegin();
+    if (p != m->config_bl.end()) {
+      decode(daemon->config, p);
+      decode(daemon->ignored_mon_config, p);
+      dout(20) << " got config " << daemon->config
+               << " ignored " << daemon->ignored_mon_config << dendl;
+    }
+
+    utime_t now = ceph_clock_now();
+    if (daemon->service_daemon) {
+      if (m->daemon_status) {
+        daemon->service_status_stamp = now;
+        daemon->service_status = *m->daemon_status;
       }
+      daemon->last_service_beacon = now;
+    } else if (m->daemon_status) {
+      derr << "got status from non-daemon " << key << dendl;
     }
+    if (m->task_status) {
+      daemon->last_service_beacon = now;
+    }
+    if (m->get_connection()->peer_is_osd() || m->get_connection()->peer_is_mon()) {
+      // only OSD and MON send health_checks to me now
+      daemon->daemon_health_metrics = std::move(m->daemon_health_metrics);
+      dout(10) << "daemon_health_metrics " << daemon->daemon_health_metrics
+               << dendl;
+    }
+  }
+
+  // update task status
+  if (m->task_status) {
+    std::lock_guard l(lock);
+    update_task_status(key, *m->task_status);
   }
 
   // if there are any schema updates, notify the python modules
@@ -14,6 +14,7 @@
 
 #include "DaemonState.h"
 
+#include <algorithm>
 #include <experimental/iterator>
 
 #include "MgrSession.h"
@@ -375,12 +376,11 @@ void DaemonStateIndex::cull_services(const std::set<std::string>& types_exist)
   }
 }
 
-void DaemonPerfCounters::update(const MMgrReport& report)
+void DaemonPerfCounters::declare(const MMgrReport& report)
 {
   dout(20) << "loading " << report.declare_types.size() << " new types, "
 	   << report.undeclare_types.size() << " old types, had "
-	   << types.size() << " types, got "
-           << report.packed.length() << " bytes of data" << dendl;
+	   << types.size() << " types" << dendl;
 
   // Retrieve session state
   auto priv = report.get_connection()->get_priv();
@@ -389,33 +389,45 @@ void DaemonPerfCounters::update(const MMgrReport& report)
   // Load any newly declared types
   for (const auto &t : report.declare_types) {
     types.insert(std::make_pair(t.path, t));
-    session->declared_types.insert(t.path);
+    session->declared_types[t.path] = t.type;
   }
   // Remove any old types
   for (const auto &t : report.undeclare_types) {
     session->declared_types.erase(t);
   }
+}
+
+void DaemonPerfCounters::update(const MMgrReport& report)
+{
+  dout(20) << "got " << report.packed.length() << " bytes of data" << dendl;
+
+  auto priv = report.get_connection()->get_priv();
+  auto session = static_cast<MgrSession*>(priv.get());
 
   const auto now = ceph_clock_now();
 
-  // Parse packed data according to declared set of types
+  // Parse packed data according to declared set of types. The session
+  // keeps the type of each path, so the shared types are not read here
   auto p = report.packed.cbegin();
   DECODE_START(1, p);
-  for (const auto &t_path : session->declared_types) {
-    const auto &t = types.at(t_path);
-    auto instances_it = instances.find(t_path);
+  auto instances_it = instances.begin();
+  for (const auto &[t_path, t_type] : session->declared_types) {
+    // both maps are sorted by path: look forward from the last instance
+    // rather than from the root
+    instances_it = std::find_if(instances_it, instances.end(),
+      [&t_path=t_path](const auto& i) { return i.first >= t_path; });
     // Always check the instance exists, as we don't prevent yet
     // multiple sessions from daemons with the same name, and one
     // session clearing stats created by another on open.
-    if (instances_it == instances.end()) {
-      instances_it = instances.insert({t_path, t.type}).first;
+    if (instances_it == instances.end() || instances_it->first != t_path) {
+      instances_it = instances.emplace_hint(instances_it, t_path, t_type);
     }
     uint64_t val = 0;
     uint64_t avgcount = 0;
     uint64_t avgcount2 = 0;
 
     decode(val, p);
-    if (t.type & PERFCOUNTER_LONGRUNAVG) {
+    if (t_type & PERFCOUNTER_LONGRUNAVG) {
       decode(avgcount, p);
       decode(avgcount2, p);
       instances_it->second.push_avg(now, val, avgcount);
@@ -114,6 +114,10 @@ class DaemonPerfCounters
 
   std::map<std::string, PerfCounterInstance> instances;
 
+  // Load the types declared and undeclared by a report into the shared
+  // types, which the caller serializes
+  void declare(const MMgrReport& report);
+  // Load the values of a report, only touching this daemon's state
   void update(const MMgrReport& report);
 
   void clear()
@@ -21,21 +21,29 @@ COMMAND("pg dump_pools_json", "show pg pools info in json only",\
 
 COMMAND("pg ls-by-pool "		\
         "name=poolstr,type=CephString " \
-	"name=states,type=CephString,n=N,req=false", \
+	"name=states,type=CephString,n=N,req=false " \
+	"name=after,type=CephPgid,req=false " \
+	"name=max,type=CephInt,range=1,req=false", \
 	"list pg with pool = [poolname]", "pg", "r")
 COMMAND("pg ls-by-primary " \
         "name=osd,type=CephOsdName " \
         "name=pool,type=CephInt,req=false " \
-	"name=states,type=CephString,n=N,req=false", \
+	"name=states,type=CephString,n=N,req=false " \
+	"name=after,type=CephPgid,req=false " \
+	"name=max,type=CephInt,range=1,req=false", \
 	"list pg with primary = [osd]", "pg", "r")
 COMMAND("pg ls-by-osd " \
         "name=osd,type=CephOsdName " \
         "name=pool,type=CephInt,req=false " \
-	"name=states,type=CephString,n=N,req=false", \
+	"name=states,type=CephString,n=N,req=false " \
+	"name=after,type=CephPgid,req=false " \
+	"name=max,type=CephInt,range=1,req=false", \
 	"list pg on osd [osd]", "pg", "r")
 COMMAND("pg ls " \
         "name=pool,type=CephInt,req=false " \
-	"name=states,type=CephString,n=N,req=false", \
+	"name=states,type=CephString,n=N,req=false " \
+	"name=after,type=CephPgid,req=false " \
+	"name=max,type=CephInt,range=1,req=false", \
 	"list pg with specific pool, osd, state", "pg", "r")
 COMMAND("pg dump_stuck " \
 	"name=stuckops,type=CephChoices,strings=inactive|unclean|stale|undersized|degraded,n=N,req=false " \
@@ -6,6 +6,7 @@
 
 #include "common/RefCountedObj.h"
 #include "common/entity_name.h"
+#include "common/perf_counters.h"
 #include "msg/msg_types.h"
 #include "MgrCap.h"
 
@@ -22,7 +23,8 @@ struct MgrSession : public RefCountedObject {
 
   MgrCap caps;
 
-  std::set<std::string> declared_types;
+  /// perf counters declared by the daemon, and their types
+  std::map<std::string, perfcounter_type_d> declared_types;
 
   const entity_addr_t& get_peer_addr() const {
     return inst.addr;
@@ -164,6 +164,7 @@ enum class PerformanceCounterType : uint8_t {
   LATENCY = 6,
   WRITE_LATENCY = 7,
   READ_LATENCY = 8,
+  SLOW_OPS = 9,       // ops over osd_perf_query_slow_op_latency, out of all ops
 };
 
 struct PerformanceCounterDescriptor {
@@ -180,6 +181,7 @@ struct PerformanceCounterDescriptor {
     case PerformanceCounterType::LATENCY:
     case PerformanceCounterType::WRITE_LATENCY:
     case PerformanceCounterType::READ_LATENCY:
+    case PerformanceCounterType::SLOW_OPS:
       return true;
     default:
       return false;
@@ -226,6 +228,7 @@ struct PerformanceCounterDescriptor {
     o.push_back(PerformanceCounterDescriptor(PerformanceCounterType::LATENCY));
     o.push_back(PerformanceCounterDescriptor(PerformanceCounterType::WRITE_LATENCY));
     o.push_back(PerformanceCounterDescriptor(PerformanceCounterType::READ_LATENCY));
+    o.push_back(PerformanceCounterDescriptor(PerformanceCounterType::SLOW_OPS));
     return o;
   }
 
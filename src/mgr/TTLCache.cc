@@ -45,6 +45,19 @@ template <class Key> PyObject* TTLCache<Key, PyObject*>::get(Key key) {
   return cached_value;
 }
 
+template <class Key, class Value>
+void TTLCacheBase<Key, Value>::renew(Key key) {
+  if (!ttl || !exists(key)) return;
+  Value value = get_value(key, false);
+  // keep the spread of insert() so renewed entries don't expire together
+  int16_t random_ttl_offset =
+      ttl * ttl_spread_ratio * (2l * rand() / float(RAND_MAX) - 1);
+  int16_t spreaded_ttl = ttl + random_ttl_offset;
+  auto expiration_date =
+      std::chrono::steady_clock::now() + std::chrono::seconds(spreaded_ttl);
+  this->content[key] = {value, expiration_date};
+}
+
 template <class Key, class Value>
 void TTLCacheBase<Key, Value>::erase(Key key) {
   cache::erase(key);
@@ -79,7 +79,6 @@ class TTLCacheBase : public Cache<Key, std::pair<Value, ttl_time_point>> {
  protected:
   Value get_value(Key key, bool count_hit = true);
   ttl_time_point get_value_time_point(Key key);
-  bool exists(Key key);
   bool expired(Key key);
   void finish_get(Key key);
   void finish_erase(Key key);
@@ -92,6 +91,9 @@ class TTLCacheBase : public Cache<Key, std::pair<Value, ttl_time_point>> {
   ~TTLCacheBase(){};
   void insert(Key key, Value value);
   Value get(Key key);
+  bool exists(Key key);
+  /* push back the expiration of an entry that is known to be current */
+  void renew(Key key);
   void erase(Key key);
   void clear();
   uint16_t get_ttl() { return ttl; };
@@ -836,6 +836,7 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
     OSDMap::Incremental inc(inc_bl);
     err = osdmap.apply_incremental(inc);
     ceph_assert(err == 0);
+    mapping.note_incremental(inc);
 
     if (!t)
       t.reset(new MonitorDBStore::Transaction);
@@ -1081,11 +1082,16 @@ void OSDMonitor::start_mapping()
   }
   if (!osdmap.get_pools().empty()) {
     auto fin = new C_UpdateCreatingPGs(this, osdmap.get_epoch());
-    mapping_job = mapping.start_update(osdmap, mapper,
-				       g_conf()->mon_osd_mapping_pgs_per_chunk);
-    dout(10) << __func__ << " started mapping job " << mapping_job.get()
-	     << " at " << fin->start << dendl;
-    mapping_job->set_finish_event(fin);
+    auto job = mapping.start_update(
+      osdmap, mapper,
+      g_conf()->mon_osd_mapping_pgs_per_chunk,
+      g_conf().get_val<bool>("mon_osd_mapping_incremental"));
+    dout(10) << __func__ << " started mapping job " << job.get()
+	     << " at " << fin->start << " incremental " << job->incremental
+	     << " (" << job->num_remap_pools << " pools, "
+	     << job->num_remap_pgs << " pgs)" << dendl;
+    job->set_finish_event(fin);
+    mapping_job = std::move(job);
   } else {
     dout(10) << __func__ << " no pools, no mapping job" << dendl;
     mapping_job = nullptr;
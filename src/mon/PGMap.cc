@@ -3337,22 +3337,46 @@ void PGMap::get_health_checks(
     int detail_max = max, deep_detail_max = max;
     int detail_more = 0, deep_detail_more = 0;
     int detail_total = 0, deep_detail_total = 0;
-    for (auto& p : pg_stat) {
-      int64_t pnum =  p.first.pool();
-      auto pool = osdmap.get_pg_pool(pnum);
-      if (!pool)
-        continue;
-      if (cct->_conf->mon_warn_pg_not_scrubbed_ratio) {
+    const double scrubbed_ratio = cct->_conf->mon_warn_pg_not_scrubbed_ratio;
+    const double deep_scrubbed_ratio =
+      cct->_conf->mon_warn_pg_not_deep_scrubbed_ratio;
+
+    // the cutoffs only depend on the pool: compute them once per pool
+    // instead of once per pg
+    std::map<int64_t, std::pair<utime_t, utime_t>> scrub_cutoffs;
+    for (auto& [pnum, pool] : osdmap.get_pools()) {
+      utime_t cutoff, deep_cutoff;
+      if (scrubbed_ratio) {
         double scrub_max_interval = 0;
-        pool->opts.get(pool_opts_t::SCRUB_MAX_INTERVAL, &scrub_max_interval);
+        pool.opts.get(pool_opts_t::SCRUB_MAX_INTERVAL, &scrub_max_interval);
         if (scrub_max_interval <= 0) {
           scrub_max_interval = cct->_conf->osd_scrub_max_interval;
         }
-        const double age = (cct->_conf->mon_warn_pg_not_scrubbed_ratio * scrub_max_interval) +
+        const double age = (scrubbed_ratio * scrub_max_interval) +
           scrub_max_interval;
-        utime_t cutoff = now;
+        cutoff = now;
         cutoff -= age;
-        if (p.second.last_scrub_stamp < cutoff) {
+      }
+      if (deep_scrubbed_ratio) {
+        double deep_scrub_interval = 0;
+        pool.opts.get(pool_opts_t::DEEP_SCRUB_INTERVAL, &deep_scrub_interval);
+        if (deep_scrub_interval <= 0) {
+          deep_scrub_interval = cct->_conf->osd_deep_scrub_interval;
+        }
+        double deep_age = (deep_scrubbed_ratio * deep_scrub_interval) +
+          deep_scrub_interval;
+        deep_cutoff = now;
+        deep_cutoff -= deep_age;
+      }
+      scrub_cutoffs.emplace(pnum, std::make_pair(cutoff, deep_cutoff));
+    }
+
+    for (auto& p : pg_stat) {
+      auto cutoffs = scrub_cutoffs.find(p.first.pool());
+      if (cutoffs == scrub_cutoffs.end())
+        continue;
+      if (scrubbed_ratio) {
+        if (p.second.last_scrub_stamp < cutoffs->second.first) {
           if (detail_max > 0) {
             ostringstream ss;
             ss << "pg " << p.first << " not scrubbed since "
@@ -3365,17 +3389,8 @@ void PGMap::get_health_checks(
           ++detail_total;
         }
       }
-      if (cct->_conf->mon_warn_pg_not_deep_scrubbed_ratio) {
-        double deep_scrub_interval = 0;
-        pool->opts.get(pool_opts_t::DEEP_SCRUB_INTERVAL, &deep_scrub_interval);
-        if (deep_scrub_interval <= 0) {
-          deep_scrub_interval = cct->_conf->osd_deep_scrub_interval;
-        }
-        double deep_age = (cct->_conf->mon_warn_pg_not_deep_scrubbed_ratio * deep_scrub_interval) +
-          deep_scrub_interval;
-        utime_t deep_cutoff = now;
-        deep_cutoff -= deep_age;
-        if (p.second.last_deep_scrub_stamp < deep_cutoff) {
+      if (deep_scrubbed_ratio) {
+        if (p.second.last_deep_scrub_stamp < cutoffs->second.second) {
           if (deep_detail_max > 0) {
             ostringstream ss;
             ss << "pg " << p.first << " not deep-scrubbed since "
@@ -3707,6 +3722,23 @@ int process_pg_map_command(
 
     pg_map.get_filtered_pg_stats(state, pool, osd, primary, pgs);
 
+    // pages of at most max pgs, each starting after the last pg of the
+    // previous page, keep the output of large clusters small
+    string after_str;
+    if (cmd_getval(cmdmap, "after", after_str)) {
+      pg_t after;
+      if (!after.parse(after_str.c_str())) {
+        *ss << "invalid pgid '" << after_str << "'";
+        return -EINVAL;
+      }
+      pgs.erase(pgs.begin(), pgs.upper_bound(after));
+    }
+    int64_t max = 0;
+    if (cmd_getval(cmdmap, "max", max) && max > 0 &&
+        pgs.size() > (uint64_t)max) {
+      pgs.erase(std::next(pgs.begin(), max), pgs.end());
+    }
+
     if (f && !pgs.empty()) {
       pg_map.dump_filtered_pg_stats(f, pgs);
       f->flush(*odata);
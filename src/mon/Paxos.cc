@@ -1256,8 +1256,16 @@ void Paxos::trim()
   }
   t->put(get_name(), "first_committed", end);
   if (g_conf()->mon_compact_on_trim) {
-    dout(10) << " compacting trimmed range" << dendl;
-    t->compact_range(get_name(), stringify(first_committed - 1), stringify(end));
+    // let the tombstones of a few trims add up, and compact them at once
+    if (!trim_compact_from) {
+      trim_compact_from = first_committed;
+    }
+    if (end - trim_compact_from >= g_conf()->mon_compact_on_trim_min_versions) {
+      dout(10) << " compacting trimmed range" << dendl;
+      t->compact_range(get_name(), stringify(trim_compact_from - 1),
+		       stringify(end));
+      trim_compact_from = 0;
+    }
   }
 
   trimming = true;
@@ -626,6 +626,12 @@ private:
    */
   bool trimming;
 
+  /**
+   * first version trimmed since the trimmed versions were last compacted,
+   * or 0 if there is none
+   */
+  version_t trim_compact_from = 0;
+
   /**
    * true if we want trigger_propose to *not* propose (yet)
    */
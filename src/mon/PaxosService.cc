@@ -258,6 +258,21 @@ void PaxosService::propose_pending()
     }
   };
   paxos.queue_pending_finisher(new C_Committed(this));
+
+  // the pending updates of other services that only wait out their propose
+  // interval go into the same round instead of taking rounds of their own
+  if (g_conf().get_val<bool>("paxos_propose_batch_services") &&
+      !paxos.is_plugged()) {
+    paxos.plug();
+    for (auto& svc : mon.paxos_service) {
+      if (svc.get() != this && svc->proposal_timer && svc->have_pending &&
+          svc->is_active()) {
+        dout(10) << " batching pending " << svc->get_service_name() << dendl;
+        svc->propose_pending();
+      }
+    }
+    paxos.unplug();
+  }
   paxos.trigger_propose();
 }
 
@@ -458,11 +473,20 @@ void PaxosService::trim(MonitorDBStore::TransactionRef t,
     }
   }
   if (g_conf()->mon_compact_on_trim) {
-    dout(20) << " compacting prefix " << get_service_name() << dendl;
-    t->compact_range(get_service_name(), stringify(from - 1), stringify(to));
-    t->compact_range(get_service_name(),
-		     mon.store->combine_strings(full_prefix_name, from - 1),
-		     mon.store->combine_strings(full_prefix_name, to));
+    // let the tombstones of a few trims add up, and compact them at once
+    if (!trim_compact_from) {
+      trim_compact_from = from;
+    }
+    if (to - trim_compact_from >= g_conf()->mon_compact_on_trim_min_versions) {
+      dout(20) << " compacting prefix " << get_service_name() << dendl;
+      t->compact_range(get_service_name(), stringify(trim_compact_from - 1),
+		       stringify(to));
+      t->compact_range(get_service_name(),
+		       mon.store->combine_strings(full_prefix_name,
+						  trim_compact_from - 1),
+		       mon.store->combine_strings(full_prefix_name, to));
+      trim_compact_from = 0;
+    }
   }
 }
 
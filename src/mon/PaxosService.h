@@ -479,6 +479,12 @@ public:
    * @}
    */
 
+  /**
+   * first version trimmed since the trimmed versions were last compacted,
+   * or 0 if there is none
+   */
+  version_t trim_compact_from = 0;
+
   /**
    * Callback list to be used for waiting for the next proposal to commit.
    */
@@ -98,6 +98,26 @@ void DispatchQueue::enqueue(const ref_t<Message>& m, int priority, uint64_t id)
   cond.notify_one();
 }
 
+void DispatchQueue::enqueue(std::vector<ref_t<Message>>&& ms, uint64_t id)
+{
+  std::lock_guard l{lock};
+  if (stop) {
+    return;
+  }
+  for (auto& m : ms) {
+    int priority = m->get_priority();
+    ldout(cct,20) << "queue " << m << " prio " << priority << dendl;
+    QueueItem item{m};
+    add_arrival(item);
+    if (priority >= CEPH_MSG_PRIO_LOW) {
+      mqueue.enqueue_strict(id, priority, std::move(item));
+    } else {
+      mqueue.enqueue(id, priority, m->get_cost(), std::move(item));
+    }
+  }
+  cond.notify_one();
+}
+
 void DispatchQueue::local_delivery(const ref_t<Message>& m, int priority)
 {
   auto local_delivery_stamp = ceph_clock_now();
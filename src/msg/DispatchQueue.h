@@ -19,6 +19,7 @@
 #include <atomic>
 #include <set>
 #include <queue>
+#include <vector>
 #include <boost/intrusive_ptr.hpp>
 #include "include/ceph_assert.h"
 #include "include/common_fwd.h"
@@ -208,6 +209,8 @@ class DispatchQueue {
   void enqueue(Message* m, int priority, uint64_t id) {
     return enqueue(ceph::ref_t<Message>(m, false), priority, id); /* consume ref */
   }
+  /// queue messages received together on a connection, in order, at once
+  void enqueue(std::vector<ceph::ref_t<Message>>&& ms, uint64_t id);
   void discard_queue(uint64_t id);
   void discard_local();
   uint64_t get_id() {
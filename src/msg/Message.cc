@@ -71,6 +71,7 @@
 #include "messages/MOSDOpReply.h"
 #include "messages/MOSDRepOp.h"
 #include "messages/MOSDRepOpReply.h"
+#include "messages/MOSDRepOpBatch.h"
 #include "messages/MOSDMap.h"
 #include "messages/MMonGetOSDMap.h"
 #include "messages/MMonGetPurgedSnaps.h"
@@ -85,6 +86,7 @@
 #include "messages/MOSDPGRemove.h"
 #include "messages/MOSDPGInfo.h"
 #include "messages/MOSDPGInfo2.h"
+#include "messages/MOSDPGPeeringBatch.h"
 #include "messages/MOSDPGCreate2.h"
 #include "messages/MOSDPGTrim.h"
 #include "messages/MOSDPGLease.h"
@@ -544,6 +546,9 @@ Message *decode_message(CephContext *cct,
   case MSG_OSD_REPOPREPLY:
     m = make_message<MOSDRepOpReply>();
     break;
+  case MSG_OSD_REPOP_BATCH:
+    m = make_message<MOSDRepOpBatch>();
+    break;
   case MSG_OSD_PG_CREATED:
     m = make_message<MOSDPGCreated>();
     break;
@@ -592,6 +597,9 @@ Message *decode_message(CephContext *cct,
   case MSG_OSD_PG_INFO2:
     m = make_message<MOSDPGInfo2>();
     break;
+  case MSG_OSD_PG_PEERING_BATCH:
+    m = make_message<MOSDPGPeeringBatch>();
+    break;
   case MSG_OSD_PG_CREATE2:
     m = make_message<MOSDPGCreate2>();
     break;
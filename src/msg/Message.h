@@ -102,6 +102,7 @@
 #define MSG_OSD_PG_REMOVE      84
 #define MSG_OSD_PG_INFO        85
 #define MSG_OSD_PG_INFO2      132
+#define MSG_OSD_PG_PEERING_BATCH 125
 #define MSG_OSD_PG_TRIM        86
 
 #define MSG_PGSTATS            87
@@ -136,6 +137,7 @@
 
 #define MSG_OSD_REPOP         112
 #define MSG_OSD_REPOPREPLY    113
+#define MSG_OSD_REPOP_BATCH   124
 #define MSG_OSD_PG_UPDATE_LOG_MISSING  114
 #define MSG_OSD_PG_UPDATE_LOG_MISSING_REPLY  115
 
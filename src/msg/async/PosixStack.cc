@@ -20,8 +20,13 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
 
 #include <algorithm>
+#include <deque>
+#include <limits>
 
 #include "PosixStack.h"
 
@@ -38,16 +43,47 @@
 #undef dout_prefix
 #define dout_prefix *_dout << "PosixStack "
 
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define HAVE_MSG_ZEROCOPY
+#endif
+
 class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   ceph::NetHandler &handler;
   int _fd;
   entity_addr_t sa;
   bool connected;
+  PerfCounters *logger;
+
+  // MSG_ZEROCOPY state: every successful zerocopy sendmsg() is numbered by
+  // the kernel, and the pages it referenced must stay alive until that
+  // number is reported back on the socket error queue.
+  size_t zerocopy_min_bytes = 0;  // 0 means disabled
+  uint32_t zerocopy_next_id = 0;
+  std::deque<std::pair<uint32_t, ceph::buffer::list>> zerocopy_pending;
+  uint64_t zerocopy_pending_bytes = 0;
 
  public:
   explicit PosixConnectedSocketImpl(ceph::NetHandler &h, const entity_addr_t &sa,
-				    int f, bool connected)
-      : handler(h), _fd(f), sa(sa), connected(connected) {}
+				    int f, bool connected,
+				    CephContext *cct = nullptr,
+				    PerfCounters *logger = nullptr)
+      : handler(h), _fd(f), sa(sa), connected(connected), logger(logger) {
+#ifdef HAVE_MSG_ZEROCOPY
+    if (cct && cct->_conf.get_val<bool>("ms_tcp_zerocopy")) {
+      int on = 1;
+      if (::setsockopt(_fd, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) == 0) {
+	zerocopy_min_bytes = std::max<size_t>(
+	  1, cct->_conf.get_val<Option::size_t>("ms_tcp_zerocopy_min_bytes"));
+      } else {
+	ldout(cct, 5) << __func__ << " SO_ZEROCOPY unavailable: "
+		      << cpp_strerror(ceph_sock_errno()) << dendl;
+      }
+    }
+#endif
+  }
+  ~PosixConnectedSocketImpl() override {
+    zerocopy_release(std::numeric_limits<uint64_t>::max());
+  }
 
   int is_connected() override {
     if (connected)
@@ -65,6 +101,10 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
 
   ssize_t read(char *buf, size_t len) override {
+    // completions raise EPOLLERR, which wakes us up as readable
+    if (!zerocopy_pending.empty()) {
+      zerocopy_reap();
+    }
     #ifdef _WIN32
     ssize_t r = ::recv(_fd, buf, len, 0);
     #else
@@ -75,16 +115,70 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
     return r;
   }
 
+  // drop the references held for the oldest pending zerocopy sends, up to
+  // @upto bytes or everything
+  void zerocopy_release(uint64_t upto) {
+    while (!zerocopy_pending.empty() && upto > 0) {
+      uint64_t len = zerocopy_pending.front().second.length();
+      upto -= std::min(upto, len);
+      zerocopy_pending_bytes -= len;
+      if (logger) {
+	logger->dec(l_msgr_send_zerocopy_pending, len);
+      }
+      zerocopy_pending.pop_front();
+    }
+  }
+
+  // consume zerocopy completion notifications from the error queue
+  void zerocopy_reap() {
+#ifdef HAVE_MSG_ZEROCOPY
+    while (!zerocopy_pending.empty()) {
+      char control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+      struct msghdr msg;
+      // FIPS zeroization audit 20191115: this memset is not security related.
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      if (::recvmsg(_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+	return;  // EAGAIN: nothing (more) completed yet
+      }
+      for (auto cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+	if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+	      (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) {
+	  continue;
+	}
+	auto serr = reinterpret_cast<struct sock_extended_err*>(CMSG_DATA(cm));
+	if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+	  continue;
+	}
+	if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+	  // the kernel copied anyway (loopback, no sg support, ...): stop
+	  // paying for the notifications on this socket
+	  zerocopy_min_bytes = 0;
+	}
+	// [ee_info, ee_data] is the (inclusive) range of completed sends;
+	// tcp completes them in order
+	uint32_t hi = serr->ee_data;
+	while (!zerocopy_pending.empty() &&
+	       (int32_t)(zerocopy_pending.front().first - hi) <= 0) {
+	  zerocopy_release(zerocopy_pending.front().second.length());
+	}
+      }
+    }
+#endif
+  }
+
   // return the sent length
   // < 0 means error occurred
   #ifndef _WIN32
-  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more)
+  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more,
+			    int flags = 0, unsigned *calls = nullptr)
   {
     size_t sent = 0;
     while (1) {
       MSGR_SIGPIPE_STOPPER;
       ssize_t r;
-      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0) | flags);
       if (r < 0) {
         int err = ceph_sock_errno();
         if (err == EINTR) {
@@ -95,6 +189,9 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
         return -err;
       }
 
+      if (calls) {
+	++*calls;
+      }
       sent += r;
       if (len == sent) break;
 
@@ -115,7 +212,12 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
 
   ssize_t send(ceph::buffer::list &bl, bool more) override {
+    if (!zerocopy_pending.empty()) {
+      zerocopy_reap();
+    }
     size_t sent_bytes = 0;
+    size_t zerocopy_bytes = 0;
+    unsigned zerocopy_calls = 0;
     auto pb = std::cbegin(bl.buffers());
     uint64_t left_pbrs = bl.get_num_buffers();
     while (left_pbrs) {
@@ -134,12 +236,30 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
 	msglen += pb->length();
 	++pb;
       }
-      ssize_t r = do_sendmsg(_fd, msg, msglen, left_pbrs || more);
-      if (r < 0)
-        return r;
+      int flags = 0;
+#ifdef HAVE_MSG_ZEROCOPY
+      // zerocopy is per call, so only the leading part of @bl up to the
+      // last zerocopy batch has to be kept alive
+      if (zerocopy_min_bytes && msglen >= zerocopy_min_bytes &&
+	  zerocopy_bytes == sent_bytes) {
+	flags |= MSG_ZEROCOPY;
+      }
+#endif
+      ssize_t r = do_sendmsg(_fd, msg, msglen, left_pbrs || more, flags,
+			     flags ? &zerocopy_calls : nullptr);
+      if (r < 0) {
+        if (zerocopy_bytes == 0) {
+          return r;
+        }
+        // the bytes already handed over still need their buffers pinned
+        break;
+      }
 
       // "r" is the remaining length
       sent_bytes += r;
+      if (flags) {
+        zerocopy_bytes = sent_bytes;
+      }
       if (static_cast<unsigned>(r) < msglen)
         break;
       // only "r" == 0 continue
@@ -151,7 +271,22 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
         bl.splice(sent_bytes, bl.length()-sent_bytes, &swapped);
         bl.swap(swapped);
       } else {
-        bl.clear();
+        swapped.swap(bl);
+      }
+      // "swapped" now holds what was sent
+      if (zerocopy_calls) {
+        ceph::buffer::list pinned;
+        swapped.splice(0, zerocopy_bytes, &pinned);
+        zerocopy_next_id += zerocopy_calls;
+        zerocopy_pending.emplace_back(zerocopy_next_id - 1, std::move(pinned));
+        zerocopy_pending_bytes += zerocopy_bytes;
+      }
+      if (logger) {
+        logger->inc(l_msgr_send_zerocopy_bytes, zerocopy_bytes);
+        logger->inc(l_msgr_send_copy_bytes, sent_bytes - zerocopy_bytes);
+        if (zerocopy_calls) {
+          logger->inc(l_msgr_send_zerocopy_pending, zerocopy_bytes);
+        }
       }
     }
 
@@ -206,6 +341,9 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
   void close() override {
     compat_closesocket(_fd);
+    // the kernel keeps its own page references; nothing will read the
+    // error queue any more
+    zerocopy_release(std::numeric_limits<uint64_t>::max());
   }
   void set_priority(int sd, int prio, int domain) override {
     handler.set_priority(sd, prio, domain);
@@ -263,7 +401,9 @@ int PosixServerSocketImpl::accept(ConnectedSocket *sock, const SocketOptions &op
   out->set_sockaddr((sockaddr*)&ss);
   handler.set_priority(sd, opt.priority, out->get_family());
 
-  std::unique_ptr<PosixConnectedSocketImpl> csi(new PosixConnectedSocketImpl(handler, *out, sd, true));
+  std::unique_ptr<PosixConnectedSocketImpl> csi(
+    new PosixConnectedSocketImpl(handler, *out, sd, true, w->cct,
+				 w->get_perf_counter()));
   *sock = ConnectedSocket(std::move(csi));
   return 0;
 }
@@ -332,7 +472,9 @@ int PosixWorker::connect(const entity_addr_t &addr, const SocketOptions &opts, C
 
   net.set_priority(sd, opts.priority, addr.get_family());
   *socket = ConnectedSocket(
-      std::unique_ptr<PosixConnectedSocketImpl>(new PosixConnectedSocketImpl(net, addr, sd, !opts.nonblock)));
+      std::unique_ptr<PosixConnectedSocketImpl>(
+	new PosixConnectedSocketImpl(net, addr, sd, !opts.nonblock, cct,
+				     get_perf_counter())));
   return 0;
 }
 
@@ -58,6 +58,9 @@ void ProtocolV2::run_continuation(CtRef continuation) {
   } catch (const DecryptionError &) {
     lderr(cct) << __func__ << " failed to decrypt frame payload" << dendl;
   }
+  // the continuations stop once they wait for the socket: queue what was
+  // read until then
+  flush_dispatch_batch();
 }
 
 #define WRITE(B, D, C) write(D, CONTINUATION(C), B)
@@ -144,6 +147,17 @@ void ProtocolV2::discard_out_queue() {
   write_in_progress = false;
 }
 
+void ProtocolV2::flush_dispatch_batch() {
+  if (dispatch_batch.empty()) {
+    return;
+  }
+  ldout(cct, 20) << __func__ << " " << dispatch_batch.size() << " messages"
+                 << dendl;
+  connection->dispatch_queue->enqueue(std::move(dispatch_batch),
+                                      connection->conn_id);
+  dispatch_batch.clear();
+}
+
 void ProtocolV2::reset_session() {
   ldout(cct, 1) << __func__ << dendl;
 
@@ -151,6 +165,7 @@ void ProtocolV2::reset_session() {
   if (connection->delay_state) {
     connection->delay_state->discard();
   }
+  flush_dispatch_batch();
 
   connection->dispatch_queue->discard_queue(connection->conn_id);
   discard_out_queue();
@@ -176,6 +191,7 @@ void ProtocolV2::stop() {
   }
 
   if (connection->delay_state) connection->delay_state->flush();
+  flush_dispatch_batch();
 
   std::lock_guard<std::mutex> l(connection->write_lock);
 
@@ -318,6 +334,9 @@ void ProtocolV2::reset_throttle() {
 CtPtr ProtocolV2::_fault() {
   ldout(cct, 10) << __func__ << dendl;
 
+  // what was received before the fault is dispatched before the reset
+  flush_dispatch_batch();
+
   if (state == CLOSED || state == NONE) {
     ldout(cct, 10) << __func__ << " connection is already closed" << dendl;
     return nullptr;
@@ -1544,6 +1563,8 @@ CtPtr ProtocolV2::handle_message() {
     }
     connection->delay_state->queue(delay_period, message);
   } else if (messenger->ms_can_fast_dispatch(message)) {
+    // the connection may be reused while it is unlocked
+    flush_dispatch_batch();
     connection->lock.unlock();
     connection->dispatch_queue->fast_dispatch(message);
     connection->recv_start_time = ceph::mono_clock::now();
@@ -1557,8 +1578,7 @@ CtPtr ProtocolV2::handle_message() {
       return nullptr;
     }
   } else {
-    connection->dispatch_queue->enqueue(message, message->get_priority(),
-                                        connection->conn_id);
+    dispatch_batch.emplace_back(message, false); /* consume ref */
   }
 
   handle_message_ack(current_header.ack_seq);
@@ -101,6 +101,11 @@ private:
   std::map<int, std::list<out_queue_entry_t>, std::greater<int>> out_queue;
 
   std::list<Message *> sent;
+  /**
+   * Received messages for the dispatch queue, queued at once when the
+   * frames already read are handled.
+   */
+  std::vector<ceph::ref_t<Message>> dispatch_batch;
   std::atomic<uint64_t> out_seq{0};
   std::atomic<uint64_t> in_seq{0};
   std::atomic<uint64_t> ack_left{0};
@@ -153,6 +158,7 @@ private:
   void reset_throttle();
   Ct<ProtocolV2> *_fault();
   void discard_out_queue();
+  void flush_dispatch_batch();
   void reset_session();
   void prepare_send_message(uint64_t features, Message *m);
   out_queue_entry_t _get_next_outgoing();
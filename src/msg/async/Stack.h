@@ -225,6 +225,10 @@ enum {
   l_msgr_recv_encrypted_bytes,
   l_msgr_send_encrypted_bytes,
 
+  l_msgr_send_zerocopy_bytes,
+  l_msgr_send_copy_bytes,
+  l_msgr_send_zerocopy_pending,
+
   l_msgr_last,
 };
 
@@ -283,6 +287,10 @@ class Worker {
     plb.add_u64_counter(l_msgr_recv_encrypted_bytes, "msgr_recv_encrypted_bytes", "Network received encrypted bytes", NULL, 0, unit_t(UNIT_BYTES));
     plb.add_u64_counter(l_msgr_send_encrypted_bytes, "msgr_send_encrypted_bytes", "Network sent encrypted bytes", NULL, 0, unit_t(UNIT_BYTES));
 
+    plb.add_u64_counter(l_msgr_send_zerocopy_bytes, "msgr_send_zerocopy_bytes", "Network bytes sent with MSG_ZEROCOPY", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_u64_counter(l_msgr_send_copy_bytes, "msgr_send_copy_bytes", "Network bytes sent by copying into the socket buffer", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_u64(l_msgr_send_zerocopy_pending, "msgr_send_zerocopy_pending", "Bytes sent with MSG_ZEROCOPY awaiting kernel completion", NULL, 0, unit_t(UNIT_BYTES));
+
     perf_logger = plb.create_perf_counters();
     cct->get_perfcounters_collection()->add(perf_logger);
 
@@ -10,6 +10,7 @@
 #include <openssl/evp.h>
 
 #include <array>
+#include <cstring>
 #include <numeric> // for std::accumulate()
 
 #define dout_subsys ceph_subsys_ms
@@ -118,19 +119,45 @@ void AES128GCM_OnWireTxHandler::authenticated_encrypt_update(
               plaintext.length());
   auto filler = buffer.append_hole(plaintext.length());
 
-  for (const auto& plainbuf : plaintext.buffers()) {
+  auto encrypt = [this, &filler](const char* in, unsigned len) {
     int update_len = 0;
 
     if(1 != EVP_EncryptUpdate(ectx.get(),
 	reinterpret_cast<unsigned char*>(filler.c_str()),
 	&update_len,
-	reinterpret_cast<const unsigned char*>(plainbuf.c_str()),
-	plainbuf.length())) {
+	reinterpret_cast<const unsigned char*>(in),
+	len)) {
       throw std::runtime_error("EVP_EncryptUpdate failed");
     }
     ceph_assert_always(update_len >= 0);
-    ceph_assert(static_cast<unsigned>(update_len) == plainbuf.length());
+    ceph_assert(static_cast<unsigned>(update_len) == len);
     filler.advance(update_len);
+  };
+
+  // every EVP_EncryptUpdate() call has a fixed cost, which dominates for
+  // the small buffers of encoded headers and such. runs of small buffers
+  // are copied to the output first and encrypted in place with one call
+  static constexpr unsigned SMALL_BUFFER_LEN = 512;
+  char* run = nullptr;
+  unsigned run_len = 0;
+  for (const auto& plainbuf : plaintext.buffers()) {
+    if (plainbuf.length() < SMALL_BUFFER_LEN) {
+      if (!run) {
+        run = filler.c_str();
+      }
+      std::memcpy(run + run_len, plainbuf.c_str(), plainbuf.length());
+      run_len += plainbuf.length();
+      continue;
+    }
+    if (run) {
+      encrypt(run, run_len);
+      run = nullptr;
+      run_len = 0;
+    }
+    encrypt(plainbuf.c_str(), plainbuf.length());
+  }
+  if (run) {
+    encrypt(run, run_len);
   }
 
   ldout(cct, 15) << __func__
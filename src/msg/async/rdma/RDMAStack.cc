@@ -602,7 +602,6 @@ void RDMADispatcher::handle_rx_event(ibv_wc *cqe, int rx_number)
           ib->post_chunk_to_pool(chunk);
           perf_logger->dec(l_msgr_rdma_rx_bufs_in_use);
         } else {
-          conn->post_chunks_to_rq(1);
           polled[conn].push_back(*response);
 
           if (qp != nullptr && !qp->get_srq()) {
@@ -651,8 +650,12 @@ void RDMADispatcher::handle_rx_event(ibv_wc *cqe, int rx_number)
     }
   }
 
-  for (auto &i : polled)
+  // replace the consumed receive buffers with one post per connection
+  // rather than one per completion
+  for (auto &i : polled) {
+    i.first->post_chunks_to_rq(i.second.size());
     i.first->pass_wc(std::move(i.second));
+  }
   polled.clear();
 }
 
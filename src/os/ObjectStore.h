@@ -444,6 +444,17 @@ public:
    * @returns true if object exists, false otherwise
    */
   virtual bool exists(CollectionHandle& c, const ghobject_t& oid) = 0;
+  /**
+   * prefetch_object -- hint that an object will be accessed soon
+   *
+   * Lets the store start loading the object's metadata and attributes in
+   * the background, so that the access finds them cached.  Advisory only;
+   * the default implementation ignores it.
+   *
+   * @param cid collection for object
+   * @param oid oid of object
+   */
+  virtual void prefetch_object(CollectionHandle& c, const ghobject_t& oid) {}
   /**
    * set_collection_opts -- std::set pool options for a collectioninformation for an object
    *
@@ -564,6 +575,26 @@ public:
      return total;
    }
 
+  /**
+   * get_locality_hints -- tell roughly where each object's data lives
+   *
+   * Fills hints with one value per object such that reading the objects
+   * in increasing hint order walks the device more or less sequentially.
+   * The values are only meaningful relative to each other.  Objects
+   * without data, or that do not exist, get UINT64_MAX.
+   *
+   * @param cid collection for objects
+   * @param oids objects to locate
+   * @param hints output, one entry per element of oids
+   * @returns 0 on success, -EOPNOTSUPP if the store cannot tell
+   */
+   virtual int get_locality_hints(
+     CollectionHandle &c,
+     const std::vector<ghobject_t>& oids,
+     std::vector<uint64_t> *hints) {
+     return -EOPNOTSUPP;
+   }
+
   /**
    * dump_onode -- dumps onode metadata in human readable form,
      intended primiarily for debugging
@@ -4,6 +4,7 @@
 #include "BitmapFreelistManager.h"
 
 #include <bit>
+#include <limits>
 #include "kv/KeyValueDB.h"
 #include "os/kv.h"
 #include "include/stringify.h"
@@ -473,6 +474,94 @@ bool BitmapFreelistManager::enumerate_next(KeyValueDB *kvdb, uint64_t *offset, u
   return false;
 }
 
+void BitmapFreelistManager::enumerate_range(
+  KeyValueDB *kvdb,
+  uint64_t offset, uint64_t length,
+  std::function<void(uint64_t, uint64_t)> cb)
+{
+  uint64_t end = std::min(offset + length, get_alloc_units() * bytes_per_block);
+  if (offset >= end) {
+    return;
+  }
+  dout(10) << __func__ << std::hex << " 0x" << offset << "~" << (end - offset)
+	   << std::dec << dendl;
+
+  // merge adjacent free runs, including those spanning key boundaries
+  uint64_t run_start = 0, run_end = 0;
+  auto note_free = [&](uint64_t s, uint64_t e) {
+    s = std::max(s, offset);
+    e = std::min(e, end);
+    if (s >= e) {
+      return;
+    }
+    if (run_end == s && run_end > run_start) {
+      run_end = e;
+      return;
+    }
+    if (run_end > run_start) {
+      cb(run_start, run_end - run_start);
+    }
+    run_start = s;
+    run_end = e;
+  };
+
+  uint64_t key_off = offset & key_mask;
+  KeyValueDB::Iterator it = kvdb->get_iterator(bitmap_prefix);
+  {
+    string k;
+    make_offset_key(key_off, &k);
+    it->lower_bound(k);
+  }
+  for (; key_off < end; key_off += bytes_per_key) {
+    uint64_t next_key = std::numeric_limits<uint64_t>::max();
+    if (it->valid()) {
+      string k = it->key();
+      _key_decode_u64(k.c_str(), &next_key);
+    }
+    if (next_key != key_off) {
+      // no key means all blocks in it are free
+      note_free(key_off, key_off + bytes_per_key);
+      continue;
+    }
+    bufferlist bl = it->value();
+    int pos = 0;
+    while (true) {
+      int s = get_next_clear_bit(bl, pos);
+      if (s < 0) {
+	break;
+      }
+      int e = get_next_set_bit(bl, s);
+      if (e < 0) {
+	e = blocks_per_key;
+      }
+      note_free(_get_offset(key_off, s), _get_offset(key_off, e));
+      pos = e;
+    }
+    it->next();
+  }
+  if (run_end > run_start) {
+    cb(run_start, run_end - run_start);
+  }
+}
+
+void BitmapFreelistManager::set_dirty_region_tracking(
+  const std::string& prefix,
+  uint64_t region_size)
+{
+  dirty_prefix = prefix;
+  dirty_region_size = 0;
+  dirty_region_bl.clear();
+  if (!prefix.empty()) {
+    ceph_assert(region_size > 0);
+    dirty_region_size = std::max<uint64_t>(std::bit_ceil(region_size),
+					   bytes_per_key);
+    encode(dirty_region_size, dirty_region_bl);
+  }
+  dout(1) << __func__ << " prefix " << prefix
+	  << " region_size 0x" << std::hex << dirty_region_size << std::dec
+	  << dendl;
+}
+
 void BitmapFreelistManager::dump(KeyValueDB *kvdb)
 {
   enumerate_reset();
@@ -491,6 +580,7 @@ void BitmapFreelistManager::allocate(
 	   << std::dec << dendl;
   if (!is_null_manager()) {
     _xor(offset, length, txn);
+    _note_dirty(offset, length, txn);
   }
 }
 
@@ -502,6 +592,7 @@ void BitmapFreelistManager::release(
 	   << std::dec << dendl;
   if (!is_null_manager()) {
     _xor(offset, length, txn);
+    _note_dirty(offset, length, txn);
   }
 }
 
@@ -585,6 +676,25 @@ void BitmapFreelistManager::_xor(
   }
 }
 
+void BitmapFreelistManager::_note_dirty(
+  uint64_t offset, uint64_t length,
+  KeyValueDB::Transaction txn)
+{
+  if (dirty_prefix.empty()) {
+    return;
+  }
+  // The region key goes into every transaction that touches the region
+  // rather than once per region: concurrent transactions may commit in
+  // any order, and each must be self-describing on its own.
+  uint64_t last = p2align(offset + length - 1, dirty_region_size);
+  for (uint64_t r = p2align(offset, dirty_region_size); r <= last;
+       r += dirty_region_size) {
+    string k;
+    make_offset_key(r, &k);
+    txn->set(dirty_prefix, k, dirty_region_bl);
+  }
+}
+
 uint64_t BitmapFreelistManager::size_2_block_count(uint64_t target_size) const
 {
   auto target_blocks = target_size / bytes_per_block;
@@ -34,6 +34,10 @@ class BitmapFreelistManager : public FreelistManager {
   ceph::buffer::list enumerate_bl;   ///< current key at enumerate_offset
   int enumerate_bl_pos;      ///< bit position in enumerate_bl
 
+  std::string dirty_prefix;     ///< where touched regions are recorded
+  uint64_t dirty_region_size = 0;
+  ceph::buffer::list dirty_region_bl; ///< encoded dirty_region_size
+
   uint64_t _get_offset(uint64_t key_off, int bit) {
     return key_off + bit * bytes_per_block;
   }
@@ -43,6 +47,9 @@ class BitmapFreelistManager : public FreelistManager {
   void _xor(
     uint64_t offset, uint64_t length,
     KeyValueDB::Transaction txn);
+  void _note_dirty(
+    uint64_t offset, uint64_t length,
+    KeyValueDB::Transaction txn);
 
   int _read_cfg(
     std::function<int(const std::string&, std::string*)> cfg_reader);
@@ -75,6 +82,12 @@ public:
 
   void enumerate_reset() override;
   bool enumerate_next(KeyValueDB *kvdb, uint64_t *offset, uint64_t *length) override;
+  void enumerate_range(KeyValueDB *kvdb,
+    uint64_t offset, uint64_t length,
+    std::function<void(uint64_t, uint64_t)> cb) override;
+
+  void set_dirty_region_tracking(const std::string& prefix,
+    uint64_t region_size) override;
 
   void allocate(
     uint64_t offset, uint64_t length,
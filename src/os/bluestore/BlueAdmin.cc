@@ -49,6 +49,11 @@ BlueStore::SocketHook::SocketHook(BlueStore& store)
       this,
       "print compression stats, per collection");
     ceph_assert(r == 0);
+    r = admin_socket->register_command(
+      "bluestore startup timings",
+      this,
+      "print time spent in each step of the last mount");
+    ceph_assert(r == 0);
   }
 }
 
@@ -177,6 +182,17 @@ int BlueStore::SocketHook::call(
     }
     f->close_section();
     return 0;
+  } else if (command == "bluestore startup timings") {
+    std::lock_guard l(store.startup_timings_lock);
+    f->open_array_section("startup_timings");
+    for (const auto& [phase, elapsed] : store.startup_timings) {
+      f->open_object_section("phase");
+      f->dump_string("name", phase);
+      f->dump_float("seconds", std::chrono::duration<double>(elapsed).count());
+      f->close_section();
+    }
+    f->close_section();
+    return 0;
   } else {
     ss << "Invalid command" << std::endl;
     r = -ENOSYS;
@@ -459,6 +459,13 @@ void BlueFS::_init_logger()
                 "Average allocation latency for primary/shared device",
                 "bsal",
                 PerfCountersBuilder::PRIO_USEFUL);
+  b.add_time_avg(l_bluefs_log_replay_lat, "log_replay_lat",
+                "Time spent replaying the bluefs log on mount");
+  b.add_u64(l_bluefs_log_replay_txns, "log_replay_txns",
+	    "Transactions replayed from the bluefs log on last mount");
+  b.add_u64(l_bluefs_log_replay_bytes, "log_replay_bytes",
+	    "Bytes replayed from the bluefs log on last mount",
+	    nullptr, 0, unit_t(UNIT_BYTES));
 
   logger = b.create_perf_counters();
   cct->get_perfcounters_collection()->add(logger);
@@ -1350,8 +1357,11 @@ int BlueFS::_verify_alloc_granularity(
 int BlueFS::_replay(bool noop, bool to_stdout)
 {
   dout(10) << __func__ << (noop ? " NO-OP" : "") << dendl;
+  auto replay_start = mono_clock::now();
   ino_last = 1;  // by the log
   uint64_t log_seq = 0;
+  uint64_t replay_txns = 0;
+  uint64_t replay_bytes = 0;
 
   FileRef log_file;
   log_file = _get_file(1);
@@ -1366,8 +1376,13 @@ int BlueFS::_replay(bool noop, bool to_stdout)
     std::cout << " log_fnode " << super.log_fnode << std::endl;
   } 
 
+  // The log is read strictly sequentially, so read ahead in large chunks:
+  // a single big read lets the device work on many requests at once
+  // instead of waiting on each max_prefetch sized one.
   FileReader *log_reader = new FileReader(
-    log_file, cct->_conf->bluefs_max_prefetch,
+    log_file,
+    std::max<uint64_t>(cct->_conf->bluefs_max_prefetch,
+      cct->_conf.get_val<Option::size_t>("bluefs_replay_prefetch")),
     true);  // ignore eof
 
   bool seen_recs = false;
@@ -1479,6 +1494,8 @@ int BlueFS::_replay(bool noop, bool to_stdout)
       auto p = bl.cbegin();
       decode(t, p);
       seen_recs = true;
+      ++replay_txns;
+      replay_bytes += bl.length();
     }
     catch (ceph::buffer::error& e) {
       // Multi-block transactions might be incomplete due to unexpected
@@ -1888,7 +1905,13 @@ int BlueFS::_replay(bool noop, bool to_stdout)
   // reflect file count in logger
   logger->set(l_bluefs_num_files, nodes.file_map.size());
 
-  dout(10) << __func__ << " done" << dendl;
+  last_replay_duration = mono_clock::now() - replay_start;
+  logger->tinc(l_bluefs_log_replay_lat, last_replay_duration);
+  logger->set(l_bluefs_log_replay_txns, replay_txns);
+  logger->set(l_bluefs_log_replay_bytes, replay_bytes);
+  dout(10) << __func__ << " done, " << replay_txns << " txns, 0x"
+	   << std::hex << replay_bytes << std::dec << " bytes in "
+	   << last_replay_duration << dendl;
   return 0;
 }
 
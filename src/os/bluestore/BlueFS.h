@@ -87,6 +87,9 @@ enum {
   l_bluefs_wal_alloc_lat,
   l_bluefs_db_alloc_lat,
   l_bluefs_slow_alloc_lat,
+  l_bluefs_log_replay_lat,
+  l_bluefs_log_replay_txns,
+  l_bluefs_log_replay_bytes,
   l_bluefs_last,
 };
 
@@ -564,6 +567,7 @@ private:
 
   bluefs_super_t super;        ///< latest superblock (as last written)
   uint64_t ino_last = 0;       ///< last assigned ino (this one is in use)
+  ceph::timespan last_replay_duration = ceph::timespan::zero(); ///< of the last _replay()
   bool conf_wal_envelope_mode = false; ///< conf "bluefs_wal_envelope_mode" at mount
 
   struct {
@@ -784,6 +788,10 @@ public:
   // the super is always stored on bdev 0
   int mkfs(uuid_d osd_uuid, const bluefs_layout_t& layout);
   int mount();
+  /// wall time the last mount spent replaying the log
+  ceph::timespan get_last_replay_duration() const {
+    return last_replay_duration;
+  }
   int maybe_verify_layout(const bluefs_layout_t& layout) const;
   void umount(bool avoid_compact = false);
   int prepare_new_device(int id, const bluefs_layout_t& layout);
@@ -22,6 +22,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <algorithm>
+#include <cmath>
 
 #include <boost/container/flat_set.hpp>
 #include <boost/algorithm/string.hpp>
@@ -139,6 +140,7 @@ const string PREFIX_PERPG_OMAP = "p";   // u64(pool) + u32(hash) + u64(id) + key
 const string PREFIX_DEFERRED = "L";    // id -> deferred_transaction_t
 const string PREFIX_ALLOC = "B";       // u64 offset -> u64 length (freelist)
 const string PREFIX_ALLOC_BITMAP = "b";// (see BitmapFreelistManager)
+const string PREFIX_ALLOC_DIRTY = "D"; // u64 offset -> u64 length (regions changed since snapshot)
 const string PREFIX_SHARED_BLOB = "X"; // u64 SB id -> shared_blob_t
 
 const string BLUESTORE_GLOBAL_STATFS_KEY = "bluestore_statfs";
@@ -5274,7 +5276,15 @@ BlueStore::OnodeRef BlueStore::Collection::get_onode(
   int r = -ENOENT;
   Onode *on;
   if (!is_createop) {
-    r = store->db->get(PREFIX_OBJ, key.c_str(), key.size(), &v);
+    if (store->onode_cold_cache->get(key, &v)) {
+      r = 0;
+      store->logger->inc(l_bluestore_onode_cold_hits);
+    } else {
+      r = store->db->get(PREFIX_OBJ, key.c_str(), key.size(), &v);
+      if (r >= 0 && v.length()) {
+        store->onode_cold_cache->put(key, v);
+      }
+    }
     ldout(store->cct, 20) << " r " << r << " v.len " << v.length() << dendl;
   }
   if (v.length() == 0) {
@@ -5429,6 +5439,7 @@ void *BlueStore::MempoolThread::entry()
     pcm->insert("kv", binned_kv_cache, true);
     pcm->insert("meta", meta_cache, true);
     pcm->insert("data", data_cache, true);
+    pcm->insert("meta_cold", meta_cold_cache, true);
     if (binned_kv_onode_cache != nullptr) {
       pcm->insert("kv_onode", binned_kv_onode_cache, true);
     }
@@ -5490,6 +5501,7 @@ void *BlueStore::MempoolThread::entry()
       }
       meta_cache->set_cache_ratio(store->cache_meta_ratio);
       data_cache->set_cache_ratio(store->cache_data_ratio);
+      meta_cold_cache->set_cache_ratio(store->cache_meta_cold_ratio);
 
       // Log events at 5 instead of 20 when balance happens.
       interval_stats_trim = true;
@@ -5561,6 +5573,7 @@ void BlueStore::MempoolThread::_resize_shards(bool interval_stats)
   int64_t kv_onode_used = store->db->get_cache_usage(PREFIX_OBJ);
   int64_t meta_used = meta_cache->_get_used_bytes();
   int64_t data_used = data_cache->_get_used_bytes();
+  int64_t meta_cold_used = meta_cold_cache->_get_used_bytes();
 
   uint64_t cache_size = store->cache_size;
   int64_t kv_alloc =
@@ -5571,12 +5584,15 @@ void BlueStore::MempoolThread::_resize_shards(bool interval_stats)
      static_cast<int64_t>(store->cache_meta_ratio * cache_size);
   int64_t data_alloc =
      static_cast<int64_t>(store->cache_data_ratio * cache_size);
+  int64_t meta_cold_alloc =
+     static_cast<int64_t>(store->cache_meta_cold_ratio * cache_size);
 
   if (pcm != nullptr && binned_kv_cache != nullptr) {
     cache_size = pcm->get_tuned_mem();
     kv_alloc = binned_kv_cache->get_committed_size();
     meta_alloc = meta_cache->get_committed_size();
     data_alloc = data_cache->get_committed_size();
+    meta_cold_alloc = meta_cold_cache->get_committed_size();
     if (binned_kv_onode_cache != nullptr) {
       kv_onode_alloc = binned_kv_onode_cache->get_committed_size();
     }
@@ -5591,7 +5607,9 @@ void BlueStore::MempoolThread::_resize_shards(bool interval_stats)
                   << " meta_alloc: " << meta_alloc
                   << " meta_used: " << meta_used
                   << " data_alloc: " << data_alloc
-                  << " data_used: " << data_used << dendl;
+                  << " data_used: " << data_used
+                  << " meta_cold_alloc: " << meta_cold_alloc
+                  << " meta_cold_used: " << meta_cold_used << dendl;
   } else {
     dout(20) << __func__  << " cache_size: " << cache_size
                    << " kv_alloc: " << kv_alloc
@@ -5601,7 +5619,9 @@ void BlueStore::MempoolThread::_resize_shards(bool interval_stats)
                    << " meta_alloc: " << meta_alloc
                    << " meta_used: " << meta_used
                    << " data_alloc: " << data_alloc
-                   << " data_used: " << data_used << dendl;
+                   << " data_used: " << data_used
+                   << " meta_cold_alloc: " << meta_cold_alloc
+                   << " meta_cold_used: " << meta_cold_used << dendl;
   }
 
   uint64_t max_shard_onodes = static_cast<uint64_t>(
@@ -5617,6 +5637,7 @@ void BlueStore::MempoolThread::_resize_shards(bool interval_stats)
   for (auto i : store->buffer_cache_shards) {
     i->set_max(max_shard_buffer);
   }
+  store->onode_cold_cache->set_max_bytes(meta_cold_alloc);
 }
 
 void BlueStore::MempoolThread::_update_cache_settings()
@@ -5686,6 +5707,7 @@ BlueStore::BlueStore(CephContext *cct,
   : ObjectStore(cct, path),
     throttle(cct),
     finisher(cct, "commit_finisher", "cfin"),
+    readahead_finisher(cct, "readahead_finisher", "bstore_ra"),
     kv_sync_thread(this),
     kv_finalize_thread(this),
     min_alloc_size(_min_alloc_size),
@@ -5740,6 +5762,10 @@ std::vector<std::string> BlueStore::get_tracked_keys() const noexcept
     "bluestore_deferred_batch_ops"s,
     "bluestore_deferred_batch_ops_hdd"s,
     "bluestore_deferred_batch_ops_ssd"s,
+    "bluestore_deferred_coalesce_max_bytes"s,
+    "bluestore_deferred_coalesce_queue_depth"s,
+    "bluestore_deferred_coalesce_queue_depth_hdd"s,
+    "bluestore_deferred_coalesce_queue_depth_ssd"s,
     "bluestore_throttle_bytes"s,
     "bluestore_throttle_deferred_bytes"s,
     "bluestore_throttle_cost_per_io_hdd"s,
@@ -5764,6 +5790,12 @@ std::vector<std::string> BlueStore::get_tracked_keys() const noexcept
     "bluestore_warn_on_no_per_pool_omap"s,
     "bluestore_warn_on_no_per_pg_omap"s,
     "bluestore_max_defer_interval"s,
+    "bluestore_readahead_max_bytes"s,
+    "bluestore_readahead_min_bytes"s,
+    "bluestore_readahead_trigger_requests"s,
+    "bluestore_readahead_budget_bytes"s,
+    "bluestore_omap_bloom_max_keys"s,
+    "bluestore_omap_bloom_fpp"s,
     "bluestore_onode_segment_size"s,
     "bluestore_allocator_lookup_policy"s,
     "bluestore_volume_selection_reserved_factor"s,
@@ -5810,7 +5842,11 @@ void BlueStore::handle_conf_change(const ConfigProxy& conf,
       changed.count("bluestore_max_alloc_size") ||
       changed.count("bluestore_deferred_batch_ops") ||
       changed.count("bluestore_deferred_batch_ops_hdd") ||
-      changed.count("bluestore_deferred_batch_ops_ssd")) {
+      changed.count("bluestore_deferred_batch_ops_ssd") ||
+      changed.count("bluestore_deferred_coalesce_max_bytes") ||
+      changed.count("bluestore_deferred_coalesce_queue_depth") ||
+      changed.count("bluestore_deferred_coalesce_queue_depth_hdd") ||
+      changed.count("bluestore_deferred_coalesce_queue_depth_ssd")) {
     if (bdev) {
       // only after startup
       _set_alloc_sizes();
@@ -5833,6 +5869,16 @@ void BlueStore::handle_conf_change(const ConfigProxy& conf,
       _set_max_defer_interval();
     }
   }
+  if (changed.count("bluestore_readahead_max_bytes") ||
+      changed.count("bluestore_readahead_min_bytes") ||
+      changed.count("bluestore_readahead_trigger_requests") ||
+      changed.count("bluestore_readahead_budget_bytes")) {
+    _set_readahead();
+  }
+  if (changed.count("bluestore_omap_bloom_max_keys") ||
+      changed.count("bluestore_omap_bloom_fpp")) {
+    _set_omap_bloom();
+  }
   if (changed.count("osd_memory_target") ||
       changed.count("osd_memory_base") ||
       changed.count("osd_memory_cache_min") ||
@@ -5950,6 +5996,33 @@ void BlueStore::_set_throttle_params()
   dout(10) << __func__ << " throttle_cost_per_io " << throttle_cost_per_io
 	   << dendl;
 }
+
+void BlueStore::_set_readahead()
+{
+  readahead_min_bytes =
+    cct->_conf.get_val<Option::size_t>("bluestore_readahead_min_bytes");
+  readahead_budget_bytes =
+    cct->_conf.get_val<Option::size_t>("bluestore_readahead_budget_bytes");
+  readahead_trigger_requests =
+    cct->_conf.get_val<uint64_t>("bluestore_readahead_trigger_requests");
+  // last, so that readers never see it enabled with stale limits
+  readahead_max_bytes =
+    cct->_conf.get_val<Option::size_t>("bluestore_readahead_max_bytes");
+  dout(10) << __func__ << " max 0x" << std::hex << readahead_max_bytes
+	   << " min 0x" << readahead_min_bytes
+	   << " budget 0x" << readahead_budget_bytes << std::dec
+	   << " trigger " << readahead_trigger_requests << dendl;
+}
+
+void BlueStore::_set_omap_bloom()
+{
+  omap_bloom_fpp = cct->_conf.get_val<double>("bluestore_omap_bloom_fpp");
+  omap_bloom_max_keys =
+    cct->_conf.get_val<uint64_t>("bluestore_omap_bloom_max_keys");
+  dout(10) << __func__ << " max_keys " << omap_bloom_max_keys
+	   << " fpp " << omap_bloom_fpp << dendl;
+}
+
 void BlueStore::_set_blob_size()
 {
   if (cct->_conf->bluestore_max_blob_size) {
@@ -6061,11 +6134,21 @@ int BlueStore::_set_cache_sizes()
     return -EINVAL;
   }
 
-  if (cache_meta_ratio + cache_kv_ratio + cache_kv_onode_ratio > 1.0) {
+  cache_meta_cold_ratio = cct->_conf.get_val<double>("bluestore_cache_meta_cold_ratio");
+  if (cache_meta_cold_ratio < 0 || cache_meta_cold_ratio > 1.0) {
+    derr << __func__ << " bluestore_cache_meta_cold_ratio (" << cache_meta_cold_ratio
+         << ") must be in range [0,1.0]" << dendl;
+    return -EINVAL;
+  }
+
+  if (cache_meta_ratio + cache_kv_ratio + cache_kv_onode_ratio +
+      cache_meta_cold_ratio > 1.0) {
     derr << __func__ << " bluestore_cache_meta_ratio (" << cache_meta_ratio
          << ") + bluestore_cache_kv_ratio (" << cache_kv_ratio
          << ") + bluestore_cache_kv_onode_ratio (" << cache_kv_onode_ratio
-         << ") = " << cache_meta_ratio + cache_kv_ratio + cache_kv_onode_ratio << "; must be <= 1.0"
+         << ") + bluestore_cache_meta_cold_ratio (" << cache_meta_cold_ratio
+         << ") = " << cache_meta_ratio + cache_kv_ratio + cache_kv_onode_ratio +
+                      cache_meta_cold_ratio << "; must be <= 1.0"
          << dendl;
     return -EINVAL;
   }
@@ -6073,7 +6156,8 @@ int BlueStore::_set_cache_sizes()
   cache_data_ratio = (double)1.0 - 
                      (double)cache_meta_ratio - 
                      (double)cache_kv_ratio - 
-                     (double)cache_kv_onode_ratio;
+                     (double)cache_kv_onode_ratio -
+                     (double)cache_meta_cold_ratio;
   if (cache_data_ratio < 0) {
     // deal with floating point imprecision
     cache_data_ratio = 0;
@@ -6083,8 +6167,22 @@ int BlueStore::_set_cache_sizes()
           << " meta " << cache_meta_ratio
 	  << " kv " << cache_kv_ratio
 	  << " kv_onode " << cache_kv_onode_ratio
+	  << " meta_cold " << cache_meta_cold_ratio
 	  << " data " << cache_data_ratio
 	  << dendl;
+
+  CompressorRef cold_compressor;
+  auto cold_alg = cct->_conf.get_val<std::string>(
+    "bluestore_cache_meta_cold_compression");
+  if (cold_alg != "none") {
+    cold_compressor = Compressor::create(cct, cold_alg);
+    if (!cold_compressor) {
+      derr << __func__ << " unable to initialize " << cold_alg
+           << " compressor for the cold onode cache, storing uncompressed"
+           << dendl;
+    }
+  }
+  onode_cold_cache->set_compressor(cold_compressor);
   return 0;
 }
 
@@ -6291,9 +6389,18 @@ void BlueStore::_init_logger()
   b.add_time_avg(l_bluestore_kv_sync_lat, "kv_sync_lat",
 		 "Average kv_sync thread latency",
 		 "kscl", PerfCountersBuilder::PRIO_INTERESTING);
+  b.add_time_avg(l_bluestore_kv_submit_lat, "kv_submit_lat",
+		 "Average time to submit a kv_sync batch before its sync commit");
   b.add_time_avg(l_bluestore_kv_final_lat, "kv_final_lat",
 		 "Average kv_finalize thread latency",
 		 "kfll", PerfCountersBuilder::PRIO_INTERESTING);
+  b.add_u64_avg(l_bluestore_kv_group_commit_batch, "kv_group_commit_batch",
+		"Average number of transactions per kv sync commit",
+		"kgcb", PerfCountersBuilder::PRIO_INTERESTING);
+  b.add_time_avg(l_bluestore_kv_group_commit_wait_lat,
+		 "kv_group_commit_wait_lat",
+		 "Average time kv_sync thread waited in the group commit window",
+		 "kgcw", PerfCountersBuilder::PRIO_USEFUL);
   //****************************************
 
   // write op stats
@@ -6357,6 +6464,18 @@ void BlueStore::_init_logger()
 		    NULL,
 		    PerfCountersBuilder::PRIO_DEBUGONLY,
 		    unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluestore_deferred_flush_batches,
+		    "deferred_flush_batches",
+		    "Deferred batches submitted through coalesced flushes");
+  b.add_u64_counter(l_bluestore_deferred_flush_ios,
+		    "deferred_flush_ios",
+		    "Disk writes issued by coalesced deferred flushes");
+  b.add_u64_counter(l_bluestore_deferred_flush_extents,
+		    "deferred_flush_extents",
+		    "Deferred extents merged into coalesced flush writes");
+  b.add_u64_counter(l_bluestore_deferred_flush_held,
+		    "deferred_flush_held",
+		    "Deferred flushes postponed due to device queue depth");
 
   b.add_u64_counter(l_bluestore_write_big_skipped_blobs,
       "write_big_skipped_blobs",
@@ -6412,6 +6531,13 @@ void BlueStore::_init_logger()
   b.add_u64_counter(l_bluestore_onode_shard_misses,
 		    "onode_shard_misses",
 		    "Count of onode shard cache lookups misses");
+  b.add_u64_counter(l_bluestore_onode_cold_hits, "onode_cold_hits",
+		    "Count of onode cache misses served from the cold onode cache");
+  b.add_u64(l_bluestore_onode_cold_entries, "onode_cold_entries",
+	    "Number of encoded onodes in the cold onode cache");
+  b.add_u64(l_bluestore_onode_cold_bytes, "onode_cold_bytes",
+	    "Size of the cold onode cache",
+	    nullptr, 0, unit_t(UNIT_BYTES));
   b.add_u64(l_bluestore_extents, "onode_extents",
 	    "Number of extents in cache");
   b.add_u64(l_bluestore_blobs, "onode_blobs",
@@ -6439,6 +6565,30 @@ void BlueStore::_init_logger()
 	    NULL,
 	    PerfCountersBuilder::PRIO_DEBUGONLY,
 	    unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluestore_readahead_ops, "readahead_ops",
+	    "Prefetch reads issued for sequential streams");
+  b.add_u64_counter(l_bluestore_readahead_bytes, "readahead_bytes",
+	    "Sum for bytes of prefetch reads issued",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY,
+	    unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluestore_readahead_dropped, "readahead_dropped",
+	    "Prefetch reads skipped due to bluestore_readahead_budget_bytes");
+  b.add_u64_counter(l_bluestore_readahead_hit_bytes, "readahead_hit_bytes",
+	    "Sum for bytes of reads within prefetched ranges found in the cache",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY,
+	    unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluestore_readahead_miss_bytes, "readahead_miss_bytes",
+	    "Sum for bytes of reads within prefetched ranges read from disk",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY,
+	    unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluestore_onode_prefetch, "onode_prefetch",
+	    "Onode loads queued by prefetch hints");
+  b.add_u64_counter(l_bluestore_onode_prefetch_dropped,
+	    "onode_prefetch_dropped",
+	    "Prefetch hints ignored because too many were queued");
   //****************************************
 
   // internal stats
@@ -6467,6 +6617,10 @@ void BlueStore::_init_logger()
     "amount of keys set by omap setkeys calls");
   b.add_u64_counter(l_bluestore_omap_setkeys_bytes, "omap_setkeys_bytes",
     "amount of bytes set by omap setkeys calls");
+  b.add_u64_counter(l_bluestore_omap_bloom_builds, "omap_bloom_builds",
+    "omap key bloom filters built from a key scan");
+  b.add_u64_counter(l_bluestore_omap_bloom_skipped, "omap_bloom_skipped",
+    "omap key lookups answered as missing by the bloom filter");
   b.add_u64_counter(l_bluestore_omap_rmkeys_count, "omap_rmkeys_count",
     "amount of omap keys removed via rmkeys");
   b.add_u64_counter(l_bluestore_omap_rmkey_ranges_count, "omap_rmkey_range_count",
@@ -7061,12 +7215,30 @@ void BlueStore::_set_alloc_sizes(void)
     }
   }
 
+  deferred_coalesce_max_bytes = cct->_conf.get_val<Option::size_t>(
+    "bluestore_deferred_coalesce_max_bytes");
+  if (auto qd = cct->_conf.get_val<uint64_t>(
+        "bluestore_deferred_coalesce_queue_depth"); qd) {
+    deferred_coalesce_queue_depth = qd;
+  } else {
+    if (_use_rotational_settings()) {
+      deferred_coalesce_queue_depth = cct->_conf.get_val<uint64_t>(
+	"bluestore_deferred_coalesce_queue_depth_hdd");
+    } else {
+      deferred_coalesce_queue_depth = cct->_conf.get_val<uint64_t>(
+	"bluestore_deferred_coalesce_queue_depth_ssd");
+    }
+  }
+
   dout(10) << __func__ << " min_alloc_size 0x" << std::hex << min_alloc_size
 	   << std::dec << " order " << (int)min_alloc_size_order
 	   << " max_alloc_size 0x" << std::hex << max_alloc_size
 	   << " prefer_deferred_size 0x" << prefer_deferred_size
 	   << std::dec
 	   << " deferred_batch_ops " << deferred_batch_ops
+	   << " deferred_coalesce_max_bytes 0x" << std::hex
+	   << deferred_coalesce_max_bytes << std::dec
+	   << " deferred_coalesce_queue_depth " << deferred_coalesce_queue_depth
 	   << dendl;
 }
 
@@ -7104,6 +7276,8 @@ int BlueStore::_open_bdev(bool create)
   block_size_order = std::countr_zero(block_size);
   ceph_assert(block_size == 1u << block_size_order);
   _set_max_defer_interval();
+  _set_readahead();
+  _set_omap_bloom();
   // and set cache_size based on device type
   r = _set_cache_sizes();
   if (r < 0) {
@@ -7297,7 +7471,15 @@ int BlueStore::_init_alloc()
 
   uint64_t num = 0, bytes = 0;
   utime_t start_time = ceph_clock_now();
-  if (!fm->is_null_manager()) {
+  alloc_snapshot_used = false;
+  alloc_snapshot_clean = false;
+  if (!fm->is_null_manager() && _alloc_snapshot_enabled() &&
+      _restore_alloc_snapshot(&num, &bytes) == 0) {
+    alloc_snapshot_used = true;
+    utime_t duration = ceph_clock_now() - start_time;
+    dout(5) << __func__ << " loaded allocation snapshot, num_entries=" << num
+            << " free_size=" << bytes << " time=" << duration << " seconds" << dendl;
+  } else if (!fm->is_null_manager()) {
     // This is the original path - loading allocation map from RocksDB and feeding into the allocator
     dout(5) << __func__ << "::NCB::loading allocation from FM -> alloc" << dendl;
     // initialize from freelist
@@ -7759,6 +7941,7 @@ int BlueStore::_is_bluefs(bool create, bool* ret)
 int BlueStore::_open_db_and_around(bool read_only, bool to_repair)
 {
   dout(5) << __func__ << "::NCB::read_only=" << read_only << ", to_repair=" << to_repair << dendl;
+  mono_clock::time_point phase_start;
   {
     string type;
     int r = read_meta("type", &type);
@@ -7798,10 +7981,14 @@ int BlueStore::_open_db_and_around(bool read_only, bool to_repair)
 
   // open in read-only first to read FM list and init allocator
   // as they might be needed for some BlueFS procedures
+  phase_start = mono_clock::now();
   r = _open_db(false, false, true);
   if (r < 0)
     goto out_bdev;
+  _note_startup_phase("open_db_ro", phase_start);
+  _note_bluefs_replay("bluefs_replay_ro");
 
+  phase_start = mono_clock::now();
   r = _open_super_meta();
   if (r < 0) {
     goto out_db;
@@ -7810,10 +7997,13 @@ int BlueStore::_open_db_and_around(bool read_only, bool to_repair)
   r = _open_fm(nullptr, true, false);
   if (r < 0)
     goto out_db;
+  _note_startup_phase("open_fm", phase_start);
 
+  phase_start = mono_clock::now();
   r = _init_alloc();
   if (r < 0)
     goto out_fm;
+  _note_startup_phase("init_alloc", phase_start);
 
   if (bdev_label_multi) {
     _main_bdev_label_try_reserve();
@@ -7825,14 +8015,22 @@ int BlueStore::_open_db_and_around(bool read_only, bool to_repair)
   // load allocated extents from bluefs into allocator.
   // And now it's time to do that
   //
+  phase_start = mono_clock::now();
   _close_db();
+  _note_startup_phase("close_db_ro", phase_start);
+  phase_start = mono_clock::now();
   r = _open_db(false, to_repair, read_only);
   if (r < 0) {
     goto out_alloc;
   }
+  _note_startup_phase("open_db", phase_start);
+  _note_bluefs_replay("bluefs_replay");
 
   if (!read_only) {
+    phase_start = mono_clock::now();
     _post_init_alloc();
+    _post_init_alloc_snapshot(to_repair);
+    _note_startup_phase("post_init_alloc", phase_start);
   }
 
   // when function is called in repair mode (to_repair=true) we skip db->open()/create()
@@ -8137,6 +8335,8 @@ void BlueStore::_close_db()
            << " pool stats=" << osd_pools.size()
            << dendl;
   bool do_destage = !db_was_opened_read_only && need_to_destage_allocation_file;
+  bool store_snapshot = !db_was_opened_read_only && need_to_store_alloc_snapshot &&
+    fm && !fm->is_null_manager();
   if (do_destage && is_statfs_recoverable()) {
     auto t = db->get_transaction();
     store_statfs_t s;
@@ -8185,7 +8385,7 @@ void BlueStore::_close_db()
   delete db;
   db = nullptr;
 
-  if (do_destage && fm && fm->is_null_manager()) {
+  if ((do_destage && fm && fm->is_null_manager()) || store_snapshot) {
     if (cct->_conf->osd_fast_shutdown) {
       interval_set<uint64_t> discard_queued;
       bdev->swap_discard_queued(discard_queued);
@@ -8203,9 +8403,17 @@ void BlueStore::_close_db()
     //   or it was a fast shutdown, but we already moved the main discards-queue to the allocator
     //   and only need to wait for the threads local discard_processing queues to drain
     bdev->discard_drain();
-    int ret = store_allocator(alloc);
-    if (unlikely(ret != 0)) {
-      derr << __func__ << "::NCB::store_allocator() failed (we will need to rebuild it on startup)" << dendl;
+    if (store_snapshot) {
+      int ret = _store_alloc_snapshot();
+      if (unlikely(ret != 0)) {
+        derr << __func__ << " failed to store allocator snapshot (will replay dirty regions on startup)" << dendl;
+      }
+      need_to_store_alloc_snapshot = false;
+    } else {
+      int ret = store_allocator(alloc);
+      if (unlikely(ret != 0)) {
+        derr << __func__ << "::NCB::store_allocator() failed (we will need to rebuild it on startup)" << dendl;
+      }
     }
   }
 
@@ -9175,6 +9383,8 @@ void BlueStore::set_cache_shards(unsigned num)
   ceph_assert(num >= oold && num >= bold);
   onode_cache_shards.resize(num);
   buffer_cache_shards.resize(num);
+  // only called while unmounted, so the cold tier is empty here
+  onode_cold_cache = std::make_unique<OnodeColdCache>(cct, num);
   for (unsigned i = oold; i < num; ++i) {
     onode_cache_shards[i] = 
         OnodeCacheShard::create(cct, cct->_conf->bluestore_cache_type,
@@ -9342,6 +9552,9 @@ int BlueStore::_mount()
   }
   debug_extent_map_encode_check = cct->_conf.get_val<bool>("bluestore_debug_extent_map_encode_check");
   _kv_only = false;
+  _reset_startup_timings();
+  auto mount_start = mono_clock::now();
+  auto phase_start = mount_start;
   if (cct->_conf->bluestore_fsck_on_mount) {
     int rc = fsck(cct->_conf->bluestore_fsck_on_mount_deep);
     if (rc < 0)
@@ -9350,6 +9563,7 @@ int BlueStore::_mount()
       derr << __func__ << " fsck found " << rc << " errors" << dendl;
       return -EIO;
     }
+    _note_startup_phase("fsck_on_mount", phase_start);
   }
 
   if (cct->_conf->osd_max_object_size > OBJECT_MAX_SIZE) {
@@ -9376,10 +9590,12 @@ int BlueStore::_mount()
   }
 
   // The recovery process for allocation-map needs to open collection early
+  phase_start = mono_clock::now();
   r = _open_collections();
   if (r < 0) {
     return r;
   }
+  _note_startup_phase("open_collections", phase_start);
   auto shutdown_cache = make_scope_guard([&] {
     if (!mounted) {
       _shutdown_cache();
@@ -9398,10 +9614,12 @@ int BlueStore::_mount()
     }
   });
 
+  phase_start = mono_clock::now();
   r = _deferred_replay();
   if (r < 0) {
     return r;
   }
+  _note_startup_phase("deferred_replay", phase_start);
 
   mempool_thread.init();
 
@@ -9411,7 +9629,9 @@ int BlueStore::_mount()
     auto was_per_pool_omap = per_pool_omap;
 
     dout(1) << __func__ << " quick-fix on mount" << dendl;
+    phase_start = mono_clock::now();
     _fsck_on_open(FSCK_SHALLOW, true);
+    _note_startup_phase("fsck_quick_fix", phase_start);
 
     //set again as hopefully it has been fixed
     if (was_per_pool_omap != OMAP_PER_PG) {
@@ -9419,10 +9639,34 @@ int BlueStore::_mount()
     }
   }
 
+  _note_startup_phase("total", mount_start);
   mounted = true;
   return 0;
 }
 
+void BlueStore::_reset_startup_timings()
+{
+  std::lock_guard l(startup_timings_lock);
+  startup_timings.clear();
+}
+
+void BlueStore::_note_startup_phase(std::string_view phase,
+				    mono_clock::time_point start)
+{
+  auto elapsed = mono_clock::now() - start;
+  dout(5) << __func__ << " " << phase << " took " << elapsed << dendl;
+  std::lock_guard l(startup_timings_lock);
+  startup_timings.emplace_back(phase, elapsed);
+}
+
+void BlueStore::_note_bluefs_replay(std::string_view phase)
+{
+  if (bluefs) {
+    std::lock_guard l(startup_timings_lock);
+    startup_timings.emplace_back(phase, bluefs->get_last_replay_duration());
+  }
+}
+
 int BlueStore::umount()
 {
   dout(5) << __func__ << dendl;
@@ -10750,6 +10994,10 @@ int BlueStore::_fsck(BlueStore::FSCKDepth depth, bool repair)
       depth == FSCK_SHALLOW ? " (shallow)" : " (regular)")
     << dendl;
 
+  // a standalone fsck reports its own open steps, the ones of a mount
+  // that runs fsck first are noted again after it
+  _reset_startup_timings();
+
   // hack - sanitize check for bdev label
   bluestore_bdev_label_require_all = false;
   auto restore_option = make_scope_guard([&] {
@@ -12333,6 +12581,9 @@ void BlueStore::refresh_perf_counters()
   logger->set(l_bluestore_blobs, num_blobs);
   logger->set(l_bluestore_buffers, num_buffers);
   logger->set(l_bluestore_buffer_bytes, num_buffer_bytes);
+  logger->set(l_bluestore_onode_cold_entries,
+	      onode_cold_cache->get_num_entries());
+  logger->set(l_bluestore_onode_cold_bytes, onode_cold_cache->get_bytes());
 }
 
 // ---------------
@@ -12391,6 +12642,50 @@ bool BlueStore::exists(CollectionHandle &c_, const ghobject_t& oid)
   return r;
 }
 
+struct C_PrefetchObject : public Context {
+  BlueStore *store;
+  BlueStore::CollectionRef c;
+  ghobject_t oid;
+  C_PrefetchObject(BlueStore *s, BlueStore::CollectionRef c,
+		   const ghobject_t& oid)
+    : store(s), c(c), oid(oid) {}
+  void finish(int r) override {
+    store->do_prefetch_object(c, oid);
+  }
+};
+
+void BlueStore::prefetch_object(CollectionHandle &c_, const ghobject_t& oid)
+{
+  Collection *c = static_cast<Collection *>(c_.get());
+  std::shared_lock l(onode_prefetch_lock);
+  if (onode_prefetch_finishers.empty() || !readahead_running || !c->exists) {
+    return;
+  }
+  uint64_t max = cct->_conf->bluestore_onode_prefetch_max_queued;
+  if (onode_prefetch_queued.fetch_add(1) >= max) {
+    --onode_prefetch_queued;
+    logger->inc(l_bluestore_onode_prefetch_dropped);
+    return;
+  }
+  dout(20) << __func__ << " " << c->cid << " " << oid << dendl;
+  logger->inc(l_bluestore_onode_prefetch);
+  auto& f = onode_prefetch_finishers[
+    oid.hobj.get_hash() % onode_prefetch_finishers.size()];
+  f->queue(new C_PrefetchObject(this, CollectionRef(c), oid));
+}
+
+void BlueStore::do_prefetch_object(CollectionRef c, const ghobject_t& oid)
+{
+  {
+    std::shared_lock l(c->lock);
+    if (c->exists) {
+      // loading the onode brings its attrs along
+      c->get_onode(oid, false);
+    }
+  }
+  --onode_prefetch_queued;
+}
+
 int BlueStore::stat(
   CollectionHandle &c_,
   const ghobject_t& oid,
@@ -12533,6 +12828,8 @@ int BlueStore::read(
     r = _do_read(c, o, offset, length, bl, op_flags);
     if (r == -EIO) {
       logger->inc(l_bluestore_read_eio);
+    } else if (r > 0) {
+      _maybe_readahead(c, o, offset, r, op_flags);
     }
   }
 
@@ -12783,7 +13080,9 @@ int BlueStore::_generate_read_result_bl(
             // need offset before padding
             o->bc.did_read(o->c->cache, r.logical_offset, std::move(region_buffer));
           }
-          ready_regions[r.logical_offset].substr_of(req.bl, r.front, r.length);
+          auto& region = ready_regions[r.logical_offset];
+          region.substr_of(req.bl, r.front, r.length);
+          _prime_read_crc(bptr->get_blob(), req.r_off + r.front, region);
         }
       }
     }
@@ -12880,7 +13179,14 @@ int BlueStore::_do_read(
   ready_regions_t ready_regions;
   blobs2read_t blobs2read;
   _read_cache(o, offset, length, read_cache_policy, ready_regions, blobs2read);
-
+  if (auto ra = o->readahead.load(); ra && ra->covers(offset, length)) {
+    uint64_t hit = 0;
+    for (auto& [off, rbl] : ready_regions) {
+      hit += rbl.length();
+    }
+    logger->inc(l_bluestore_readahead_hit_bytes, hit);
+    logger->inc(l_bluestore_readahead_miss_bytes, length - hit);
+  }
 
   // read raw blob data.
   start = mono_clock::now(); // for the sake of simplicity
@@ -12941,6 +13247,97 @@ int BlueStore::_do_read(
   return r;
 }
 
+struct C_Readahead : public Context {
+  BlueStore *store;
+  BlueStore::CollectionRef c;
+  BlueStore::OnodeRef o;
+  uint64_t offset, length;
+  C_Readahead(BlueStore *s, BlueStore::CollectionRef c, BlueStore::OnodeRef o,
+	      uint64_t offset, uint64_t length)
+    : store(s), c(c), o(o), offset(offset), length(length) {}
+  void finish(int r) override {
+    store->do_readahead(c, o, offset, length);
+  }
+};
+
+void BlueStore::_maybe_readahead(
+  Collection *c,
+  OnodeRef& o,
+  uint64_t offset,
+  uint64_t length,
+  uint32_t op_flags)
+{
+  uint64_t max_bytes = readahead_max_bytes;
+  if (max_bytes == 0 || !readahead_running ||
+      (op_flags & (CEPH_OSD_OP_FLAG_FADVISE_RANDOM |
+		   CEPH_OSD_OP_FLAG_FADVISE_DONTNEED |
+		   CEPH_OSD_OP_FLAG_FADVISE_NOCACHE |
+		   CEPH_OSD_OP_FLAG_BYPASS_CLEAN_CACHE))) {
+    return;
+  }
+  auto ra = o->readahead.load();
+  if (!ra) {
+    auto n = new OnodeReadahead;
+    n->ra.set_trigger_requests(readahead_trigger_requests);
+    n->ra.set_min_readahead_size(readahead_min_bytes);
+    n->ra.set_max_readahead_size(max_bytes);
+    n->ra.set_alignments({min_alloc_size});
+    if (o->readahead.compare_exchange_strong(ra, n)) {
+      ra = n;
+    } else {
+      delete n;  // lost the race, ra holds the winner
+    }
+  }
+
+  auto ext = ra->ra.update(offset, length, o->onode.size);
+  if (ext.second == 0) {
+    return;
+  }
+  uint64_t budget = readahead_budget_bytes;
+  if (readahead_inflight_bytes.fetch_add(ext.second) + ext.second > budget) {
+    readahead_inflight_bytes -= ext.second;
+    logger->inc(l_bluestore_readahead_dropped);
+    dout(20) << __func__ << " " << o->oid << " over budget, dropping 0x"
+	     << std::hex << ext.first << "~" << ext.second << std::dec << dendl;
+    return;
+  }
+  dout(20) << __func__ << " " << o->oid << " prefetch 0x" << std::hex
+	   << ext.first << "~" << ext.second << std::dec << dendl;
+  ra->ra.inc_pending();
+  logger->inc(l_bluestore_readahead_ops);
+  logger->inc(l_bluestore_readahead_bytes, ext.second);
+  readahead_finisher.queue(
+    new C_Readahead(this, CollectionRef(c), o, ext.first, ext.second));
+}
+
+void BlueStore::do_readahead(
+  CollectionRef c,
+  OnodeRef o,
+  uint64_t offset,
+  uint64_t length)
+{
+  {
+    std::shared_lock l(c->lock);
+    // skip objects removed or moved to another collection meanwhile
+    if (o->exists && o->c == c.get()) {
+      bufferlist bl;
+      int r = _do_read(c.get(), o, offset, length, bl,
+		       CEPH_OSD_OP_FLAG_FADVISE_WILLNEED);
+      if (r > 0) {
+	auto ra = o->readahead.load();
+	if (offset > ra->done_end || offset + r < ra->done_start) {
+	  ra->done_start = offset;
+	}
+	ra->done_end = offset + r;
+      }
+      dout(20) << __func__ << " " << o->oid << " 0x" << std::hex << offset
+	       << "~" << length << std::dec << " = " << r << dendl;
+    }
+  }
+  o->readahead.load()->ra.dec_pending();
+  readahead_inflight_bytes -= length;
+}
+
 void inline BlueStore::_do_read_and_pad(
   Collection* c,
   OnodeRef& o,
@@ -13009,6 +13406,34 @@ int BlueStore::_verify_csum(OnodeRef& o,
   return r;
 }
 
+// The csum of an uncompressed crc32c blob that just passed verification
+// is crc32c(-1) of each csum chunk of the data we hand out.  Chain those
+// into the crc32c(-1) of the whole region and record it on the buffer, so
+// a caller that digests the data (deep scrub does) gets it for free.
+void BlueStore::_prime_read_crc(
+  const bluestore_blob_t& blob,
+  uint64_t blob_xoffset,
+  bufferlist& bl)
+{
+  if (!cct->_conf->bluestore_csum_prime_read_crc ||
+      cct->_conf->bluestore_ignore_data_csum ||
+      blob.csum_type != Checksummer::CSUM_CRC32C ||
+      bl.get_num_buffers() != 1) {
+    return;
+  }
+  const uint64_t csum_chunk = blob.get_csum_chunk_size();
+  if (blob_xoffset % csum_chunk || bl.length() % csum_chunk) {
+    return;
+  }
+  uint32_t crc = -1;
+  for (uint64_t pos = 0; pos < bl.length(); pos += csum_chunk) {
+    // crc32c(crc, chunk) = crc32c(-1, chunk) ^ crc32c(crc ^ -1, zeros)
+    uint32_t chunk_crc = blob.get_csum_item((blob_xoffset + pos) / csum_chunk);
+    crc = chunk_crc ^ ceph_crc32c(crc ^ (uint32_t)-1, nullptr, csum_chunk);
+  }
+  bl.set_crc32c(-1, crc);
+}
+
 int BlueStore::_decompress(bufferlist& source, bufferlist* result)
 {
   int r = 0;
@@ -13120,6 +13545,41 @@ int BlueStore::_fiemap(
   return 0;
 }
 
+int BlueStore::get_locality_hints(
+  CollectionHandle &c_,
+  const vector<ghobject_t>& oids,
+  vector<uint64_t> *hints)
+{
+  Collection *c = static_cast<Collection *>(c_.get());
+  if (!c->exists)
+    return -ENOENT;
+  hints->assign(oids.size(), std::numeric_limits<uint64_t>::max());
+  std::shared_lock l(c->lock);
+  for (size_t i = 0; i < oids.size(); ++i) {
+    OnodeRef o = c->get_onode(oids[i], false);
+    if (!o || !o->exists || o->onode.size == 0) {
+      continue;
+    }
+    // the device offset of the first allocated extent stands in for the
+    // whole object; good enough to turn a scan into a mostly forward sweep
+    o->extent_map.fault_range(db, 0, 1);
+    for (auto& e : o->extent_map.extent_map) {
+      auto& pextents = e.blob->get_blob().get_extents();
+      auto p = std::find_if(pextents.begin(), pextents.end(),
+			    [](const bluestore_pextent_t& pe) {
+			      return pe.is_valid();
+			    });
+      if (p != pextents.end()) {
+	(*hints)[i] = p->offset;
+	break;
+      }
+    }
+    dout(30) << __func__ << " " << oids[i] << " 0x" << std::hex
+	     << (*hints)[i] << std::dec << dendl;
+  }
+  return 0;
+}
+
 int BlueStore::fiemap(
   CollectionHandle &c_,
   const ghobject_t& oid,
@@ -13786,6 +14246,59 @@ int BlueStore::omap_get_keys(
   return r;
 }
 
+BlueStore::OmapBloom *BlueStore::_get_omap_bloom(OnodeRef& o)
+{
+  OmapBloom *b = o->omap_bloom.load();
+  if (b) {
+    return b->overflow ? nullptr : b;
+  }
+  uint64_t max_keys = omap_bloom_max_keys;
+  if (max_keys == 0) {
+    return nullptr;
+  }
+  // we hold the collection lock, so nothing can be queued against o while
+  // we scan, and o was flushed, so the kv store has all of its keys
+  std::vector<std::string> keys;
+  bool overflow = false;
+  {
+    const string& prefix = o->get_omap_prefix();
+    string head, tail;
+    o->get_omap_key(string(), &head);
+    o->get_omap_tail(&tail);
+    KeyValueDB::Iterator it = db->get_iterator(prefix, 0, KeyValueDB::IteratorBounds{head, tail});
+    for (it->lower_bound(head); it->valid(); it->next()) {
+      if (it->key() >= tail) {
+	break;
+      }
+      if (keys.size() >= max_keys) {
+	overflow = true;
+	break;
+      }
+      keys.emplace_back();
+      o->decode_omap_key(it->key(), &keys.back());
+    }
+  }
+  OmapBloom *n;
+  if (overflow) {
+    n = new OmapBloom;
+  } else {
+    // leave room for growth before a rebuild is due
+    n = new OmapBloom(std::max<size_t>(keys.size() * 2, 64), omap_bloom_fpp);
+    for (auto& k : keys) {
+      n->insert(k);
+    }
+  }
+  logger->inc(l_bluestore_omap_bloom_builds);
+  dout(20) << __func__ << " " << o->oid << " " << keys.size() << " keys"
+	   << (overflow ? " (overflow)" : "") << dendl;
+  // a concurrent reader may have beaten us to it
+  if (!o->omap_bloom.compare_exchange_strong(b, n)) {
+    delete n;
+    n = b;
+  }
+  return n->overflow ? nullptr : n;
+}
+
 int BlueStore::omap_get_values(
   CollectionHandle &c_,        ///< [in] Collection containing oid
   const ghobject_t &oid,       ///< [in] Object containing omap
@@ -13812,9 +14325,14 @@ int BlueStore::omap_get_values(
   o->flush();
   {
     const string& prefix = o->get_omap_prefix();
+    OmapBloom *bloom = _get_omap_bloom(o);
     o->get_omap_key(string(), &final_key);
     size_t base_key_len = final_key.size();
     for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p) {
+      if (bloom && !bloom->may_contain(*p)) {
+	logger->inc(l_bluestore_omap_bloom_skipped);
+	continue;
+      }
       final_key.resize(base_key_len); // keep prefix
       final_key += *p;
       bufferlist val;
@@ -13862,9 +14380,15 @@ int BlueStore::omap_check_keys(
   o->flush();
   {
     const string& prefix = o->get_omap_prefix();
+    OmapBloom *bloom = _get_omap_bloom(o);
     o->get_omap_key(string(), &final_key);
     size_t base_key_len = final_key.size();
     for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p) {
+      if (bloom && !bloom->may_contain(*p)) {
+	logger->inc(l_bluestore_omap_bloom_skipped);
+	dout(30) << __func__ << "  miss (bloom) " << *p << dendl;
+	continue;
+      }
       final_key.resize(base_key_len); // keep prefix
       final_key += *p;
       bufferlist val;
@@ -14467,7 +14991,7 @@ void BlueStore::_txc_write_nodes(TransContext *txc, KeyValueDB::Transaction t)
 
   // finalize onodes
   for (auto o : txc->onodes) {
-    _record_onode(o, t);
+    _record_onode(o, t, true);
     int16_t spanning_change =
       o->extent_map.spanning_blob_map.size() - o->prev_spanning_cnt;
     if (spanning_change != 0) {
@@ -14912,11 +15436,82 @@ void BlueStore::_osr_drain_all()
 }
 
 
+void BlueStore::_kv_submit_queue(TransContext *txc)
+{
+  {
+    std::lock_guard l(kv_submit_lock);
+    ++kv_submit_pending;
+  }
+  // keep each osr on one thread so its txcs are submitted in order
+  auto& t = kv_submit_threads[
+    txc->osr->get_sequencer_id() % kv_submit_threads.size()];
+  std::lock_guard l(t->lock);
+  t->q.push_back(txc);
+  t->cond.notify_one();
+}
+
+void BlueStore::_kv_submit_wait()
+{
+  std::unique_lock l(kv_submit_lock);
+  kv_submit_cond.wait(l, [this] { return kv_submit_pending == 0; });
+}
+
+void BlueStore::_kv_submit_thread(KVSubmitThread *t)
+{
+  dout(10) << __func__ << " start" << dendl;
+  std::unique_lock l(t->lock);
+  while (true) {
+    if (t->q.empty()) {
+      if (t->stop) {
+	break;
+      }
+      t->cond.wait(l);
+      continue;
+    }
+    auto txc = t->q.front();
+    t->q.pop_front();
+    l.unlock();
+    // a later txc of this osr may submit itself once this drops to zero
+    _txc_apply_kv(txc, false);
+    --txc->osr->kv_committing_serially;
+    {
+      std::lock_guard pl(kv_submit_lock);
+      if (--kv_submit_pending == 0) {
+	kv_submit_cond.notify_all();
+      }
+    }
+    l.lock();
+  }
+  dout(10) << __func__ << " finish" << dendl;
+}
+
 void BlueStore::_kv_start()
 {
   dout(10) << __func__ << dendl;
 
   finisher.start();
+  readahead_finisher.start();
+  {
+    std::unique_lock l(onode_prefetch_lock);
+    for (uint64_t i = 0; i < cct->_conf->bluestore_onode_prefetch_threads; ++i) {
+      auto f = std::make_unique<Finisher>(
+        cct, "onode_prefetch_finisher_" + stringify(i), "bstore_prefetch");
+      f->start();
+      onode_prefetch_finishers.push_back(std::move(f));
+    }
+  }
+  for (uint64_t i = 0; i < cct->_conf->bluestore_compression_threads; ++i) {
+    auto f = std::make_unique<Finisher>(
+      cct, "compress_finisher_" + stringify(i), "bstore_compress");
+    f->start();
+    compress_finishers.push_back(std::move(f));
+  }
+  readahead_running = true;
+  for (uint64_t i = 0; i < cct->_conf->bluestore_kv_submit_threads; ++i) {
+    auto t = std::make_unique<KVSubmitThread>(this);
+    t->create("bstore_kv_sub");
+    kv_submit_threads.push_back(std::move(t));
+  }
   kv_sync_thread.create("bstore_kv_sync");
   kv_finalize_thread.create("bstore_kv_final");
 }
@@ -14924,6 +15519,25 @@ void BlueStore::_kv_start()
 void BlueStore::_kv_stop()
 {
   dout(10) << __func__ << dendl;
+  // queued prefetches pin onodes and collections
+  readahead_running = false;
+  readahead_finisher.wait_for_empty();
+  readahead_finisher.stop();
+  std::vector<std::unique_ptr<Finisher>> prefetch_finishers;
+  {
+    // once swapped out no prefetch_object can queue to them
+    std::unique_lock l(onode_prefetch_lock);
+    prefetch_finishers.swap(onode_prefetch_finishers);
+  }
+  for (auto& f : prefetch_finishers) {
+    f->wait_for_empty();
+    f->stop();
+  }
+  for (auto& f : compress_finishers) {
+    f->wait_for_empty();
+    f->stop();
+  }
+  compress_finishers.clear();
   {
     std::unique_lock l{kv_lock};
     while (!kv_sync_started) {
@@ -14942,6 +15556,15 @@ void BlueStore::_kv_stop()
   }
   kv_sync_thread.join();
   kv_finalize_thread.join();
+  for (auto& t : kv_submit_threads) {
+    {
+      std::lock_guard l(t->lock);
+      t->stop = true;
+      t->cond.notify_all();
+    }
+    t->join();
+  }
+  kv_submit_threads.clear();
   ceph_assert(removed_collections.empty());
   {
     std::lock_guard l(kv_lock);
@@ -14998,6 +15621,30 @@ void BlueStore::_kv_sync_thread()
 
       dout(20) << __func__ << " wake" << dendl;
     } else {
+      if (!kv_stop && !deferred_aggressive && !kv_queue.empty()) {
+	// group commit: give other sequencers a chance to join this sync
+	auto window = _kv_group_commit_window(kv_queue.size());
+	if (window != ceph::timespan::zero()) {
+	  auto wstart = mono_clock::now();
+	  auto deadline = wstart + window;
+	  size_t target = std::ceil(kv_batch_avg);
+	  while (!kv_stop && kv_queue.size() < target) {
+	    // let submitters wake us as they queue
+	    kv_sync_in_progress = false;
+	    if (kv_cond.wait_until(l, deadline) == std::cv_status::timeout) {
+	      break;
+	    }
+	  }
+	  kv_sync_in_progress = true;
+	  auto waited = mono_clock::now() - wstart;
+	  twait += waited;
+	  logger->tinc(l_bluestore_kv_group_commit_wait_lat, waited);
+	  dout(20) << __func__ << " group commit waited " << waited
+		   << " for " << kv_queue.size() << "/" << target
+		   << " txcs" << dendl;
+	}
+      }
+
       deque<TransContext*> kv_submitting;
       deque<DeferredBatch*> deferred_done, deferred_stable;
       uint64_t aios = 0, costs = 0, txcs = 0;
@@ -15092,12 +15739,17 @@ void BlueStore::_kv_sync_thread()
 	dout(10) << __func__ << " new_blobid_max " << new_blobid_max << dendl;
       }
 
+      auto submit_start = mono_clock::now();
       for (auto txc : kv_committing) {
 	throttle.log_state_latency(*txc, logger, l_bluestore_state_kv_queued_lat);
 	if (txc->get_state() == TransContext::STATE_KV_QUEUED) {
 	  ++kv_submitted;
-	  _txc_apply_kv(txc, false);
-	  --txc->osr->kv_committing_serially;
+	  if (kv_submit_threads.empty()) {
+	    _txc_apply_kv(txc, false);
+	    --txc->osr->kv_committing_serially;
+	  } else {
+	    _kv_submit_queue(txc);
+	  }
 	} else {
 	  ceph_assert(txc->get_state() == TransContext::STATE_KV_SUBMITTED);
 	}
@@ -15105,6 +15757,11 @@ void BlueStore::_kv_sync_thread()
 	  --txc->osr->txc_with_unstable_io;
 	}
       }
+      if (!kv_submit_threads.empty()) {
+	// synct carries the deferred cleanup and must follow everything
+	_kv_submit_wait();
+      }
+      logger->tinc(l_bluestore_kv_submit_lat, mono_clock::now() - submit_start);
 
       // release throttle *before* we commit.  this allows new ops
       // to be prepared and enter pipeline while we are waiting on
@@ -15219,6 +15876,14 @@ void BlueStore::_kv_sync_thread()
 	  l_bluestore_kv_sync_lat,
 	  dur,
 	  cct->_conf->bluestore_log_op_age);
+	if (committing_size) {
+	  logger->inc(l_bluestore_kv_group_commit_batch, committing_size);
+	  // feed the group commit window estimator
+	  constexpr double alpha = 0.125;
+	  kv_sync_lat_avg = kv_sync_lat_avg * (1 - alpha) +
+	    ceph::to_seconds<double>(dur) * alpha;
+	  kv_batch_avg = kv_batch_avg * (1 - alpha) + committing_size * alpha;
+	}
       }
 
       l.lock();
@@ -15231,6 +15896,19 @@ void BlueStore::_kv_sync_thread()
   kv_sync_started = false;
 }
 
+ceph::timespan BlueStore::_kv_group_commit_window(size_t queued) const
+{
+  auto max_us = cct->_conf->bluestore_kv_sync_group_commit_max_window_us;
+  // at low queue depth nobody else is going to show up; commit right away
+  if (max_us == 0 || kv_batch_avg < 2.0 || queued >= kv_batch_avg) {
+    return ceph::timespan::zero();
+  }
+  double window = std::min(
+    kv_sync_lat_avg * cct->_conf->bluestore_kv_sync_group_commit_latency_ratio,
+    max_us / 1000000.0);
+  return ceph::make_timespan(window);
+}
+
 void BlueStore::_kv_finalize_thread()
 {
   deque<TransContext*> kv_committed;
@@ -15371,19 +16049,23 @@ void BlueStore::deferred_try_submit()
     }
   }
 
-  for (auto& osr : osrs) {
-    osr->deferred_lock.lock();
-    if (osr->deferred_pending) {
-      if (!osr->deferred_running) {
-	_deferred_submit_unlock(osr.get());
+  if (deferred_coalesce_max_bytes.load() > 0) {
+    _deferred_submit_coalesced(osrs);
+  } else {
+    for (auto& osr : osrs) {
+      osr->deferred_lock.lock();
+      if (osr->deferred_pending) {
+	if (!osr->deferred_running) {
+	  _deferred_submit_unlock(osr.get());
+	} else {
+	  osr->deferred_lock.unlock();
+	  dout(20) << __func__ << "  osr " << osr << " already has running"
+		   << dendl;
+	}
       } else {
 	osr->deferred_lock.unlock();
-	dout(20) << __func__ << "  osr " << osr << " already has running"
-		 << dendl;
+	dout(20) << __func__ << "  osr " << osr << " has no pending" << dendl;
       }
-    } else {
-      osr->deferred_lock.unlock();
-      dout(20) << __func__ << "  osr " << osr << " has no pending" << dendl;
     }
   }
 
@@ -15458,6 +16140,123 @@ struct C_DeferredTrySubmit : public Context {
   }
 };
 
+void BlueStore::_deferred_submit_coalesced(
+  const vector<OpSequencerRef>& osrs)
+{
+  int qd = deferred_coalesce_queue_depth.load();
+  if (qd > 0 && !deferred_aggressive && deferred_inflight_ios.load() >= qd) {
+    // the device is busy; let more writes pile up and merge, and retry
+    // once the in-flight flushes complete
+    deferred_flush_held = true;
+    // a flush that completed before held was set queued no retry: check
+    // again, and submit now unless a completion already claimed the hold
+    if (deferred_inflight_ios.load() >= qd ||
+	!deferred_flush_held.exchange(false)) {
+      dout(20) << __func__ << " " << deferred_inflight_ios.load()
+	       << " ios in flight, holding" << dendl;
+      logger->inc(l_bluestore_deferred_flush_held);
+      return;
+    }
+  }
+
+  auto f = new DeferredFlush(cct);
+  for (auto& osr : osrs) {
+    osr->deferred_lock.lock();
+    if (osr->deferred_pending && !osr->deferred_running) {
+      auto b = osr->deferred_pending;
+      deferred_queue_size -= b->seq_bytes.size();
+      ceph_assert(deferred_queue_size >= 0);
+      osr->deferred_running = b;
+      osr->deferred_pending = nullptr;
+      f->batches.push_back(b);
+    } else {
+      dout(20) << __func__ << "  osr " << osr << " has "
+	       << (osr->deferred_pending ? "running" : "no pending") << dendl;
+    }
+    osr->deferred_lock.unlock();
+  }
+  if (f->batches.empty()) {
+    delete f;
+    return;
+  }
+
+  // merge all batches in LBA order; within a batch extents never
+  // overlap, across batches overlapping extents are written separately
+  std::vector<std::pair<uint64_t, bufferlist*>> extents;
+  for (auto b : f->batches) {
+    for (auto& txc : b->txcs) {
+      throttle.log_state_latency(txc, logger,
+				 l_bluestore_state_deferred_queued_lat);
+    }
+    for (auto& [offset, io] : b->iomap) {
+      extents.emplace_back(offset, &io.bl);
+    }
+  }
+  std::stable_sort(extents.begin(), extents.end(),
+    [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  uint64_t max_bytes = deferred_coalesce_max_bytes.load();
+  uint64_t start = 0, pos = 0;
+  uint64_t merged = 0;
+  bufferlist bl;
+  auto flush = [&] {
+    dout(20) << __func__ << " write 0x" << std::hex
+	     << start << "~" << bl.length() << std::dec
+	     << " from " << merged << " extents" << dendl;
+    if (!g_conf()->bluestore_debug_omit_block_device_write) {
+      logger->inc(l_bluestore_submitted_deferred_writes);
+      logger->inc(l_bluestore_submitted_deferred_write_bytes, bl.length());
+      int r = bdev->aio_write(start, bl, &f->ioc, false);
+      ceph_assert(r == 0);
+      ++f->num_ios;
+    }
+    logger->inc(l_bluestore_deferred_flush_extents, merged);
+    bl.clear();
+    merged = 0;
+  };
+  for (auto& [offset, ebl] : extents) {
+    if (bl.length() &&
+	(offset != pos || bl.length() + ebl->length() > max_bytes)) {
+      flush();
+    }
+    if (!bl.length()) {
+      start = pos = offset;
+    }
+    pos += ebl->length();
+    bl.claim_append(*ebl);
+    ++merged;
+  }
+  if (bl.length()) {
+    flush();
+  }
+
+  dout(10) << __func__ << " " << f->batches.size() << " batches, "
+	   << extents.size() << " extents in " << f->num_ios << " ios"
+	   << dendl;
+  logger->inc(l_bluestore_deferred_flush_batches, f->batches.size());
+  logger->inc(l_bluestore_deferred_flush_ios, f->num_ios);
+  if (f->num_ios == 0) {
+    _deferred_flush_finish(f);
+    return;
+  }
+  deferred_inflight_ios += f->num_ios;
+  bdev->aio_submit(&f->ioc);
+}
+
+void BlueStore::_deferred_flush_finish(DeferredFlush *f)
+{
+  dout(10) << __func__ << " " << f->batches.size() << " batches" << dendl;
+  deferred_inflight_ios -= f->num_ios;
+  for (auto b : f->batches) {
+    _deferred_aio_finish(b->osr);
+  }
+  delete f;
+  if (deferred_flush_held.exchange(false)) {
+    dout(20) << __func__ << " queuing held deferred_try_submit" << dendl;
+    finisher.queue(new C_DeferredTrySubmit(this));
+  }
+}
+
 void BlueStore::_deferred_aio_finish(OpSequencer *osr)
 {
   dout(10) << __func__ << " osr " << osr << dendl;
@@ -16949,6 +17748,50 @@ void BlueStore::_do_write_big(
   }
 }
 
+void BlueStore::_compress_batch(Compressor *c, std::vector<CompressJob>& jobs)
+{
+  auto run = [c](CompressJob& j) {
+    auto start = mono_clock::now();
+    j.r = c->compress(*j.in, j.out, j.compressor_message);
+    j.lat = mono_clock::now() - start;
+  };
+  size_t workers = compress_finishers.size();
+  if (workers == 0 || jobs.size() < 2) {
+    for (auto& j : jobs) {
+      run(j);
+    }
+    return;
+  }
+  // job i goes to finisher i % (workers + 1); the last slot is ours, so
+  // that we keep working instead of just waiting
+  ceph::mutex lock = ceph::make_mutex("BlueStore::_compress_batch");
+  ceph::condition_variable cond;
+  size_t pending = 0;
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    size_t w = i % (workers + 1);
+    if (w == workers) {
+      continue;
+    }
+    {
+      std::lock_guard l(lock);
+      ++pending;
+    }
+    compress_finishers[w]->queue(new LambdaContext(
+      [&, i](int) {
+	run(jobs[i]);
+	std::lock_guard l(lock);
+	if (--pending == 0) {
+	  cond.notify_all();
+	}
+      }));
+  }
+  for (size_t i = workers; i < jobs.size(); i += workers + 1) {
+    run(jobs[i]);
+  }
+  std::unique_lock l(lock);
+  cond.wait(l, [&] { return pending == 0; });
+}
+
 int BlueStore::_do_alloc_write(
   TransContext *txc,
   CollectionRef coll,
@@ -16980,18 +17823,25 @@ int BlueStore::_do_alloc_write(
   // and the condition is : (data_size < deferred).
 
   auto max_bsize = std::max(wctx->target_blob_size, min_alloc_size);
+  std::vector<CompressJob> jobs;
+  if (wctx->compressor) {
+    for (auto& wi : wctx->writes) {
+      if (wi.blob_length > min_alloc_size) {
+	ceph_assert(wi.b_off == 0);
+	ceph_assert(wi.blob_length == wi.bl.length());
+	jobs.emplace_back();
+	jobs.back().in = &wi.bl;
+      }
+    }
+    _compress_batch(wctx->compressor.get(), jobs);
+  }
+  auto job = jobs.begin();
   for (auto& wi : wctx->writes) {
     if (wctx->compressor && wi.blob_length > min_alloc_size) {
-      auto start = mono_clock::now();
-
-      // compress
-      ceph_assert(wi.b_off == 0);
-      ceph_assert(wi.blob_length == wi.bl.length());
-
       // FIXME: memory alignment here is bad
-      bufferlist t;
-      std::optional<int32_t> compressor_message;
-      int r = wctx->compressor->compress(wi.bl, t, compressor_message);
+      bufferlist& t = job->out;
+      std::optional<int32_t>& compressor_message = job->compressor_message;
+      int r = job->r;
       uint64_t want_len_raw = wi.blob_length * wctx->crr;
       uint64_t want_len = p2roundup(want_len_raw, min_alloc_size);
       bool rejected = false;
@@ -17057,8 +17907,9 @@ int BlueStore::_do_alloc_write(
       }
       log_latency("compress@_do_alloc_write",
 	l_bluestore_compress_lat,
-        mono_clock::now() - start,
+	job->lat,
 	cct->_conf->bluestore_log_op_age );
+      ++job;
     } else {
       need += wi.blob_length;
       data_size += wi.bl.length();
@@ -17927,6 +18778,7 @@ int BlueStore::_do_remove(
     );
   }
   txc->t->rmkey(PREFIX_OBJ, o->key.c_str(), o->key.size());
+  onode_cold_cache->erase(std::string_view(o->key.c_str(), o->key.size()));
   txc->note_removed_object(o);
   o->extent_map.clear();
   o->onode = bluestore_onode_t();
@@ -18150,6 +19002,7 @@ void BlueStore::_do_omap_clear(TransContext *txc, OnodeRef& o)
   txc->t->rm_range_keys(omap_prefix, prefix, tail);
   txc->t->rmkey(omap_prefix, tail);
   o->onode.clear_omap_flag();
+  _drop_omap_bloom(o);
   dout(20) << __func__ << " remove range start: "
            << pretty_binary_string(prefix) << " end: "
            << pretty_binary_string(tail) << dendl;
@@ -18203,6 +19056,7 @@ int BlueStore::_omap_setkeys(TransContext *txc,
   string final_key;
   o->get_omap_key(string(), &final_key);
   size_t base_key_len = final_key.size();
+  OmapBloom *bloom = o->omap_bloom.load();
   decode(num, p);
   auto num0 = num;
   uint64_t total_bytes = 0;
@@ -18217,6 +19071,13 @@ int BlueStore::_omap_setkeys(TransContext *txc,
 	     << " <- " << key << dendl;
     txc->t->set(prefix, final_key, value);
     total_bytes += value.length();
+    if (bloom) {
+      bloom->insert(key);
+    }
+  }
+  if (bloom && bloom->is_full()) {
+    // rebuilt at the right size on the next lookup
+    _drop_omap_bloom(o);
   }
   logger->inc(l_bluestore_omap_setkeys_count);
   logger->inc(l_bluestore_omap_setkeys_records, num0);
@@ -18535,6 +19396,8 @@ int BlueStore::_rename(TransContext *txc,
   }
 
   txc->t->rmkey(PREFIX_OBJ, oldo->key.c_str(), oldo->key.size());
+  onode_cold_cache->erase(
+    std::string_view(oldo->key.c_str(), oldo->key.size()));
 
   // rewrite shards
   {
@@ -19162,6 +20025,7 @@ void BlueStore::_shutdown_cache()
   for (auto i : onode_cache_shards) {
     ceph_assert(i->empty());
   }
+  onode_cold_cache->clear();
   ceph_assert(Buffer::total == 0);
 }
 
@@ -19178,6 +20042,7 @@ int BlueStore::flush_cache(ostream *os)
   for (auto i : buffer_cache_shards) {
     i->flush();
   }
+  onode_cold_cache->clear();
 
   return 0;
 }
@@ -19199,7 +20064,8 @@ void BlueStore::_apply_padding(uint64_t head_pad,
   }
 }
 
-void BlueStore::_record_onode(OnodeRef& o, KeyValueDB::Transaction &txn)
+void BlueStore::_record_onode(OnodeRef& o, KeyValueDB::Transaction &txn,
+			      bool update_cold_cache)
 {
   // finalize extent_map shards
   o->extent_map.update(txn, false);
@@ -19246,6 +20112,14 @@ void BlueStore::_record_onode(OnodeRef& o, KeyValueDB::Transaction &txn)
 
 
   txn->set(PREFIX_OBJ, o->key.c_str(), o->key.size(), bl);
+  // fsck and injection paths may never submit txn, so only the regular
+  // transaction path may publish the new value to the cold cache
+  std::string_view key(o->key.c_str(), o->key.size());
+  if (update_cold_cache) {
+    onode_cold_cache->put(key, bl);
+  } else {
+    onode_cold_cache->erase(key);
+  }
 }
 
 void BlueStore::_log_alerts(osd_alert_list_t& alerts)
@@ -19809,6 +20683,9 @@ bool RocksDBBlueFSVolumeSelector::compare(BlueFSVolumeSelector* other) {
 
 static const std::string allocator_dir    = "ALLOCATOR_NCB_DIR";
 static const std::string allocator_file   = "ALLOCATOR_NCB_FILE";
+// bitmap freelist: written at umount, renamed to the base copy at mount
+static const std::string alloc_snapshot_file      = "ALLOCATOR_SNAPSHOT";
+static const std::string alloc_snapshot_base_file = "ALLOCATOR_SNAPSHOT_BASE";
 static uint32_t    s_format_version = 0x01; // support future changes to allocator-map file
 static uint32_t    s_serial         = 0x01;
 
@@ -20118,6 +20995,12 @@ const unsigned MAX_EXTENTS_IN_BUFFER = 4 * 1024; // 4K extents = 64KB of data
 // write the allocator to a flat bluefs file - 4K extents at a time
 //-----------------------------------------------------------------------------------
 int BlueStore::store_allocator(Allocator* src_allocator)
+{
+  return __store_allocator(src_allocator, allocator_file);
+}
+
+//-----------------------------------------------------------------------------------
+int BlueStore::__store_allocator(Allocator* src_allocator, const std::string& fname)
 {
   // when storing allocations to file we must be sure there is no background compactions
   // the easiest way to achieve it is to make sure db is closed
@@ -20135,10 +21018,10 @@ int BlueStore::store_allocator(Allocator* src_allocator)
   }
   bluefs->compact_log();
   // reuse previous file-allocation if exists
-  ret = bluefs->stat(allocator_dir, allocator_file, nullptr, nullptr);
+  ret = bluefs->stat(allocator_dir, fname, nullptr, nullptr);
   bool overwrite_file = (ret == 0);
   BlueFS::FileWriter *p_handle = nullptr;
-  ret = bluefs->open_for_write(allocator_dir, allocator_file, &p_handle, overwrite_file);
+  ret = bluefs->open_for_write(allocator_dir, fname, &p_handle, overwrite_file);
   if (ret != 0) {
     derr <<  __func__ << "Failed open_for_write with error-code " << ret << dendl;
     return -1;
@@ -20277,7 +21160,8 @@ int calc_allocator_image_trailer_size()
 }
 
 //-----------------------------------------------------------------------------------
-int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes)
+int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes,
+				   const std::string& fname)
 {
   if (cct->_conf->bluestore_debug_inject_allocation_from_file_failure > 0) {
      boost::mt11213b rng(time(NULL));
@@ -20289,7 +21173,7 @@ int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t
   }
   utime_t start_time = ceph_clock_now();
   BlueFS::FileReader *p_temp_handle = nullptr;
-  int ret = bluefs->open_for_read(allocator_dir, allocator_file, &p_temp_handle, false);
+  int ret = bluefs->open_for_read(allocator_dir, fname, &p_temp_handle, false);
   if (ret != 0) {
     dout(1) << "Failed open_for_read with error-code " << ret << dendl;
     return -1;
@@ -20438,7 +21322,7 @@ int BlueStore::restore_allocator(Allocator* dest_allocator, uint64_t *num, uint6
 {
   utime_t    start = ceph_clock_now();
   auto temp_allocator = unique_ptr<Allocator>(create_bitmap_allocator(bdev->get_size()));
-  int ret = __restore_allocator(temp_allocator.get(), num, bytes);
+  int ret = __restore_allocator(temp_allocator.get(), num, bytes, allocator_file);
   if (ret != 0) {
     return ret;
   }
@@ -20451,6 +21335,169 @@ int BlueStore::restore_allocator(Allocator* dest_allocator, uint64_t *num, uint6
   return ret;
 }
 
+//-----------------------------------------------------------------------------------
+// Allocator snapshot for the bitmap freelist.
+//
+// A clean umount stores the allocator in alloc_snapshot_file.  The next
+// mount loads it, renames it to alloc_snapshot_base_file and drops all
+// PREFIX_ALLOC_DIRTY keys.  From then on the freelist records every region
+// it touches under PREFIX_ALLOC_DIRTY, in the same kv transaction, so after
+// an unplanned shutdown the base copy can be brought up to date by
+// re-reading only those regions from the freelist.
+bool BlueStore::_alloc_snapshot_enabled()
+{
+  // NCB keeps its own allocation file and never writes the freelist
+  return cct->_conf.get_val<bool>("bluestore_alloc_snapshot") &&
+    (is_db_rotational() || !cct->_conf->bluestore_allocation_from_file);
+}
+
+//-----------------------------------------------------------------------------------
+int BlueStore::_restore_alloc_snapshot(uint64_t *num, uint64_t *bytes)
+{
+  if (before_expansion_bdev_size > 0) {
+    dout(1) << "device was expanded, ignoring allocator snapshot" << dendl;
+    return -ESTALE;
+  }
+  utime_t start = ceph_clock_now();
+  uint64_t snap_num = 0, snap_bytes = 0;
+  auto temp_allocator = unique_ptr<Allocator>(create_bitmap_allocator(bdev->get_size()));
+  if (!temp_allocator) {
+    return -ENOMEM;
+  }
+  int ret = __restore_allocator(temp_allocator.get(), &snap_num, &snap_bytes,
+				alloc_snapshot_file);
+  if (ret == 0) {
+    alloc_snapshot_clean = true;
+  } else {
+    // no clean-umount copy; start over from the base one
+    temp_allocator.reset(create_bitmap_allocator(bdev->get_size()));
+    if (!temp_allocator) {
+      return -ENOMEM;
+    }
+    ret = __restore_allocator(temp_allocator.get(), &snap_num, &snap_bytes,
+			      alloc_snapshot_base_file);
+    if (ret != 0) {
+      dout(1) << "no valid allocator snapshot" << dendl;
+      return ret;
+    }
+
+    interval_set<uint64_t> dirty;
+    KeyValueDB::Iterator it = db->get_iterator(PREFIX_ALLOC_DIRTY);
+    for (it->lower_bound(string()); it->valid(); it->next()) {
+      uint64_t offset, length;
+      string k = it->key();
+      _key_decode_u64(k.c_str(), &offset);
+      bufferlist v = it->value();
+      auto p = v.cbegin();
+      decode(length, p);
+      dirty.union_insert(offset, length);
+    }
+
+    uint64_t capacity = p2align(temp_allocator->get_capacity(), min_alloc_size);
+    uint64_t dirty_bytes = 0;
+    for (auto p = dirty.begin(); p != dirty.end(); ++p) {
+      uint64_t offset = p.get_start();
+      uint64_t end = std::min(p.get_end(), capacity);
+      if (offset >= end) {
+	continue;
+      }
+      // replace the region's stale state with what the freelist has now
+      temp_allocator->init_rm_free(offset, end - offset);
+      fm->enumerate_range(db, offset, end - offset,
+	[&](uint64_t o, uint64_t l) {
+	  temp_allocator->init_add_free(o, l);
+	});
+      dirty_bytes += end - offset;
+    }
+    dout(1) << "rebuilt " << dirty.num_intervals() << " dirty regions ("
+	    << byte_u_t(dirty_bytes) << ") on top of the base snapshot" << dendl;
+  }
+
+  uint64_t num_entries = 0;
+  copy_allocator(temp_allocator.get(), alloc, &num_entries);
+  *num = num_entries;
+  *bytes = alloc->get_free();
+  utime_t duration = ceph_clock_now() - start;
+  dout(1) << "restored " << (alloc_snapshot_clean ? "clean" : "base")
+	  << " snapshot in " << duration << " seconds, num_entries=" << num_entries << dendl;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------------
+int BlueStore::_store_alloc_snapshot()
+{
+  return __store_allocator(alloc, alloc_snapshot_file);
+}
+
+//-----------------------------------------------------------------------------------
+void BlueStore::_post_init_alloc_snapshot(bool to_repair)
+{
+  need_to_store_alloc_snapshot = false;
+  int r = 0;
+  if (fm->is_null_manager() || to_repair || !_alloc_snapshot_enabled()) {
+    // freelist changes would go untracked, so any snapshot gets stale
+    r = _remove_alloc_snapshots();
+    ceph_assert(r >= 0);
+    fm->set_dirty_region_tracking(string(), 0);
+    return;
+  }
+
+  if (alloc_snapshot_clean) {
+    // retire the clean copy before anything can change the freelist
+    r = bluefs->rename(allocator_dir, alloc_snapshot_file,
+		       allocator_dir, alloc_snapshot_base_file);
+    ceph_assert(r >= 0);
+    bluefs->sync_metadata(false);
+    auto t = db->get_transaction();
+    t->rmkeys_by_prefix(PREFIX_ALLOC_DIRTY);
+    r = db->submit_transaction_sync(t);
+    ceph_assert(r >= 0);
+  } else if (alloc_snapshot_used) {
+    // brought the base copy up to date; a clean copy, if any, is broken
+    if (bluefs->stat(allocator_dir, alloc_snapshot_file, nullptr, nullptr) == 0) {
+      r = bluefs->unlink(allocator_dir, alloc_snapshot_file);
+      ceph_assert(r >= 0);
+      bluefs->sync_metadata(false);
+    }
+  } else {
+    // rebuilt from the freelist: whatever is on disk is not to be trusted
+    // (e.g. the device was expanded) and the next umount starts afresh
+    r = _remove_alloc_snapshots();
+    ceph_assert(r >= 0);
+  }
+  fm->set_dirty_region_tracking(
+    PREFIX_ALLOC_DIRTY,
+    cct->_conf.get_val<Option::size_t>("bluestore_alloc_snapshot_region_size"));
+  need_to_store_alloc_snapshot = true;
+}
+
+//-----------------------------------------------------------------------------------
+int BlueStore::_remove_alloc_snapshots()
+{
+  if (!bluefs->dir_exists(allocator_dir)) {
+    return 0;
+  }
+  bool removed = false;
+  for (auto& fname : {alloc_snapshot_file, alloc_snapshot_base_file}) {
+    if (bluefs->stat(allocator_dir, fname, nullptr, nullptr) != 0) {
+      continue;
+    }
+    dout(1) << "removing " << fname << dendl;
+    int r = bluefs->unlink(allocator_dir, fname);
+    if (r < 0) {
+      derr << "failed to unlink " << fname << ": " << cpp_strerror(r) << dendl;
+      return r;
+    }
+    removed = true;
+  }
+  // leftover PREFIX_ALLOC_DIRTY keys are harmless: a new base copy only
+  // appears together with their removal
+  if (removed) {
+    bluefs->sync_metadata(false);
+  }
+  return 0;
+}
+
 //-----------------------------------------------------------------------------------
 void BlueStore::set_allocation_in_simple_bmap(SimpleBitmap* sbmap, uint64_t offset, uint64_t length)
 {
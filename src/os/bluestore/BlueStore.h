@@ -43,6 +43,7 @@
 #include "include/cpp-btree/btree_set.h"
 
 #include "include/ceph_assert.h"
+#include "include/flat_hash_map.h"
 #include "include/interval_set.h"
 #include "include/mempool.h"
 #include "include/hash.h"
@@ -52,12 +53,14 @@
 #include "common/Throttle.h"
 #include "common/perf_counters.h"
 #include "common/PriorityCache.h"
+#include "common/Readahead.h"
 #include "compressor/Compressor.h"
 #include "os/ObjectStore.h"
 
 #include "bluestore_types.h"
 #include "bluestore_common.h"
 #include "BlueFS.h"
+#include "OnodeColdCache.h"
 #include "common/EventTrace.h"
 #include "common/admin_socket.h"
 
@@ -126,7 +129,10 @@ enum {
   l_bluestore_kv_flush_lat,
   l_bluestore_kv_commit_lat,
   l_bluestore_kv_sync_lat,
+  l_bluestore_kv_submit_lat,
   l_bluestore_kv_final_lat,
+  l_bluestore_kv_group_commit_batch,
+  l_bluestore_kv_group_commit_wait_lat,
   //****************************************
 
   // write op stats
@@ -150,6 +156,10 @@ enum {
   l_bluestore_issued_deferred_write_bytes,
   l_bluestore_submitted_deferred_writes,
   l_bluestore_submitted_deferred_write_bytes,
+  l_bluestore_deferred_flush_batches,
+  l_bluestore_deferred_flush_ios,
+  l_bluestore_deferred_flush_extents,
+  l_bluestore_deferred_flush_held,
 
   l_bluestore_write_big_skipped_blobs,
   l_bluestore_write_big_skipped_bytes,
@@ -176,6 +186,9 @@ enum {
   l_bluestore_onode_misses,
   l_bluestore_onode_shard_hits,
   l_bluestore_onode_shard_misses,
+  l_bluestore_onode_cold_hits,
+  l_bluestore_onode_cold_entries,
+  l_bluestore_onode_cold_bytes,
   l_bluestore_extents,
   l_bluestore_blobs,
   l_bluestore_spanning_blobs,
@@ -187,6 +200,13 @@ enum {
   l_bluestore_buffer_bytes,
   l_bluestore_buffer_hit_bytes,
   l_bluestore_buffer_miss_bytes,
+  l_bluestore_readahead_ops,
+  l_bluestore_readahead_bytes,
+  l_bluestore_readahead_dropped,
+  l_bluestore_readahead_hit_bytes,
+  l_bluestore_readahead_miss_bytes,
+  l_bluestore_onode_prefetch,
+  l_bluestore_onode_prefetch_dropped,
   //****************************************
 
   // internal stats
@@ -207,6 +227,8 @@ enum {
   l_bluestore_omap_setkeys_count,
   l_bluestore_omap_setkeys_records,
   l_bluestore_omap_setkeys_bytes,
+  l_bluestore_omap_bloom_builds,
+  l_bluestore_omap_bloom_skipped,
   //****************************************
 
   // other client ops latencies
@@ -264,6 +286,8 @@ public:
     max_defer_interval =
 	cct->_conf.get_val<double>("bluestore_max_defer_interval");
   }
+  void _set_readahead();
+  void _set_omap_bloom();
 
   struct TransContext;
 
@@ -597,7 +621,7 @@ public:
 
     // we use a bare pointer because we don't want to affect the ref
     // count
-    mempool::bluestore_cache_meta::unordered_map<uint64_t,SharedBlob*> sb_map;
+    mempool::bluestore_cache_meta::flat_hash_map<uint64_t,SharedBlob*> sb_map;
 
     SharedBlobRef lookup(uint64_t sbid) {
       std::lock_guard l(lock);
@@ -1297,6 +1321,42 @@ public:
 				    uint64_t min_alloc_size);
   };
 
+  /// sequential read stream of an onode
+  struct OnodeReadahead {
+    Readahead ra;
+    /// range covered by completed prefetches of the current stream
+    std::atomic<uint64_t> done_start = {0};
+    std::atomic<uint64_t> done_end = {0};
+
+    bool covers(uint64_t offset, uint64_t length) const {
+      return offset < done_end && offset + length > done_start;
+    }
+  };
+
+  /// approximate set of the omap keys of an onode; a miss means the key
+  /// is definitely absent.  Only ever grows between omap clears, so it is
+  /// a superset of both the committed and the queued keys.
+  struct OmapBloom {
+    bloom_filter filter;
+    bool overflow = false;  ///< too many keys to track; always says maybe
+
+    OmapBloom() : overflow(true) {}
+    OmapBloom(size_t expected, double fpp) : filter(expected, fpp, 0) {}
+
+    void insert(const std::string& key) {
+      if (!overflow) {
+        filter.insert(key);
+      }
+    }
+    bool may_contain(const std::string& key) const {
+      return overflow || filter.contains(key);
+    }
+    /// took more inserts than it was sized for and should be rebuilt
+    bool is_full() const {
+      return !overflow && filter.is_full();
+    }
+  };
+
   struct OnodeSpace;
   struct OnodeCacheShard;
   /// an in-memory object
@@ -1330,6 +1390,11 @@ public:
     ceph::mutex flush_lock = ceph::make_mutex("BlueStore::Onode::flush_lock");
     ceph::condition_variable flush_cond;   ///< wait here for uncommitted txns
     std::shared_ptr<int64_t> cache_age_bin;  ///< cache age bin
+    /// allocated on the first read when readahead is enabled
+    std::atomic<OnodeReadahead*> readahead = {nullptr};
+    /// built on the first omap lookup when the omap bloom is enabled;
+    /// updated and dropped under the exclusive collection lock
+    std::atomic<OmapBloom*> omap_bloom = {nullptr};
 
     Onode(Collection *c, const ghobject_t& o,
 	  const mempool::bluestore_cache_meta::string& k)
@@ -1354,6 +1419,8 @@ public:
     }
 
     ~Onode() {
+      delete readahead.load();
+      delete omap_bloom.load();
       if (c) {
         std::lock_guard l(c->cache->lock);
         bc._clear(c->cache);
@@ -2133,10 +2200,26 @@ public:
     }
   };
 
+  /// pending batches of several OpSequencers, written as one set of
+  /// LBA-ordered, coalesced ios
+  struct DeferredFlush final : public AioContext {
+    std::vector<DeferredBatch*> batches;
+    IOContext ioc;                   ///< our aios
+    uint64_t num_ios = 0;
+
+    DeferredFlush(CephContext *cct)
+      : ioc(cct, this) {}
+
+    void aio_finish(BlueStore *store) override {
+      store->_deferred_flush_finish(this);
+    }
+  };
+
   class OpSequencer : public RefCountedObject {
   public:
-    ceph::mutex qlock = ceph::make_mutex("BlueStore::OpSequencer::qlock");
-    ceph::condition_variable qcond;
+    ceph::adaptive_mutex qlock =
+      ceph::make_adaptive_mutex("BlueStore::OpSequencer::qlock");
+    ceph::adaptive_condition_variable qcond;
     typedef boost::intrusive::list<
       TransContext,
       boost::intrusive::member_hook<
@@ -2287,6 +2370,20 @@ public:
       return NULL;
     }
   };
+  /// submits txcs on behalf of the kv_sync thread, so that rocksdb can
+  /// group concurrent writers; every txc of an osr goes to the same one
+  struct KVSubmitThread : public Thread {
+    BlueStore *store;
+    ceph::mutex lock = ceph::make_mutex("BlueStore::KVSubmitThread::lock");
+    ceph::condition_variable cond;
+    std::deque<TransContext*> q;
+    bool stop = false;
+    explicit KVSubmitThread(BlueStore *s) : store(s) {}
+    void *entry() override {
+      store->_kv_submit_thread(this);
+      return NULL;
+    }
+  };
 
   struct BigDeferredWriteContext {
     uint64_t off = 0;     // original logical offset
@@ -2336,6 +2433,16 @@ private:
   // store open_db options:
   bool db_was_opened_read_only = true;
   bool need_to_destage_allocation_file = false;
+  // allocator snapshot (bitmap freelist only), see _restore_alloc_snapshot()
+  bool alloc_snapshot_used = false;   ///< allocator was loaded from a snapshot
+  bool alloc_snapshot_clean = false;  ///< ... written by a clean umount
+  bool need_to_store_alloc_snapshot = false;
+
+  /// wall time of each step of the last mount or fsck
+  /// ("bluestore startup timings")
+  ceph::mutex startup_timings_lock =
+    ceph::make_mutex("BlueStore::startup_timings_lock");
+  std::vector<std::pair<std::string, ceph::timespan>> startup_timings;
 
   ///< rwlock to protect coll_map/new_coll_map
   ceph::shared_mutex coll_lock = ceph::make_shared_mutex("BlueStore::coll_lock");
@@ -2345,6 +2452,8 @@ private:
 
   mempool::bluestore_cache_buffer::vector<BufferCacheShard*> buffer_cache_shards;
   mempool::bluestore_cache_onode::vector<OnodeCacheShard*> onode_cache_shards;
+  /// encoded onodes backing onode_cache_shards
+  std::unique_ptr<OnodeColdCache> onode_cold_cache;
 
   /// protect zombie_osr_set
   ceph::mutex zombie_osr_lock = ceph::make_mutex("BlueStore::zombie_osr_lock");
@@ -2363,10 +2472,28 @@ private:
   deferred_osr_queue_t deferred_queue; ///< osr's with deferred io pending
   std::atomic_int deferred_queue_size = {0};         ///< num txc's queued across all osrs
   std::atomic_int deferred_aggressive = {0}; ///< aggressive wakeup of kv thread
+  std::atomic_int deferred_inflight_ios = {0}; ///< coalesced deferred ios in flight
+  std::atomic_bool deferred_flush_held = {false}; ///< submission held for queue depth
   Finisher  finisher;
   utime_t  deferred_last_submitted = utime_t();
 
+  Finisher readahead_finisher;  ///< runs prefetch reads
+  std::atomic_bool readahead_running = {false}; ///< prefetch finishers too
+  std::atomic<uint64_t> readahead_inflight_bytes = {0};
+  /// load onodes hinted by prefetch_object, picked by object hash
+  std::vector<std::unique_ptr<Finisher>> onode_prefetch_finishers;
+  /// protect onode_prefetch_finishers against _kv_start/_kv_stop
+  ceph::shared_mutex onode_prefetch_lock =
+    ceph::make_shared_mutex("BlueStore::onode_prefetch_lock");
+  std::atomic<uint64_t> onode_prefetch_queued = {0};
+  /// compress blobs of a write concurrently with the submitting thread
+  std::vector<std::unique_ptr<Finisher>> compress_finishers;
+
   KVSyncThread kv_sync_thread;
+  std::vector<std::unique_ptr<KVSubmitThread>> kv_submit_threads;
+  ceph::mutex kv_submit_lock = ceph::make_mutex("BlueStore::kv_submit_lock");
+  ceph::condition_variable kv_submit_cond;
+  uint64_t kv_submit_pending = 0;  ///< handed to kv_submit_threads, not done
   ceph::mutex kv_lock = ceph::make_mutex("BlueStore::kv_lock");
   ceph::condition_variable kv_cond;
   bool _kv_only = false;
@@ -2379,6 +2506,8 @@ private:
   std::deque<TransContext*> kv_committing;        ///< currently syncing
   std::deque<DeferredBatch*> deferred_done_queue;   ///< deferred ios done
   bool kv_sync_in_progress = false;
+  double kv_sync_lat_avg = 0;  ///< moving avg of kv flush+commit time (sec)
+  double kv_batch_avg = 0;     ///< moving avg of txcs per kv commit
 
   KVFinalizeThread kv_finalize_thread;
   ceph::mutex kv_finalize_lock = ceph::make_mutex("BlueStore::kv_finalize_lock");
@@ -2426,6 +2555,12 @@ private:
   ///< number threshold for forced deferred writes
   std::atomic<int> deferred_batch_ops = {0};
 
+  ///< max size of a coalesced deferred io (0 = submit per OpSequencer)
+  std::atomic<uint64_t> deferred_coalesce_max_bytes = {0};
+
+  ///< in-flight coalesced deferred ios above which submission is held
+  std::atomic<int> deferred_coalesce_queue_depth = {0};
+
   ///< size threshold for forced deferred writes
   std::atomic<uint64_t> prefer_deferred_size = {0};
 
@@ -2453,6 +2588,7 @@ private:
   double cache_meta_ratio = 0;   ///< cache ratio dedicated to metadata
   double cache_kv_ratio = 0;     ///< cache ratio dedicated to kv (e.g., rocksdb)
   double cache_kv_onode_ratio = 0; ///< cache ratio dedicated to kv onodes (e.g., rocksdb onode CF)
+  double cache_meta_cold_ratio = 0; ///< cache ratio dedicated to encoded onodes
   double cache_data_ratio = 0;   ///< cache ratio dedicated to object data
   bool cache_autotune = false;   ///< cache autotune setting
   double cache_age_bin_interval = 0; ///< time to wait between cache age bin rotations
@@ -2467,6 +2603,12 @@ private:
   uint64_t osd_memory_cache_min = 0; ///< Min memory to assign when autotuning cache
   double osd_memory_cache_resize_interval = 0; ///< Time to wait between cache resizing 
   double max_defer_interval = 0; ///< Time to wait between last deferred submit
+  std::atomic<uint64_t> readahead_max_bytes = {0}; ///< 0 disables readahead
+  std::atomic<uint64_t> readahead_min_bytes = {0};
+  std::atomic<uint64_t> readahead_budget_bytes = {0}; ///< cap on queued prefetch
+  std::atomic<int> readahead_trigger_requests = {0};
+  std::atomic<uint64_t> omap_bloom_max_keys = {0}; ///< 0 disables omap bloom
+  std::atomic<double> omap_bloom_fpp = {0.01};
   std::atomic<uint32_t> config_changed = {0}; ///< Counter to determine if there is a configuration change.
 
   // caching of bdev_label
@@ -2703,11 +2845,37 @@ private:
     };
     std::shared_ptr<DataCache> data_cache;
 
+    // The cold onode tier is not age binned: everything it holds is
+    // requested at the LAST priority, so it only grows into memory the
+    // other caches leave unused.
+    struct MetaColdCache : public MempoolCache {
+      MetaColdCache(BlueStore *s) : MempoolCache(s) {};
+
+      virtual uint32_t get_bin_count() const {
+        return 0;
+      }
+      virtual void set_bin_count(uint32_t count) {
+      }
+      virtual uint64_t _get_used_bytes() const {
+        return store->onode_cold_cache->get_bytes();
+      }
+      virtual void shift_bins() {
+      }
+      virtual uint64_t _sum_bins(uint32_t start, uint32_t end) const {
+        return 0;
+      }
+      virtual std::string get_cache_name() const {
+        return "BlueStore Meta Cold Cache";
+      }
+    };
+    std::shared_ptr<MetaColdCache> meta_cold_cache;
+
   public:
     explicit MempoolThread(BlueStore *s)
       : store(s),
         meta_cache(new MetaCache(s)),
-        data_cache(new DataCache(s)) {}
+        data_cache(new DataCache(s)),
+        meta_cold_cache(new MetaColdCache(s)) {}
 
     void *entry() override;
     void init() {
@@ -2738,6 +2906,10 @@ private:
 
   void _init_logger();
   void _shutdown_logger();
+  void _reset_startup_timings();
+  void _note_startup_phase(std::string_view phase,
+			   ceph::mono_clock::time_point start);
+  void _note_bluefs_replay(std::string_view phase);
   int _reload_logger();
 
   int _open_path();
@@ -2796,6 +2968,11 @@ private:
   int _create_alloc();
   int _init_alloc();
   void _post_init_alloc();
+  bool _alloc_snapshot_enabled();
+  int _restore_alloc_snapshot(uint64_t *num, uint64_t *bytes);
+  int _store_alloc_snapshot();
+  void _post_init_alloc_snapshot(bool to_repair);
+  int _remove_alloc_snapshots();
   void _close_alloc();
   int _open_collections();
   void _fsck_collections(int64_t* errors);
@@ -2887,7 +3064,11 @@ private:
   void _kv_start();
   void _kv_stop();
   void _kv_sync_thread();
+  void _kv_submit_thread(KVSubmitThread *t);
+  void _kv_submit_queue(TransContext *txc);
+  void _kv_submit_wait();
   void _kv_finalize_thread();
+  ceph::timespan _kv_group_commit_window(size_t queued) const;
 
   bluestore_deferred_op_t *_get_deferred_op(TransContext *txc, uint64_t len);
   void _deferred_queue(TransContext *txc);
@@ -2896,6 +3077,8 @@ public:
 private:
   void _deferred_submit_unlock(OpSequencer *osr);
   void _deferred_aio_finish(OpSequencer *osr);
+  void _deferred_submit_coalesced(const std::vector<OpSequencerRef>& osrs);
+  void _deferred_flush_finish(DeferredFlush *f);
   int _deferred_replay();
   bool _eliminate_outdated_deferred(bluestore_deferred_transaction_t* deferred_txn,
 				    interval_set<uint64_t>& bluefs_extents);
@@ -3008,7 +3191,8 @@ private:
 		      uint64_t tail_pad,
 		      ceph::buffer::list& padded);
 
-  void _record_onode(OnodeRef &o, KeyValueDB::Transaction &txn);
+  void _record_onode(OnodeRef &o, KeyValueDB::Transaction &txn,
+		     bool update_cold_cache = false);
 
   // -- ondisk version ---
 public:
@@ -3179,6 +3363,9 @@ public:
   void collect_metadata(std::map<std::string,std::string> *pm) override;
 
   bool exists(CollectionHandle &c, const ghobject_t& oid) override;
+  void prefetch_object(CollectionHandle &c, const ghobject_t& oid) override;
+  /// load oid's onode into the cache (runs on onode_prefetch_finishers)
+  void do_prefetch_object(CollectionRef c, const ghobject_t& oid);
   int set_collection_opts(
     CollectionHandle& c,
     const pool_opts_t& opts) override;
@@ -3278,6 +3465,18 @@ private:
     uint32_t op_flags = 0,
     uint64_t retry_count = 0);
 
+  void _maybe_readahead(
+    Collection *c,
+    OnodeRef& o,
+    uint64_t offset,
+    uint64_t length,
+    uint32_t op_flags);
+public:
+  /// prefetch into the onode's buffer cache (runs on readahead_finisher)
+  void do_readahead(CollectionRef c, OnodeRef o,
+		    uint64_t offset, uint64_t length);
+private:
+
   void _do_read_and_pad(
     Collection* c,
     OnodeRef& o,
@@ -3308,6 +3507,11 @@ public:
     ceph::buffer::list& bl,
     uint32_t op_flags) override;
 
+  int get_locality_hints(
+    CollectionHandle &c_,
+    const std::vector<ghobject_t>& oids,
+    std::vector<uint64_t> *hints) override;
+
   int dump_onode(CollectionHandle &c, const ghobject_t& oid,
     const std::string& section_name, ceph::Formatter *f) override;
 
@@ -3474,6 +3678,10 @@ public:
 			   coll_t cid2, ghobject_t oid2,
 			   uint64_t offset);
   void inject_zombie_spanning_blob(coll_t cid, ghobject_t oid, int16_t blob_id);
+  // next umount leaves the allocator snapshot behind as after a crash
+  void inject_alloc_snapshot_loss() {
+    need_to_store_alloc_snapshot = false;
+  }
   // resets global per_pool_omap in DB
   void inject_legacy_omap();
   // resets per_pool_omap | pgmeta_omap for onode
@@ -3633,6 +3841,10 @@ private:
     uint64_t blob_xoffset,
     const ceph::buffer::list& bl,
     uint64_t logical_offset);
+  void _prime_read_crc(
+    const bluestore_blob_t& blob,
+    uint64_t blob_xoffset,
+    ceph::buffer::list& bl);
   int _decompress(ceph::buffer::list& source, ceph::buffer::list* result);
 
 
@@ -3761,6 +3973,17 @@ private:
     CollectionRef c,
     OnodeRef& o,
     WriteContext *wctx);
+
+  /// one buffer to compress in a _compress_batch call
+  struct CompressJob {
+    const ceph::buffer::list *in = nullptr;
+    ceph::buffer::list out;
+    std::optional<int32_t> compressor_message;
+    int r = 0;
+    ceph::timespan lat;
+  };
+  /// compress every job with c, spread over compress_finishers if any
+  void _compress_batch(Compressor *c, std::vector<CompressJob>& jobs);
   void _wctx_finish(
     TransContext *txc,
     CollectionRef& c,
@@ -3860,6 +4083,12 @@ private:
 	       CollectionRef& c,
 	       OnodeRef& o);
   void _do_omap_clear(TransContext *txc, OnodeRef& o);
+  /// bloom over o's omap keys, building it if needed; nullptr if disabled
+  /// or too many keys.  Caller holds c->lock and has flushed o.
+  OmapBloom *_get_omap_bloom(OnodeRef& o);
+  void _drop_omap_bloom(OnodeRef& o) {
+    delete o->omap_bloom.exchange(nullptr);
+  }
   int _omap_clear(TransContext *txc,
 		  CollectionRef& c,
 		  OnodeRef& o);
@@ -4100,9 +4329,11 @@ private:
 				      uint64_t  *p_extent_count, const void *v_header, BlueFS::FileReader *p_handle, uint64_t offset);
 
   int  copy_allocator(Allocator* src_alloc, Allocator *dest_alloc, uint64_t* p_num_entries);
+  int  __store_allocator(Allocator* allocator, const std::string& fname);
   int  store_allocator(Allocator* allocator);
   int  invalidate_allocation_file_on_bluefs();
-  int  __restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes);
+  int  __restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes,
+			   const std::string& fname);
   int  restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes);
   int  read_allocation_from_drive_on_startup();
   int  reconstruct_allocations(SimpleBitmap *smbmp, read_alloc_stats_t &stats);
@@ -37,6 +37,15 @@ public:
 
   virtual void enumerate_reset() = 0;
   virtual bool enumerate_next(KeyValueDB *kvdb, uint64_t *offset, uint64_t *length) = 0;
+  /// report free extents within [offset, offset+length) to cb
+  virtual void enumerate_range(KeyValueDB *kvdb,
+    uint64_t offset, uint64_t length,
+    std::function<void(uint64_t, uint64_t)> cb) = 0;
+
+  /// record every touched region_size-aligned region under prefix in the
+  /// same transaction as the freelist update (empty prefix disables)
+  virtual void set_dirty_region_tracking(const std::string& prefix,
+    uint64_t region_size) = 0;
 
   virtual void allocate(
     uint64_t offset, uint64_t length,
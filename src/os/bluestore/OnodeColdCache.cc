@@ -0,0 +1,229 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ */
+
+#include "OnodeColdCache.h"
+
+#include "common/debug.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_bluestore
+#undef dout_prefix
+#define dout_prefix *_dout << "bluestore.OnodeColdCache "
+
+using ceph::bufferlist;
+
+namespace {
+// Values handed to us come from kv reads or transaction encoding and may
+// sit in larger buffers; keep only the bytes we account for.
+bufferlist exact_copy(const bufferlist& in)
+{
+  bufferlist out;
+  if (in.length()) {
+    ceph::buffer::ptr bp(in.length());
+    in.begin().copy(in.length(), bp.c_str());
+    out.append(std::move(bp));
+  }
+  return out;
+}
+}
+
+void OnodeColdCache::Shard::_erase(std::list<Entry>::iterator p)
+{
+  bytes -= p->cost();
+  if (p->raw_len) {
+    raw_compressed -= p->raw_len;
+  }
+  index.erase(std::string_view(p->key));
+  lru.erase(p);
+}
+
+void OnodeColdCache::Shard::_trim()
+{
+  while (bytes > max && !lru.empty()) {
+    _erase(std::prev(lru.end()));
+  }
+}
+
+OnodeColdCache::OnodeColdCache(CephContext *cct, size_t num_shards)
+  : cct(cct)
+{
+  if (num_shards == 0) {
+    num_shards = 1;
+  }
+  shards.reserve(num_shards);
+  for (size_t i = 0; i < num_shards; ++i) {
+    shards.emplace_back(std::make_unique<Shard>());
+  }
+}
+
+OnodeColdCache::~OnodeColdCache()
+{
+  clear();
+}
+
+void OnodeColdCache::set_compressor(CompressorRef c)
+{
+  std::lock_guard l(compressor_lock);
+  compressor = std::move(c);
+}
+
+CompressorRef OnodeColdCache::get_compressor()
+{
+  std::lock_guard l(compressor_lock);
+  return compressor;
+}
+
+OnodeColdCache::Shard& OnodeColdCache::shard_for(std::string_view key)
+{
+  return *shards[std::hash<std::string_view>{}(key) % shards.size()];
+}
+
+bool OnodeColdCache::get(std::string_view key, bufferlist *v)
+{
+  if (!enabled()) {
+    return false;
+  }
+  bufferlist data;
+  uint32_t raw_len;
+  std::optional<int32_t> compressor_message;
+  Shard& s = shard_for(key);
+  {
+    std::lock_guard l(s.lock);
+    auto p = s.index.find(key);
+    if (p == s.index.end()) {
+      return false;
+    }
+    s.lru.splice(s.lru.begin(), s.lru, p->second);
+    data = p->second->data;
+    raw_len = p->second->raw_len;
+    compressor_message = p->second->compressor_message;
+  }
+  if (!raw_len) {
+    *v = std::move(data);
+    return true;
+  }
+  auto c = get_compressor();
+  bufferlist out;
+  if (!c || c->decompress(data, out, compressor_message) < 0 ||
+      out.length() != raw_len) {
+    // compressor changed or value is unusable; fall back to the kv store
+    ldout(cct, 10) << __func__ << " failed to decompress entry, dropping"
+		   << dendl;
+    erase(key);
+    return false;
+  }
+  *v = std::move(out);
+  return true;
+}
+
+void OnodeColdCache::put(std::string_view key, const bufferlist& v)
+{
+  if (!enabled()) {
+    return;
+  }
+  Entry e;
+  e.key = std::string(key);
+  if (auto c = get_compressor(); c) {
+    bufferlist out;
+    std::optional<int32_t> compressor_message;
+    if (c->compress(v, out, compressor_message) == 0 &&
+	out.length() < v.length()) {
+      e.data = exact_copy(out);
+      e.raw_len = v.length();
+      e.compressor_message = compressor_message;
+    }
+  }
+  if (!e.raw_len) {
+    e.data = exact_copy(v);
+  }
+
+  Shard& s = shard_for(key);
+  std::lock_guard l(s.lock);
+  if (auto p = s.index.find(key); p != s.index.end()) {
+    s._erase(p->second);
+  }
+  if (e.cost() > s.max) {
+    return;
+  }
+  s.lru.push_front(std::move(e));
+  auto& front = s.lru.front();
+  s.index.emplace(std::string_view(front.key), s.lru.begin());
+  s.bytes += front.cost();
+  if (front.raw_len) {
+    s.raw_compressed += front.raw_len;
+  }
+  s._trim();
+}
+
+void OnodeColdCache::erase(std::string_view key)
+{
+  if (!enabled()) {
+    return;
+  }
+  Shard& s = shard_for(key);
+  std::lock_guard l(s.lock);
+  if (auto p = s.index.find(key); p != s.index.end()) {
+    s._erase(p->second);
+  }
+}
+
+void OnodeColdCache::clear()
+{
+  for (auto& s : shards) {
+    std::lock_guard l(s->lock);
+    s->index.clear();
+    s->lru.clear();
+    s->bytes = 0;
+    s->raw_compressed = 0;
+  }
+}
+
+void OnodeColdCache::set_max_bytes(uint64_t max)
+{
+  max_bytes = max;
+  uint64_t per_shard = max / shards.size();
+  for (auto& s : shards) {
+    std::lock_guard l(s->lock);
+    s->max = per_shard;
+    s->_trim();
+  }
+}
+
+uint64_t OnodeColdCache::get_bytes() const
+{
+  uint64_t total = 0;
+  for (auto& s : shards) {
+    std::lock_guard l(s->lock);
+    total += s->bytes;
+  }
+  return total;
+}
+
+uint64_t OnodeColdCache::get_num_entries() const
+{
+  uint64_t total = 0;
+  for (auto& s : shards) {
+    std::lock_guard l(s->lock);
+    total += s->lru.size();
+  }
+  return total;
+}
+
+uint64_t OnodeColdCache::get_raw_bytes_compressed() const
+{
+  uint64_t total = 0;
+  for (auto& s : shards) {
+    std::lock_guard l(s->lock);
+    total += s->raw_compressed;
+  }
+  return total;
+}
@@ -0,0 +1,110 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ */
+
+#ifndef CEPH_OS_BLUESTORE_ONODECOLDCACHE_H
+#define CEPH_OS_BLUESTORE_ONODECOLDCACHE_H
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "common/ceph_mutex.h"
+#include "compressor/Compressor.h"
+#include "include/buffer.h"
+
+/**
+ * OnodeColdCache
+ *
+ * Second tier behind the decoded onode LRU.  It keeps the encoded
+ * PREFIX_OBJ value of recently used onodes, optionally compressed, so
+ * that an onode trimmed from the OnodeCacheShard can be rebuilt without
+ * a kv lookup.  Entries are kept in sync with the kv store by the write
+ * path: every onode update replaces the cached value and every removal
+ * drops it.
+ *
+ * The cache is sharded by key hash and is independent of collections,
+ * so split/merge do not need to move entries around.
+ */
+class OnodeColdCache {
+public:
+  /// rough per-entry bookkeeping cost on top of key and value bytes
+  static constexpr size_t ENTRY_OVERHEAD = 96;
+
+  OnodeColdCache(CephContext *cct, size_t num_shards);
+  ~OnodeColdCache();
+
+  /// compress values with c (nullptr stores them as-is)
+  void set_compressor(CompressorRef c);
+
+  /// if cached, fill *v with the decoded (uncompressed) value
+  bool get(std::string_view key, ceph::buffer::list *v);
+  /// insert or replace the value for key
+  void put(std::string_view key, const ceph::buffer::list& v);
+  void erase(std::string_view key);
+  void clear();
+
+  /// total byte budget, split evenly across shards; 0 disables the cache
+  void set_max_bytes(uint64_t max);
+  uint64_t get_max_bytes() const {
+    return max_bytes;
+  }
+  bool enabled() const {
+    return max_bytes > 0;
+  }
+
+  uint64_t get_bytes() const;
+  uint64_t get_num_entries() const;
+  /// sum of original value lengths of the compressed entries
+  uint64_t get_raw_bytes_compressed() const;
+
+private:
+  struct Entry {
+    std::string key;
+    ceph::buffer::list data;
+    uint32_t raw_len = 0;      ///< 0 if data is not compressed
+    std::optional<int32_t> compressor_message;
+
+    size_t cost() const {
+      return key.size() + data.length() + ENTRY_OVERHEAD;
+    }
+  };
+
+  struct Shard {
+    ceph::mutex lock = ceph::make_mutex("OnodeColdCache::Shard::lock");
+    std::list<Entry> lru;      ///< most recently used at the front
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+    uint64_t bytes = 0;
+    uint64_t max = 0;
+    uint64_t raw_compressed = 0;
+
+    void _erase(std::list<Entry>::iterator p);
+    void _trim();
+  };
+
+  CephContext *cct;
+  std::vector<std::unique_ptr<Shard>> shards;
+  std::atomic<uint64_t> max_bytes = {0};
+
+  ceph::mutex compressor_lock =
+    ceph::make_mutex("OnodeColdCache::compressor_lock");
+  CompressorRef compressor;
+
+  Shard& shard_for(std::string_view key);
+  CompressorRef get_compressor();
+};
+
+#endif
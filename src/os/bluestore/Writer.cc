@@ -251,7 +251,7 @@ inline BlueStore::extent_map_t::iterator BlueStore::Writer::_find_mutable_blob_l
     if (search_begin > it->blob_start()) continue;
     if (it->blob_end() > search_end) continue;
     if (it->blob_start() > mapmust_begin) continue;
-    auto bblob = it->blob->get_blob();
+    const auto& bblob = it->blob->get_blob();
     if (!bblob.is_mutable()) continue;
     if (bblob.has_csum()) {
       uint32_t mask = (mapmust_begin - it->blob_start()) |
@@ -280,7 +280,7 @@ inline BlueStore::extent_map_t::iterator BlueStore::Writer::_find_mutable_blob_r
     if (search_begin > it->blob_start()) continue;
     if (it->blob_end() > search_end) continue;
     if (it->blob_start() > mapmust_begin) continue;
-    auto bblob = it->blob->get_blob();
+    const auto& bblob = it->blob->get_blob();
     if (!bblob.is_mutable()) continue;
     if (bblob.has_csum()) {
       uint32_t mask = (mapmust_begin - it->blob_start()) |
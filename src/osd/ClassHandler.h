@@ -22,7 +22,7 @@ public:
     const std::string name;
     using func_t = std::variant<cls_method_cxx_call_t, cls_method_call_t>;
     func_t func;
-    int flags = 0;
+    const int flags = 0;
     ClassData *cls = nullptr;
 
     int exec(cls_method_context_t ctx,
@@ -30,8 +30,9 @@ public:
 	     ceph::bufferlist& outdata);
     void unregister();
 
-    int get_flags() {
-      std::lock_guard l(cls->handler->mutex);
+    // set once at registration, so every cls call can read them without
+    // taking the handler-wide mutex
+    int get_flags() const {
       return flags;
     }
     ClassMethod(const char* name, func_t call, int flags, ClassData* cls)
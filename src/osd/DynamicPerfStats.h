@@ -60,11 +60,12 @@ public:
 
   template <typename OpRequest>
   void add(int osd, const pg_info_t &pg_info, const OpRequest& op,
-           uint64_t inb, uint64_t outb, const utime_t &latency) {
+           uint64_t inb, uint64_t outb, const utime_t &latency,
+           const utime_t &slow_latency) {
 
     auto update_counter_fnc =
-        [&op, inb, outb, &latency](const PerformanceCounterDescriptor &d,
-                                   PerformanceCounter *c) {
+        [&op, inb, outb, &latency, &slow_latency](
+            const PerformanceCounterDescriptor &d, PerformanceCounter *c) {
           ceph_assert(d.is_supported());
 
           switch(d.type) {
@@ -110,6 +111,12 @@ public:
               c->second++;
             }
             return;
+          case PerformanceCounterType::SLOW_OPS:
+            if (latency >= slow_latency) {
+              c->first++;
+            }
+            c->second++;
+            return;
           default:
             ceph_abort_msg("unknown counter type");
           }
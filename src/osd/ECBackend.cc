@@ -166,6 +166,17 @@ void ECBackend::ECRecoveryBackend::maybe_load_obc(
   }
 }
 
+void ECBackend::ECRecoveryBackend::note_recovery_read(
+  uint64_t bytes_read,
+  uint64_t bytes_recovered)
+{
+  // the ratio of the two is the recovery read amplification; MSR codes
+  // such as clay keep it well below k by reading only sub-chunks
+  auto logger = get_parent()->get_logger();
+  logger->inc(l_osd_ec_recovery_read_bytes, bytes_read);
+  logger->inc(l_osd_ec_recovery_rebuilt_bytes, bytes_recovered);
+}
+
 struct SendPushReplies : public Context {
   PGBackend::Listener *l;
   epoch_t epoch;
@@ -504,22 +515,30 @@ void ECBackend::handle_sub_read(
         dout(20) << __func__ << " case2: going to do fragmented read;"
 		 << " subchunk_size=" << subchunk_size
 		 << " chunk_size=" << sinfo.get_chunk_size() << dendl;
-        bool error = false;
-        for (int m = 0; m < (int)len && !error;
-             m += sinfo.get_chunk_size()) {
-          for (auto &&k: subchunks) {
-            bufferlist bl0;
-            r = switcher->store->read(
-              switcher->ch,
-              ghobject_t(hoid, ghobject_t::NO_GEN, shard),
-              offset + m + (k.first) * subchunk_size,
-              (k.second) * subchunk_size,
-              bl0, flags);
-            if (r < 0) {
-              error = true;
-              break;
+        // Gather every sub-chunk fragment of the extent and hand them to
+        // the store as a single vectored read rather than one read per
+        // fragment.  The sub-chunk list is sorted and disjoint, so offset
+        // order is the order the decoder expects.  Fragments beyond the end
+        // of the shard are dropped, matching the short reads the store
+        // would otherwise return.
+        ghobject_t goid(hoid, ghobject_t::NO_GEN, shard);
+        struct stat st;
+        r = switcher->store->stat(switcher->ch, goid, &st);
+        if (r >= 0) {
+          interval_set<uint64_t> fragments;
+          for (int m = 0; m < (int)len; m += sinfo.get_chunk_size()) {
+            for (auto &&k: subchunks) {
+              uint64_t off = offset + m + (k.first) * subchunk_size;
+              uint64_t end = std::min<uint64_t>(
+                off + (k.second) * subchunk_size, st.st_size);
+              if (off < end) {
+                fragments.union_insert(off, end - off);
+              }
             }
-            bl.claim_append(bl0);
+          }
+          if (!fragments.empty()) {
+            r = switcher->store->readv(switcher->ch, goid, fragments, bl,
+                                       flags);
           }
         }
       }
@@ -225,6 +225,9 @@ public:
       const std::map<std::string, ceph::bufferlist, std::less<>>& raw_attrs,
       RecoveryOp &op) final;
 
+    void note_recovery_read(uint64_t bytes_read,
+                            uint64_t bytes_recovered) final;
+
     PGBackend::Listener *get_parent() const { return parent; }
 
    private:
@@ -1292,6 +1292,7 @@ void ECCommon::RecoveryBackend::handle_recovery_read_complete(
 
   op.returned_data.emplace(std::move(res.buffers_read));
   uint64_t aligned_size = ECUtil::align_next(op.obc->obs.oi.size);
+  note_recovery_read(op.returned_data->size(), req.shard_want_to_read.size());
 
   dout(30) << __func__ << " before decode: oid=" << op.hoid << " EC_DEBUG_BUFFERS: "
          << op.returned_data->debug_string(2048, 0)
@@ -1675,6 +1676,7 @@ ECTransaction::WritePlan ECCommon::get_write_plan(
 
       uint64_t old_object_size = 0;
       bool object_in_cache = false;
+      const ECUtil::shard_extent_set_t *cached_extents = nullptr;
       if (rmw_pipeline.extent_cache.contains_object(oid)) {
         /* We have a valid extent cache for this object. If we need to read, we
          * need to behave as if the object is already the size projected by the
@@ -1682,6 +1684,7 @@ ECTransaction::WritePlan ECCommon::get_write_plan(
          */
         old_object_size = rmw_pipeline.extent_cache.get_projected_size(oid);
         object_in_cache = true;
+        cached_extents = &rmw_pipeline.extent_cache.get_cached_extents(oid);
       } else {
         std::optional<object_info_t> old_oi = get_object_info_from_obc(obc);
         if (old_oi && !inner_op.delete_first) {
@@ -1695,7 +1698,8 @@ ECTransaction::WritePlan ECCommon::get_write_plan(
                                        writable_shards,
                                        object_in_cache, old_object_size,
                                        oi, soi,
-                                       rmw_pipeline.ec_pdw_write_mode);
+                                       rmw_pipeline.ec_pdw_write_mode,
+                                       cached_extents);
 
       if (plan.to_read) plans.want_read = true;
       plans.plans.emplace_back(std::move(plan));
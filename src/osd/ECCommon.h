@@ -809,6 +809,9 @@ struct ECCommon {
     virtual void maybe_load_obc(
       const std::map<std::string, ceph::bufferlist, std::less<>> &raw_attrs,
       RecoveryOp &op) = 0;
+    /// account for one recovery read: shard bytes read vs. bytes rebuilt
+    virtual void note_recovery_read(uint64_t bytes_read,
+                                    uint64_t bytes_recovered) {}
     void dispatch_recovery_messages(RecoveryMessages &m, int priority);
 
     RecoveryBackend::RecoveryOp recover_object(
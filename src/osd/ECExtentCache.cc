@@ -279,6 +279,11 @@ uint64_t ECExtentCache::get_projected_size(hobject_t const &oid) const {
   return objects.at(oid).get_projected_size();
 }
 
+const shard_extent_set_t &ECExtentCache::get_cached_extents(
+    hobject_t const &oid) const {
+  return objects.at(oid).do_not_read;
+}
+
 bool ECExtentCache::contains_object(hobject_t const &oid) const {
   return objects.contains(oid);
 }
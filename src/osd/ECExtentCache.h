@@ -340,6 +340,11 @@ private:
   void on_change2() const;
   [[nodiscard]] bool contains_object(hobject_t const &oid) const;
   [[nodiscard]] uint64_t get_projected_size(hobject_t const &oid) const;
+  /* Extents of an object which a newly prepared op can obtain without a
+   * backend read: cached data, reads already in flight, writes from earlier
+   * ops and the zero-filled area beyond the old end of an append. */
+  [[nodiscard]] const ECUtil::shard_extent_set_t &get_cached_extents(
+      hobject_t const &oid) const;
 
   template <typename CacheReadyCb>
   OpRef prepare(hobject_t const &oid,
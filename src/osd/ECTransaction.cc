@@ -127,7 +127,8 @@ ECTransaction::WritePlanObj::WritePlanObj(
     uint64_t orig_size,
     const std::optional<object_info_t> &oi,
     const std::optional<object_info_t> &soi,
-    unsigned pdw_write_mode
+    unsigned pdw_write_mode,
+    const ECUtil::shard_extent_set_t *cached_extents
   ) :
   hoid(hoid),
   will_write(sinfo.get_k_plus_m()),
@@ -205,15 +206,30 @@ ECTransaction::WritePlanObj::WritePlanObj(
 
       reads.intersection_of(read_mask);
 
-      /* Here we decide if we want to do a conventional write or a parity delta write. */
-      if (sinfo.supports_parity_delta_writes() && !object_in_cache &&
+      /* Here we decide if we want to do a conventional write or a parity delta write.
+       * If the object is in the extent cache, only the extents the cache
+       * cannot supply cost any IO, so compare what is left of each read set.
+       * Without that information, assume the cache makes the conventional
+       * write cheapest.
+       */
+      if (sinfo.supports_parity_delta_writes() &&
+          (!object_in_cache || cached_extents) &&
           orig_size == projected_size && !reads.empty()) {
 
-        shard_id_set read_shards = reads.get_shard_id_set();
-        shard_id_set pdw_read_shards = pdw_reads.get_shard_id_set();
+        ECUtil::shard_extent_set_t uncached_reads(reads);
+        ECUtil::shard_extent_set_t uncached_pdw_reads(pdw_reads);
+        if (object_in_cache) {
+          uncached_reads.subtract(*cached_extents);
+          uncached_pdw_reads.subtract(*cached_extents);
+        }
+        shard_id_set read_shards = uncached_reads.get_shard_id_set();
+        shard_id_set pdw_read_shards = uncached_pdw_reads.get_shard_id_set();
 
         if (pdw_write_mode != 0) {
           do_parity_delta_write = (pdw_write_mode == 2);
+        } else if (read_shards.empty()) {
+          // The cache holds everything a conventional write needs.
+          do_parity_delta_write = false;
         } else if (pdw_read_shards.size() >= sinfo.get_k()) {
           // Even if recovery required for a convention RMW, PDW is not more
           // efficient.
@@ -484,12 +484,17 @@ slice_iterator shard_extent_map_t::begin_slice_iterator(
 
 /* Encode parity chunks, using the encode_chunks interface into the
  * erasure coding. This generates all parity using full stripe writes.
+ *
+ * Unless zero buffers are being deduplicated (which inspects the output of
+ * each slice before moving on to the next one), all slices are handed to
+ * the plugin in a single encode_chunks_batch call.
  */
 int shard_extent_map_t::encode(const ErasureCodeInterfaceRef &ec_impl,
     DoutPrefixProvider *dpp,
     shard_id_set *dedup_zeros) {
   shard_id_set out_set = sinfo->get_parity_shards();
   bool rebuild_req = false;
+  std::vector<shard_id_map<bufferptr>> batch_in, batch_out;
 
   for (auto iter = begin_slice_iterator(out_set, dpp, dedup_zeros); !iter.is_end(); ++iter) {
     if (!iter.is_page_aligned()) {
@@ -500,11 +505,23 @@ int shard_extent_map_t::encode(const ErasureCodeInterfaceRef &ec_impl,
     shard_id_map<bufferptr> &in = iter.get_in_bufferptrs();
     shard_id_map<bufferptr> &out = iter.get_out_bufferptrs();
 
+    if (!dedup_zeros) {
+      batch_in.emplace_back(in);
+      batch_out.emplace_back(out);
+      continue;
+    }
+
     if (int ret = ec_impl->encode_chunks(in, out)) {
       return ret;
     }
   }
 
+  if (!rebuild_req && !batch_in.empty()) {
+    if (int ret = ec_impl->encode_chunks_batch(batch_in, batch_out)) {
+      return ret;
+    }
+  }
+
   if (rebuild_req) {
     pad_and_rebuild_to_ec_align();
     return encode(ec_impl, dpp, dedup_zeros);
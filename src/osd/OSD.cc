@@ -98,6 +98,7 @@
 #include "messages/MOSDPGLog.h"
 #include "messages/MOSDPGRemove.h"
 #include "messages/MOSDPGInfo.h"
+#include "messages/MOSDPGPeeringBatch.h"
 #include "messages/MOSDPGCreate2.h"
 #include "messages/MOSDForceRecovery.h"
 #include "messages/MOSDPGCreated.h"
@@ -253,6 +254,7 @@ OSDService::OSDService(OSD *osd, ceph::async::io_context_pool& poolctx) :
   monc(osd->monc),
   osd_max_object_size(cct->_conf, "osd_max_object_size"),
   osd_skip_data_digest(cct->_conf, "osd_skip_data_digest"),
+  osd_read_fast_path(cct->_conf, "osd_read_fast_path"),
   publish_lock{ceph::make_mutex("OSDService::publish_lock")},
   pre_publish_lock{ceph::make_mutex("OSDService::pre_publish_lock")},
   m_osd_scrub{cct, *this, cct->_conf},
@@ -1202,8 +1204,19 @@ pair<ConnectionRef,ConnectionRef> OSDService::get_con_osd_hb(int peer, epoch_t f
   }
   ret.first = osd->hb_back_client_messenger->connect_to_osd(
     next_map->get_hb_back_addrs(peer));
-  ret.second = osd->hb_front_client_messenger->connect_to_osd(
-    next_map->get_hb_front_addrs(peer));
+  const auto& front_addrs = next_map->get_hb_front_addrs(peer);
+  const auto& my_front_addrs = next_map->get_hb_front_addrs(whoami);
+  if (cct->_conf->osd_heartbeat_skip_shared_front &&
+      !front_addrs.empty() && !my_front_addrs.empty() &&
+      next_map->get_hb_back_addrs(peer).is_same_host(front_addrs.front()) &&
+      next_map->get_hb_back_addrs(whoami).is_same_host(my_front_addrs.front())) {
+    // both ends have their front and back on one network: the back
+    // heartbeats are enough
+    dout(20) << __func__ << " osd." << peer << " shares front and back, "
+	     << "not connecting to front" << dendl;
+  } else {
+    ret.second = osd->hb_front_client_messenger->connect_to_osd(front_addrs);
+  }
   release_map(next_map);
   return ret;
 }
@@ -2425,6 +2438,19 @@ OSD::OSD(CephContext *cct_,
   asok_hook(NULL),
   m_osd_pg_epoch_max_lag_factor(cct->_conf.get_val<double>(
 				  "osd_pg_epoch_max_lag_factor")),
+  osd_recovery_sleep_hybrid(cct->_conf, "osd_recovery_sleep_hybrid"),
+  osd_recovery_sleep_degraded(cct->_conf, "osd_recovery_sleep_degraded"),
+  osd_recovery_sleep_degraded_ssd(cct->_conf, "osd_recovery_sleep_degraded_ssd"),
+  osd_recovery_sleep_degraded_hybrid(cct->_conf, "osd_recovery_sleep_degraded_hybrid"),
+  osd_recovery_sleep_degraded_hdd(cct->_conf, "osd_recovery_sleep_degraded_hdd"),
+  osd_delete_sleep(cct->_conf, "osd_delete_sleep"),
+  osd_delete_sleep_ssd(cct->_conf, "osd_delete_sleep_ssd"),
+  osd_delete_sleep_hybrid(cct->_conf, "osd_delete_sleep_hybrid"),
+  osd_delete_sleep_hdd(cct->_conf, "osd_delete_sleep_hdd"),
+  osd_snap_trim_sleep(cct->_conf, "osd_snap_trim_sleep"),
+  osd_snap_trim_sleep_ssd(cct->_conf, "osd_snap_trim_sleep_ssd"),
+  osd_snap_trim_sleep_hybrid(cct->_conf, "osd_snap_trim_sleep_hybrid"),
+  osd_snap_trim_sleep_hdd(cct->_conf, "osd_snap_trim_sleep_hdd"),
   osd_compat(get_osd_compat_set()),
   osd_op_tp(cct, "OSD::osd_op_tp", "tp_osd_tp",
 	    get_num_op_threads()),
@@ -2657,9 +2683,50 @@ int OSD::set_numa_affinity()
   } else {
     dout(1) << __func__ << " not setting numa affinity" << dendl;
   }
+  set_shard_numa_placement(store_node, front_node);
   return 0;
 }
 
+void OSD::set_shard_numa_placement(int store_node, int net_node)
+{
+  auto placement = cct->_conf.get_val<std::string>("osd_numa_shard_placement");
+  if (placement == "none") {
+    return;
+  }
+  int nodes = get_numa_node_count();
+  if (nodes <= 0) {
+    dout(1) << __func__ << " unable to determine numa nodes: "
+	    << cpp_strerror(nodes) << dendl;
+    return;
+  }
+  // the node the data path is local to: an explicit/auto affinity if we
+  // have one, otherwise the storage device, otherwise the public network
+  int local_node = numa_node;
+  if (local_node < 0) {
+    local_node = store_node >= 0 ? store_node : net_node;
+  }
+  if (placement == "local" && local_node < 0) {
+    dout(1) << __func__ << " no local numa node for storage or network,"
+	    << " not placing shards" << dendl;
+    return;
+  }
+  for (unsigned i = 0; i < num_shards; ++i) {
+    int node = placement == "local" ? local_node : (int)(i % nodes);
+    size_t cpu_set_size = 0;
+    cpu_set_t cpu_set;
+    int r = get_numa_node_cpu_set(node, &cpu_set_size, &cpu_set);
+    if (r < 0) {
+      dout(1) << __func__ << " unable to determine numa node " << node
+	      << " CPUs: " << cpp_strerror(r) << dendl;
+      continue;
+    }
+    dout(1) << __func__ << " " << shards[i]->shard_name
+	    << " numa node " << node << " cpus "
+	    << cpu_set_to_str_list(cpu_set_size, &cpu_set) << dendl;
+    shards[i]->set_numa_node(node, cpu_set);
+  }
+}
+
 // asok
 
 class OSDSocketHook : public AdminSocketHook {
@@ -3611,36 +3678,33 @@ float OSD::get_osd_recovery_sleep()
   if (!store_is_rotational && !journal_is_rotational)
     return cct->_conf->osd_recovery_sleep_ssd;
   else if (store_is_rotational && !journal_is_rotational)
-    return cct->_conf.get_val<double>("osd_recovery_sleep_hybrid");
+    return *osd_recovery_sleep_hybrid;
   else
     return cct->_conf->osd_recovery_sleep_hdd;
 }
 
 float OSD::get_osd_recovery_sleep_degraded() {
-  float osd_recovery_sleep_degraded =
-    cct->_conf.get_val<double>("osd_recovery_sleep_degraded");
-  if (osd_recovery_sleep_degraded > 0) {
-    return osd_recovery_sleep_degraded;
+  if (*osd_recovery_sleep_degraded > 0) {
+    return *osd_recovery_sleep_degraded;
   }
   if (!store_is_rotational && !journal_is_rotational) {
-    return cct->_conf.get_val<double>("osd_recovery_sleep_degraded_ssd");
+    return *osd_recovery_sleep_degraded_ssd;
   } else if (store_is_rotational && !journal_is_rotational) {
-    return cct->_conf.get_val<double>("osd_recovery_sleep_degraded_hybrid");
+    return *osd_recovery_sleep_degraded_hybrid;
   } else {
-    return cct->_conf.get_val<double>("osd_recovery_sleep_degraded_hdd");
+    return *osd_recovery_sleep_degraded_hdd;
   }
 }
 
 float OSD::get_osd_delete_sleep()
 {
-  float osd_delete_sleep = cct->_conf.get_val<double>("osd_delete_sleep");
-  if (osd_delete_sleep > 0)
-    return osd_delete_sleep;
+  if (*osd_delete_sleep > 0)
+    return *osd_delete_sleep;
   if (!store_is_rotational && !journal_is_rotational)
-    return cct->_conf.get_val<double>("osd_delete_sleep_ssd");
+    return *osd_delete_sleep_ssd;
   if (store_is_rotational && !journal_is_rotational)
-    return cct->_conf.get_val<double>("osd_delete_sleep_hybrid");
-  return cct->_conf.get_val<double>("osd_delete_sleep_hdd");
+    return *osd_delete_sleep_hybrid;
+  return *osd_delete_sleep_hdd;
 }
 
 int OSD::get_recovery_max_active()
@@ -3655,14 +3719,13 @@ int OSD::get_recovery_max_active()
 
 float OSD::get_osd_snap_trim_sleep()
 {
-  float osd_snap_trim_sleep = cct->_conf.get_val<double>("osd_snap_trim_sleep");
-  if (osd_snap_trim_sleep > 0)
-    return osd_snap_trim_sleep;
+  if (*osd_snap_trim_sleep > 0)
+    return *osd_snap_trim_sleep;
   if (!store_is_rotational && !journal_is_rotational)
-    return cct->_conf.get_val<double>("osd_snap_trim_sleep_ssd");
+    return *osd_snap_trim_sleep_ssd;
   if (store_is_rotational && !journal_is_rotational)
-    return cct->_conf.get_val<double>("osd_snap_trim_sleep_hybrid");
-  return cct->_conf.get_val<double>("osd_snap_trim_sleep_hdd");
+    return *osd_snap_trim_sleep_hybrid;
+  return *osd_snap_trim_sleep_hdd;
 }
 
 int OSD::init()
@@ -5605,7 +5668,6 @@ void OSD::_add_heartbeat_peer(int p)
     pair<ConnectionRef,ConnectionRef> cons = service.get_con_osd_hb(p, get_osdmap_epoch());
     if (!cons.first)
       return;
-    ceph_assert(cons.second);
 
     hi = &heartbeat_peers[p];
     hi->peer = p;
@@ -5619,15 +5681,17 @@ void OSD::_add_heartbeat_peer(int p)
     hi->con_back = cons.first.get();
     hi->con_back->set_priv(sb);
 
-    auto sf = ceph::make_ref<Session>(cct, cons.second.get());
-    sf->peer = p;
-    sf->stamps = stamps;
-    hi->con_front = cons.second.get();
-    hi->con_front->set_priv(sf);
+    if (cons.second) {
+      auto sf = ceph::make_ref<Session>(cct, cons.second.get());
+      sf->peer = p;
+      sf->stamps = stamps;
+      hi->con_front = cons.second.get();
+      hi->con_front->set_priv(sf);
+    }
 
     dout(10) << "_add_heartbeat_peer: new peer osd." << p
 	     << " " << hi->con_back->get_peer_addr()
-	     << " " << hi->con_front->get_peer_addr()
+	     << " " << (hi->con_front ? hi->con_front->get_peer_addr() : entity_addr_t())
 	     << dendl;
   } else {
     hi = &i->second;
@@ -6191,8 +6255,9 @@ void OSD::heartbeat_check()
       utime_t oldest_deadline = p->second.ping_history.begin()->second.first;
       if (p->second.last_rx_back == utime_t() ||
 	  p->second.last_rx_front == utime_t()) {
+        auto con = p->second.con_front ? p->second.con_front : p->second.con_back;
         derr << "heartbeat_check: no reply from "
-             << p->second.con_front->get_peer_addr().get_sockaddr()
+             << con->get_peer_addr().get_sockaddr()
              << " osd." << p->first
              << " ever on either front or back, first ping sent "
              << p->second.first_tx
@@ -6201,8 +6266,9 @@ void OSD::heartbeat_check()
 	// fail
 	failure_queue[p->first] = p->second.first_tx;
       } else {
+	auto con = p->second.con_front ? p->second.con_front : p->second.con_back;
 	derr << "heartbeat_check: no reply from "
-             << p->second.con_front->get_peer_addr().get_sockaddr()
+             << con->get_peer_addr().get_sockaddr()
 	     << " osd." << p->first << " since back " << p->second.last_rx_back
 	     << " front " << p->second.last_rx_front
 	     << " (oldest deadline " << oldest_deadline << ")"
@@ -7680,6 +7746,8 @@ void OSD::ms_fast_dispatch(Message *m)
     return handle_fast_pg_notify(static_cast<MOSDPGNotify*>(m));
   case MSG_OSD_PG_INFO:
     return handle_fast_pg_info(static_cast<MOSDPGInfo*>(m));
+  case MSG_OSD_PG_PEERING_BATCH:
+    return handle_fast_pg_peering_batch(static_cast<MOSDPGPeeringBatch*>(m));
   case MSG_OSD_PG_REMOVE:
     return handle_fast_pg_remove(static_cast<MOSDPGRemove*>(m));
     // these are single-pg messages that handle themselves
@@ -9391,11 +9459,20 @@ void OSD::dispatch_context(PeeringCtx &ctx, PG *pg, OSDMapRef curmap,
   } else if (!is_active()) {
     dout(20) << __func__ << " not active" << dendl;
   } else {
+    OSDShard *sdata = nullptr;
+    // older osds don't know the bundled message
+    if (pg && cct->_conf->osd_peering_batch_max_pgs > 1 &&
+	curmap->require_osd_release >= ceph_release_t::tentacle) {
+      sdata = shards[pg->pg_id.hash_to_shard(shards.size())];
+    }
     for (auto& [osd, ls] : ctx.message_map) {
       if (!curmap->is_up(osd)) {
 	dout(20) << __func__ << " skipping down osd." << osd << dendl;
 	continue;
       }
+      if (sdata && queue_peering_batch(sdata, osd, ls)) {
+	continue;
+      }
       ConnectionRef con = service.get_con_osd_cluster(
 	osd, curmap->get_epoch());
       if (!con) {
@@ -9530,6 +9607,137 @@ void OSD::handle_fast_pg_info(MOSDPGInfo* m)
   m->put();
 }
 
+void OSD::handle_fast_pg_peering_batch(MOSDPGPeeringBatch* m)
+{
+  dout(7) << __func__ << " " << *m << " from " << m->get_source() << dendl;
+  if (!require_osd_peer(m)) {
+    m->put();
+    return;
+  }
+  for (auto& pm : m->ops) {
+    // the sub-ops were never sent on their own; make them look as if
+    // they had been
+    pm->set_connection(m->get_connection());
+    pm->set_src(m->get_source());
+    enqueue_peering_evt(
+      pm->get_spg(),
+      PGPeeringEventRef(pm->get_event()));
+  }
+  m->put();
+}
+
+bool OSD::queue_peering_batch(
+  OSDShard *sdata,
+  int osd,
+  std::vector<MessageRef>& ls)
+{
+  bool all_batchable = std::all_of(
+    ls.begin(), ls.end(), [](const MessageRef& m) {
+      return MOSDPGPeeringBatch::can_batch(m->get_type());
+    });
+  if (!all_batchable) {
+    // keep the order of this pg's messages: whatever was held back for
+    // the osd goes out first
+    flush_peering_batch(sdata, true, osd);
+    return false;
+  }
+  {
+    std::lock_guard l{sdata->peering_batch_lock};
+    if (sdata->peering_batch_len == 0) {
+      sdata->peering_batch_start = ceph::mono_clock::now();
+      // the shard may stay busy for longer than the delay; this sends the
+      // batch in time. it does nothing if the batch went out before
+      service.mono_timer.add_event(
+	ceph::make_timespan(cct->_conf->osd_peering_batch_max_delay),
+	[this, sdata] {
+	  flush_peering_batch(sdata, false);
+	});
+    }
+    auto& batch = sdata->peering_batch[osd];
+    batch.insert(batch.end(),
+		 std::make_move_iterator(ls.begin()),
+		 std::make_move_iterator(ls.end()));
+    sdata->peering_batch_len += ls.size();
+    sdata->peering_batch_pending = true;
+  }
+  ls.clear();
+  flush_peering_batch(sdata, false);
+  return true;
+}
+
+void OSD::flush_peering_batch(OSDShard *sdata, bool force, int only_osd)
+{
+  if (!sdata->peering_batch_pending) {
+    return;
+  }
+  // messages stay held until they can be sent
+  auto curmap = service.get_osdmap();
+  if (!curmap->is_up(whoami) || !is_active()) {
+    dout(20) << __func__ << " not up or not active" << dendl;
+    return;
+  }
+  std::map<int, std::vector<MessageRef>> batch;
+  {
+    std::lock_guard l{sdata->peering_batch_lock};
+    if (only_osd >= 0) {
+      auto p = sdata->peering_batch.find(only_osd);
+      if (p == sdata->peering_batch.end()) {
+	return;
+      }
+      sdata->peering_batch_len -= p->second.size();
+      batch[only_osd].swap(p->second);
+      sdata->peering_batch.erase(p);
+    } else {
+      if (!force &&
+	  sdata->peering_batch_len < cct->_conf->osd_peering_batch_max_pgs &&
+	  ceph::to_seconds<double>(
+	    ceph::mono_clock::now() - sdata->peering_batch_start) <
+	  cct->_conf->osd_peering_batch_max_delay) {
+	return;
+      }
+      batch.swap(sdata->peering_batch);
+      sdata->peering_batch_len = 0;
+    }
+    sdata->peering_batch_pending = sdata->peering_batch_len > 0;
+  }
+
+  for (auto& [osd, ls] : batch) {
+    if (!curmap->is_up(osd)) {
+      dout(20) << __func__ << " skipping down osd." << osd << dendl;
+      continue;
+    }
+    ConnectionRef con = service.get_con_osd_cluster(osd, curmap->get_epoch());
+    if (!con) {
+      dout(20) << __func__ << " skipping osd." << osd << " (NULL con)"
+	       << dendl;
+      continue;
+    }
+    service.maybe_share_map(con.get(), curmap);
+    if (ls.size() == 1 ||
+	!con->has_features(CEPH_FEATUREMASK_SERVER_TENTACLE)) {
+      for (auto& m : ls) {
+	con->send_message2(std::move(m));
+      }
+      continue;
+    }
+    std::vector<ceph::ref_t<MOSDPeeringOp>> ops;
+    ops.reserve(ls.size());
+    for (auto& m : ls) {
+      ops.push_back(ceph::ref_cast<MOSDPeeringOp>(std::move(m)));
+    }
+    dout(20) << __func__ << " " << ops.size() << " ops to osd." << osd
+	     << dendl;
+    con->send_message2(
+      ceph::make_message<MOSDPGPeeringBatch>(curmap->get_epoch(), std::move(ops)));
+  }
+}
+
+void OSD::flush_peering_batch_to(spg_t pgid, int osd)
+{
+  auto& sdata = shards[pgid.hash_to_shard(shards.size())];
+  flush_peering_batch(sdata, true, osd);
+}
+
 void OSD::handle_fast_pg_remove(MOSDPGRemove *m)
 {
   dout(7) << __func__ << " " << *m << " from " << m->get_source() << dendl;
@@ -9898,6 +10106,9 @@ void OSD::enqueue_op(spg_t pg, OpRequestRef&& op, epoch_t epoch)
 
   op->mark_queued_for_pg();
   logger->tinc(l_osd_op_before_queue_op_lat, latency);
+  if (type == CEPH_MSG_OSD_OP && cct->_conf->osd_op_prefetch_objects) {
+    prefetch_op_object(pg, op);
+  }
   if (PGRecoveryMsg::is_recovery_msg(op)) {
     op_shardedwq.queue(
       OpSchedulerItem(
@@ -9911,6 +10122,24 @@ void OSD::enqueue_op(spg_t pg, OpRequestRef&& op, epoch_t epoch)
   }
 }
 
+void OSD::prefetch_op_object(spg_t pg, OpRequestRef& op)
+{
+  // the op isn't queued yet, so nobody else is looking at the message
+  MOSDOp *m = static_cast<MOSDOp*>(op->get_nonconst_req());
+  if (m->finish_decode()) {
+    op->reset_desc();   // for TrackedOp
+    m->clear_payload();
+  }
+  auto ch = store->open_collection(coll_t(pg));
+  if (!ch) {
+    return;
+  }
+  // do_op starts with the head's object info and snapset
+  ghobject_t oid(m->get_hobj().get_head(), ghobject_t::NO_GEN, pg.shard);
+  dout(20) << __func__ << " " << pg << " " << oid << dendl;
+  store->prefetch_object(ch, oid);
+}
+
 void OSD::enqueue_peering_evt(spg_t pgid, PGPeeringEventRef evt)
 {
   dout(15) << __func__ << " " << pgid << " " << evt->get_desc() << dendl;
@@ -11018,6 +11247,51 @@ op_queue_type_t OSDShard::get_op_queue_type() const
   return scheduler->get_type();
 }
 
+void OSDShard::set_numa_node(int node, const cpu_set_t& cpu_set)
+{
+  // publish the cpu set before the node so readers never see a node
+  // without its cpus
+  numa_cpu_set = cpu_set;
+  numa_node.store(node, std::memory_order_release);
+}
+
+void OSDShard::bind_thread_to_numa_node()
+{
+  // each worker thread belongs to exactly one shard, so one bound node per
+  // thread is enough.  once bound, memory the thread touches (op contexts,
+  // pg state, bufferlists) is first-touch allocated on the local node.
+  static thread_local int bound_node = -1;
+  int node = numa_node.load(std::memory_order_acquire);
+  if (node < 0 || node == bound_node) {
+    return;
+  }
+#if defined(__linux__)
+  int r = sched_setaffinity(0, sizeof(numa_cpu_set), &numa_cpu_set);
+  if (r < 0) {
+    r = -errno;
+    derr << "failed to bind to numa node " << node << ": "
+	 << cpp_strerror(r) << dendl;
+  } else {
+    dout(10) << "bound worker thread to numa node " << node << dendl;
+  }
+#endif
+  bound_node = node;
+}
+
+void OSDShard::note_enqueue_numa_locality()
+{
+#if defined(__linux__)
+  if (numa_node.load(std::memory_order_acquire) < 0) {
+    return;
+  }
+  if (int cpu = sched_getcpu(); cpu >= 0 && CPU_ISSET(cpu, &numa_cpu_set)) {
+    ++numa_local_enqueues;
+  } else {
+    ++numa_remote_enqueues;
+  }
+#endif
+}
+
 OSDShard::OSDShard(
   int id,
   CephContext *cct,
@@ -11032,13 +11306,14 @@ OSDShard::OSDShard(
     sdata_wait_lock{make_mutex(sdata_wait_lock_name)},
     osdmap_lock{make_mutex(shard_name + "::osdmap_lock")},
     shard_lock_name(shard_name + "::shard_lock"),
-    shard_lock{make_mutex(shard_lock_name)},
+    shard_lock{ceph::make_adaptive_mutex(shard_lock_name)},
     scheduler(ceph::osd::scheduler::make_scheduler(
       cct, osd->whoami, osd->num_shards, id, osd->store->is_rotational(),
       osd->store->get_type(), osd_op_queue, osd_op_queue_cut_off, osd->monc)),
     context_queue(sdata_wait_lock, sdata_cond),
     ec_extent_cache_lru(cct->_conf.get_val<uint64_t>(
-      "ec_extent_cache_size"))
+      "ec_extent_cache_size")),
+    peering_batch_lock{make_mutex(shard_name + "::peering_batch_lock")}
 {
   dout(0) << "using op scheduler " << *scheduler << dendl;
 }
@@ -11079,6 +11354,18 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   uint32_t shard_index = thread_index % osd->num_shards;
   auto& sdata = osd->shards[shard_index];
   ceph_assert(sdata);
+  sdata->bind_thread_to_numa_node();
+
+  // peering messages held back by earlier items go out once the shard
+  // runs dry, or sooner if they have waited too long
+  if (sdata->peering_batch_pending) {
+    bool idle;
+    {
+      std::lock_guard l{sdata->shard_lock};
+      idle = sdata->scheduler->empty();
+    }
+    osd->flush_peering_batch(sdata, idle);
+  }
 
   // If all threads of shards do oncommits, there is a out-of-order
   // problem.  So we choose the thread which has the smallest
@@ -11423,6 +11710,7 @@ void OSD::ShardedOpWQ::_enqueue(OpSchedulerItem&& item) {
 
   OSDShard* sdata = osd->shards[shard_index];
   assert (NULL != sdata);
+  sdata->note_enqueue_numa_locality();
 
   dout(20) << fmt::format("{} {}", __func__, item) << dendl;
 
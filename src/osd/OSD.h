@@ -90,6 +90,7 @@ class LogChannel;
 class MOSDPGCreate2;
 class MOSDPGNotify;
 class MOSDPGInfo;
+class MOSDPGPeeringBatch;
 class MOSDPGRemove;
 class MOSDForceRecovery;
 class MMonGetPurgedSnapsReply;
@@ -117,6 +118,7 @@ public:
 
   md_config_cacher_t<Option::size_t> osd_max_object_size;
   md_config_cacher_t<bool> osd_skip_data_digest;
+  md_config_cacher_t<bool> osd_read_fast_path;
 
   void enqueue_back(OpSchedulerItem&& qi);
   void enqueue_front(OpSchedulerItem&& qi);
@@ -991,7 +993,7 @@ struct OSDShard {
   }
 
   std::string shard_lock_name;
-  ceph::mutex shard_lock;   ///< protects remaining members below
+  ceph::adaptive_mutex shard_lock;   ///< protects remaining members below
 
   /// map of slots for each spg_t.  maintains ordering of items dequeued
   /// from scheduler while _process thread drops shard lock to acquire the
@@ -1027,6 +1029,25 @@ struct OSDShard {
   //longer than the most recent IO in each object.
   ECExtentCache::LRU ec_extent_cache_lru;
 
+  /// peering messages for other OSDs held back to be sent as one
+  /// MOSDPGPeeringBatch per OSD (see OSD::flush_peering_batch)
+  ceph::mutex peering_batch_lock;
+  std::map<int, std::vector<MessageRef>> peering_batch;
+  unsigned peering_batch_len = 0;
+  ceph::mono_time peering_batch_start;
+  std::atomic<bool> peering_batch_pending = {false};
+
+  /// numa node the shard's worker threads are bound to (-1 for none)
+  std::atomic<int> numa_node = {-1};
+  cpu_set_t numa_cpu_set;
+  /// enqueues issued from a cpu on (or off) the shard's numa node
+  std::atomic<uint64_t> numa_local_enqueues = {0};
+  std::atomic<uint64_t> numa_remote_enqueues = {0};
+
+  void set_numa_node(int node, const cpu_set_t& cpu_set);
+  void bind_thread_to_numa_node();
+  void note_enqueue_numa_locality();
+
   void _attach_pg(OSDShardPGSlot *slot, PG *pg);
   void _detach_pg(OSDShardPGSlot *slot);
 
@@ -1387,6 +1408,20 @@ private:
 
   // -- config settings --
   float m_osd_pg_epoch_max_lag_factor;
+  // the sleeps are read for every recovery, delete and snap trim op
+  md_config_cacher_t<double> osd_recovery_sleep_hybrid;
+  md_config_cacher_t<double> osd_recovery_sleep_degraded;
+  md_config_cacher_t<double> osd_recovery_sleep_degraded_ssd;
+  md_config_cacher_t<double> osd_recovery_sleep_degraded_hybrid;
+  md_config_cacher_t<double> osd_recovery_sleep_degraded_hdd;
+  md_config_cacher_t<double> osd_delete_sleep;
+  md_config_cacher_t<double> osd_delete_sleep_ssd;
+  md_config_cacher_t<double> osd_delete_sleep_hybrid;
+  md_config_cacher_t<double> osd_delete_sleep_hdd;
+  md_config_cacher_t<double> osd_snap_trim_sleep;
+  md_config_cacher_t<double> osd_snap_trim_sleep_ssd;
+  md_config_cacher_t<double> osd_snap_trim_sleep_hybrid;
+  md_config_cacher_t<double> osd_snap_trim_sleep_hdd;
 
   // -- superblock --
   OSDSuperblock superblock;
@@ -1785,6 +1820,11 @@ protected:
 	std::scoped_lock l{sdata->shard_lock};
 	f->open_object_section(queue_name);
 	sdata->scheduler->dump(*f);
+	if (int node = sdata->numa_node; node >= 0) {
+	  f->dump_int("numa_node", node);
+	  f->dump_unsigned("numa_local_enqueues", sdata->numa_local_enqueues);
+	  f->dump_unsigned("numa_remote_enqueues", sdata->numa_remote_enqueues);
+	}
 	f->close_section();
       }
     }
@@ -1815,6 +1855,8 @@ protected:
 
 
   void enqueue_op(spg_t pg, OpRequestRef&& op, epoch_t epoch);
+  /// ask the store to start loading the object a queued client op targets
+  void prefetch_op_object(spg_t pg, OpRequestRef& op);
   void dequeue_op(
     PGRef pg, OpRequestRef op,
     ThreadPool::TPHandle &handle);
@@ -2064,8 +2106,22 @@ protected:
   void handle_fast_pg_notify(MOSDPGNotify *m);
   void handle_pg_notify_nopg(const MNotifyRec& q);
   void handle_fast_pg_info(MOSDPGInfo *m);
+  void handle_fast_pg_peering_batch(MOSDPGPeeringBatch *m);
   void handle_fast_pg_remove(MOSDPGRemove *m);
 
+  /// hold back the batchable messages of ls for a later
+  /// flush_peering_batch(); returns false if ls must be sent as is
+  bool queue_peering_batch(OSDShard *sdata, int osd,
+			   std::vector<MessageRef>& ls);
+  /// send what the shard holds back if the batch is full, old enough, or
+  /// force is set; with only_osd >= 0, just that OSD's part (always)
+  void flush_peering_batch(OSDShard *sdata, bool force, int only_osd = -1);
+
+public:
+  /// send the messages held back for osd by pgid's shard, so they are not
+  /// overtaken by a message sent outside the peering context
+  void flush_peering_batch_to(spg_t pgid, int osd);
+
 public:
   // used by OSDShard
   PGRef handle_pg_create_info(const OSDMapRef& osdmap, const PGCreateInfo *info);
@@ -2108,6 +2164,7 @@ private:
     case MSG_OSD_PG_INFO2:
     case MSG_OSD_PG_NOTIFY:
     case MSG_OSD_PG_NOTIFY2:
+    case MSG_OSD_PG_PEERING_BATCH:
     case MSG_OSD_PG_LOG:
     case MSG_OSD_PG_TRIM:
     case MSG_OSD_PG_REMOVE:
@@ -2115,6 +2172,7 @@ private:
     case MSG_OSD_RECOVERY_RESERVE:
     case MSG_OSD_REPOP:
     case MSG_OSD_REPOPREPLY:
+    case MSG_OSD_REPOP_BATCH:
     case MSG_OSD_PG_PUSH:
     case MSG_OSD_PG_PULL:
     case MSG_OSD_PG_PUSH_REPLY:
@@ -2241,6 +2299,7 @@ public:
 
   int enable_disable_fuse(bool stop);
   int set_numa_affinity();
+  void set_shard_numa_placement(int store_node, int net_node);
 
   void suicide(int exitcode);
   int shutdown();
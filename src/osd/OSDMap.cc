@@ -5737,7 +5737,24 @@ int OSDMap::calc_pg_upmaps(
     cct->_conf.get_val<bool>("osd_calc_pg_upmaps_aggressively_fast");
   auto local_fallback_retries =
     cct->_conf.get_val<uint64_t>("osd_calc_pg_upmaps_local_fallback_retries");
-    
+
+  // only the upmaps of tmp_osd_map change from here on, so the crush
+  // mapping of each pg is computed once rather than on every pass
+  map<pg_t, vector<int>> raw_by_pg;
+  auto pg_to_raw_upmap = [&](pg_t pg, vector<int> *raw_upmap) {
+    auto pool = tmp_osd_map.get_pg_pool(pg.pool());
+    if (!pool) {
+      raw_upmap->clear();
+      return;
+    }
+    auto [raw, inserted] = raw_by_pg.try_emplace(pg);
+    if (inserted) {
+      tmp_osd_map._pg_to_raw_osds(*pool, pg, &raw->second, NULL);
+    }
+    *raw_upmap = raw->second;
+    tmp_osd_map._apply_upmap(*pool, pg, raw_upmap);
+  };
+
   while (max--) {
     ldout(cct, 30) << "Top of loop #" << max+1 << dendl;
     // build overfull and underfull
@@ -5865,8 +5882,8 @@ int OSDMap::calc_pg_upmaps(
           // to see if we can append more remapping pairs
 	}
 	ldout(cct, 10) << " trying " << pg << dendl;
-        vector<int> raw, orig, out;
-        tmp_osd_map.pg_to_raw_upmap(pg, &raw, &orig); // including existing upmaps too
+        vector<int> orig, out;
+        pg_to_raw_upmap(pg, &orig); // including existing upmaps too
 	if (!try_pg_upmap(cct, pg, overfull, underfull, more_underfull, &orig, &out)) {
 	  continue;
 	}
@@ -5986,9 +6003,11 @@ int OSDMap::calc_pg_upmaps(
     // ready to go
     ceph_assert(new_stddev < stddev);
     stddev = new_stddev;
-    pgs_by_osd = temp_pgs_by_osd;
-    osd_deviation = temp_osd_deviation;
-    deviation_osd = temp_deviation_osd;
+    // the temporaries are rebuilt before they are used again: move them
+    // rather than copy every pg of every osd once more
+    pgs_by_osd = std::move(temp_pgs_by_osd);
+    osd_deviation = std::move(temp_osd_deviation);
+    deviation_osd = std::move(temp_deviation_osd);
     n_changes++;
 
 
@@ -6909,6 +6928,76 @@ void OSDMap::get_pool_ids_by_osd(CephContext *cct,
   }
 }
 
+void OSDMap::get_pools_reaching_osds(const set<int>& osds,
+				     set<int64_t> *pools) const
+{
+  ceph_assert(pools);
+  map<int, bool> rule_reaches;  // cache per rule; many pools share rules
+  for (auto& [pool_id, pool] : get_pools()) {
+    int ruleno = pool.get_crush_rule();
+    auto [p, inserted] = rule_reaches.emplace(ruleno, false);
+    if (inserted) {
+      if (!crush->rule_exists(ruleno)) {
+	p->second = true;  // be conservative
+      }
+      for (int step = 0; !p->second && step < crush->get_rule_len(ruleno);
+	   ++step) {
+	if (crush->get_rule_op(ruleno, step) != CRUSH_RULE_TAKE) {
+	  continue;
+	}
+	int root = crush->get_rule_arg1(ruleno, step);
+	for (int osd : osds) {
+	  if (crush->subtree_contains(root, osd)) {
+	    p->second = true;
+	    break;
+	  }
+	}
+      }
+    }
+    if (p->second) {
+      pools->insert(pool_id);
+    }
+  }
+}
+
+void OSDMap::get_pgs_with_exceptions_for_osds(const set<int>& osds,
+					      set<pg_t> *pgs) const
+{
+  ceph_assert(pgs);
+  auto named = [&osds](auto& v) {
+    return std::any_of(v.begin(), v.end(),
+		       [&osds](int32_t osd) { return osds.count(osd) > 0; });
+  };
+  for (auto p = pg_temp->begin(); p != pg_temp->end(); ++p) {
+    if (named(p->second)) {
+      pgs->insert(p->first);
+    }
+  }
+  for (auto& [pgid, osd] : *primary_temp) {
+    if (osds.count(osd)) {
+      pgs->insert(pgid);
+    }
+  }
+  for (auto& [pgid, up] : pg_upmap) {
+    if (named(up)) {
+      pgs->insert(pgid);
+    }
+  }
+  for (auto& [pgid, items] : pg_upmap_items) {
+    for (auto& [from, to] : items) {
+      if (osds.count(from) || osds.count(to)) {
+	pgs->insert(pgid);
+	break;
+      }
+    }
+  }
+  for (auto& [pgid, osd] : pg_upmap_primaries) {
+    if (osds.count(osd)) {
+      pgs->insert(pgid);
+    }
+  }
+}
+
 template <typename F>
 class OSDUtilizationDumper : public CrushTreeDumper::Dumper<F> {
 public:
@@ -1753,6 +1753,13 @@ private:
 public:
   int get_osds_by_bucket_name(const std::string &name, std::set<int> *osds) const;
 
+  /// add pools whose crush rule may choose any of @osds
+  void get_pools_reaching_osds(const std::set<int>& osds,
+			       std::set<int64_t> *pools) const;
+  /// add pgs whose pg_temp, primary_temp or upmap entries name any of @osds
+  void get_pgs_with_exceptions_for_osds(const std::set<int>& osds,
+					std::set<pg_t> *pgs) const;
+
   bool have_pg_upmaps(pg_t pg) const {
     return pg_upmap.count(pg) ||
       pg_upmap_items.count(pg);
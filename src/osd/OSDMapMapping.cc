@@ -16,7 +16,8 @@ MEMPOOL_DEFINE_OBJECT_FACTORY(OSDMapMapping, osdmapmapping,
 
 // ensure that we have a PoolMappings for each pool and that
 // the dimensions (pg_num and size) match up.
-void OSDMapMapping::_init_mappings(const OSDMap& osdmap)
+void OSDMapMapping::_init_mappings(const OSDMap& osdmap,
+				   std::set<int64_t> *created)
 {
   num_pgs = 0;
   auto q = pools.begin();
@@ -40,6 +41,9 @@ void OSDMapMapping::_init_mappings(const OSDMap& osdmap)
     pools.emplace(p.first, PoolMapping(p.second.get_size(),
 				       p.second.get_pg_num(),
 				       p.second.is_erasure()));
+    if (created) {
+      created->insert(p.first);
+    }
   }
   pools.erase(q, pools.end());
   ceph_assert(pools.size() == osdmap.get_pools().size());
@@ -60,6 +64,123 @@ void OSDMapMapping::update(const OSDMap& osdmap, pg_t pgid)
   _update_range(osdmap, pgid.pool(), pgid.ps(), pgid.ps() + 1);
 }
 
+void OSDMapMapping::note_incremental(const OSDMap::Incremental& inc)
+{
+  // bound the history in case nobody is consuming it
+  constexpr size_t max_deltas = 500;
+  while (deltas.size() >= max_deltas) {
+    deltas.erase(deltas.begin());
+  }
+  Delta& d = deltas[inc.epoch];
+  if (inc.fullmap.length() || inc.crush.length() || inc.new_max_osd >= 0) {
+    d.full = true;
+    return;
+  }
+  for (auto& p : inc.new_pools) {
+    d.pools.insert(p.first);
+  }
+  d.pools.insert(inc.old_pools.begin(), inc.old_pools.end());
+  for (auto& p : inc.new_up_client) {
+    d.osds.insert(p.first);
+  }
+  for (auto& p : inc.new_state) {
+    d.osds.insert(p.first);
+  }
+  for (auto& p : inc.new_weight) {
+    d.osds.insert(p.first);
+  }
+  for (auto& p : inc.new_primary_affinity) {
+    d.osds.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_temp) {
+    d.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_primary_temp) {
+    d.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_upmap) {
+    d.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_upmap_items) {
+    d.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_upmap_primary) {
+    d.pgs.insert(p.first);
+  }
+  d.pgs.insert(inc.old_pg_upmap.begin(), inc.old_pg_upmap.end());
+  d.pgs.insert(inc.old_pg_upmap_items.begin(), inc.old_pg_upmap_items.end());
+  d.pgs.insert(inc.old_pg_upmap_primary.begin(),
+	       inc.old_pg_upmap_primary.end());
+}
+
+bool OSDMapMapping::_get_incremental(
+  const OSDMap& osdmap,
+  const std::set<int64_t>& created,
+  std::set<int64_t> *remap_pools,
+  vector<pg_t> *remap_pgs)
+{
+  // anything up to our epoch is already reflected in the mapping
+  deltas.erase(deltas.begin(), deltas.upper_bound(epoch));
+  if (epoch == 0 || osdmap.get_epoch() <= epoch) {
+    return false;
+  }
+  // note that if a previous (incremental or full) job was aborted part way
+  // through, whatever it touched is covered by these same deltas
+  Delta d;
+  for (epoch_t e = epoch + 1; e <= osdmap.get_epoch(); ++e) {
+    auto p = deltas.find(e);
+    if (p == deltas.end() || p->second.full) {
+      return false;
+    }
+    d.merge(p->second);
+  }
+
+  *remap_pools = std::move(d.pools);
+  remap_pools->insert(created.begin(), created.end());
+  if (!d.osds.empty()) {
+    // a changed osd may move any pg whose rule can reach it, plus those that
+    // only map to it through an exception or are currently acting on it
+    osdmap.get_pools_reaching_osds(d.osds, remap_pools);
+    osdmap.get_pgs_with_exceptions_for_osds(d.osds, &d.pgs);
+    for (int osd : d.osds) {
+      if (osd >= 0 && (unsigned)osd < acting_rmap.size()) {
+	d.pgs.insert(acting_rmap[osd].begin(), acting_rmap[osd].end());
+      }
+    }
+  }
+  for (auto& pgid : d.pgs) {
+    if (remap_pools->count(pgid.pool())) {
+      continue;
+    }
+    auto pool = osdmap.get_pg_pool(pgid.pool());
+    if (pool && pgid.ps() < pool->get_pg_num()) {
+      remap_pgs->push_back(pgid);
+    }
+  }
+  return true;
+}
+
+std::unique_ptr<OSDMapMapping::MappingJob> OSDMapMapping::start_update(
+  const OSDMap& map,
+  ParallelPGMapper& mapper,
+  unsigned pgs_per_item,
+  bool incremental)
+{
+  std::unique_ptr<MappingJob> job(new MappingJob(&map, this));
+  std::set<int64_t> remap_pools;
+  vector<pg_t> remap_pgs;
+  if (incremental &&
+      _get_incremental(map, job->created_pools, &remap_pools, &remap_pgs)) {
+    job->incremental = true;
+    job->num_remap_pools = remap_pools.size();
+    job->num_remap_pgs = remap_pgs.size();
+    mapper.queue(job.get(), pgs_per_item, remap_pgs, &remap_pools);
+  } else {
+    mapper.queue(job.get(), pgs_per_item, {});
+  }
+  return job;
+}
+
 void OSDMapMapping::_build_rmap(const OSDMap& osdmap)
 {
   acting_rmap.resize(osdmap.get_max_osd());
@@ -164,7 +285,8 @@ void ParallelPGMapper::WQ::_process(Item *i, ThreadPool::TPHandle &h)
 void ParallelPGMapper::queue(
   Job *job,
   unsigned pgs_per_item,
-  const vector<pg_t>& input_pgs)
+  const vector<pg_t>& input_pgs,
+  const std::set<int64_t> *input_pools)
 {
   bool any = false;
   if (!input_pgs.empty()) {
@@ -190,10 +312,15 @@ void ParallelPGMapper::queue(
       any = true;
     }
     ceph_assert(any);
-    return;
+    if (!input_pools) {
+      return;
+    }
   }
-  // no input pgs, load all from map
+  // no input pgs, load all (or the given pools) from map
   for (auto& p : job->osdmap->get_pools()) {
+    if (input_pools && !input_pools->count(p.first)) {
+      continue;
+    }
     for (unsigned ps = 0; ps < p.second.get_pg_num(); ps += pgs_per_item) {
       unsigned ps_end = std::min(ps + pgs_per_item, p.second.get_pg_num());
       job->start_one();
@@ -203,5 +330,11 @@ void ParallelPGMapper::queue(
       any = true;
     }
   }
+  if (!any && input_pools) {
+    // nothing to remap; complete the job right away
+    job->start_one();
+    job->finish_one();
+    return;
+  }
   ceph_assert(any);
 }
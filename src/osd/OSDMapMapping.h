@@ -9,12 +9,11 @@
 #include <map>
 
 #include "osd/osd_types.h"
+#include "osd/OSDMap.h"
 #include "common/WorkQueue.h"
 #include "common/Clock.h" // for ceph_clock_now()
 #include "common/Cond.h"
 
-class OSDMap;
-
 /// work queue to perform work on batches of pgids on multiple CPUs
 class ParallelPGMapper {
 public:
@@ -161,10 +160,14 @@ public:
     : cct(cct),
       wq(this, tp) {}
 
+  /// queue @input_pgs, or every pg of the map if empty.  if @input_pools
+  /// is given, every pg of those pools is queued in addition to
+  /// @input_pgs, and the job completes immediately if both are empty.
   void queue(
     Job *job,
     unsigned pgs_per_item,
-    const std::vector<pg_t>& input_pgs);
+    const std::vector<pg_t>& input_pgs,
+    const std::set<int64_t> *input_pools = nullptr);
 
   void drain() {
     wq.drain();
@@ -251,6 +254,21 @@ private:
     }
   };
 
+  /// what an OSDMap::Incremental may change in the mapping
+  struct Delta {
+    bool full = false;          ///< crush, max_osd or full map change
+    std::set<int64_t> pools;    ///< pools created, removed or modified
+    std::set<int> osds;         ///< osds whose state, weight or affinity changed
+    std::set<pg_t> pgs;         ///< pgs with changed temps or upmaps
+
+    void merge(const Delta& o) {
+      full |= o.full;
+      pools.insert(o.pools.begin(), o.pools.end());
+      osds.insert(o.osds.begin(), o.osds.end());
+      pgs.insert(o.pgs.begin(), o.pgs.end());
+    }
+  };
+
   mempool::osdmap_mapping::map<int64_t,PoolMapping> pools;
   mempool::osdmap_mapping::vector<
     mempool::osdmap_mapping::vector<pg_t>> acting_rmap;  // osd -> pg
@@ -258,7 +276,11 @@ private:
   epoch_t epoch = 0;
   uint64_t num_pgs = 0;
 
-  void _init_mappings(const OSDMap& osdmap);
+  /// deltas noted for epochs newer than the mapping, by epoch
+  std::map<epoch_t, Delta> deltas;
+
+  void _init_mappings(const OSDMap& osdmap,
+		      std::set<int64_t> *created = nullptr);
   void _update_range(
     const OSDMap& map,
     int64_t pool,
@@ -266,22 +288,36 @@ private:
 
   void _build_rmap(const OSDMap& osdmap);
 
-  void _start(const OSDMap& osdmap) {
-    _init_mappings(osdmap);
+  void _start(const OSDMap& osdmap, std::set<int64_t> *created = nullptr) {
+    _init_mappings(osdmap, created);
   }
   void _finish(const OSDMap& osdmap);
 
+  bool _get_incremental(
+    const OSDMap& osdmap,
+    const std::set<int64_t>& created,
+    std::set<int64_t> *remap_pools,
+    std::vector<pg_t> *remap_pgs);
+
   void _dump();
 
   friend class ParallelPGMapper;
 
   struct MappingJob : public ParallelPGMapper::Job {
     OSDMapMapping *mapping;
+    std::set<int64_t> created_pools;  ///< pools with a fresh (empty) table
+    bool incremental = false;         ///< only affected pgs are remapped
+    size_t num_remap_pools = 0;       ///< incremental: pools remapped in full
+    size_t num_remap_pgs = 0;         ///< incremental: other pgs remapped
     MappingJob(const OSDMap *osdmap, OSDMapMapping *m)
       : Job(osdmap), mapping(m) {
-      mapping->_start(*osdmap);
+      mapping->_start(*osdmap, &created_pools);
+    }
+    void process(const std::vector<pg_t>& pgs) override {
+      for (auto& pgid : pgs) {
+	mapping->_update_range(*osdmap, pgid.pool(), pgid.ps(), pgid.ps() + 1);
+      }
     }
-    void process(const std::vector<pg_t>& pgs) override {}
     void process(int64_t pool, unsigned ps_begin, unsigned ps_end) override {
       mapping->_update_range(*osdmap, pool, ps_begin, ps_end);
     }
@@ -334,14 +370,18 @@ public:
 
   void update(const OSDMap& map, pg_t pgid);
 
+  /// remember what @inc changes; must be called for every epoch applied
+  /// for start_update() to be able to skip unaffected pgs
+  void note_incremental(const OSDMap::Incremental& inc);
+
+  /// (re)calculate the mapping for @map.  if @incremental and every
+  /// epoch since the current mapping was noted, only pgs that the noted
+  /// incrementals may have moved are remapped.
   std::unique_ptr<MappingJob> start_update(
     const OSDMap& map,
     ParallelPGMapper& mapper,
-    unsigned pgs_per_item) {
-    std::unique_ptr<MappingJob> job(new MappingJob(&map, this));
-    mapper.queue(job.get(), pgs_per_item, {});
-    return job;
-  }
+    unsigned pgs_per_item,
+    bool incremental = false);
 
   epoch_t get_epoch() const {
     return epoch;
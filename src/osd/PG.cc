@@ -50,6 +50,7 @@
 #include "messages/MOSDScrubReserve.h"
 #include "messages/MOSDRepOp.h"
 #include "messages/MOSDRepOpReply.h"
+#include "messages/MOSDRepOpBatch.h"
 #include "messages/MOSDRepScrubMap.h"
 #include "messages/MOSDPGRecoveryDelete.h"
 #include "messages/MOSDPGRecoveryDeleteReply.h"
@@ -752,6 +753,7 @@ void PG::send_cluster_message(
   if (share_map_update) {
     osd->maybe_share_map(con.get(), get_osdmap());
   }
+  osd->osd->flush_peering_batch_to(pg_id, target);
   osd->send_message_osd_cluster(m, con.get());
 }
 
@@ -2063,6 +2065,8 @@ bool PG::can_discard_request(OpRequestRef& op)
     return false; // never discard
   case MSG_OSD_REPOP:
     return can_discard_replica_op<MOSDRepOp, MSG_OSD_REPOP>(op);
+  case MSG_OSD_REPOP_BATCH:
+    return can_discard_replica_op<MOSDRepOpBatch, MSG_OSD_REPOP_BATCH>(op);
   case MSG_OSD_PG_PUSH:
     return can_discard_replica_op<MOSDPGPush, MSG_OSD_PG_PUSH>(op);
   case MSG_OSD_PG_PULL:
@@ -802,7 +802,7 @@ protected:
   // get() should be called on pointer copy (to another thread, etc.).
   // put() should be called on destruction of some previously copied pointer.
   // unlock() when done with the current pointer (_most common_).
-  mutable ceph::mutex _lock = ceph::make_mutex("PG::_lock");
+  mutable ceph::adaptive_mutex _lock = ceph::make_adaptive_mutex("PG::_lock");
 #ifndef CEPH_DEBUG_MUTEX
   mutable std::thread::id locked_by;
 #endif
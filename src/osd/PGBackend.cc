@@ -16,6 +16,8 @@
  *
  */
 
+#include <numeric>
+
 #include "PGBackend.h"
 #include "common/debug.h"
 #include "common/errno.h"
@@ -808,6 +810,34 @@ PGBackend *PGBackend::build_pg_backend(
   }
 }
 
+void PGBackend::be_order_by_locality(std::vector<hobject_t> &ls)
+{
+  std::vector<ghobject_t> oids;
+  oids.reserve(ls.size());
+  for (auto& poid : ls) {
+    oids.emplace_back(
+      poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard);
+  }
+  std::vector<uint64_t> hints;
+  int r = store->get_locality_hints(ch, oids, &hints);
+  if (r < 0) {
+    dout(20) << __func__ << " no locality hints: " << cpp_strerror(r) << dendl;
+    return;
+  }
+  ceph_assert(hints.size() == ls.size());
+  std::vector<size_t> order(ls.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return hints[a] < hints[b];
+  });
+  std::vector<hobject_t> sorted;
+  sorted.reserve(ls.size());
+  for (auto i : order) {
+    sorted.push_back(std::move(ls[i]));
+  }
+  ls.swap(sorted);
+}
+
 int PGBackend::be_scan_list(
   const Scrub::ScrubCounterSet& io_counters,
   ScrubMap &map,
@@ -624,6 +624,9 @@ typedef std::shared_ptr<const OSDMap> OSDMapRef;
      ScrubMap &map,
      ScrubMapBuilder &pos);
 
+   /// reorder ls so that scanning it reads the device roughly in order
+   void be_order_by_locality(std::vector<hobject_t> &ls);
+
    virtual uint64_t be_get_ondisk_size(uint64_t logical_size,
                                        shard_id_t shard_id) const = 0;
 
@@ -536,7 +536,7 @@ void PGLog::merge_log(pg_info_t &oinfo, pg_log_t&& olog, pg_shard_t fromosd,
 
 
 // returns true if any changes were made to log.dups
-bool PGLog::merge_log_dups(const pg_log_t& olog) {
+bool PGLog::merge_log_dups(pg_log_t& olog) {
   dout(5) << __func__
 	  << " log.dups.size()=" << log.dups.size()
 	  <<  "olog.dups.size()=" << olog.dups.size() << dendl;
@@ -550,10 +550,10 @@ bool PGLog::merge_log_dups(const pg_log_t& olog) {
       changed = true;
       dirty_from_dups = eversion_t();
       dirty_to_dups = eversion_t::max();
-      // since our log.dups is empty just copy them
-      for (const auto& i : olog.dups) {
-	log.dups.push_back(i);
-	log.index(log.dups.back());
+      // since our log.dups is empty just take them
+      log.dups.splice(log.dups.end(), olog.dups);
+      for (auto& i : log.dups) {
+	log.index(i);
       }
     } else {
       // since our log.dups is not empty try to extend on each end
@@ -566,39 +566,39 @@ bool PGLog::merge_log_dups(const pg_log_t& olog) {
 
 	auto log_tail_version = log.dups.back().version;
 
-	auto insert_cursor = log.dups.end();
-	eversion_t last_shared = eversion_t::max();
-	for (auto i = olog.dups.crbegin(); i != olog.dups.crend(); ++i) {
-	  if (i->version <= log_tail_version) break;
-	  log.dups.insert(insert_cursor, *i);
-	  last_shared = i->version;
-
-	  auto prev = insert_cursor;
-	  --prev;
-	  // be sure to pass reference of copy in log.dups
-	  log.index(*prev);
-
-	  --insert_cursor; // make sure we insert in reverse order
+	auto from = olog.dups.end();
+	while (from != olog.dups.begin() &&
+	       std::prev(from)->version > log_tail_version) {
+	  --from;
+	}
+	eversion_t last_shared = from->version;
+	auto last_old = std::prev(log.dups.end());
+	log.dups.splice(log.dups.end(), olog.dups, from, olog.dups.end());
+	for (auto i = std::next(last_old); i != log.dups.end(); ++i) {
+	  // the entries keep their addresses, so index them in place
+	  log.index(*i);
 	}
 	mark_dirty_from_dups(last_shared);
       }
 
-      if (olog.dups.front().version < log.dups.front().version) {
+      if (!olog.dups.empty() &&
+	  olog.dups.front().version < log.dups.front().version) {
 	// extend the dups's head (i.e., older dups)
 	dout(10) << "merge_log extending dups head to " <<
 	  olog.dups.front().version << dendl;
 	changed = true;
 
-	eversion_t last;
-	auto insert_cursor = log.dups.begin();
-	for (auto i = olog.dups.cbegin(); i != olog.dups.cend(); ++i) {
-	  if (i->version >= insert_cursor->version) break;
-	  log.dups.insert(insert_cursor, *i);
-	  last = i->version;
-	  auto prev = insert_cursor;
-	  --prev;
-	  // be sure to pass address of copy in log.dups
-	  log.index(*prev);
+	auto log_head_version = log.dups.front().version;
+
+	auto to = olog.dups.begin();
+	while (to != olog.dups.end() && to->version < log_head_version) {
+	  ++to;
+	}
+	eversion_t last = std::prev(to)->version;
+	auto first_old = log.dups.begin();
+	log.dups.splice(first_old, olog.dups, olog.dups.begin(), to);
+	for (auto i = log.dups.begin(); i != first_old; ++i) {
+	  log.index(*i);
 	}
 	mark_dirty_to_dups(last);
       }
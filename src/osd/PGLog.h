@@ -25,6 +25,7 @@
 #include "osd_types.h"
 #include "os/ObjectStore.h"
 
+#include <functional>
 #include <iosfwd>
 #include <map>
 #include <memory>
@@ -167,7 +168,29 @@ public:
    * plus some methods to manipulate it all.
    */
   struct IndexedLog : public pg_log_t {
-    mutable std::unordered_map<hobject_t, pg_log_entry_t*> objects;  // ptrs into log.  be careful!
+    /*
+     * The objects index is keyed by a reference to the soid of the entry
+     * it points at rather than by a copy, so indexing an object costs no
+     * second copy of its name.  index_object() keeps the key pointing at
+     * the current entry.  Lookups by plain hobject_t are transparent.
+     */
+    struct object_key_hash {
+      using is_transparent = void;
+      size_t operator()(const hobject_t& o) const {
+	return std::hash<hobject_t>()(o);
+      }
+    };
+    struct object_key_equal {
+      using is_transparent = void;
+      bool operator()(const hobject_t& l, const hobject_t& r) const {
+	return l == r;
+      }
+    };
+    using object_index_t = std::unordered_map<
+      std::reference_wrapper<const hobject_t>, pg_log_entry_t*,
+      object_key_hash, object_key_equal>;
+
+    mutable object_index_t objects;  // ptrs into log.  be careful!
     mutable std::unordered_map<osd_reqid_t, pg_log_entry_t*> caller_ops;
     mutable std::unordered_multimap<osd_reqid_t, pg_log_entry_t*> extra_caller_ops;
     mutable std::unordered_map<osd_reqid_t, pg_log_dup_t*> dup_index;
@@ -535,7 +558,7 @@ public:
 	for (auto i = log.begin(); i != log.end(); ++i) {
 	  if (to_index & PGLOG_INDEXED_OBJECTS) {
 	    if (i->object_is_indexed()) {
-	      objects[i->soid] = const_cast<pg_log_entry_t*>(&(*i));
+	      index_object(const_cast<pg_log_entry_t&>(*i));
 	    }
 	  }
 
@@ -575,11 +598,26 @@ public:
       index(PGLOG_INDEXED_DUPS);
     }
 
+    /// point the objects index for e.soid at e
+    void index_object(pg_log_entry_t& e) const {
+      auto p = objects.find(e.soid);
+      if (p == objects.end()) {
+	objects.emplace(std::cref(e.soid), &e);
+	return;
+      }
+      // the key must refer to the indexed entry, which outlives the
+      // entry it replaces
+      auto node = objects.extract(p);
+      node.key() = std::cref(e.soid);
+      node.mapped() = &e;
+      objects.insert(std::move(node));
+    }
+
     void index(pg_log_entry_t& e) {
       if ((indexed_data & PGLOG_INDEXED_OBJECTS) && e.object_is_indexed()) {
-        if (objects.count(e.soid) == 0 ||
-            objects[e.soid]->version < e.version)
-          objects[e.soid] = &e;
+        auto p = objects.find(e.soid);
+        if (p == objects.end() || p->second->version < e.version)
+          index_object(e);
       }
       if (indexed_data & PGLOG_INDEXED_CALLER_OPS) {
 	// divergent merge_log indexes new before unindexing old
@@ -676,7 +714,7 @@ public:
 
       // to our index
       if ((indexed_data & PGLOG_INDEXED_OBJECTS) && e.object_is_indexed()) {
-        objects[e.soid] = &(log.back());
+        index_object(log.back());
       }
       if (indexed_data & PGLOG_INDEXED_CALLER_OPS) {
         if (e.reqid_is_indexed()) {
@@ -1365,7 +1403,8 @@ protected:
       this);
   }
 
-  bool merge_log_dups(const pg_log_t& olog);
+  /// merge olog's dups into ours, moving (not copying) the ones we take
+  bool merge_log_dups(pg_log_t& olog);
 
 public:
 
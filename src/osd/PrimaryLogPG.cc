@@ -2478,6 +2478,12 @@ void PrimaryLogPG::do_op(OpRequestRef& op)
 
   dout(25) << __func__ << " oi " << obc->obs.oi << dendl;
 
+  if (r == 0 && maybe_do_fast_read(op, obc)) {
+    log_op_prepare_lat(*op);
+    maybe_force_recovery();
+    return;
+  }
+
   OpContext *ctx = new OpContext(op, m->get_reqid(), &m->ops, obc, this);
 
   if (m->has_flag(CEPH_OSD_FLAG_SKIPRWLOCKS)) {
@@ -2543,19 +2549,24 @@ void PrimaryLogPG::do_op(OpRequestRef& op)
   op->mark_started();
 
   execute_ctx(ctx);
+  log_op_prepare_lat(*op);
+
+  // force recovery of the oldest missing object if too many logs
+  maybe_force_recovery();
+}
+
+void PrimaryLogPG::log_op_prepare_lat(const OpRequest& op)
+{
   utime_t prepare_latency = ceph_clock_now();
-  prepare_latency -= op->get_dequeued_time();
+  prepare_latency -= op.get_dequeued_time();
   osd->logger->tinc(l_osd_op_prepare_lat, prepare_latency);
-  if (op->may_read() && op->may_write()) {
+  if (op.may_read() && op.may_write()) {
     osd->logger->tinc(l_osd_op_rw_prepare_lat, prepare_latency);
-  } else if (op->may_read()) {
+  } else if (op.may_read()) {
     osd->logger->tinc(l_osd_op_r_prepare_lat, prepare_latency);
-  } else if (op->may_write() || op->may_cache()) {
+  } else if (op.may_write() || op.may_cache()) {
     osd->logger->tinc(l_osd_op_w_prepare_lat, prepare_latency);
   }
-
-  // force recovery of the oldest missing object if too many logs
-  maybe_force_recovery();
 }
 
 PrimaryLogPG::cache_result_t PrimaryLogPG::maybe_handle_manifest_detail(
@@ -4481,7 +4492,11 @@ void PrimaryLogPG::log_op_stats(const OpRequest& op,
 	   << " lat " << latency << dendl;
 
   if (m_dynamic_perf_stats.is_enabled()) {
-    m_dynamic_perf_stats.add(osd->get_nodeid(), info, op, inb, outb, latency);
+    utime_t slow_latency;
+    slow_latency.set_from_double(
+      cct->_conf.get_val<double>("osd_perf_query_slow_op_latency"));
+    m_dynamic_perf_stats.add(osd->get_nodeid(), info, op, inb, outb, latency,
+                             slow_latency);
   }
 }
 
@@ -6024,6 +6039,222 @@ int PrimaryLogPG::do_sparse_read(OpContext *ctx, OSDOp& osd_op) {
   return 0;
 }
 
+bool PrimaryLogPG::maybe_do_fast_read(OpRequestRef& op,
+				      const ObjectContextRef& obc)
+{
+  // as in do_op; results are written back into m->ops for the reply
+  MOSDOp *m = static_cast<MOSDOp*>(op->get_nonconst_req());
+  const object_info_t& oi = obc->obs.oi;
+  const hobject_t& soid = oi.soid;
+
+  if (!*osd->osd_read_fast_path ||
+      !op->may_read() || op->may_write() || op->may_cache() ||
+      op->rwordered() ||
+      pool.info.is_erasure() || pool.info.is_tier() ||
+      m->has_flag(CEPH_OSD_FLAG_SKIPRWLOCKS) ||
+      m->has_flag(CEPH_OSD_FLAG_FLUSH) ||
+      m->get_snapid() == CEPH_SNAPDIR ||
+      !obc->obs.exists || oi.is_whiteout() || oi.is_lost() ||
+      oi.has_manifest()) {
+    return false;
+  }
+  for (auto& osd_op : m->ops) {
+    switch (osd_op.op.op) {
+    case CEPH_OSD_OP_READ:
+    case CEPH_OSD_OP_SPARSE_READ:
+    case CEPH_OSD_OP_STAT:
+    case CEPH_OSD_OP_GETXATTR:
+    case CEPH_OSD_OP_OMAPGETHEADER:
+    case CEPH_OSD_OP_OMAPGETVALSBYKEYS:
+      break;
+    default:
+      return false;
+    }
+  }
+
+  // a shared obc lock orders us after in-flight writes; if it is not
+  // immediately available let the normal path queue the op
+  ObcLockManager lock_manager;
+  if (!lock_manager.try_get_read_lock(soid, obc)) {
+    return false;
+  }
+
+  // Nothing here has side effects, so on any error (including the ones the
+  // normal path knows how to repair or report) we drop what we have and
+  // let do_osd_ops redo the whole op.  Results are staged so that m->ops
+  // is untouched in that case.
+  std::vector<bufferlist> outdata(m->ops.size());
+  std::vector<uint64_t> extent_len(m->ops.size(), 0);
+  std::optional<uint64_t> data_off;
+  object_stat_sum_t delta_stats;
+  uint64_t bytes_read = 0;
+  bool ok = true;
+  for (size_t i = 0; ok && i < m->ops.size(); ++i) {
+    const ceph_osd_op& rop = m->ops[i].op;
+    bufferlist& out = outdata[i];
+    switch (rop.op) {
+    case CEPH_OSD_OP_READ:
+    case CEPH_OSD_OP_SPARSE_READ:
+      {
+	uint64_t size = oi.size;
+	uint64_t offset = rop.extent.offset;
+	uint64_t length = rop.extent.length;
+	uint32_t tseq = rop.extent.truncate_seq;
+	uint64_t tsize = rop.extent.truncate_size;
+	if (tseq == 1 && tsize == (-1ULL)) {
+	  tseq = 0;  // munge -1 truncate to 0 truncate
+	  tsize = 0;
+	}
+	if (oi.truncate_seq < tseq && offset + length > tsize && size > tsize) {
+	  size = tsize;
+	}
+	if (rop.op == CEPH_OSD_OP_READ && length == 0) {
+	  length = size;
+	}
+	if (offset >= size) {
+	  length = 0;
+	} else if (offset + length > size) {
+	  length = size - offset;
+	}
+	int r = 0;
+	if (rop.op == CEPH_OSD_OP_READ) {
+	  if (!data_off) {
+	    data_off = rop.extent.offset;
+	  }
+	  if (length > 0) {
+	    r = pgbackend->objects_read_sync(soid, offset, length, rop.flags,
+					     &out);
+	  }
+	  if (r >= 0 && offset == 0 && (uint64_t)r == oi.size &&
+	      oi.is_data_digest() && oi.data_digest != out.crc32c(-1)) {
+	    r = -EIO;
+	  }
+	} else {
+	  map<uint64_t, uint64_t> extents;
+	  bufferlist data_bl;
+	  r = osd->store->fiemap(
+	    ch, ghobject_t(soid, ghobject_t::NO_GEN, info.pgid.shard),
+	    offset, length, extents);
+	  if (r >= 0) {
+	    r = pgbackend->objects_readv_sync(soid, extents, rop.flags,
+					      &data_bl);
+	  }
+	  if (r >= 0 && (uint64_t)r == oi.size && oi.is_data_digest() &&
+	      oi.data_digest != data_bl.crc32c(-1)) {
+	    r = -EIO;
+	  }
+	  if (r >= 0) {
+	    encode(extents, out);
+	    ::encode_destructively(data_bl, out);
+	  }
+	}
+	if (r < 0) {
+	  ok = false;
+	  break;
+	}
+	extent_len[i] = r;
+	delta_stats.num_rd_kb += shift_round_up(r, 10);
+	delta_stats.num_rd++;
+      }
+      break;
+
+    case CEPH_OSD_OP_STAT:
+      encode(oi.size, out);
+      encode(oi.mtime, out);
+      delta_stats.num_rd++;
+      break;
+
+    case CEPH_OSD_OP_GETXATTR:
+      {
+	string aname;
+	try {
+	  auto bp = m->ops[i].indata.cbegin();
+	  bp.copy(rop.xattr.name_len, aname);
+	} catch (ceph::buffer::error& e) {
+	  ok = false;
+	  break;
+	}
+	if (getattr_maybe_cache(obc, "_" + aname, &out) < 0) {
+	  ok = false;
+	  break;
+	}
+	delta_stats.num_rd_kb += shift_round_up(out.length(), 10);
+	delta_stats.num_rd++;
+      }
+      break;
+
+    case CEPH_OSD_OP_OMAPGETHEADER:
+      if (oi.is_omap()) {
+	osd->store->omap_get_header(ch, ghobject_t(soid), &out);
+	delta_stats.num_rd_kb += shift_round_up(out.length(), 10);
+	delta_stats.num_rd++;
+      }
+      break;
+
+    case CEPH_OSD_OP_OMAPGETVALSBYKEYS:
+      {
+	set<string> keys_to_get;
+	try {
+	  auto bp = m->ops[i].indata.cbegin();
+	  decode(keys_to_get, bp);
+	} catch (ceph::buffer::error& e) {
+	  ok = false;
+	  break;
+	}
+	map<string, bufferlist> vals;
+	if (oi.is_omap()) {
+	  osd->store->omap_get_values(ch, ghobject_t(soid), keys_to_get, &vals);
+	}
+	encode(vals, out);
+	delta_stats.num_rd_kb += shift_round_up(out.length(), 10);
+	delta_stats.num_rd++;
+      }
+      break;
+    }
+    bytes_read += out.length();
+  }
+
+  if (!ok) {
+    dout(20) << __func__ << " " << soid << " falling back to normal path"
+	     << dendl;
+    release_object_locks(lock_manager);
+    return false;
+  }
+
+  dout(10) << __func__ << " " << soid << " " << m->ops
+	   << " ov " << oi.version << dendl;
+  op->mark_started();
+  op->mark_event("fast read");
+
+  for (size_t i = 0; i < m->ops.size(); ++i) {
+    OSDOp& osd_op = m->ops[i];
+    switch (osd_op.op.op) {
+    case CEPH_OSD_OP_READ:
+    case CEPH_OSD_OP_SPARSE_READ:
+      osd_op.op.extent.length = extent_len[i];
+      break;
+    case CEPH_OSD_OP_GETXATTR:
+      osd_op.op.xattr.value_len = outdata[i].length();
+      break;
+    }
+    osd_op.rval = 0;
+    osd_op.outdata = std::move(outdata[i]);
+  }
+  unstable_stats.add(delta_stats);
+
+  MOSDOpReply *reply = new MOSDOpReply(m, 0, get_osdmap_epoch(), 0, false);
+  reply->get_header().data_off = data_off.value_or(0);
+  reply->set_reply_versions(eversion_t(), oi.user_version);
+  reply->add_flags(CEPH_OSD_FLAG_ACK | CEPH_OSD_FLAG_ONDISK);
+  release_object_locks(lock_manager);
+
+  log_op_stats(*op, 0, bytes_read);
+  osd->logger->inc(l_osd_op_r_fast);
+  publish_stats_to_osd();
+  osd->send_message_osd_client(reply, m->get_connection());
+  return true;
+}
+
 int PrimaryLogPG::do_osd_ops(OpContext *ctx, vector<OSDOp>& ops)
 {
   int result = 0;
@@ -1464,6 +1464,15 @@ protected:
 
   int do_read(OpContext *ctx, OSDOp& osd_op);
   int do_sparse_read(OpContext *ctx, OSDOp& osd_op);
+
+  /**
+   * answer a pure read (replicated pool, existing object, only simple
+   * read ops) straight from the ObjectStore without an OpContext
+   *
+   * @return true if the op was answered, false to take the normal path
+   */
+  bool maybe_do_fast_read(OpRequestRef& op, const ObjectContextRef& obc);
+  void log_op_prepare_lat(const OpRequest& op);
   int do_writesame(OpContext *ctx, OSDOp& osd_op);
 
   bool pgls_filter(const PGLSFilter& filter, const hobject_t& sobj);
@@ -22,6 +22,7 @@
 #include "messages/MOSDPGPCT.h"
 #include "messages/MOSDRepOp.h"
 #include "messages/MOSDRepOpReply.h"
+#include "messages/MOSDRepOpBatch.h"
 #include "messages/MOSDPGPush.h"
 #include "messages/MOSDPGPull.h"
 #include "messages/MOSDPGPushReply.h"
@@ -237,6 +238,10 @@ bool ReplicatedBackend::_handle_message(
     return true;
   }
 
+  case MSG_OSD_REPOP_BATCH:
+    do_repop_batch(op);
+    return true;
+
   case MSG_OSD_PG_PCT:
     do_pct(op);
     return true;
@@ -272,6 +277,8 @@ void ReplicatedBackend::on_change()
     op.second->on_commit = nullptr;
   }
   in_progress_ops.clear();
+  repop_batches.clear();
+  repops_unacked.clear();
   clear_recovery_state();
   cancel_pct_update();
 }
@@ -746,6 +753,12 @@ void ReplicatedBackend::do_repop_reply(OpRequestRef op)
       in_progress_ops.erase(iter);
     }
   }
+  if (auto p = repops_unacked.find(from);
+      p != repops_unacked.end() && p->second > 0) {
+    --p->second;
+  }
+  // the replica is keeping up again: send what piled up meanwhile
+  flush_repop_batch(from);
   maybe_kick_pct_update();
 }
 
@@ -1206,12 +1219,71 @@ void ReplicatedBackend::issue_op(
 	  pinfo);
       if (op->op && op->op->pg_trace)
 	wr->trace.init("replicated op", nullptr, &op->op->pg_trace);
-      get_parent()->send_message_osd_cluster(
-	  shard.osd, wr, get_osdmap_epoch());
+      send_repop(shard, static_cast<MOSDRepOp*>(wr));
     }
   }
 }
 
+void ReplicatedBackend::send_repop(pg_shard_t shard, MOSDRepOp *wr)
+{
+  unsigned unacked = ++repops_unacked[shard];
+  uint64_t max_ops = cct->_conf->osd_repop_batch_max_ops;
+  // only acting shards are covered by the pg feature negotiation
+  if (unacked == 1 ||
+      max_ops < 2 ||
+      !PG_HAVE_FEATURE(parent->get_pg_acting_features(), REPOP_BATCH) ||
+      !parent->get_acting_shards().count(shard)) {
+    flush_repop_batch(shard);
+    get_parent()->send_message_osd_cluster(
+      shard.osd, wr, get_osdmap_epoch());
+    return;
+  }
+  auto& batch = repop_batches[shard];
+  if (!batch.empty() && batch.front()->map_epoch != wr->map_epoch) {
+    flush_repop_batch(shard);
+  }
+  batch.emplace_back(wr, false);
+  if (batch.size() >= max_ops) {
+    flush_repop_batch(shard);
+  }
+}
+
+void ReplicatedBackend::flush_repop_batch(pg_shard_t shard)
+{
+  auto p = repop_batches.find(shard);
+  if (p == repop_batches.end()) {
+    return;
+  }
+  auto ops = std::move(p->second);
+  repop_batches.erase(p);
+  if (ops.empty()) {
+    return;
+  }
+  Message *m;
+  if (ops.size() == 1) {
+    m = ops.front().detach();
+  } else {
+    dout(20) << __func__ << " " << ops.size() << " repops to " << shard
+	     << dendl;
+    epoch_t map_epoch = ops.front()->map_epoch;
+    epoch_t min_epoch = ops.front()->min_epoch;
+    int priority = ops.front()->get_priority();
+    m = new MOSDRepOpBatch(
+      spg_t(get_info().pgid.pgid, shard.shard),
+      map_epoch, min_epoch, std::move(ops));
+    m->set_priority(priority);
+  }
+  get_parent()->send_message_osd_cluster(
+    shard.osd, m, get_osdmap_epoch());
+}
+
+void ReplicatedBackend::flush_repop_batches()
+{
+  while (!repop_batches.empty()) {
+    flush_repop_batch(repop_batches.begin()->first);
+  }
+}
+
 // sub op modify
 void ReplicatedBackend::do_repop(OpRequestRef op)
 {
@@ -1220,6 +1292,41 @@ void ReplicatedBackend::do_repop(OpRequestRef op)
   int msg_type = m->get_type();
   ceph_assert(MSG_OSD_REPOP == msg_type);
 
+  op->mark_started();
+
+  vector<ObjectStore::Transaction> tls;
+  tls.reserve(2);
+  prepare_repop(op, m, m->get_source().num(), tls);
+  parent->queue_transactions(tls, op);
+  // op is cleaned up by oncommit/onapply when both are executed
+  dout(30) << __func__ << " missing after" << get_parent()->get_log().get_missing().get_items() << dendl;
+}
+
+void ReplicatedBackend::do_repop_batch(OpRequestRef op)
+{
+  auto m = op->get_req<MOSDRepOpBatch>();
+  ceph_assert(m->get_type() == MSG_OSD_REPOP_BATCH);
+  dout(10) << __func__ << " " << *m << dendl;
+
+  op->mark_started();
+
+  // the sub-ops carry no source of their own
+  int ackerosd = m->get_source().num();
+  vector<ObjectStore::Transaction> tls;
+  tls.reserve(2 * m->ops.size());
+  for (auto& sub : m->ops) {
+    sub->finish_decode();
+    prepare_repop(op, sub, ackerosd, tls);
+  }
+  parent->queue_transactions(tls, op);
+}
+
+void ReplicatedBackend::prepare_repop(
+  OpRequestRef op,
+  ceph::cref_t<MOSDRepOp> m,
+  int ackerosd,
+  vector<ObjectStore::Transaction>& tls)
+{
   const hobject_t& soid = m->poid;
 
   dout(10) << __func__ << " " << soid
@@ -1235,12 +1342,9 @@ void ReplicatedBackend::do_repop(OpRequestRef op)
   dout(30) << __func__ << " missing before " << get_parent()->get_log().get_missing().get_items() << dendl;
   parent->maybe_preempt_replica_scrub(soid);
 
-  int ackerosd = m->get_source().num();
-
-  op->mark_started();
-
   RepModifyRef rm(std::make_shared<RepModify>(get_parent()->min_peer_features()));
   rm->op = op;
+  rm->m = m;
   rm->ackerosd = ackerosd;
   rm->last_complete = get_info().last_complete;
   rm->epoch_started = get_osdmap_epoch();
@@ -1307,13 +1411,8 @@ void ReplicatedBackend::do_repop(OpRequestRef op)
   rm->opt.register_on_commit(
     parent->bless_context(
       new C_OSD_RepModifyCommit(this, rm)));
-  vector<ObjectStore::Transaction> tls;
-  tls.reserve(2);
   tls.push_back(std::move(rm->localt));
   tls.push_back(std::move(rm->opt));
-  parent->queue_transactions(tls, op);
-  // op is cleaned up by oncommit/onapply when both are executed
-  dout(30) << __func__ << " missing after" << get_parent()->get_log().get_missing().get_items() << dendl;
 }
 
 void ReplicatedBackend::repop_commit(RepModifyRef rm)
@@ -1323,7 +1422,7 @@ void ReplicatedBackend::repop_commit(RepModifyRef rm)
   rm->committed = true;
 
   // send commit.
-  auto m = rm->op->get_req<MOSDRepOp>();
+  auto m = rm->m.get();
   ceph_assert(m->get_type() == MSG_OSD_REPOP);
   dout(10) << __func__ << " on op " << *m
 	   << ", sending commit to osd." << rm->ackerosd
@@ -17,6 +17,7 @@
 #define REPBACKEND_H
 
 #include "PGBackend.h"
+#include "messages/MOSDRepOp.h"
 
 struct C_ReplicatedBackend_OnPullComplete;
 class ReplicatedBackend : public PGBackend {
@@ -389,7 +390,8 @@ public:
 
   void call_write_ordered(std::function<void(void)> &&cb) override {
     // ReplicatedBackend submits writes inline in submit_transaction, so
-    // we can just call the callback.
+    // we can just call the callback once held back repops are out.
+    flush_repop_batches();
     cb();
   }
 
@@ -439,9 +441,21 @@ private:
   void op_commit(const ceph::ref_t<InProgressOp>& op);
   void do_repop_reply(OpRequestRef op);
   void do_repop(OpRequestRef op);
+  void do_repop_batch(OpRequestRef op);
+
+  /// repops sent (or held back) to each replica and not acked yet
+  std::map<pg_shard_t, unsigned> repops_unacked;
+  /// repops held back for a replica while earlier ones are unacked
+  std::map<pg_shard_t, std::vector<ceph::ref_t<MOSDRepOp>>> repop_batches;
+
+  /// send wr to shard now, or hold it back to go out with later repops
+  void send_repop(pg_shard_t shard, MOSDRepOp *wr);
+  void flush_repop_batch(pg_shard_t shard);
+  void flush_repop_batches();
 
   struct RepModify {
     OpRequestRef op;
+    ceph::cref_t<MOSDRepOp> m;
     bool committed;
     int ackerosd;
     eversion_t last_complete;
@@ -460,6 +474,12 @@ private:
 
   struct C_OSD_RepModifyCommit;
 
+  /// decode one repop and append its transactions to tls
+  void prepare_repop(
+    OpRequestRef op,
+    ceph::cref_t<MOSDRepOp> m,
+    int ackerosd,
+    std::vector<ObjectStore::Transaction>& tls);
   void repop_commit(RepModifyRef rm);
   bool auto_repair_supported() const override { return store->has_builtin_csum(); }
 
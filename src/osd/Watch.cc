@@ -60,6 +60,7 @@ Notify::Notify(
     cookie(cookie),
     notify_id(notify_id),
     version(version),
+    start(ceph_clock_now()),
     osd(osd),
     cb(nullptr) {}
 
@@ -215,6 +216,8 @@ void Notify::maybe_complete_notify()
     if (timed_out)
       reply->return_code = -ETIMEDOUT;
     client->send_message(reply);
+    osd->logger->inc(l_osd_notify);
+    osd->logger->tinc(l_osd_notify_lat, ceph_clock_now() - start);
     unregister_cb();
 
     complete = true;
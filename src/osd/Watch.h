@@ -62,6 +62,7 @@ class Notify {
   uint64_t cookie;
   uint64_t notify_id;
   uint64_t version;
+  utime_t start;    ///< when the notify was received, for notify_latency
 
   OSDService *osd;
   CancelableContext *cb;
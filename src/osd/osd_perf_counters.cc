@@ -80,6 +80,9 @@ PerfCounters *build_osd_logger(CephContext *cct) {
   osd_plb.add_time_avg(
     l_osd_op_r_prepare_lat, "op_r_prepare_latency",
     "Latency of read operations (excluding queue time and wait for finished)");
+  osd_plb.add_u64_counter(
+    l_osd_op_r_fast, "op_r_fast",
+    "Client read operations served without an OpContext");
   osd_plb.add_u64_counter(
     l_osd_op_w, "op_w", "Client write operations");
   osd_plb.add_u64_counter(
@@ -175,6 +178,12 @@ PerfCounters *build_osd_logger(CephContext *cct) {
   osd_plb.add_u64_counter(l_osd_push, "push", "Push messages sent");
   osd_plb.add_u64_counter(l_osd_push_outb, "push_out_bytes", "Pushed size", NULL, 0, unit_t(UNIT_BYTES));
 
+  osd_plb.add_u64_counter(
+    l_osd_notify, "notify", "Notifies completed or timed out");
+  osd_plb.add_time_avg(
+    l_osd_notify_lat, "notify_latency",
+    "Latency from a notify to its last watcher ack or timeout");
+
   osd_plb.add_u64_counter(
     l_osd_rop, "recovery_ops",
     "Started recovery operations",
@@ -184,6 +193,14 @@ PerfCounters *build_osd_logger(CephContext *cct) {
    l_osd_rbytes, "recovery_bytes",
    "recovery bytes",
    "rbt", PerfCountersBuilder::PRIO_INTERESTING);
+  osd_plb.add_u64_counter(
+    l_osd_ec_recovery_read_bytes, "ec_recovery_read_bytes",
+    "Shard bytes read to recover erasure coded objects",
+    NULL, 0, unit_t(UNIT_BYTES));
+  osd_plb.add_u64_counter(
+    l_osd_ec_recovery_rebuilt_bytes, "ec_recovery_rebuilt_bytes",
+    "Shard bytes rebuilt by erasure coded recovery",
+    NULL, 0, unit_t(UNIT_BYTES));
 
   osd_plb.add_time_avg(
     l_osd_recovery_push_queue_lat,
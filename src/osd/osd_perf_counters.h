@@ -22,6 +22,7 @@ enum osd_counter_idx_t {
   l_osd_op_r_lat_outb_hist,
   l_osd_op_r_process_lat,
   l_osd_op_r_prepare_lat,
+  l_osd_op_r_fast,
   l_osd_op_w,
   l_osd_op_w_inb,
   l_osd_op_w_lat,
@@ -64,8 +65,13 @@ enum osd_counter_idx_t {
   l_osd_push,
   l_osd_push_outb,
 
+  l_osd_notify,
+  l_osd_notify_lat,
+
   l_osd_rop,
   l_osd_rbytes,
+  l_osd_ec_recovery_read_bytes,
+  l_osd_ec_recovery_rebuilt_bytes,
 
   l_osd_recovery_push_queue_lat,
   l_osd_recovery_push_reply_queue_lat,
@@ -19,9 +19,10 @@ static constexpr pg_feature_vec_t PG_FEATURE_INCARNATION_1 = 0ull;
   (((x) & (PG_FEATUREMASK_##name)) == (PG_FEATUREMASK_##name))
 
 DEFINE_PG_FEATURE(0, 1, PCT)
+DEFINE_PG_FEATURE(1, 1, REPOP_BATCH)
 
 static constexpr pg_feature_vec_t PG_FEATURE_NONE = 0ull;
 static constexpr pg_feature_vec_t PG_FEATURE_CRIMSON_ALL =
   PG_FEATURE_PCT;
 static constexpr pg_feature_vec_t PG_FEATURE_CLASSIC_ALL =
-  PG_FEATURE_PCT;
+  PG_FEATURE_PCT | PG_FEATURE_REPOP_BATCH;
@@ -71,6 +71,11 @@ void mClockScheduler::dump(ceph::Formatter &f) const
     f.dump_int("queue_size", it->second.size());
   }
   f.close_section();
+
+  // per-class allocation vs. what was achieved
+  f.open_object_section("mClockAllocation");
+  mclock_conf.dump(f);
+  f.close_section();
 }
 
 void mClockScheduler::enqueue(OpSchedulerItem&& item)
@@ -168,6 +173,7 @@ WorkItem mClockScheduler::dequeue()
   } else {
     mclock_queue_t::PullReq result = scheduler.pull_request();
     if (result.is_future()) {
+      mclock_conf.note_throttled();
       return result.getTime();
     } else if (result.is_none()) {
       ceph_assert(
@@ -178,6 +184,8 @@ WorkItem mClockScheduler::dequeue()
 
       auto &retn = result.get_retn();
       mclock_conf.put_mclock_counter(retn.client);
+      mclock_conf.note_dequeue(
+	retn.client, retn.request->get_qos_cost(), !scheduler.empty());
       return std::move(*retn.request);
     }
   }
@@ -1377,6 +1377,12 @@ int PgScrubber::build_scrub_map_chunk(ScrubMap& map,
       break;
     }
     m_pg->_scan_rollback_obs(rollback_obs);
+    // the scrub map is keyed by object, so the scan order is ours to
+    // choose; for deep scrubs read the objects in on-disk order to save
+    // seeks
+    if (deep && m_pg->cct->_conf->osd_deep_scrub_sort_by_locality) {
+      m_pg->get_pgbackend()->be_order_by_locality(pos.ls);
+    }
     pos.pos = 0;
     return -EINPROGRESS;
   }
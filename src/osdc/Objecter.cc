@@ -2329,6 +2329,21 @@ void Objecter::op_submit(Op *op, ceph_tid_t *ptid, int *ctx_budget)
   _op_submit_with_budget(op, rl, ptid, ctx_budget);
 }
 
+void Objecter::op_submit(const std::vector<Op*>& ops,
+			 std::vector<ceph_tid_t> *ptids)
+{
+  shunique_lock rl(rwlock, ceph::acquire_shared);
+  if (ptids)
+    ptids->reserve(ptids->size() + ops.size());
+  for (auto op : ops) {
+    ceph_tid_t tid = 0;
+    op->trace.event("op submit");
+    _op_submit_with_budget(op, rl, &tid);
+    if (ptids)
+      ptids->push_back(tid);
+  }
+}
+
 void Objecter::_op_submit_with_budget(Op *op,
 				      shunique_lock<ceph::shared_mutex>& sul,
 				      ceph_tid_t *ptid,
@@ -2527,7 +2542,10 @@ void Objecter::_op_submit(Op *op, shunique_lock<ceph::shared_mutex>& sul, ceph_t
     _maybe_request_map();
   }
 
-  unique_lock sl(s->lock);
+  // the op is not visible to the reply path until _session_op_assign and
+  // cannot be answered before _send_op, so concurrent submitters (and
+  // replies) for the same session only need to share the session lock
+  shared_lock sl(s->lock);
   if (op->tid == 0)
     op->tid = ++last_tid;
 
@@ -2632,7 +2650,7 @@ start:
   for (auto siter = osd_sessions.begin();
        siter != osd_sessions.end(); ++siter) {
     auto s = siter->second;
-    shared_lock sl(s->lock);
+    unique_lock sl(s->lock);
     while (auto tid = next_subsystem_op(s->ops)) {
       sl.unlock();
       auto ret = op_cancel(s, *tid, ceph::from_error_code(ec), ec);
@@ -2645,7 +2663,7 @@ start:
   }
 
   // Handle case where the op is in homeless session
-  shared_lock sl(homeless_session->lock);
+  unique_lock sl(homeless_session->lock);
   while (auto tid = next_subsystem_op(homeless_session->ops)) {
     sl.unlock();
     auto ret = op_cancel(homeless_session, *tid, ceph::from_error_code(ec), ec);
@@ -2689,7 +2707,7 @@ start:
   for (auto siter = osd_sessions.begin();
        siter != osd_sessions.end(); ++siter) {
     OSDSession *s = siter->second;
-    shared_lock sl(s->lock);
+    unique_lock sl(s->lock);
     if (s->ops.find(tid) != s->ops.end()) {
       sl.unlock();
       ret = op_cancel(s, tid, r, osdcode(r));
@@ -2705,7 +2723,7 @@ start:
 		<< " not found in live sessions" << dendl;
 
   // Handle case where the op is in homeless session
-  shared_lock sl(homeless_session->lock);
+  unique_lock sl(homeless_session->lock);
   if (homeless_session->ops.find(tid) != homeless_session->ops.end()) {
     sl.unlock();
     ret = op_cancel(homeless_session, tid, r, osdcode(r));
@@ -2736,7 +2754,7 @@ epoch_t Objecter::op_cancel_writes(int r, int64_t pool)
   for (auto siter = osd_sessions.begin();
        siter != osd_sessions.end(); ++siter) {
     OSDSession *s = siter->second;
-    shared_lock sl(s->lock);
+    unique_lock sl(s->lock);
     for (auto op_i = s->ops.begin();
 	 op_i != s->ops.end(); ++op_i) {
       if (op_i->second->target.flags & CEPH_OSD_FLAG_WRITE
@@ -3166,13 +3184,16 @@ int Objecter::_map_session(op_target_t *target, OSDSession **s,
 
 void Objecter::_session_op_assign(OSDSession *to, Op *op)
 {
-  // to->lock is locked
+  // to->lock is locked (shared is enough)
   ceph_assert(op->session == NULL);
   ceph_assert(op->tid);
 
   get_session(to);
   op->session = to;
-  to->ops[op->tid] = op;
+  {
+    std::lock_guard l(to->ops_lock);
+    to->ops[op->tid] = op;
+  }
 
   if (to->is_homeless()) {
     num_homeless_ops++;
@@ -3184,13 +3205,16 @@ void Objecter::_session_op_assign(OSDSession *to, Op *op)
 void Objecter::_session_op_remove(OSDSession *from, Op *op)
 {
   ceph_assert(op->session == from);
-  // from->lock is locked
+  // from->lock is locked (shared is enough)
 
   if (from->is_homeless()) {
     num_homeless_ops--;
   }
 
-  from->ops.erase(op->tid);
+  {
+    std::lock_guard l(from->ops_lock);
+    from->ops.erase(op->tid);
+  }
   put_session(from);
   op->session = NULL;
 
@@ -3313,7 +3337,7 @@ void Objecter::_finish_op(Op *op, int r)
 {
   ldout(cct, 15) << __func__ << " " << op->tid << dendl;
 
-  // op->session->lock is locked unique or op->session is null
+  // op->session->lock is locked or op->session is null
 
   if (!op->ctx_budgeted && op->budget >= 0) {
     put_op_budget_bytes(op->budget);
@@ -3541,10 +3565,20 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
     return;
   }
 
-  unique_lock sl(s->lock);
+  // replies on one connection are dispatched serially, and everything
+  // else that touches a registered op (cancel, resend, timeout) takes the
+  // session lock unique, so shared is enough here
+  shared_lock sl(s->lock);
 
-  map<ceph_tid_t, Op *>::iterator iter = s->ops.find(tid);
-  if (iter == s->ops.end()) {
+  Op *op = nullptr;
+  {
+    std::lock_guard l(s->ops_lock);
+    auto iter = s->ops.find(tid);
+    if (iter != s->ops.end()) {
+      op = iter->second;
+    }
+  }
+  if (!op) {
     ldout(cct, 7) << "handle_osd_op_reply " << tid
 		  << (m->is_ondisk() ? " ondisk" : (m->is_onnvram() ?
 						    " onnvram" : " ack"))
@@ -3561,7 +3595,6 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
 		<< " in " << m->get_pg()
 		<< " attempt " << m->get_retry_attempt()
 		<< dendl;
-  Op *op = iter->second;
   op->trace.event("osd op reply");
 
   if (retry_writes_after_first_reply && op->attempts == 1 &&
@@ -4760,7 +4793,7 @@ void Objecter::_dump_active()
   for (auto siter = osd_sessions.begin();
        siter != osd_sessions.end(); ++siter) {
     auto s = siter->second;
-    shared_lock sl(s->lock);
+    unique_lock sl(s->lock);
     _dump_active(s);
     sl.unlock();
   }
@@ -4819,7 +4852,7 @@ void Objecter::dump_ops(Formatter *fmt)
   for (auto siter = osd_sessions.begin();
        siter != osd_sessions.end(); ++siter) {
     OSDSession *s = siter->second;
-    shared_lock sl(s->lock);
+    unique_lock sl(s->lock);
     _dump_ops(s, fmt);
     sl.unlock();
   }
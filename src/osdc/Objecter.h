@@ -2453,7 +2453,13 @@ public:
 
   struct OSDSession : public RefCountedObject {
     // pending ops
+    //
+    // ops is modified either with lock held unique, or with lock held
+    // shared plus ops_lock.  The latter lets op submission and reply
+    // handling for the same osd run concurrently; anything that walks
+    // ops must therefore hold lock unique (or take ops_lock).
     std::map<ceph_tid_t,Op*> ops;
+    ceph::mutex ops_lock = ceph::make_mutex("OSDSession::ops_lock");
     std::map<uint64_t, LingerOp*> linger_ops;
     std::map<ceph_tid_t,CommandOp*> command_ops;
 
@@ -2814,6 +2820,10 @@ private:
   // public interface
 public:
   void op_submit(Op *op, ceph_tid_t *ptid = NULL, int *ctx_budget = NULL);
+  // submit several ops under one acquisition of rwlock; the tid of each
+  // op is appended to ptids, if given
+  void op_submit(const std::vector<Op*>& ops,
+		 std::vector<ceph_tid_t> *ptids = nullptr);
   bool is_active() {
     std::shared_lock l(rwlock);
     return !((!inflight_ops) && linger_ops.empty() &&
@@ -131,6 +131,7 @@ void Striper::file_to_extents(CephContext *cct, const char *object_format,
                   &lightweight_object_extents);
 
   // convert lightweight object extents to heavyweight version
+  const auto oloc = OSDMap::file_to_object_locator(*layout);
   extents.reserve(lightweight_object_extents.size());
   for (auto& lightweight_object_extent : lightweight_object_extents) {
     auto& object_extent = extents.emplace_back(
@@ -139,7 +140,7 @@ void Striper::file_to_extents(CephContext *cct, const char *object_format,
       lightweight_object_extent.offset, lightweight_object_extent.length,
       lightweight_object_extent.truncate_size);
 
-    object_extent.oloc = OSDMap::file_to_object_locator(*layout);
+    object_extent.oloc = oloc;
     object_extent.buffer_extents.reserve(
       lightweight_object_extent.buffer_extents.size());
     object_extent.buffer_extents.insert(
@@ -162,6 +163,7 @@ void Striper::file_to_extents(
                   &lightweight_object_extents);
 
   // convert lightweight object extents to heavyweight version
+  const auto oloc = OSDMap::file_to_object_locator(*layout);
   for (auto& lightweight_object_extent : lightweight_object_extents) {
     auto oid = format_oid(object_format, lightweight_object_extent.object_no);
     auto& object_extent = object_extents[oid].emplace_back(
@@ -169,7 +171,7 @@ void Striper::file_to_extents(
       lightweight_object_extent.offset, lightweight_object_extent.length,
       lightweight_object_extent.truncate_size);
 
-      object_extent.oloc = OSDMap::file_to_object_locator(*layout);
+      object_extent.oloc = oloc;
       object_extent.buffer_extents.reserve(
         lightweight_object_extent.buffer_extents.size());
       object_extent.buffer_extents.insert(
@@ -2617,7 +2617,7 @@ class MgrModule(ceph_module.BaseMgrModule, MgrModuleLoggingMixin):
            'pg_id', 'object_name', 'snap_id'
         Valid performance counter types:
            'ops', 'write_ops', 'read_ops', 'bytes', 'write_bytes', 'read_bytes',
-           'latency', 'write_latency', 'read_latency'
+           'latency', 'write_latency', 'read_latency', 'slow_ops'
 
         :param object query: query
         :rtype: int (query id)
@@ -0,0 +1,219 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+#include "d4n_peers.h"
+
+#include <fmt/format.h>
+
+#include "common/ceph_hash.h"
+#include "common/dout.h"
+#include "common/errno.h"
+#include "rgw_op.h"
+#include "rgw_rest_conn.h"
+#include "rgw_rest_s3.h"
+#include "rgw_sal.h"
+#include "rgw_sal_d4n.h"
+
+#define dout_subsys ceph_subsys_rgw
+
+namespace rgw { namespace d4n {
+
+static uint32_t ring_hash(std::string_view s)
+{
+  return ceph_str_hash_rjenkins(s.data(), s.size());
+}
+
+HashRing::HashRing(std::vector<std::string> _nodes) : nodes(std::move(_nodes))
+{
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    for (unsigned p = 0; p < points_per_node; ++p) {
+      points.emplace(ring_hash(fmt::format("{}#{}", nodes[i], p)), i);
+    }
+  }
+}
+
+const std::string& HashRing::owner(std::string_view key) const
+{
+  auto i = points.lower_bound(ring_hash(key));
+  if (i == points.end()) { // wrap around
+    i = points.begin();
+  }
+  return nodes[i->second];
+}
+
+PeerCache::PeerCache(CephContext* cct, rgw::sal::Driver* driver,
+                     std::vector<std::string> peers, std::string self)
+  : self(std::move(self)), ring(std::move(peers))
+{
+  for (const auto& endpoint : ring.get_nodes()) {
+    if (endpoint == this->self) {
+      continue;
+    }
+    conns.emplace(endpoint, std::make_unique<RGWRESTConn>(
+        cct, driver, "d4n-peer", std::list<std::string>{endpoint},
+        std::nullopt));
+  }
+}
+
+PeerCache::~PeerCache() = default;
+
+RGWRESTConn* PeerCache::owner(std::string_view oid_in_cache)
+{
+  const auto& endpoint = ring.owner(oid_in_cache);
+  if (endpoint == self) {
+    return nullptr;
+  }
+  return conns.at(endpoint).get();
+}
+
+int PeerCache::fetch(const DoutPrefixProvider* dpp, RGWRESTConn* peer,
+                     const rgw_bucket& bucket, const rgw_obj_key& key,
+                     const std::string& etag, uint64_t ofs, uint64_t end,
+                     bufferlist& bl, optional_yield y)
+{
+  param_vec_t params = {
+    {"tenant", bucket.tenant},
+    {"bucket", bucket.name},
+    {"bucket-id", bucket.bucket_id},
+    {"object", key.name},
+    {"instance", key.instance},
+    {"ofs", std::to_string(ofs)},
+    {"end", std::to_string(end)},
+  };
+  std::map<std::string, std::string> headers;
+  if (!etag.empty()) {
+    headers.emplace("HTTP_IF_MATCH", etag);
+  }
+  int r = peer->get_resource(dpp, "/admin/d4n", &params, &headers, bl,
+                             nullptr, nullptr, y);
+  if (r < 0) {
+    ldpp_dout(dpp, 10) << "D4N PeerCache::" << __func__ << "(): failed to fetch "
+        << key << " [" << ofs << ", " << end << "] from peer "
+        << peer->get_url() << ": " << cpp_strerror(r) << dendl;
+    return r;
+  }
+  if (bl.length() != end - ofs + 1) {
+    ldpp_dout(dpp, 10) << "D4N PeerCache::" << __func__ << "(): short read of "
+        << key << " from peer: " << bl.length() << " of "
+        << end - ofs + 1 << " bytes" << dendl;
+    return -EIO;
+  }
+  return 0;
+}
+
+namespace {
+
+class ReadIntoBufferlist : public RGWGetDataCB {
+  bufferlist& bl;
+  public:
+    explicit ReadIntoBufferlist(bufferlist& bl) : bl(bl) {}
+    int handle_data(bufferlist& data, off_t ofs, off_t len) override {
+      data.begin(ofs).copy(len, bl);
+      return 0;
+    }
+};
+
+class RGWOp_D4N_Block_Get : public RGWRESTOp {
+  bufferlist bl;
+
+  public:
+    int verify_permission(optional_yield y) override {
+      // only peers, signing with the zone's system key, read blocks
+      if (!s->system_request) {
+        return -EACCES;
+      }
+      return 0;
+    }
+    void execute(optional_yield y) override;
+    void send_response() override;
+
+    const char* name() const override { return "d4n_get_block"; }
+};
+
+void RGWOp_D4N_Block_Get::execute(optional_yield y)
+{
+  rgw_bucket b;
+  rgw_obj_key key;
+  uint64_t ofs = 0, end = 0;
+  RESTArgs::get_string(s, "tenant", "", &b.tenant);
+  RESTArgs::get_string(s, "bucket", "", &b.name);
+  RESTArgs::get_string(s, "bucket-id", "", &b.bucket_id);
+  RESTArgs::get_string(s, "object", "", &key.name);
+  RESTArgs::get_string(s, "instance", "", &key.instance);
+  op_ret = RESTArgs::get_uint64(s, "ofs", 0, &ofs);
+  if (op_ret < 0) {
+    return;
+  }
+  op_ret = RESTArgs::get_uint64(s, "end", 0, &end);
+  if (op_ret < 0) {
+    return;
+  }
+  if (b.name.empty() || key.name.empty() || end < ofs) {
+    op_ret = -EINVAL;
+    return;
+  }
+
+  std::unique_ptr<rgw::sal::Bucket> bucket;
+  op_ret = driver->load_bucket(this, b, &bucket, y);
+  if (op_ret < 0) {
+    return;
+  }
+  auto obj = bucket->get_object(key);
+  // the owner on the caller's ring serves the read itself, whatever its own
+  // ring says, or the request could be forwarded back
+  if (auto d4n_obj = dynamic_cast<rgw::sal::D4NFilterObject*>(obj.get()); d4n_obj) {
+    d4n_obj->set_peer_read(true);
+  }
+  auto read_op = obj->get_read_op();
+  const char* if_match = s->info.env->get("HTTP_IF_MATCH");
+  read_op->params.if_match = if_match;
+  op_ret = read_op->prepare(y, this);
+  if (op_ret < 0) {
+    return;
+  }
+  if (end >= obj->get_size()) {
+    op_ret = -ERANGE;
+    return;
+  }
+
+  // the read goes through this gateway's cache, which keeps the block
+  ReadIntoBufferlist cb{bl};
+  op_ret = read_op->iterate(this, ofs, end, &cb, y);
+}
+
+void RGWOp_D4N_Block_Get::send_response()
+{
+  set_req_state_err(s, op_ret);
+  dump_errno(s);
+  end_header(s, this, "application/octet-stream",
+             op_ret < 0 ? NO_CONTENT_LENGTH : bl.length());
+  if (op_ret >= 0) {
+    dump_body(s, bl);
+  }
+}
+
+class RGWHandler_D4N : public RGWHandler_Auth_S3 {
+  protected:
+    RGWOp* op_get() override {
+      return new RGWOp_D4N_Block_Get;
+    }
+  public:
+    using RGWHandler_Auth_S3::RGWHandler_Auth_S3;
+    ~RGWHandler_D4N() override = default;
+
+    int read_permissions(RGWOp*, optional_yield) override {
+      return 0;
+    }
+};
+
+} // anonymous namespace
+
+RGWHandler_REST* RGWRESTMgr_D4N::get_handler(rgw::sal::Driver* driver,
+                                             req_state*,
+                                             const rgw::auth::StrategyRegistry& auth_registry,
+                                             const std::string&)
+{
+  return new RGWHandler_D4N(auth_registry);
+}
+
+} } // namespace rgw::d4n
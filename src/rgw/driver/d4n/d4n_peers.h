@@ -0,0 +1,84 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "rgw_common.h"
+#include "rgw_rest.h"
+
+class RGWRESTConn;
+
+namespace rgw::sal {
+  class Driver;
+}
+
+namespace rgw { namespace d4n {
+
+/* Consistent hash ring of the gateways that share a D4N cache. Each gateway
+ * is placed on the ring at several points, so adding or removing one only
+ * moves the blocks of its neighbours. */
+class HashRing {
+  std::vector<std::string> nodes;
+  std::map<uint32_t, size_t> points; // ring position -> index into nodes
+
+  public:
+    static constexpr unsigned points_per_node = 128;
+
+    explicit HashRing(std::vector<std::string> nodes);
+
+    bool empty() const { return nodes.empty(); }
+    const std::vector<std::string>& get_nodes() const { return nodes; }
+    /* the node that owns a key */
+    const std::string& owner(std::string_view key) const;
+};
+
+/* Routes the reads of cache blocks to the gateway that owns them on the
+ * ring, so that each block is cached by one gateway instead of by every
+ * gateway that reads it. The owner is asked for the block over the admin
+ * API, signed with the zone's system key, and reads it through its own
+ * cache: from its cache driver on a hit, or from the backend on a miss,
+ * keeping a copy for the next peer that asks. */
+class PeerCache {
+  std::string self;
+  HashRing ring;
+  std::map<std::string, std::unique_ptr<RGWRESTConn>> conns; // by endpoint
+
+  public:
+    /* peers is the endpoint list of rgw_d4n_cache_peers, self the entry of
+     * this gateway */
+    PeerCache(CephContext* cct, rgw::sal::Driver* driver,
+              std::vector<std::string> peers, std::string self);
+    ~PeerCache();
+
+    /* the connection to the gateway that owns a block, or nullptr when
+     * this gateway owns it */
+    RGWRESTConn* owner(std::string_view oid_in_cache);
+
+    /* read bytes [ofs, end] of an object through the cache of a peer. the
+     * etag guards against reading a different version than the caller */
+    int fetch(const DoutPrefixProvider* dpp, RGWRESTConn* peer,
+              const rgw_bucket& bucket, const rgw_obj_key& key,
+              const std::string& etag, uint64_t ofs, uint64_t end,
+              bufferlist& bl, optional_yield y);
+};
+
+/* the admin API that serves the block reads of peers: GET /admin/d4n/block */
+class RGWRESTMgr_D4N : public RGWRESTMgr {
+  public:
+    RGWRESTMgr_D4N() = default;
+    ~RGWRESTMgr_D4N() override = default;
+
+    RGWHandler_REST* get_handler(rgw::sal::Driver* driver,
+                                 req_state*,
+                                 const rgw::auth::StrategyRegistry& auth_registry,
+                                 const std::string&) override;
+};
+
+} } // namespace rgw::d4n
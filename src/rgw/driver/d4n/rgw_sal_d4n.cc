@@ -16,6 +16,8 @@
 #include "rgw_perf_counters.h"
 #include <boost/redis/config.hpp>
 #include <memory>
+#include "include/str_list.h"
+#include "rgw_rest_conn.h"
 #include "rgw_sal_d4n.h"
 
 namespace rgw { namespace sal {
@@ -95,6 +97,20 @@ int D4NFilterDriver::initialize(CephContext *cct, const DoutPrefixProvider *dpp)
   objDir->set_redis_pool(redis_pool);
   blockDir->set_redis_pool(redis_pool);
   bucketDir->set_redis_pool(redis_pool);
+
+  std::vector<std::string> peers;
+  get_str_vec(cct->_conf->rgw_d4n_cache_peers, ",", peers);
+  if (!peers.empty()) {
+    const std::string& self = cct->_conf->rgw_d4n_cache_peer_endpoint;
+    if (std::find(peers.begin(), peers.end(), self) == peers.end()) {
+      ldpp_dout(dpp, 0) << "D4NFilterDriver::" << __func__ << "(): Error: rgw_d4n_cache_peer_endpoint "
+        << self << " is not one of rgw_d4n_cache_peers, not sharing the cache" << dendl;
+    } else {
+      peerCache = std::make_unique<rgw::d4n::PeerCache>(cct, this, std::move(peers), self);
+      ldpp_dout(dpp, 10) << "D4NFilterDriver::" << __func__ << "(): sharing the cache with peers "
+        << cct->_conf->rgw_d4n_cache_peers << dendl;
+    }
+  }
   
   return 0;
 }
@@ -1662,10 +1678,19 @@ void D4NFilterDriver::shutdown()
   blockDir.reset();
   bucketDir.reset();
   policyDriver.reset();
+  peerCache.reset();
 
   next->shutdown();
 }
 
+void D4NFilterDriver::register_admin_apis(RGWRESTMgr* mgr)
+{
+  if (peerCache) {
+    mgr->register_resource("d4n", new rgw::d4n::RGWRESTMgr_D4N);
+  }
+  next->register_admin_apis(mgr);
+}
+
 std::unique_ptr<Object::ReadOp> D4NFilterObject::get_read_op()
 {
   std::unique_ptr<ReadOp> r = next->get_read_op();
@@ -1967,6 +1992,18 @@ int D4NFilterObject::D4NFilterReadOp::iterate(const DoutPrefixProvider* dpp, int
     block.cacheObj.objName = source->get_key().get_oid();
     block.cacheObj.bucketName = source->get_bucket()->get_bucket_id();
 
+    /* blocks owned by a peer are read through its cache, unless they're
+     * also cached for the destination of a copy or this is a peer's read */
+    const bool read_from_peers = source->driver->get_peer_cache() &&
+                                 !source->peer_read &&
+                                 !(source->dest_object && source->dest_bucket);
+    std::string etag;
+    if (read_from_peers) {
+      if (auto i = source->get_attrs().find(RGW_ATTR_ETAG); i != source->get_attrs().end()) {
+        etag = i->second.to_str();
+      }
+    }
+
     do {
       uint64_t id = adjusted_start_ofs, read_ofs = 0; //read_ofs is the actual offset to start reading from the current part/ chunk
       if (start_part_num == (num_parts - 1)) {
@@ -2011,7 +2048,31 @@ int D4NFilterObject::D4NFilterReadOp::iterate(const DoutPrefixProvider* dpp, int
         }
       } else { // else - if update_refcount_if_key_exists
         int r = -1;
-        if ((ret = block_dir->get(dpp, &block, y)) == 0) {
+        RGWRESTConn* peer = read_from_peers ? source->driver->get_block_owner(oid_in_cache) : nullptr;
+        bufferlist peer_bl;
+        if (peer && source->driver->get_peer_cache()->fetch(dpp, peer, source->get_bucket()->get_key(),
+                        source->get_key(), etag, adjusted_start_ofs, adjusted_start_ofs + part_len - 1,
+                        peer_bl, y) == 0) {
+          ldpp_dout(dpp, 20) << "D4NFilterObject::iterate:: " << __func__ << "(): " << __LINE__ << ": READ FROM PEER: oid_in_cache=" << oid_in_cache << dendl;
+          // send the pending cache reads first, so the data goes out in order
+          r = drain(dpp, y);
+          if (r < 0) {
+            ldpp_dout(dpp, 0) << "D4NFilterObject::iterate:: " << __func__ << "(): Error: failed to drain, ret=" << r << dendl;
+            return r;
+          }
+          bufferlist bl_part;
+          peer_bl.begin(read_ofs).copy(len_to_read, bl_part);
+          if (client_cb) {
+            r = client_cb->handle_data(bl_part, 0, bl_part.length());
+            if (r < 0) {
+              return r;
+            }
+          }
+          this->offset += bl_part.length();
+          if (perfcounter) {
+            perfcounter->inc(l_rgw_d4n_peer_hits);
+          }
+        } else if ((ret = block_dir->get(dpp, &block, y)) == 0) {
           if (block.version != version) {
             // TODO: If data has already been returned for any older versioned block, then return ‘retry’ error
             ldpp_dout(dpp, 20) << "D4NFilterObject::iterate:: " << __func__ << "(): Info: Version mismatch, draining data for oid: " << oid_in_cache << dendl;
@@ -2200,7 +2261,7 @@ int D4NFilterObject::D4NFilterReadOp::D4NFilterGetCB::handle_data(bufferlist& bl
 
     if (bl.length() > 0 && last_part) { // if bl = bl_rem has data and this is the last part, write it to cache
       std::string oid = get_key_in_cache(prefix, std::to_string(adjusted_start_ofs), std::to_string(bl_len));
-      if (!policy->exist_key(oid)) {
+      if (!policy->exist_key(oid) && source->keeps_block(oid)) {
         block.blockID = adjusted_start_ofs;
         block.size = bl.length();
 
@@ -2235,7 +2296,7 @@ int D4NFilterObject::D4NFilterReadOp::D4NFilterGetCB::handle_data(bufferlist& bl
       std::string oid = get_key_in_cache(prefix, std::to_string(adjusted_start_ofs), std::to_string(bl_len));
       block.blockID = adjusted_start_ofs;
       block.size = bl.length();
-      if (!policy->exist_key(oid)) {
+      if (!policy->exist_key(oid) && source->keeps_block(oid)) {
         auto ret = policy->eviction(dpp, block.size, *y);
         if (ret == 0) {
           ret = cache_driver->put(dpp, oid, bl, bl.length(), attrs, *y);
@@ -2273,7 +2334,7 @@ int D4NFilterObject::D4NFilterReadOp::D4NFilterGetCB::handle_data(bufferlist& bl
 
       if (bl_rem.length() == rgw_max_chunk_size) {
         std::string oid = prefix + CACHE_DELIM + std::to_string(adjusted_start_ofs) + CACHE_DELIM + std::to_string(bl_rem.length());
-          if (!policy->exist_key(oid)) {
+          if (!policy->exist_key(oid) && source->keeps_block(oid)) {
           block.blockID = adjusted_start_ofs;
           block.size = bl_rem.length();
           
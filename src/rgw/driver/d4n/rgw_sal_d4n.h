@@ -25,6 +25,7 @@
 
 #include "driver/d4n/d4n_directory.h"
 #include "driver/d4n/d4n_policy.h"
+#include "driver/d4n/d4n_peers.h"
 
 #include <boost/intrusive/list.hpp>
 #include <boost/asio/io_context.hpp>
@@ -59,6 +60,7 @@ class D4NFilterDriver : public FilterDriver {
     std::unique_ptr<rgw::d4n::BlockDirectory> blockDir;
     std::unique_ptr<rgw::d4n::BucketDirectory> bucketDir;
     std::unique_ptr<rgw::d4n::PolicyDriver> policyDriver;
+    std::unique_ptr<rgw::d4n::PeerCache> peerCache;
     boost::asio::io_context& io_context;
     optional_yield y;
 
@@ -88,10 +90,17 @@ class D4NFilterDriver : public FilterDriver {
     rgw::d4n::BlockDirectory* get_block_dir() { return blockDir.get(); }
     rgw::d4n::BucketDirectory* get_bucket_dir() { return bucketDir.get(); }
     rgw::d4n::PolicyDriver* get_policy_driver() { return policyDriver.get(); }
+    rgw::d4n::PeerCache* get_peer_cache() { return peerCache.get(); }
+    /* the peer that owns a cache block, or nullptr when this gateway owns
+     * it or doesn't share its cache */
+    RGWRESTConn* get_block_owner(const std::string& oid_in_cache) {
+      return peerCache ? peerCache->owner(oid_in_cache) : nullptr;
+    }
     void save_y(optional_yield y) { this->y = y; }
     std::shared_ptr<connection> get_conn() { return conn; }
     std::shared_ptr<rgw::d4n::RedisPool> get_redis_pool() { return redis_pool; }
     void shutdown() override;
+    virtual void register_admin_apis(RGWRESTMgr* mgr) override;
 };
 
 class D4NFilterUser : public FilterUser {
@@ -144,6 +153,7 @@ class D4NFilterObject : public FilterObject {
     bool exists_in_cache{false};
     bool load_from_store{false};
     bool attrs_read_from_cache{false};
+    bool peer_read{false}; //serving the block read of a peer, never forwarded
 
   public:
     struct D4NFilterReadOp : FilterReadOp {
@@ -277,6 +287,13 @@ class D4NFilterObject : public FilterObject {
     virtual std::unique_ptr<DeleteOp> get_delete_op() override;
 
     void set_object_version(const std::string& version) { this->version = version; }
+    /* reads for a peer stay on this gateway, even for blocks it doesn't own
+     * on its ring, so they can't bounce between gateways whose rings differ */
+    void set_peer_read(bool peer_read) { this->peer_read = peer_read; }
+    /* whether a block read from the backend is kept in this gateway's cache */
+    bool keeps_block(const std::string& oid_in_cache) {
+      return peer_read || !driver->get_block_owner(oid_in_cache);
+    }
     const std::string get_object_version() { return this->version; }
 
     void set_prefix(const std::string& prefix) { this->prefix = prefix; }
@@ -358,10 +358,16 @@ public:
     return k_str;
   }
 
+  /* entries put in lmdb per transaction while filling, so the fill of a
+   * large bucket doesn't hold the write lock of its environment (shared
+   * with other buckets) for the whole scan */
+  static constexpr uint32_t fill_txn_entries = 4096;
+
   int fill(const DoutPrefixProvider* dpp, BucketCacheEntry<D, B>* bucket,
 	    B* sal_bucket, uint32_t flags, optional_yield y) /* assert: LOCKED */
   {
       auto txn = bucket->env->getRWTransaction();
+      uint32_t txn_entries{0};
 
       /* instruct the bucket provider to enumerate all entries,
        * in any order */
@@ -385,6 +391,11 @@ public:
 	  }
 	  txn->put(bucket->dbi, concat_k, ser_data);
 	  //std::cout << fmt::format("{} {}", __func__, bde.key.name) << '\n';
+	  if (++txn_entries == fill_txn_entries) {
+	    txn->commit();
+	    txn = bucket->env->getRWTransaction();
+	    txn_entries = 0;
+	  }
 	  return 0;
 	});
 
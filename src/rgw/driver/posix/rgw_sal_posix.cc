@@ -18,6 +18,10 @@
 #include <sys/stat.h>
 #include <sys/xattr.h>
 #include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <boost/asio/random_access_file.hpp>
+#include <boost/asio/write_at.hpp>
 #include "rgw_multi.h"
 #include "include/scope_guard.h"
 #include "common/Clock.h" // for ceph_clock_now()
@@ -583,7 +587,6 @@ int File::write(int64_t ofs, bufferlist& bl, const DoutPrefixProvider* dpp,
 		       optional_yield y)
 {
   int64_t left = bl.length();
-  char* curp = bl.c_str();
   ssize_t ret;
 
   ret = fchmod(fd, S_IRUSR|S_IWUSR);
@@ -594,16 +597,32 @@ int File::write(int64_t ofs, bufferlist& bl, const DoutPrefixProvider* dpp,
   }
 
 
-  ret = lseek(fd, ofs, SEEK_SET);
-  if (ret < 0) {
-    ret = errno;
-    ldpp_dout(dpp, 0) << "ERROR: could not seek object " << get_name() << " to "
-      << ofs << " :" << cpp_strerror(ret) << dendl;
-    return -ret;
+#ifdef BOOST_ASIO_HAS_FILE
+  if (y) {
+    /* write through io_uring, suspending the request instead of blocking
+     * the frontend thread */
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.reserve(bl.get_num_buffers());
+    for (const auto& ptr : bl.buffers()) {
+      buffers.emplace_back(ptr.c_str(), ptr.length());
+    }
+    boost::system::error_code ec;
+    auto& yield = y.get_yield_context();
+    boost::asio::random_access_file file(yield.get_executor(), fd);
+    boost::asio::async_write_at(file, ofs, buffers, yield[ec]);
+    file.release(); // fd stays owned by this File
+    if (ec) {
+      ldpp_dout(dpp, 0) << "ERROR: could not write object " << get_name() << ": "
+	<< ec.message() << dendl;
+      return -ec.value();
+    }
+    return 0;
   }
+#endif
 
+  char* curp = bl.c_str();
   while (left > 0) {
-    ret = ::write(fd, curp, left);
+    ret = ::pwrite(fd, curp, left, ofs);
     if (ret < 0) {
       ret = errno;
       ldpp_dout(dpp, 0) << "ERROR: could not write object " << get_name() << ": "
@@ -613,6 +632,7 @@ int File::write(int64_t ofs, bufferlist& bl, const DoutPrefixProvider* dpp,
 
     curp += ret;
     left -= ret;
+    ofs += ret;
   }
 
   return 0;
@@ -624,26 +644,45 @@ int File::read(int64_t ofs, int64_t left, bufferlist& bl,
   int64_t len = std::min(left, READ_SIZE);
   ssize_t ret;
 
-  ret = lseek(fd, ofs, SEEK_SET);
-  if (ret < 0) {
-    ret = errno;
-    ldpp_dout(dpp, 0) << "ERROR: could not seek object " << get_name() << " to "
-                      << ofs << " :" << cpp_strerror(ret) << dendl;
-    return -ret;
+  /* read straight into the buffer that's appended to bl */
+  bufferptr bp = buffer::create(len);
+
+#ifdef BOOST_ASIO_HAS_FILE
+  if (y) {
+    /* read through io_uring, suspending the request instead of blocking
+     * the frontend thread */
+    boost::system::error_code ec;
+    auto& yield = y.get_yield_context();
+    boost::asio::random_access_file file(yield.get_executor(), fd);
+    ret = file.async_read_some_at(ofs, boost::asio::buffer(bp.c_str(), len),
+				  yield[ec]);
+    file.release(); // fd stays owned by this File
+    if (ec == boost::asio::error::eof) {
+      return 0;
     }
-
-    char read_buf[READ_SIZE];
-    ret = ::read(fd, read_buf, len);
-    if (ret < 0) {
-      ret = errno;
+    if (ec) {
       ldpp_dout(dpp, 0) << "ERROR: could not read object " << get_name() << ": "
-	<< cpp_strerror(ret) << dendl;
-      return -ret;
+	<< ec.message() << dendl;
+      return -ec.value();
     }
+    bp.set_length(ret);
+    bl.append(std::move(bp));
+    return ret;
+  }
+#endif
 
-    bl.append(read_buf, ret);
+  ret = ::pread(fd, bp.c_str(), len, ofs);
+  if (ret < 0) {
+    ret = errno;
+    ldpp_dout(dpp, 0) << "ERROR: could not read object " << get_name() << ": "
+	<< cpp_strerror(ret) << dendl;
+    return -ret;
+  }
 
-    return ret;
+  bp.set_length(ret);
+  bl.append(std::move(bp));
+
+  return ret;
 }
 
 int File::copy(const DoutPrefixProvider *dpp, optional_yield y,
@@ -1079,28 +1118,115 @@ int Directory::get_ent(const DoutPrefixProvider *dpp, optional_yield y, const st
   return 0;
 }
 
-int Directory::fill_cache(const DoutPrefixProvider *dpp, optional_yield y,
-                          fill_cache_cb_t &cb)
-{
-  int ret = for_each(dpp, [this, &cb, &dpp, &y](const char *name) {
-    std::unique_ptr<FSEnt> ent;
+/* number of entries read from a directory before they're filled */
+static constexpr size_t fill_cache_chunk = 1024;
 
-    if (name[0] == '.') {
-      /* Skip dotfiles */
-      return 0;
-    }
+int Directory::fill_cache_entries(const DoutPrefixProvider *dpp, optional_yield y,
+                                  fill_cache_cb_t &cb)
+{
+  /* stat()ing an entry and reading its xattrs takes several syscalls, which
+   * dominate the time to fill the listing cache of a large bucket, so the
+   * entries of a chunk are filled by a few threads.  Nested directories
+   * (versions, multipart uploads) are filled by the thread that found them */
+  static thread_local bool fill_worker = false;
+  const size_t nthreads = fill_worker ? 1 : std::max<int64_t>(1,
+      ctx->_conf.get_val<int64_t>("rgw_posix_cache_fill_threads"));
 
+  auto fill_one = [this, dpp](const std::string& name, optional_yield y,
+                              fill_cache_cb_t& cb) {
+    std::unique_ptr<FSEnt> ent;
     int ret = get_ent(dpp, y, name, std::string(), ent);
     if (ret < 0)
       return ret;
 
     ent->stat(dpp); // Stat the object to get the type
 
-    ret = ent->fill_cache(dpp, y, cb);
-    if (ret < 0)
-      return ret;
+    return ent->fill_cache(dpp, y, cb);
+  };
+
+  if (nthreads == 1) {
+    return for_each(dpp, [&fill_one, &cb, &y](const char *name) {
+      if (name[0] == '.') {
+        /* Skip dotfiles */
+        return 0;
+      }
+      return fill_one(name, y, cb);
+    });
+  }
+
+  std::vector<std::string> names;
+  names.reserve(fill_cache_chunk);
+
+  /* the workers collect the entries of each name, then this thread hands
+   * them to cb in order, as cb may write to a transaction it owns */
+  auto fill_chunk = [&]() {
+    std::vector<std::vector<rgw_bucket_dir_entry>> results(names.size());
+    std::atomic<size_t> next{0};
+    std::atomic<int> error{0};
+
+    auto work = [&]() {
+      fill_worker = true;
+      for (size_t i = next++; i < names.size() && error == 0; i = next++) {
+        auto& out = results[i];
+        fill_cache_cb_t collect = [&out](const DoutPrefixProvider*,
+                                         rgw_bucket_dir_entry& bde) {
+          out.push_back(std::move(bde));
+          return 0;
+        };
+        int r = fill_one(names[i], null_yield, collect);
+        if (r < 0) {
+          int expected = 0;
+          error.compare_exchange_strong(expected, r);
+        }
+      }
+      fill_worker = false;
+    };
+
+    std::vector<std::thread> workers;
+    const size_t n = std::min(nthreads, names.size());
+    for (size_t t = 1; t < n; ++t) {
+      workers.emplace_back(work);
+    }
+    work(); // this thread takes a share too
+    for (auto& w : workers) {
+      w.join();
+    }
+    names.clear();
+    if (error < 0) {
+      return error.load();
+    }
+
+    for (auto& entries : results) {
+      for (auto& bde : entries) {
+        int r = cb(dpp, bde);
+        if (r < 0)
+          return r;
+      }
+    }
     return 0;
+  };
+
+  int ret = for_each(dpp, [&names, &fill_chunk](const char *name) {
+    if (name[0] == '.') {
+      /* Skip dotfiles */
+      return 0;
+    }
+    names.emplace_back(name);
+    if (names.size() < fill_cache_chunk) {
+      return 0;
+    }
+    return fill_chunk();
   });
+  if (ret == 0 && !names.empty()) {
+    ret = fill_chunk();
+  }
+  return ret;
+}
+
+int Directory::fill_cache(const DoutPrefixProvider *dpp, optional_yield y,
+                          fill_cache_cb_t &cb)
+{
+  int ret = fill_cache_entries(dpp, y, cb);
 
   if (ret < 0) {
     ldpp_dout(dpp, 0) << "ERROR: could not list directory " << get_name() << ": "
@@ -1797,25 +1923,7 @@ int VersionedDirectory::remove(const DoutPrefixProvider* dpp, optional_yield y,
 int VersionedDirectory::fill_cache(const DoutPrefixProvider *dpp, optional_yield y,
                           fill_cache_cb_t &cb)
 {
-  int ret = for_each(dpp, [this, &cb, &dpp, &y](const char *name) {
-    std::unique_ptr<FSEnt> ent;
-
-    if (name[0] == '.') {
-      /* Skip dotfiles */
-      return 0;
-    }
-
-    int ret = get_ent(dpp, y, name, std::string(), ent);
-    if (ret < 0)
-      return ret;
-
-    ent->stat(dpp); // Stat the object to get the type
-
-    ret = ent->fill_cache(dpp, y, cb);
-    if (ret < 0)
-      return ret;
-    return 0;
-  });
+  int ret = fill_cache_entries(dpp, y, cb);
 
   if (ret < 0) {
     ldpp_dout(dpp, 0) << "ERROR: could not list directory " << get_name() << ": "
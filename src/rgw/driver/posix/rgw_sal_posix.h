@@ -213,6 +213,10 @@ public:
   virtual int fill_cache(const DoutPrefixProvider* dpp, optional_yield y, fill_cache_cb_t& cb) override;
 
   int get_ent(const DoutPrefixProvider *dpp, optional_yield y, const std::string& name, const std::string& version, std::unique_ptr<FSEnt>& ent);
+
+protected:
+  /* fill the cache with the entries of this directory, skipping dotfiles */
+  int fill_cache_entries(const DoutPrefixProvider *dpp, optional_yield y, fill_cache_cb_t& cb);
 };
 
 class Symlink: public File {
@@ -2,6 +2,7 @@
 // vim: ts=8 sw=2 sts=2 expandtab ft=cpp
 
 #include "common/Clock.h" // for ceph_clock_now()
+#include "common/async/spawn_throttle.h"
 #include "common/JSONFormatter.h"
 #include "include/function2.hpp"
 #include "rgw_acl_s3.h"
@@ -1513,35 +1514,94 @@ int RGWBucketAdminOp::sync_bucket(rgw::sal::Driver* driver, RGWBucketAdminOpStat
   return bucket.sync(op_state, dpp, y, err_msg);
 }
 
-static int bucket_stats(rgw::sal::Driver* driver,
-                        const std::string& tenant_name,
-                        const std::string& bucket_name, Formatter* formatter,
-                        const DoutPrefixProvider* dpp, optional_yield y) {
+namespace {
+
+struct bucket_stats_entry {
+  std::string name;
+  int ret = 0;
   std::unique_ptr<rgw::sal::Bucket> bucket;
   map<RGWObjCategory, RGWStorageStats> stats;
+  std::string bucket_ver, master_ver;
+  std::string max_marker;
+};
 
-  int ret = driver->load_bucket(dpp, rgw_bucket(tenant_name, bucket_name),
-                                &bucket, y);
+} // anonymous namespace
+
+static int read_bucket_stats(rgw::sal::Driver* driver,
+                             const std::string& tenant_name,
+                             bucket_stats_entry& entry,
+                             const DoutPrefixProvider* dpp, optional_yield y)
+{
+  int ret = driver->load_bucket(dpp, rgw_bucket(tenant_name, entry.name),
+                                &entry.bucket, y);
   if (ret < 0) {
     return ret;
   }
 
-  const RGWBucketInfo& bucket_info = bucket->get_info();
-
-  const auto& index = bucket_info.get_current_index();
+  const auto& index = entry.bucket->get_info().get_current_index();
   if (is_layout_indexless(index)) {
     cerr << "error, indexless buckets do not maintain stats; bucket=" <<
-      bucket->get_name() << std::endl;
+      entry.name << std::endl;
     return -EINVAL;
   }
 
-  std::string bucket_ver, master_ver;
-  std::string max_marker;
-  ret = bucket->read_stats(dpp, y, index, RGW_NO_SHARD, &bucket_ver, &master_ver, stats, &max_marker);
+  ret = entry.bucket->read_stats(dpp, y, index, RGW_NO_SHARD,
+                                 &entry.bucket_ver, &entry.master_ver,
+                                 entry.stats, &entry.max_marker);
   if (ret < 0) {
-    cerr << "error getting bucket stats bucket=" << bucket->get_name() << " ret=" << ret << std::endl;
+    cerr << "error getting bucket stats bucket=" << entry.name << " ret=" << ret << std::endl;
     return ret;
   }
+  return 0;
+}
+
+/* read the stats of a page of buckets with up to max_aio of them in flight.
+ * the result of each bucket is left in its entry */
+static void read_bucket_stats(rgw::sal::Driver* driver,
+                              const std::string& tenant_name,
+                              std::vector<bucket_stats_entry>& entries,
+                              int max_aio, const DoutPrefixProvider* dpp,
+                              optional_yield y)
+{
+  if (max_aio <= 1) {
+    for (auto& entry : entries) {
+      entry.ret = read_bucket_stats(driver, tenant_name, entry, dpp, y);
+    }
+    return;
+  }
+
+  auto read_all = [&] (boost::asio::yield_context yield) {
+    auto throttle = ceph::async::spawn_throttle{yield, size_t(max_aio)};
+    for (auto& entry : entries) {
+      throttle.spawn([&] (boost::asio::yield_context yield) {
+        entry.ret = read_bucket_stats(driver, tenant_name, entry, dpp, yield);
+      });
+    }
+    throttle.wait();
+  };
+
+  // if we're not running in a coroutine, spawn one
+  if (!y) {
+    boost::asio::io_context context;
+    boost::asio::spawn(context, read_all,
+        [] (std::exception_ptr eptr) {
+          if (eptr) std::rethrow_exception(eptr);
+        });
+    context.run();
+  } else {
+    read_all(y.get_yield_context());
+  }
+}
+
+static void dump_bucket_stats(bucket_stats_entry& entry,
+                              Formatter* formatter)
+{
+  const auto& bucket = entry.bucket;
+  auto& stats = entry.stats;
+  const auto& bucket_ver = entry.bucket_ver;
+  const auto& master_ver = entry.master_ver;
+  const auto& max_marker = entry.max_marker;
+  const RGWBucketInfo& bucket_info = bucket->get_info();
 
   utime_t ut(bucket->get_modification_time());
   utime_t ctime_ut(bucket->get_creation_time());
@@ -1593,10 +1653,37 @@ static int bucket_stats(rgw::sal::Driver* driver,
   // TODO: bucket CORS
   // TODO: bucket LC
   formatter->close_section();
+}
 
+static int bucket_stats(rgw::sal::Driver* driver,
+                        const std::string& tenant_name,
+                        const std::string& bucket_name, Formatter* formatter,
+                        const DoutPrefixProvider* dpp, optional_yield y) {
+  bucket_stats_entry entry;
+  entry.name = bucket_name;
+  int ret = read_bucket_stats(driver, tenant_name, entry, dpp, y);
+  if (ret < 0) {
+    return ret;
+  }
+  dump_bucket_stats(entry, formatter);
   return 0;
 }
 
+/* dump the stats of a page of buckets in order, skipping those that failed */
+static void bucket_stats(rgw::sal::Driver* driver,
+                         const std::string& tenant_name,
+                         std::vector<bucket_stats_entry>& entries,
+                         int max_aio, Formatter* formatter,
+                         const DoutPrefixProvider* dpp, optional_yield y)
+{
+  read_bucket_stats(driver, tenant_name, entries, max_aio, dpp, y);
+  for (auto& entry : entries) {
+    if (entry.ret >= 0) {
+      dump_bucket_stats(entry, formatter);
+    }
+  }
+}
+
 int RGWBucketAdminOp::limit_check(rgw::sal::Driver* driver,
 				  RGWBucketAdminOpState& op_state,
 				  const std::list<std::string>& user_ids,
@@ -1713,6 +1800,7 @@ static int list_owner_bucket_info(const DoutPrefixProvider* dpp,
                                   const std::string& marker,
 				  uint32_t max_entries,
                                   bool show_stats,
+                                  int max_aio,
                                   RGWFormatterFlusher& flusher)
 {
   bool max_entries_specified = (max_entries > 0);
@@ -1758,9 +1846,10 @@ static int list_owner_bucket_info(const DoutPrefixProvider* dpp,
       return ret;
     }
 
+    std::vector<bucket_stats_entry> entries;
     for (const auto& ent : listing.buckets) {
       if (show_stats) {
-        bucket_stats(driver, tenant, ent.bucket.name, formatter, dpp, y);
+        entries.emplace_back().name = ent.bucket.name;
       } else {
         formatter->dump_string("bucket", ent.bucket.name);
       }
@@ -1770,6 +1859,9 @@ static int list_owner_bucket_info(const DoutPrefixProvider* dpp,
         break;
       }
     } // for loop
+    if (show_stats) {
+      bucket_stats(driver, tenant, entries, max_aio, formatter, dpp, y);
+    }
 
     flusher.flush();
 
@@ -1828,10 +1920,12 @@ int RGWBucketAdminOp::info(rgw::sal::Driver* driver,
       ldpp_dout(dpp, 1) << "Listing buckets in user account "
           << info.account_id << dendl;
       ret = list_owner_bucket_info(dpp, y, driver, info.account_id, uid.tenant,
-                                   op_state.marker, op_state.max_entries, show_stats, flusher);
+                                   op_state.marker, op_state.max_entries, show_stats,
+                                   op_state.get_max_aio(), flusher);
     } else {
       ret = list_owner_bucket_info(dpp, y, driver, uid, uid.tenant,
-                                   op_state.marker, op_state.max_entries, show_stats, flusher);
+                                   op_state.marker, op_state.max_entries, show_stats,
+                                   op_state.get_max_aio(), flusher);
     }
     if (ret < 0) {
       return ret;
@@ -1850,7 +1944,8 @@ int RGWBucketAdminOp::info(rgw::sal::Driver* driver,
     }
 
     ret = list_owner_bucket_info(dpp, y, driver, account_id, info.tenant,
-                                 op_state.marker, op_state.max_entries, show_stats, flusher);
+                                 op_state.marker, op_state.max_entries, show_stats,
+                                 op_state.get_max_aio(), flusher);
     if (ret < 0) {
       return ret;
     }
@@ -1865,13 +1960,20 @@ int RGWBucketAdminOp::info(rgw::sal::Driver* driver,
       constexpr int max_keys = 1000;
       ret = driver->meta_list_keys_next(dpp, handle, max_keys, buckets,
 						   &truncated);
-      for (auto& bucket_name : buckets) {
-        if (show_stats) {
-          bucket_stats(driver, user_id.tenant, bucket_name, formatter, dpp, y);
-	} else {
+      if (show_stats) {
+        std::vector<bucket_stats_entry> entries;
+        entries.reserve(buckets.size());
+        for (auto& bucket_name : buckets) {
+          entries.emplace_back().name = std::move(bucket_name);
+        }
+        bucket_stats(driver, user_id.tenant, entries, op_state.get_max_aio(),
+                     formatter, dpp, y);
+      } else {
+        for (auto& bucket_name : buckets) {
           formatter->dump_string("bucket", bucket_name);
-	}
+        }
       }
+      flusher.flush();
     }
     driver->meta_list_keys_complete(handle);
 
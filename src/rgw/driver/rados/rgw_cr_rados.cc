@@ -812,6 +812,7 @@ int RGWAsyncFetchRemoteObj::_send_request(const DoutPrefixProvider *dpp)
 
   std::optional<uint64_t> bytes_transferred;
   const req_context rctx{dpp, null_yield, nullptr};
+  const auto start = ceph::mono_clock::now();
   int r = store->getRados()->fetch_remote_obj(obj_ctx,
                        NULL, /* uid */
                        user_id ? &*user_id : nullptr, /* replication uid */
@@ -846,7 +847,8 @@ int RGWAsyncFetchRemoteObj::_send_request(const DoutPrefixProvider *dpp)
                        source_trace_entry,
                        &zones_trace,
                        &bytes_transferred,
-                       keep_tags);
+                       keep_tags,
+                       prefetched.get());
 
   if (r < 0) {
     ldpp_dout(dpp, 0) << "store->fetch_remote_obj() returned r=" << r << dendl;
@@ -864,6 +866,8 @@ int RGWAsyncFetchRemoteObj::_send_request(const DoutPrefixProvider *dpp)
       if (counters) {
         if (bytes_transferred) {
           counters->inc(sync_counters::l_fetch, *bytes_transferred);
+          counters->tinc(sync_counters::l_fetch_lat,
+                         ceph::mono_clock::now() - start);
         } else {
           counters->inc(sync_counters::l_fetch_not_modified);
         }
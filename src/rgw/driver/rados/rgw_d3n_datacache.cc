@@ -34,7 +34,12 @@ int D3nCacheAioWriteRequest::d3n_libaio_prepare_write_op(bufferlist& bl, unsigne
   cb = new struct aiocb;
   mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
   memset(cb, 0, sizeof(struct aiocb));
-  r = fd = ::open(location.c_str(), O_WRONLY | O_CREAT | O_TRUNC, mode);
+  const bool direct = g_conf()->rgw_d3n_l1_direct_io;
+  int flags = O_WRONLY | O_CREAT | O_TRUNC;
+  if (direct) {
+    flags |= O_DIRECT;
+  }
+  r = fd = ::open(location.c_str(), flags, mode);
   if (fd < 0) {
     ldout(cct, 0) << "ERROR: D3nCacheAioWriteRequest::create_io: open file failed, errno=" << errno << ", location='" << location.c_str() << "'" << dendl;
     return r;
@@ -45,14 +50,27 @@ int D3nCacheAioWriteRequest::d3n_libaio_prepare_write_op(bufferlist& bl, unsigne
     posix_fadvise(fd, 0, 0, g_conf()->rgw_d3n_l1_fadvise);
   cb->aio_fildes = fd;
 
-  data = malloc(len);
+  // O_DIRECT writes whole aligned blocks, the completion truncates the
+  // file back to len
+  const unsigned int nbytes = direct ? p2roundup<unsigned>(len, D3N_DIRECT_IO_ALIGN) : len;
+  if (direct) {
+    if (::posix_memalign(&data, D3N_DIRECT_IO_ALIGN, nbytes) != 0) {
+      data = nullptr;
+    }
+  } else {
+    data = malloc(len);
+  }
   if (!data) {
     ldout(cct, 0) << "ERROR: D3nCacheAioWriteRequest::create_io: memory allocation failed" << dendl;
     return -1;
   }
   cb->aio_buf = data;
-  memcpy((void*)data, bl.c_str(), len);
-  cb->aio_nbytes = len;
+  bl.begin().copy(len, static_cast<char*>(data));
+  if (nbytes > len) {
+    memset(static_cast<char*>(data) + len, 0, nbytes - len);
+  }
+  cb->aio_nbytes = nbytes;
+  this->len = len;
 
   return r;
 }
@@ -101,6 +119,14 @@ void D3nDataCache::init(CephContext *_cct) {
   if (conf_eviction_policy == "random")
     eviction_policy = _eviction_policy::RANDOM;
 
+  tinylfu_admission = eviction_policy == _eviction_policy::LRU &&
+    cct->_conf.get_val<std::string>("rgw_d3n_l1_admission_policy") == "tinylfu";
+  if (tinylfu_admission) {
+    // cache entries are rados objects of up to a stripe each
+    sketch.init(cct->_conf->rgw_d3n_l1_datacache_size /
+                std::max<uint64_t>(cct->_conf->rgw_obj_stripe_size, 1));
+  }
+
 #if defined(HAVE_LIBAIO) && defined(__GLIBC__)
   // libaio setup
   struct aioinit ainit{0};
@@ -175,20 +201,25 @@ void D3nDataCache::d3n_libaio_write_completion_cb(D3nCacheAioWriteRequest* c)
 
   ldout(cct, 5) << "D3nDataCache: " << __func__ << "(): oid=" << c->oid << dendl;
 
+  if (c->cb->aio_nbytes != c->len && ::ftruncate(c->fd, c->len) < 0) {
+    // get() would find the size mismatch and drop the entry anyway
+    ldout(cct, 1) << "ERROR: D3nDataCache: " << __func__ << "(): ftruncate failed, errno=" << errno << dendl;
+  }
+
   { // update cache_map entries for new chunk in cache
     const std::lock_guard l(d3n_cache_lock);
     d3n_outstanding_write_list.erase(c->oid);
     chunk_info = new D3nChunkDataInfo;
     chunk_info->oid = c->oid;
     chunk_info->set_ctx(cct);
-    chunk_info->size = c->cb->aio_nbytes;
+    chunk_info->size = c->len;
     d3n_cache_map.insert(pair<string, D3nChunkDataInfo*>(c->oid, chunk_info));
   }
 
   { // update free size
     const std::lock_guard l(d3n_eviction_lock);
-    free_data_cache_size -= c->cb->aio_nbytes;
-    outstanding_write_size -= c->cb->aio_nbytes;
+    free_data_cache_size -= c->len;
+    outstanding_write_size -= c->len;
     lru_insert_head(chunk_info);
   }
 
@@ -251,6 +282,14 @@ void D3nDataCache::put(bufferlist& bl, unsigned int len, std::string& oid)
     _outstanding_write_size = outstanding_write_size;
   }
   ldout(cct, 20) << "D3nDataCache: Before eviction _free_data_cache_size:" << _free_data_cache_size << ", _outstanding_write_size:" << _outstanding_write_size << ", freed_size:" << freed_size << dendl;
+  if (tinylfu_admission &&
+      len > _free_data_cache_size - _outstanding_write_size &&
+      !admit(digest_oid, len - (_free_data_cache_size - _outstanding_write_size))) {
+    ldout(cct, 20) << "D3nDataCache: not admitted, the entries it would evict are requested more often" << dendl;
+    const std::lock_guard l(d3n_cache_lock);
+    d3n_outstanding_write_list.erase(digest_oid);
+    return;
+  }
   while (len > (_free_data_cache_size - _outstanding_write_size + freed_size)) {
     ldout(cct, 20) << "D3nDataCache: enter eviction" << dendl;
     if (eviction_policy == _eviction_policy::LRU) {
@@ -283,6 +322,22 @@ void D3nDataCache::put(bufferlist& bl, unsigned int len, std::string& oid)
   outstanding_write_size += len;
 }
 
+bool D3nDataCache::admit(const std::string& digest_oid, uint64_t needed)
+{
+  const std::lock_guard l(d3n_eviction_lock);
+  const auto frequency = sketch.estimate(digest_oid);
+  // the new entry must be requested more often than each entry it evicts,
+  // so a large one has to beat more of them
+  uint64_t freed = 0;
+  for (auto victim = tail; victim && freed < needed; victim = victim->lru_prev) {
+    if (sketch.estimate(victim->oid) >= frequency) {
+      return false;
+    }
+    freed += victim->size;
+  }
+  return true;
+}
+
 bool D3nDataCache::get(const string& oid, const off_t len)
 {
   const std::lock_guard l(d3n_cache_lock);
@@ -290,6 +345,11 @@ bool D3nDataCache::get(const string& oid, const off_t len)
   std::string digest_oid = D3nL1CacheRequest::generate_oid_digest(oid);
   string location = cache_location + digest_oid;
 
+  if (tinylfu_admission) {
+    const std::lock_guard l(d3n_eviction_lock);
+    sketch.increment(digest_oid);
+  }
+
   lsubdout(g_ceph_context, rgw_datacache, 20) << "D3nDataCache: " << __func__ << "(): oid=" << oid << ", digest_oid=" << digest_oid << ", location=" << location << dendl;
   std::unordered_map<string, D3nChunkDataInfo*>::iterator iter = d3n_cache_map.find(digest_oid);
   if (!(iter == d3n_cache_map.end())) {
@@ -12,6 +12,7 @@
 #include <signal.h>
 #include "include/Context.h"
 #include "include/lru.h"
+#include "common/FrequencySketch.h"
 #include "rgw_d3n_cacherequest.h"
 
 
@@ -41,6 +42,7 @@ struct D3nChunkDataInfo : public LRUObject {
 struct D3nCacheAioWriteRequest {
 	std::string oid;
 	void *data = nullptr;
+	unsigned int len = 0; // the chunk length, aio_nbytes may be padded for O_DIRECT
 	int fd = -1;
 	struct aiocb *cb = nullptr;
 	D3nDataCache *priv_data = nullptr;
@@ -74,6 +76,8 @@ private:
   enum class _eviction_policy {
     LRU=0, RANDOM=1
   } eviction_policy;
+  bool tinylfu_admission = false;
+  ceph::FrequencySketch sketch; // protected by d3n_eviction_lock
 
   struct sigaction action;
   uint64_t free_data_cache_size = 0;
@@ -83,6 +87,7 @@ private:
 
 private:
   void add_io();
+  bool admit(const std::string& digest_oid, uint64_t needed);
 
 public:
   D3nDataCache();
@@ -23,6 +23,7 @@
 #include "rgw_bucket_sync_cache.h"
 #include "rgw_datalog.h"
 #include "rgw_metadata.h"
+#include "rgw_sync_bulk_fetch.h"
 #include "rgw_sync_counters.h"
 #include "rgw_sync_error_repo.h"
 #include "rgw_sync_module.h"
@@ -58,6 +59,59 @@ static const string object_status_oid_prefix = "bucket.sync-status";
 
 static const string data_sync_bids_oid = "data-sync-bids";
 
+int64_t ThroughputConcurrencyControl::adj_concurrency(CephContext* cct,
+                                                      PerfCounters* counters,
+                                                      int64_t concurrency)
+{
+  const int64_t max_window =
+    cct->_conf.get_val<uint64_t>("rgw_bucket_sync_spawn_window_max");
+  if (!counters || max_window <= concurrency) {
+    return concurrency;
+  }
+
+  std::lock_guard l{lock};
+  const auto now = ceph::coarse_mono_clock::now();
+  if (window == 0) {
+    window = concurrency;
+    step = std::max<int64_t>(concurrency / 4, 1);
+    sampled_at = now;
+    sampled_bytes = counters->get(sync_counters::l_fetch);
+    return window;
+  }
+  if (now - sampled_at < sample_interval) {
+    return std::clamp(window, concurrency, max_window);
+  }
+
+  const uint64_t bytes = counters->get(sync_counters::l_fetch);
+  const double rate = (bytes - sampled_bytes) /
+    std::chrono::duration<double>(now - sampled_at).count();
+  sampled_at = now;
+  sampled_bytes = bytes;
+
+  // nothing to replicate is no signal either way
+  if (rate > 0) {
+    if (rate < last_rate * 1.05) {
+      // the last move didn't help, go back the other way
+      step = -step;
+    }
+    window = std::clamp(window + step, concurrency, max_window);
+    last_rate = rate;
+  }
+
+  counters->set(sync_counters::l_fetch_bandwidth, static_cast<uint64_t>(rate));
+  counters->set(sync_counters::l_fetch_window, window);
+  return window;
+}
+
+int64_t RGWDataSyncCtx::bucket_spawn_window()
+{
+  int64_t window = cct->_conf->rgw_bucket_sync_spawn_window;
+  if (tcc) {
+    window = tcc->adj_concurrency(cct, env->counters, window);
+  }
+  return lcc.adj_concurrency(window);
+}
+
 void rgw_datalog_info::decode_json(JSONObj *obj) {
   JSONDecoder::decode_json("num_objects", num_shards, obj);
 }
@@ -2626,6 +2680,9 @@ public:
   RGWCoroutine *remove_object(const DoutPrefixProvider *dpp, RGWDataSyncCtx *sc, rgw_bucket_sync_pipe& sync_pipe, rgw_obj_key& key, real_time& mtime, bool versioned, uint64_t versioned_epoch, rgw_zone_set *zones_trace) override;
   RGWCoroutine *create_delete_marker(const DoutPrefixProvider *dpp, RGWDataSyncCtx *sc, rgw_bucket_sync_pipe& sync_pipe, rgw_obj_key& key, real_time& mtime,
                                      rgw_bucket_entry_owner& owner, bool versioned, uint64_t versioned_epoch, rgw_zone_set *zones_trace) override;
+  bool fetches_objects() const override {
+    return true;
+  }
 };
 
 class RGWDefaultSyncModuleInstance : public RGWSyncModuleInstance {
@@ -3033,6 +3090,20 @@ public:
                                                             std::move(dest_params),
                                                             need_retry);
 
+          // bulk fetched data only stands in for the first attempt of a
+          // system sync. user mode syncs need the per-user GET
+          std::shared_ptr<const rgw_bulk_fetch_entry> prefetched;
+          if (param_mode != rgw_sync_pipe_params::MODE_USER && try_num == 0) {
+            auto p = sync_pipe.prefetched.find(key);
+            if (p != sync_pipe.prefetched.end()) {
+              prefetched = std::move(p->second);
+              sync_pipe.prefetched.erase(p);
+              if (sync_env->counters) {
+                sync_env->counters->inc(sync_counters::l_fetch_bulk);
+              }
+            }
+          }
+
           call(new RGWFetchRemoteObjCR(sync_env->async_rados, sync_env->driver, sc->source_zone,
                                        param_user,
                                        sync_pipe.source_bucket_info.bucket,
@@ -3042,7 +3113,8 @@ public:
                                        std::static_pointer_cast<RGWFetchObjFilter>(filter),
                                        stat_follow_olh,
                                        source_trace_entry, zones_trace,
-                                       sync_env->counters, dpp, replicate_tags));
+                                       sync_env->counters, dpp, replicate_tags,
+                                       std::move(prefetched)));
         }
         if (retcode < 0) {
           if (*need_retry) {
@@ -4102,6 +4174,26 @@ struct bilog_list_result {
   }
 };
 
+/// list a bucket index log page ahead of its use; the result and error
+/// are kept for the caller rather than failing the spawned stack
+class RGWPrefetchBucketIndexLogCR : public RGWCoroutine {
+  RGWDataSyncCtx *sc;
+  rgw_bucket_shard bs;
+  string marker;
+  uint64_t generation;
+
+public:
+  bilog_list_result result;
+  int ret{0};
+
+  RGWPrefetchBucketIndexLogCR(RGWDataSyncCtx *_sc, const rgw_bucket_shard& bs,
+                              const string& marker, uint64_t generation)
+    : RGWCoroutine(_sc->cct), sc(_sc), bs(bs), marker(marker),
+      generation(generation) {}
+
+  int operate(const DoutPrefixProvider *dpp) override;
+};
+
 class RGWListBucketIndexLogCR: public RGWCoroutine {
   RGWDataSyncCtx *sc;
   RGWDataSyncEnv *sync_env;
@@ -4150,6 +4242,99 @@ public:
   }
 };
 
+int RGWPrefetchBucketIndexLogCR::operate(const DoutPrefixProvider *dpp)
+{
+  reenter(this) {
+    yield call(new RGWListBucketIndexLogCR(sc, bs, marker, generation, &result));
+    ret = retcode;
+    return set_cr_done();
+  }
+  return 0;
+}
+
+static uint64_t bulk_fetch_max_obj_size(RGWDataSyncCtx *sc)
+{
+  if (!sc->env->sync_module->get_data_handler()->fetches_objects()) {
+    return 0;
+  }
+  return sc->cct->_conf.get_val<Option::size_t>("rgw_sync_bulk_fetch_max_obj_size");
+}
+
+/// ask the source zone for a set of small objects in batches, and keep
+/// the ones it returned in sync_pipe.prefetched. failures are not fatal,
+/// the objects that are missing are then fetched one by one
+class RGWBulkFetchObjsCR : public RGWCoroutine {
+  RGWDataSyncCtx *sc;
+  RGWDataSyncEnv *sync_env;
+  rgw_bucket_sync_pipe& sync_pipe;
+  std::vector<rgw_obj_key> keys;
+  RGWSyncTraceNodeRef tn;
+  const uint64_t max_entries;
+  size_t pos{0};
+
+  bufferlist in;
+  bufferlist out;
+
+public:
+  RGWBulkFetchObjsCR(RGWDataSyncCtx *_sc, rgw_bucket_sync_pipe& sync_pipe,
+                     std::vector<rgw_obj_key> keys, RGWSyncTraceNodeRef tn)
+    : RGWCoroutine(_sc->cct), sc(_sc), sync_env(_sc->env),
+      sync_pipe(sync_pipe), keys(std::move(keys)), tn(std::move(tn)),
+      max_entries(std::max<uint64_t>(1, cct->_conf.get_val<uint64_t>(
+          "rgw_sync_bulk_fetch_max_entries"))) {}
+
+  int operate(const DoutPrefixProvider *dpp) override {
+    reenter(this) {
+      while (pos < keys.size()) {
+        yield {
+          rgw_bulk_fetch_request req;
+          req.bucket = sync_pipe.info.source_bs.bucket;
+          auto end = std::min(keys.size(), pos + max_entries);
+          req.keys.assign(keys.begin() + pos, keys.begin() + end);
+          pos = end;
+          req.max_obj_size = cct->_conf.get_val<Option::size_t>(
+              "rgw_sync_bulk_fetch_max_obj_size");
+          req.dst_zone_trace = rgw_zone_set_entry(
+              sync_env->svc->zone->get_zone().id,
+              sync_pipe.dest_bucket_info.bucket.get_key());
+          in.clear();
+          encode(req, in);
+          out.clear();
+          rgw_http_param_pair pairs[] = { { "type", "bucket-index" },
+                                          { "fetch", nullptr },
+                                          { nullptr, nullptr } };
+          call(new RGWPostRawRESTResourceCR<bufferlist>(
+                  cct, sc->conn, sync_env->http_manager, "/admin/log",
+                  pairs, nullptr, in, &out));
+        }
+        if (retcode < 0) {
+          // source zones without the bulk api fail the same way
+          tn->log(5, SSTR("bulk fetch failed, fetching objects individually: retcode=" << retcode));
+          return set_cr_done();
+        }
+        try {
+          rgw_bulk_fetch_result result;
+          auto iter = out.cbegin();
+          decode(result, iter);
+          for (auto& e : result.entries) {
+            if (e.status < 0 && e.status != -ERR_NOT_MODIFIED) {
+              continue;
+            }
+            auto key = e.key;
+            sync_pipe.prefetched[key] =
+                std::make_shared<const rgw_bulk_fetch_entry>(std::move(e));
+          }
+        } catch (const buffer::error& err) {
+          tn->log(5, SSTR("failed to decode bulk fetch response: " << err.what()));
+          return set_cr_done();
+        }
+      }
+      return set_cr_done();
+    }
+    return 0;
+  }
+};
+
 #define BUCKET_SYNC_UPDATE_MARKER_WINDOW 10
 
 class RGWBucketFullSyncMarkerTrack : public RGWSyncShardMarkerTrack<rgw_obj_key, rgw_obj_key> {
@@ -4526,6 +4711,7 @@ class RGWBucketFullSyncCR : public RGWCoroutine {
   list<bucket_list_entry>::iterator entries_iter;
   rgw_obj_key list_marker;
   bucket_list_entry *entry{nullptr};
+  std::vector<rgw_obj_key> bulk_keys;
 
   int total_entries{0};
 
@@ -4603,6 +4789,19 @@ public:
     prefix_handler.set_rules(sync_pipe.get_rules());
   }
 
+  // the listed objects small enough to be fetched in bulk
+  void collect_bulk_fetch_keys() {
+    const uint64_t max_size = bulk_fetch_max_obj_size(sc);
+    bulk_keys.clear();
+    for (const auto& e : list_result.entries) {
+      if (!e.delete_marker && e.size <= max_size &&
+          e.key.instance != "null" &&
+          prefix_handler.check_key_handled(e.key)) {
+        bulk_keys.push_back(e.key);
+      }
+    }
+  }
+
   int operate(const DoutPrefixProvider *dpp) override;
 };
 
@@ -4642,6 +4841,13 @@ int RGWBucketFullSyncCR::operate(const DoutPrefixProvider *dpp)
       if (list_result.entries.size() > 0) {
         tn->set_flag(RGW_SNS_FLAG_ACTIVE); /* actually have entries to sync */
       }
+      sync_pipe.prefetched.clear();
+      if (bulk_fetch_max_obj_size(sc) > 0) {
+        collect_bulk_fetch_keys();
+        if (!bulk_keys.empty()) {
+          yield call(new RGWBulkFetchObjsCR(sc, sync_pipe, std::move(bulk_keys), tn));
+        }
+      }
       entries_iter = list_result.entries.begin();
       for (; entries_iter != list_result.entries.end(); ++entries_iter) {
         if (lease_cr && !lease_cr->is_locked()) {
@@ -4676,7 +4882,7 @@ int RGWBucketFullSyncCR::operate(const DoutPrefixProvider *dpp)
                                  entry->key, &marker_tracker, zones_trace, tn),
                       false);
         }
-        drain_with_cb(sc->lcc.adj_concurrency(cct->_conf->rgw_bucket_sync_spawn_window),
+        drain_with_cb(sc->bucket_spawn_window(),
                       [&](uint64_t stack_id, int ret) {
                 if (ret < 0) {
                   tn->log(10, "a sync operation returned error");
@@ -4843,6 +5049,10 @@ class RGWBucketShardIncrementalSyncCR : public RGWCoroutine {
   int sync_status{0};
   bool syncstopped{false};
 
+  // the next bilog page, listed while the current one is synced
+  boost::intrusive_ptr<RGWPrefetchBucketIndexLogCR> prefetch_cr;
+  std::vector<rgw_obj_key> bulk_keys;
+
   RGWSyncTraceNodeRef tn;
   RGWBucketIncSyncShardMarkerTrack marker_tracker;
 
@@ -4884,6 +5094,30 @@ public:
     return boost::starts_with(key.name, iter->first);
   }
 
+  // the objects of the current page whose sync copies the object data
+  void collect_bulk_fetch_keys() {
+    bulk_keys.clear();
+    for (auto i = list_result.begin(); i != entries_end; ++i) {
+      if (i->op != CLS_RGW_OP_ADD && i->op != CLS_RGW_OP_LINK_OLH) {
+        continue;
+      }
+      if (i->state != CLS_RGW_STATE_COMPLETE ||
+          i->zones_trace.exists(zone_id.id, target_location_key)) {
+        continue;
+      }
+      auto s = squash_map.find(make_pair(i->object, i->instance));
+      if (s == squash_map.end() || s->second != make_pair(i->timestamp, i->op)) {
+        continue;
+      }
+      rgw_obj_key k;
+      if (!k.set(rgw_obj_index_key{i->object, i->instance}) ||
+          !k.ns.empty() || k.instance == "null" || !check_key_handled(k)) {
+        continue;
+      }
+      bulk_keys.push_back(std::move(k));
+    }
+  }
+
   int operate(const DoutPrefixProvider *dpp) override;
 };
 
@@ -4902,9 +5136,30 @@ int RGWBucketShardIncrementalSyncCR::operate(const DoutPrefixProvider *dpp)
         }
         return set_cr_error(-ECANCELED);
       }
-      tn->log(20, SSTR("listing bilog for incremental sync; position=" << sync_info.inc_marker.position));
-      set_status() << "listing bilog; position=" << sync_info.inc_marker.position;
-      yield call(new RGWListBucketIndexLogCR(sc, bs, sync_info.inc_marker.position, generation, &extended_result));
+      if (prefetch_cr) {
+        set_status() << "waiting for prefetched bilog; position=" << sync_info.inc_marker.position;
+        while (!prefetch_cr->is_done()) {
+          yield wait_for_child();
+          bool again = true;
+          while (again) {
+            again = collect(&ret, nullptr);
+            if (ret < 0) {
+              tn->log(0, SSTR("ERROR: a child operation returned error (ret=" << ret << ")"));
+              sync_status = ret;
+            }
+          }
+        }
+        extended_result = std::move(prefetch_cr->result);
+        retcode = prefetch_cr->ret;
+        prefetch_cr.reset();
+        if (sync_status != 0) {
+          break;
+        }
+      } else {
+        tn->log(20, SSTR("listing bilog for incremental sync; position=" << sync_info.inc_marker.position));
+        set_status() << "listing bilog; position=" << sync_info.inc_marker.position;
+        yield call(new RGWListBucketIndexLogCR(sc, bs, sync_info.inc_marker.position, generation, &extended_result));
+      }
       if (retcode < 0 && retcode != -ENOENT) {
         /* wait for all operations to complete */
         drain_all();
@@ -4952,6 +5207,26 @@ int RGWBucketShardIncrementalSyncCR::operate(const DoutPrefixProvider *dpp)
         }
       }
 
+      if (truncated && !syncstopped && !list_result.empty() &&
+          cct->_conf.get_val<bool>("rgw_bucket_sync_bilog_prefetch")) {
+        /* the next listing starts at the last entry of this page */
+        {
+          const string& last_id = list_result.back().id;
+          ssize_t p = last_id.find('#');
+          prefetch_cr = new RGWPrefetchBucketIndexLogCR(
+            sc, bs, p < 0 ? last_id : last_id.substr(p + 1), generation);
+        }
+        spawn(prefetch_cr.get(), false);
+      }
+
+      sync_pipe.prefetched.clear();
+      if (bulk_fetch_max_obj_size(sc) > 0) {
+        collect_bulk_fetch_keys();
+        if (!bulk_keys.empty()) {
+          yield call(new RGWBulkFetchObjsCR(sc, sync_pipe, std::move(bulk_keys), tn));
+        }
+      }
+
       entries_iter = list_result.begin();
       for (; entries_iter != entries_end; ++entries_iter) {
         if (lease_cr && !lease_cr->is_locked()) {
@@ -5085,7 +5360,7 @@ int RGWBucketShardIncrementalSyncCR::operate(const DoutPrefixProvider *dpp)
                   false);
           }
         // }
-	  drain_with_cb(sc->lcc.adj_concurrency(cct->_conf->rgw_bucket_sync_spawn_window),
+	  drain_with_cb(sc->bucket_spawn_window(),
                       [&](uint64_t stack_id, int ret) {
                 if (ret < 0) {
                   tn->log(10, "a sync operation returned error");
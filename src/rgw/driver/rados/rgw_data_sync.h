@@ -353,6 +353,25 @@ public:
   }
 };
 
+/// \brief Adjust concurrency to replication throughput
+///
+/// Sample the object bytes fetched from a source zone and, once per
+/// interval, keep moving the bucket sync window in the direction that
+/// last raised throughput, turning around once it stops helping. The
+/// window never drops below the configured spawn window.
+class ThroughputConcurrencyControl {
+  static constexpr auto sample_interval = std::chrono::seconds(5);
+  ceph::mutex lock = ceph::make_mutex("ThroughputConcurrencyControl");
+  ceph::coarse_mono_time sampled_at;
+  uint64_t sampled_bytes = 0;
+  double last_rate = 0;
+  int64_t window = 0;
+  int64_t step = 0;
+public:
+  int64_t adj_concurrency(CephContext* cct, PerfCounters* counters,
+                          int64_t concurrency);
+};
+
 struct RGWDataSyncCtx {
   RGWDataSyncEnv *env{nullptr};
   CephContext *cct{nullptr};
@@ -361,13 +380,16 @@ struct RGWDataSyncCtx {
   rgw_zone_id source_zone;
 
   LatencyConcurrencyControl lcc{nullptr};
+  // shared by the copies made for a source zone, as is its link
+  std::shared_ptr<ThroughputConcurrencyControl> tcc;
 
   RGWDataSyncCtx() = default;
 
   RGWDataSyncCtx(RGWDataSyncEnv* env,
 		 RGWRESTConn* conn,
 		 const rgw_zone_id& source_zone)
-    : env(env), cct(env->cct), conn(conn), source_zone(source_zone), lcc(cct) {}
+    : env(env), cct(env->cct), conn(conn), source_zone(source_zone), lcc(cct),
+      tcc(std::make_shared<ThroughputConcurrencyControl>()) {}
 
   void init(RGWDataSyncEnv *_env,
             RGWRESTConn *_conn,
@@ -377,7 +399,12 @@ struct RGWDataSyncCtx {
     conn = _conn;
     source_zone = _source_zone;
     lcc.cct = cct;
+    tcc = std::make_shared<ThroughputConcurrencyControl>();
   }
+
+  /// spawn window for the items of a bucket shard, following both the
+  /// replication throughput and the local latency
+  int64_t bucket_spawn_window();
 };
 
 class RGWRados;
@@ -74,6 +74,7 @@ using namespace rgw::dedup;
 #include "rgw_dedup_store.h"
 #include "rgw_dedup_cluster.h"
 #include "rgw_dedup_epoch.h"
+#include "rgw_dedup_chunk.h"
 #include "rgw_perf_counters.h"
 #include "include/ceph_assert.h"
 
@@ -401,6 +402,9 @@ namespace rgw::dedup {
     d_heart_beat_max_elapsed_sec = 3;
   }
 
+  //---------------------------------------------------------------------------
+  Background::~Background() = default;
+
   //---------------------------------------------------------------------------
   int Background::add_disk_rec_from_bucket_idx(disk_block_array_t     &disk_arr,
                                                const rgw::sal::Bucket *p_bucket,
@@ -517,12 +521,18 @@ namespace rgw::dedup {
                                              RGWObjManifest &tgt_manifest)
   {
     unsigned idx = 0;
+    int ret_code = 0;
+    std::set<rgw_raw_obj> released;
     for (auto p = tgt_manifest.obj_begin(dpp); p != tgt_manifest.obj_end(dpp); ++p, ++idx) {
       rgw_raw_obj raw_obj = p.get_location().get_raw_obj(rados);
       if (oid == raw_obj.oid) {
         ldpp_dout(dpp, 20) << __func__ << "::[" << idx <<"] Skip HEAD OBJ: " << raw_obj.oid << dendl;
         continue;
       }
+      // chunk dedup manifests may point at the same tail object many times
+      if (!released.insert(raw_obj).second) {
+        continue;
+      }
 
       rgw_rados_ref obj;
       int ret = rgw_get_rados_ref(dpp, rados_handle, raw_obj, &obj);
@@ -532,12 +542,21 @@ namespace rgw::dedup {
         continue;
       }
       librados::IoCtx ioctx = obj.ioctx;
-      ldpp_dout(dpp, 20) << __func__ << "::removing tail object: " << raw_obj.oid
+      ldpp_dout(dpp, 20) << __func__ << "::releasing tail object: " << raw_obj.oid
                          << dendl;
-      ret = ioctx.remove(raw_obj.oid);
+      // tail objects may also be referenced by chunk deduped objects, drop
+      // our reference and let the object go with the last one
+      librados::ObjectWriteOperation op;
+      cls_refcount_put(op, ref_tag, true);
+      ret = ioctx.operate(raw_obj.oid, &op);
+      if (unlikely(ret < 0 && ret != -ENOENT)) {
+        ldpp_dout(dpp, 1) << __func__ << "::ERR: failed to release tail object "
+                          << raw_obj.oid << ", err is " << cpp_strerror(-ret) << dendl;
+        ret_code = ret;
+      }
     }
 
-    return 0;
+    return ret_code;
   }
 
   //---------------------------------------------------------------------------
@@ -792,7 +811,13 @@ namespace rgw::dedup {
       }
 
       // free tail objects based on TGT manifest
-      free_tail_objs_by_manifest(ref_tag, tgt_oid, tgt_manifest);
+      ret = free_tail_objs_by_manifest(ref_tag, tgt_oid, tgt_manifest);
+      if (unlikely(ret != 0)) {
+        // the head already points at SRC, so the tail objects that kept
+        // their reference are left for an orphan scan
+        ldpp_dout(dpp, 1) << __func__ << "::WARN: failed to release some tail "
+                          << "objects of " << tgt_oid << dendl;
+      }
 
       if (!has_shared_manifest_src) {
         // When SRC OBJ A has two or more dups (B, C) we set SHARED_MANIFEST
@@ -1001,6 +1026,40 @@ namespace rgw::dedup {
     return ret;
   }
 
+  //---------------------------------------------------------------------------
+  int Background::chunk_dedup_record(const disk_record_t *p_rec,
+                                     md5_stats_t         *p_stats)
+  {
+    rgw_bucket b{p_rec->tenant_name, p_rec->bucket_name, p_rec->bucket_id};
+    unique_ptr<rgw::sal::Bucket> bucket;
+    int ret = driver->load_bucket(dpp, b, &bucket, null_yield);
+    if (unlikely(ret != 0)) {
+      ldpp_dout(dpp, 15) << __func__ << "::Failed driver->load_bucket(): "
+                         << cpp_strerror(-ret) << dendl;
+      return 0;
+    }
+
+    unique_ptr<rgw::sal::Object> p_obj = bucket->get_object(p_rec->obj_name);
+    if (unlikely(!p_obj)) {
+      return 0;
+    }
+
+    ret = p_obj->get_obj_attrs(null_yield, dpp);
+    if (unlikely(ret < 0)) {
+      ldpp_dout(dpp, 10) << __func__ << "::ERR: failed to stat object(" << p_rec->obj_name
+                         << "), returned error: " << cpp_strerror(-ret) << dendl;
+      return 0;
+    }
+
+    ret = d_chunk_dedup->dedup_object(p_obj.get(), p_stats);
+    if (unlikely(ret < 0)) {
+      ldpp_dout(dpp, 10) << __func__ << "::ERR: failed chunk dedup of "
+                         << p_rec->obj_name << "::" << cpp_strerror(-ret) << dendl;
+    }
+    // a failure here doesn't affect the whole object dedup
+    return 0;
+  }
+
   //---------------------------------------------------------------------------
   // We purged all entries not marked for-dedup (i.e. singleton bit is set) from the table
   //   so all entries left are sources of dedup with multiple copies.
@@ -1049,6 +1108,11 @@ namespace rgw::dedup {
         p_stats->skipped_singleton_bytes += ondisk_byte_size;
         ldpp_dout(dpp, 20) << __func__ << "::skipped singleton::"
                            << p_rec->obj_name << std::dec << dendl;
+        // singletons may still share parts of their tail with other objects
+        if (d_chunk_dedup && p_rec->s.num_parts == 0 &&
+            p_rec->s.obj_bytes_size > d_head_object_size) {
+          return chunk_dedup_record(p_rec, p_stats);
+        }
       }
       return 0;
     }
@@ -2653,8 +2717,22 @@ namespace rgw::dedup {
           // Wait for all other workers to finish ingress step
           work_shards_barrier(num_work_shards);
           if (!d_ctl.should_stop()) {
+#ifdef FULL_DEDUP_SUPPORT
+            if (d_ctl.dedup_type == dedup_req_type_t::DEDUP_TYPE_FULL &&
+                cct->_conf.get_val<bool>("rgw_dedup_chunk_enabled")) {
+              d_chunk_dedup = std::make_unique<chunk_dedup_t>(dpp, cct, rados,
+                                                              rados_handle);
+              if (d_chunk_dedup->init() != 0) {
+                d_chunk_dedup.reset();
+              }
+            }
+#endif
             process_all_shards(false, &Background::f_dedup_md5_shard, raw_mem.get(),
                                RAW_MEM_SIZE, num_work_shards, num_md5_shards);
+            if (d_chunk_dedup) {
+              d_chunk_dedup->finish();
+              d_chunk_dedup.reset();
+            }
             // Wait for all other md5 shards to finish
             md5_shards_barrier(num_md5_shards);
             safe_pool_delete(store, dpp, pool_id);
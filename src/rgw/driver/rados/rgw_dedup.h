@@ -19,6 +19,7 @@
 #include "rgw_dedup_table.h"
 #include "rgw_dedup_cluster.h"
 #include "rgw_realm_reloader.h"
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <variant>
@@ -27,6 +28,7 @@
 
 namespace rgw::dedup {
   struct dedup_epoch_t;
+  class chunk_dedup_t;
   struct control_t {
     control_t() {
       reset();
@@ -78,6 +80,7 @@ namespace rgw::dedup {
 
   public:
     Background(rgw::sal::Driver* _driver, CephContext* _cct);
+    ~Background();
     int  watch_reload(const DoutPrefixProvider* dpp);
     int  unwatch_reload(const DoutPrefixProvider* dpp);
     void handle_notify(uint64_t notify_id, uint64_t cookie, bufferlist &bl);
@@ -214,6 +217,8 @@ namespace rgw::dedup {
                      const disk_record_t *p_tgt_rec,
                      md5_stats_t         *p_stats,
                      bool                 is_shared_manifest_src);
+    int chunk_dedup_record(const disk_record_t *p_rec,
+                           md5_stats_t         *p_stats);
 #endif
     int  remove_slabs(unsigned worker_id, unsigned md5_shard, uint32_t slab_count);
     int  init_rados_access_handles(bool init_pool);
@@ -239,6 +244,8 @@ namespace rgw::dedup {
     uint32_t d_min_obj_size_for_dedup = (4ULL * 1024 * 1024);
     uint32_t d_head_object_size       = (4ULL * 1024 * 1024);
     control_t d_ctl;
+    // set during a full dedup scan when rgw_dedup_chunk_enabled is on
+    std::unique_ptr<chunk_dedup_t> d_chunk_dedup;
     uint64_t d_watch_handle = 0;
     DedupWatcher d_watcher_ctx;
 
@@ -0,0 +1,647 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2;
+// vim: ts=8 sw=2 sts=2 expandtab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include "rgw_dedup_chunk.h"
+#include "rgw_rados.h"
+#include "rgw_tools.h"
+#include "rgw_obj_manifest.h"
+#include "svc_zone.h"
+#include "services/svc_tier_rados.h"
+#include "cls/refcount/cls_refcount_client.h"
+#include "common/errno.h"
+#include "common/ceph_crypto.h"
+#include "BLAKE3/c/blake3.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#define dout_subsys ceph_subsys_rgw_dedup
+
+namespace rgw::dedup {
+  static const char* FP_INDEX_NS = "dedup";
+  static const char* FP_INDEX_PREFIX = "dedup.fp_index.";
+  static constexpr double FP_BLOOM_FPP = 0.01;
+
+  //---------------------------------------------------------------------------
+  bool fp_index_t::shard_bloom_t::merge(const shard_bloom_t &other)
+  {
+    if (salt_count_ != other.salt_count_ || table_size_ != other.table_size_ ||
+        random_seed_ != other.random_seed_) {
+      return false;
+    }
+    for (size_t i = 0; i < bit_table_.size(); i++) {
+      bit_table_[i] |= other.bit_table_[i];
+    }
+    insert_count_ += other.insert_count_;
+    return true;
+  }
+
+  //---------------------------------------------------------------------------
+  fp_index_t::fp_index_t(const DoutPrefixProvider* _dpp,
+                         librados::IoCtx &_ioctx,
+                         unsigned _num_shards,
+                         uint64_t expected_entries) :
+    dpp(_dpp), ioctx(_ioctx), num_shards(std::max(_num_shards, 1u)),
+    entries_per_shard(std::max<uint64_t>(expected_entries / num_shards, 1024))
+  {
+    blooms.reserve(num_shards);
+    for (unsigned shard = 0; shard < num_shards; shard++) {
+      blooms.emplace_back(entries_per_shard, FP_BLOOM_FPP, 0);
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  std::string fp_index_t::shard_oid(unsigned shard) const
+  {
+    return FP_INDEX_PREFIX + std::to_string(shard);
+  }
+
+  //---------------------------------------------------------------------------
+  // keys are "<pool-id>_<hex fingerprint>", the fingerprint is uniformly
+  // distributed so use its first bytes for the shard and the bloom hash
+  static uint64_t key_hex_field(const std::string &key, unsigned pos)
+  {
+    auto p = key.find('_');
+    if (p == std::string::npos || key.length() < p + 1 + pos + 8) {
+      return 0;
+    }
+    return strtoull(key.substr(p + 1 + pos, 8).c_str(), nullptr, 16);
+  }
+
+  unsigned fp_index_t::key_to_shard(const std::string &key) const
+  {
+    return key_hex_field(key, 0) % num_shards;
+  }
+
+  uint32_t fp_index_t::key_to_hash(const std::string &key) const
+  {
+    return key_hex_field(key, 8);
+  }
+
+  //---------------------------------------------------------------------------
+  void fp_index_t::load()
+  {
+    for (unsigned shard = 0; shard < num_shards; shard++) {
+      bufferlist bl;
+      int ret = ioctx.read(shard_oid(shard), bl, 0, 0);
+      if (ret <= 0) {
+        continue;
+      }
+      shard_bloom_t saved;
+      try {
+        auto p = bl.cbegin();
+        saved.decode(p);
+      } catch (buffer::error& err) {
+        ldpp_dout(dpp, 1) << __func__ << "::ERR: bad bloom filter in "
+                          << shard_oid(shard) << dendl;
+        continue;
+      }
+      if (!blooms[shard].merge(saved)) {
+        // the index was sized differently, every key will be a lookup
+        ldpp_dout(dpp, 5) << __func__ << "::bloom filter size changed for "
+                          << shard_oid(shard) << dendl;
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  void fp_index_t::flush()
+  {
+    for (unsigned shard = 0; shard < num_shards; shard++) {
+      // other RGWs may have stored their own fingerprints since we loaded
+      bufferlist saved_bl;
+      if (ioctx.read(shard_oid(shard), saved_bl, 0, 0) > 0) {
+        shard_bloom_t saved;
+        try {
+          auto p = saved_bl.cbegin();
+          saved.decode(p);
+          blooms[shard].merge(saved);
+        } catch (buffer::error& err) {
+          // overwrite it
+        }
+      }
+      bufferlist bl;
+      blooms[shard].encode(bl);
+      int ret = ioctx.write_full(shard_oid(shard), bl);
+      if (ret < 0) {
+        ldpp_dout(dpp, 1) << __func__ << "::ERR: failed to write "
+                          << shard_oid(shard) << "::" << cpp_strerror(-ret) << dendl;
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  int fp_index_t::lookup(const std::vector<std::string> &keys,
+                         std::map<std::string, fp_index_entry_t> *p_found,
+                         uint64_t *p_bloom_skipped)
+  {
+    std::map<unsigned, std::set<std::string>> shard_keys;
+    for (const auto &key : keys) {
+      unsigned shard = key_to_shard(key);
+      if (blooms[shard].contains(key_to_hash(key))) {
+        shard_keys[shard].insert(key);
+      }
+      else {
+        (*p_bloom_skipped)++;
+      }
+    }
+
+    for (auto& [shard, shard_set] : shard_keys) {
+      std::map<std::string, bufferlist> vals;
+      librados::ObjectReadOperation op;
+      int rval = 0;
+      op.omap_get_vals_by_keys(shard_set, &vals, &rval);
+      int ret = ioctx.operate(shard_oid(shard), &op, nullptr);
+      if (ret == -ENOENT) {
+        continue;
+      }
+      if (ret < 0) {
+        ldpp_dout(dpp, 1) << __func__ << "::ERR: failed to read "
+                          << shard_oid(shard) << "::" << cpp_strerror(-ret) << dendl;
+        return ret;
+      }
+      for (auto& [key, bl] : vals) {
+        fp_index_entry_t entry;
+        try {
+          auto p = bl.cbegin();
+          decode(entry, p);
+        } catch (buffer::error& err) {
+          ldpp_dout(dpp, 1) << __func__ << "::ERR: bad index entry " << key << dendl;
+          continue;
+        }
+        (*p_found)[key] = std::move(entry);
+      }
+    }
+    return 0;
+  }
+
+  //---------------------------------------------------------------------------
+  int fp_index_t::insert(const std::map<std::string, fp_index_entry_t> &entries)
+  {
+    std::map<unsigned, std::map<std::string, bufferlist>> shard_vals;
+    for (const auto& [key, entry] : entries) {
+      unsigned shard = key_to_shard(key);
+      encode(entry, shard_vals[shard][key]);
+      blooms[shard].insert(key_to_hash(key));
+    }
+
+    int ret_code = 0;
+    for (auto& [shard, vals] : shard_vals) {
+      librados::ObjectWriteOperation op;
+      op.omap_set(vals);
+      int ret = ioctx.operate(shard_oid(shard), &op);
+      if (ret < 0) {
+        ldpp_dout(dpp, 1) << __func__ << "::ERR: failed to update "
+                          << shard_oid(shard) << "::" << cpp_strerror(-ret) << dendl;
+        ret_code = ret;
+      }
+    }
+    return ret_code;
+  }
+
+  //===========================================================================
+  // chunk_dedup_t
+  //===========================================================================
+  chunk_dedup_t::chunk_dedup_t(const DoutPrefixProvider* _dpp,
+                               CephContext *_cct,
+                               RGWRados *_rados,
+                               librados::Rados *_rados_handle) :
+    dpp(_dpp), cct(_cct), rados(_rados), rados_handle(_rados_handle)
+  {
+    const auto& conf = cct->_conf;
+    uint64_t target_size = conf.get_val<Option::size_t>("rgw_dedup_chunk_target_size");
+    int target_bits = 0;
+    while ((2ULL << target_bits) <= target_size) {
+      target_bits++;
+    }
+    cdc = CDC::create("fastcdc", target_bits);
+    max_bytes_per_sec = conf.get_val<Option::size_t>("rgw_dedup_chunk_max_bytes_per_sec");
+  }
+
+  //---------------------------------------------------------------------------
+  int chunk_dedup_t::init()
+  {
+    const rgw_pool& log_pool = rados->svc.zone->get_zone_params().log_pool;
+    rgw_pool pool(log_pool.name, FP_INDEX_NS);
+    int ret = rgw_init_ioctx(dpp, rados_handle, pool, index_ioctx, true, true);
+    if (ret < 0) {
+      ldpp_dout(dpp, 1) << __func__ << "::ERR: failed to open fingerprint index pool "
+                        << pool << "::" << cpp_strerror(-ret) << dendl;
+      return ret;
+    }
+
+    const auto& conf = cct->_conf;
+    index = std::make_unique<fp_index_t>(
+      dpp, index_ioctx,
+      conf.get_val<uint64_t>("rgw_dedup_chunk_index_shards"),
+      conf.get_val<uint64_t>("rgw_dedup_chunk_index_expected_entries"));
+    index->load();
+    throttled_bytes = 0;
+    throttle_start = ceph_clock_now();
+    return 0;
+  }
+
+  //---------------------------------------------------------------------------
+  void chunk_dedup_t::finish()
+  {
+    if (index) {
+      index->flush();
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  void chunk_dedup_t::throttle(uint64_t bytes)
+  {
+    if (max_bytes_per_sec == 0) {
+      return;
+    }
+    throttled_bytes += bytes;
+    double elapsed = (double)(ceph_clock_now() - throttle_start);
+    double expected = (double)throttled_bytes / max_bytes_per_sec;
+    if (expected > elapsed) {
+      std::this_thread::sleep_for(std::chrono::duration<double>(expected - elapsed));
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  static std::string fingerprint_hex(const bufferlist &bl)
+  {
+    blake3_hasher hmac;
+    blake3_hasher_init(&hmac);
+    for (const auto& bptr : bl.buffers()) {
+      blake3_hasher_update(&hmac, (const unsigned char *)bptr.c_str(), bptr.length());
+    }
+    uint8_t hash[BLAKE3_OUT_LEN];
+    blake3_hasher_finalize(&hmac, hash, BLAKE3_OUT_LEN);
+
+    static const char hex[] = "0123456789abcdef";
+    std::string out(BLAKE3_OUT_LEN * 2, '0');
+    for (unsigned i = 0; i < BLAKE3_OUT_LEN; i++) {
+      out[2*i]   = hex[hash[i] >> 4];
+      out[2*i+1] = hex[hash[i] & 0xF];
+    }
+    return out;
+  }
+
+  //---------------------------------------------------------------------------
+  int chunk_dedup_t::calc_stripe_chunks(stripe_t *p_stripe, md5_stats_t *p_stats)
+  {
+    rgw_rados_ref obj;
+    int ret = rgw_get_rados_ref(dpp, rados_handle, p_stripe->raw_obj, &obj);
+    if (ret < 0) {
+      ldpp_dout(dpp, 1) << __func__ << "::ERR: failed rgw_get_rados_ref() for oid: "
+                        << p_stripe->raw_obj.oid << ", err is " << cpp_strerror(-ret) << dendl;
+      return ret;
+    }
+
+    bufferlist bl;
+    ret = obj.ioctx.read(p_stripe->raw_obj.oid, bl, 0, 0);
+    if (ret < 0) {
+      ldpp_dout(dpp, 1) << __func__ << "::ERR: failed to read " << p_stripe->raw_obj.oid
+                        << ", error is " << cpp_strerror(-ret) << dendl;
+      return ret;
+    }
+    if (bl.length() != p_stripe->size) {
+      ldpp_dout(dpp, 5) << __func__ << "::unexpected size for " << p_stripe->raw_obj.oid
+                        << "::" << bl.length() << " != " << p_stripe->size << dendl;
+      return -EINVAL;
+    }
+    throttle(bl.length());
+    p_stats->chunk_scanned_bytes += bl.length();
+
+    const std::string key_prefix = std::to_string(obj.ioctx.get_id()) + "_";
+    std::vector<std::pair<uint64_t, uint64_t>> chunks;
+    cdc->calc_chunks(bl, &chunks);
+    for (auto& [ofs, len] : chunks) {
+      bufferlist chunk_bl;
+      chunk_bl.substr_of(bl, ofs, len);
+      p_stripe->chunks.push_back({p_stripe->ofs + ofs, len,
+                                  key_prefix + fingerprint_hex(chunk_bl)});
+    }
+    p_stats->chunk_count += chunks.size();
+    return 0;
+  }
+
+  //---------------------------------------------------------------------------
+  void chunk_dedup_t::put_refs(const std::string &ref_tag,
+                               const std::set<rgw_raw_obj> &objs)
+  {
+    for (const auto &raw_obj : objs) {
+      rgw_rados_ref obj;
+      int ret = rgw_get_rados_ref(dpp, rados_handle, raw_obj, &obj);
+      if (ret < 0) {
+        continue;
+      }
+      librados::ObjectWriteOperation op;
+      cls_refcount_put(op, ref_tag, true);
+      ret = obj.ioctx.operate(raw_obj.oid, &op);
+      if (ret < 0 && ret != -ENOENT) {
+        ldpp_dout(dpp, 1) << __func__ << "::ERR: failed to drop reference on "
+                          << raw_obj.oid << "::" << cpp_strerror(-ret) << dendl;
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // take a reference on every tail object the shared stripes will point at.
+  // a stripe whose source was removed since it was indexed stays unshared
+  // returns the objects referenced
+  std::set<rgw_raw_obj> chunk_dedup_t::get_refs(const std::string &ref_tag,
+                                                std::vector<stripe_t> &stripes,
+                                                std::map<std::string, fp_index_entry_t> &found)
+  {
+    std::map<rgw_raw_obj, bool> sources; // raw obj -> was referenced
+    auto source_of = [&](const chunk_ref_t &c) {
+      return rgw_obj_select(found[c.key].loc).get_raw_obj(rados);
+    };
+    for (auto &stripe : stripes) {
+      if (stripe.shared) {
+        for (const auto &c : stripe.chunks) {
+          sources.emplace(source_of(c), false);
+        }
+      }
+    }
+
+    for (auto& [raw_obj, referenced] : sources) {
+      rgw_rados_ref obj;
+      int ret = rgw_get_rados_ref(dpp, rados_handle, raw_obj, &obj);
+      if (ret < 0) {
+        continue;
+      }
+      librados::ObjectWriteOperation op;
+      op.assert_exists();
+      cls_refcount_get(op, ref_tag, true);
+      ret = obj.ioctx.operate(raw_obj.oid, &op);
+      if (ret == 0) {
+        referenced = true;
+      }
+      else {
+        ldpp_dout(dpp, 10) << __func__ << "::failed to reference " << raw_obj.oid
+                           << "::" << cpp_strerror(-ret) << dendl;
+      }
+    }
+
+    std::set<rgw_raw_obj> used;
+    for (auto &stripe : stripes) {
+      if (!stripe.shared) {
+        continue;
+      }
+      for (const auto &c : stripe.chunks) {
+        if (!sources[source_of(c)]) {
+          stripe.shared = false;
+          break;
+        }
+      }
+      if (stripe.shared) {
+        for (const auto &c : stripe.chunks) {
+          used.insert(source_of(c));
+        }
+      }
+    }
+
+    // drop the references no remaining shared stripe needs
+    std::set<rgw_raw_obj> unused;
+    for (auto& [raw_obj, referenced] : sources) {
+      if (referenced && used.count(raw_obj) == 0) {
+        unused.insert(raw_obj);
+      }
+    }
+    put_refs(ref_tag, unused);
+    return used;
+  }
+
+  //---------------------------------------------------------------------------
+  int chunk_dedup_t::dedup_object(rgw::sal::Object *p_obj, md5_stats_t *p_stats)
+  {
+    utime_t start_time = ceph_clock_now();
+    const rgw::sal::Attrs& attrs = p_obj->get_attrs();
+    // encrypted/compressed data can't be shared by offset, and objects
+    // already sharing a manifest are handled by whole-object dedup
+    if (attrs.count(RGW_ATTR_CRYPT_MODE) || attrs.count(RGW_ATTR_COMPRESSION) ||
+        attrs.count(RGW_ATTR_SHARE_MANIFEST)) {
+      return 0;
+    }
+
+    auto itr = attrs.find(RGW_ATTR_MANIFEST);
+    if (itr == attrs.end()) {
+      return 0;
+    }
+    const bufferlist &manifest_bl = itr->second;
+    RGWObjManifest manifest;
+    try {
+      auto bl_iter = manifest_bl.cbegin();
+      decode(manifest, bl_iter);
+    } catch (buffer::error& err) {
+      ldpp_dout(dpp, 1) << __func__ << "::ERROR: bad manifest for "
+                        << p_obj->get_name() << dendl;
+      return -EINVAL;
+    }
+    if (manifest.has_explicit_objs() || manifest.is_tier_type_s3()) {
+      return 0;
+    }
+
+    // the object was scanned already and didn't change since
+    bufferlist manifest_hash_bl, hash_bl;
+    crypto::digest<crypto::SHA1>(manifest_bl).encode(hash_bl);
+    hash_bl.splice(0, 8, &manifest_hash_bl);
+    itr = attrs.find(RGW_ATTR_DEDUP_CHUNKED);
+    if (itr != attrs.end() && itr->second.contents_equal(manifest_hash_bl)) {
+      return 0;
+    }
+
+    // the tail objects are released with the same tag GC would use
+    std::string ref_tag;
+    itr = attrs.find(RGW_ATTR_TAIL_TAG);
+    if (itr == attrs.end()) {
+      itr = attrs.find(RGW_ATTR_ID_TAG);
+    }
+    if (itr == attrs.end()) {
+      ldpp_dout(dpp, 5) << __func__ << "::No TAIL_TAG and no ID_TAG" << dendl;
+      return -EINVAL;
+    }
+    ref_tag = itr->second.to_str();
+
+    auto etag_itr = attrs.find(RGW_ATTR_ETAG);
+    if (etag_itr == attrs.end()) {
+      return -EINVAL;
+    }
+
+    rgw_obj_select head_select(manifest.get_obj());
+    head_select.set_placement_rule(manifest.get_head_placement_rule());
+    const rgw_raw_obj head_raw = head_select.get_raw_obj(rados);
+
+    rgw_bucket tail_bucket = manifest.get_tail_placement().bucket;
+    if (tail_bucket.name.empty()) {
+      tail_bucket = manifest.get_obj().bucket;
+    }
+
+    std::vector<stripe_t> stripes;
+    for (auto p = manifest.obj_begin(dpp); p != manifest.obj_end(dpp); ++p) {
+      if (p.get_stripe_ofs() < manifest.get_head_size()) {
+        continue;
+      }
+      stripe_t stripe;
+      stripe.raw_obj = p.get_location().get_raw_obj(rados);
+      stripe.ofs = p.get_stripe_ofs();
+      stripe.size = p.get_stripe_size();
+      if (!RGWSI_Tier_RADOS::raw_obj_to_obj(tail_bucket, stripe.raw_obj, &stripe.loc)) {
+        ldpp_dout(dpp, 5) << __func__ << "::ERR: unexpected tail oid "
+                          << stripe.raw_obj.oid << dendl;
+        return -EINVAL;
+      }
+      // explicit parts carry no placement rule, pin the pool instead
+      stripe.loc.bucket.explicit_placement.data_pool = stripe.raw_obj.pool;
+      stripes.push_back(std::move(stripe));
+    }
+    if (stripes.empty()) {
+      return 0;
+    }
+
+    p_stats->chunk_scanned_objs++;
+    std::vector<std::string> keys;
+    for (auto &stripe : stripes) {
+      int ret = calc_stripe_chunks(&stripe, p_stats);
+      if (ret < 0) {
+        p_stats->chunk_failed++;
+        p_stats->chunk_duration += ceph_clock_now() - start_time;
+        return ret;
+      }
+      for (const auto &c : stripe.chunks) {
+        keys.push_back(c.key);
+      }
+    }
+
+    std::map<std::string, fp_index_entry_t> found;
+    int ret = index->lookup(keys, &found, &p_stats->chunk_bloom_skipped);
+    if (ret < 0) {
+      p_stats->chunk_failed++;
+      p_stats->chunk_duration += ceph_clock_now() - start_time;
+      return ret;
+    }
+
+    // a stripe can go only if every one of its chunks lives in another
+    // object (entries pointing back at this object are stale)
+    std::set<rgw_raw_obj> own_objs;
+    for (const auto &stripe : stripes) {
+      own_objs.insert(stripe.raw_obj);
+    }
+    own_objs.insert(head_raw);
+    for (auto &stripe : stripes) {
+      stripe.shared = !stripe.chunks.empty();
+      for (const auto &c : stripe.chunks) {
+        auto f = found.find(c.key);
+        bool valid = (f != found.end() && f->second.size == c.size &&
+                      own_objs.count(rgw_obj_select(f->second.loc).get_raw_obj(rados)) == 0);
+        if (valid) {
+          p_stats->chunk_dup_count++;
+          p_stats->chunk_dup_bytes += c.size;
+        }
+        else {
+          found.erase(c.key);
+          stripe.shared = false;
+        }
+      }
+    }
+
+    std::set<rgw_raw_obj> referenced;
+    bool any_shared = std::any_of(stripes.begin(), stripes.end(),
+                                  [](const stripe_t &s) { return s.shared; });
+    if (any_shared) {
+      referenced = get_refs(ref_tag, stripes, found);
+    }
+    any_shared = std::any_of(stripes.begin(), stripes.end(),
+                             [](const stripe_t &s) { return s.shared; });
+
+    librados::ObjectWriteOperation op;
+    op.cmpxattr(RGW_ATTR_ETAG, CEPH_OSD_CMPXATTR_OP_EQ, etag_itr->second);
+    op.cmpxattr(RGW_ATTR_MANIFEST, CEPH_OSD_CMPXATTR_OP_EQ, manifest_bl);
+    bufferlist new_manifest_bl;
+    if (any_shared) {
+      std::map<uint64_t, RGWObjManifestPart> objs;
+      if (manifest.get_head_size() > 0) {
+        RGWObjManifestPart& part = objs[0];
+        part.loc = manifest.get_obj();
+        part.loc.bucket.explicit_placement.data_pool = head_raw.pool;
+        part.size = manifest.get_head_size();
+      }
+      for (const auto &stripe : stripes) {
+        if (stripe.shared) {
+          for (const auto &c : stripe.chunks) {
+            const fp_index_entry_t &entry = found[c.key];
+            RGWObjManifestPart& part = objs[c.ofs];
+            part.loc = entry.loc;
+            part.loc_ofs = entry.loc_ofs;
+            part.size = c.size;
+          }
+        }
+        else {
+          RGWObjManifestPart& part = objs[stripe.ofs];
+          part.loc = stripe.loc;
+          part.size = stripe.size;
+        }
+      }
+      RGWObjManifest new_manifest = manifest;
+      new_manifest.set_explicit(manifest.get_obj_size(), objs);
+      encode(new_manifest, new_manifest_bl);
+      op.setxattr(RGW_ATTR_MANIFEST, new_manifest_bl);
+
+      manifest_hash_bl.clear();
+      hash_bl.clear();
+      crypto::digest<crypto::SHA1>(new_manifest_bl).encode(hash_bl);
+      hash_bl.splice(0, 8, &manifest_hash_bl);
+    }
+    op.setxattr(RGW_ATTR_DEDUP_CHUNKED, manifest_hash_bl);
+
+    rgw_rados_ref head_obj;
+    ret = rgw_get_rados_ref(dpp, rados_handle, head_raw, &head_obj);
+    if (ret == 0) {
+      ret = head_obj.ioctx.operate(head_raw.oid, &op);
+    }
+    if (ret < 0) {
+      // most likely the object was overwritten while we were reading it
+      ldpp_dout(dpp, 10) << __func__ << "::failed to update " << head_raw.oid
+                         << "::" << cpp_strerror(-ret) << dendl;
+      put_refs(ref_tag, referenced);
+      p_stats->chunk_failed++;
+      p_stats->chunk_duration += ceph_clock_now() - start_time;
+      return 0;
+    }
+
+    std::set<rgw_raw_obj> released;
+    std::map<std::string, fp_index_entry_t> new_entries;
+    for (const auto &stripe : stripes) {
+      if (stripe.shared) {
+        released.insert(stripe.raw_obj);
+        p_stats->chunk_shared_stripes++;
+        p_stats->chunk_freed_bytes += stripe.size;
+        continue;
+      }
+      // the data stays here, let the next objects share it
+      for (const auto &c : stripe.chunks) {
+        if (found.count(c.key) == 0 && new_entries.count(c.key) == 0) {
+          fp_index_entry_t &entry = new_entries[c.key];
+          entry.loc = stripe.loc;
+          entry.loc_ofs = c.ofs - stripe.ofs;
+          entry.size = c.size;
+        }
+      }
+    }
+    if (any_shared) {
+      p_stats->chunk_deduped_objs++;
+      put_refs(ref_tag, released);
+    }
+    index->insert(new_entries);
+    p_stats->chunk_duration += ceph_clock_now() - start_time;
+    return 0;
+  }
+
+} //namespace rgw::dedup
@@ -0,0 +1,150 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2;
+// vim: ts=8 sw=2 sts=2 expandtab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "include/rados/librados.hpp"
+#include "common/dout.h"
+#include "common/CDC.h"
+#include "common/bloom_filter.hpp"
+#include "include/utime.h"
+#include "rgw_common.h"
+#include "rgw_sal.h"
+#include "rgw_dedup_utils.h"
+
+class RGWRados;
+class RGWObjManifest;
+
+namespace rgw::dedup {
+
+  // Chunk level dedup of objects that have no whole-object duplicate.
+  //
+  // The tail objects of a singleton are cut with FastCDC into content defined
+  // chunks, one tail object at a time, and every chunk is looked up by its
+  // BLAKE3 fingerprint in a sharded omap index kept in the zone log pool.
+  // The index maps a fingerprint to the tail object (and offset) holding the
+  // first copy of that data; an in-memory bloom filter per index shard skips
+  // the omap read for fingerprints never seen before.
+  //
+  // A tail object is released only when all of its chunks are found in other
+  // tail objects, since a partially duplicated tail object doesn't free any
+  // space. The object manifest is then rewritten as an explicit manifest
+  // pointing at the shared ranges, and a cls_refcount reference with the
+  // object's tail tag is taken on every tail object it now uses, so GC and
+  // copies follow the same rules as for whole-object dedup.
+  struct fp_index_entry_t {
+    rgw_obj  loc;     // tail object holding the chunk
+    uint64_t loc_ofs = 0;
+    uint64_t size = 0;
+
+    void encode(ceph::bufferlist& bl) const {
+      ENCODE_START(1, 1, bl);
+      encode(loc, bl);
+      encode(loc_ofs, bl);
+      encode(size, bl);
+      ENCODE_FINISH(bl);
+    }
+    void decode(ceph::bufferlist::const_iterator& bl) {
+      DECODE_START(1, bl);
+      decode(loc, bl);
+      decode(loc_ofs, bl);
+      decode(size, bl);
+      DECODE_FINISH(bl);
+    }
+  };
+  WRITE_CLASS_ENCODER(fp_index_entry_t)
+
+  class fp_index_t {
+  public:
+    fp_index_t(const DoutPrefixProvider* _dpp,
+               librados::IoCtx &_ioctx,
+               unsigned _num_shards,
+               uint64_t expected_entries);
+    // load the bloom filters saved by the previous scans
+    void load();
+    // merge the bloom filters with the saved ones and write them back
+    void flush();
+    // @keys are fingerprints prefixed with the data pool id
+    int  lookup(const std::vector<std::string> &keys,
+                std::map<std::string, fp_index_entry_t> *p_found,
+                uint64_t *p_bloom_skipped);
+    int  insert(const std::map<std::string, fp_index_entry_t> &entries);
+
+  private:
+    class shard_bloom_t : public bloom_filter {
+    public:
+      using bloom_filter::bloom_filter;
+      bool merge(const shard_bloom_t &other);
+    };
+    unsigned key_to_shard(const std::string &key) const;
+    uint32_t key_to_hash(const std::string &key) const;
+    std::string shard_oid(unsigned shard) const;
+
+    const DoutPrefixProvider* const dpp;
+    librados::IoCtx &ioctx;
+    const unsigned num_shards;
+    const uint64_t entries_per_shard;
+    std::vector<shard_bloom_t> blooms;
+  };
+
+  class chunk_dedup_t {
+  public:
+    chunk_dedup_t(const DoutPrefixProvider* _dpp,
+                  CephContext *_cct,
+                  RGWRados *_rados,
+                  librados::Rados *_rados_handle);
+    // open the fingerprint index and load its bloom filters
+    int  init();
+    void finish();
+    // try to share the tail of @p_obj with already indexed data
+    int  dedup_object(rgw::sal::Object *p_obj, md5_stats_t *p_stats);
+
+  private:
+    struct chunk_ref_t {
+      uint64_t ofs;        // offset of the chunk in the rgw object
+      uint64_t size;
+      std::string key;     // fingerprint index key
+    };
+    struct stripe_t {
+      rgw_raw_obj raw_obj;
+      rgw_obj     loc;
+      uint64_t    ofs;     // offset of the stripe in the rgw object
+      uint64_t    size;
+      std::vector<chunk_ref_t> chunks;
+      bool        shared = false;
+    };
+
+    int  calc_stripe_chunks(stripe_t *p_stripe, md5_stats_t *p_stats);
+    std::set<rgw_raw_obj> get_refs(const std::string &ref_tag,
+                                   std::vector<stripe_t> &stripes,
+                                   std::map<std::string, fp_index_entry_t> &found);
+    void put_refs(const std::string &ref_tag, const std::set<rgw_raw_obj> &objs);
+    void throttle(uint64_t bytes);
+
+    const DoutPrefixProvider* const dpp;
+    CephContext* const cct;
+    RGWRados* const rados;
+    librados::Rados* const rados_handle;
+    librados::IoCtx index_ioctx;
+    std::unique_ptr<fp_index_t> index;
+    std::unique_ptr<CDC> cdc;
+    uint64_t max_bytes_per_sec = 0;
+    uint64_t throttled_bytes = 0;
+    utime_t  throttle_start;
+  };
+
+} //namespace rgw::dedup
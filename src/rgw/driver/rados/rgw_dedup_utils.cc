@@ -453,6 +453,18 @@ namespace rgw::dedup {
     this->failed_dedup            += other.failed_dedup;
     this->failed_table_load       += other.failed_table_load;
     this->failed_map_overflow     += other.failed_map_overflow;
+
+    this->chunk_scanned_objs      += other.chunk_scanned_objs;
+    this->chunk_scanned_bytes     += other.chunk_scanned_bytes;
+    this->chunk_count             += other.chunk_count;
+    this->chunk_dup_count         += other.chunk_dup_count;
+    this->chunk_dup_bytes         += other.chunk_dup_bytes;
+    this->chunk_bloom_skipped     += other.chunk_bloom_skipped;
+    this->chunk_deduped_objs      += other.chunk_deduped_objs;
+    this->chunk_shared_stripes    += other.chunk_shared_stripes;
+    this->chunk_freed_bytes       += other.chunk_freed_bytes;
+    this->chunk_failed            += other.chunk_failed;
+    this->chunk_duration          += other.chunk_duration;
     return *this;
   }
 
@@ -592,12 +604,36 @@ namespace rgw::dedup {
         f->dump_unsigned("Size mismatch SRC/TGT", this->size_mismatch);
       }
     }
+
+    if (this->chunk_scanned_objs) {
+      Formatter::ObjectSection chunk(*f, "chunk dedup");
+      f->dump_unsigned("Scanned Obj", this->chunk_scanned_objs);
+      f->dump_unsigned("Scanned Bytes", this->chunk_scanned_bytes);
+      f->dump_unsigned("Chunks", this->chunk_count);
+      f->dump_unsigned("Duplicate Chunks", this->chunk_dup_count);
+      f->dump_unsigned("Duplicate Chunk Bytes", this->chunk_dup_bytes);
+      f->dump_unsigned("Bloom Filter Skipped", this->chunk_bloom_skipped);
+      f->dump_unsigned("Deduped Obj", this->chunk_deduped_objs);
+      f->dump_unsigned("Released Tail Objs", this->chunk_shared_stripes);
+      f->dump_unsigned("Released Bytes", this->chunk_freed_bytes);
+      if (this->chunk_failed) {
+        f->dump_unsigned("Failed", this->chunk_failed);
+      }
+      uint64_t kept_bytes = this->chunk_scanned_bytes - this->chunk_freed_bytes;
+      if (kept_bytes) {
+        f->dump_float("Dedup Ratio", (double)this->chunk_scanned_bytes / kept_bytes);
+      }
+      double sec = (double)this->chunk_duration;
+      if (sec > 0) {
+        f->dump_float("Throughput MB/s", this->chunk_scanned_bytes / sec / (1024*1024));
+      }
+    }
   }
 
   //---------------------------------------------------------------------------
   void encode(const md5_stats_t& m, ceph::bufferlist& bl)
   {
-    ENCODE_START(1, 1, bl);
+    ENCODE_START(2, 1, bl);
 
     encode(m.small_objs_stat, bl);
     encode(m.big_objs_stat, bl);
@@ -642,13 +678,25 @@ namespace rgw::dedup {
     encode(m.failed_map_overflow, bl);
 
     encode(m.duration, bl);
+
+    encode(m.chunk_scanned_objs, bl);
+    encode(m.chunk_scanned_bytes, bl);
+    encode(m.chunk_count, bl);
+    encode(m.chunk_dup_count, bl);
+    encode(m.chunk_dup_bytes, bl);
+    encode(m.chunk_bloom_skipped, bl);
+    encode(m.chunk_deduped_objs, bl);
+    encode(m.chunk_shared_stripes, bl);
+    encode(m.chunk_freed_bytes, bl);
+    encode(m.chunk_failed, bl);
+    encode(m.chunk_duration, bl);
     ENCODE_FINISH(bl);
   }
 
   //---------------------------------------------------------------------------
   void decode(md5_stats_t& m, ceph::bufferlist::const_iterator& bl)
   {
-    DECODE_START(1, bl);
+    DECODE_START(2, bl);
     decode(m.small_objs_stat, bl);
     decode(m.big_objs_stat, bl);
     decode(m.ingress_failed_load_bucket, bl);
@@ -692,6 +740,20 @@ namespace rgw::dedup {
     decode(m.failed_map_overflow, bl);
 
     decode(m.duration, bl);
+
+    if (struct_v >= 2) {
+      decode(m.chunk_scanned_objs, bl);
+      decode(m.chunk_scanned_bytes, bl);
+      decode(m.chunk_count, bl);
+      decode(m.chunk_dup_count, bl);
+      decode(m.chunk_dup_bytes, bl);
+      decode(m.chunk_bloom_skipped, bl);
+      decode(m.chunk_deduped_objs, bl);
+      decode(m.chunk_shared_stripes, bl);
+      decode(m.chunk_freed_bytes, bl);
+      decode(m.chunk_failed, bl);
+      decode(m.chunk_duration, bl);
+    }
     DECODE_FINISH(bl);
   }
 } //namespace rgw::dedup
@@ -181,6 +181,19 @@ namespace rgw::dedup {
     uint64_t failed_table_load = 0;
     uint64_t failed_map_overflow = 0;
     utime_t  duration = {0, 0};
+
+    // chunk level dedup of singletons (rgw_dedup_chunk_enabled)
+    uint64_t chunk_scanned_objs = 0;
+    uint64_t chunk_scanned_bytes = 0;
+    uint64_t chunk_count = 0;
+    uint64_t chunk_dup_count = 0;
+    uint64_t chunk_dup_bytes = 0;
+    uint64_t chunk_bloom_skipped = 0;
+    uint64_t chunk_deduped_objs = 0;
+    uint64_t chunk_shared_stripes = 0;
+    uint64_t chunk_freed_bytes = 0;
+    uint64_t chunk_failed = 0;
+    utime_t  chunk_duration = {0, 0};
   };
   std::ostream &operator<<(std::ostream &out, const md5_stats_t &s);
   void encode(const md5_stats_t& m, ceph::bufferlist& bl);
@@ -367,6 +367,7 @@ class RGWGCIOManager {
     string oid;
     int index{-1};
     string tag;
+    ceph::mono_time start;
   };
 
   deque<IO> ios;
@@ -379,11 +380,53 @@ class RGWGCIOManager {
 #define MAX_AIO_DEFAULT 10
   size_t max_aio{MAX_AIO_DEFAULT};
 
+  /* the tail deletion window adapts between min_aio and max_aio_limit:
+   * it grows by one per window of deletions that complete within
+   * latency_target, and halves, at most once per such latency, when
+   * one doesn't, which is how the osds tell us they're overloaded
+   */
+  size_t min_aio{MAX_AIO_DEFAULT};
+  size_t max_aio_limit{MAX_AIO_DEFAULT};
+  ceph::timespan latency_target{0};
+  size_t completions_in_window{0};
+  ceph::mono_time last_decrease;
+
+  void update_window(ceph::timespan latency) {
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_gc_tail_delete);
+      perfcounter->tinc(l_rgw_gc_tail_delete_lat, latency);
+    }
+    if (latency_target == ceph::timespan::zero()) {
+      return;
+    }
+    const auto now = ceph::mono_clock::now();
+    if (latency > latency_target) {
+      if (now - last_decrease > latency && max_aio > min_aio) {
+        max_aio = std::max(max_aio / 2, min_aio);
+        last_decrease = now;
+        completions_in_window = 0;
+        ldpp_dout(dpp, 10) << "gc tail deletion took " << latency
+            << ", shrinking io window to " << max_aio << dendl;
+      }
+    } else if (++completions_in_window >= max_aio && max_aio < max_aio_limit) {
+      ++max_aio;
+      completions_in_window = 0;
+    }
+    if (perfcounter) {
+      perfcounter->set(l_rgw_gc_io_window, max_aio);
+    }
+  }
+
 public:
   RGWGCIOManager(const DoutPrefixProvider* _dpp, CephContext *_cct, RGWGC *_gc) : dpp(_dpp),
                                                                                   cct(_cct),
                                                                                   gc(_gc) {
     max_aio = cct->_conf->rgw_gc_max_concurrent_io;
+    min_aio = max_aio;
+    max_aio_limit = std::max<size_t>(
+        cct->_conf.get_val<uint64_t>("rgw_gc_max_concurrent_io_limit"), min_aio);
+    latency_target = cct->_conf.get_val<std::chrono::milliseconds>(
+        "rgw_gc_io_latency_target");
     remove_tags.resize(min(static_cast<int>(cct->_conf->rgw_gc_max_objs), rgw_shards_max()));
     tag_io_size.resize(min(static_cast<int>(cct->_conf->rgw_gc_max_objs), rgw_shards_max()));
   }
@@ -412,7 +455,7 @@ public:
     if (ret < 0) {
       return ret;
     }
-    ios.push_back(IO{IO::TailIO, c.get(), oid, index, tag});
+    ios.push_back(IO{IO::TailIO, c.get(), oid, index, tag, ceph::mono_clock::now()});
     c.release();
 
     return 0;
@@ -420,11 +463,23 @@ public:
 
   int handle_next_completion() {
     ceph_assert(!ios.empty());
-    IO& io = ios.front();
+    /* take any io that has completed already, so that a slow one at the
+     * front doesn't hold the window */
+    auto it = std::find_if(ios.begin(), ios.end(),
+                           [] (const IO& io) { return io.c->is_complete(); });
+    if (it == ios.end()) {
+      it = ios.begin();
+    }
+    IO io = *it;
+    ios.erase(it);
     io.c->wait_for_complete();
     int ret = io.c->get_return_value();
     io.c->release();
 
+    if (io.type == IO::TailIO) {
+      update_window(ceph::mono_clock::now() - io.start);
+    }
+
     if (ret == -ENOENT) {
       ret = 0;
     }
@@ -448,7 +503,6 @@ public:
     }
 
   done:
-    ios.pop_front();
     return ret;
   }
 
@@ -738,6 +792,30 @@ done:
   return 0;
 }
 
+int RGWGC::get_oldest_entry_time(int index, bool expired_only,
+                                 optional_yield y, utime_t *time)
+{
+  std::list<cls_rgw_gc_obj_info> entries;
+  bool truncated = false;
+  std::string marker, next_marker;
+  int ret;
+  if (transitioned_objects_cache[index]) {
+    ret = cls_rgw_gc_queue_list_entries(store->gc_pool_ctx, obj_names[index], marker, 1,
+                                        expired_only, entries, &truncated, next_marker);
+  } else {
+    ret = gc_list(this, y, store->gc_pool_ctx, obj_names[index], marker, 1,
+                  expired_only, entries, &truncated, next_marker);
+  }
+  if (ret < 0) {
+    return ret;
+  }
+  if (entries.empty()) {
+    return -ENOENT;
+  }
+  *time = entries.front().time;
+  return 0;
+}
+
 int RGWGC::process(bool expired_only, optional_yield y)
 {
   int max_secs = cct->_conf->rgw_gc_processor_max_time;
@@ -746,8 +824,32 @@ int RGWGC::process(bool expired_only, optional_yield y)
 
   RGWGCIOManager io_manager(this, store->ctx(), this);
 
+  /* process the shards with the oldest entries first, so that the backlog
+   * drains in order when a cycle can't get to all of them */
+  std::vector<std::pair<utime_t, int>> oldest;
+  std::vector<int> order;
   for (int i = 0; i < max_objs; i++) {
     int index = (i + start) % max_objs;
+    utime_t time;
+    if (get_oldest_entry_time(index, expired_only, y, &time) == 0) {
+      oldest.emplace_back(time, index);
+    } else {
+      order.push_back(index);
+    }
+  }
+  std::stable_sort(oldest.begin(), oldest.end(),
+                   [] (const auto& a, const auto& b) { return a.first < b.first; });
+  if (perfcounter) {
+    const utime_t now = ceph_clock_now();
+    perfcounter->set(l_rgw_gc_oldest_entry_age,
+                     oldest.empty() || oldest.front().first > now ?
+                       0 : (now - oldest.front().first).sec());
+  }
+  order.insert(order.begin(), oldest.size(), 0);
+  std::transform(oldest.begin(), oldest.end(), order.begin(),
+                 [] (const auto& o) { return o.second; });
+
+  for (int index : order) {
     int ret = process(index, max_secs, expired_only, io_manager, y);
     if (ret < 0)
       return ret;
@@ -27,6 +27,8 @@ class RGWGC : public DoutPrefixProvider {
   static constexpr uint64_t seed = 8675309;
 
   int tag_index(const std::string& tag);
+  int get_oldest_entry_time(int index, bool expired_only, optional_yield y,
+                            utime_t *time);
   int send_chain(const cls_rgw_obj_chain& chain, const std::string& tag, optional_yield y);
 
   class GCWorker : public Thread {
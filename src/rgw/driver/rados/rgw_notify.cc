@@ -382,9 +382,26 @@ private:
     return 0;
   }
 
+  // seconds the oldest entry of a listing has been waiting in the queue
+  static uint64_t queue_lag(const std::vector<cls_queue_entry>& entries) {
+    event_entry_t event_entry;
+    auto iter = entries.front().data.cbegin();
+    try {
+      decode(event_entry, iter);
+    } catch (buffer::error& err) {
+      return 0;
+    }
+    if (event_entry.creation_time == ceph::coarse_real_clock::zero()) {
+      // entry of an older version, waiting for migration
+      return 0;
+    }
+    const auto age = ceph::coarse_real_clock::now() - event_entry.creation_time;
+    return std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::seconds>(age).count());
+  }
+
   // processing of a specific queue
   void process_queue(const std::string& queue_name, boost::asio::yield_context yield) {
-    constexpr auto max_elements = 1024;
+    const uint64_t max_elements = std::max<uint64_t>(1, cct->_conf->rgw_topic_persistency_batch_size);
     auto is_idle = false;
     const std::string start_marker;
 
@@ -416,12 +433,15 @@ private:
         op.assert_exists();
         bufferlist obl;
         int rval;
+        bufferlist stats_bl;
+        int stats_rval = 0;
         rados::cls::lock::assert_locked(&op, queue_name+"_lock", 
           ClsLockType::EXCLUSIVE,
           lock_cookie, 
           "" /*no tag*/);
         cls_2pc_queue_list_entries(op, start_marker, max_elements, &obl, &rval);
-        // check ownership and list entries in one batch
+        cls_2pc_queue_get_topic_stats(op, &stats_bl, &stats_rval);
+        // check ownership, list entries and read the topic stats in one batch
         auto ret = rgw_rados_operate(this, rados_ioctx, queue_name, std::move(op), nullptr, yield);
         if (ret == -ENOENT) {
           // queue was deleted
@@ -449,12 +469,28 @@ private:
             << queue_name << ". error: " << ret << " (will retry)" << dendl;
           continue;
         }
+        // updating perfcounters with topic stats
+        uint64_t entries_size;
+        uint32_t entries_number;
+        if (stats_rval < 0) {
+          ret = stats_rval;
+        } else {
+          ret = cls_2pc_queue_get_topic_stats_result(stats_bl, entries_number, entries_size);
+        }
+        if (ret < 0) {
+          ldpp_dout(this, 1) << "ERROR: topic stats for topic: " << queue_name << ". error: " << ret << dendl;
+        } else {
+          queue_counters_container.set(l_rgw_persistent_topic_len, entries_number);
+          queue_counters_container.set(l_rgw_persistent_topic_size, entries_size);
+        }
       }
       total_entries = entries.size();
       if (total_entries == 0) {
         // nothing in the queue
+        queue_counters_container.set(l_rgw_persistent_topic_lag, 0);
         continue;
       }
+      queue_counters_container.set(l_rgw_persistent_topic_lag, queue_lag(entries));
       // log when queue is not idle
       ldpp_dout(this, 20) << "INFO: found: " << total_entries << " entries in: " << queue_name <<
         ". end marker is: " << end_marker << dendl;
@@ -480,6 +516,8 @@ private:
       auto stop_processing = false;
       auto remove_entries = false;
       auto entry_idx = 1U;
+      uint64_t pushed_entries = 0;
+      uint64_t failed_entries = 0;
       tokens_waiter tw(this);
       std::vector<bool> needs_migration_vector(entries.size(), false);
       for (auto& entry : entries) {
@@ -492,6 +530,7 @@ private:
         boost::asio::spawn(yield, std::allocator_arg, make_stack_allocator(),
           [this, &is_idle, &notifs_persistency_tracker, &queue_name, entry_idx,
            total_entries, &end_marker, &remove_entries, &stop_processing,
+           &pushed_entries, &failed_entries,
            token = std::move(token), &entry, &needs_migration_vector,
            push_endpoint = push_endpoint.get(),
            &topic_info](boost::asio::yield_context yield) {
@@ -507,6 +546,9 @@ private:
                 << entryProcessingResultString[static_cast<unsigned int>(result)] << dendl;
               remove_entries = true;
               needs_migration_vector[entry_idx - 1] = (result == EntryProcessingResult::Migrating);
+              if (result == EntryProcessingResult::Successful) {
+                ++pushed_entries;
+              }
               notifs_persistency_tracker.erase(entry.marker);
               is_idle = false;
               return;
@@ -520,6 +562,7 @@ private:
               ldpp_dout(this, 20) << "INFO: skipped processing of entry: " << entry.marker
                 << " (" << entry_idx << "/" << total_entries << ") from: " << queue_name << dendl;
             } else {
+              ++failed_entries;
               is_idle = (result_code == -EBUSY);
               ldpp_dout(this, 20) << "INFO: failed processing of entry: " <<
                 entry.marker << " (" << entry_idx << "/" << total_entries << ") from: " << queue_name <<
@@ -536,6 +579,8 @@ private:
         // wait for all pending work to finish
         tw.async_wait(yield);
       }
+      queue_counters_container.inc(l_rgw_persistent_topic_pushed, pushed_entries);
+      queue_counters_container.inc(l_rgw_persistent_topic_failed, failed_entries);
 
       // delete all published entries from queue
       if (remove_entries) {
@@ -647,17 +692,6 @@ private:
           }
         }
       }
-
-      // updating perfcounters with topic stats
-      uint64_t entries_size;
-      uint32_t entries_number;
-      const auto ret = cls_2pc_queue_get_topic_stats(rados_ioctx, queue_name, entries_number, entries_size);
-      if (ret < 0) {
-        ldpp_dout(this, 1) << "ERROR: topic stats for topic: " << queue_name << ". error: " << ret << dendl;
-      } else {
-        queue_counters_container.set(l_rgw_persistent_topic_len, entries_number);
-        queue_counters_container.set(l_rgw_persistent_topic_size, entries_size);
-      }
     }
     ldpp_dout(this, 5) << "INFO: manager stopped. done processing for queue: " << queue_name << dendl;
   }
@@ -0,0 +1,274 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * Copyright contributors to the Ceph project
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation. See file COPYING.
+ *
+ */
+
+#include "rgw_quota_deltas.h"
+
+#include <fmt/format.h>
+
+#include "common/ceph_hash.h"
+#include "common/dout.h"
+#include "common/errno.h"
+#include "rgw_common.h"
+#include "rgw_tools.h"
+
+#define dout_subsys ceph_subsys_rgw
+
+namespace rgwrados::quota {
+
+// the omap keys of a bucket: <prefix><instance>
+static std::string key_prefix(const rgw_bucket& bucket)
+{
+  return bucket.get_key() + '/';
+}
+
+// a gateway has far fewer instances than this per bucket
+static constexpr uint64_t max_instances = 1000;
+
+static int decode_deltas(const std::string& prefix,
+                         const std::map<std::string, bufferlist>& vals,
+                         instance_deltas& deltas)
+{
+  for (const auto& [key, bl] : vals) {
+    instance_delta d;
+    try {
+      auto p = bl.cbegin();
+      decode(d, p);
+    } catch (const buffer::error&) {
+      return -EIO;
+    }
+    deltas.emplace(key.substr(prefix.size()), std::move(d));
+  }
+  return 0;
+}
+
+static void clamped_add(uint64_t& value, int64_t delta)
+{
+  if (delta < 0 && static_cast<uint64_t>(-delta) > value) {
+    value = 0;
+  } else {
+    value += delta;
+  }
+}
+
+void apply(const stats_delta& delta, RGWStorageStats& stats)
+{
+  clamped_add(stats.num_objects, delta.num_objects);
+  clamped_add(stats.size, delta.size);
+  clamped_add(stats.size_rounded, delta.size_rounded);
+}
+
+stats_delta difference(const instance_deltas& before,
+                       const instance_deltas& after)
+{
+  stats_delta d;
+  for (const auto& [instance, a] : after) {
+    d += a.delta;
+    if (auto b = before.find(instance); b != before.end()) {
+      d -= b->second.delta;
+    }
+  }
+  return d;
+}
+
+std::set<std::string> stale_keys(const rgw_bucket& bucket,
+                                 const instance_deltas& deltas,
+                                 const std::string& self,
+                                 ceph::real_time oldest)
+{
+  const auto prefix = key_prefix(bucket);
+  std::set<std::string> keys;
+  for (const auto& [i, d] : deltas) {
+    if (i != self && d.updated < oldest) {
+      keys.insert(prefix + i);
+    }
+  }
+  return keys;
+}
+
+DeltaAggregator::DeltaAggregator(librados::IoCtx ioctx,
+                                 uint64_t instance_id, uint32_t num_shards)
+  : ioctx(std::move(ioctx)),
+    instance(std::to_string(instance_id)),
+    num_shards(std::max<uint32_t>(1, num_shards))
+{}
+
+std::string DeltaAggregator::shard_oid(const std::string& prefix) const
+{
+  const uint32_t shard = ceph_str_hash_linux(prefix.data(), prefix.size()) % num_shards;
+  return fmt::format("quota_deltas.{}", shard);
+}
+
+void DeltaAggregator::add(const rgw_bucket& bucket, const stats_delta& delta)
+{
+  std::lock_guard lock{mutex};
+  auto& l = local[bucket];
+  l.total += delta;
+  l.dirty = true;
+}
+
+stats_delta DeltaAggregator::local_total(const rgw_bucket& bucket)
+{
+  std::lock_guard lock{mutex};
+  auto i = local.find(bucket);
+  if (i == local.end()) {
+    return {};
+  }
+  return i->second.total;
+}
+
+std::vector<rgw_bucket> DeltaAggregator::collect(ceph::real_time now,
+                                                 ceph::timespan republish,
+                                                 delta_writes& writes)
+{
+  std::vector<rgw_bucket> collected;
+  std::lock_guard lock{mutex};
+  for (auto& [bucket, l] : local) {
+    // republish unchanged totals too, or other gateways trim our key and
+    // count the whole total again once it reappears
+    if (!l.dirty && now - l.published < republish) {
+      continue;
+    }
+    const auto prefix = key_prefix(bucket);
+    bufferlist bl;
+    encode(instance_delta{l.total, now}, bl);
+    writes[shard_oid(prefix)].emplace(prefix + instance, std::move(bl));
+    l.dirty = false;
+    l.published = now;
+    collected.push_back(bucket);
+  }
+  return collected;
+}
+
+int DeltaAggregator::flush(const DoutPrefixProvider* dpp, optional_yield y,
+                           ceph::timespan republish)
+{
+  delta_writes writes;
+  const auto flushed = collect(ceph::real_clock::now(), republish, writes);
+
+  int ret = 0;
+  for (auto& [oid, vals] : writes) {
+    librados::ObjectWriteOperation op;
+    op.omap_set(vals);
+    int r = rgw_rados_operate(dpp, ioctx, oid, std::move(op), y);
+    if (r < 0) {
+      ldpp_dout(dpp, 1) << "WARNING: failed to write quota deltas to "
+          << oid << ": " << cpp_strerror(r) << dendl;
+      ret = r;
+    }
+  }
+  if (ret < 0) {
+    // publish the totals again with the next flush
+    std::lock_guard lock{mutex};
+    for (const auto& bucket : flushed) {
+      local[bucket].dirty = true;
+    }
+  }
+  return ret;
+}
+
+int DeltaAggregator::read(const DoutPrefixProvider* dpp,
+                          const rgw_bucket& bucket,
+                          instance_deltas& deltas, optional_yield y)
+{
+  const auto prefix = key_prefix(bucket);
+  std::map<std::string, bufferlist> vals;
+  int rval = 0;
+  librados::ObjectReadOperation op;
+  op.omap_get_vals2("", prefix, max_instances, &vals, nullptr, &rval);
+  int r = rgw_rados_operate(dpp, ioctx, shard_oid(prefix), std::move(op),
+                            nullptr, y);
+  if (r == -ENOENT) {
+    return 0;
+  }
+  if (r < 0) {
+    return r;
+  }
+  if (rval < 0) {
+    return rval;
+  }
+  return decode_deltas(prefix, vals, deltas);
+}
+
+namespace {
+
+struct read_state {
+  boost::intrusive_ptr<ReadDeltasCB> cb;
+  std::string prefix;
+  std::map<std::string, bufferlist> vals;
+  int rval = 0;
+};
+
+void read_deltas_cb(librados::completion_t c, void* arg)
+{
+  std::unique_ptr<read_state> state{static_cast<read_state*>(arg)};
+  int r = rados_aio_get_return_value(c);
+  instance_deltas deltas;
+  if (r == -ENOENT) {
+    r = 0;
+  } else if (r >= 0 && state->rval < 0) {
+    r = state->rval;
+  } else if (r >= 0) {
+    r = decode_deltas(state->prefix, state->vals, deltas);
+  }
+  state->cb->handle_response(r, std::move(deltas));
+}
+
+} // anonymous namespace
+
+int DeltaAggregator::read_async(const DoutPrefixProvider* dpp,
+                                const rgw_bucket& bucket,
+                                boost::intrusive_ptr<ReadDeltasCB> cb)
+{
+  auto state = std::make_unique<read_state>();
+  state->cb = std::move(cb);
+  state->prefix = key_prefix(bucket);
+
+  librados::ObjectReadOperation op;
+  op.omap_get_vals2("", state->prefix, max_instances, &state->vals,
+                    nullptr, &state->rval);
+  const auto oid = shard_oid(state->prefix);
+  auto c = librados::Rados::aio_create_completion(state.get(), read_deltas_cb);
+  int r = ioctx.aio_operate(oid, c, &op, nullptr);
+  c->release();
+  if (r < 0) {
+    ldpp_dout(dpp, 1) << "WARNING: failed to read quota deltas from "
+        << oid << ": " << cpp_strerror(r) << dendl;
+    return r;
+  }
+  state.release(); // owned by the completion
+  return 0;
+}
+
+void DeltaAggregator::trim(const DoutPrefixProvider* dpp,
+                           const rgw_bucket& bucket,
+                           const instance_deltas& deltas,
+                           ceph::timespan max_age)
+{
+  const auto keys = stale_keys(bucket, deltas, instance,
+                               ceph::real_clock::now() - max_age);
+  if (keys.empty()) {
+    return;
+  }
+  ldpp_dout(dpp, 20) << "trimming " << keys.size()
+      << " stale quota deltas of bucket=" << bucket << dendl;
+
+  librados::ObjectWriteOperation op;
+  op.omap_rm_keys(keys);
+  auto c = librados::Rados::aio_create_completion();
+  ioctx.aio_operate(shard_oid(key_prefix(bucket)), c, &op);
+  c->release();
+}
+
+} // namespace rgwrados::quota
@@ -0,0 +1,191 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * Copyright contributors to the Ceph project
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation. See file COPYING.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/intrusive_ptr.hpp>
+#include <boost/smart_ptr/intrusive_ref_counter.hpp>
+
+#include "include/encoding.h"
+#include "include/rados/librados.hpp"
+#include "common/ceph_time.h"
+#include "common/async/yield_context.h"
+#include "rgw_bucket_types.h"
+
+class DoutPrefixProvider;
+struct RGWStorageStats;
+
+namespace rgwrados::quota {
+
+/// net change of a bucket's stats
+struct stats_delta {
+  int64_t num_objects = 0;
+  int64_t size = 0;
+  int64_t size_rounded = 0;
+
+  stats_delta& operator+=(const stats_delta& rhs) {
+    num_objects += rhs.num_objects;
+    size += rhs.size;
+    size_rounded += rhs.size_rounded;
+    return *this;
+  }
+  stats_delta& operator-=(const stats_delta& rhs) {
+    num_objects -= rhs.num_objects;
+    size -= rhs.size;
+    size_rounded -= rhs.size_rounded;
+    return *this;
+  }
+
+  void encode(bufferlist& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(num_objects, bl);
+    encode(size, bl);
+    encode(size_rounded, bl);
+    ENCODE_FINISH(bl);
+  }
+  void decode(bufferlist::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(num_objects, bl);
+    decode(size, bl);
+    decode(size_rounded, bl);
+    DECODE_FINISH(bl);
+  }
+};
+WRITE_CLASS_ENCODER(stats_delta)
+
+/// apply a delta to stats, clamping each counter at 0
+void apply(const stats_delta& delta, RGWStorageStats& stats);
+
+/// the delta that one gateway published for a bucket, accumulated since that
+/// gateway started
+struct instance_delta {
+  stats_delta delta;
+  ceph::real_time updated;
+
+  void encode(bufferlist& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(delta, bl);
+    encode(updated, bl);
+    ENCODE_FINISH(bl);
+  }
+  void decode(bufferlist::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(delta, bl);
+    decode(updated, bl);
+    DECODE_FINISH(bl);
+  }
+};
+WRITE_CLASS_ENCODER(instance_delta)
+
+/// the published deltas of a bucket, by gateway instance
+using instance_deltas = std::map<std::string, instance_delta>;
+
+/// sum of the changes between two reads of a bucket's published deltas.
+/// instances missing from either read changed nothing in between
+stats_delta difference(const instance_deltas& before,
+                       const instance_deltas& after);
+
+/// the omap keys of the bucket's deltas that other gateways last updated
+/// before oldest
+std::set<std::string> stale_keys(const rgw_bucket& bucket,
+                                 const instance_deltas& deltas,
+                                 const std::string& self,
+                                 ceph::real_time oldest);
+
+/// omap values to write, by shard object
+using delta_writes = std::map<std::string, std::map<std::string, bufferlist>>;
+
+/// Ref-counted callback for DeltaAggregator::read_async()
+class ReadDeltasCB : public boost::intrusive_ref_counter<ReadDeltasCB> {
+ public:
+  virtual ~ReadDeltasCB() {}
+  virtual void handle_response(int r, instance_deltas&& deltas) = 0;
+};
+
+/**
+ * Exchanges bucket stats changes between gateways, so quota checks can
+ * follow the writes of every gateway without reading the header of each
+ * bucket index shard.
+ *
+ * Each gateway adds the changes it makes to a running total per bucket and
+ * periodically writes the totals to an omap key of its own on one of
+ * rgw_bucket_quota_delta_shards objects in the zone's log pool. The keys of
+ * a bucket share a prefix, so a reader gets all of them with a single omap
+ * read, and the change since an earlier read is the difference of the
+ * totals. No gateway writes another's key, so plain omap writes are enough.
+ *
+ * A reader counts the whole total of a key it didn't see before, so the key
+ * of a live gateway must not be trimmed: totals are republished at least
+ * once per republish interval even when they didn't change.
+ */
+class DeltaAggregator {
+  librados::IoCtx ioctx;
+  const std::string instance;
+  const uint32_t num_shards;
+
+  struct local_delta {
+    stats_delta total;
+    bool dirty = false;
+    ceph::real_time published;
+  };
+  std::mutex mutex;
+  std::map<rgw_bucket, local_delta> local;
+
+  std::string shard_oid(const std::string& prefix) const;
+
+ public:
+  DeltaAggregator(librados::IoCtx ioctx,
+                  uint64_t instance_id, uint32_t num_shards);
+
+  /// the omap key suffix of this gateway
+  const std::string& get_instance() const { return instance; }
+
+  /// add a local change, which is published by the next flush()
+  void add(const rgw_bucket& bucket, const stats_delta& delta);
+
+  /// this gateway's running total for the bucket, including the changes
+  /// that weren't flushed yet
+  stats_delta local_total(const rgw_bucket& bucket);
+
+  /// take the totals to publish at now: those changed since they were last
+  /// taken and those taken at least republish ago. returns their buckets
+  std::vector<rgw_bucket> collect(ceph::real_time now,
+                                  ceph::timespan republish,
+                                  delta_writes& writes);
+
+  /// publish the collect()ed totals, with one omap write per shard object
+  int flush(const DoutPrefixProvider* dpp, optional_yield y,
+            ceph::timespan republish);
+
+  /// read the published deltas of a bucket
+  int read(const DoutPrefixProvider* dpp, const rgw_bucket& bucket,
+           instance_deltas& deltas, optional_yield y);
+  int read_async(const DoutPrefixProvider* dpp, const rgw_bucket& bucket,
+                 boost::intrusive_ptr<ReadDeltasCB> cb);
+
+  /// remove the keys of other gateways that weren't updated for max_age,
+  /// such as those of stopped gateways. doesn't wait for the result
+  void trim(const DoutPrefixProvider* dpp, const rgw_bucket& bucket,
+            const instance_deltas& deltas, ceph::timespan max_age);
+};
+
+} // namespace rgwrados::quota
@@ -5,6 +5,7 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <cmath>
 #include <sstream>
 
 #include <boost/algorithm/string.hpp>
@@ -70,12 +71,14 @@
 #include <list>
 #include <map>
 #include "include/random.h"
+#include "include/scope_guard.h"
 
 #include "rgw_gc.h"
 #include "rgw_lc.h"
 
 #include "rgw_object_expirer_core.h"
 #include "rgw_sync.h"
+#include "rgw_sync_bulk_fetch.h"
 #include "rgw_sync_counters.h"
 #include "rgw_sync_trace.h"
 #include "rgw_trim_datalog.h"
@@ -83,6 +86,7 @@
 #include "rgw_data_sync.h"
 #include "rgw_realm_watcher.h"
 #include "rgw_reshard.h"
+#include "rgw_perf_counters.h"
 #include "rgw_cr_rados.h"
 #include "topic_migration.h"
 
@@ -812,6 +816,7 @@ struct complete_op_data {
   bool log_op;
   uint16_t bilog_op;
   rgw_zone_set zones_trace;
+  string locator;
 
   bool stopped{false};
 
@@ -833,16 +838,42 @@ class RGWIndexCompletionManager {
   bool _stop{false};
   std::thread retry_thread;
 
+  // complete ops waiting to be sent together to their index shard
+  struct complete_batch {
+    rgw_rados_ref ref;
+    std::vector<complete_op_data*> entries;
+    std::set<cls_rgw_obj_key> keys;
+    ceph::coarse_mono_time deadline;
+  };
+  std::map<rgw_raw_obj, complete_batch> batches;
+  std::condition_variable batch_cond;
+  std::mutex batches_lock;
+  bool batch_stop{false};
+  std::thread batch_thread;
+  // set once an index osd rejects the batch method
+  std::atomic<bool> batch_unsupported{false};
+
   // used to distribute the completions and the locks they use across
   // their respective vectors; it will get incremented and can wrap
   // around back to 0 without issue
   std::atomic<uint32_t> cur_shard {0};
 
   void process();
-  
+  void process_batches();
+  void submit_batch(complete_batch&& batch);
+
   void add_completion(complete_op_data *completion);
   
   void stop() {
+    if (batch_thread.joinable()) {
+      {
+        std::lock_guard l{batches_lock};
+        batch_stop = true;
+      }
+      batch_cond.notify_all();
+      batch_thread.join();
+    }
+
     if (retry_thread.joinable()) {
       _stop = true;
       cond.notify_all();
@@ -873,7 +904,8 @@ public:
 				std::to_string(i));
       })},
     completions(num_shards),
-    retry_thread(&RGWIndexCompletionManager::process, this)
+    retry_thread(&RGWIndexCompletionManager::process, this),
+    batch_thread(&RGWIndexCompletionManager::process_batches, this)
     {}
 
   ~RGWIndexCompletionManager() {
@@ -890,7 +922,21 @@ public:
                          rgw_zone_set *zones_trace,
                          complete_op_data **result);
 
-  bool handle_completion(completion_t cb, complete_op_data *arg);
+  // queue a complete op to be sent along with the others for the same
+  // index shard. returns false if batching is disabled, in which case the
+  // caller sends the op itself
+  bool batch_completion(const rgw_rados_ref& bucket_obj, const rgw_obj& obj,
+                        RGWModifyOp op, string& tag,
+                        rgw_bucket_entry_ver& ver,
+                        const cls_rgw_obj_key& key,
+                        rgw_bucket_dir_entry_meta& dir_meta,
+                        list<cls_rgw_obj_key> *remove_objs, bool log_op,
+                        uint16_t bilog_op,
+                        rgw_zone_set *zones_trace,
+                        const std::string& locator,
+                        bool batch);
+
+  bool handle_completion(int r, complete_op_data *arg, bool batched = false);
 
   CephContext* ctx() {
     return store->ctx();
@@ -906,13 +952,43 @@ static void obj_complete_cb(completion_t cb, void *arg)
     delete completion;
     return;
   }
-  bool need_delete = completion->manager->handle_completion(cb, completion);
+  bool need_delete = completion->manager->handle_completion(
+    rados_aio_get_return_value(cb), completion);
   completion->lock.unlock();
   if (need_delete) {
     delete completion;
   }
 }
 
+struct complete_batch_data {
+  RGWIndexCompletionManager *manager{nullptr};
+  std::vector<complete_op_data*> entries;
+};
+
+static void finish_complete_batch(complete_batch_data *arg, int r)
+{
+  std::unique_ptr<complete_batch_data> batch{arg};
+  for (auto completion : batch->entries) {
+    completion->lock.lock();
+    if (completion->stopped) {
+      completion->lock.unlock();
+      delete completion;
+      continue;
+    }
+    bool need_delete = batch->manager->handle_completion(r, completion, true);
+    completion->lock.unlock();
+    if (need_delete) {
+      delete completion;
+    }
+  }
+}
+
+static void obj_complete_batch_cb(completion_t cb, void *arg)
+{
+  finish_complete_batch(reinterpret_cast<complete_batch_data*>(arg),
+                        rados_aio_get_return_value(cb));
+}
+
 void RGWIndexCompletionManager::process()
 {
   DoutPrefix dpp(store->ctx(), dout_subsys, "rgw index completion thread: ");
@@ -957,7 +1033,7 @@ void RGWIndexCompletionManager::process()
 			       o.assert_exists();
 			       cls_rgw_guard_bucket_resharding(o, -ERR_BUSY_RESHARDING);
 			       cls_rgw_bucket_complete_op(o, c->op, c->tag, c->ver, c->key, c->dir_meta, &c->remove_objs,
-							  c->log_op, c->bilog_op, &c->zones_trace);
+							  c->log_op, c->bilog_op, &c->zones_trace, c->locator);
 			       int ret = bs->bucket_obj.operate(&dpp, std::move(o), null_yield);
 			       ldout_bitx(bitx, &dpp, 10) <<
 				 "EXITING " << __func__ << ": ret=" << dendl_bitx;
@@ -1035,7 +1111,147 @@ void RGWIndexCompletionManager::add_completion(complete_op_data *completion) {
   cond.notify_all();
 }
 
-bool RGWIndexCompletionManager::handle_completion(completion_t cb, complete_op_data *arg)
+bool RGWIndexCompletionManager::batch_completion(const rgw_rados_ref& bucket_obj,
+                                                 const rgw_obj& obj,
+                                                 RGWModifyOp op, string& tag,
+                                                 rgw_bucket_entry_ver& ver,
+                                                 const cls_rgw_obj_key& key,
+                                                 rgw_bucket_dir_entry_meta& dir_meta,
+                                                 list<cls_rgw_obj_key> *remove_objs, bool log_op,
+                                                 uint16_t bilog_op,
+                                                 rgw_zone_set *zones_trace,
+                                                 const std::string& locator,
+                                                 bool batch)
+{
+  auto& conf = ctx()->_conf;
+  auto delay = conf.get_val<uint64_t>("rgw_bucket_index_complete_batch_delay_us");
+  if (batch) {
+    delay = std::max(delay, conf.get_val<uint64_t>("rgw_multi_obj_del_index_batch_delay_us"));
+  }
+  const auto max_ops = conf.get_val<uint64_t>("rgw_bucket_index_complete_batch_max");
+  if (delay == 0 || max_ops <= 1 || batch_unsupported) {
+    return false;
+  }
+
+  complete_op_data *entry;
+  create_completion(obj, op, tag, ver, key, dir_meta, remove_objs, log_op,
+                    bilog_op, zones_trace, &entry);
+  entry->locator = locator;
+  // the batch has a completion of its own
+  entry->rados_completion->release();
+  entry->rados_completion = nullptr;
+
+  std::optional<complete_batch> full;
+  {
+    std::lock_guard l{batches_lock};
+    auto [i, added] = batches.try_emplace(bucket_obj.obj);
+    auto& batch = i->second;
+    bool conflict = batch.keys.count(key) > 0;
+    for (const auto& k : entry->remove_objs) {
+      conflict = conflict || batch.keys.count(k) > 0;
+    }
+    if (conflict) {
+      // the cls method can't apply two ops on the same key, send the
+      // earlier ones first; librados keeps the order of ops on an object
+      full.emplace(std::move(batch));
+      batch = complete_batch{};
+      added = true;
+    }
+    if (added) {
+      batch.ref = bucket_obj;
+      batch.deadline = ceph::coarse_mono_clock::now() +
+        std::chrono::microseconds(delay);
+    }
+    batch.entries.push_back(entry);
+    batch.keys.insert(key);
+    batch.keys.insert(entry->remove_objs.begin(), entry->remove_objs.end());
+    if (!full && batch.entries.size() >= max_ops) {
+      full.emplace(std::move(batch));
+      batches.erase(i);
+    }
+  }
+  if (full) {
+    submit_batch(std::move(*full));
+  }
+  batch_cond.notify_all();
+  return true;
+}
+
+void RGWIndexCompletionManager::submit_batch(complete_batch&& batch)
+{
+  std::vector<rgw_cls_obj_complete_op> ops;
+  ops.reserve(batch.entries.size());
+  for (auto c : batch.entries) {
+    auto& call = ops.emplace_back();
+    call.op = c->op;
+    call.tag = c->tag;
+    call.key = c->key;
+    call.ver = c->ver;
+    call.locator = c->locator;
+    call.meta = c->dir_meta;
+    call.log_op = c->log_op;
+    call.bilog_flags = c->bilog_op;
+    call.remove_objs = c->remove_objs;
+    call.zones_trace = c->zones_trace;
+  }
+
+  librados::ObjectWriteOperation o;
+  o.assert_exists(); // bucket index shard must exist
+  cls_rgw_guard_bucket_resharding(o, -ERR_BUSY_RESHARDING);
+  cls_rgw_bucket_complete_op_batch(o, ops);
+
+  auto data = new complete_batch_data;
+  data->manager = this;
+  data->entries = std::move(batch.entries);
+  auto completion = librados::Rados::aio_create_completion(data, obj_complete_batch_cb);
+  int r = batch.ref.aio_operate(completion, &o);
+  completion->release();
+  if (r < 0) {
+    ldout(ctx(), 0) << "ERROR: " << __func__ << "(): failed to send batch to "
+        << batch.ref.obj << " r=" << r << dendl;
+    // the callback won't run, hand the entries to the retry thread
+    finish_complete_batch(data, r);
+  }
+}
+
+void RGWIndexCompletionManager::process_batches()
+{
+  std::unique_lock l{batches_lock};
+  while (true) {
+    if (batches.empty()) {
+      if (batch_stop) {
+        return;
+      }
+      batch_cond.wait(l);
+      continue;
+    }
+
+    // send the expired batches, or all of them when stopping
+    const auto now = ceph::coarse_mono_clock::now();
+    auto next = ceph::coarse_mono_time::max();
+    std::vector<complete_batch> expired;
+    for (auto i = batches.begin(); i != batches.end();) {
+      if (batch_stop || i->second.deadline <= now) {
+        expired.push_back(std::move(i->second));
+        i = batches.erase(i);
+      } else {
+        next = std::min(next, i->second.deadline);
+        ++i;
+      }
+    }
+    if (!expired.empty()) {
+      l.unlock();
+      for (auto& batch : expired) {
+        submit_batch(std::move(batch));
+      }
+      l.lock();
+      continue;
+    }
+    batch_cond.wait_until(l, next);
+  }
+}
+
+bool RGWIndexCompletionManager::handle_completion(int r, complete_op_data *arg, bool batched)
 {
   int shard_id = arg->manager_shard_id;
   {
@@ -1052,8 +1268,12 @@ bool RGWIndexCompletionManager::handle_completion(completion_t cb, complete_op_d
     comps.erase(iter);
   }
 
-  int r = rados_aio_get_return_value(cb);
-  if (r != -ERR_BUSY_RESHARDING) {
+  if (batched && r == -EOPNOTSUPP && !batch_unsupported.exchange(true)) {
+    ldout(arg->manager->ctx(), 1) << __func__ << "(): index osd doesn't "
+        "support batched complete ops, sending them individually" << dendl;
+  }
+  // a failed batch is retried as individual complete ops
+  if (r != -ERR_BUSY_RESHARDING && !(batched && r < 0)) {
     ldout(arg->manager->ctx(), 20) << __func__ << "(): completion " << 
       (r == 0 ? "ok" : "failed with " + to_string(r)) << 
       " for obj=" << arg->key << dendl;
@@ -1978,7 +2198,8 @@ int RGWRados::Bucket::List::list_objects_ordered(
 					   &cls_filtered,
 					   &cur_marker,
                                            y,
-					   params.force_check_filter);
+					   params.force_check_filter,
+					   &list_state);
     if (r < 0) {
       return r;
     }
@@ -3307,7 +3528,14 @@ int RGWRados::Object::Write::_do_write_meta(uint64_t size, uint64_t accounted_si
   struct timespec mtime_ts = real_clock::to_timespec(meta.set_mtime);
   op.mtime2(&mtime_ts);
 
-  if (meta.data) {
+  const uint64_t inline_max =
+    store->ctx()->_conf.get_val<Option::size_t>("rgw_inline_data_max_size");
+  if (meta.data && reset_obj && meta.data->length() == size &&
+      size > 0 && size <= inline_max) {
+    /* the whole object fits, keep the data with the metadata. the head is
+       recreated above, so no earlier data or inline attr survives */
+    op.setxattr(RGW_ATTR_INLINE_DATA, *meta.data);
+  } else if (meta.data) {
     /* if we want to overwrite the data, we also want to overwrite the
        xattrs, so just remove the object */
     op.write_full(*meta.data);
@@ -3720,7 +3948,7 @@ public:
 
     // do not compress if object is encrypted
     if (plugin && !encrypted) {
-      compressor = boost::in_place(cct, plugin, filter);
+      compressor = boost::in_place(cct, plugin, filter, null_yield);
       // add a filter that buffers data so we don't try to compress tiny blocks.
       // libcurl reads in 16k at a time, and we need at least 64k to get a good
       // compression ratio
@@ -4457,7 +4685,8 @@ int RGWRados::fetch_remote_obj(RGWObjectCtx& dest_obj_ctx,
                std::optional<rgw_zone_set_entry> source_trace_entry,
                rgw_zone_set *zones_trace,
                std::optional<uint64_t>* bytes_transferred,
-               bool keep_tags)
+               bool keep_tags,
+               const rgw_bulk_fetch_entry* prefetched)
 {
   /* source is in a different zonegroup, copy from there */
 
@@ -4610,7 +4839,41 @@ int RGWRados::fetch_remote_obj(RGWObjectCtx& dest_obj_ctx,
   static constexpr bool sync_cloudtiered = true;
 
   static constexpr int NUM_ENPOINT_IOERROR_RETRIES = 20;
-  for (int tries = 0; tries < NUM_ENPOINT_IOERROR_RETRIES; tries++) {
+  if (prefetched) {
+    /* the source zone already sent the object in a bulk fetch; apply the
+     * checks a sync GET would have made against the If-Modified-Since
+     * date, which only has second precision */
+    ret = prefetched->status;
+    if (ret == 0 && pmod) {
+      obj_time_weight src_weight;
+      src_weight.init(std::max(prefetched->mtime, prefetched->internal_mtime),
+                      prefetched->zone_short_id, prefetched->pg_ver);
+      src_weight.high_precision = true;
+      obj_time_weight mod_weight;
+      mod_weight.init(real_clock::from_time_t(real_clock::to_time_t(*pmod)),
+                      0, dest_mtime_weight.pg_ver);
+      mod_weight.high_precision = true;
+      if (!(mod_weight < src_weight)) {
+        ret = -ERR_NOT_MODIFIED;
+      }
+    }
+    if (ret < 0) {
+      goto set_err_state;
+    }
+    {
+      bufferlist bl = prefetched->body;
+      bool pause = false;
+      cb.set_extra_data_len(prefetched->metadata_len);
+      ret = cb.handle_data(bl, &pause);
+    }
+    if (ret < 0) {
+      goto set_err_state;
+    }
+    etag = prefetched->etag;
+    set_mtime = prefetched->mtime;
+    accounted_size = prefetched->size;
+  }
+  for (int tries = 0; !prefetched && tries < NUM_ENPOINT_IOERROR_RETRIES; tries++) {
     ret = conn->get_obj(rctx.dpp, user_id, perm_check_uid, info, src_obj, pmod, unmod_ptr,
                         dest_mtime_weight.zone_short_id, dest_mtime_weight.pg_ver, prepend_meta, get_op, rgwx_stat,
                         sync_manifest, skip_decrypt, &dst_zone_trace,
@@ -6655,6 +6918,7 @@ int RGWRados::Object::Delete::delete_obj(optional_yield y,
 
   index_op.set_zones_trace(params.zones_trace);
   index_op.set_bilog_flags(params.bilog_flags);
+  index_op.set_batch(params.batch_index);
 
   if (params.null_verid) {
     index_op.set_bilog_flags(params.bilog_flags | RGW_BILOG_NULL_VERSION);
@@ -6902,6 +7166,13 @@ int RGWRados::get_obj_state_impl(const DoutPrefixProvider *dpp, RGWObjectCtx *oc
 
   s->exists = true;
   s->has_attrs = true;
+  if (auto i = s->attrset.find(RGW_ATTR_INLINE_DATA); i != s->attrset.end()) {
+    /* the head holds no data of its own. serving reads from s->data saves
+     * them a second round trip */
+    s->data = std::move(i->second);
+    s->size = s->data.length();
+    s->attrset.erase(i);
+  }
   s->accounted_size = s->size;
 
   auto iter = s->attrset.find(RGW_ATTR_ETAG);
@@ -7155,7 +7426,12 @@ int RGWRados::Object::Stat::wait(const DoutPrefixProvider *dpp)
 
 int RGWRados::Object::Stat::finish(const DoutPrefixProvider *dpp)
 {
-  map<string, bufferlist>::iterator iter = result.attrs.find(RGW_ATTR_MANIFEST);
+  map<string, bufferlist>::iterator iter = result.attrs.find(RGW_ATTR_INLINE_DATA);
+  if (iter != result.attrs.end()) {
+    result.size = iter->second.length();
+    result.attrs.erase(iter);
+  }
+  iter = result.attrs.find(RGW_ATTR_MANIFEST);
   if (iter != result.attrs.end()) {
     bufferlist& bl = iter->second;
     auto biter = bl.cbegin();
@@ -8030,7 +8306,7 @@ int RGWRados::Bucket::UpdateIndex::complete_del(const DoutPrefixProvider *dpp,
 
   bool add_log = log_op && store->svc.zone->need_to_log_data();
 
-  ret = store->cls_obj_complete_del(*bs, optag, poolid, epoch, obj, removed_mtime, remove_objs, bilog_flags, zones_trace, add_log);
+  ret = store->cls_obj_complete_del(*bs, optag, poolid, epoch, obj, removed_mtime, remove_objs, bilog_flags, zones_trace, add_log, batch);
 
   if (add_log) {
     ret = add_datalog_entry(dpp, store->svc.datalog_rados,
@@ -8142,7 +8418,8 @@ int RGWRados::Object::Read::read(int64_t ofs, int64_t end,
 
     // astate can be modified by append_atomic_test
     // coverity[check_after_deref:SUPPRESS]
-    if (astate && astate->prefetch_data) {
+    // prefetched, or stored inline
+    if (astate && astate->data.length() > 0) {
       if (!ofs && astate->data.length() >= len) {
         bl = astate->data;
         return bl.length();
@@ -8212,10 +8489,13 @@ int get_obj_data::flush(rgw::AioResultList&& results) {
 
     bl_list.push_back(bl);
     offset += bl.length();
+    const auto ready = ceph::mono_clock::now();
     int r = client_cb->handle_data(bl, 0, bl.length());
     if (r < 0) {
       return r;
     }
+    update_window(completed.front().id, bl.length(), ready,
+                  ceph::mono_clock::now() - ready);
 
     if (rgwrados->get_use_datacache()) {
       const std::lock_guard l(d3n_get_data.d3n_lock);
@@ -8232,6 +8512,49 @@ int get_obj_data::flush(rgw::AioResultList&& results) {
   return 0;
 }
 
+void get_obj_data::init_window(uint64_t chunk_size, uint64_t window,
+                               uint64_t max_window)
+{
+  read_window.chunk_size = chunk_size;
+  read_window.window = window;
+  read_window.max_window = max_window;
+}
+
+void get_obj_data::update_window(uint64_t id, uint64_t len,
+                                 ceph::mono_time ready,
+                                 ceph::timespan drain_time)
+{
+  auto& w = read_window;
+  if (!w.max_window || !w.chunk_size) {
+    return;
+  }
+
+  constexpr double alpha = 0.25; // weight of the latest sample
+  auto average = [] (double avg, double sample) {
+    return avg == 0 ? sample : avg + alpha * (sample - avg);
+  };
+
+  if (auto i = w.issued.find(id); i != w.issued.end()) {
+    const double latency = std::chrono::duration<double>(ready - i->second).count();
+    w.read_latency = average(w.read_latency, latency);
+    w.issued.erase(i);
+  }
+  const double drain = std::max(std::chrono::duration<double>(drain_time).count(),
+                                1e-6);
+  w.drain_rate = average(w.drain_rate, len / drain);
+
+  // keep as much in flight as the client takes while a read is
+  // outstanding, plus the chunk being sent
+  const double wanted = w.drain_rate * w.read_latency + w.chunk_size;
+  const double max_chunks = std::max<uint64_t>(w.max_window / w.chunk_size, 1);
+  const uint64_t chunks = std::min(std::ceil(wanted / w.chunk_size), max_chunks);
+  const uint64_t window = std::max<uint64_t>(chunks, 1) * w.chunk_size;
+  if (window != w.window) {
+    w.window = window;
+    aio->set_window(window);
+  }
+}
+
 static int _get_obj_iterate_cb(const DoutPrefixProvider *dpp,
                                const rgw_raw_obj& read_obj, off_t obj_ofs,
                                off_t read_ofs, off_t len, bool is_head_obj,
@@ -8290,6 +8613,7 @@ int RGWRados::get_obj_iterate_cb(const DoutPrefixProvider *dpp,
   const uint64_t cost = len;
   const uint64_t id = obj_ofs; // use logical object offset for sorting replies
 
+  d->note_read_issued(id);
   auto completed = d->aio->get(obj.obj, rgw::Aio::librados_op(obj.ioctx, std::move(op), d->yield), cost, id);
 
   return d->flush(std::move(completed));
@@ -8302,9 +8626,17 @@ int RGWRados::Object::Read::iterate(const DoutPrefixProvider *dpp, int64_t ofs,
   CephContext *cct = store->ctx();
   const uint64_t chunk_size = cct->_conf->rgw_get_obj_max_req_size;
   const uint64_t window_size = cct->_conf->rgw_get_obj_window_size;
+  const uint64_t max_window_size =
+    cct->_conf.get_val<Option::size_t>("rgw_get_obj_max_window_size");
 
-  auto aio = rgw::make_throttle(window_size, y);
+  // data read ahead by all requests, see rgw_get_obj_inflight_max_bytes
+  static rgw::ThrottleBudget inflight_budget;
+  inflight_budget.set_limit(
+    cct->_conf.get_val<Option::size_t>("rgw_get_obj_inflight_max_bytes"));
+
+  auto aio = rgw::make_throttle(window_size, y, &inflight_budget);
   get_obj_data data(store, cb, &*aio, ofs, y);
+  data.init_window(chunk_size, window_size, max_window_size);
 
   if (state.obj.empty()) {
     state.obj = source->get_obj();
@@ -8724,6 +9056,16 @@ int RGWRados::block_while_resharding(RGWRados::BucketShard *bs,
   int ret = 0;
   cls_rgw_bucket_instance_entry entry;
 
+  // account for the time the write spends waiting on the reshard
+  const auto wait_start = ceph::mono_clock::now();
+  auto account_wait = make_scope_guard([wait_start] {
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_reshard_blocked_writes);
+      perfcounter->tinc(l_rgw_reshard_block_lat,
+                        ceph::mono_clock::now() - wait_start);
+    }
+  });
+
   // gets loaded by fetch_new_bucket_info; can be used by
   // clear_resharding
   std::map<std::string, bufferlist> bucket_attrs;
@@ -10344,6 +10686,27 @@ int RGWRados::bi_list(const DoutPrefixProvider *dpp,
   return bi_list(bs, obj_name_filter, marker, max, entries, is_truncated, reshardlog, y);
 }
 
+int RGWRados::reshard_log_trim_entries(const DoutPrefixProvider *dpp,
+                                       const RGWBucketInfo& bucket_info,
+                                       int shard_id,
+                                       std::vector<rgw_cls_bi_entry> entries,
+                                       optional_yield y)
+{
+  BucketShard bs(this);
+  int ret = bs.init(dpp, bucket_info,
+		    bucket_info.layout.current_index,
+		    shard_id, y);
+  if (ret < 0) {
+    ldpp_dout(dpp, 5) << "bs.init() returned ret=" << ret << dendl;
+    return ret;
+  }
+
+  librados::ObjectWriteOperation op;
+  cls_rgw_bucket_reshard_log_trim_entries(op, std::move(entries));
+  auto& ref = bs.bucket_obj;
+  return rgw_rados_operate(dpp, ref.ioctx, ref.obj.oid, std::move(op), y);
+}
+
 int RGWRados::bi_remove(const DoutPrefixProvider *dpp, BucketShard& bs)
 {
   auto& ref = bs.bucket_obj;
@@ -10422,7 +10785,8 @@ int RGWRados::cls_obj_complete_op(BucketShard& bs, const rgw_obj& obj, RGWModify
                                   int64_t pool, uint64_t epoch,
                                   rgw_bucket_dir_entry& ent, RGWObjCategory category,
                                   list<rgw_obj_index_key> *remove_objs, uint16_t bilog_flags,
-                                  rgw_zone_set *_zones_trace, bool log_op)
+                                  rgw_zone_set *_zones_trace, bool log_op,
+                                  bool batch)
 {
   const bool bitx = cct->_conf->rgw_bucket_index_transaction_instrumentation;
   ldout_bitx_c(bitx, cct, 10) << "ENTERING " << __func__ << ": bucket-shard=" << bs <<
@@ -10448,6 +10812,13 @@ int RGWRados::cls_obj_complete_op(BucketShard& bs, const rgw_obj& obj, RGWModify
   ver.pool = pool;
   ver.epoch = epoch;
   cls_rgw_obj_key key(ent.key.name, ent.key.instance);
+  if (index_completion_manager->batch_completion(bs.bucket_obj, obj, op, tag, ver,
+                                                 key, dir_meta, remove_objs,
+                                                 log_op, bilog_flags, &zones_trace,
+                                                 obj.key.get_loc(), batch)) {
+    ldout_bitx_c(bitx, cct, 10) << "EXITING " << __func__ << ": batched" << dendl_bitx;
+    return 0;
+  }
   cls_rgw_guard_bucket_resharding(o, -ERR_BUSY_RESHARDING);
   cls_rgw_bucket_complete_op(o, op, tag, ver, key, dir_meta, remove_objs,
                              log_op, bilog_flags, &zones_trace, obj.key.get_loc());
@@ -10480,14 +10851,15 @@ int RGWRados::cls_obj_complete_del(BucketShard& bs, string& tag,
                                    list<rgw_obj_index_key> *remove_objs,
                                    uint16_t bilog_flags,
                                    rgw_zone_set *zones_trace,
-                                   bool log_op)
+                                   bool log_op,
+                                   bool batch)
 {
   rgw_bucket_dir_entry ent;
   ent.meta.mtime = removed_mtime;
   obj.key.get_index_key(&ent.key);
   return cls_obj_complete_op(bs, obj, CLS_RGW_OP_DEL, tag, pool, epoch,
 			     ent, RGWObjCategory::None, remove_objs,
-			     bilog_flags, zones_trace, log_op);
+			     bilog_flags, zones_trace, log_op, batch);
 }
 
 int RGWRados::cls_obj_complete_cancel(BucketShard& bs, string& tag, rgw_obj& obj,
@@ -10540,6 +10912,60 @@ uint32_t RGWRados::calc_ordered_bucket_list_per_shard(uint32_t num_entries,
 }
 
 
+// returns true if list_state belongs to this listing and the caller
+// continues after an entry it knows about; the entries returned after
+// start_after are then put back into the shards they came from
+static bool resume_ordered_list(RGWRados::OrderedListState& list_state,
+				const RGWBucketInfo& bucket_info,
+				const rgw::bucket_index_layout_generation& idx_layout,
+				const int shard_id,
+				const rgw_obj_index_key& start_after,
+				const std::string& prefix,
+				const std::string& delimiter,
+				const bool list_versions,
+				const std::map<int, std::string>& shard_oids)
+{
+  if (!list_state.valid ||
+      list_state.bucket_id != bucket_info.bucket.bucket_id ||
+      list_state.index_gen != idx_layout.gen ||
+      list_state.shard_id != shard_id ||
+      list_state.prefix != prefix ||
+      list_state.delimiter != delimiter ||
+      list_state.list_versions != list_versions ||
+      list_state.shards.size() != shard_oids.size()) {
+    return false;
+  }
+  for (const auto& [shard, oid] : shard_oids) {
+    auto i = list_state.shards.find(shard);
+    if (i == list_state.shards.end()) {
+      return false;
+    }
+    // older osds don't tell where to continue a truncated shard from
+    if (i->second.result.is_truncated && i->second.result.marker.empty()) {
+      return false;
+    }
+  }
+
+  auto& returned = list_state.returned;
+  auto resume_at = returned.end();
+  if (start_after != list_state.last_entry) {
+    resume_at = std::find_if(returned.begin(), returned.end(),
+			     [&start_after] (const auto& r) {
+			       return r.entry.key == start_after;
+			     });
+    if (resume_at == returned.end()) {
+      return false;
+    }
+    ++resume_at;
+  }
+  for (auto i = resume_at; i != returned.end(); ++i) {
+    list_state.shards[i->shard].result.dir.m.emplace(
+      std::move(i->name), std::move(i->entry));
+  }
+  returned.clear();
+  return true;
+}
+
 int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
                                       RGWBucketInfo& bucket_info,
                                       const rgw::bucket_index_layout_generation& idx_layout,
@@ -10555,7 +10981,8 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
 				      bool* cls_filtered,
 				      rgw_obj_index_key* last_entry,
                                       optional_yield y,
-				      RGWBucketListNameFilter force_check_filter)
+				      RGWBucketListNameFilter force_check_filter,
+				      OrderedListState* list_state)
 {
   const bool bitx = cct->_conf->rgw_bucket_index_transaction_instrumentation;
 
@@ -10635,17 +11062,71 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
   index_ver.pool = ioctx.get_id();
 
   std::map<int, rgw_cls_list_ret> shard_list_results;
-  cls_rgw_obj_key start_after_key(start_after.name, start_after.instance);
-  r = svc.bi_rados->list_objects(dpp, y, ioctx, shard_oids, start_after_key,
-                                 prefix, delimiter, num_entries_per_shard,
-                                 list_versions, shard_list_results);
-  if (r < 0) {
-    ldpp_dout(dpp, 0) << __func__ <<
-      ": CLSRGWIssueBucketList for " << bucket_info.bucket <<
-      " failed" << dendl;
-    return r;
+
+  // when continuing a listing, only query the shards whose known
+  // remaining entries may not be enough for this call; ask the shards
+  // that have been contributing the most entries for more of them
+  std::map<int, std::string> query_oids;
+  std::map<int, uint32_t> query_num_entries;
+  std::map<int, ent_map_t> known_entries;
+  if (list_state &&
+      !resume_ordered_list(*list_state, bucket_info, idx_layout, shard_id,
+			   start_after, prefix, delimiter, list_versions,
+			   shard_oids)) {
+    list_state->reset();
+  }
+  for (const auto& [shard, oid] : shard_oids) {
+    if (!list_state || !list_state->valid) {
+      query_oids.emplace(shard, oid);
+      continue;
+    }
+    auto& known = list_state->shards.at(shard);
+    const uint32_t want =
+      std::max(num_entries_per_shard,
+	       std::min(num_entries, 2 * known.consumed));
+    if (!known.result.is_truncated || known.result.dir.m.size() >= want) {
+      shard_list_results[shard] = std::move(known.result);
+      continue;
+    }
+    // read on from where the shard left off
+    shard_list_results[shard].marker = known.result.marker;
+    known_entries[shard] = std::move(known.result.dir.m);
+    query_oids.emplace(shard, oid);
+    query_num_entries[shard] = want;
+    ++list_state->shards_resumed;
   }
 
+  if (!query_oids.empty()) {
+    cls_rgw_obj_key start_after_key(start_after.name, start_after.instance);
+    r = svc.bi_rados->list_objects(dpp, y, ioctx, query_oids, start_after_key,
+				   prefix, delimiter, num_entries_per_shard,
+				   list_versions, shard_list_results,
+				   &query_num_entries);
+    if (r < 0) {
+      ldpp_dout(dpp, 0) << __func__ <<
+	": CLSRGWIssueBucketList for " << bucket_info.bucket <<
+	" failed" << dendl;
+      if (list_state) {
+	list_state->reset();
+      }
+      return r;
+    }
+  }
+  for (auto& [shard, entries] : known_entries) {
+    // all known entries sort before the ones just read
+    auto& m = shard_list_results[shard].dir.m;
+    m.insert(boost::container::ordered_unique_range,
+	     std::make_move_iterator(entries.begin()),
+	     std::make_move_iterator(entries.end()));
+  }
+  if (list_state) {
+    ++list_state->calls;
+    list_state->shard_ops += query_oids.size();
+  }
+  ldpp_dout(dpp, 10) << __func__ <<
+    ": queried " << query_oids.size() << " of " << shard_count <<
+    " shard(s)" << dendl;
+
   // to manage the iterators through each shard's list results
   struct ShardTracker {
     const size_t shard_idx;
@@ -10653,6 +11134,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     const std::string& oid_name;
     RGWRados::ent_map_t::iterator cursor;
     RGWRados::ent_map_t::iterator end;
+    uint32_t consumed = 0;
 
     // manages an iterator through a shard and provides other
     // accessors
@@ -10677,6 +11159,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     }
     inline ShardTracker& advance() {
       ++cursor;
+      ++consumed;
       // return a self-reference to allow for chaining of calls, such
       // as x.advance().at_end()
       return *this;
@@ -10729,6 +11212,9 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
 
   rgw_bucket_dir_entry*
     last_entry_visited = nullptr; // to set last_entry (marker)
+  // the shard and name of each entry put into m, to be able to resume
+  // after any of them
+  std::vector<std::pair<int, std::string>> returned;
   std::map<std::string, bufferlist> updates;
   uint32_t count = 0;
   while (count < num_entries && !candidates.empty()) {
@@ -10765,6 +11251,9 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
 	ldpp_dout(dpp, 0) << __func__ <<
 	  ": check_disk_state for \"" << dirent.key <<
 	  "\" failed with r=" << r << dendl;
+	if (list_state) {
+	  list_state->reset();
+	}
 	return r;
       }
     } else {
@@ -10782,6 +11271,9 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
       last_entry_visited = &it->second;
       if (inserted) {
 	++count;
+	if (list_state) {
+	  returned.emplace_back(tracker.shard_idx, name);
+	}
       } else {
 	ldpp_dout(dpp, 0) << "WARNING: " << __func__ <<
 	  " reassigned map value at \"" << name <<
@@ -10861,6 +11353,36 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
       count << ", which is truncated" << dendl;
   }
 
+  if (list_state) {
+    // remember what hasn't been returned yet for the next call
+    list_state->valid = (last_entry_visited != nullptr);
+    list_state->bucket_id = bucket_info.bucket.bucket_id;
+    list_state->index_gen = idx_layout.gen;
+    list_state->shard_id = shard_id;
+    list_state->prefix = prefix;
+    list_state->delimiter = delimiter;
+    list_state->list_versions = list_versions;
+    if (last_entry_visited != nullptr) {
+      list_state->last_entry = last_entry_visited->key;
+    }
+    list_state->shards.clear();
+    for (auto& t : results_trackers) {
+      auto& known = list_state->shards[t.shard_idx];
+      known.consumed = t.consumed;
+      const auto consumed_end = t.cursor - t.result.dir.m.begin();
+      known.result = std::move(t.result);
+      known.result.dir.m.erase(known.result.dir.m.begin(),
+			       known.result.dir.m.begin() + consumed_end);
+    }
+    list_state->returned.clear();
+    list_state->returned.reserve(returned.size());
+    for (auto& [shard, name] : returned) {
+      if (auto i = m.find(name); i != m.end()) {
+	list_state->returned.push_back({shard, std::move(name), i->second});
+      }
+    }
+  }
+
   if (last_entry_visited != nullptr && last_entry) {
     *last_entry = last_entry_visited->key;
     ldpp_dout(dpp, 20) << __func__ <<
@@ -339,6 +339,8 @@ using tombstone_cache_t = lru_map<rgw_obj, tombstone_entry>;
 
 class RGWIndexCompletionManager;
 
+struct rgw_bulk_fetch_entry;
+
 class RGWRados
 {
   friend class RGWGC;
@@ -890,8 +892,9 @@ public:
 	bool abortmp;
 	uint64_t parts_accounted_size;
 	obj_version *check_objv;
+        bool batch_index; // batch the index update with others on its shard
 
-        DeleteParams() : versioning_status(0), null_verid(false), olh_epoch(0), bilog_flags(0), remove_objs(NULL), high_precision_time(false), zones_trace(nullptr), abortmp(false), parts_accounted_size(0), check_objv(nullptr) {}
+        DeleteParams() : versioning_status(0), null_verid(false), olh_epoch(0), bilog_flags(0), remove_objs(NULL), high_precision_time(false), zones_trace(nullptr), abortmp(false), parts_accounted_size(0), check_objv(nullptr), batch_index(false) {}
       } params;
 
       struct DeleteResult {
@@ -940,6 +943,58 @@ public:
     }; // struct RGWRados::Object::Stat
   }; // class RGWRados::Object
 
+  /**
+   * What an ordered listing learned about each index shard and hasn't
+   * returned yet, carried from one cls_bucket_list_ordered() call to the
+   * next call of the same listing. When a call continues exactly where a
+   * previous one (or one of the entries it returned) left off, a shard
+   * is queried again only if its known entries may not be enough. A
+   * shard that has been fully read is never queried again. Shards that
+   * contributed the most entries are asked for more next time.
+   */
+  struct OrderedListState {
+    struct Shard {
+      // entries read from the shard but not returned yet, along with
+      // the shard's truncation state and marker to continue from
+      rgw_cls_list_ret result;
+      // number of entries consumed from the shard by the last call
+      uint32_t consumed = 0;
+    };
+
+    // the listing these shards belong to
+    std::string bucket_id;
+    uint64_t index_gen = 0;
+    int shard_id = RGW_NO_SHARD;
+    std::string prefix;
+    std::string delimiter;
+    bool list_versions = false;
+
+    struct Returned {
+      int shard;
+      std::string name;
+      rgw_bucket_dir_entry entry;
+    };
+
+    bool valid = false;
+    std::map<int, Shard> shards;
+    // entries returned by the last call, in order, with the shard they
+    // came from; the caller may resume after any of them
+    std::vector<Returned> returned;
+    // the last entry the last call visited
+    rgw_obj_index_key last_entry;
+
+    // statistics over the lifetime of the listing
+    uint64_t calls = 0;
+    uint64_t shard_ops = 0;
+    uint64_t shards_resumed = 0;
+
+    void reset() {
+      valid = false;
+      shards.clear();
+      returned.clear();
+    }
+  };
+
   class Bucket {
     RGWRados *store;
     RGWBucketInfo bucket_info;
@@ -969,6 +1024,7 @@ public:
       bool bs_initialized{false};
       bool blind;
       bool prepared{false};
+      bool batch{false};
       rgw_zone_set *zones_trace{nullptr};
 
       int init_bs(const DoutPrefixProvider *dpp, optional_yield y) {
@@ -1018,6 +1074,11 @@ public:
         zones_trace = _zones_trace;
       }
 
+      // let complete_del() wait to be sent with others for the same shard
+      void set_batch(bool b) {
+        batch = b;
+      }
+
       int prepare(const DoutPrefixProvider *dpp, RGWModifyOp, const std::string *write_tag, optional_yield y);
       int complete(const DoutPrefixProvider *dpp, int64_t poolid, uint64_t epoch, uint64_t size,
                    uint64_t accounted_size, const ceph::real_time& ut,
@@ -1053,6 +1114,9 @@ public:
 
       RGWRados::Bucket *target;
       rgw_obj_key next_marker;
+      // lets consecutive pages of an ordered listing through the same
+      // List reuse what earlier pages read from the index shards
+      OrderedListState list_state;
 
       int list_objects_ordered(const DoutPrefixProvider *dpp,
                                int64_t max,
@@ -1106,6 +1170,9 @@ public:
       rgw_obj_key& get_next_marker() {
         return next_marker;
       }
+      const OrderedListState& get_list_state() const {
+        return list_state;
+      }
     }; // class RGWRados::Bucket::List
   }; // class RGWRados::Bucket
 
@@ -1214,7 +1281,8 @@ public:
                        std::optional<rgw_zone_set_entry> source_trace_entry,
                        rgw_zone_set *zones_trace = nullptr,
                        std::optional<uint64_t>* bytes_transferred = 0,
-                       bool keep_tags = true);
+                       bool keep_tags = true,
+                       const rgw_bulk_fetch_entry* prefetched = nullptr);
   /**
    * Copy an object.
    * dest_obj: the object to copy into
@@ -1541,13 +1609,15 @@ public:
                          optional_yield y);
   int cls_obj_complete_op(BucketShard& bs, const rgw_obj& obj, RGWModifyOp op, std::string& tag, int64_t pool, uint64_t epoch,
                           rgw_bucket_dir_entry& ent, RGWObjCategory category, std::list<rgw_obj_index_key> *remove_objs,
-                          uint16_t bilog_flags, rgw_zone_set *zones_trace = nullptr, bool log_op = true);
+                          uint16_t bilog_flags, rgw_zone_set *zones_trace = nullptr, bool log_op = true,
+                          bool batch = false);
   int cls_obj_complete_add(BucketShard& bs, const rgw_obj& obj, std::string& tag, int64_t pool, uint64_t epoch, rgw_bucket_dir_entry& ent,
                            RGWObjCategory category, std::list<rgw_obj_index_key> *remove_objs, uint16_t bilog_flags,
                            rgw_zone_set *zones_trace = nullptr, bool log_op = true);
   int cls_obj_complete_del(BucketShard& bs, std::string& tag, int64_t pool, uint64_t epoch, rgw_obj& obj,
                            ceph::real_time& removed_mtime, std::list<rgw_obj_index_key> *remove_objs,
-                           uint16_t bilog_flags, rgw_zone_set *zones_trace = nullptr, bool log_op = true);
+                           uint16_t bilog_flags, rgw_zone_set *zones_trace = nullptr, bool log_op = true,
+                           bool batch = false);
   int cls_obj_complete_cancel(BucketShard& bs, std::string& tag, rgw_obj& obj,
                               std::list<rgw_obj_index_key> *remove_objs,
                               uint16_t bilog_flags, rgw_zone_set *zones_trace = nullptr, bool log_op = true);
@@ -1570,7 +1640,8 @@ public:
 			      bool* cls_filtered,
 			      rgw_obj_index_key *last_entry,
                               optional_yield y,
-			      RGWBucketListNameFilter force_check_filter = {});
+			      RGWBucketListNameFilter force_check_filter = {},
+			      OrderedListState* list_state = nullptr);
   int cls_bucket_list_unordered(const DoutPrefixProvider *dpp,
                                 RGWBucketInfo& bucket_info,
                                 const rgw::bucket_index_layout_generation& idx_layout,
@@ -1607,6 +1678,11 @@ public:
   int bi_list(const DoutPrefixProvider *dpp, rgw_bucket& bucket, const std::string& obj_name, const std::string& marker, uint32_t max,
               std::list<rgw_cls_bi_entry> *entries, bool *is_truncated, bool reshardlog, optional_yield y);
   int bi_remove(const DoutPrefixProvider *dpp, BucketShard& bs);
+  int reshard_log_trim_entries(const DoutPrefixProvider *dpp,
+                               const RGWBucketInfo& bucket_info,
+                               int shard_id,
+                               std::vector<rgw_cls_bi_entry> entries,
+                               optional_yield y);
 
 
   int cls_obj_usage_log_add(const DoutPrefixProvider *dpp, const std::string& oid, rgw_usage_log_info& info, optional_yield y);
@@ -1769,6 +1845,17 @@ struct get_obj_data {
   rgw::AioResultList completed; // completed read results, sorted by offset
   optional_yield yield;
 
+  // the read-ahead window, sized from the rate at which the client takes
+  // the data and the latency of the reads
+  struct read_window_t {
+    uint64_t chunk_size = 0; // reads are no larger than this
+    uint64_t max_window = 0; // 0 keeps the initial window
+    uint64_t window = 0;
+    double drain_rate = 0;   // bytes/s, moving average
+    double read_latency = 0; // seconds until a read is sent, moving average
+    std::map<uint64_t, ceph::mono_time> issued; // by read id
+  } read_window;
+
   get_obj_data(RGWRados* rgwrados, RGWGetDataCB* cb, rgw::Aio* aio,
                uint64_t offset, optional_yield yield)
                : rgwrados(rgwrados), client_cb(cb), aio(aio), offset(offset), yield(yield) {}
@@ -1783,6 +1870,15 @@ struct get_obj_data {
 
   int flush(rgw::AioResultList&& results);
 
+  void init_window(uint64_t chunk_size, uint64_t window, uint64_t max_window);
+  void note_read_issued(uint64_t id) {
+    if (read_window.max_window) {
+      read_window.issued.emplace(id, ceph::mono_clock::now());
+    }
+  }
+  void update_window(uint64_t id, uint64_t len, ceph::mono_time ready,
+                     ceph::timespan drain_time);
+
   void cancel() {
     // wait for all completions to drain and ignore the results
     aio->drain();
@@ -1190,6 +1190,118 @@ int RGWBucketReshard::reshard_process(const rgw::bucket_index_layout_generation&
   return 0;
 }
 
+// copy the entries logged by writes during the InLogrecord stage to
+// the target shards while writes are still allowed, and drop them from
+// the reshard log, so that as little as possible is left for the
+// InProgress stage where writes are blocked
+int RGWBucketReshard::catch_up_reshard_log(const rgw::bucket_index_layout_generation& current,
+                                           int max_op_entries,
+                                           BucketReshardManager& target_shards_mgr,
+                                           ostream *out,
+                                           const DoutPrefixProvider *dpp, optional_yield y)
+{
+  const auto& conf = store->ctx()->_conf;
+  const uint64_t max_passes =
+    conf.get_val<uint64_t>("rgw_reshard_log_catchup_max_passes");
+  const uint64_t catchup_entries =
+    conf.get_val<uint64_t>("rgw_reshard_log_catchup_entries");
+
+  const uint32_t num_source_shards = rgw::num_shards(current.layout.normal);
+  const std::string null_object_filter;
+  constexpr bool process_log = true;
+
+  for (uint64_t pass = 0; pass < max_passes; ++pass) {
+    uint64_t pass_entries = 0;
+    for (uint32_t i = 0; i < num_source_shards; ++i) {
+      std::string marker;
+      bool is_truncated = true;
+      while (is_truncated) {
+        list<rgw_cls_bi_entry> entries;
+        int ret = store->getRados()->bi_list(dpp, bucket_info, i, null_object_filter,
+                                             marker, max_op_entries, &entries,
+                                             &is_truncated, process_log, y);
+        if (ret == -ENOENT) {
+          break;
+        } else if (ret < 0) {
+          ldpp_dout(dpp, 0) << "ERROR: " << __func__ << " bi_list() failed: "
+              << cpp_strerror(-ret) << dendl;
+          return ret;
+        }
+        if (entries.empty()) {
+          break;
+        }
+        marker = entries.back().idx;
+
+        std::vector<rgw_cls_bi_entry> copied;
+        copied.reserve(entries.size());
+        for (auto& entry : entries) {
+          cls_rgw_obj_key cls_key;
+          RGWObjCategory category;
+          rgw_bucket_category_stats stats;
+          bool account = entry.get_info(&cls_key, &category, &stats);
+          rgw_obj_key key(cls_key);
+          if (entry.type == BIIndexType::OLH && key.empty()) {
+            // see reshard_process(), left for it to drop
+            continue;
+          }
+
+          int shard_index;
+          ret = calc_target_shard(bucket_info, key, shard_index, dpp);
+          if (ret < 0) {
+            return ret;
+          }
+          ret = target_shards_mgr.add_entry(shard_index, entry, account,
+                                            category, stats, process_log);
+          if (ret < 0) {
+            return ret;
+          }
+          copied.push_back(entry);
+        }
+        pass_entries += copied.size();
+
+        // the entries must be stored in the target shards before they
+        // can be dropped from the log
+        ret = target_shards_mgr.finish(process_log, this, dpp);
+        if (ret < 0) {
+          ldpp_dout(dpp, 0) << "ERROR: " << __func__ << " failed to copy "
+              "reshard log entries: " << cpp_strerror(-ret) << dendl;
+          return ret;
+        }
+
+        // entries overwritten since they were listed are kept, and
+        // copied again on a later pass
+        ret = store->getRados()->reshard_log_trim_entries(dpp, bucket_info, i,
+                                                          std::move(copied), y);
+        if (ret == -EOPNOTSUPP) {
+          // not an error, the osds can't trim entries yet. the entries
+          // copied so far stay in the log and are copied again by the
+          // replay of the InProgress stage
+          ldpp_dout(dpp, 0) << "WARNING: " << "reshard_log_trim_entries() is not "
+              "supported, falling back to the blocked replay of the reshard log"
+              << dendl;
+          return 0;
+        } else if (ret < 0) {
+          ldpp_dout(dpp, 0) << "ERROR: " << __func__ << " failed to trim "
+              "reshard log entries of shard " << i << ": "
+              << cpp_strerror(-ret) << dendl;
+          return ret;
+        }
+      }
+    }
+
+    ldpp_dout(dpp, 10) << __func__ << ": pass " << pass << " copied "
+        << pass_entries << " reshard log entries" << dendl;
+    if (out) {
+      (*out) << "log catch-up pass " << pass << ": " << pass_entries
+          << " entries" << std::endl;
+    }
+    if (pass_entries <= catchup_entries) {
+      break;
+    }
+  }
+  return 0;
+}
+
 int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& current,
                                  const rgw::bucket_index_layout_generation& target,
                                  int max_op_entries, // max num to process per op
@@ -1225,6 +1337,13 @@ int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& curr
       return ret;
     }
 
+    ret = catch_up_reshard_log(current, max_op_entries, target_shards_mgr,
+                               verbose_json_out ? nullptr : out, dpp, y);
+    if (ret < 0) {
+      ldpp_dout(dpp, 0) << __func__ << ": failed to catch up on reshard log ret = " << ret << dendl;
+      return ret;
+    }
+
     ret = change_reshard_state(store, bucket_info, bucket_attrs, fault, dpp, y);
     if (ret < 0) {
       return ret;
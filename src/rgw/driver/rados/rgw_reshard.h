@@ -94,6 +94,11 @@ class RGWBucketReshard {
                       std::ostream *out,
                       Formatter *formatter, rgw::BucketReshardState reshard_stage,
                       const DoutPrefixProvider *dpp, optional_yield y);
+  int catch_up_reshard_log(const rgw::bucket_index_layout_generation& current,
+                           int max_entries,
+                           BucketReshardManager& target_shards_mgr,
+                           std::ostream *out,
+                           const DoutPrefixProvider *dpp, optional_yield y);
 
   int do_reshard(const rgw::bucket_index_layout_generation& current,
                  const rgw::bucket_index_layout_generation& target,
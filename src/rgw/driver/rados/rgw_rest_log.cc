@@ -594,6 +594,164 @@ void RGWOp_BILog_Info::send_response() {
   flusher.flush();
 }
 
+int RGWOp_BILog_Fetch::fetch_obj(rgw::sal::Bucket* bucket,
+                                 const rgw_bulk_fetch_request& req,
+                                 uint64_t max_obj_size,
+                                 rgw_bulk_fetch_entry& entry,
+                                 optional_yield y)
+{
+  std::unique_ptr<rgw::sal::Object> obj = bucket->get_object(entry.key);
+  std::unique_ptr<rgw::sal::Object::ReadOp> read_op = obj->get_read_op();
+  int r = read_op->prepare(y, this);
+  if (r < 0) {
+    return r;
+  }
+
+  auto& attrs = obj->get_attrs();
+  // leave anything a sync GET would transform to the regular path
+  if (attrs.count(RGW_ATTR_COMPRESSION) || attrs.count(RGW_ATTR_CRYPT_MODE) ||
+      attrs.count(RGW_ATTR_USER_MANIFEST) || attrs.count(RGW_ATTR_SLO_MANIFEST) ||
+      attrs.count(RGW_ATTR_CLOUD_TIER_TYPE)) {
+    return -EOPNOTSUPP;
+  }
+  if (obj->get_size() > max_obj_size) {
+    return -EFBIG;
+  }
+
+  if (auto i = attrs.find(RGW_ATTR_OBJ_REPLICATION_TRACE); i != attrs.end()) {
+    try {
+      std::vector<rgw_zone_set_entry> zones;
+      auto p = i->second.cbegin();
+      decode(zones, p);
+      for (const auto& zone : zones) {
+        if (zone == req.dst_zone_trace) {
+          return -ERR_NOT_MODIFIED;
+        }
+      }
+    } catch (const buffer::error&) {}
+  }
+
+  bufferlist data;
+  for (uint64_t ofs = 0; ofs < obj->get_size(); ) {
+    bufferlist bl;
+    r = read_op->read(ofs, obj->get_size() - 1, bl, y, this);
+    if (r < 0) {
+      return r;
+    }
+    if (r == 0) {
+      return -EIO;
+    }
+    ofs += r;
+    data.claim_append(bl);
+  }
+
+  entry.mtime = obj->get_mtime();
+  entry.size = obj->get_size();
+  if (auto i = attrs.find(RGW_ATTR_ETAG); i != attrs.end()) {
+    entry.etag = i->second.to_str();
+  }
+  try {
+    if (auto i = attrs.find(RGW_ATTR_PG_VER); i != attrs.end() && i->second.length()) {
+      auto p = i->second.cbegin();
+      decode(entry.pg_ver, p);
+    }
+    if (auto i = attrs.find(RGW_ATTR_SOURCE_ZONE); i != attrs.end() && i->second.length()) {
+      auto p = i->second.cbegin();
+      decode(entry.zone_short_id, p);
+    }
+    if (auto i = attrs.find(RGW_ATTR_INTERNAL_MTIME); i != attrs.end()) {
+      auto p = i->second.cbegin();
+      decode(entry.internal_mtime, p);
+    }
+  } catch (const buffer::error&) {
+    ldpp_dout(this, 0) << "ERROR: failed to decode object version attrs, ignoring" << dendl;
+  }
+
+  /* same layout as the prepended metadata of a sync GET */
+  JSONFormatter jf;
+  jf.open_object_section("obj_metadata");
+  encode_json("attrs", attrs, &jf);
+  utime_t ut(entry.mtime);
+  encode_json("mtime", ut, &jf);
+  jf.close_section();
+  stringstream ss;
+  jf.flush(ss);
+  entry.body.append(ss.str());
+  entry.metadata_len = entry.body.length();
+  entry.body.claim_append(data);
+  return 0;
+}
+
+void RGWOp_BILog_Fetch::execute(optional_yield y) {
+  constexpr size_t max_request_len = 4 * 1024 * 1024;
+  bufferlist in;
+  std::tie(op_ret, in) = rgw_rest_read_all_input(s, max_request_len);
+  if (op_ret < 0) {
+    return;
+  }
+
+  rgw_bulk_fetch_request req;
+  try {
+    auto p = in.cbegin();
+    decode(req, p);
+  } catch (const buffer::error&) {
+    ldpp_dout(this, 5) << "ERROR: failed to decode bulk fetch request" << dendl;
+    op_ret = -EINVAL;
+    return;
+  }
+
+  auto cct = s->cct;
+  const uint64_t max_entries =
+    cct->_conf.get_val<uint64_t>("rgw_sync_bulk_fetch_max_entries");
+  const uint64_t max_bytes =
+    cct->_conf.get_val<Option::size_t>("rgw_sync_bulk_fetch_max_bytes");
+  const uint64_t max_obj_size = std::min<uint64_t>(
+    req.max_obj_size,
+    cct->_conf.get_val<Option::size_t>("rgw_sync_bulk_fetch_max_obj_size"));
+  if (req.keys.size() > max_entries) {
+    req.keys.resize(max_entries);
+  }
+
+  std::unique_ptr<rgw::sal::Bucket> bucket;
+  op_ret = driver->load_bucket(s, req.bucket, &bucket, y);
+  if (op_ret < 0) {
+    ldpp_dout(this, 5) << "could not get bucket info for bucket="
+        << req.bucket << dendl;
+    return;
+  }
+
+  uint64_t total = 0;
+  result.entries.reserve(req.keys.size());
+  for (const auto& key : req.keys) {
+    auto& entry = result.entries.emplace_back();
+    entry.key = key;
+    if (total >= max_bytes) {
+      // the rest is fetched individually
+      entry.status = -EAGAIN;
+      continue;
+    }
+    entry.status = fetch_obj(bucket.get(), req, max_obj_size, entry, y);
+    total += entry.body.length();
+  }
+  op_ret = 0;
+}
+
+void RGWOp_BILog_Fetch::send_response() {
+  bufferlist bl;
+  if (op_ret >= 0) {
+    encode(result, bl);
+  }
+
+  set_req_state_err(s, op_ret);
+  dump_errno(s);
+  end_header(s, this, "application/octet-stream", bl.length(), true);
+
+  if (op_ret < 0) {
+    return;
+  }
+  dump_body(s, bl);
+}
+
 void RGWOp_BILog_Delete::execute(optional_yield y) {
   bool gen_specified = false;
   string tenant_name = s->info.args.get("tenant"),
@@ -1279,6 +1437,10 @@ RGWOp *RGWHandler_Log::op_post() {
       return new RGWOp_MDLog_Unlock;
     else if (s->info.args.exists("notify"))
       return new RGWOp_MDLog_Notify;
+  } else if (type.compare("bucket-index") == 0) {
+    if (s->info.args.exists("fetch")) {
+      return new RGWOp_BILog_Fetch;
+    }
   } else if (type.compare("data") == 0) {
     if (s->info.args.exists("notify")) {
       return new RGWOp_DATALog_Notify;
@@ -21,6 +21,7 @@
 #include "rgw_metadata.h"
 #include "rgw_mdlog.h"
 #include "rgw_data_sync.h"
+#include "rgw_sync_bulk_fetch.h"
 
 class RGWOp_BILog_List : public RGWRESTOp {
   bool sent_header;
@@ -87,6 +88,33 @@ public:
   }
 };
 
+class RGWOp_BILog_Fetch : public RGWRESTOp {
+  rgw_bulk_fetch_result result;
+
+  int fetch_obj(rgw::sal::Bucket* bucket, const rgw_bulk_fetch_request& req,
+                uint64_t max_obj_size, rgw_bulk_fetch_entry& entry,
+                optional_yield y);
+public:
+  RGWOp_BILog_Fetch() {}
+  ~RGWOp_BILog_Fetch() override {}
+
+  int check_caps(const RGWUserCaps& caps) override {
+    return caps.check_cap("bilog", RGW_CAP_READ);
+  }
+  int verify_permission(optional_yield y) override {
+    // object data is only handed out to other zones
+    if (!s->system_request) {
+      return -EPERM;
+    }
+    return check_caps(s->user->get_caps());
+  }
+  void send_response() override;
+  void execute(optional_yield y) override;
+  const char* name() const override {
+    return "bucket_index_log_fetch";
+  }
+};
+
 class RGWOp_MDLog_List : public RGWRESTOp {
   std::vector<cls::log::entry> entries;
   std::string last_marker;
@@ -3616,6 +3616,7 @@ int RadosObject::RadosDeleteOp::delete_obj(const DoutPrefixProvider* dpp, option
   parent_op.params.abortmp = params.abortmp;
   parent_op.params.parts_accounted_size = params.parts_accounted_size;
   parent_op.params.null_verid = params.null_verid;
+  parent_op.params.batch_index = flags & FLAG_BATCH_INDEX;
   if (params.objv_tracker) {
       parent_op.params.check_objv = params.objv_tracker->version_for_check();
   }
@@ -3788,35 +3789,25 @@ int RadosMultipartUpload::cleanup_orphaned_parts(const DoutPrefixProvider *dpp,
           }
         }
       }
-      cleanup_part_history(dpp, y, part, remove_objs, part_prefixes);
+      cleanup_part_history(dpp, y, part, remove_objs, part_prefixes, &chain);
     }
   } while (truncated);
 
-  if (store->getRados()->get_gc() == nullptr) {
-    //Delete objects inline if gc hasn't been initialised (in case when bypass gc is specified)
-    store->getRados()->delete_objs_inline(dpp, chain, mp_obj.get_upload_id(), y);
-  } else {
-    /* use upload id as tag and do it synchronously */
-    auto [ret, leftover_chain] = store->getRados()->send_chain_to_gc(chain, mp_obj.get_upload_id(), y);
-    if (ret < 0 && leftover_chain) {
-      ldpp_dout(dpp, 5) << __func__ << ": gc->send_chain() returned " << ret << dendl;
-      if (ret == -ENOENT) {
-        return -ERR_NO_SUCH_UPLOAD;
-      }
-      //Delete objects inline if send chain to gc fails
-      store->getRados()->delete_objs_inline(dpp, *leftover_chain, mp_obj.get_upload_id(), y);
-    }
-  }
-  return 0;
+  return remove_part_objs(dpp, y, chain);
 }
 
 int RadosMultipartUpload::cleanup_part_history(const DoutPrefixProvider* dpp,
                                                optional_yield y,
                                                RadosMultipartPart *part,
                                                list<rgw_obj_index_key>& remove_objs,
-                                               boost::container::flat_set<std::string>& processed_prefixes)
+                                               boost::container::flat_set<std::string>& processed_prefixes,
+                                               cls_rgw_obj_chain* chain)
 {
-  cls_rgw_obj_chain chain;
+  // without a chain from the caller, remove this part's objects right away
+  cls_rgw_obj_chain part_chain;
+  if (!chain) {
+    chain = &part_chain;
+  }
   for (auto& ppfx : part->get_past_prefixes()) {
     auto [it, inserted] = processed_prefixes.emplace(ppfx);
     if (!inserted) {
@@ -3836,9 +3827,19 @@ int RadosMultipartUpload::cleanup_part_history(const DoutPrefixProvider* dpp,
     for (; miter != manifest.obj_end(dpp); ++miter) {
       rgw_raw_obj raw_part_obj = miter.get_location().get_raw_obj(store->getRados());
       cls_rgw_obj_key part_key(raw_part_obj.oid);
-      chain.push_obj(raw_part_obj.pool.to_str(), part_key, raw_part_obj.loc);
+      chain->push_obj(raw_part_obj.pool.to_str(), part_key, raw_part_obj.loc);
     }
   }
+  if (chain == &part_chain) {
+    return remove_part_objs(dpp, y, part_chain);
+  }
+  return 0;
+}
+
+int RadosMultipartUpload::remove_part_objs(const DoutPrefixProvider* dpp,
+                                           optional_yield y,
+                                           cls_rgw_obj_chain& chain)
+{
   if (store->getRados()->get_gc() == nullptr) {
     // Delete objects inline if gc hasn't been initialised (in case when bypass gc is specified)
     store->getRados()->delete_objs_inline(dpp, chain, mp_obj.get_upload_id(), y);
@@ -4142,6 +4143,99 @@ int RadosMultipartUpload::list_parts(const DoutPrefixProvider *dpp, CephContext
   return 0;
 }
 
+namespace {
+
+// Reads the part entries of a sorted (v2) multipart upload for
+// CompleteMultipartUpload in pages of max_parts. The request names every
+// part, so the omap position of each page is known up front and up to
+// max_pending pages are read at once.
+class PartPageReader {
+ public:
+  struct page_t {
+    std::map<int, std::string>::const_iterator first; // first part of the page
+    uint64_t count = 0; // parts of the request in this page
+    bool last = false;
+    std::string after;
+    std::map<std::string, bufferlist> entries;
+    bool more = false;
+    int r = 0;
+    bool ready = false;
+  };
+
+ private:
+  rgw_rados_ref ref;
+  std::unique_ptr<rgw::Aio> aio;
+  std::vector<page_t> pages;
+  size_t issued = 0;
+  size_t consumed = 0;
+  const uint64_t max_pending;
+  optional_yield y;
+
+  void complete(rgw::AioResultList&& results) {
+    for (auto& r : results) {
+      auto& page = pages[r.id];
+      page.ready = true;
+      if (r.result < 0) {
+        page.r = r.result;
+      }
+    }
+  }
+
+ public:
+  PartPageReader(rgw_rados_ref ref, const std::map<int, std::string>& part_etags,
+                 uint64_t max_parts, uint64_t max_pending, optional_yield y)
+    : ref(std::move(ref)), aio(rgw::make_throttle(max_pending, y)),
+      max_pending(max_pending), y(y)
+  {
+    char buf[32];
+    int prev = 0;
+    auto i = part_etags.begin();
+    while (i != part_etags.end()) {
+      auto& page = pages.emplace_back();
+      page.first = i;
+      snprintf(buf, sizeof(buf), "part.%08d", prev);
+      page.after = buf;
+      for (; i != part_etags.end() && page.count < max_parts; ++i) {
+        prev = i->first;
+        ++page.count;
+      }
+    }
+    if (!pages.empty()) {
+      pages.back().last = true;
+    }
+  }
+  ~PartPageReader() {
+    // the pending reads write into pages
+    aio->drain();
+  }
+
+  // returns the next page in order, or nullptr after the last one
+  page_t* next() {
+    if (consumed == pages.size()) {
+      return nullptr;
+    }
+    for (;;) {
+      while (issued < pages.size() && issued < consumed + max_pending) {
+        auto& page = pages[issued];
+        // one more entry on the last page tells whether parts that the
+        // request doesn't name follow
+        librados::ObjectReadOperation op;
+        op.omap_get_vals2(page.after, page.count + (page.last ? 1 : 0),
+                          &page.entries, &page.more, &page.r);
+        complete(aio->get(ref.obj, rgw::Aio::librados_op(ref.ioctx, std::move(op), y),
+                          1, issued));
+        ++issued;
+      }
+      if (pages[consumed].ready) {
+        return &pages[consumed++];
+      }
+      complete(aio->wait());
+    }
+  }
+};
+
+} // anonymous namespace
+
 int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
 				   optional_yield y, CephContext* cct,
 				   map<int, string>& part_etags,
@@ -4172,9 +4266,75 @@ int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
   uint64_t min_part_size = cct->_conf->rgw_multipart_min_part_size;
   auto etags_iter = part_etags.begin();
   rgw::sal::Attrs& attrs = target_obj->get_attrs();
+  cls_rgw_obj_chain chain; // objects of replaced part uploads
+
+  std::optional<PartPageReader> reader;
+  const auto max_pending_reads =
+    cct->_conf.get_val<uint64_t>("rgw_multipart_complete_concurrent_reads");
+  if (max_pending_reads > 0 && is_v2_upload_id(get_upload_id())) {
+    rgw_obj meta_obj(bucket->get_key(),
+                     rgw_obj_key(get_meta(), std::string(), RGW_OBJ_NS_MULTIPART));
+    meta_obj.in_extra_data = true;
+    rgw_raw_obj raw_obj;
+    store->getRados()->obj_to_raw(bucket->get_placement_rule(), meta_obj, &raw_obj);
+    rgw_rados_ref ref;
+    if (rgw_get_rados_ref(dpp, store->getRados()->get_rados_handle(),
+                          raw_obj, &ref) >= 0) {
+      reader.emplace(std::move(ref), part_etags, max_parts, max_pending_reads, y);
+    }
+  }
+
+  // decodes the next page of the reader into parts. returns -EAGAIN if the
+  // page doesn't hold exactly the parts named by the request, so that
+  // list_parts() takes over from there and reports the mismatch
+  auto read_page = [&] () -> int {
+    auto page = reader->next();
+    if (!page) {
+      return -EAGAIN;
+    }
+    if (page->r < 0) {
+      return page->r;
+    }
+    if (page->entries.size() != page->count || (page->last && page->more)) {
+      return -EAGAIN;
+    }
+    parts.clear();
+    auto etag = page->first;
+    for (auto& [key, bl] : page->entries) {
+      auto part = std::make_unique<RadosMultipartPart>();
+      try {
+        auto bli = bl.cbegin();
+        decode(part->info, bli);
+      } catch (buffer::error& err) {
+        ldpp_dout(dpp, 0) << "ERROR: could not part info, caught buffer::error" <<
+          dendl;
+        return -EIO;
+      }
+      if ((int)part->info.num != etag->first) {
+        return -EAGAIN;
+      }
+      ++etag;
+      parts[part->info.num] = std::move(part);
+    }
+    page->entries.clear();
+    marker = parts.rbegin()->first;
+    truncated = !page->last;
+    return 0;
+  };
 
   do {
-    ret = list_parts(dpp, cct, max_parts, marker, &marker, &truncated, y);
+    ret = -EAGAIN;
+    if (reader) {
+      ret = read_page();
+      if (ret == -EAGAIN) {
+        ldpp_dout(dpp, 10) << "unexpected parts after part " << marker
+            << ", listing the rest in order" << dendl;
+        reader.reset();
+      }
+    }
+    if (ret == -EAGAIN) {
+      ret = list_parts(dpp, cct, max_parts, marker, &marker, &truncated, y);
+    }
     if (ret == -ENOENT) {
       ret = -ERR_NO_SUCH_UPLOAD;
     }
@@ -4284,12 +4444,15 @@ int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
 
       remove_objs.push_back(remove_key);
 
-      cleanup_part_history(dpp, y, part, remove_objs, it->second);
+      cleanup_part_history(dpp, y, part, remove_objs, it->second, &chain);
 
       ofs += obj_part.size;
       accounted_size += obj_part.accounted_size;
     }
   } while (truncated);
+  reader.reset();
+
+  remove_part_objs(dpp, y, chain);
   hash.Final((unsigned char *)final_etag);
 
   buf_to_hex((unsigned char *)final_etag, sizeof(final_etag), final_etag_str);
@@ -4674,6 +4837,68 @@ int RadosLifecycle::put_head(const DoutPrefixProvider* dpp, optional_yield y,
   return rgw_rados_operate(dpp, ioctx, oid, std::move(op), y);
 }
 
+// the progress of each bucket is kept in the omap of its own object
+static std::string lc_progress_oid(const std::string& bucket)
+{
+  return "lc_progress." + bucket;
+}
+
+int RadosLifecycle::get_bucket_progress(const DoutPrefixProvider* dpp,
+                                        optional_yield y,
+                                        const std::string& bucket,
+                                        std::map<std::string, rgw_obj_key>& markers)
+{
+  std::map<std::string, bufferlist> vals;
+  int rval = 0;
+  librados::ObjectReadOperation op;
+  op.omap_get_vals2("", std::numeric_limits<uint64_t>::max(), &vals, nullptr, &rval);
+
+  auto& ioctx = *store->getRados()->get_lc_pool_ctx();
+  int ret = rgw_rados_operate(dpp, ioctx, lc_progress_oid(bucket), std::move(op), nullptr, y);
+  if (ret < 0) {
+    return ret;
+  }
+
+  markers.clear();
+  try {
+    for (auto& [key, bl] : vals) {
+      auto p = bl.cbegin();
+      decode(markers[key], p);
+    }
+  } catch (const buffer::error&) {
+    return -EIO;
+  }
+  return 0;
+}
+
+int RadosLifecycle::set_bucket_progress(const DoutPrefixProvider* dpp,
+                                        optional_yield y,
+                                        const std::string& bucket,
+                                        const std::map<std::string, rgw_obj_key>& markers)
+{
+  std::map<std::string, bufferlist> vals;
+  for (const auto& [key, marker] : markers) {
+    encode(marker, vals[key]);
+  }
+  librados::ObjectWriteOperation op;
+  op.omap_set(vals);
+
+  auto& ioctx = *store->getRados()->get_lc_pool_ctx();
+  return rgw_rados_operate(dpp, ioctx, lc_progress_oid(bucket), std::move(op), y);
+}
+
+int RadosLifecycle::rm_bucket_progress(const DoutPrefixProvider* dpp,
+                                       optional_yield y,
+                                       const std::string& bucket)
+{
+  librados::ObjectWriteOperation op;
+  op.remove();
+
+  auto& ioctx = *store->getRados()->get_lc_pool_ctx();
+  int ret = rgw_rados_operate(dpp, ioctx, lc_progress_oid(bucket), std::move(op), y);
+  return ret == -ENOENT ? 0 : ret;
+}
+
 std::unique_ptr<LCSerializer> RadosLifecycle::get_serializer(const std::string& lock_name,
 							     const std::string& oid,
 							     const std::string& cookie)
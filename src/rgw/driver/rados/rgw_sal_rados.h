@@ -896,7 +896,10 @@ protected:
                            optional_yield y,
                            RadosMultipartPart* part,
                            std::list<rgw_obj_index_key>& remove_objs,
-                           boost::container::flat_set<std::string>& processed_prefixes);
+                           boost::container::flat_set<std::string>& processed_prefixes,
+                           cls_rgw_obj_chain* chain = nullptr);
+  int remove_part_objs(const DoutPrefixProvider* dpp, optional_yield y,
+                       cls_rgw_obj_chain& chain);
 };
 
 class MPRadosSerializer : public StoreMPSerializer {
@@ -945,6 +948,14 @@ public:
                        const std::string& oid, LCHead& head) override;
   virtual int put_head(const DoutPrefixProvider* dpp, optional_yield y,
                        const std::string& oid, const LCHead& head) override;
+  virtual int get_bucket_progress(const DoutPrefixProvider* dpp, optional_yield y,
+                                  const std::string& bucket,
+                                  std::map<std::string, rgw_obj_key>& markers) override;
+  virtual int set_bucket_progress(const DoutPrefixProvider* dpp, optional_yield y,
+                                  const std::string& bucket,
+                                  const std::map<std::string, rgw_obj_key>& markers) override;
+  virtual int rm_bucket_progress(const DoutPrefixProvider* dpp, optional_yield y,
+                                 const std::string& bucket) override;
   virtual std::unique_ptr<LCSerializer> get_serializer(const std::string& lock_name,
 						       const std::string& oid,
 						       const std::string& cookie) override;
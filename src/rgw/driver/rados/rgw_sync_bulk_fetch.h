@@ -0,0 +1,120 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "include/buffer.h"
+#include "include/encoding.h"
+#include "common/ceph_time.h"
+#include "rgw_common.h"
+#include "cls/rgw/cls_rgw_types.h"
+
+/*
+ * Bulk object fetch for multisite sync.
+ *
+ * Instead of one GET per object, data sync can ask the source zone for
+ * up to rgw_sync_bulk_fetch_max_entries small objects in one
+ * POST /admin/log?type=bucket-index&fetch request. The response carries,
+ * for each object, the same body a sync GET with rgwx-prepend-metadata
+ * would have returned, so the destination writes it through the regular
+ * fetch_remote_obj() path.
+ *
+ * Objects that need server side processing (compressed, encrypted,
+ * manifests, cloud tiered) or are too large are returned with an error
+ * status and fetched individually as before.
+ */
+
+struct rgw_bulk_fetch_request {
+  rgw_bucket bucket;
+  std::vector<rgw_obj_key> keys;
+  uint64_t max_obj_size{0};
+  // objects already replicated to this entry are reported as not modified
+  rgw_zone_set_entry dst_zone_trace;
+
+  void encode(bufferlist& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(bucket, bl);
+    encode(keys, bl);
+    encode(max_obj_size, bl);
+    encode(dst_zone_trace, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(bufferlist::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(bucket, bl);
+    decode(keys, bl);
+    decode(max_obj_size, bl);
+    decode(dst_zone_trace, bl);
+    DECODE_FINISH(bl);
+  }
+};
+WRITE_CLASS_ENCODER(rgw_bulk_fetch_request)
+
+struct rgw_bulk_fetch_entry {
+  rgw_obj_key key;
+  // 0, -ERR_NOT_MODIFIED, or an error asking for an individual fetch
+  int32_t status{0};
+  std::string etag;
+  ceph::real_time mtime;
+  // later than mtime if only the metadata changed since
+  ceph::real_time internal_mtime;
+  uint32_t zone_short_id{0};
+  uint64_t pg_ver{0};
+  uint64_t size{0};
+  // JSON encoded attrs and mtime followed by the object data
+  uint64_t metadata_len{0};
+  bufferlist body;
+
+  void encode(bufferlist& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(key, bl);
+    encode(status, bl);
+    encode(etag, bl);
+    encode(mtime, bl);
+    encode(internal_mtime, bl);
+    encode(zone_short_id, bl);
+    encode(pg_ver, bl);
+    encode(size, bl);
+    encode(metadata_len, bl);
+    encode(body, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(bufferlist::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(key, bl);
+    decode(status, bl);
+    decode(etag, bl);
+    decode(mtime, bl);
+    decode(internal_mtime, bl);
+    decode(zone_short_id, bl);
+    decode(pg_ver, bl);
+    decode(size, bl);
+    decode(metadata_len, bl);
+    decode(body, bl);
+    DECODE_FINISH(bl);
+  }
+};
+WRITE_CLASS_ENCODER(rgw_bulk_fetch_entry)
+
+struct rgw_bulk_fetch_result {
+  std::vector<rgw_bulk_fetch_entry> entries;
+
+  void encode(bufferlist& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(entries, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(bufferlist::const_iterator& bl) {
+    DECODE_START(1, bl);
+    decode(entries, bl);
+    DECODE_FINISH(bl);
+  }
+};
+WRITE_CLASS_ENCODER(rgw_bulk_fetch_result)
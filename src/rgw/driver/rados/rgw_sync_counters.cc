@@ -17,6 +17,10 @@ PerfCountersRef build(CephContext *cct, const std::string& name)
   b.add_u64_avg(l_fetch, "fetch_bytes", "Number of object bytes replicated");
   b.add_u64_counter(l_fetch_not_modified, "fetch_not_modified", "Number of objects already replicated");
   b.add_u64_counter(l_fetch_err, "fetch_errors", "Number of object replication errors");
+  b.add_time_avg(l_fetch_lat, "fetch_latency", "Average latency of object replication");
+  b.add_u64(l_fetch_bandwidth, "fetch_bandwidth", "Object bytes replicated per second, sampled by bucket sync");
+  b.add_u64(l_fetch_window, "fetch_window", "Current bucket sync spawn window");
+  b.add_u64_counter(l_fetch_bulk, "fetch_bulk", "Number of objects replicated through bulk fetches");
 
   b.add_time_avg(l_poll, "poll_latency", "Average latency of replication log requests");
   b.add_u64_counter(l_poll_err, "poll_errors", "Number of replication log request errors");
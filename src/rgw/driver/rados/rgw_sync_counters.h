@@ -13,6 +13,10 @@ enum {
   l_fetch,
   l_fetch_not_modified,
   l_fetch_err,
+  l_fetch_lat,
+  l_fetch_bandwidth,
+  l_fetch_window,
+  l_fetch_bulk,
 
   l_poll,
   l_poll_err,
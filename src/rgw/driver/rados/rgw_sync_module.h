@@ -39,6 +39,12 @@ public:
                                       bool versioned, uint64_t versioned_epoch, rgw_zone_set *zones_trace) = 0;
   virtual RGWCoroutine *create_delete_marker(const DoutPrefixProvider *dpp, RGWDataSyncCtx *sc, rgw_bucket_sync_pipe& bucket_info, rgw_obj_key& key, real_time& mtime,
                                              rgw_bucket_entry_owner& owner, bool versioned, uint64_t versioned_epoch, rgw_zone_set *zones_trace) = 0;
+
+  // whether sync_object() copies the object data from the source zone,
+  // and so can use objects prefetched in bulk
+  virtual bool fetches_objects() const {
+    return false;
+  }
 };
 
 class RGWRESTMgr;
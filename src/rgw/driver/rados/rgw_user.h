@@ -78,9 +78,11 @@ struct bucket_meta_entry {
   uint64_t count;
 };
 
+/* sync the stats of each bucket of an owner, up to max_aio buckets at a time */
 int rgw_sync_all_stats(const DoutPrefixProvider *dpp,
                        optional_yield y, rgw::sal::Driver* driver,
-                       const rgw_owner& owner, const std::string& tenant);
+                       const rgw_owner& owner, const std::string& tenant,
+                       int max_aio = 1);
 extern int rgw_user_get_all_buckets_stats(const DoutPrefixProvider *dpp,
   rgw::sal::Driver* driver, rgw::sal::User* user,
   std::map<std::string, bucket_meta_entry>& buckets_usage_map, optional_yield y);
@@ -480,12 +480,15 @@ void usage()
   cout << "                                     object deletions by not involving GC\n";
   cout << "   --inconsistent-index              when specified with bucket deletion and bypass-gc set to true,\n";
   cout << "                                     ignores bucket index consistency\n";
+  cout << "   --benchmark                       when specified with bucket list, time the ordered listing\n";
+  cout << "                                     and report index shard ops per page instead of the entries\n";
   cout << "   --min-rewrite-size                min object size for bucket rewrite (default 4M)\n";
   cout << "   --max-rewrite-size                max object size for bucket rewrite (default ULLONG_MAX)\n";
   cout << "   --min-rewrite-stripe-size         min stripe size for object rewrite (default 0)\n";
   cout << "   --trim-delay-ms                   time interval in msec to limit the frequency of sync error log entries trimming operations,\n";
   cout << "                                     the trimming process will sleep the specified msec for every 1000 entries trimmed\n";
-  cout << "   --max-concurrent-ios              maximum concurrent ios for bucket operations (default: 32)\n";
+  cout << "   --max-concurrent-ios              maximum concurrent ios for bucket operations, bucket\n"
+          "                                     stats and user stats --sync-stats (default: 32)\n";
   cout << "   --enable-feature                  enable a zone/zonegroup feature\n";
   cout << "   --disable-feature                 disable a zone/zonegroup feature\n";
   cout << "\n";
@@ -3703,6 +3706,7 @@ int main(int argc, const char **argv)
   int bypass_gc = false;
   int warnings_only = false;
   int inconsistent_index = false;
+  int benchmark = false;
 
   int verbose = false;
 
@@ -4121,6 +4125,8 @@ int main(int argc, const char **argv)
      // do nothing
     } else if (ceph_argparse_binary_flag(args, i, &inconsistent_index, NULL, "--inconsistent-index", (char*)NULL)) {
      // do nothing
+    } else if (ceph_argparse_binary_flag(args, i, &benchmark, NULL, "--benchmark", (char*)NULL)) {
+     // do nothing
     } else if (ceph_argparse_flag(args, i, "--hide-progress", (char*)NULL)) {
       hide_progress = true;
     } else if (ceph_argparse_flag(args, i, "--dump-keys", (char*)NULL)) {
@@ -7517,7 +7523,6 @@ int main(int argc, const char **argv)
         cerr << "ERROR: could not init bucket: " << cpp_strerror(-ret) << std::endl;
         return -ret;
       }
-      formatter->open_array_section("entries");
 
       int count = 0;
 
@@ -7529,6 +7534,84 @@ int main(int argc, const char **argv)
       }
       const int paginate_size = std::min(max_entries, MAX_PAGINATE_SIZE);
 
+      if (benchmark) {
+	if (allow_unordered) {
+	  cerr << "ERROR: --benchmark measures the ordered listing, it "
+	    "cannot be used with --allow-unordered" << std::endl;
+	  return EINVAL;
+	}
+	RGWRados::Bucket target(static_cast<rgw::sal::RadosStore*>(driver)->getRados(),
+				bucket->get_info());
+	RGWRados::Bucket::List list_op(&target);
+	list_op.params.marker = rgw_obj_key(marker);
+	list_op.params.enforce_ns = false;
+	list_op.params.list_versions = true;
+
+	uint64_t pages = 0;
+	uint64_t prev_calls = 0;
+	uint64_t prev_ops = 0;
+	ceph::timespan total_latency{};
+	ceph::timespan max_latency{};
+	bool is_truncated = false;
+
+	formatter->open_object_section("benchmark");
+	formatter->dump_string("bucket", bucket_name);
+	formatter->dump_unsigned("index_shards",
+	  rgw::num_shards(bucket->get_info().layout.current_index.layout));
+	formatter->dump_int("page_size", paginate_size);
+	formatter->open_array_section("pages");
+	do {
+	  std::vector<rgw_bucket_dir_entry> objs;
+	  std::map<std::string, bool> common_prefixes;
+	  const int remaining = max_entries - count;
+	  auto start = ceph::mono_clock::now();
+	  ret = list_op.list_objects(dpp(), std::min(remaining, paginate_size),
+				     &objs, &common_prefixes, &is_truncated,
+				     null_yield);
+	  auto latency = ceph::mono_clock::now() - start;
+	  if (ret < 0) {
+	    cerr << "ERROR: list_objects(): " << cpp_strerror(-ret) << std::endl;
+	    return -ret;
+	  }
+	  list_op.params.marker = list_op.get_next_marker();
+	  count += objs.size();
+	  ++pages;
+	  total_latency += latency;
+	  max_latency = std::max(max_latency, latency);
+
+	  const auto& list_state = list_op.get_list_state();
+	  formatter->open_object_section("page");
+	  formatter->dump_unsigned("entries", objs.size());
+	  formatter->dump_unsigned("cls_calls", list_state.calls - prev_calls);
+	  formatter->dump_unsigned("shard_ops", list_state.shard_ops - prev_ops);
+	  formatter->dump_float("latency_ms",
+	    std::chrono::duration<double, std::milli>(latency).count());
+	  formatter->close_section();
+	  formatter->flush(cout);
+	  prev_calls = list_state.calls;
+	  prev_ops = list_state.shard_ops;
+	} while (is_truncated && count < max_entries);
+	formatter->close_section(); // pages
+
+	const auto& list_state = list_op.get_list_state();
+	formatter->dump_unsigned("total_pages", pages);
+	formatter->dump_int("total_entries", count);
+	formatter->dump_unsigned("total_cls_calls", list_state.calls);
+	formatter->dump_unsigned("total_shard_ops", list_state.shard_ops);
+	formatter->dump_unsigned("shards_resumed", list_state.shards_resumed);
+	formatter->dump_float("shard_ops_per_page",
+	  pages ? double(list_state.shard_ops) / pages : 0.0);
+	formatter->dump_float("avg_page_latency_ms", pages ?
+	  std::chrono::duration<double, std::milli>(total_latency).count() / pages : 0.0);
+	formatter->dump_float("max_page_latency_ms",
+	  std::chrono::duration<double, std::milli>(max_latency).count());
+	formatter->close_section(); // benchmark
+	formatter->flush(cout);
+	return 0;
+      }
+
+      formatter->open_array_section("entries");
+
       string prefix;
       string delim;
       string ns;
@@ -8566,6 +8649,7 @@ next:
 
     constexpr uint32_t NUM_ENTRIES = 1000;
     uint16_t expansion_factor = 1;
+    RGWRados::OrderedListState list_state;
     while (is_truncated) {
       RGWRados::ent_map_t result;
       result.reserve(NUM_ENTRIES);
@@ -8577,7 +8661,8 @@ next:
 	NUM_ENTRIES, true, expansion_factor,
 	result, &is_truncated, &cls_filtered, &marker,
 	null_yield,
-	rgw_bucket_object_check_filter);
+	rgw_bucket_object_check_filter,
+	&list_state);
       if (r < 0 && r != -ENOENT) {
         cerr << "ERROR: failed operation r=" << r << std::endl;
       } else if (r == -ENOENT) {
@@ -9531,7 +9616,8 @@ next:
         }
       } else {
         int ret = rgw_sync_all_stats(dpp(), null_yield, driver,
-                                     user->get_id(), user->get_tenant());
+                                     user->get_id(), user->get_tenant(),
+                                     max_concurrent_ios);
         if (ret < 0) {
           cerr << "ERROR: could not sync user stats: " <<
 	    cpp_strerror(-ret) << std::endl;
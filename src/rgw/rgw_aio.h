@@ -98,6 +98,10 @@ class Aio {
   // wait for all outstanding completions and return their results
   virtual AioResultList drain() = 0;
 
+  // change the total cost allowed in flight. takes effect for the next
+  // call to get(); implementations without a window ignore it
+  virtual void set_window(uint64_t window) {}
+
   static OpFunc librados_op(librados::IoCtx ctx,
                             librados::ObjectReadOperation&& op,
                             optional_yield y);
@@ -43,12 +43,17 @@ AioResultList BlockingAioThrottle::get(rgw_raw_obj obj,
   } else {
     // wait for the write size to become available
     pending_size += p->cost;
+    waiting_cost = p->cost;
     if (!is_available()) {
       ceph_assert(waiter == Wait::None);
       waiter = Wait::Available;
       cond.wait(lock, [this] { return is_available(); });
       waiter = Wait::None;
     }
+    waiting_cost = 0;
+    if (budget) {
+      budget->acquire(p->cost);
+    }
 
     // register the pending write and attach a completion
     p->parent = this;
@@ -72,6 +77,9 @@ void BlockingAioThrottle::put(AioResult& r)
   completed.push_back(p);
 
   pending_size -= p.cost;
+  if (budget) {
+    budget->release(p.cost);
+  }
 
   if (waiter_ready()) {
     cond.notify_one();
@@ -108,6 +116,12 @@ AioResultList BlockingAioThrottle::drain()
   return std::move(completed);
 }
 
+void BlockingAioThrottle::set_window(uint64_t w)
+{
+  std::scoped_lock lock{mutex};
+  window = w;
+}
+
 template <typename CompletionToken>
 auto YieldingAioThrottle::async_wait(CompletionToken&& token)
 {
@@ -134,6 +148,7 @@ AioResultList YieldingAioThrottle::get(rgw_raw_obj obj,
   } else {
     // wait for the write size to become available
     pending_size += p->cost;
+    waiting_cost = p->cost;
     if (!is_available()) {
       ceph_assert(waiter == Wait::None);
       ceph_assert(!completion);
@@ -142,6 +157,10 @@ AioResultList YieldingAioThrottle::get(rgw_raw_obj obj,
       waiter = Wait::Available;
       async_wait(yield[ec]);
     }
+    waiting_cost = 0;
+    if (budget) {
+      budget->acquire(p->cost);
+    }
 
     // register the pending write and initiate the operation
     pending.push_back(*p);
@@ -161,6 +180,9 @@ void YieldingAioThrottle::put(AioResult& r)
   completed.push_back(p);
 
   pending_size -= p.cost;
+  if (budget) {
+    budget->release(p.cost);
+  }
 
   if (waiter_ready()) {
     ceph_assert(completion);
@@ -199,4 +221,9 @@ AioResultList YieldingAioThrottle::drain()
   }
   return std::move(completed);
 }
+
+void YieldingAioThrottle::set_window(uint64_t w)
+{
+  window = w;
+}
 } // namespace rgw
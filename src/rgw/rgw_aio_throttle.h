@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include "common/ceph_mutex.h"
 #include "common/async/completion.h"
@@ -23,15 +24,43 @@
 
 namespace rgw {
 
+// a limit on the total cost in flight shared by several throttles, i.e.
+// the memory held by reads of all requests. a throttle with nothing in
+// flight may always go over it, so that every throttle makes progress.
+// the limit is soft: throttles racing for the last of it may overshoot
+class ThrottleBudget {
+  std::atomic<uint64_t> limit;
+  std::atomic<uint64_t> used{0};
+ public:
+  explicit ThrottleBudget(uint64_t limit = 0) : limit(limit) {}
+
+  // 0 means unlimited
+  void set_limit(uint64_t l) { limit = l; }
+  uint64_t get_limit() const { return limit; }
+  uint64_t get_used() const { return used; }
+
+  bool has_room(uint64_t cost) const {
+    const uint64_t l = limit;
+    return l == 0 || used + cost <= l;
+  }
+  void acquire(uint64_t cost) { used += cost; }
+  void release(uint64_t cost) { used -= cost; }
+};
+
 class Throttle {
  protected:
-  const uint64_t window;
+  uint64_t window;
+  ThrottleBudget* const budget;
   uint64_t pending_size = 0;
+  uint64_t waiting_cost = 0; // cost of the operation waiting in get()
 
   AioResultList pending;
   AioResultList completed;
 
-  bool is_available() const { return pending_size <= window; }
+  bool fits_budget() const {
+    return !budget || pending.empty() || budget->has_room(waiting_cost);
+  }
+  bool is_available() const { return pending_size <= window && fits_budget(); }
   bool has_completion() const { return !completed.empty(); }
   bool is_drained() const { return pending.empty(); }
 
@@ -41,7 +70,8 @@ class Throttle {
   bool waiter_ready() const;
 
  public:
-  Throttle(uint64_t window) : window(window) {}
+  Throttle(uint64_t window, ThrottleBudget* budget = nullptr)
+    : window(window), budget(budget) {}
 
   virtual ~Throttle() {
     // must drain before destructing
@@ -61,7 +91,8 @@ class BlockingAioThrottle final : public Aio, private Throttle {
     uint64_t cost = 0;
   };
  public:
-  BlockingAioThrottle(uint64_t window) : Throttle(window) {}
+  BlockingAioThrottle(uint64_t window, ThrottleBudget* budget = nullptr)
+    : Throttle(window, budget) {}
 
   virtual ~BlockingAioThrottle() override {};
 
@@ -75,6 +106,8 @@ class BlockingAioThrottle final : public Aio, private Throttle {
   AioResultList wait() override final;
 
   AioResultList drain() override final;
+
+  void set_window(uint64_t window) override final;
 };
 
 // a throttle that yields the coroutine instead of blocking. all public
@@ -93,8 +126,9 @@ class YieldingAioThrottle final : public Aio, private Throttle {
   struct Pending : AioResultEntry { uint64_t cost = 0; };
 
  public:
-  YieldingAioThrottle(uint64_t window, boost::asio::yield_context yield)
-    : Throttle(window), yield(yield)
+  YieldingAioThrottle(uint64_t window, boost::asio::yield_context yield,
+                      ThrottleBudget* budget = nullptr)
+    : Throttle(window, budget), yield(yield)
   {}
 
   virtual ~YieldingAioThrottle() override {};
@@ -109,17 +143,21 @@ class YieldingAioThrottle final : public Aio, private Throttle {
   AioResultList wait() override final;
 
   AioResultList drain() override final;
+
+  void set_window(uint64_t window) override final;
 };
 
 // return a smart pointer to Aio
-inline auto make_throttle(uint64_t window_size, optional_yield y)
+inline auto make_throttle(uint64_t window_size, optional_yield y,
+                          ThrottleBudget* budget = nullptr)
 {
   std::unique_ptr<Aio> aio;
   if (y) {
     aio = std::make_unique<YieldingAioThrottle>(window_size,
-                                                y.get_yield_context());
+                                                y.get_yield_context(),
+                                                budget);
   } else {
-    aio = std::make_unique<BlockingAioThrottle>(window_size);
+    aio = std::make_unique<BlockingAioThrottle>(window_size, budget);
   }
   return aio;
 }
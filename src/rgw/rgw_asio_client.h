@@ -51,6 +51,16 @@ class ClientIO : public io::RestfulClient,
     return write_data(buf, len);
   }
 
+  size_t send_body_buffers(const ceph::bufferlist& bl,
+                           size_t ofs, size_t len) override {
+    return write_buffers(bl, ofs, len);
+  }
+
+  /* Send exactly @len bytes starting at @ofs of @bl as a single gathered
+   * write. On failure throws rgw::io::Exception. */
+  virtual size_t write_buffers(const ceph::bufferlist& bl,
+                               size_t ofs, size_t len) = 0;
+
   RGWEnv& get_env() noexcept override {
     return env;
   }
@@ -6,6 +6,7 @@
 #include <iomanip>
 #include <list>
 #include <memory>
+#include <optional>
 
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/bind_cancellation_slot.hpp>
@@ -17,6 +18,7 @@
 #include <boost/asio/ip/v6_only.hpp>
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
+#include <boost/container/small_vector.hpp>
 
 #include <boost/intrusive/list.hpp>
 #include <boost/smart_ptr/intrusive_ref_counter.hpp>
@@ -31,9 +33,11 @@
 #include "rgw_asio_client.h"
 #include "rgw_asio_frontend.h"
 #include "rgw_asio_thread.h"
+#include "rgw_perf_counters.h"
 
 #ifdef WITH_RADOSGW_BEAST_OPENSSL
 #include <boost/asio/ssl.hpp>
+#include "rgw_asio_ktls.h"
 #endif
 
 #include "common/split.h"
@@ -45,6 +49,12 @@
 
 #include "rgw_asio_frontend_timer.h"
 #include "rgw_dmclock_async_scheduler.h"
+#include "rgw_dmclock_tenant_scheduler.h"
+
+#ifdef WITH_RADOSGW_BEAST_HTTP2
+#include "common/async/yield_waiter.h"
+#include "rgw_asio_http2.h"
+#endif
 
 #define dout_subsys ceph_subsys_rgw
 
@@ -130,16 +140,16 @@ class StreamIO : public rgw::asio::ClientIO {
 
   boost::system::error_code get_fatal_error_code() const { return fatal_ec; }
 
-  size_t write_data(const char* buf, size_t len) override {
+  template <typename ConstBufferSequence>
+  size_t write(const ConstBufferSequence& buffers) {
     boost::system::error_code ec;
     timeout.start();
     size_t bytes = 0;
     if (y) {
       boost::asio::yield_context& yield = y.get_yield_context();
-      bytes = boost::asio::async_write(stream, boost::asio::buffer(buf, len),
-                                       yield[ec]);
+      bytes = boost::asio::async_write(stream, buffers, yield[ec]);
     } else {
-      bytes = boost::asio::write(stream, boost::asio::buffer(buf, len), ec);
+      bytes = boost::asio::write(stream, buffers, ec);
     }
     timeout.cancel();
     if (ec) {
@@ -156,6 +166,25 @@ class StreamIO : public rgw::asio::ClientIO {
     return bytes;
   }
 
+  size_t write_data(const char* buf, size_t len) override {
+    return write(boost::asio::buffer(buf, len));
+  }
+
+  size_t write_buffers(const ceph::bufferlist& bl,
+                       size_t ofs, size_t len) override {
+    // the buffers are owned by bl, which the caller holds until the write
+    // completes, so librados' buffers can be written as they are
+    boost::container::small_vector<boost::asio::const_buffer, 16> buffers;
+    rgw::io::for_each_buffer(bl, ofs, len, [&buffers] (const char* buf, size_t n) {
+      buffers.emplace_back(buf, n);
+    });
+    const size_t bytes = write(buffers);
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_send_zerocopy_bytes, bytes);
+    }
+    return bytes;
+  }
+
   size_t recv_body(char* buf, size_t max) override {
     auto& message = parser.get();
     auto& body_remaining = message.body();
@@ -247,6 +276,30 @@ std::ostream& operator<<(std::ostream& out, const log_apache_time& a) {
 
 using SharedMutex = ceph::async::SharedMutex<boost::asio::any_io_executor>;
 
+// getting ssl_cipher and tls_version of tls streams
+template <typename Stream>
+void set_ssl_env(RGWEnv&, Stream&) {}
+
+#ifdef WITH_RADOSGW_BEAST_OPENSSL
+void set_ssl_env(RGWEnv& env, const SSL* native_handle)
+{
+  const auto ssl_cipher = SSL_CIPHER_get_name(SSL_get_current_cipher(native_handle));
+  const auto tls_version = SSL_get_version(native_handle);
+  env.set("SSL_CIPHER", ssl_cipher);
+  env.set("TLS_VERSION", tls_version);
+}
+
+void set_ssl_env(RGWEnv& env, ssl::stream<tcp::socket&>& stream)
+{
+  set_ssl_env(env, stream.native_handle());
+}
+
+void set_ssl_env(RGWEnv& env, rgw::asio::ktls_stream& stream)
+{
+  set_ssl_env(env, stream.native_handle());
+}
+#endif // WITH_RADOSGW_BEAST_OPENSSL
+
 template <typename Stream>
 void handle_connection(boost::asio::io_context& context,
                        RGWProcessEnv& env, Stream& stream,
@@ -339,15 +392,8 @@ void handle_connection(boost::asio::io_context& context,
                                   rgw::io::add_conlen_controlling(
                                     &real_client))));
       RGWRestfulIO client(cct, &real_client_io);
-      // getting ssl_cipher and tls_version
-      if(is_ssl) {
-        ceph_assert(typeid(Stream) == typeid(boost::asio::ssl::stream<tcp::socket&>));
-        const SSL * native_handle = reinterpret_cast<const SSL *>(stream.native_handle());
-        const auto ssl_cipher = SSL_CIPHER_get_name(SSL_get_current_cipher(native_handle));
-        const auto tls_version = SSL_get_version(native_handle);
-        auto& client_env = client.get_env();
-        client_env.set("SSL_CIPHER", ssl_cipher);
-        client_env.set("TLS_VERSION", tls_version);
+      if (is_ssl) {
+        set_ssl_env(client.get_env(), stream);
       }
       int http_ret = 0;
       string user = "-";
@@ -412,6 +458,297 @@ void handle_connection(boost::asio::io_context& context,
   }
 }
 
+#ifdef WITH_RADOSGW_BEAST_HTTP2
+namespace http2 = rgw::asio::http2;
+
+// log a value or '-' if it's empty
+struct log_value {
+  std::string_view value;
+  std::string_view quote;
+  log_value(std::string_view value, std::string_view quote = "")
+    : value(value), quote(quote) {}
+};
+std::ostream& operator<<(std::ostream& out, const log_value& v) {
+  if (v.value.empty()) {
+    return out << '-';
+  }
+  return out << v.quote << v.value << v.quote;
+}
+
+// read until the buffer holds enough of the connection's first bytes to tell
+// whether they are the HTTP/2 connection preface
+template <typename Stream>
+bool read_http2_preface(Stream& stream, parse_buffer& buffer,
+                        timeout_timer& timeout,
+                        boost::system::error_code& ec,
+                        boost::asio::yield_context yield)
+{
+  constexpr auto preface = http2::client_preface;
+  for (;;) {
+    const auto data = buffer.data();
+    const size_t n = std::min(data.size(), preface.size());
+    const auto received = std::string_view{
+        static_cast<const char*>(data.data()), n};
+    if (received != preface.substr(0, n)) {
+      return false;
+    }
+    if (n == preface.size()) {
+      return true;
+    }
+    timeout.start();
+    const size_t bytes = stream.async_read_some(
+        buffer.prepare(buffer.max_size() - buffer.size()), yield[ec]);
+    timeout.cancel();
+    if (ec) {
+      return false;
+    }
+    buffer.commit(bytes);
+  }
+}
+
+template <typename Stream>
+void handle_http2_request(RGWProcessEnv& env, Stream& stream,
+                          http2::StreamIO& real_client, bool is_ssl,
+                          SharedMutex& pause_mutex,
+                          rgw::dmclock::Scheduler *scheduler,
+                          const std::string& uri_prefix,
+                          const tcp::endpoint& remote_endpoint,
+                          boost::asio::yield_context yield)
+{
+  auto cct = env.driver->ctx();
+
+  boost::system::error_code ec;
+  auto lock = pause_mutex.async_lock_shared(yield[ec]);
+  if (ec == boost::asio::error::operation_aborted) {
+    return;
+  } else if (ec) {
+    ldout(cct, 1) << "failed to lock: " << ec.message() << dendl;
+    return;
+  }
+
+  // process the request
+  RGWRequest req{env.driver->get_new_req_id()};
+
+  real_client.set_yield(yield);
+  optional_yield y{yield};
+
+  // no chunking filter, the stream frames the body
+  auto real_client_io = rgw::io::add_reordering(
+                          rgw::io::add_buffering(cct,
+                            rgw::io::add_conlen_controlling(
+                              &real_client)));
+  RGWRestfulIO client(cct, &real_client_io);
+  if (is_ssl) {
+    set_ssl_env(client.get_env(), stream);
+  }
+  int http_ret = 0;
+  string user = "-";
+  const auto started = ceph::coarse_real_clock::now();
+  ceph::coarse_real_clock::duration latency{};
+  process_request(env, &req, uri_prefix, &client, y,
+                  scheduler, &user, &latency, &http_ret);
+
+  if (cct->_conf->subsys.should_gather(ceph_subsys_rgw_access, 1)) {
+    // access log line elements begin per Apache Combined Log Format with additions following
+    lsubdout(cct, rgw_access, 1) << "beast: " << std::hex << &req << std::dec << ": "
+        << remote_endpoint.address() << " - " << user << " [" << log_apache_time{started} << "] \""
+        << real_client.get_method() << ' ' << real_client.get_path() << ' '
+        << http_version{20} << "\" " << http_ret << ' '
+        << client.get_bytes_sent() + client.get_bytes_received() << ' '
+        << log_value{real_client.get_header("referer"), "\""} << ' '
+        << log_value{real_client.get_header("user-agent"), "\""} << ' '
+        << log_value{real_client.get_header("range")} << " latency="
+        << latency << dendl;
+  }
+}
+
+// serve the streams of an HTTP/2 connection. this coroutine reads from the
+// connection, a writer coroutine writes the frames queued by the session,
+// and each request runs in a coroutine of its own, all on the connection's
+// strand
+template <typename Stream>
+void handle_http2_connection(RGWProcessEnv& env, Stream& stream,
+                             timeout_timer& timeout,
+                             timeout_timer& write_timeout,
+                             parse_buffer& buffer, bool is_ssl,
+                             SharedMutex& pause_mutex,
+                             rgw::dmclock::Scheduler *scheduler,
+                             const std::string& uri_prefix,
+                             const http2::Settings& settings,
+                             boost::system::error_code& ec,
+                             boost::asio::yield_context yield)
+{
+  auto cct = env.driver->ctx();
+
+  auto& socket = stream.lowest_layer();
+  const auto remote_endpoint = socket.remote_endpoint(ec);
+  if (ec) {
+    ldout(cct, 1) << "failed to connect client: " << ec.message() << dendl;
+    return;
+  }
+  const auto local_endpoint = socket.local_endpoint(ec);
+  if (ec) {
+    ldout(cct, 1) << "failed to connect client: " << ec.message() << dendl;
+    return;
+  }
+
+  auto ex = yield.get_executor();
+  auto session = std::make_shared<http2::Session>(
+      cct, ex, settings, is_ssl, local_endpoint, remote_endpoint);
+  if (session->init() < 0) {
+    return;
+  }
+
+  // the other coroutines use the session and this stack frame, so they must
+  // all return before this one
+  size_t coroutines = 0;
+  ceph::async::yield_waiter<void> drained;
+  auto coroutine_done = [&] {
+    if (--coroutines == 0 && drained) {
+      boost::asio::post(ex, [&drained] {
+          if (drained) {
+            drained.complete({});
+          }
+        });
+    }
+  };
+
+  ++coroutines;
+  boost::asio::spawn(ex, std::allocator_arg, make_stack_allocator(),
+    [&] (boost::asio::yield_context yield) {
+      static constexpr size_t max_write = 65536;
+      std::string out;
+      boost::system::error_code ec;
+      for (;;) {
+        out.clear();
+        if (session->output(out, max_write) < 0) {
+          session->shutdown();
+        }
+        if (out.empty()) {
+          if (session->done()) {
+            break;
+          }
+          session->wait_output(yield);
+          continue;
+        }
+        write_timeout.start();
+        boost::asio::async_write(stream, boost::asio::buffer(out), yield[ec]);
+        write_timeout.cancel();
+        if (ec) {
+          ldout(cct, 4) << "http2: failed to write: " << ec.message() << dendl;
+          session->shutdown();
+          break;
+        }
+        if (session->idle()) {
+          // time out the connection unless another request comes in
+          timeout.start();
+        }
+      }
+      // stop the reader
+      boost::system::error_code ec_ignored;
+      socket.cancel(ec_ignored);
+      coroutine_done();
+    }, [] (std::exception_ptr eptr) {
+      if (eptr) std::rethrow_exception(eptr);
+    });
+
+  // the buffer may hold bytes read with the preface or the tls handshake
+  int r = session->receive(buffer.data().data(), buffer.size());
+  buffer.consume(buffer.size());
+
+  while (r >= 0) {
+    for (auto& request : session->take_requests()) {
+      ++coroutines;
+      boost::asio::spawn(ex, std::allocator_arg, make_stack_allocator(),
+        [&, s = std::move(request)] (boost::asio::yield_context yield) {
+          handle_http2_request(env, stream, *s, is_ssl, pause_mutex,
+                               scheduler, uri_prefix, remote_endpoint, yield);
+          s->finish();
+          coroutine_done();
+        }, [] (std::exception_ptr eptr) {
+          if (eptr) std::rethrow_exception(eptr);
+        });
+    }
+    session->notify_output();
+    if (session->done()) {
+      break;
+    }
+
+    // only connections without open streams time out while reading
+    if (session->idle()) {
+      timeout.start();
+    }
+    const size_t bytes = stream.async_read_some(buffer.prepare(buffer.max_size()),
+                                                yield[ec]);
+    timeout.cancel();
+    if (ec == boost::asio::error::eof ||
+        ec == boost::asio::error::connection_reset ||
+        ec == boost::asio::error::bad_descriptor ||
+        ec == boost::asio::error::operation_aborted
+#ifdef WITH_RADOSGW_BEAST_OPENSSL
+        || ec == ssl::error::stream_truncated
+#endif
+        ) {
+      ldout(cct, 20) << "http2: failed to read: " << ec.message() << dendl;
+      break;
+    } else if (ec) {
+      ldout(cct, 1) << "http2: failed to read: " << ec.message() << dendl;
+      break;
+    }
+    buffer.commit(bytes);
+    r = session->receive(buffer.data().data(), bytes);
+    buffer.consume(bytes);
+  }
+
+  session->shutdown();
+  while (coroutines > 0) {
+    boost::system::error_code ec_ignored;
+    drained.async_wait(yield[ec_ignored]);
+  }
+}
+
+#ifdef WITH_RADOSGW_BEAST_OPENSSL
+// true if the client chose HTTP/2 during the tls handshake
+bool negotiated_http2(const SSL* native_handle)
+{
+  const unsigned char* proto = nullptr;
+  unsigned int len = 0;
+  SSL_get0_alpn_selected(native_handle, &proto, &len);
+  return std::string_view{reinterpret_cast<const char*>(proto), len} ==
+      http2::alpn_id;
+}
+
+// ALPN selection that prefers HTTP/2 over http/1.1
+int select_alpn(SSL* ssl, const unsigned char** out, unsigned char* outlen,
+                const unsigned char* in, unsigned int inlen, void* arg)
+{
+  const unsigned char* http11 = nullptr;
+  for (unsigned int i = 0; i < inlen;) {
+    const unsigned int len = in[i++];
+    if (i + len > inlen) {
+      break;
+    }
+    const auto proto = std::string_view{reinterpret_cast<const char*>(in + i), len};
+    if (proto == http2::alpn_id) {
+      *out = in + i;
+      *outlen = len;
+      return SSL_TLSEXT_ERR_OK;
+    }
+    if (proto == "http/1.1") {
+      http11 = in + i;
+    }
+    i += len;
+  }
+  if (http11) {
+    *out = http11;
+    *outlen = http11[-1];
+    return SSL_TLSEXT_ERR_OK;
+  }
+  return SSL_TLSEXT_ERR_NOACK;
+}
+#endif // WITH_RADOSGW_BEAST_OPENSSL
+#endif // WITH_RADOSGW_BEAST_HTTP2
+
 // timeout support requires that connections are reference-counted, because the
 // timeout_handler can outlive the coroutine
 struct Connection : boost::intrusive::list_base_hook<>,
@@ -480,6 +817,18 @@ class AsioFrontend {
   int ssl_set_private_key(const string& name, bool is_ssl_cert);
   int ssl_set_certificate_chain(const string& name);
   int init_ssl();
+  // let OpenSSL hand the record encryption to the kernel
+  bool ssl_ktls = false;
+  template <typename Stream>
+  void handle_ssl_connection(const boost::intrusive_ptr<Connection>& conn,
+                             Stream& stream,
+                             timeout_timer& timeout,
+                             boost::asio::yield_context yield);
+#endif
+#ifdef WITH_RADOSGW_BEAST_HTTP2
+  bool http2 = false;
+  http2::Settings http2_settings;
+  void init_http2();
 #endif
   SharedMutex pause_mutex;
   std::unique_ptr<rgw::dmclock::Scheduler> scheduler;
@@ -527,6 +876,10 @@ class AsioFrontend {
                                               *sched_ctx.get_dmc_client_config(),
                                               dmc::AtLimit::Reject));
       break;
+    case dmc::scheduler_t::dmclock_tenant:
+      scheduler.reset(new dmc::TenantScheduler(ctx(), context,
+                                               sched_ctx.get_dmc_tenant_counters()));
+      break;
     case dmc::scheduler_t::none:
       lderr(ctx()) << "Got invalid scheduler type for beast, defaulting to throttler" << dendl;
       [[fallthrough]];
@@ -668,6 +1021,10 @@ int AsioFrontend::init()
     }
   }
 
+#ifdef WITH_RADOSGW_BEAST_HTTP2
+  init_http2();
+#endif
+
 #ifdef WITH_RADOSGW_BEAST_OPENSSL
   int r = init_ssl();
   if (r < 0) {
@@ -789,6 +1146,54 @@ int AsioFrontend::init()
   return drop_privileges(ctx());
 }
 
+#ifdef WITH_RADOSGW_BEAST_HTTP2
+void AsioFrontend::init_http2()
+{
+  auto& config = conf->get_config_map();
+
+  auto enabled = config.find("http2");
+  if (enabled == config.end() || enabled->second != "1") {
+    return;
+  }
+  if (!ctx()->_conf->rgw_beast_enable_async) {
+    // the streams of a connection are served by coroutines on its strand
+    lderr(ctx()) << "WARNING: http2 requires rgw_beast_enable_async, "
+        "serving HTTP/1.1 only" << dendl;
+    return;
+  }
+  http2 = true;
+  http2_settings.header_limit = header_limit;
+  // like the timeout of each read and write on HTTP/1.1 connections
+  http2_settings.stream_timeout = request_timeout;
+
+  auto max_streams = config.find("http2_max_streams");
+  if (max_streams != config.end()) {
+    auto value = ceph::parse<uint32_t>(max_streams->second);
+    if (!value || *value == 0) {
+      lderr(ctx()) << "WARNING: invalid value for http2_max_streams: "
+          << max_streams->second << ", using the default value: "
+          << http2_settings.max_concurrent_streams << dendl;
+    } else {
+      http2_settings.max_concurrent_streams = *value;
+    }
+  }
+
+  auto window_size = config.find("http2_window_size");
+  if (window_size != config.end()) {
+    // RFC 9113 section 6.9.2 limits the window to 2^31-1
+    auto value = ceph::parse<uint32_t>(window_size->second);
+    if (!value || *value < 65535 ||
+        *value > uint32_t(std::numeric_limits<int32_t>::max())) {
+      lderr(ctx()) << "WARNING: invalid value for http2_window_size: "
+          << window_size->second << ", using the default value: "
+          << http2_settings.window_size << dendl;
+    } else {
+      http2_settings.window_size = *value;
+    }
+  }
+}
+#endif // WITH_RADOSGW_BEAST_HTTP2
+
 #ifdef WITH_RADOSGW_BEAST_OPENSSL
 
 static string config_val_prefix = "config://";
@@ -1016,6 +1421,21 @@ int AsioFrontend::init_ssl()
     }
   }
 
+  std::optional<string> ktls = conf->get_val("ssl_ktls");
+  if (ktls && *ktls == "1") {
+    if (!cert) {
+      lderr(ctx()) << "no ssl_certificate configured for ssl_ktls" << dendl;
+      return -EINVAL;
+    }
+#ifdef SSL_OP_ENABLE_KTLS
+    ssl_context->set_options(SSL_OP_ENABLE_KTLS);
+    ssl_ktls = true;
+#else
+    lderr(ctx()) << "WARNING: ssl_ktls requires OpenSSL 3.0 with ktls "
+        "support, ignoring" << dendl;
+#endif
+  }
+
   auto ports = config.equal_range("ssl_port");
   auto endpoints = config.equal_range("ssl_endpoint");
 
@@ -1089,10 +1509,46 @@ int AsioFrontend::init_ssl()
     listeners.back().endpoint = endpoint;
     listeners.back().use_ssl = true;
   }
+
+#ifdef WITH_RADOSGW_BEAST_HTTP2
+  if (http2) {
+    SSL_CTX_set_alpn_select_cb(ssl_context->native_handle(),
+                               select_alpn, nullptr);
+  }
+#endif
   return 0;
 }
 #endif // WITH_RADOSGW_BEAST_OPENSSL
 
+#ifdef WITH_RADOSGW_BEAST_OPENSSL
+template <typename Stream>
+void AsioFrontend::handle_ssl_connection(const boost::intrusive_ptr<Connection>& conn,
+                                         Stream& stream, timeout_timer& timeout,
+                                         boost::asio::yield_context yield)
+{
+  boost::system::error_code ec;
+#ifdef WITH_RADOSGW_BEAST_HTTP2
+  if (http2 && negotiated_http2(stream.native_handle())) {
+    auto write_timeout = timeout_timer{context.get_executor(), request_timeout, conn};
+    handle_http2_connection(env, stream, timeout, write_timeout,
+                            conn->buffer, true, pause_mutex,
+                            scheduler.get(), uri_prefix,
+                            http2_settings, ec, yield);
+  } else
+#endif
+  handle_connection(context, env, stream, timeout, header_limit,
+                    conn->buffer, true, pause_mutex, scheduler.get(),
+                    uri_prefix, ec, yield);
+
+  if (!ec || ec == http::error::end_of_stream) {
+    // ssl shutdown (ignoring errors)
+    stream.async_shutdown(yield[ec]);
+  }
+
+  conn->socket.shutdown(tcp::socket::shutdown_both, ec);
+}
+#endif // WITH_RADOSGW_BEAST_OPENSSL
+
 void AsioFrontend::accept(Listener& l, boost::asio::yield_context yield)
 {
   for (;;) {
@@ -1129,7 +1585,35 @@ void AsioFrontend::on_accept(Listener& l, tcp::socket stream)
   
   // spawn a coroutine to handle the connection
 #ifdef WITH_RADOSGW_BEAST_OPENSSL
-  if (l.use_ssl) {
+  if (l.use_ssl && ssl_ktls) {
+    boost::asio::spawn(make_strand(context), std::allocator_arg, make_stack_allocator(),
+      [this, s=std::move(stream)] (boost::asio::yield_context yield) mutable {
+        auto conn = boost::intrusive_ptr{new Connection(std::move(s))};
+        auto c = connections.add(*conn);
+        auto timeout = timeout_timer{context.get_executor(), request_timeout, conn};
+        boost::system::error_code ec;
+        std::optional<rgw::asio::ktls_stream> stream;
+        try {
+          stream.emplace(conn->socket, ssl_context->native_handle());
+        } catch (const boost::system::system_error& e) {
+          ldout(ctx(), 1) << "ssl setup failed: " << e.what() << dendl;
+          return;
+        }
+        // do ssl handshake, openssl enables ktls at its end
+        timeout.start();
+        stream->async_handshake(yield[ec]);
+        timeout.cancel();
+        if (ec) {
+          ldout(ctx(), 1) << "ssl handshake failed: " << ec.message() << dendl;
+          return;
+        }
+        ldout(ctx(), 20) << "ssl handshake done, ktls send="
+            << stream->ktls_send() << " recv=" << stream->ktls_recv() << dendl;
+        handle_ssl_connection(conn, *stream, timeout, yield);
+      }, [] (std::exception_ptr eptr) {
+        if (eptr) std::rethrow_exception(eptr);
+      });
+  } else if (l.use_ssl) {
     boost::asio::spawn(make_strand(context), std::allocator_arg, make_stack_allocator(),
       [this, s=std::move(stream)] (boost::asio::yield_context yield) mutable {
         auto conn = boost::intrusive_ptr{new Connection(std::move(s))};
@@ -1148,16 +1632,7 @@ void AsioFrontend::on_accept(Listener& l, tcp::socket stream)
           return;
         }
         conn->buffer.consume(bytes);
-        handle_connection(context, env, stream, timeout, header_limit,
-                          conn->buffer, true, pause_mutex, scheduler.get(),
-                          uri_prefix, ec, yield);
-
-        if (!ec || ec == http::error::end_of_stream) {
-          // ssl shutdown (ignoring errors)
-          stream.async_shutdown(yield[ec]);
-        }
-
-        conn->socket.shutdown(tcp::socket::shutdown_both, ec);
+        handle_ssl_connection(conn, stream, timeout, yield);
       }, [] (std::exception_ptr eptr) {
         if (eptr) std::rethrow_exception(eptr);
       });
@@ -1171,6 +1646,18 @@ void AsioFrontend::on_accept(Listener& l, tcp::socket stream)
         auto c = connections.add(*conn);
         auto timeout = timeout_timer{context.get_executor(), request_timeout, conn};
         boost::system::error_code ec;
+#ifdef WITH_RADOSGW_BEAST_HTTP2
+        // cleartext HTTP/2 needs prior knowledge, the connection starts
+        // with the client preface
+        if (http2 && read_http2_preface(conn->socket, conn->buffer,
+                                        timeout, ec, yield)) {
+          auto write_timeout = timeout_timer{context.get_executor(), request_timeout, conn};
+          handle_http2_connection(env, conn->socket, timeout, write_timeout,
+                                  conn->buffer, false, pause_mutex,
+                                  scheduler.get(), uri_prefix,
+                                  http2_settings, ec, yield);
+        } else if (!ec)
+#endif
         handle_connection(context, env, conn->socket, timeout, header_limit,
                           conn->buffer, false, pause_mutex, scheduler.get(),
                           uri_prefix, ec, yield);
@@ -0,0 +1,673 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <limits>
+
+#include <boost/asio/post.hpp>
+#include <nghttp2/nghttp2.h>
+
+#include "rgw_asio_http2.h"
+#include "rgw_perf_counters.h"
+
+#define dout_subsys ceph_subsys_rgw
+
+namespace rgw::asio::http2 {
+
+static nghttp2_nv make_nv(std::string_view name, std::string_view value)
+{
+  // nghttp2 copies the name and value, they don't need to outlive the call
+  return nghttp2_nv{
+    reinterpret_cast<uint8_t*>(const_cast<char*>(name.data())),
+    reinterpret_cast<uint8_t*>(const_cast<char*>(value.data())),
+    name.size(), value.size(), NGHTTP2_NV_FLAG_NONE};
+}
+
+// connection-specific header fields are not allowed in HTTP/2 (RFC 9113
+// section 8.2.2)
+static bool is_connection_header(std::string_view name)
+{
+  return name == "connection" || name == "keep-alive" ||
+      name == "proxy-connection" || name == "transfer-encoding" ||
+      name == "upgrade";
+}
+
+struct Callbacks {
+  static int on_begin_headers(nghttp2_session* session,
+                              const nghttp2_frame* frame,
+                              void* user_data)
+  {
+    if (frame->hd.type != NGHTTP2_HEADERS ||
+        frame->headers.cat != NGHTTP2_HCAT_REQUEST) {
+      return 0;
+    }
+    auto self = static_cast<Session*>(user_data);
+    const int32_t id = frame->hd.stream_id;
+    auto stream = std::make_shared<StreamIO>(*self, id);
+    nghttp2_session_set_stream_user_data(session, id, stream.get());
+    self->streams.emplace(id, std::move(stream));
+    return 0;
+  }
+
+  static int on_header(nghttp2_session* session, const nghttp2_frame* frame,
+                       const uint8_t* name, size_t namelen,
+                       const uint8_t* value, size_t valuelen,
+                       uint8_t flags, void* user_data)
+  {
+    if (frame->hd.type != NGHTTP2_HEADERS ||
+        frame->headers.cat != NGHTTP2_HCAT_REQUEST) {
+      return 0; // trailers are ignored
+    }
+    auto stream = static_cast<StreamIO*>(
+        nghttp2_session_get_stream_user_data(session, frame->hd.stream_id));
+    if (!stream) {
+      return 0;
+    }
+    auto self = static_cast<Session*>(user_data);
+    stream->header_bytes += namelen + valuelen;
+    if (stream->header_bytes > self->settings.header_limit) {
+      ldout(self->cct, 1) << "http2: stream " << stream->id
+          << " exceeds the header limit of " << self->settings.header_limit
+          << dendl;
+      return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE; // resets the stream
+    }
+    const auto n = std::string_view{reinterpret_cast<const char*>(name), namelen};
+    const auto v = std::string_view{reinterpret_cast<const char*>(value), valuelen};
+    if (n == ":method") {
+      stream->method = v;
+    } else if (n == ":path") {
+      stream->path = v;
+    } else if (n == ":authority") {
+      stream->authority = v;
+    } else if (!n.empty() && n[0] != ':') {
+      stream->headers.emplace_back(n, v);
+    }
+    return 0;
+  }
+
+  static int on_frame_recv(nghttp2_session* session,
+                           const nghttp2_frame* frame,
+                           void* user_data)
+  {
+    if (frame->hd.type != NGHTTP2_HEADERS && frame->hd.type != NGHTTP2_DATA) {
+      return 0;
+    }
+    auto self = static_cast<Session*>(user_data);
+    auto i = self->streams.find(frame->hd.stream_id);
+    if (i == self->streams.end()) {
+      return 0;
+    }
+    auto& stream = i->second;
+    if (frame->hd.flags & NGHTTP2_FLAG_END_STREAM) {
+      stream->rx_eof = true;
+      self->wake(*stream);
+    }
+    if (frame->hd.type == NGHTTP2_HEADERS &&
+        frame->headers.cat == NGHTTP2_HCAT_REQUEST) {
+      self->requests.push_back(stream);
+    }
+    return 0;
+  }
+
+  static int on_data_chunk_recv(nghttp2_session* session, uint8_t flags,
+                                int32_t stream_id, const uint8_t* data,
+                                size_t len, void* user_data)
+  {
+    auto self = static_cast<Session*>(user_data);
+    auto stream = static_cast<StreamIO*>(
+        nghttp2_session_get_stream_user_data(session, stream_id));
+    if (!stream) {
+      self->unconsumed += len;
+      return 0;
+    }
+    stream->rx.append(reinterpret_cast<const char*>(data), len);
+    self->wake(*stream);
+    return 0;
+  }
+
+  static int on_stream_close(nghttp2_session* session, int32_t stream_id,
+                             uint32_t error_code, void* user_data)
+  {
+    auto self = static_cast<Session*>(user_data);
+    auto i = self->streams.find(stream_id);
+    if (i == self->streams.end()) {
+      return 0;
+    }
+    self->close_stream(*i->second, error_code);
+    self->streams.erase(i);
+    return 0;
+  }
+
+  static ssize_t read_data(nghttp2_session* session, int32_t stream_id,
+                           uint8_t* buf, size_t length, uint32_t* data_flags,
+                           nghttp2_data_source* source, void* user_data)
+  {
+    auto stream = static_cast<StreamIO*>(source->ptr);
+    auto self = static_cast<Session*>(user_data);
+    const size_t n = std::min<size_t>(length, stream->tx.length());
+    if (n > 0) {
+      stream->tx.begin().copy(n, reinterpret_cast<char*>(buf));
+      stream->tx.splice(0, n);
+    }
+    if (stream->tx.length() == 0) {
+      if (stream->tx_eof) {
+        *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+        stream->tx_done = true;
+      } else if (n == 0) {
+        return NGHTTP2_ERR_DEFERRED; // resumed by send_body()
+      }
+    }
+    if (stream->tx.length() < self->settings.window_size) {
+      self->wake(*stream);
+    }
+    return n;
+  }
+};
+
+StreamIO::StreamIO(Session& session, int32_t id)
+  : session(session), id(id), timer(session.ex)
+{
+}
+
+StreamIO::~StreamIO() = default;
+
+std::string_view StreamIO::get_header(std::string_view name) const
+{
+  auto i = std::find_if(headers.begin(), headers.end(),
+                        [name] (const auto& h) { return h.first == name; });
+  if (i == headers.end()) {
+    return {};
+  }
+  return i->second;
+}
+
+bool StreamIO::wait()
+{
+  ceph_assert(yield);
+  const auto timeout = session.settings.stream_timeout;
+  if (timeout.count() > 0) {
+    deadline = ceph::coarse_mono_clock::now() + timeout;
+    timer.expires_at(deadline);
+    timer.async_wait([w = weak_from_this()] (boost::system::error_code ec) {
+        auto s = w.lock();
+        // a canceled timer may still complete after a later wait() rearmed
+        // it, so compare with the current deadline
+        if (!ec && s && s->waiter &&
+            ceph::coarse_mono_clock::now() >= s->deadline) {
+          s->timed_out = true;
+          s->waiter.complete({});
+        }
+      });
+  }
+  boost::system::error_code ec;
+  waiter.async_wait((*yield)[ec]);
+  timer.cancel();
+  if (!timed_out) {
+    return true;
+  }
+  if (!closed) {
+    ldout(session.cct, 4) << "http2: stream " << id << " timed out" << dendl;
+    nghttp2_submit_rst_stream(session.session, NGHTTP2_FLAG_NONE, id,
+                              NGHTTP2_CANCEL);
+    session.notify_output();
+    closed = true;
+  }
+  return false;
+}
+
+void StreamIO::check_closed()
+{
+  if (closed) {
+    throw rgw::io::Exception(ECONNRESET, std::system_category());
+  }
+}
+
+int StreamIO::init_env(CephContext *cct)
+{
+  env.init(cct);
+
+  perfcounter->inc(l_rgw_qlen);
+  perfcounter->inc(l_rgw_qactive);
+
+  bool has_content_length = false;
+  bool has_host = false;
+  for (const auto& [name, value] : headers) {
+    if (name == "content-length") {
+      env.set("CONTENT_LENGTH", value);
+      has_content_length = true;
+      continue;
+    }
+    if (name == "content-type") {
+      env.set("CONTENT_TYPE", value);
+      continue;
+    }
+    if (name == "host") {
+      has_host = true;
+    }
+
+    static const std::string_view HTTP_{"HTTP_"};
+
+    std::string key;
+    key.reserve(HTTP_.size() + name.size());
+    key.append(HTTP_);
+    for (auto c : name) {
+      if (c == '-') {
+        key.push_back('_');
+      } else if (c == '_') {
+        key.push_back('-');
+      } else {
+        key.push_back(std::toupper(c));
+      }
+    }
+    env.set(std::move(key), value);
+  }
+  if (!has_host && !authority.empty()) {
+    env.set("HTTP_HOST", authority);
+  }
+  if (!has_content_length && !rx_eof) {
+    // the body ends with the stream instead, which rgw reads like a chunked
+    // request
+    env.set("HTTP_TRANSFER_ENCODING", "chunked");
+  }
+
+  env.set("HTTP_VERSION", "2.0");
+  env.set("REQUEST_METHOD", method);
+
+  // split uri from query
+  std::string_view uri = path;
+  auto pos = uri.find('?');
+  if (pos != uri.npos) {
+    env.set("QUERY_STRING", std::string(uri.substr(pos + 1)));
+    uri = uri.substr(0, pos);
+  }
+  env.set("SCRIPT_URI", std::string(uri));
+  env.set("REQUEST_URI", path);
+
+  char port_buf[16];
+  snprintf(port_buf, sizeof(port_buf), "%d", session.local_endpoint.port());
+  env.set("SERVER_PORT", port_buf);
+  if (session.is_ssl) {
+    env.set("SERVER_PORT_SECURE", port_buf);
+  }
+  env.set("REMOTE_ADDR", session.remote_endpoint.address().to_string());
+  return 0;
+}
+
+size_t StreamIO::send_status(int status, const char* status_name)
+{
+  this->status = std::to_string(status);
+  return this->status.size();
+}
+
+size_t StreamIO::send_100_continue()
+{
+  check_closed();
+  const auto nv = make_nv(":status", "100");
+  int r = nghttp2_submit_headers(session.session, NGHTTP2_FLAG_NONE, id,
+                                 nullptr, &nv, 1, nullptr);
+  if (r < 0) {
+    ldout(session.cct, 4) << "http2: failed to send 100-continue: "
+        << nghttp2_strerror(r) << dendl;
+    throw rgw::io::Exception(EIO, std::system_category());
+  }
+  session.notify_output();
+  return nv.namelen + nv.valuelen;
+}
+
+size_t StreamIO::send_header(const std::string_view& name,
+                             const std::string_view& value)
+{
+  std::string lower{name};
+  std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+  if (is_connection_header(lower)) {
+    return 0;
+  }
+  const size_t sent = lower.size() + value.size();
+  response_headers.emplace_back(std::move(lower), value);
+  return sent;
+}
+
+size_t StreamIO::send_content_length(uint64_t len)
+{
+  auto value = std::to_string(len);
+  const size_t sent = value.size();
+  response_headers.emplace_back("content-length", std::move(value));
+  return sent;
+}
+
+static std::string date_header()
+{
+  const time_t gtime = time(nullptr);
+  struct tm result;
+  if (gmtime_r(&gtime, &result) == nullptr) {
+    return {};
+  }
+  char timestr[128];
+  const size_t len = strftime(timestr, sizeof(timestr),
+                              "%a, %d %b %Y %H:%M:%S %Z", &result);
+  return std::string(timestr, len);
+}
+
+void StreamIO::submit_response()
+{
+  std::vector<nghttp2_nv> nva;
+  nva.reserve(response_headers.size() + 1);
+  nva.push_back(make_nv(":status", status));
+  for (const auto& [name, value] : response_headers) {
+    nva.push_back(make_nv(name, value));
+  }
+
+  nghttp2_data_provider data_prd;
+  data_prd.source.ptr = this;
+  data_prd.read_callback = Callbacks::read_data;
+
+  int r = nghttp2_submit_response(session.session, id, nva.data(), nva.size(),
+                                  &data_prd);
+  if (r < 0) {
+    ldout(session.cct, 4) << "http2: failed to submit response: "
+        << nghttp2_strerror(r) << dendl;
+    throw rgw::io::Exception(EIO, std::system_category());
+  }
+  submitted = true;
+  response_headers.clear();
+  session.notify_output();
+}
+
+size_t StreamIO::complete_header()
+{
+  check_closed();
+  if (auto date = date_header(); !date.empty()) {
+    response_headers.emplace_back("date", std::move(date));
+  }
+  submit_response();
+  return 0;
+}
+
+void StreamIO::flush()
+{
+  session.notify_output();
+}
+
+size_t StreamIO::queue_body(size_t len)
+{
+  if (submitted) {
+    nghttp2_session_resume_data(session.session, id);
+    session.notify_output();
+  }
+  // once a window of data is queued, wait for nghttp2 to take it so that
+  // the response body in memory is bounded by the client's flow control
+  while (tx.length() >= session.settings.window_size) {
+    if (!wait()) {
+      throw rgw::io::Exception(ETIMEDOUT, std::system_category());
+    }
+    check_closed();
+  }
+  return len;
+}
+
+size_t StreamIO::send_body(const char* buf, size_t len)
+{
+  check_closed();
+  tx.append(buf, len);
+  return queue_body(len);
+}
+
+size_t StreamIO::send_body_buffers(const ceph::bufferlist& bl,
+                                   size_t ofs, size_t len)
+{
+  check_closed();
+  // share the caller's buffers, nghttp2 copies them into its frames
+  ceph::bufferlist part;
+  part.substr_of(bl, ofs, len);
+  tx.claim_append(part);
+  return queue_body(len);
+}
+
+size_t StreamIO::recv_body(char* buf, size_t max)
+{
+  while (rx.length() == 0 && !rx_eof) {
+    check_closed();
+    if (!wait()) {
+      throw rgw::io::Exception(ETIMEDOUT, std::system_category());
+    }
+  }
+  const size_t n = std::min<size_t>(max, rx.length());
+  if (n > 0) {
+    rx.begin().copy(n, buf);
+    rx.splice(0, n);
+    // open the stream's flow control window again
+    nghttp2_session_consume(session.session, id, n);
+    session.notify_output();
+  }
+  return n;
+}
+
+size_t StreamIO::complete_request()
+{
+  perfcounter->inc(l_rgw_qlen, -1);
+  perfcounter->inc(l_rgw_qactive, -1);
+
+  tx_eof = true;
+  if (closed) {
+    return 0;
+  }
+  if (!submitted) {
+    submit_response();
+  } else {
+    nghttp2_session_resume_data(session.session, id);
+    session.notify_output();
+  }
+  while (!tx_done && !closed) {
+    if (!wait()) {
+      return 0;
+    }
+  }
+  if (!rx_eof && !closed) {
+    // the response is complete, the rest of the request isn't needed
+    nghttp2_submit_rst_stream(session.session, NGHTTP2_FLAG_NONE, id,
+                              NGHTTP2_NO_ERROR);
+    session.notify_output();
+  }
+  return 0;
+}
+
+void StreamIO::finish()
+{
+  if (!tx_done && !closed) {
+    nghttp2_submit_rst_stream(session.session, NGHTTP2_FLAG_NONE, id,
+                              NGHTTP2_INTERNAL_ERROR);
+    session.notify_output();
+  }
+}
+
+Session::Session(CephContext* cct, boost::asio::any_io_executor ex,
+                 const Settings& settings, bool is_ssl,
+                 const endpoint_type& local_endpoint,
+                 const endpoint_type& remote_endpoint)
+  : cct(cct), ex(std::move(ex)), settings(settings), is_ssl(is_ssl),
+    local_endpoint(local_endpoint), remote_endpoint(remote_endpoint)
+{
+}
+
+Session::~Session()
+{
+  if (session) {
+    nghttp2_session_del(session);
+  }
+}
+
+int Session::init()
+{
+  nghttp2_session_callbacks* callbacks = nullptr;
+  int r = nghttp2_session_callbacks_new(&callbacks);
+  if (r < 0) {
+    return -ENOMEM;
+  }
+  nghttp2_session_callbacks_set_on_begin_headers_callback(
+      callbacks, Callbacks::on_begin_headers);
+  nghttp2_session_callbacks_set_on_header_callback(
+      callbacks, Callbacks::on_header);
+  nghttp2_session_callbacks_set_on_frame_recv_callback(
+      callbacks, Callbacks::on_frame_recv);
+  nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
+      callbacks, Callbacks::on_data_chunk_recv);
+  nghttp2_session_callbacks_set_on_stream_close_callback(
+      callbacks, Callbacks::on_stream_close);
+
+  nghttp2_option* option = nullptr;
+  r = nghttp2_option_new(&option);
+  if (r < 0) {
+    nghttp2_session_callbacks_del(callbacks);
+    return -ENOMEM;
+  }
+  // window updates are sent as recv_body() consumes the request body
+  nghttp2_option_set_no_auto_window_update(option, 1);
+
+  r = nghttp2_session_server_new2(&session, callbacks, this, option);
+  nghttp2_option_del(option);
+  nghttp2_session_callbacks_del(callbacks);
+  if (r < 0) {
+    ldout(cct, 1) << "http2: failed to create session: "
+        << nghttp2_strerror(r) << dendl;
+    return -ENOMEM;
+  }
+
+  const nghttp2_settings_entry entries[] = {
+    {NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, settings.max_concurrent_streams},
+    {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, settings.window_size},
+    {NGHTTP2_SETTINGS_MAX_HEADER_LIST_SIZE,
+     static_cast<uint32_t>(settings.header_limit)},
+  };
+  r = nghttp2_submit_settings(session, NGHTTP2_FLAG_NONE,
+                              entries, std::size(entries));
+  if (r < 0) {
+    ldout(cct, 1) << "http2: failed to submit settings: "
+        << nghttp2_strerror(r) << dendl;
+    return -EINVAL;
+  }
+  // let every stream fill its window at once
+  const uint64_t connection_window = std::min<uint64_t>(
+      std::numeric_limits<int32_t>::max(),
+      uint64_t(settings.window_size) * settings.max_concurrent_streams);
+  r = nghttp2_session_set_local_window_size(
+      session, NGHTTP2_FLAG_NONE, 0, static_cast<int32_t>(connection_window));
+  if (r < 0) {
+    ldout(cct, 1) << "http2: failed to set the connection window: "
+        << nghttp2_strerror(r) << dendl;
+    return -EINVAL;
+  }
+  return 0;
+}
+
+int Session::receive(const void* data, size_t len)
+{
+  const ssize_t r = nghttp2_session_mem_recv(
+      session, static_cast<const uint8_t*>(data), len);
+  consume_unread();
+  if (r < 0) {
+    ldout(cct, 1) << "http2: failed to process input: "
+        << nghttp2_strerror(r) << dendl;
+    return -EPROTO;
+  }
+  return 0;
+}
+
+int Session::output(std::string& out, size_t max)
+{
+  while (out.size() < max) {
+    const uint8_t* data = nullptr;
+    const ssize_t n = nghttp2_session_mem_send(session, &data);
+    if (n < 0) {
+      ldout(cct, 1) << "http2: failed to serialize output: "
+          << nghttp2_strerror(n) << dendl;
+      return -EPROTO;
+    }
+    if (n == 0) {
+      break;
+    }
+    out.append(reinterpret_cast<const char*>(data), n);
+  }
+  // streams closed by the frames sent may have left their body unread
+  consume_unread();
+  return 0;
+}
+
+std::vector<std::shared_ptr<StreamIO>> Session::take_requests()
+{
+  return std::exchange(requests, {});
+}
+
+void Session::wake(StreamIO& stream)
+{
+  if (stream.waiter) {
+    // never resume the stream's coroutine from inside nghttp2
+    boost::asio::post(ex, [s = stream.shared_from_this()] {
+        if (s->waiter) {
+          s->waiter.complete({});
+        }
+      });
+  }
+}
+
+void Session::notify_output()
+{
+  output_pending = true;
+  if (writer) {
+    boost::asio::post(ex, [self = shared_from_this()] {
+        if (self->writer) {
+          self->writer.complete({});
+        }
+      });
+  }
+}
+
+void Session::wait_output(boost::asio::yield_context yield)
+{
+  if (!output_pending) {
+    boost::system::error_code ec;
+    writer.async_wait(yield[ec]);
+  }
+  output_pending = false;
+}
+
+void Session::consume_unread()
+{
+  if (unconsumed > 0) {
+    nghttp2_session_consume_connection(session, unconsumed);
+    unconsumed = 0;
+    output_pending = true; // for the window update
+  }
+}
+
+void Session::close_stream(StreamIO& stream, uint32_t error_code)
+{
+  stream.closed = true;
+  stream.error_code = error_code;
+  unconsumed += stream.rx.length();
+  stream.rx.clear();
+  wake(stream);
+}
+
+bool Session::done() const
+{
+  return shut_down || (!nghttp2_session_want_read(session) &&
+                       !nghttp2_session_want_write(session));
+}
+
+void Session::shutdown()
+{
+  if (shut_down) {
+    return;
+  }
+  shut_down = true;
+  nghttp2_session_terminate_session(session, NGHTTP2_NO_ERROR);
+  for (auto& [id, stream] : streams) {
+    stream->closed = true;
+    wake(*stream);
+  }
+  notify_output();
+}
+
+} // namespace rgw::asio::http2
@@ -0,0 +1,210 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/basic_waitable_timer.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/spawn.hpp>
+
+#include "common/async/yield_waiter.h"
+#include "common/ceph_time.h"
+#include "include/buffer.h"
+#include "rgw_client_io.h"
+
+typedef struct nghttp2_session nghttp2_session;
+
+namespace rgw::asio::http2 {
+
+// the connection preface of a client that talks HTTP/2 over cleartext tcp
+// with prior knowledge (RFC 9113 section 3.3)
+inline constexpr std::string_view client_preface =
+    "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+// the ALPN protocol id of HTTP/2 over TLS
+inline constexpr std::string_view alpn_id = "h2";
+
+struct Settings {
+  uint32_t max_concurrent_streams = 100;
+  // receive window of each stream, which bounds the request body that is
+  // buffered before process_request() reads it
+  uint32_t window_size = 1 << 20;
+  size_t header_limit = 16384;
+  // longest wait of a stream for the client to send body data or take
+  // response data, after which the stream is reset. 0 disables it
+  ceph::timespan stream_timeout{};
+};
+
+class Session;
+
+// A request on an HTTP/2 stream. Each stream is served by its own coroutine,
+// which sees this as the RestfulClient of process_request(). Its reads and
+// writes only wait for this stream's data and flow control window, so a slow
+// request doesn't hold up the others on the connection.
+class StreamIO : public io::RestfulClient,
+                 public std::enable_shared_from_this<StreamIO> {
+  friend class Session;
+  friend struct Callbacks;
+
+  Session& session;
+  const int32_t id;
+  RGWEnv env;
+  std::optional<boost::asio::yield_context> yield;
+
+  // request
+  std::string method;
+  std::string path;
+  std::string authority;
+  std::vector<std::pair<std::string, std::string>> headers;
+  size_t header_bytes = 0;
+  ceph::bufferlist rx; // received body not yet read by recv_body()
+  bool rx_eof = false;
+
+  // response
+  std::vector<std::pair<std::string, std::string>> response_headers;
+  std::string status;
+  ceph::bufferlist tx; // response body not yet taken by nghttp2
+  bool tx_eof = false; // complete_request() was called
+  bool tx_done = false; // the end of the response was handed to nghttp2
+  bool submitted = false;
+
+  bool closed = false; // by the client, or with the connection
+  uint32_t error_code = 0;
+
+  ceph::async::yield_waiter<void> waiter;
+  using timer_type = boost::asio::basic_waitable_timer<
+      ceph::coarse_mono_clock,
+      boost::asio::wait_traits<ceph::coarse_mono_clock>,
+      boost::asio::any_io_executor>;
+  timer_type timer;
+  ceph::coarse_mono_time deadline;
+  bool timed_out = false;
+
+  // suspend until woken by the session. returns false if the stream timed
+  // out first, which resets it
+  bool wait();
+  void check_closed();
+  void submit_response();
+  size_t queue_body(size_t len);
+
+ public:
+  StreamIO(Session& session, int32_t id);
+  ~StreamIO() override;
+
+  int32_t get_id() const { return id; }
+  std::string_view get_method() const { return method; }
+  std::string_view get_path() const { return path; }
+  // the value of a request header, or an empty string
+  std::string_view get_header(std::string_view name) const;
+
+  // the coroutine that serves this stream, all blocking calls suspend it
+  void set_yield(boost::asio::yield_context y) { yield.emplace(std::move(y)); }
+
+  // reset the stream if process_request() didn't complete its response
+  void finish();
+
+  int init_env(CephContext *cct) override;
+  size_t complete_request() override;
+  void flush() override;
+  size_t send_status(int status, const char *status_name) override;
+  size_t send_100_continue() override;
+  size_t send_header(const std::string_view& name,
+                     const std::string_view& value) override;
+  size_t send_content_length(uint64_t len) override;
+  size_t complete_header() override;
+  size_t recv_body(char* buf, size_t max) override;
+  size_t send_body(const char* buf, size_t len) override;
+  size_t send_body_buffers(const ceph::bufferlist& bl,
+                           size_t ofs, size_t len) override;
+
+  RGWEnv& get_env() noexcept override {
+    return env;
+  }
+};
+
+// The HTTP/2 state of a connection. It doesn't do any I/O itself: the
+// frontend feeds it the bytes read from the connection with receive(),
+// writes out what output() returns, and spawns a coroutine for each request
+// returned by take_requests(). All calls must be made from the connection's
+// strand.
+class Session : public std::enable_shared_from_this<Session> {
+  friend class StreamIO;
+  using endpoint_type = boost::asio::ip::tcp::endpoint;
+
+  CephContext* const cct;
+  boost::asio::any_io_executor ex;
+  const Settings settings;
+  const bool is_ssl;
+  const endpoint_type local_endpoint;
+  const endpoint_type remote_endpoint;
+
+  nghttp2_session* session = nullptr;
+  std::map<int32_t, std::shared_ptr<StreamIO>> streams;
+  // streams with complete request headers, waiting for a coroutine
+  std::vector<std::shared_ptr<StreamIO>> requests;
+  // request body bytes of closed streams that were never read
+  size_t unconsumed = 0;
+  bool shut_down = false;
+
+  bool output_pending = false;
+  ceph::async::yield_waiter<void> writer;
+
+  void wake(StreamIO& stream);
+  void consume_unread();
+  void close_stream(StreamIO& stream, uint32_t error_code);
+
+  // the nghttp2 callbacks
+  friend struct Callbacks;
+
+ public:
+  Session(CephContext* cct, boost::asio::any_io_executor ex,
+          const Settings& settings, bool is_ssl,
+          const endpoint_type& local_endpoint,
+          const endpoint_type& remote_endpoint);
+  ~Session();
+
+  Session(const Session&) = delete;
+  Session& operator=(const Session&) = delete;
+
+  // queue the server connection preface, returns a negative error code on
+  // failure
+  int init();
+
+  // process bytes read from the connection. returns a negative error code if
+  // the connection can't go on; a GOAWAY may still be queued for output
+  int receive(const void* data, size_t len);
+
+  // append up to @max bytes of queued frames to @out. returns a negative
+  // error code if the connection can't go on
+  int output(std::string& out, size_t max);
+
+  // the requests whose headers were received since the last call
+  std::vector<std::shared_ptr<StreamIO>> take_requests();
+
+  // wake the writer after frames were queued
+  void notify_output();
+
+  // suspend the writer until notify_output()
+  void wait_output(boost::asio::yield_context yield);
+
+  // true if no stream is open, for the idle timeout
+  bool idle() const { return streams.empty(); }
+
+  // true once there is nothing left to read or write
+  bool done() const;
+
+  // stop the session: all open streams fail their pending and future I/O,
+  // and done() returns true once the queued frames are written
+  void shutdown();
+};
+
+} // namespace rgw::asio::http2
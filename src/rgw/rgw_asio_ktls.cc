@@ -0,0 +1,129 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+#include "rgw_asio_ktls.h"
+
+#include <cerrno>
+
+#include <boost/asio/error.hpp>
+#include <boost/asio/ssl/error.hpp>
+#include <openssl/err.h>
+
+namespace rgw::asio {
+
+ktls_stream::ktls_stream(socket_type& socket, SSL_CTX* ctx)
+  : socket(socket)
+{
+  ssl = ::SSL_new(ctx);
+  if (!ssl) {
+    throw boost::system::system_error(static_cast<int>(::ERR_get_error()),
+                                      boost::asio::error::get_ssl_category());
+  }
+  // OpenSSL reads and writes the socket with a socket BIO, which it can
+  // switch to kTLS once the keys are known
+  if (::SSL_set_fd(ssl, socket.native_handle()) != 1) {
+    const auto err = static_cast<int>(::ERR_get_error());
+    ::SSL_free(ssl);
+    throw boost::system::system_error(err, boost::asio::error::get_ssl_category());
+  }
+  ::SSL_set_accept_state(ssl);
+  socket.non_blocking(true);
+}
+
+ktls_stream::~ktls_stream()
+{
+  ::SSL_free(ssl);
+}
+
+auto ktls_stream::do_handshake(boost::system::error_code& ec) -> want
+{
+  ::ERR_clear_error();
+  const int r = ::SSL_do_handshake(ssl);
+  if (r != 1) {
+    return want_from(r, ec);
+  }
+  send_offload = BIO_get_ktls_send(::SSL_get_wbio(ssl));
+  recv_offload = BIO_get_ktls_recv(::SSL_get_rbio(ssl));
+  return want::done;
+}
+
+auto ktls_stream::do_shutdown(boost::system::error_code& ec) -> want
+{
+  ::ERR_clear_error();
+  // send our close_notify without waiting for the client's
+  const int r = ::SSL_shutdown(ssl);
+  if (r >= 0) {
+    return want::done;
+  }
+  return want_from(r, ec);
+}
+
+auto ktls_stream::do_read(boost::asio::mutable_buffer buffer, size_t& bytes,
+                          boost::system::error_code& ec) -> want
+{
+  if (buffer.size() == 0) {
+    return want::done;
+  }
+  ::ERR_clear_error();
+  const int r = ::SSL_read_ex(ssl, buffer.data(), buffer.size(), &bytes);
+  if (r != 1) {
+    bytes = 0;
+    return want_from(r, ec);
+  }
+  return want::done;
+}
+
+auto ktls_stream::do_write(boost::asio::const_buffer buffer, size_t& bytes,
+                           boost::system::error_code& ec) -> want
+{
+  if (buffer.size() == 0) {
+    return want::done;
+  }
+  ::ERR_clear_error();
+  const int r = ::SSL_write_ex(ssl, buffer.data(), buffer.size(), &bytes);
+  if (r != 1) {
+    bytes = 0;
+    return want_from(r, ec);
+  }
+  return want::done;
+}
+
+auto ktls_stream::want_from(int r, boost::system::error_code& ec) -> want
+{
+  switch (::SSL_get_error(ssl, r)) {
+    case SSL_ERROR_WANT_READ:
+      return want::read;
+    case SSL_ERROR_WANT_WRITE:
+      return want::write;
+    case SSL_ERROR_ZERO_RETURN:
+      ec = boost::asio::error::eof;
+      return want::done;
+    case SSL_ERROR_SYSCALL:
+      if (errno) {
+        ec.assign(errno, boost::system::system_category());
+      } else {
+        // the peer closed the socket without a close_notify
+        ec = boost::asio::ssl::error::stream_truncated;
+      }
+      return want::done;
+    default:
+      ec.assign(static_cast<int>(::ERR_get_error()),
+                boost::asio::error::get_ssl_category());
+      if (!ec) {
+        ec = boost::asio::ssl::error::unexpected_result;
+      }
+      return want::done;
+  }
+}
+
+auto ktls_stream::want_from(boost::system::error_code& ec) -> want
+{
+  if (ec == boost::asio::error::would_block ||
+      ec == boost::asio::error::try_again) {
+    ec.clear();
+    return want::write;
+  }
+  return want::done;
+}
+
+} // namespace rgw::asio
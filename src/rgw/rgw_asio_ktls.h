@@ -0,0 +1,241 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+#pragma once
+
+#include <type_traits>
+
+#include <boost/asio/append.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/compose.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <openssl/ssl.h>
+
+namespace rgw::asio {
+
+// A TLS stream where OpenSSL does the I/O on the tcp socket itself, instead
+// of through memory BIOs like boost::asio::ssl::stream. That lets OpenSSL hand
+// the record encryption to the kernel (kTLS) at the end of the handshake when
+// the context has SSL_OP_ENABLE_KTLS and the kernel supports the cipher, and
+// to the NIC where the driver offloads it.
+//
+// Once the kernel encrypts the connection's output, writes go straight to
+// the socket. A gathered write of bufferlist buffers is then sent without
+// copying them into user space records, like on a plain connection. Reads
+// always go through SSL_read(), which reads plaintext from the kernel with
+// receive offload, so alerts and other records are still handled by OpenSSL.
+//
+// Operations must not be called concurrently, except for one read with one
+// write as for a socket, and all of them must run on the same strand.
+class ktls_stream {
+ public:
+  using socket_type = boost::asio::ip::tcp::socket;
+  using executor_type = socket_type::executor_type;
+
+  // throws boost::system::system_error if the SSL object can't be created
+  ktls_stream(socket_type& socket, SSL_CTX* ctx);
+  ~ktls_stream();
+
+  ktls_stream(const ktls_stream&) = delete;
+  ktls_stream& operator=(const ktls_stream&) = delete;
+
+  executor_type get_executor() { return socket.get_executor(); }
+  socket_type& lowest_layer() { return socket; }
+  SSL* native_handle() { return ssl; }
+
+  // true if the kernel encrypts the output, once the handshake is done
+  bool ktls_send() const { return send_offload; }
+  // true if the kernel decrypts the input, once the handshake is done
+  bool ktls_recv() const { return recv_offload; }
+
+  template <typename CompletionToken>
+  auto async_handshake(CompletionToken&& token) {
+    return start<void(boost::system::error_code)>(
+        [this] (boost::system::error_code& ec, size_t&) {
+          return do_handshake(ec);
+        }, std::forward<CompletionToken>(token));
+  }
+
+  template <typename CompletionToken>
+  auto async_shutdown(CompletionToken&& token) {
+    return start<void(boost::system::error_code)>(
+        [this] (boost::system::error_code& ec, size_t&) {
+          return do_shutdown(ec);
+        }, std::forward<CompletionToken>(token));
+  }
+
+  template <typename MutableBufferSequence, typename ReadToken>
+  auto async_read_some(const MutableBufferSequence& buffers, ReadToken&& token) {
+    const auto buffer = first_buffer<boost::asio::mutable_buffer>(buffers);
+    return start<void(boost::system::error_code, size_t)>(
+        [this, buffer] (boost::system::error_code& ec, size_t& bytes) {
+          return do_read(buffer, bytes, ec);
+        }, std::forward<ReadToken>(token));
+  }
+
+  template <typename ConstBufferSequence, typename WriteToken>
+  auto async_write_some(const ConstBufferSequence& buffers, WriteToken&& token) {
+    return start<void(boost::system::error_code, size_t)>(
+        [this, buffers] (boost::system::error_code& ec, size_t& bytes) {
+          return do_write_some(buffers, bytes, ec);
+        }, std::forward<WriteToken>(token));
+  }
+
+  template <typename MutableBufferSequence>
+  size_t read_some(const MutableBufferSequence& buffers,
+                   boost::system::error_code& ec) {
+    const auto buffer = first_buffer<boost::asio::mutable_buffer>(buffers);
+    return run([this, buffer] (boost::system::error_code& ec, size_t& bytes) {
+        return do_read(buffer, bytes, ec);
+      }, ec);
+  }
+
+  template <typename MutableBufferSequence>
+  size_t read_some(const MutableBufferSequence& buffers) {
+    boost::system::error_code ec;
+    const size_t bytes = read_some(buffers, ec);
+    if (ec) {
+      throw boost::system::system_error(ec);
+    }
+    return bytes;
+  }
+
+  template <typename ConstBufferSequence>
+  size_t write_some(const ConstBufferSequence& buffers,
+                    boost::system::error_code& ec) {
+    return run([this, &buffers] (boost::system::error_code& ec, size_t& bytes) {
+        return do_write_some(buffers, bytes, ec);
+      }, ec);
+  }
+
+  template <typename ConstBufferSequence>
+  size_t write_some(const ConstBufferSequence& buffers) {
+    boost::system::error_code ec;
+    const size_t bytes = write_some(buffers, ec);
+    if (ec) {
+      throw boost::system::system_error(ec);
+    }
+    return bytes;
+  }
+
+ private:
+  socket_type& socket;
+  SSL* ssl = nullptr;
+  bool send_offload = false;
+  bool recv_offload = false;
+
+  // what a non-blocking step needs before it can be retried
+  enum class want { done, read, write };
+
+  want do_handshake(boost::system::error_code& ec);
+  want do_shutdown(boost::system::error_code& ec);
+  want do_read(boost::asio::mutable_buffer buffer, size_t& bytes,
+               boost::system::error_code& ec);
+  want do_write(boost::asio::const_buffer buffer, size_t& bytes,
+                boost::system::error_code& ec);
+  template <typename ConstBufferSequence>
+  want do_write_some(const ConstBufferSequence& buffers, size_t& bytes,
+                     boost::system::error_code& ec) {
+    if (send_offload) {
+      // the kernel frames and encrypts the records, so the whole buffer
+      // sequence goes out in one sendmsg()
+      bytes = socket.write_some(buffers, ec);
+      return want_from(ec);
+    }
+    return do_write(first_buffer<boost::asio::const_buffer>(buffers), bytes, ec);
+  }
+  // map the result of an SSL call that failed
+  want want_from(int r, boost::system::error_code& ec);
+  // map the result of a non-blocking socket call
+  static want want_from(boost::system::error_code& ec);
+
+  template <typename Buffer, typename BufferSequence>
+  static Buffer first_buffer(const BufferSequence& buffers) {
+    auto i = boost::asio::buffer_sequence_begin(buffers);
+    const auto end = boost::asio::buffer_sequence_end(buffers);
+    for (; i != end; ++i) {
+      if (Buffer b{*i}; b.size() > 0) {
+        return b;
+      }
+    }
+    return Buffer{};
+  }
+
+  // retry a step, waiting for the socket in between
+  template <typename Step>
+  size_t run(Step&& step, boost::system::error_code& ec) {
+    for (;;) {
+      size_t bytes = 0;
+      switch (step(ec, bytes)) {
+        case want::read:
+          socket.wait(socket_type::wait_read, ec);
+          break;
+        case want::write:
+          socket.wait(socket_type::wait_write, ec);
+          break;
+        case want::done:
+          return bytes;
+      }
+      if (ec) {
+        return 0;
+      }
+    }
+  }
+
+  template <typename Signature, typename Step>
+  struct io_op {
+    ktls_stream& stream;
+    Step step;
+    enum class state { starting, waiting, posted } s = state::starting;
+
+    template <typename Self>
+    void operator()(Self& self, boost::system::error_code ec = {},
+                    size_t bytes = 0) {
+      if (s == state::posted) {
+        complete(self, ec, bytes);
+        return;
+      }
+      if (!ec) {
+        switch (step(ec, bytes)) {
+          case want::read:
+            s = state::waiting;
+            stream.socket.async_wait(socket_type::wait_read, std::move(self));
+            return;
+          case want::write:
+            s = state::waiting;
+            stream.socket.async_wait(socket_type::wait_write, std::move(self));
+            return;
+          case want::done:
+            break;
+        }
+      }
+      if (s == state::starting) {
+        // never complete from inside the initiating function
+        s = state::posted;
+        boost::asio::post(boost::asio::append(std::move(self), ec, bytes));
+        return;
+      }
+      complete(self, ec, bytes);
+    }
+
+    template <typename Self>
+    static void complete(Self& self, boost::system::error_code ec,
+                         size_t bytes) {
+      if constexpr (std::is_same_v<Signature, void(boost::system::error_code)>) {
+        self.complete(ec);
+      } else {
+        self.complete(ec, bytes);
+      }
+    }
+  };
+
+  template <typename Signature, typename Step, typename CompletionToken>
+  auto start(Step&& step, CompletionToken&& token) {
+    return boost::asio::async_compose<CompletionToken, Signature>(
+        io_op<Signature, std::decay_t<Step>>{*this, std::forward<Step>(step)},
+        token, socket);
+  }
+};
+
+} // namespace rgw::asio
@@ -23,6 +23,7 @@
 class RGWSI_Zone;
 class RGWSI_SyncModules;
 class RGWSI_Bucket_Sync;
+struct rgw_bulk_fetch_entry;
 
 struct rgw_sync_group_pipe_map;
 struct rgw_sync_bucket_pipes;
@@ -436,6 +437,10 @@ struct rgw_bucket_sync_pipe {
   RGWBucketInfo dest_bucket_info;
   std::map<std::string, bufferlist> dest_bucket_attrs;
 
+  // objects the source zone already sent in a bulk fetch, taken by the
+  // object syncs of the current listing
+  std::map<rgw_obj_key, std::shared_ptr<const rgw_bulk_fetch_entry>> prefetched;
+
   RGWBucketSyncFlowManager::pipe_rules_ref& get_rules() {
     return info.handler.rules;
   }
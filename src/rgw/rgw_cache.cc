@@ -12,14 +12,15 @@ using namespace std;
 
 int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, uint32_t mask, rgw_cache_entry_info *cache_info)
 {
+  Shard& shard = get_shard(name);
 
-  std::shared_lock rl{lock};
-  std::unique_lock wl{lock, std::defer_lock}; // may be promoted to write lock
+  std::shared_lock rl{shard.lock};
+  std::unique_lock wl{shard.lock, std::defer_lock}; // may be promoted to write lock
   if (!enabled) {
     return -ENOENT;
   }
-  auto iter = cache_map.find(name);
-  if (iter == cache_map.end()) {
+  auto iter = shard.cache_map.find(name);
+  if (iter == shard.cache_map.end()) {
     ldpp_dout(dpp, 10) << "cache get: name=" << name << " : miss" << dendl;
     if (perfcounter) {
       perfcounter->inc(l_rgw_cache_miss);
@@ -33,12 +34,12 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
     rl.unlock();
     wl.lock(); // write lock for expiration
     // check that wasn't already removed by other thread
-    iter = cache_map.find(name);
-    if (iter != cache_map.end()) {
+    iter = shard.cache_map.find(name);
+    if (iter != shard.cache_map.end()) {
       for (auto &kv : iter->second.chained_entries)
         kv.first->invalidate(kv.second);
-      remove_lru(name, iter->second.lru_iter);
-      cache_map.erase(iter);
+      remove_lru(shard, name, iter->second.lru_iter);
+      shard.cache_map.erase(iter);
     }
     if (perfcounter) {
       perfcounter->inc(l_rgw_cache_miss);
@@ -48,58 +49,72 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
 
   ObjectCacheEntry *entry = &iter->second;
 
-  if (lru_counter - entry->lru_promotion_ts > lru_window) {
-    ldpp_dout(dpp, 20) << "cache get: touching lru, lru_counter=" << lru_counter
-                   << " promotion_ts=" << entry->lru_promotion_ts << dendl;
-    rl.unlock();
-    wl.lock(); // write lock for touch_lru()
-    /* need to redo this because entry might have dropped off the cache */
-    iter = cache_map.find(name);
-    if (iter == cache_map.end()) {
-      ldpp_dout(dpp, 10) << "lost race! cache get: name=" << name << " : miss" << dendl;
-      if(perfcounter) perfcounter->inc(l_rgw_cache_miss);
-      return -ENOENT;
-    }
-
-    entry = &iter->second;
-    /* check again, we might have lost a race here */
-    if (lru_counter - entry->lru_promotion_ts > lru_window) {
-      touch_lru(dpp, name, *entry, iter->second.lru_iter);
+  bool apply_touches_now = false;
+  if (shard.lru_counter - entry->lru_promotion_ts > shard.lru_window) {
+    /* queue the promotion rather than taking the write lock for every one */
+    std::lock_guard tl{shard.touch_lock};
+    if (!entry->touch_queued) {
+      ldpp_dout(dpp, 20) << "cache get: queueing lru touch, lru_counter=" << shard.lru_counter
+                     << " promotion_ts=" << entry->lru_promotion_ts << dendl;
+      entry->touch_queued = true;
+      shard.touched.push_back(name);
+      apply_touches_now = shard.touched.size() >= touch_batch;
     }
   }
 
+  int r = 0;
   ObjectCacheInfo& src = iter->second.info;
   if(src.status == -ENOENT) {
     ldpp_dout(dpp, 10) << "cache get: name=" << name << " : hit (negative entry)" << dendl;
     if (perfcounter) perfcounter->inc(l_rgw_cache_hit);
-    return -ENODATA;
-  }
-  if ((src.flags & mask) != mask) {
+    r = -ENODATA;
+  } else if ((src.flags & mask) != mask) {
     ldpp_dout(dpp, 10) << "cache get: name=" << name << " : type miss (requested=0x"
                    << std::hex << mask << ", cached=0x" << src.flags
                    << std::dec << ")" << dendl;
     if(perfcounter) perfcounter->inc(l_rgw_cache_miss);
-    return -ENOENT;
+    r = -ENOENT;
+  } else {
+    ldpp_dout(dpp, 10) << "cache get: name=" << name << " : hit (requested=0x"
+                   << std::hex << mask << ", cached=0x" << src.flags
+                   << std::dec << ")" << dendl;
+
+    info = src;
+    if (cache_info) {
+      cache_info->cache_locator = name;
+      cache_info->gen = entry->gen;
+    }
+    if(perfcounter) perfcounter->inc(l_rgw_cache_hit);
   }
-  ldpp_dout(dpp, 10) << "cache get: name=" << name << " : hit (requested=0x"
-                 << std::hex << mask << ", cached=0x" << src.flags
-                 << std::dec << ")" << dendl;
 
-  info = src;
-  if (cache_info) {
-    cache_info->cache_locator = name;
-    cache_info->gen = entry->gen;
+  if (apply_touches_now) {
+    rl.unlock();
+    wl.lock(); // write lock for touch_lru()
+    apply_touches(dpp, shard);
   }
-  if(perfcounter) perfcounter->inc(l_rgw_cache_hit);
 
-  return 0;
+  return r;
 }
 
 bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
                                     std::initializer_list<rgw_cache_entry_info*> cache_info_entries,
 				    RGWChainedCache::Entry *chained_entry)
 {
-  std::unique_lock l{lock};
+  /* lock the shards of all entries, in index order like lock_all() */
+  std::vector<Shard*> entry_shards;
+  entry_shards.reserve(cache_info_entries.size());
+  for (auto cache_info : cache_info_entries) {
+    entry_shards.push_back(&get_shard(cache_info->cache_locator));
+  }
+  auto locked = entry_shards;
+  std::sort(locked.begin(), locked.end(),
+            [](const Shard* a, const Shard* b) { return a->index < b->index; });
+  locked.erase(std::unique(locked.begin(), locked.end()), locked.end());
+  std::vector<std::unique_lock<ceph::shared_mutex>> locks;
+  locks.reserve(locked.size());
+  for (auto shard : locked) {
+    locks.emplace_back(shard->lock);
+  }
 
   if (!enabled) {
     return false;
@@ -108,9 +123,11 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
   std::vector<ObjectCacheEntry*> entries;
   entries.reserve(cache_info_entries.size());
   /* first verify that all entries are still valid */
+  auto shard = entry_shards.begin();
   for (auto cache_info : cache_info_entries) {
     ldpp_dout(dpp, 10) << "chain_cache_entry: cache_locator="
 		   << cache_info->cache_locator << dendl;
+    auto& cache_map = (*shard++)->cache_map;
     auto iter = cache_map.find(cache_info->cache_locator);
     if (iter == cache_map.end()) {
       ldpp_dout(dpp, 20) << "chain_cache_entry: couldn't find cache locator" << dendl;
@@ -141,7 +158,8 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
 
 void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, rgw_cache_entry_info *cache_info)
 {
-  std::unique_lock l{lock};
+  Shard& shard = get_shard(name);
+  std::unique_lock l{shard.lock};
 
   if (!enabled) {
     return;
@@ -150,11 +168,13 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
   ldpp_dout(dpp, 10) << "cache put: name=" << name << " info.flags=0x"
                  << std::hex << info.flags << std::dec << dendl;
 
-  auto [iter, inserted] = cache_map.emplace(name, ObjectCacheEntry{});
+  apply_touches(dpp, shard);
+
+  auto [iter, inserted] = shard.cache_map.emplace(name, ObjectCacheEntry{});
   ObjectCacheEntry& entry = iter->second;
   entry.info.time_added = ceph::coarse_mono_clock::now();
   if (inserted) {
-    entry.lru_iter = lru.end();
+    entry.lru_iter = shard.lru.end();
   }
   ObjectCacheInfo& target = entry.info;
 
@@ -163,8 +183,7 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
   entry.chained_entries.clear();
   entry.gen++;
 
-  touch_lru(dpp, name, entry, entry.lru_iter);
-
+  touch_lru(dpp, shard, name, entry, entry.lru_iter);
   target.status = info.status;
 
   if (info.status < 0) {
@@ -218,14 +237,15 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
 // negative lookup. It must only invalidate.
 bool ObjectCache::invalidate_remove(const DoutPrefixProvider *dpp, const string& name)
 {
-  std::unique_lock l{lock};
+  Shard& shard = get_shard(name);
+  std::unique_lock l{shard.lock};
 
   if (!enabled) {
     return false;
   }
 
-  auto iter = cache_map.find(name);
-  if (iter == cache_map.end())
+  auto iter = shard.cache_map.find(name);
+  if (iter == shard.cache_map.end())
     return false;
 
   ldpp_dout(dpp, 10) << "removing " << name << " from cache" << dendl;
@@ -235,16 +255,49 @@ bool ObjectCache::invalidate_remove(const DoutPrefixProvider *dpp, const string&
     kv.first->invalidate(kv.second);
   }
 
-  remove_lru(name, iter->second.lru_iter);
-  cache_map.erase(iter);
+  remove_lru(shard, name, iter->second.lru_iter);
+  shard.cache_map.erase(iter);
   return true;
 }
 
-void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, ObjectCacheEntry& entry,
+void ObjectCache::set_ctx(CephContext *_cct)
+{
+  cct = _cct;
+  const unsigned long lru_max = cct->_conf->rgw_cache_lru_size;
+  const auto num_shards = std::clamp<unsigned long>(
+      cct->_conf.get_val<uint64_t>("rgw_cache_shards"), 1,
+      std::max(lru_max, 1ul));
+  shards.clear();
+  for (unsigned long i = 0; i < num_shards; i++) {
+    auto& shard = shards.emplace_back(std::make_unique<Shard>(i));
+    shard->lru_window = lru_max / num_shards / 2;
+  }
+  expiry = std::chrono::seconds(cct->_conf.get_val<uint64_t>(
+                                              "rgw_cache_expiry_interval"));
+}
+
+std::vector<std::unique_lock<ceph::shared_mutex>> ObjectCache::lock_all()
+{
+  std::vector<std::unique_lock<ceph::shared_mutex>> locks;
+  locks.reserve(shards.size());
+  for (auto& shard : shards) {
+    locks.emplace_back(shard->lock);
+  }
+  return locks;
+}
+
+unsigned long ObjectCache::get_shard_lru_max() const
+{
+  return std::max<unsigned long>(cct->_conf->rgw_cache_lru_size / shards.size(), 1);
+}
+
+void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, Shard& shard,
+                            const string& name, ObjectCacheEntry& entry,
 			    std::list<string>::iterator& lru_iter)
 {
-  while (lru_size > (size_t)cct->_conf->rgw_cache_lru_size) {
-    auto iter = lru.begin();
+  const auto lru_max = get_shard_lru_max();
+  while (shard.lru_size > lru_max) {
+    auto iter = shard.lru.begin();
     if ((*iter).compare(name) == 0) {
       /*
        * if the entry we're touching happens to be at the lru end, don't remove it,
@@ -252,43 +305,61 @@ void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, O
        */
       break;
     }
-    auto map_iter = cache_map.find(*iter);
+    auto map_iter = shard.cache_map.find(*iter);
     ldout(cct, 10) << "removing entry: name=" << *iter << " from cache LRU" << dendl;
-    if (map_iter != cache_map.end()) {
+    if (map_iter != shard.cache_map.end()) {
       ObjectCacheEntry& entry = map_iter->second;
       invalidate_lru(entry);
-      cache_map.erase(map_iter);
+      shard.cache_map.erase(map_iter);
     }
-    lru.pop_front();
-    lru_size--;
+    shard.lru.pop_front();
+    shard.lru_size--;
   }
 
-  if (lru_iter == lru.end()) {
-    lru.push_back(name);
-    lru_size++;
+  if (lru_iter == shard.lru.end()) {
+    shard.lru.push_back(name);
+    shard.lru_size++;
     lru_iter--;
     ldpp_dout(dpp, 10) << "adding " << name << " to cache LRU end" << dendl;
   } else {
     ldpp_dout(dpp, 10) << "moving " << name << " to cache LRU end" << dendl;
-    lru.erase(lru_iter);
-    lru.push_back(name);
-    lru_iter = lru.end();
-    --lru_iter;
+    shard.lru.splice(shard.lru.end(), shard.lru, lru_iter);
   }
 
-  lru_counter++;
-  entry.lru_promotion_ts = lru_counter;
+  shard.lru_counter++;
+  entry.lru_promotion_ts = shard.lru_counter;
+}
+
+void ObjectCache::apply_touches(const DoutPrefixProvider *dpp, Shard& shard)
+{
+  std::vector<string> touched;
+  {
+    std::lock_guard tl{shard.touch_lock};
+    touched.swap(shard.touched);
+  }
+  for (const auto& name : touched) {
+    /* the entry may have dropped off the cache since */
+    auto iter = shard.cache_map.find(name);
+    if (iter == shard.cache_map.end()) {
+      continue;
+    }
+    ObjectCacheEntry& entry = iter->second;
+    entry.touch_queued = false;
+    if (shard.lru_counter - entry.lru_promotion_ts > shard.lru_window) {
+      touch_lru(dpp, shard, name, entry, entry.lru_iter);
+    }
+  }
 }
 
-void ObjectCache::remove_lru(const string& name,
+void ObjectCache::remove_lru(Shard& shard, const string& name,
 			     std::list<string>::iterator& lru_iter)
 {
-  if (lru_iter == lru.end())
+  if (lru_iter == shard.lru.end())
     return;
 
-  lru.erase(lru_iter);
-  lru_size--;
-  lru_iter = lru.end();
+  shard.lru.erase(lru_iter);
+  shard.lru_size--;
+  lru_iter = shard.lru.end();
 }
 
 void ObjectCache::invalidate_lru(ObjectCacheEntry& entry)
@@ -302,7 +373,7 @@ void ObjectCache::invalidate_lru(ObjectCacheEntry& entry)
 
 void ObjectCache::set_enabled(bool status)
 {
-  std::unique_lock l{lock};
+  auto locks = lock_all();
 
   enabled = status;
 
@@ -313,32 +384,38 @@ void ObjectCache::set_enabled(bool status)
 
 void ObjectCache::invalidate_all()
 {
-  std::unique_lock l{lock};
+  auto locks = lock_all();
 
   do_invalidate_all();
 }
 
 void ObjectCache::do_invalidate_all()
 {
-  cache_map.clear();
-  lru.clear();
+  for (auto& shard : shards) {
+    shard->cache_map.clear();
+    shard->lru.clear();
 
-  lru_size = 0;
-  lru_counter = 0;
-  lru_window = 0;
+    shard->lru_size = 0;
+    shard->lru_counter = 0;
+    shard->lru_window = 0;
+
+    std::lock_guard tl{shard->touch_lock};
+    shard->touched.clear();
+  }
 
+  std::lock_guard l{chained_lock};
   for (auto& cache : chained_cache) {
     cache->invalidate_all();
   }
 }
 
 void ObjectCache::chain_cache(RGWChainedCache *cache) {
-  std::unique_lock l{lock};
+  std::lock_guard l{chained_lock};
   chained_cache.push_back(cache);
 }
 
 void ObjectCache::unchain_cache(RGWChainedCache *cache) {
-  std::unique_lock l{lock};
+  std::lock_guard l{chained_lock};
 
   auto iter = chained_cache.begin();
   for (; iter != chained_cache.end(); ++iter) {
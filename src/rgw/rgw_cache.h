@@ -6,6 +6,7 @@
 #include <shared_mutex> // for std::shared_lock
 #include <string>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include "include/types.h"
 #include "include/utime.h"
@@ -155,33 +156,70 @@ struct ObjectCacheEntry {
   uint64_t lru_promotion_ts;
   uint64_t gen;
   std::vector<std::pair<RGWChainedCache *, std::string> > chained_entries;
+  bool touch_queued; // protected by the shard's touch_lock
 
-  ObjectCacheEntry() : lru_promotion_ts(0), gen(0) {}
+  ObjectCacheEntry() : lru_promotion_ts(0), gen(0), touch_queued(false) {}
 };
 
+/* The cache is split in shards by name hash, each with its own lock and
+ * LRU, so that requests for different objects don't contend. The shards
+ * share enabled, expiry and the chained caches.
+ */
 class ObjectCache {
-  std::unordered_map<std::string, ObjectCacheEntry> cache_map;
-  std::list<std::string> lru;
-  unsigned long lru_size;
-  unsigned long lru_counter;
-  unsigned long lru_window;
-  ceph::shared_mutex lock = ceph::make_shared_mutex("ObjectCache");
+  /* Code that holds several shard locks takes them in index order. Each
+   * shard's lock has its own lockdep name so that lockdep checks that
+   * order instead of reporting a recursive lock. */
+  struct Shard {
+    const unsigned index;
+    std::unordered_map<std::string, ObjectCacheEntry> cache_map;
+    std::list<std::string> lru;
+    unsigned long lru_size = 0;
+    unsigned long lru_counter = 0;
+    unsigned long lru_window = 0;
+    ceph::shared_mutex lock;
+
+    // lru promotions noted by get() under the read lock, applied in
+    // batches under the write lock
+    ceph::mutex touch_lock = ceph::make_mutex("ObjectCache::Shard::touch");
+    std::vector<std::string> touched;
+
+    explicit Shard(unsigned index)
+      : index(index),
+        lock(ceph::make_shared_mutex("ObjectCache::Shard::" +
+                                     std::to_string(index))) {}
+  };
+  // once this many promotions are queued, get() applies them
+  static constexpr size_t touch_batch = 32;
+
+  std::vector<std::unique_ptr<Shard>> shards;
   CephContext *cct;
 
+  ceph::mutex chained_lock = ceph::make_mutex("ObjectCache::chained");
   std::vector<RGWChainedCache *> chained_cache;
 
-  bool enabled;
+  bool enabled; // written with all shard locks held
   ceph::timespan expiry;
 
-  void touch_lru(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheEntry& entry,
+  Shard& get_shard(const std::string& name) {
+    return *shards[std::hash<std::string>{}(name) % shards.size()];
+  }
+  std::vector<std::unique_lock<ceph::shared_mutex>> lock_all();
+  unsigned long get_shard_lru_max() const;
+
+  void touch_lru(const DoutPrefixProvider *dpp, Shard& shard,
+                 const std::string& name, ObjectCacheEntry& entry,
 		 std::list<std::string>::iterator& lru_iter);
-  void remove_lru(const std::string& name, std::list<std::string>::iterator& lru_iter);
+  void apply_touches(const DoutPrefixProvider *dpp, Shard& shard);
+  void remove_lru(Shard& shard, const std::string& name,
+                  std::list<std::string>::iterator& lru_iter);
   void invalidate_lru(ObjectCacheEntry& entry);
 
   void do_invalidate_all();
 
 public:
-  ObjectCache() : lru_size(0), lru_counter(0), lru_window(0), cct(NULL), enabled(false) { }
+  ObjectCache() : cct(NULL), enabled(false) {
+    shards.push_back(std::make_unique<Shard>(0));
+  }
   ~ObjectCache();
   int get(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheInfo& bl, uint32_t mask, rgw_cache_entry_info *cache_info);
   std::optional<ObjectCacheInfo> get(const DoutPrefixProvider *dpp, const std::string& name) {
@@ -190,6 +228,38 @@ public:
     return r < 0 ? std::nullopt : info;
   }
 
+  template<typename F>
+  void for_each(const F& f) {
+    for (auto& shard : shards) {
+      std::shared_lock l{shard->lock};
+      if (enabled) {
+        auto now  = ceph::coarse_mono_clock::now();
+        for (const auto& [name, entry] : shard->cache_map) {
+          if (expiry.count() && (now - entry.info.time_added) < expiry) {
+            f(name, entry);
+          }
+        }
+      }
+    }
+  }
+
+  void put(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheInfo& bl, rgw_cache_entry_info *cache_info);
+  bool invalidate_remove(const DoutPrefixProvider *dpp, const std::string& name);
+  void set_ctx(CephContext *_cct);
+  bool chain_cache_entry(const DoutPrefixProvider *dpp,
+                         std::initializer_list<rgw_cache_entry_info*> cache_info_entries,
+			 RGWChainedCache::Entry *chained_entry);
+
+  void set_enabled(bool status);
+
+  void chain_cache(RGWChainedCache *cache);
+  void unchain_cache(RGWChainedCache *cache);
+  void invalidate_all();
+};
+    auto r = get(dpp, name, *info, 0, nullptr);
+    return r < 0 ? std::nullopt : info;
+  }
+
   template<typename F>
   void for_each(const F& f) {
     std::shared_lock l{lock};
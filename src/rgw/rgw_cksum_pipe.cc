@@ -14,6 +14,7 @@
  */
 
 #include "rgw_cksum_pipe.h"
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -74,9 +75,20 @@ namespace rgw::putobj {
 
   int RGWPutObj_Cksum::process(ceph::buffer::list &&data, uint64_t logical_offset)
   {
+    /* with an ETag hash, both digests consume each block while it is
+     * still in cache, rather than each making its own pass */
+    static constexpr size_t fused_block = 64 * 1024;
     for (const auto& ptr : data.buffers()) {
-      _digest->Update(reinterpret_cast<const unsigned char*>(ptr.c_str()),
-                      ptr.length());
+      auto p = reinterpret_cast<const unsigned char*>(ptr.c_str());
+      if (!etag_hash) {
+	_digest->Update(p, ptr.length());
+	continue;
+      }
+      for (size_t off = 0; off < ptr.length(); off += fused_block) {
+	auto len = std::min(fused_block, ptr.length() - off);
+	etag_hash->Update(p + off, len);
+	_digest->Update(p + off, len);
+      }
     }
     return Pipe::process(std::move(data), logical_offset);
   }
@@ -184,6 +184,7 @@ namespace rgw::putobj {
     cksum::Digest* _digest;
     cksum::Cksum _cksum;
     cksum_hdr_t cksum_hdr;
+    ceph::crypto::MD5* etag_hash{nullptr};
 
   public:
 
@@ -206,6 +207,11 @@ namespace rgw::putobj {
       return cksum_hdr;
     }
 
+    /* also feed the caller's ETag hash, in the same pass over the data */
+    void set_etag_hash(ceph::crypto::MD5* hash) {
+      etag_hash = hash;
+    }
+
     const cksum::Cksum& finalize() {
       _cksum = finalize_digest(_digest, _type);
       _cksum.flags = flags; // n.b., this may clear the COMPOSITE flag
@@ -30,5 +30,16 @@ namespace io {
   return init_error;
 }
 
+size_t RestfulClient::send_body_buffers(const ceph::bufferlist& bl,
+                                        const size_t ofs,
+                                        const size_t len)
+{
+  size_t sent = 0;
+  for_each_buffer(bl, ofs, len, [this, &sent] (const char* buf, size_t n) {
+    sent += send_body(buf, n);
+  });
+  return sent;
+}
+
 } /* namespace io */
 } /* namespace rgw */
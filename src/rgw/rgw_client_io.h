@@ -145,12 +145,42 @@ public:
    * of response's body. On failure throws rgw::io::Exception. */
   virtual size_t send_body(const char* buf, size_t len) = 0;
 
+  /* Generate a part of response's body by taking exactly @len bytes, starting
+   * at @ofs, from the buffer list @bl without making them contiguous first.
+   * The default implementation passes each of the underlying buffers to
+   * send_body(). On success returns number of generated bytes of response's
+   * body. On failure throws rgw::io::Exception. */
+  virtual size_t send_body_buffers(const ceph::bufferlist& bl,
+                                   size_t ofs, size_t len);
+
   /* Flushes all already generated data to a direct client of RadosGW.
    * On failure throws rgw::io::Exception containing errno. */
   virtual void flush() = 0;
 } /* rgw::io::RestfulClient */;
 
 
+/* Call @f with the pointer and length of each contiguous piece of the @len
+ * bytes starting at @ofs of @bl. */
+template <typename F>
+void for_each_buffer(const ceph::bufferlist& bl, size_t ofs, size_t len,
+                     F&& f)
+{
+  for (const auto& ptr : bl.buffers()) {
+    if (len == 0) {
+      break;
+    }
+    if (ofs >= ptr.length()) {
+      ofs -= ptr.length();
+      continue;
+    }
+    const size_t n = std::min<size_t>(ptr.length() - ofs, len);
+    f(ptr.c_str() + ofs, n);
+    ofs = 0;
+    len -= n;
+  }
+}
+
+
 /* Abstract decorator over any implementation of rgw::io::RestfulClient
  * which could be provided both as a pointer-to-object or the object itself. */
 template <typename DecorateeT>
@@ -239,6 +269,12 @@ public:
     return get_decoratee().send_body(buf, len);
   }
 
+  size_t send_body_buffers(const ceph::bufferlist& bl,
+                           const size_t ofs,
+                           const size_t len) override {
+    return get_decoratee().send_body_buffers(bl, ofs, len);
+  }
+
   void flush() override {
     return get_decoratee().flush();
   }
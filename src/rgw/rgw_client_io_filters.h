@@ -9,6 +9,7 @@
 
 #include "rgw_common.h"
 #include "rgw_client_io.h"
+#include "rgw_perf_counters.h"
 
 namespace rgw {
 namespace io {
@@ -121,6 +122,19 @@ public:
     return sent;
   }
 
+  size_t send_body_buffers(const ceph::bufferlist& bl,
+                           const size_t ofs,
+                           const size_t len) override {
+    const auto sent = DecoratedRestfulClient<T>::send_body_buffers(bl, ofs, len);
+    lsubdout(cct, rgw, 30) << "AccountingFilter::send_body_buffers: e="
+        << (enabled ? "1" : "0") << ", sent=" << sent << ", total="
+        << total_sent << dendl;
+    if (enabled) {
+      total_sent += sent;
+    }
+    return sent;
+  }
+
   size_t complete_request() override {
     const auto sent = DecoratedRestfulClient<T>::complete_request();
     lsubdout(cct, rgw, 30) << "AccountingFilter::complete_request: e="
@@ -172,6 +186,8 @@ public:
   size_t send_chunked_transfer_encoding() override;
   size_t complete_header() override;
   size_t send_body(const char* buf, size_t len) override;
+  size_t send_body_buffers(const ceph::bufferlist& bl,
+                           size_t ofs, size_t len) override;
   size_t complete_request() override;
 };
 
@@ -181,6 +197,9 @@ size_t BufferingFilter<T>::send_body(const char* const buf,
 {
   if (buffer_data) {
     data.append(buf, len);
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_send_copied_bytes, len);
+    }
 
     lsubdout(cct, rgw, 30) << "BufferingFilter<T>::send_body: defer count = "
         << len << dendl;
@@ -190,6 +209,25 @@ size_t BufferingFilter<T>::send_body(const char* const buf,
   return DecoratedRestfulClient<T>::send_body(buf, len);
 }
 
+template <typename T>
+size_t BufferingFilter<T>::send_body_buffers(const ceph::bufferlist& bl,
+                                             const size_t ofs,
+                                             const size_t len)
+{
+  if (buffer_data) {
+    /* Share the buffers rather than copying them. */
+    ceph::bufferlist deferred;
+    deferred.substr_of(bl, ofs, len);
+    data.claim_append(deferred);
+
+    lsubdout(cct, rgw, 30) << "BufferingFilter<T>::send_body_buffers: defer count = "
+        << len << dendl;
+    return 0;
+  }
+
+  return DecoratedRestfulClient<T>::send_body_buffers(bl, ofs, len);
+}
+
 template <typename T>
 size_t BufferingFilter<T>::send_content_length(const uint64_t len)
 {
@@ -237,12 +275,10 @@ size_t BufferingFilter<T>::complete_request()
   }
 
   if (buffer_data) {
-    /* We are sending each buffer separately to avoid extra memory shuffling
+    /* We are sending the buffers as they are to avoid extra memory shuffling
      * that would occur on data.c_str() to provide a continuous memory area. */
-    for (const auto& ptr : data.buffers()) {
-      sent += DecoratedRestfulClient<T>::send_body(ptr.c_str(),
-                                                   ptr.length());
-    }
+    sent += DecoratedRestfulClient<T>::send_body_buffers(data, 0,
+                                                         data.length());
     data.clear();
     buffer_data = false;
     lsubdout(cct, rgw, 30) << "BufferingFilter::complete_request: buffer_data: sent="
@@ -301,6 +337,26 @@ public:
     }
   }
 
+  size_t send_body_buffers(const ceph::bufferlist& bl,
+                           const size_t ofs,
+                           const size_t len) override {
+    if (! chunking_enabled) {
+      return DecoratedRestfulClient<T>::send_body_buffers(bl, ofs, len);
+    } else {
+      static constexpr char HEADER_END[] = "\r\n";
+      char chunk_size[32];
+      const auto chunk_size_len = snprintf(chunk_size, sizeof(chunk_size),
+                                           "%zx\r\n", len);
+      size_t sent = 0;
+
+      sent += DecoratedRestfulClient<T>::send_body(chunk_size, chunk_size_len);
+      sent += DecoratedRestfulClient<T>::send_body_buffers(bl, ofs, len);
+      sent += DecoratedRestfulClient<T>::send_body(HEADER_END,
+                                                   sizeof(HEADER_END) - 1);
+      return sent;
+    }
+  }
+
   size_t complete_request() override {
     size_t sent = 0;
 
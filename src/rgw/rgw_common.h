@@ -106,6 +106,7 @@ using ceph::crypto::MD5;
 #define RGW_ATTR_MANIFEST    	RGW_ATTR_PREFIX "manifest"
 #define RGW_ATTR_USER_MANIFEST  RGW_ATTR_PREFIX "user_manifest"
 #define RGW_ATTR_SHARE_MANIFEST RGW_ATTR_PREFIX "shared_manifest"
+#define RGW_ATTR_DEDUP_CHUNKED  RGW_ATTR_PREFIX "dedup_chunked"
 #define RGW_ATTR_AMZ_WEBSITE_REDIRECT_LOCATION	RGW_ATTR_PREFIX RGW_AMZ_WEBSITE_REDIRECT_LOCATION
 #define RGW_ATTR_SLO_MANIFEST   RGW_ATTR_PREFIX "slo_manifest"
 /* Information whether an object is SLO or not must be exposed to
@@ -163,6 +164,10 @@ using ceph::crypto::MD5;
 
 #define RGW_ATTR_APPEND_PART_NUM    RGW_ATTR_PREFIX "append_part_num"
 
+/* the data of a small object, stored in place of the head object's data,
+ * see rgw_inline_data_max_size. never exposed as an object attr */
+#define RGW_ATTR_INLINE_DATA    RGW_ATTR_PREFIX "inline_data"
+
 /* Attrs to store cloudtier config information. These are used internally
  * for the replication of cloudtiered objects but not stored as xattrs in
  * the head object. */
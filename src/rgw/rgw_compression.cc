@@ -1,6 +1,11 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
 // vim: ts=8 sw=2 sts=2 expandtab ft=cpp
 
+#include <algorithm>
+
+#include <boost/asio/post.hpp>
+
+#include "common/async/context_pool.h"
 #include "rgw_compression.h"
 
 #define dout_subsys ceph_subsys_rgw
@@ -41,8 +46,147 @@ int rgw_compression_info_from_attrset(const map<string, bufferlist>& attrs,
 
 //------------RGWPutObj_Compress---------------
 
+// shared by all uploads, started on first use
+static ceph::async::io_context_pool& compression_pool(CephContext* cct)
+{
+  static ceph::async::io_context_pool pool(
+    cct->_conf.get_val<uint64_t>("rgw_compression_threads"));
+  return pool;
+}
+
+RGWPutObj_Compress::RGWPutObj_Compress(CephContext* cct_, CompressorRef compressor,
+                                       rgw::sal::DataProcessor *next,
+                                       optional_yield y)
+  : Pipe(next), cct(cct_), compressor(compressor), y(y)
+{
+  if (cct->_conf.get_val<uint64_t>("rgw_compression_threads") > 0) {
+    window = std::max<uint64_t>(1, cct->_conf.get_val<uint64_t>("rgw_compression_window"));
+  }
+}
+
+RGWPutObj_Compress::~RGWPutObj_Compress()
+{
+  // workers still reference this filter
+  wait_all();
+}
+
+void RGWPutObj_Compress::add_block(uint64_t logical_offset, uint64_t len)
+{
+  compression_block newbl;
+  size_t bs = blocks.size();
+  newbl.old_ofs = logical_offset;
+  newbl.new_ofs = bs > 0 ? blocks[bs-1].len + blocks[bs-1].new_ofs : 0;
+  newbl.len = len;
+  blocks.push_back(newbl);
+
+  compressed_ofs = newbl.new_ofs;
+}
+
+void RGWPutObj_Compress::submit(bufferlist&& in, uint64_t logical_offset)
+{
+  auto job = std::make_shared<Job>();
+  job->in = std::move(in);
+  job->logical_offset = logical_offset;
+  job->compressor_message = compressor_message;
+  jobs.push_back(job);
+
+  auto pool = compression_pool(cct).get_executor();
+  if (y) {
+    auto ex = y.get_yield_context().get_executor();
+    boost::asio::post(pool, [this, job, ex] {
+        int r = compressor->compress(job->in, job->out, job->compressor_message);
+        // nothing touches this filter once the job is done, so that must
+        // be the last step
+        boost::asio::post(ex, [this, job, r] {
+            job->r = r;
+            job->done = true;
+            if (waiter) {
+              waiter.complete({});
+            }
+          });
+      });
+    return;
+  }
+  boost::asio::post(pool, [this, job] {
+      int r = compressor->compress(job->in, job->out, job->compressor_message);
+      std::lock_guard l{lock};
+      job->r = r;
+      job->done = true;
+      cond.notify_all();
+    });
+}
+
+bool RGWPutObj_Compress::is_done(const Job& job)
+{
+  if (y) {
+    return job.done;
+  }
+  std::lock_guard l{lock};
+  return job.done;
+}
+
+template <typename Pred>
+void RGWPutObj_Compress::wait_until(Pred&& pred)
+{
+  if (y) {
+    while (!pred()) {
+      boost::system::error_code ec;
+      waiter.async_wait(y.get_yield_context()[ec]);
+    }
+    return;
+  }
+  std::unique_lock l{lock};
+  cond.wait(l, std::forward<Pred>(pred));
+}
+
+int RGWPutObj_Compress::complete_front()
+{
+  auto job = std::move(jobs.front());
+  jobs.pop_front();
+  wait_until([&job] { return job->done; });
+  if (job->r < 0) {
+    lderr(cct) << "Compression failed with exit code " << job->r
+        << " for next part, compression process failed" << dendl;
+    return -EIO;
+  }
+  compressor_message = job->compressor_message;
+  add_block(job->logical_offset, job->out.length());
+  return Pipe::process(std::move(job->out), compressed_ofs);
+}
+
+void RGWPutObj_Compress::wait_all()
+{
+  wait_until([this] {
+      return std::all_of(jobs.begin(), jobs.end(),
+                         [] (const auto& j) { return j->done; });
+    });
+}
+
 int RGWPutObj_Compress::process(bufferlist&& in, uint64_t logical_offset)
 {
+  if (window > 0 && in.length() > 0 && logical_offset > 0 && compressed) {
+    submit(std::move(in), logical_offset);
+    // pass on the parts that are done, and wait for the oldest one while
+    // the window is full
+    while (!jobs.empty()) {
+      if (!is_done(*jobs.front()) && jobs.size() < window) {
+        break;
+      }
+      int r = complete_front();
+      if (r < 0) {
+        return r;
+      }
+    }
+    return 0;
+  }
+  // parts still being compressed go first
+  while (!jobs.empty()) {
+    int r = complete_front();
+    if (r < 0) {
+      return r;
+    }
+  }
+
   bufferlist out;
   compressed_ofs = logical_offset;
 
@@ -64,15 +208,7 @@ int RGWPutObj_Compress::process(bufferlist&& in, uint64_t logical_offset)
         out = std::move(in);
       } else {
         compressed = true;
-    
-        compression_block newbl;
-        size_t bs = blocks.size();
-        newbl.old_ofs = logical_offset;
-        newbl.new_ofs = bs > 0 ? blocks[bs-1].len + blocks[bs-1].new_ofs : 0;
-        newbl.len = out.length();
-        blocks.push_back(newbl);
-
-	compressed_ofs = newbl.new_ofs;
+        add_block(logical_offset, out.length());
       }
     } else {
       compressed = false;
@@ -3,8 +3,13 @@
 
 #pragma once
 
+#include <deque>
+#include <memory>
 #include <vector>
 
+#include "common/async/yield_context.h"
+#include "common/async/yield_waiter.h"
+#include "common/ceph_mutex.h"
 #include "compressor/Compressor.h"
 #include "rgw_putobj.h"
 #include "rgw_op.h"
@@ -47,11 +52,39 @@ class RGWPutObj_Compress : public rgw::putobj::Pipe
   std::optional<int32_t> compressor_message;
   std::vector<compression_block> blocks;
   uint64_t compressed_ofs{0};
+
+  // a part compressed by the rgw_compression_threads workers
+  struct Job {
+    bufferlist in;
+    bufferlist out;
+    uint64_t logical_offset{0};
+    std::optional<int32_t> compressor_message;
+    int r{0};
+    bool done{false};
+  };
+  // parts after the first are compressed in parallel, up to
+  // rgw_compression_window at a time, and passed on in order
+  std::deque<std::shared_ptr<Job>> jobs;
+  size_t window{0};
+  // with a yield context, jobs are marked done on its executor and the
+  // request's coroutine is suspended while it waits for them. without,
+  // the request's thread blocks on the condition variable
+  optional_yield y;
+  ceph::async::yield_waiter<void> waiter;
+  ceph::mutex lock = ceph::make_mutex("RGWPutObj_Compress");
+  ceph::condition_variable cond;
+
+  void add_block(uint64_t logical_offset, uint64_t len);
+  void submit(bufferlist&& in, uint64_t logical_offset);
+  bool is_done(const Job& job);
+  template <typename Pred>
+  void wait_until(Pred&& pred);
+  int complete_front();
+  void wait_all();
 public:
   RGWPutObj_Compress(CephContext* cct_, CompressorRef compressor,
-                     rgw::sal::DataProcessor *next)
-    : Pipe(next), cct(cct_), compressor(compressor) {}
-  virtual ~RGWPutObj_Compress() override {};
+                     rgw::sal::DataProcessor *next, optional_yield y);
+  virtual ~RGWPutObj_Compress() override;
 
   int process(bufferlist&& data, uint64_t logical_offset) override;
 
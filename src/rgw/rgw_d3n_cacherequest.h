@@ -16,6 +16,7 @@
 #include <errno.h>
 #include "common/error_code.h"
 #include "common/errno.h"
+#include "include/intarith.h"
 
 #include "rgw_aio.h"
 #include "rgw_cache.h"
@@ -23,6 +24,9 @@
 #include "xxhash.h"
 
 
+// buffer, offset and length alignment of cache file I/O with O_DIRECT
+constexpr unsigned D3N_DIRECT_IO_ALIGN = 4096;
+
 struct D3nGetObjData {
   std::mutex d3n_lock;
 };
@@ -48,6 +52,8 @@ struct D3nL1CacheRequest {
 
   struct AsyncFileReadOp {
     bufferlist result;
+    bufferptr buf; // may be padded for O_DIRECT
+    off_t read_len = 0;
     unique_aio_cb_ptr aio_cb;
     using Signature = void(boost::system::error_code, bufferlist);
     using Completion = ceph::async::Completion<Signature, AsyncFileReadOp>;
@@ -56,7 +62,14 @@ struct D3nL1CacheRequest {
       ldpp_dout(dpp, 20) << "D3nDataCache: " << __func__ << "(): location=" << location << dendl;
       aio_cb.reset(new struct aiocb);
       memset(aio_cb.get(), 0, sizeof(struct aiocb));
-      aio_cb->aio_fildes = TEMP_FAILURE_RETRY(::open(location.c_str(), O_RDONLY|O_CLOEXEC|O_BINARY));
+      // O_DIRECT reads whole aligned blocks, the file ends where the data does
+      const bool direct = g_conf()->rgw_d3n_l1_direct_io &&
+        p2phase<uint64_t>(read_ofs, D3N_DIRECT_IO_ALIGN) == 0;
+      int flags = O_RDONLY|O_CLOEXEC|O_BINARY;
+      if (direct) {
+        flags |= O_DIRECT;
+      }
+      aio_cb->aio_fildes = TEMP_FAILURE_RETRY(::open(location.c_str(), flags));
       if(aio_cb->aio_fildes < 0) {
         int err = errno;
         ldpp_dout(dpp, 1) << "ERROR: D3nDataCache: " << __func__ << "(): can't open " << location << " : " << cpp_strerror(err) << dendl;
@@ -65,11 +78,12 @@ struct D3nL1CacheRequest {
       if (g_conf()->rgw_d3n_l1_fadvise != POSIX_FADV_NORMAL)
         posix_fadvise(aio_cb->aio_fildes, 0, 0, g_conf()->rgw_d3n_l1_fadvise);
 
-      bufferptr bp(read_len);
-      aio_cb->aio_buf = bp.c_str();
-      result.append(std::move(bp));
+      const size_t nbytes = direct ? p2roundup<uint64_t>(read_len, D3N_DIRECT_IO_ALIGN) : read_len;
+      buf = direct ? buffer::create_aligned(nbytes, D3N_DIRECT_IO_ALIGN) : buffer::create(nbytes);
+      aio_cb->aio_buf = buf.c_str();
+      this->read_len = read_len;
 
-      aio_cb->aio_nbytes = read_len;
+      aio_cb->aio_nbytes = nbytes;
       aio_cb->aio_offset = read_ofs;
       aio_cb->aio_sigevent.sigev_notify = SIGEV_THREAD;
       aio_cb->aio_sigevent.sigev_notify_function = libaio_cb_aio_dispatch;
@@ -87,6 +101,10 @@ struct D3nL1CacheRequest {
       boost::system::error_code ec;
       if (ret < 0) {
           ec.assign(-ret, boost::system::system_category());
+      } else if (aio_return(op.aio_cb.get()) < op.read_len) {
+          ec.assign(EIO, boost::system::system_category());
+      } else {
+          op.result.append(op.buf, 0, op.read_len);
       }
 
       ceph::async::dispatch(std::move(p), ec, std::move(op.result));
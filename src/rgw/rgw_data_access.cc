@@ -146,7 +146,7 @@ int RGWDataAccess::Object::put(bufferlist& data,
       ldpp_dout(dpp, 1) << "Cannot load plugin for compression type "
         << compression_type << dendl;
     } else {
-      compressor.emplace(driver->ctx(), plugin, filter);
+      compressor.emplace(driver->ctx(), plugin, filter, y);
       filter = &*compressor;
     }
   }
@@ -35,7 +35,8 @@ using crimson::dmclock::ClientInfo;
 enum class scheduler_t {
                         none,
                         throttler,
-                        dmclock
+                        dmclock,
+                        dmclock_tenant
 };
 
 inline scheduler_t get_scheduler_t(CephContext* const cct)
@@ -43,6 +44,8 @@ inline scheduler_t get_scheduler_t(CephContext* const cct)
   const auto scheduler_type = cct->_conf.get_val<std::string>("rgw_scheduler_type");
   if (scheduler_type == "dmclock")
     return scheduler_t::dmclock;
+  else if (scheduler_type == "dmclock-tenant")
+    return scheduler_t::dmclock_tenant;
   else if (scheduler_type == "throttler")
     return scheduler_t::throttler;
   else
@@ -75,6 +75,15 @@ public:
     int r = schedule_request_impl(client,params,time,cost,yield);
     return std::make_pair(r,SchedulerCompleter(std::bind(&Scheduler::request_complete,this)));
   }
+  // as above, also naming the tenant of the request for schedulers that
+  // queue by tenant; the others ignore it
+  auto schedule_request(const client_id& client, const std::string& tenant,
+			const ReqParams& params, const Time& time,
+			const Cost& cost, optional_yield yield)
+  {
+    int r = schedule_tenant_request_impl(client,tenant,params,time,cost,yield);
+    return std::make_pair(r,SchedulerCompleter(std::bind(&Scheduler::request_complete,this)));
+  }
   virtual void request_complete() {};
 
   virtual ~Scheduler() {};
@@ -82,6 +91,13 @@ private:
   virtual int schedule_request_impl(const client_id&, const ReqParams&,
 				    const Time&, const Cost&,
 				    optional_yield) = 0;
+  virtual int schedule_tenant_request_impl(const client_id& client,
+					   const std::string&,
+					   const ReqParams& params,
+					   const Time& time, const Cost& cost,
+					   optional_yield yield) {
+    return schedule_request_impl(client, params, time, cost, yield);
+  }
 };
 
 } // namespace rgw::dmclock
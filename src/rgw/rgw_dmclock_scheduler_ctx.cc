@@ -13,6 +13,7 @@
  *
  */
 #include "rgw_dmclock_scheduler_ctx.h"
+#include "common/perf_counters_key.h"
 
 using namespace std::literals;
 
@@ -88,6 +89,39 @@ ClientCounters::ClientCounters(CephContext *cct)
       throttle_counters::build(cct, "dmclock-scheduler");
 }
 
+TenantCounters::TenantCounters(CephContext* const cct)
+  : cache(std::make_unique<ceph::perf_counters::PerfCountersCache>(
+        cct, cct->_conf.get_val<uint64_t>("rgw_dmclock_tenant_counters_cache_size"),
+        tenant_counters::build))
+{}
+
+std::string TenantCounters::key(const std::string& tenant) const
+{
+  // label values can't be empty
+  return ceph::perf_counters::key_create("rgw_dmclock_tenant",
+      {{"tenant", tenant.empty() ? "anonymous" : tenant}});
+}
+
+void TenantCounters::on_limit(const std::string& tenant, Cost cost)
+{
+  cache->inc(key(tenant), tenant_counters::l_limit, 1);
+}
+
+void TenantCounters::on_process(const std::string& tenant,
+                                ceph::timespan wait, Cost cost)
+{
+  auto c = cache->get(key(tenant));
+  if (!c) {
+    return;
+  }
+  c->inc(tenant_counters::l_reqs);
+  c->inc(tenant_counters::l_cost, cost);
+  c->tinc(tenant_counters::l_wait_lat, wait);
+  c->hinc(tenant_counters::l_wait_hist,
+          std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count(),
+          cost);
+}
+
 void inc(ClientSums& sums, client_id client, Cost cost)
 {
   auto& sum = sums[static_cast<size_t>(client)];
@@ -177,3 +211,40 @@ PerfCountersRef build(CephContext *cct, const std::string& name)
 }
 
 } // namespace throttle_counters
+
+namespace tenant_counters {
+
+std::shared_ptr<PerfCounters> build(const std::string& name, CephContext *cct)
+{
+  PerfCountersBuilder b(cct, name, l_first, l_last);
+  b.set_prio_default(PerfCountersBuilder::PRIO_USEFUL);
+  b.add_u64_counter(l_reqs, "reqs", "Requests scheduled");
+  b.add_u64_counter(l_cost, "cost", "Cost of requests scheduled");
+  b.add_u64_counter(l_limit, "limit", "Requests rejected by limit");
+  b.add_time_avg(l_wait_lat, "wait_lat", "Time spent queued");
+
+  // wait in nanoseconds by request cost
+  PerfHistogramCommon::axis_config_d wait_axis_config{
+    "Wait (usec)",
+    PerfHistogramCommon::SCALE_LOG2, ///< Wait in logarithmic scale
+    0,                               ///< Start at 0
+    1000,                            ///< Quantization unit is 1usec
+    24,                              ///< Enough to cover ~8 seconds
+  };
+  PerfHistogramCommon::axis_config_d cost_axis_config{
+    "Cost",
+    PerfHistogramCommon::SCALE_LOG2, ///< Cost in logarithmic scale
+    0,                               ///< Start at 0
+    1,                               ///< Quantization unit is 1
+    16,                              ///< Enough to cover the usual costs
+  };
+  b.add_u64_counter_histogram(l_wait_hist, "wait_histogram",
+                              wait_axis_config, cost_axis_config,
+                              "Histogram of time spent queued by request cost");
+
+  std::shared_ptr<PerfCounters> counters(b.create_perf_counters());
+  cct->get_perfcounters_collection()->add(counters.get());
+  return counters;
+}
+
+} // namespace tenant_counters
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "common/perf_counters.h"
+#include "common/perf_counters_cache.h"
 #include "common/ceph_context.h"
 #include "common/config.h"
 #include "rgw_dmclock.h"
@@ -48,6 +49,20 @@ namespace throttle_counters {
   PerfCountersRef build(CephContext *cct, const std::string& name);
 } // namespace throttle
 
+namespace tenant_counters {
+  enum {
+        l_first = 447280,
+        l_reqs,
+        l_cost,
+        l_limit,
+        l_wait_lat,
+        l_wait_hist,
+        l_last
+  };
+
+  std::shared_ptr<PerfCounters> build(const std::string& name, CephContext *cct);
+} // namespace tenant_counters
+
 namespace rgw::dmclock {
 
 // the last client counter would be for global scheduler stats
@@ -75,6 +90,18 @@ public:
 };
 
 
+/// labeled per-tenant counters of the tenant scheduler, kept for the most
+/// recently active rgw_dmclock_tenant_counters_cache_size tenants
+class TenantCounters {
+  std::unique_ptr<ceph::perf_counters::PerfCountersCache> cache;
+  std::string key(const std::string& tenant) const;
+public:
+  TenantCounters(CephContext* const cct);
+
+  void on_limit(const std::string& tenant, Cost cost);
+  void on_process(const std::string& tenant, ceph::timespan wait, Cost cost);
+};
+
 struct ClientSum {
   uint64_t count{0};
   Cost cost{0};
@@ -111,15 +138,20 @@ public:
       dmc_client_config = std::make_shared<ClientConfig>(cct);
       // we don't have a move only cref std::function yet
       dmc_client_counters = std::make_optional<ClientCounters>(cct);
+    } else if (sched_t == scheduler_t::dmclock_tenant &&
+               cct->_conf->throttler_perf_counter) {
+      dmc_tenant_counters = std::make_unique<TenantCounters>(cct);
     }
   }
   // We need to construct a std::function from a NonCopyable object
   ClientCounters& get_dmc_client_counters() { return dmc_client_counters.value(); }
   ClientConfig* const get_dmc_client_config() const { return dmc_client_config.get(); }
+  TenantCounters* get_dmc_tenant_counters() const { return dmc_tenant_counters.get(); }
 private:
   scheduler_t sched_t;
   std::shared_ptr<ClientConfig> dmc_client_config {nullptr};
   std::optional<ClientCounters> dmc_client_counters  {std::nullopt};
+  std::unique_ptr<TenantCounters> dmc_tenant_counters;
 };
 
 } // namespace rgw::dmclock
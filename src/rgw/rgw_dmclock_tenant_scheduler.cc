@@ -0,0 +1,221 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+#include "common/async/completion.h"
+#include "rgw_dmclock_tenant_scheduler.h"
+
+#include <boost/asio/post.hpp>
+
+using namespace std::literals;
+
+namespace rgw::dmclock {
+
+TenantScheduler::Shard::Shard(boost::asio::io_context& context,
+                              Queue::ClientInfoFunc client_info_f,
+                              std::chrono::seconds idle_age)
+  : queue(std::move(client_info_f), idle_age, 2 * idle_age,
+          std::min(idle_age, std::chrono::seconds(60)), AtLimit::Reject),
+    strand(context.get_executor()),
+    timer(strand)
+{}
+
+TenantScheduler::TenantScheduler(CephContext *cct,
+                                 boost::asio::io_context& context,
+                                 TenantCounters* tenant_counters)
+  : cct(cct), executor(context.get_executor()),
+    tenant_counters(tenant_counters),
+    counters(cct, "dmclock-tenant-scheduler"),
+    max_requests(cct->_conf.get_val<int64_t>("rgw_max_concurrent_requests"))
+{
+  if (max_requests <= 0) {
+    max_requests = std::numeric_limits<int64_t>::max();
+  }
+  update_client_info(cct->_conf);
+
+  const auto idle_age = std::chrono::seconds(
+      std::max<uint64_t>(1, cct->_conf.get_val<uint64_t>("rgw_dmclock_tenant_idle_age")));
+  auto client_info_f = [this] (const std::string&) -> const ClientInfo* {
+    return client_info.load();
+  };
+  const auto num_shards = std::max<uint64_t>(1,
+      cct->_conf.get_val<uint64_t>("rgw_dmclock_tenant_shards"));
+  for (uint64_t i = 0; i < num_shards; i++) {
+    shards.push_back(std::make_unique<Shard>(context, client_info_f, idle_age));
+  }
+  cct->_conf.add_observer(this);
+}
+
+TenantScheduler::~TenantScheduler()
+{
+  cancel();
+  cct->_conf.remove_observer(this);
+}
+
+std::vector<std::string> TenantScheduler::get_tracked_keys() const noexcept
+{
+  return {
+    "rgw_dmclock_tenant_res"s,
+    "rgw_dmclock_tenant_wgt"s,
+    "rgw_dmclock_tenant_lim"s,
+    "rgw_max_concurrent_requests"s
+  };
+}
+
+void TenantScheduler::update_client_info(const ConfigProxy& conf)
+{
+  auto info = std::make_unique<ClientInfo>(
+      conf.get_val<double>("rgw_dmclock_tenant_res"),
+      conf.get_val<double>("rgw_dmclock_tenant_wgt"),
+      conf.get_val<double>("rgw_dmclock_tenant_lim"));
+  std::lock_guard lock{info_mtx};
+  client_info = info.get();
+  client_infos.push_back(std::move(info));
+}
+
+void TenantScheduler::handle_conf_change(const ConfigProxy& conf,
+                                         const std::set<std::string>& changed)
+{
+  if (changed.count("rgw_max_concurrent_requests")) {
+    auto new_max = conf.get_val<int64_t>("rgw_max_concurrent_requests");
+    max_requests = new_max > 0 ? new_max : std::numeric_limits<int64_t>::max();
+  }
+  if (changed.count("rgw_dmclock_tenant_res") ||
+      changed.count("rgw_dmclock_tenant_wgt") ||
+      changed.count("rgw_dmclock_tenant_lim")) {
+    update_client_info(conf);
+    for (auto& shard : shards) {
+      shard->queue.update_client_infos();
+    }
+  }
+  for (auto& shard : shards) {
+    schedule(*shard, crimson::dmclock::TimeZero);
+  }
+}
+
+int TenantScheduler::schedule_request_impl(const client_id& client,
+                                           const ReqParams& params,
+                                           const Time& time, const Cost& cost,
+                                           optional_yield yield_ctx)
+{
+  return schedule_tenant_request_impl(client, {}, params, time, cost, yield_ctx);
+}
+
+int TenantScheduler::schedule_tenant_request_impl(const client_id& client,
+                                                  const std::string& tenant,
+                                                  const ReqParams& params,
+                                                  const Time& time,
+                                                  const Cost& cost,
+                                                  optional_yield yield_ctx)
+{
+    ceph_assert(yield_ctx);
+
+    auto &yield = yield_ctx.get_yield_context();
+    boost::system::error_code ec;
+    async_request(client, tenant, params, time, cost, yield[ec]);
+
+    if (ec){
+      if (ec == boost::system::errc::resource_unavailable_try_again)
+        return -EAGAIN;
+      else
+        return -ec.value();
+    }
+
+    return 0;
+}
+
+void TenantScheduler::request_complete()
+{
+  --outstanding_requests;
+  if (auto c = counters()) {
+    c->inc(throttle_counters::l_outstanding, -1);
+  }
+  // one request slot is free, hand it to the next throttled shard
+  const size_t start = next_wakeup++;
+  for (size_t i = 0; i < shards.size(); i++) {
+    auto& shard = *shards[(start + i) % shards.size()];
+    if (shard.throttled.exchange(false)) {
+      schedule(shard, crimson::dmclock::TimeZero);
+      break;
+    }
+  }
+}
+
+void TenantScheduler::cancel()
+{
+  for (auto& shard : shards) {
+    shard->queue.remove_by_req_filter([] (RequestRef&& request) {
+        auto c = static_cast<Completion*>(request.release());
+        Completion::dispatch(std::unique_ptr<Completion>{c},
+                             boost::asio::error::operation_aborted,
+                             PhaseType::priority);
+        return true;
+      });
+    shard->timer.cancel();
+  }
+}
+
+void TenantScheduler::schedule(Shard& shard, const Time& time)
+{
+  boost::asio::post(shard.strand, [this, &shard, time] {
+      shard.timer.expires_at(Clock::from_double(time));
+      shard.timer.async_wait([this, &shard] (boost::system::error_code ec) {
+          // process requests unless the wait was canceled. note that a
+          // canceled wait may execute after this TenantScheduler destructs
+          if (ec != boost::asio::error::operation_aborted) {
+            process(shard, get_time());
+          }
+        });
+    });
+}
+
+void TenantScheduler::process(Shard& shard, const Time& now)
+{
+  // must run in the shard's strand
+  assert(shard.strand.running_in_this_thread());
+
+  while (true) {
+    // take a request slot before pulling, the slots are shared by shards
+    if (outstanding_requests++ >= max_requests) {
+      shard.throttled = true;
+      if (--outstanding_requests < max_requests) {
+        // a request completed meanwhile and may have missed the flag
+        shard.throttled = false;
+        continue;
+      }
+      if (auto c = counters()) {
+        c->inc(throttle_counters::l_throttle);
+      }
+      break;
+    }
+
+    auto pull = shard.queue.pull_request(now);
+
+    if (pull.is_none()) {
+      --outstanding_requests;
+      // no pending requests, cancel the timer
+      shard.timer.cancel();
+      break;
+    }
+    if (pull.is_future()) {
+      --outstanding_requests;
+      // update the timer based on the future time
+      schedule(shard, pull.getTime());
+      break;
+    }
+    if (auto c = counters()) {
+      c->inc(throttle_counters::l_outstanding);
+    }
+
+    // complete the request
+    auto& r = pull.get_retn();
+    if (tenant_counters) {
+      auto lat = Clock::from_double(now) - Clock::from_double(r.request->started);
+      tenant_counters->on_process(r.request->tenant, lat, r.request->cost);
+    }
+    auto c = static_cast<Completion*>(r.request.release());
+    Completion::post(std::unique_ptr<Completion>{c},
+                     boost::system::error_code{}, r.phase);
+  }
+}
+
+} // namespace rgw::dmclock
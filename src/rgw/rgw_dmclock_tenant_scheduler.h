@@ -0,0 +1,173 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation. See file COPYING.
+ *
+ */
+
+#pragma once
+
+#include "common/async/completion.h"
+
+#include <boost/asio/basic_waitable_timer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/strand.hpp>
+#include "rgw_dmclock_scheduler.h"
+#include "rgw_dmclock_scheduler_ctx.h"
+
+namespace rgw::dmclock {
+  namespace async = ceph::async;
+
+struct TenantRequest {
+  client_id client;
+  std::string tenant;
+  Time started;
+  Cost cost;
+};
+
+/*
+ * A dmclock request scheduling service for use with boost::asio, where
+ * each tenant is a dmclock client so that a busy tenant can't crowd out
+ * the others.
+ *
+ * Tenants are spread over rgw_dmclock_tenant_shards queues, each with its
+ * own lock and its own timer on a strand, so frontend threads only contend
+ * on the queue of the tenants they serve. Clients are created by dmclock
+ * on a tenant's first request and erased once idle for twice
+ * rgw_dmclock_tenant_idle_age, so the number of tracked tenants follows
+ * the active ones. rgw_max_concurrent_requests is shared by all shards.
+ */
+class TenantScheduler : public md_config_obs_t, public Scheduler {
+ public:
+  TenantScheduler(CephContext *cct, boost::asio::io_context& context,
+                  TenantCounters* tenant_counters);
+  ~TenantScheduler();
+
+  using executor_type = boost::asio::io_context::executor_type;
+
+  /// submit an async request for dmclock scheduling as in AsyncScheduler,
+  /// queued by tenant
+  template <typename CompletionToken>
+  auto async_request(const client_id& client, const std::string& tenant,
+                     const ReqParams& params, const Time& time, Cost cost,
+                     CompletionToken&& token);
+
+  /// returns a throttle unit granted by async_request()
+  void request_complete() override;
+
+  /// cancel all queued requests, invoking their completion handlers with an
+  /// operation_aborted error and default-constructed result
+  void cancel();
+
+  std::vector<std::string> get_tracked_keys() const noexcept override;
+  void handle_conf_change(const ConfigProxy& conf,
+                          const std::set<std::string>& changed) override;
+
+ private:
+  int schedule_request_impl(const client_id& client, const ReqParams& params,
+                            const Time& time, const Cost& cost,
+                            optional_yield yield_ctx) override;
+  int schedule_tenant_request_impl(const client_id& client,
+                                   const std::string& tenant,
+                                   const ReqParams& params,
+                                   const Time& time, const Cost& cost,
+                                   optional_yield yield_ctx) override;
+
+  static constexpr bool IsDelayed = false;
+  using Queue = crimson::dmclock::PullPriorityQueue<std::string, TenantRequest, IsDelayed>;
+  using RequestRef = typename Queue::RequestRef;
+
+  using Signature = void(boost::system::error_code, PhaseType);
+  using Completion = async::Completion<Signature, async::AsBase<TenantRequest>>;
+
+  using Clock = ceph::coarse_real_clock;
+  using Strand = boost::asio::strand<executor_type>;
+  using Timer = boost::asio::basic_waitable_timer<Clock,
+        boost::asio::wait_traits<Clock>, Strand>;
+
+  struct Shard {
+    Queue queue; //< dmclock priority queue of this shard's tenants
+    Strand strand; //< serializes timer and process() calls
+    Timer timer; //< timer for the next scheduled request
+    /// set when process() stopped at max_requests
+    std::atomic<bool> throttled = false;
+
+    Shard(boost::asio::io_context& context,
+          Queue::ClientInfoFunc client_info_f,
+          std::chrono::seconds idle_age);
+  };
+  std::vector<std::unique_ptr<Shard>> shards;
+
+  Shard& shard_of(const std::string& tenant) {
+    return *shards[std::hash<std::string>{}(tenant) % shards.size()];
+  }
+
+  CephContext *const cct;
+  executor_type executor;
+  TenantCounters *const tenant_counters;
+  ThrottleCounters counters;
+
+  /// every tenant shares the same reservation, weight and limit. on config
+  /// changes a new ClientInfo is published; the old ones are kept since
+  /// queues may still point at them
+  std::mutex info_mtx;
+  std::vector<std::unique_ptr<ClientInfo>> client_infos;
+  std::atomic<const ClientInfo*> client_info;
+  void update_client_info(const ConfigProxy& conf);
+
+  /// max request throttle
+  std::atomic<int64_t> max_requests;
+  std::atomic<int64_t> outstanding_requests = 0;
+  /// the next throttled shard to wake up, for fairness between shards
+  std::atomic<size_t> next_wakeup = 0;
+
+  /// set a timer to process the next request of a shard
+  void schedule(Shard& shard, const Time& time);
+
+  /// process ready requests of a shard, then schedule its next pending request
+  void process(Shard& shard, const Time& now);
+};
+
+
+template <typename CompletionToken>
+auto TenantScheduler::async_request(const client_id& client,
+                                    const std::string& tenant,
+                                    const ReqParams& params,
+                                    const Time& time, Cost cost,
+                                    CompletionToken&& token)
+{
+  return boost::asio::async_initiate<CompletionToken, Signature>(
+      [this] (auto handler, auto ex, const client_id& client,
+              const std::string& tenant, const ReqParams& params,
+              const Time& time, Cost cost) {
+        auto& shard = shard_of(tenant);
+        // allocate the Request and add it to the queue
+        auto completion = Completion::create(ex, std::move(handler),
+                                             TenantRequest{client, tenant, time, cost});
+        // cast to unique_ptr<TenantRequest>
+        auto req = RequestRef{std::move(completion)};
+        int r = shard.queue.add_request(std::move(req), tenant, params, time, cost);
+        if (r == 0) {
+          // schedule an immediate call to process() on the shard's strand
+          schedule(shard, crimson::dmclock::TimeZero);
+        } else {
+          // post the error code
+          boost::system::error_code ec(r, boost::system::system_category());
+          // cast back to Completion
+          auto completion = static_cast<Completion*>(req.release());
+          async::post(std::unique_ptr<Completion>{completion},
+                      ec, PhaseType::priority);
+          if (tenant_counters) {
+            tenant_counters->on_limit(tenant, cost);
+          }
+        }
+      }, token, executor, client, tenant, params, time, cost);
+}
+
+} // namespace rgw::dmclock
@@ -1914,7 +1914,7 @@ namespace rgw {
         ldout(state->cct, 1) << "Cannot load plugin for rgw_compression_type "
                          << compression_type << dendl;
       } else {
-        compressor.emplace(state->cct, plugin, filter);
+        compressor.emplace(state->cct, plugin, filter, null_yield);
         filter = &*compressor;
       }
     }
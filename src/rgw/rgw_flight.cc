@@ -24,8 +24,10 @@
 #include "arrow/flight/server.h"
 
 #include "parquet/arrow/reader.h"
+#include "parquet/properties.h"
 
 #include "common/dout.h"
+#include "include/split.h"
 #include "rgw_op.h"
 
 #include "rgw_flight.h"
@@ -58,6 +60,59 @@ arw::Result<FlightKey> TicketToFlightKey(const flt::Ticket& t) {
   }
 }
 
+// FlightTicket; encoded as
+// "<key>:<first row group>:<row groups>:<signature>:<tenant>:<bucket>:<instance>:<name>"
+// where the object name comes last since it may contain ':'. A plain
+// flight key is accepted too and means the whole flight.
+
+flt::Ticket FlightTicketToTicket(const FlightTicket& ft) {
+  flt::Ticket result;
+  result.ticket = std::to_string(ft.key) + ":" +
+    std::to_string(ft.first_row_group) + ":" +
+    std::to_string(ft.num_row_groups) + ":" +
+    ft.signature + ":" +
+    ft.tenant_name + ":" + ft.bucket_name + ":" +
+    ft.object_key.instance + ":" + ft.object_key.name;
+  return result;
+}
+
+arw::Result<FlightTicket> TicketToFlightTicket(const flt::Ticket& t) {
+  if (t.ticket.find(':') == std::string::npos) {
+    ARROW_ASSIGN_OR_RAISE(FlightKey key, TicketToFlightKey(t));
+    return FlightTicket(key);
+  }
+
+  std::vector<std::string> fields;
+  std::string::size_type start = 0;
+  while (fields.size() < 7) {
+    auto end = t.ticket.find(':', start);
+    if (end == std::string::npos) {
+      return arw::Status::Invalid(
+	"could not convert Ticket containing \"%s\" into a Flight Ticket",
+	t.ticket);
+    }
+    fields.push_back(t.ticket.substr(start, end - start));
+    start = end + 1;
+  }
+
+  FlightTicket result;
+  try {
+    result.key = (FlightKey) std::stoul(fields[0]);
+    result.first_row_group = std::stoi(fields[1]);
+    result.num_row_groups = std::stoi(fields[2]);
+  } catch (const std::logic_error& ex) {
+    return arw::Status::Invalid(
+      "could not convert Ticket containing \"%s\" into a Flight Ticket",
+      t.ticket);
+  }
+  result.signature = fields[3];
+  result.tenant_name = fields[4];
+  result.bucket_name = fields[5];
+  result.object_key.instance = fields[6];
+  result.object_key.name = t.ticket.substr(start);
+  return result;
+}
+
 // FlightData
 
 FlightData::FlightData(const std::string& _uri,
@@ -65,6 +120,7 @@ FlightData::FlightData(const std::string& _uri,
 		       const std::string& _bucket_name,
 		       const rgw_obj_key& _object_key,
 		       uint64_t _num_records,
+		       int _num_row_groups,
 		       uint64_t _obj_size,
 		       std::shared_ptr<arw::Schema>& _schema,
 		       std::shared_ptr<const arw::KeyValueMetadata>& _kv_metadata,
@@ -76,6 +132,7 @@ FlightData::FlightData(const std::string& _uri,
   bucket_name(_bucket_name),
   object_key(_object_key),
   num_records(_num_records),
+  num_row_groups(_num_row_groups),
   obj_size(_obj_size),
   schema(_schema),
   kv_metadata(_kv_metadata),
@@ -151,12 +208,84 @@ FlightServer::FlightServer(RGWProcessEnv& _env,
   driver(env.driver),
   dp(_dp),
   flight_store(_flight_store)
-{ }
+{
+  const auto uris =
+    driver->ctx()->_conf.get_val<std::string>("rgw_flight_endpoints");
+  for (const auto& uri : ceph::split(uris, ", ")) {
+    auto r = flt::Location::Parse(std::string(uri));
+    if (!r.ok()) {
+      ERROR << "could not parse flight endpoint uri: " << uri << dendl;
+      continue;
+    }
+    endpoints.push_back(*r);
+  }
+  ticket_secret = driver->get_zone()->get_system_key().key;
+  if (ticket_secret.empty() && !endpoints.empty()) {
+    WARN << "zone has no system key, so tickets issued by other RGWs "
+      "cannot be verified and only flights of this RGW are served" << dendl;
+  }
+}
 
 FlightServer::~FlightServer()
 { }
 
 
+std::string FlightServer::sign_ticket(const FlightTicket& ft) const {
+  if (ticket_secret.empty()) {
+    return {};
+  }
+  FlightTicket unsigned_ft = ft;
+  unsigned_ft.signature.clear();
+  return calc_hmac_sha256(ticket_secret,
+			  FlightTicketToTicket(unsigned_ft).ticket).to_str();
+}
+
+// one endpoint per configured RGW, each with a contiguous range of the
+// row groups, so a client can fetch them in parallel
+arw::Result<std::unique_ptr<flt::FlightInfo>>
+FlightServer::make_flight_info(const FlightData& fd) const {
+  auto descriptor =
+    flt::FlightDescriptor::Path(
+      { fd.tenant_name, fd.bucket_name, fd.object_key.name, fd.object_key.instance, fd.object_key.ns });
+
+  FlightTicket ft(fd.key);
+  ft.tenant_name = fd.tenant_name;
+  ft.bucket_name = fd.bucket_name;
+  ft.object_key = fd.object_key;
+
+  std::vector<flt::FlightEndpoint> flight_endpoints;
+  const int parts =
+    std::min<int>(endpoints.size(), fd.num_row_groups);
+  if (parts <= 1) {
+    ft.signature = sign_ticket(ft);
+    flt::FlightEndpoint endpoint;
+    endpoint.ticket = FlightTicketToTicket(ft);
+    if (!endpoints.empty()) {
+      endpoint.locations.push_back(endpoints.front());
+    }
+    flight_endpoints.push_back(std::move(endpoint));
+  } else {
+    int first = 0;
+    for (int i = 0; i < parts; ++i) {
+      ft.first_row_group = first;
+      ft.num_row_groups =
+	fd.num_row_groups / parts + (i < fd.num_row_groups % parts ? 1 : 0);
+      first += ft.num_row_groups;
+      ft.signature = sign_ticket(ft);
+
+      flt::FlightEndpoint endpoint;
+      endpoint.ticket = FlightTicketToTicket(ft);
+      endpoint.locations.push_back(endpoints[i]);
+      flight_endpoints.push_back(std::move(endpoint));
+    }
+  }
+
+  ARROW_ASSIGN_OR_RAISE(flt::FlightInfo info_obj,
+			flt::FlightInfo::Make(*fd.schema, descriptor, flight_endpoints, fd.num_records, fd.obj_size));
+  return std::make_unique<flt::FlightInfo>(std::move(info_obj));
+}
+
+
 arw::Status FlightServer::ListFlights(const flt::ServerCallContext& context,
 				      const flt::Criteria* criteria,
 				      std::unique_ptr<flt::FlightListing>* listings) {
@@ -164,12 +293,14 @@ arw::Status FlightServer::ListFlights(const flt::ServerCallContext& context,
   // function local class to implement FlightListing interface
   class RGWFlightListing : public flt::FlightListing {
 
+    const FlightServer* server;
     FlightStore* flight_store;
     FlightKey previous_key;
 
   public:
 
-    RGWFlightListing(FlightStore* flight_store) :
+    RGWFlightListing(const FlightServer* server, FlightStore* flight_store) :
+      server(server),
       flight_store(flight_store),
       previous_key(null_flight_key)
       { }
@@ -178,23 +309,14 @@ arw::Status FlightServer::ListFlights(const flt::ServerCallContext& context,
       std::optional<FlightData> fd = flight_store->after_key(previous_key);
       if (fd) {
 	previous_key = fd->key;
-	auto descriptor =
-	  flt::FlightDescriptor::Path(
-	    { fd->tenant_name, fd->bucket_name, fd->object_key.name, fd->object_key.instance, fd->object_key.ns });
-	flt::FlightEndpoint endpoint;
-	endpoint.ticket = FlightKeyToTicket(fd->key);
-	std::vector<flt::FlightEndpoint> endpoints { endpoint };
-
-	ARROW_ASSIGN_OR_RAISE(flt::FlightInfo info_obj,
-			      flt::FlightInfo::Make(*fd->schema, descriptor, endpoints, fd->num_records, fd->obj_size));
-	return std::make_unique<flt::FlightInfo>(std::move(info_obj));
+	return server->make_flight_info(*fd);
       } else {
 	return nullptr;
       }
     }
   }; // class RGWFlightListing
 
-  *listings = std::make_unique<RGWFlightListing>(flight_store);
+  *listings = std::make_unique<RGWFlightListing>(this, flight_store);
   return arw::Status::OK();
 } // FlightServer::ListFlights
 
@@ -202,7 +324,23 @@ arw::Status FlightServer::ListFlights(const flt::ServerCallContext& context,
 arw::Status FlightServer::GetFlightInfo(const flt::ServerCallContext &context,
 					const flt::FlightDescriptor &request,
 					std::unique_ptr<flt::FlightInfo> *info) {
-  return arw::Status::OK();
+  // path is { tenant, bucket, object name [, instance] } as in ListFlights
+  if (request.type != flt::FlightDescriptor::PATH || request.path.size() < 3) {
+    return arw::Status::Invalid("flight descriptor must be a path to an object");
+  }
+
+  FlightKey key = null_flight_key;
+  while (std::optional<FlightData> fd = flight_store->after_key(key)) {
+    key = fd->key;
+    if (fd->tenant_name == request.path[0] &&
+	fd->bucket_name == request.path[1] &&
+	fd->object_key.name == request.path[2] &&
+	(request.path.size() < 4 || fd->object_key.instance == request.path[3])) {
+      ARROW_ASSIGN_OR_RAISE(*info, make_flight_info(*fd));
+      return arw::Status::OK();
+    }
+  }
+  return arw::Status::KeyError("no flight for the requested object");
 } // FlightServer::GetFlightInfo
 
 
@@ -499,34 +637,132 @@ public:
 }; // class LocalRandomAccessFile
 #endif
 
+// A Buffer that holds on to the bufferlist it was read into, so data
+// read from RADOS reaches arrow without a copy; the bufferlist is only
+// made contiguous if it came back in more than one piece
+class BufferlistBuffer : public arw::Buffer {
+
+  bufferlist bl;
+
+  BufferlistBuffer(bufferlist&& _bl) :
+    Buffer(nullptr, 0),
+    bl(std::move(_bl))
+    {
+      data_ = reinterpret_cast<const uint8_t*>(bl.c_str());
+      size_ = bl.length();
+      capacity_ = size_;
+    }
+
+public:
+
+  static std::shared_ptr<arw::Buffer> make(bufferlist&& bl) {
+    return std::shared_ptr<arw::Buffer>(new BufferlistBuffer(std::move(bl)));
+  }
+}; // class BufferlistBuffer
+
 class RandomAccessObject : public arw::io::RandomAccessFile {
 
-  FlightData flight_data;
+  // a read op can't be shared by concurrent reads, so each read borrows
+  // one of its own; these are prepared on first use and then reused
+  struct ObjectReader {
+    std::unique_ptr<rgw::sal::Object> obj;
+    std::unique_ptr<rgw::sal::Object::ReadOp> op;
+  };
+
+  // owned here since pre-buffered reads may outlive the stream
+  std::unique_ptr<rgw::sal::Bucket> bucket;
+  const rgw_obj_key key;
+  std::shared_ptr<const arw::KeyValueMetadata> kv_metadata;
   const DoutPrefix dp;
 
   int64_t position;
-  bool is_closed;
-  std::unique_ptr<rgw::sal::Object::ReadOp> op;
+  int64_t obj_size;
+  std::atomic<bool> is_closed;
 
-public:
+  std::mutex readers_mtx; // for idle_readers
+  std::vector<std::unique_ptr<ObjectReader>> idle_readers;
 
-  RandomAccessObject(const FlightData& _flight_data,
-		     std::unique_ptr<rgw::sal::Object>& obj,
-		     const DoutPrefix _dp) :
-    flight_data(_flight_data),
-    dp(_dp),
-    position(-1),
-    is_closed(false)
+  arw::Result<std::unique_ptr<ObjectReader>> get_reader() {
     {
-      op = obj->get_read_op();
+      const std::lock_guard lock(readers_mtx);
+      if (!idle_readers.empty()) {
+	auto reader = std::move(idle_readers.back());
+	idle_readers.pop_back();
+	return reader;
+      }
     }
 
-  arw::Status Open() {
-    int ret = op->prepare(null_yield, &dp);
+    auto reader = std::make_unique<ObjectReader>();
+    reader->obj = bucket->get_object(key);
+    reader->op = reader->obj->get_read_op();
+    int ret = reader->op->prepare(null_yield, &dp);
     if (ret < 0) {
       return arw::Status::IOError(
 	"unable to prepare object with error %d", ret);
     }
+    if (obj_size >= 0 && int64_t(reader->obj->get_size()) != obj_size) {
+      return arw::Status::IOError("object changed while being read");
+    }
+    return reader;
+  }
+
+  void put_reader(std::unique_ptr<ObjectReader> reader) {
+    const std::lock_guard lock(readers_mtx);
+    idle_readers.push_back(std::move(reader));
+  }
+
+  // safe to call concurrently; does not use or move position
+  arw::Result<int64_t> read_range(int64_t offset, int64_t nbytes,
+				  bufferlist& bl) {
+    if (is_closed) {
+      return arw::Status::IOError("object is closed");
+    }
+    nbytes = std::min(nbytes, obj_size - offset);
+    if (nbytes <= 0) {
+      return 0;
+    }
+
+    ARROW_ASSIGN_OR_RAISE(auto reader, get_reader());
+
+    // note: read function reads through end_position inclusive
+    const int64_t bytes_read =
+      reader->op->read(offset, offset + nbytes - 1, bl, null_yield, &dp);
+    if (bytes_read < 0) {
+      ERROR << "read operation returned " << bytes_read << dendl;
+      return arw::Status::IOError(
+	"unable to read object at position %" PRId64 ", error code: %" PRId64,
+	offset,
+	bytes_read);
+    }
+    put_reader(std::move(reader));
+
+    if (nbytes != bytes_read) {
+      INFO << "partial read: nbytes=" << nbytes <<
+	", bytes_read=" << bytes_read << dendl;
+    }
+    INFO << bytes_read << " bytes read at " << offset << dendl;
+    return bytes_read;
+  }
+
+public:
+
+  RandomAccessObject(std::unique_ptr<rgw::sal::Bucket> _bucket,
+		     const rgw_obj_key& _key,
+		     std::shared_ptr<const arw::KeyValueMetadata> _kv_metadata,
+		     const DoutPrefix _dp) :
+    bucket(std::move(_bucket)),
+    key(_key),
+    kv_metadata(_kv_metadata),
+    dp(_dp),
+    position(-1),
+    obj_size(-1),
+    is_closed(false)
+    { }
+
+  arw::Status Open() {
+    ARROW_ASSIGN_OR_RAISE(auto reader, get_reader());
+    obj_size = reader->obj->get_size();
+    put_reader(std::move(reader));
     INFO << "file opened successfully" << dendl;
     position = 0;
     return arw::Status::OK();
@@ -537,7 +773,10 @@ public:
   arw::Status Close() override {
     position = -1;
     is_closed = true;
-    (void) op.reset();
+    {
+      const std::lock_guard lock(readers_mtx);
+      idle_readers.clear();
+    }
     INFO << "object closed" << dendl;
     return arw::Status::OK();
   }
@@ -562,59 +801,52 @@ public:
       return arw::Status::IOError("object read op is in bad state");
     }
 
-    // note: read function reads through end_position inclusive
-    int64_t end_position = position + nbytes - 1;
-
-    bufferlist bl;
-
-    const int64_t bytes_read =
-      op->read(position, end_position, bl, null_yield, &dp);
-    if (bytes_read < 0) {
-      const int64_t former_position = position;
-      position = -1;
-      ERROR << "read operation returned " << bytes_read << dendl;
-      return arw::Status::IOError(
-	"unable to read object at position %" PRId64 ", error code: %" PRId64,
-	former_position,
-	bytes_read);
-    }
-
-    // TODO: see if there's a way to get rid of this copy, perhaps
-    // updating rgw::sal::read_op
-    bl.cbegin().copy(bytes_read, reinterpret_cast<char*>(out));
-
+    ARROW_ASSIGN_OR_RAISE(const int64_t bytes_read, ReadAt(position, nbytes, out));
     position += bytes_read;
-
-    if (nbytes != bytes_read) {
-      INFO << "partial read: nbytes=" << nbytes <<
-	", bytes_read=" << bytes_read << dendl;
-    }
-    INFO << bytes_read << " bytes read" << dendl;
     return bytes_read;
   }
 
   arw::Result<std::shared_ptr<arw::Buffer>> Read(int64_t nbytes) override {
     INFO << "entered: asking for " << nbytes << " bytes" << dendl;
 
-    std::shared_ptr<OwnedBuffer> buffer;
-    ARROW_ASSIGN_OR_RAISE(buffer, OwnedBuffer::make(nbytes));
-
-    ARROW_ASSIGN_OR_RAISE(const int64_t bytes_read,
-			  Read(nbytes, buffer->writeable_data()));
-    buffer->set_size(bytes_read);
+    if (position < 0) {
+      ERROR << "error, position indicated error" << dendl;
+      return arw::Status::IOError("object read op is in bad state");
+    }
 
+    ARROW_ASSIGN_OR_RAISE(auto buffer, ReadAt(position, nbytes));
+    position += buffer->size();
     return buffer;
   }
 
+  // implement RandomAccessFile; these may be called concurrently, and
+  // are when parquet pre-buffers column chunks through ReadAsync
+
+  arw::Result<int64_t> ReadAt(int64_t offset, int64_t nbytes, void* out) override {
+    bufferlist bl;
+    ARROW_ASSIGN_OR_RAISE(const int64_t bytes_read, read_range(offset, nbytes, bl));
+    bl.cbegin().copy(bytes_read, reinterpret_cast<char*>(out));
+    return bytes_read;
+  }
+
+  arw::Result<std::shared_ptr<arw::Buffer>> ReadAt(int64_t offset, int64_t nbytes) override {
+    bufferlist bl;
+    ARROW_RETURN_NOT_OK(read_range(offset, nbytes, bl));
+    return BufferlistBuffer::make(std::move(bl));
+  }
+
   bool supports_zero_copy() const override {
-    return false;
+    return true;
   }
 
   // implement Seekable
 
   arw::Result<int64_t> GetSize() override {
-    INFO << "entered: " << flight_data.obj_size << " returned" << dendl;
-    return flight_data.obj_size;
+    INFO << "entered: " << obj_size << " returned" << dendl;
+    if (obj_size < 0) {
+      return arw::Status::IOError("object is not open");
+    }
+    return obj_size;
   }
 
   arw::Result<std::string_view> Peek(int64_t nbytes) override {
@@ -640,7 +872,7 @@ public:
   }
 
   arw::Result<std::shared_ptr<const arw::KeyValueMetadata>> ReadMetadata() {
-    return flight_data.kv_metadata;
+    return kv_metadata;
   }
 
   arw::Future<std::shared_ptr<const arw::KeyValueMetadata>> ReadMetadataAsync(
@@ -662,13 +894,78 @@ public:
   }
 }; // class RandomAccessObject
 
+// Streams the record batches of some row groups of a parquet object as
+// they are decoded, keeping the file reader they depend on
+class ParquetBatchReader : public arw::RecordBatchReader {
+
+  std::shared_ptr<RandomAccessObject> input;
+  std::unique_ptr<parquet::arrow::FileReader> file_reader;
+  std::unique_ptr<arw::RecordBatchReader> batch_reader;
+
+public:
+
+  ParquetBatchReader(std::shared_ptr<RandomAccessObject> _input,
+		     std::unique_ptr<parquet::arrow::FileReader> _file_reader,
+		     std::unique_ptr<arw::RecordBatchReader> _batch_reader) :
+    input(std::move(_input)),
+    file_reader(std::move(_file_reader)),
+    batch_reader(std::move(_batch_reader))
+    { }
+
+  ~ParquetBatchReader() override {
+    batch_reader.reset();
+    file_reader.reset();
+    (void) input->Close();
+  }
+
+  std::shared_ptr<arw::Schema> schema() const override {
+    return batch_reader->schema();
+  }
+
+  arw::Status ReadNext(std::shared_ptr<arw::RecordBatch>* batch) override {
+    return batch_reader->ReadNext(batch);
+  }
+}; // class ParquetBatchReader
+
 arw::Status FlightServer::DoGet(const flt::ServerCallContext &context,
 				const flt::Ticket &request,
 				std::unique_ptr<flt::FlightDataStream> *stream) {
   int ret;
 
-  ARROW_ASSIGN_OR_RAISE(FlightKey key, TicketToFlightKey(request));
-  ARROW_ASSIGN_OR_RAISE(FlightData fd, get_flight_store()->get_flight(key));
+  ARROW_ASSIGN_OR_RAISE(FlightTicket ticket, TicketToFlightTicket(request));
+
+  // flights recorded by this RGW carry the parquet key/value metadata;
+  // tickets issued by another RGW of the zone are served from the object
+  // alone, once their signature shows that an RGW issued them
+  std::shared_ptr<const arw::KeyValueMetadata> kv_metadata;
+  auto fd = get_flight_store()->get_flight(ticket.key);
+  if (fd.ok() &&
+      (ticket.bucket_name.empty() ||
+       (fd->bucket_name == ticket.bucket_name &&
+	fd->tenant_name == ticket.tenant_name &&
+	fd->object_key == ticket.object_key))) {
+    ticket.tenant_name = fd->tenant_name;
+    ticket.bucket_name = fd->bucket_name;
+    ticket.object_key = fd->object_key;
+    kv_metadata = fd->kv_metadata;
+  } else if (ticket.bucket_name.empty()) {
+    return fd.status();
+  } else {
+    const std::string expected = sign_ticket(ticket);
+    bool valid = !expected.empty() &&
+      expected.size() == ticket.signature.size();
+    unsigned char diff = 0;
+    for (size_t i = 0; valid && i < expected.size(); ++i) {
+      diff |= expected[i] ^ ticket.signature[i];
+    }
+    if (!valid || diff) {
+      WARN << "rejecting ticket for " << ticket.bucket_name << "/" <<
+	ticket.object_key << " that is neither a flight of this RGW nor "
+	"signed by the zone" << dendl;
+      return flt::MakeFlightError(flt::FlightStatusCode::Unauthorized,
+				  "invalid ticket");
+    }
+  }
 
 #if 0
   /* load_bucket no longer requires a user parameter. Keep this code
@@ -691,40 +988,48 @@ arw::Status FlightServer::DoGet(const flt::ServerCallContext &context,
 
   std::unique_ptr<rgw::sal::Bucket> bucket;
   ret = driver->load_bucket(&dp,
-			    rgw_bucket(fd.tenant_name, fd.bucket_name),
+			    rgw_bucket(ticket.tenant_name, ticket.bucket_name),
                             &bucket, null_yield);
   if (ret < 0) {
     ERROR << "get_bucket returned " << ret << dendl;
-    // TODO return something
+    return arw::Status::IOError(
+      "unable to load bucket with error %d", ret);
   }
 
-  std::unique_ptr<rgw::sal::Object> object = bucket->get_object(fd.object_key);
-
-  auto input = std::make_shared<RandomAccessObject>(fd, object, dp);
+  auto input = std::make_shared<RandomAccessObject>(std::move(bucket),
+						    ticket.object_key,
+						    kv_metadata, dp);
   ARROW_RETURN_NOT_OK(input->Open());
 
-  std::unique_ptr<parquet::arrow::FileReader> reader;
-  ARROW_RETURN_NOT_OK(parquet::arrow::OpenFile(input,
-					       arw::default_memory_pool(),
-					       &reader));
-
-  std::shared_ptr<arrow::Table> table;
-  ARROW_RETURN_NOT_OK(reader->ReadTable(&table));
+  // decode on arrow's CPU pool and pre-buffer the column chunks of each
+  // row group with concurrent reads rather than one read at a time
+  parquet::ArrowReaderProperties arrow_properties(true /* use_threads */);
+  arrow_properties.set_pre_buffer(true);
 
-  std::vector<std::shared_ptr<arw::RecordBatch>> batches;
-  arw::TableBatchReader batch_reader(*table);
-  while (true) {
-    std::shared_ptr<arw::RecordBatch> p;
-    auto s = batch_reader.ReadNext(&p);
-    if (!s.ok()) {
-      break;
-    }
-    batches.push_back(p);
+  parquet::arrow::FileReaderBuilder builder;
+  ARROW_RETURN_NOT_OK(builder.Open(input));
+  std::unique_ptr<parquet::arrow::FileReader> reader;
+  ARROW_RETURN_NOT_OK(builder.memory_pool(arw::default_memory_pool())
+		      ->properties(arrow_properties)
+		      ->Build(&reader));
+
+  const int num_row_groups = reader->num_row_groups();
+  const int first = std::clamp(ticket.first_row_group, 0, num_row_groups);
+  const int last = ticket.num_row_groups < 0 ? num_row_groups :
+    std::min(num_row_groups, first + ticket.num_row_groups);
+  std::vector<int> row_groups;
+  for (int rg = first; rg < last; ++rg) {
+    row_groups.push_back(rg);
   }
+  INFO << "streaming row groups [" << first << ", " << last << ") of " <<
+    ticket.object_key << dendl;
+
+  std::unique_ptr<arw::RecordBatchReader> batch_reader;
+  ARROW_RETURN_NOT_OK(reader->GetRecordBatchReader(row_groups, &batch_reader));
 
-  ARROW_ASSIGN_OR_RAISE(auto owning_reader,
-			arw::RecordBatchReader::Make(
-			  std::move(batches), table->schema()));
+  auto owning_reader =
+    std::make_shared<ParquetBatchReader>(std::move(input),
+					 std::move(reader), std::move(batch_reader));
   *stream = std::unique_ptr<flt::FlightDataStream>(
     new flt::RecordBatchStream(owning_reader));
 
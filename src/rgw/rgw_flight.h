@@ -56,6 +56,7 @@ struct FlightData {
   rgw_obj_key object_key;
   // NB: what about object's namespace and instance?
   uint64_t num_records;
+  int num_row_groups;
   uint64_t obj_size;
   std::shared_ptr<arw::Schema> schema;
   std::shared_ptr<const arw::KeyValueMetadata> kv_metadata;
@@ -68,12 +69,31 @@ struct FlightData {
 	     const std::string& _bucket_name,
 	     const rgw_obj_key& _object_key,
 	     uint64_t _num_records,
+	     int _num_row_groups,
 	     uint64_t _obj_size,
 	     std::shared_ptr<arw::Schema>& _schema,
 	     std::shared_ptr<const arw::KeyValueMetadata>& _kv_metadata,
 	     rgw_user _user_id);
 };
 
+// What a DoGet streams. The ticket names the object and not only the
+// flight key, so that any RGW of the zone can serve it and a flight can
+// be split by row groups into one endpoint per RGW.
+struct FlightTicket {
+  FlightKey key;
+  int first_row_group = 0;
+  int num_row_groups = -1; // through the last row group
+  std::string tenant_name;
+  std::string bucket_name;
+  rgw_obj_key object_key;
+  // HMAC of the other fields, see FlightServer::sign_ticket
+  std::string signature;
+
+  FlightTicket(FlightKey _key = null_flight_key) :
+    key(_key)
+    { }
+};
+
 // stores flights that have been created and helps expire them
 class FlightStore {
 
@@ -123,6 +143,18 @@ class FlightServer : public flt::FlightServerBase {
   std::map<std::string, Data1> data;
   arw::Status serve_return_value;
 
+  // from rgw_flight_endpoints; the row groups of a flight are spread
+  // over these, or served whole by this server if empty
+  std::vector<flt::Location> endpoints;
+
+  // the secret of the zone's system key. tickets naming an object are
+  // signed with it, so that the RGWs of a zone serve each other's tickets
+  // while clients cannot make up tickets for objects of their choosing
+  std::string ticket_secret;
+
+  arw::Result<std::unique_ptr<flt::FlightInfo>> make_flight_info(const FlightData& fd) const;
+  std::string sign_ticket(const FlightTicket& ft) const;
+
 public:
 
   static constexpr int default_port = 8077;
@@ -223,5 +255,7 @@ public:
 
 flt::Ticket FlightKeyToTicket(const FlightKey& key);
 arw::Status TicketToFlightKey(const flt::Ticket& t, FlightKey& key);
+flt::Ticket FlightTicketToTicket(const FlightTicket& ft);
+arw::Result<FlightTicket> TicketToFlightTicket(const flt::Ticket& t);
 
 } // namespace rgw::flight
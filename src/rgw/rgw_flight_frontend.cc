@@ -16,6 +16,7 @@
 #include "arrow/type.h"
 #include "arrow/flight/server.h"
 #include "arrow/io/file.h"
+#include "arrow/io/interfaces.h"
 
 #include "parquet/arrow/reader.h"
 #include "parquet/arrow/schema.h"
@@ -72,6 +73,17 @@ int FlightFrontend::init() {
 
   flt::FlightServerOptions options(location);
   options.verify_client = false;
+
+  // pre-buffered parquet reads are issued on arrow's IO thread pool, so
+  // this is how many RADOS reads a DoGet can have outstanding
+  const int io_threads =
+    env.driver->ctx()->_conf.get_val<uint64_t>("rgw_flight_io_threads");
+  auto s0 = arw::io::SetIOThreadPoolCapacity(io_threads);
+  if (!s0.ok()) {
+    WARN << "could not set arrow IO thread pool capacity to " <<
+      io_threads << "; status=" << s0 << dendl;
+  }
+
   auto s = env.flight_server->Init(options);
   if (!s.ok()) {
     ERROR << "couldn't init flight server; status=" << s << dendl;
@@ -191,8 +203,9 @@ int FlightGetObj_Filter::handle_data(bufferlist& bl,
       std::shared_ptr<const arw::KeyValueMetadata> kv_metadata;
       std::shared_ptr<arw::Schema> aw_schema;
       int64_t num_rows = 0;
+      int num_row_groups = 0;
 
-      auto process_metadata = [&aw_schema, &num_rows, &kv_metadata, this]() -> arrow::Status {
+      auto process_metadata = [&aw_schema, &num_rows, &num_row_groups, &kv_metadata, this]() -> arrow::Status {
 	ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::io::ReadableFile> file,
 			      arrow::io::ReadableFile::Open(temp_file_name));
 	const std::shared_ptr<parquet::FileMetaData> metadata = parquet::ReadMetaData(file);
@@ -200,6 +213,7 @@ int FlightGetObj_Filter::handle_data(bufferlist& bl,
 	ARROW_RETURN_NOT_OK(file->Close());
 
 	num_rows = metadata->num_rows();
+	num_row_groups = metadata->num_row_groups();
 	kv_metadata = metadata->key_value_metadata();
 	const parquet::SchemaDescriptor* pq_schema = metadata->schema();
 	ARROW_RETURN_NOT_OK(parquet::arrow::FromParquetSchema(pq_schema, &aw_schema));
@@ -216,7 +230,7 @@ int FlightGetObj_Filter::handle_data(bufferlist& bl,
 	auto key =
 	  store->add_flight(FlightData(uri, tenant_name, bucket_name,
 				       object_key, num_rows,
-				       expected_size, aw_schema,
+				       num_row_groups, expected_size, aw_schema,
 				       kv_metadata, user_id));
 	(void) key; // suppress unused variable warning
       }
@@ -8,6 +8,7 @@
 #include <sstream>
 #include <cstring>
 #include <unordered_map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <shared_mutex> // for std::shared_lock
@@ -412,15 +413,24 @@ private:
   mutable std::mutex connections_lock;
   std::thread runner;
 
-  // TODO use rd_kafka_produce_batch for better performance
-  void publish_internal(message_wrapper_t* message) {
-    const std::unique_ptr<message_wrapper_t> msg_deleter(message);
-    const auto conn_it = connections.find(message->conn_id);
-    if (conn_it == connections.end()) {
-      ldout(cct, 1) << "Kafka publish: connection was deleted while message was in the queue" << dendl;
+  // complete the messages of a batch that could not be produced with a
+  // negative errno
+  static void fail_batch(std::vector<std::unique_ptr<message_wrapper_t>>& batch, int error) {
+    for (const auto& message : batch) {
       if (message->cb) {
-        message->cb(status_to_errno(STATUS_CONNECTION_CLOSED));
+        message->cb(error);
       }
+    }
+  }
+
+  // produce a batch of messages, all to the same connection and topic, with a single call
+  void publish_internal(std::vector<std::unique_ptr<message_wrapper_t>>& batch) {
+    const auto& first = batch.front();
+    const auto conn_it = connections.find(first->conn_id);
+    if (conn_it == connections.end()) {
+      ldout(cct, 1) << "Kafka publish: connection was deleted while " << batch.size() <<
+        " messages were in the queue" << dendl;
+      fail_batch(batch, status_to_errno(STATUS_CONNECTION_CLOSED));
       return;
     }
     auto& conn = conn_it->second;
@@ -432,87 +442,112 @@ private:
       // connection had an issue while message was in the queue
       // TODO add error stats
       ldout(conn->cct, 1) << "Kafka publish: producer was closed while message was in the queue. with status: " << status_to_string(conn->status) << dendl;
-      if (message->cb) {
-        message->cb(status_to_errno(conn->status));
-      }
+      fail_batch(batch, status_to_errno(conn->status));
       return;
     }
 
     // create a new topic unless it was already created
-    auto topic_it = conn->topics.find(message->topic);
+    auto topic_it = conn->topics.find(first->topic);
     if (topic_it == conn->topics.end()) {
-      connection_t::topic_ptr topic(rd_kafka_topic_new(conn->producer, message->topic.c_str(), nullptr));
+      connection_t::topic_ptr topic(rd_kafka_topic_new(conn->producer, first->topic.c_str(), nullptr));
       if (!topic) {
         const auto err = rd_kafka_last_error();
-        ldout(conn->cct, 1) << "Kafka publish: failed to create topic: " << message->topic << " error: " 
+        ldout(conn->cct, 1) << "Kafka publish: failed to create topic: " << first->topic << " error: " 
           << rd_kafka_err2str(err) << "(" << err << ")" << dendl;
-        if (message->cb) {
-          message->cb(-rd_kafka_err2errno(err));
-        }
+        fail_batch(batch, -rd_kafka_err2errno(err));
         return;
       }
-      topic_it = conn->topics.emplace(message->topic, std::move(topic)).first;
-      ldout(conn->cct, 20) << "Kafka publish: successfully created topic: " << message->topic << dendl;
+      topic_it = conn->topics.emplace(first->topic, std::move(topic)).first;
+      ldout(conn->cct, 20) << "Kafka publish: successfully created topic: " << first->topic << dendl;
     } else {
-        ldout(conn->cct, 20) << "Kafka publish: reused existing topic: " << message->topic << dendl;
+        ldout(conn->cct, 20) << "Kafka publish: reused existing topic: " << first->topic << dendl;
     }
 
-    const auto tag = (message->cb == nullptr ? nullptr : new uint64_t(conn->delivery_tag++));
-    const auto rc = rd_kafka_produce(
+    std::vector<rd_kafka_message_t> rkmessages(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+      auto& rkmessage = rkmessages[i];
+      rkmessage = {};
+      rkmessage.payload = batch[i]->message.data();
+      rkmessage.len = batch[i]->message.length();
+      // opaque data: tag, used in the global callback
+      // in order to invoke the real callback
+      // null if no callback exists
+      rkmessage._private = (batch[i]->cb == nullptr ? nullptr : new uint64_t(conn->delivery_tag++));
+    }
+    const auto produced = rd_kafka_produce_batch(
             topic_it->second.get(),
             // TODO: non builtin partitioning
             RD_KAFKA_PARTITION_UA,
-            // make a copy of the payload
-            // so it is safe to pass the pointer from the string
+            // make a copy of the payloads
+            // so it is safe to pass the pointers from the strings
             RD_KAFKA_MSG_F_COPY,
-            message->message.data(),
-            message->message.length(),
-            // optional key and its length
-            nullptr, 
-            0,
-            // opaque data: tag, used in the global callback
-            // in order to invoke the real callback
-            // null if no callback exists
-            tag);
-    if (rc == -1) {
-      const auto err = rd_kafka_last_error();
-      ldout(conn->cct, 1) << "Kafka publish: failed to produce for topic: "
-                          << message->topic
-                          << ". with error: " << rd_kafka_err2str(err) << dendl;
-      // immediatly invoke callback on error if needed
-      if (message->cb) {
-        message->cb(-rd_kafka_err2errno(err));
+            rkmessages.data(),
+            rkmessages.size());
+    ldout(conn->cct, 20) << "Kafka publish: produced " << produced << "/" << batch.size() <<
+      " messages for topic: " << first->topic << dendl;
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+      const auto& message = batch[i];
+      const auto tag = reinterpret_cast<uint64_t*>(rkmessages[i]._private);
+      if (const auto err = rkmessages[i].err; err != RD_KAFKA_RESP_ERR_NO_ERROR) {
+        ldout(conn->cct, 1) << "Kafka publish: failed to produce for topic: "
+                            << message->topic
+                            << ". with error: " << rd_kafka_err2str(err) << dendl;
+        // immediatly invoke callback on error if needed
+        if (message->cb) {
+          message->cb(-rd_kafka_err2errno(err));
+        }
+        delete tag;
+        continue;
       }
-      delete tag;
-      return;
-    }
-   
-    if (tag) {
-      auto const q_len = conn->callbacks.size();
-      if (q_len < max_inflight) {
-        ldout(conn->cct, 20)
-            << "Kafka publish (with callback, tag=" << *tag
-            << "): OK. Queue has: " << q_len + 1 << " callbacks" << dendl;
-        conn->callbacks.emplace_back(*tag, message->cb);
+
+      if (tag) {
+        auto const q_len = conn->callbacks.size();
+        if (q_len < max_inflight) {
+          ldout(conn->cct, 20)
+              << "Kafka publish (with callback, tag=" << *tag
+              << "): OK. Queue has: " << q_len + 1 << " callbacks" << dendl;
+          conn->callbacks.emplace_back(*tag, message->cb);
+        } else {
+          // immediately invoke callback with error - this is not a connection error
+          ldout(conn->cct, 1) << "Kafka publish (with callback): failed with error: callback queue full" << dendl;
+          message->cb(-EBUSY);
+          // tag will be deleted when the global callback is invoked
+        }
       } else {
-        // immediately invoke callback with error - this is not a connection error
-        ldout(conn->cct, 1) << "Kafka publish (with callback): failed with error: callback queue full" << dendl;
-        message->cb(-EBUSY);
-        // tag will be deleted when the global callback is invoked
+          ldout(conn->cct, 20) << "Kafka publish (no callback): OK" << dendl;
       }
-    } else {
-        ldout(conn->cct, 20) << "Kafka publish (no callback): OK" << dendl;
     }
     // coverity[leaked_storage:SUPPRESS]
   }
 
+  // publish the messages taken from the queue, batching the consecutive
+  // messages to the same connection and topic
+  void publish_all(std::vector<message_wrapper_t*>& messages) {
+    std::vector<std::unique_ptr<message_wrapper_t>> batch;
+    for (auto message : messages) {
+      if (!batch.empty() && !(batch.front()->conn_id == message->conn_id &&
+                              batch.front()->topic == message->topic)) {
+        publish_internal(batch);
+        batch.clear();
+      }
+      batch.emplace_back(message);
+    }
+    if (!batch.empty()) {
+      publish_internal(batch);
+    }
+    messages.clear();
+  }
+
   void run() noexcept {
     ceph_pthread_setname("kafka_manager");
+    std::vector<message_wrapper_t*> pending;
     while (!stopped) {
 
       // publish all messages in the queue
       auto reply_count = 0U;
-      const auto send_count = messages.consume_all([this](auto message){this->publish_internal(message);});
+      const auto send_count = messages.consume_all([&pending](auto message){pending.push_back(message);});
+      publish_all(pending);
       dequeued += send_count;
       ConnectionList::iterator conn_it;
       ConnectionList::const_iterator end_it;
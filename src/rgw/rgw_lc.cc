@@ -8,6 +8,9 @@
 #include <algorithm>
 #include <tuple>
 #include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string.hpp>
@@ -393,6 +396,16 @@ public:
     list_params.prefix = prefix;
   }
 
+  /* list a single index shard only */
+  void set_shard(int shard_id) {
+    list_params.shard_id = shard_id;
+  }
+
+  /* resume listing after a saved position */
+  void set_marker(const rgw_obj_key& marker) {
+    list_params.marker = marker;
+  }
+
   int init(const DoutPrefixProvider *dpp) {
     return fetch(dpp);
   }
@@ -869,7 +882,7 @@ class RGWLC::WorkPool
 {
   using TVector = ceph::containers::tiny_vector<WorkQ, 3>;
   TVector wqs;
-  uint64_t ix;
+  std::atomic<uint64_t> ix;
 
 public:
   WorkPool(RGWLC::LCWorker* wk, uint16_t n_threads, uint32_t qmax)
@@ -894,8 +907,8 @@ public:
   }
 
   void enqueue(WorkItem item) {
-    const auto tix = ix;
-    ix = (ix+1) % wqs.size();
+    /* bucket index shards may be listed concurrently */
+    const auto tix = ix++ % wqs.size();
     (wqs[tix]).enqueue(std::move(item));
   }
 
@@ -1838,6 +1851,51 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
 		      << prefix_map.size()
 		      << dendl;
 
+  /* list index shards concurrently, each with its own lister and rule
+   * state; versions of an object always share a shard, so the per-shard
+   * order is all the noncurrent logic needs */
+  const auto& current_index = bucket->get_info().layout.current_index;
+  uint32_t num_shards = 1;
+  if (current_index.layout.type == rgw::BucketIndexType::Normal) {
+    num_shards = rgw::num_shards(current_index.layout.normal);
+  }
+  const uint32_t listers = std::min<uint32_t>(
+    num_shards,
+    cct->_conf.get_val<uint64_t>("rgw_lc_bucket_shard_concurrency"));
+  const uint64_t progress_interval =
+    cct->_conf.get_val<uint64_t>("rgw_lc_progress_interval");
+
+  /* listing positions saved by an earlier, interrupted run */
+  std::mutex progress_lock;
+  std::map<std::string, rgw_obj_key> progress;
+  if (progress_interval > 0) {
+    ret = sal_lc->get_bucket_progress(this, null_yield, shard_id, progress);
+    if (ret < 0 && ret != -ENOENT && ret != -EOPNOTSUPP) {
+      ldpp_dout(this, 5) << __func__ << "() failed to read progress of bucket="
+			 << bucket_name << " ret=" << ret << dendl;
+    }
+    if (!progress.empty()) {
+      ldpp_dout(this, 5) << __func__ << "() resuming bucket=" << bucket_name
+			 << " from " << progress.size() << " saved positions"
+			 << dendl;
+    }
+  }
+
+  auto save_progress = [&](const std::string& key, const rgw_obj_key& marker) {
+    std::map<std::string, rgw_obj_key> update{{key, marker}};
+    {
+      std::lock_guard l{progress_lock};
+      progress[key] = marker;
+    }
+    int r = sal_lc->set_bucket_progress(this, null_yield, shard_id, update);
+    if (r < 0 && r != -EOPNOTSUPP) {
+      ldpp_dout(this, 5) << __func__ << "() failed to save progress of bucket="
+			 << bucket_name << " ret=" << r << dendl;
+    }
+  };
+
+  std::atomic<bool> stopped{false};
+
   rgw_obj_key pre_marker;
   rgw_obj_key next_marker;
   for(auto prefix_iter = prefix_map.begin(); prefix_iter != prefix_map.end();
@@ -1864,44 +1922,112 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
       pre_marker = next_marker;
     }
 
-    LCObjsLister ol(driver, bucket.get());
-    ol.set_prefix(prefix_iter->first);
-
     if (! zone_check(op, zone)) {
       ldpp_dout(this, 7) << "LC rule not executable in " << zone->get_tier_type()
 			 << " zone, skipping" << dendl;
       continue;
     }
 
-    ret = ol.init(this);
+    auto process_shard = [&](int index_shard) -> int {
+      const std::string progress_key =
+	op.id + "/" + std::to_string(index_shard);
+
+      LCObjsLister ol(driver, bucket.get());
+      ol.set_prefix(prefix_iter->first);
+      ol.set_shard(index_shard);
+      {
+	std::lock_guard l{progress_lock};
+	auto saved = progress.find(progress_key);
+	if (saved != progress.end()) {
+	  ol.set_marker(saved->second);
+	}
+      }
+
+      int r = ol.init(this);
+      if (r < 0) {
+	if (r != -ENOENT) {
+	  ldpp_dout(this, 0) << "ERROR: driver->list_objects():" << dendl;
+	}
+	return r;
+      }
+
+      op_env oenv(op, driver, worker, bucket.get(), ol);
+      LCOpRule orule(oenv);
+      orule.build(); // why can't ctor do it?
+      rgw_bucket_dir_entry* o{nullptr};
+      uint64_t unsaved = 0;
+      for (auto offset = 0; ol.get_obj(this, &o /* , fetch_barrier */); ++offset, ol.next()) {
+	orule.update();
+	std::tuple<LCOpRule, rgw_bucket_dir_entry> t1 = {orule, *o};
+	worker->workpool->enqueue(WorkItem{t1});
+	if (progress_interval > 0 && ++unsaved >= progress_interval) {
+	  /* only checkpoint between object names, so that a resumed
+	   * listing starts with the current version of the next one */
+	  auto next_name = ol.next_key_name();
+	  if (next_name && *next_name != o->key.name) {
+	    worker->workpool->drain();
+	    save_progress(progress_key, o->key);
+	    unsaved = 0;
+	  }
+	}
+	if ((offset % 100) == 0) {
+	  if (stopped || worker_should_stop(stop_at, once)) {
+	    stopped = true;
+	    return 0;
+	  }
+	}
+      }
+      return 0;
+    };
+
+    if (listers <= 1) {
+      ret = process_shard(RGW_NO_SHARD);
+    } else {
+      std::atomic<int> shard_ret{0};
+      std::vector<std::thread> threads;
+      threads.reserve(listers);
+      for (uint32_t t = 0; t < listers; ++t) {
+	threads.emplace_back([&, t] {
+	  for (uint32_t s = t; s < num_shards && !stopped; s += listers) {
+	    int r = process_shard(s);
+	    if (r < 0) {
+	      int expected = 0;
+	      shard_ret.compare_exchange_strong(expected, r);
+	      stopped = true;
+	      return;
+	    }
+	  }
+	});
+      }
+      for (auto& t : threads) {
+	t.join();
+      }
+      ret = shard_ret;
+    }
     if (ret < 0) {
       if (ret == (-ENOENT))
         return 0;
-      ldpp_dout(this, 0) << "ERROR: driver->list_objects():" << dendl;
       return ret;
     }
-
-    op_env oenv(op, driver, worker, bucket.get(), ol);
-    LCOpRule orule(oenv);
-    orule.build(); // why can't ctor do it?
-    rgw_bucket_dir_entry* o{nullptr};
-    for (auto offset = 0; ol.get_obj(this, &o /* , fetch_barrier */); ++offset, ol.next()) {
-      orule.update();
-      std::tuple<LCOpRule, rgw_bucket_dir_entry> t1 = {orule, *o};
-      worker->workpool->enqueue(WorkItem{t1});
-      if ((offset % 100) == 0) {
-	if (worker_should_stop(stop_at, once)) {
-	  ldpp_dout(this, 5) << __func__ << " interval budget EXPIRED worker="
-			     << worker->ix << " bucket=" << bucket_name
-			     << dendl;
-	  return 0;
-	}
-      }
+    if (stopped) {
+      ldpp_dout(this, 5) << __func__ << " interval budget EXPIRED worker="
+			 << worker->ix << " bucket=" << bucket_name
+			 << dendl;
+      return 0;
     }
     worker->workpool->drain();
   }
 
   ret = handle_multipart_expiration(bucket.get(), prefix_map, worker, stop_at, once);
+
+  if (progress_interval > 0 && !progress.empty()) {
+    /* the whole bucket was processed, start over next time */
+    int r = sal_lc->rm_bucket_progress(this, null_yield, shard_id);
+    if (r < 0 && r != -EOPNOTSUPP) {
+      ldpp_dout(this, 5) << __func__ << "() failed to remove progress of bucket="
+			 << bucket_name << " ret=" << r << dendl;
+    }
+  }
   return ret;
 }
 
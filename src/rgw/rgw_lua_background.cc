@@ -188,7 +188,7 @@ void Background::run() {
       auto L = lguard->get();
       try {
         //execute the background lua script
-        if (luaL_dostring(L, rgw_script.c_str()) != LUA_OK) {
+        if (dostring_cached(L, rgw_script) != LUA_OK) {
           const std::string err(lua_tostring(L, -1));
           ldpp_dout(dpp, 1) << "Lua ERROR: " << err << dendl;
           failed = true;
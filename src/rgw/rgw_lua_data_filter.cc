@@ -3,6 +3,7 @@
 #include "rgw_lua_request.h"
 #include "rgw_lua_background.h"
 #include "rgw_process_env.h"
+#include "rgw_perf_counters.h"
 #include <lua.hpp>
 
 namespace rgw::lua {
@@ -105,7 +106,12 @@ int RGWObjFilter::execute(bufferlist& bl, off_t offset, const char* op_name) con
     }
 
     // execute the lua script
-    if (luaL_dostring(L, script.c_str()) != LUA_OK) {
+    const auto start = ceph::mono_clock::now();
+    const auto rc = dostring_cached(L, script);
+    if (perfcounter) {
+      perfcounter->tinc(l_rgw_lua_script_lat, ceph::mono_clock::now() - start);
+    }
+    if (rc != LUA_OK) {
       const std::string err(lua_tostring(L, -1));
       ldpp_dout(s, 1) << "Lua ERROR: " << err << dendl;
       return -EINVAL;
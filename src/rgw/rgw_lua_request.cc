@@ -797,6 +797,7 @@ int execute(
   }
   const char* op_name = op ? op->name() : "Unknown";
 
+  const auto start = ceph::mono_clock::now();
   int rc = 0;
   try {
     open_standard_libs(L);
@@ -820,7 +821,7 @@ int execute(
     }
 
     // execute the lua script
-    if (luaL_dostring(L, script.c_str()) != LUA_OK) {
+    if (dostring_cached(L, script) != LUA_OK) {
       const std::string err(lua_tostring(L, -1));
       ldpp_dout(s, 1) << "Lua ERROR: " << err << dendl;
       rc = -1;
@@ -831,6 +832,7 @@ int execute(
   }
   if (perfcounter) {
     perfcounter->inc((rc == -1 ? l_rgw_lua_script_fail : l_rgw_lua_script_ok), 1);
+    perfcounter->tinc(l_rgw_lua_script_lat, ceph::mono_clock::now() - start);
   }
 
   return rc;
@@ -1,5 +1,6 @@
 #include <charconv> // for std::to_chars()
 #include <string>
+#include <unordered_map>
 #include <lua.hpp>
 #include "common/ceph_context.h"
 #include "common/debug.h"
@@ -33,6 +34,46 @@ void create_debug_action(lua_State* L, CephContext* cct) {
 }
 
 
+namespace {
+
+// compiled chunks by script text. a changed script has a different text, so
+// its stale chunk is never loaded again, and goes away with the next clear
+struct chunk_cache {
+  static constexpr std::size_t max_chunks = 32;
+  std::unordered_map<std::string, std::string> chunks;
+};
+thread_local chunk_cache chunks;
+
+int chunk_writer(lua_State*, const void* p, std::size_t sz, void* ud) {
+  static_cast<std::string*>(ud)->append(static_cast<const char*>(p), sz);
+  return 0;
+}
+
+} // anonymous namespace
+
+int dostring_cached(lua_State* L, const std::string& script) {
+  if (auto i = chunks.chunks.find(script); i != chunks.chunks.end()) {
+    const auto& chunk = i->second;
+    if (luaL_loadbufferx(L, chunk.data(), chunk.size(), script.c_str(), "b") == LUA_OK) {
+      return lua_pcall(L, 0, LUA_MULTRET, 0);
+    }
+    lua_pop(L, 1);
+    chunks.chunks.erase(i);
+  }
+  if (const auto rc = luaL_loadstring(L, script.c_str()); rc != LUA_OK) {
+    return rc;
+  }
+  std::string chunk;
+  // keep the debug information, so that errors have the same line numbers
+  if (lua_dump(L, chunk_writer, &chunk, 0) == 0) {
+    if (chunks.chunks.size() >= chunk_cache::max_chunks) {
+      chunks.chunks.clear();
+    }
+    chunks.chunks.emplace(script, std::move(chunk));
+  }
+  return lua_pcall(L, 0, LUA_MULTRET, 0);
+}
+
 void stack_dump(lua_State* L) {
   const auto top = lua_gettop(L);
   std::cout << std::endl << " ----------------  Stack Dump ----------------" << std::endl;
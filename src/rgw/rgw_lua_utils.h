@@ -95,6 +95,11 @@ class lua_state_guard {
 
 int dostring(lua_State* L, const char* str);
 
+// run a script like luaL_dostring(). the script is compiled the first time a
+// thread runs it, and later runs of the same script text on that thread load
+// the compiled chunk instead of parsing the script again
+int dostring_cached(lua_State* L, const std::string& script);
+
 // keys for the lua registry
 static constexpr const char* max_runtime_key = "runtimeguard_max_runtime";
 static constexpr const char* start_time_key = "runtimeguard_start_time";
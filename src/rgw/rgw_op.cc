@@ -4647,7 +4647,7 @@ void RGWPutObj::execute(optional_yield y)
         ldpp_dout(this, 1) << "Cannot load plugin for compression type "
             << compression_type << dendl;
       } else {
-        compressor.emplace(s->cct, plugin, filter);
+        compressor.emplace(s->cct, plugin, filter, y);
         filter = &*compressor;
         // always send incompressible hint when rgw is itself doing compression
         s->object->set_compressed();
@@ -4679,6 +4679,9 @@ void RGWPutObj::execute(optional_yield y)
 
     if (cksum_filter) {
       filter = &*cksum_filter;
+      if (need_calc_md5) {
+        cksum_filter->set_etag_hash(&hash);
+      }
     }
   } /* !append */
   tracepoint(rgw_op, before_data_transfer, s->req_id.c_str());
@@ -4705,8 +4708,11 @@ void RGWPutObj::execute(optional_yield y)
       break;
     }
 
-    if (need_calc_md5) {
-      hash.Update((const unsigned char *)data.c_str(), data.length());
+    if (need_calc_md5 && !cksum_filter) { // else hashed by cksum_filter
+      for (const auto& ptr : data.buffers()) {
+        hash.Update(reinterpret_cast<const unsigned char*>(ptr.c_str()),
+                    ptr.length());
+      }
     }
 
     op_ret = filter->process(std::move(data), ofs);
@@ -5050,7 +5056,7 @@ void RGWPostObj::execute(optional_yield y)
           ldpp_dout(this, 1) << "Cannot load plugin for compression type "
                            << compression_type << dendl;
         } else {
-          compressor.emplace(s->cct, plugin, filter);
+          compressor.emplace(s->cct, plugin, filter, y);
           filter = &*compressor;
         }
       }
@@ -5070,6 +5076,7 @@ void RGWPostObj::execute(optional_yield y)
     }
     if (cksum_filter) {
       filter = &*cksum_filter;
+      cksum_filter->set_etag_hash(&hash);
     }
 
     bool again;
@@ -5086,8 +5093,12 @@ void RGWPostObj::execute(optional_yield y)
         break;
       }
 
-      /* XXXX we should modernize to use component buffers? */
-      hash.Update((const unsigned char *)data.c_str(), data.length());
+      if (!cksum_filter) { // else hashed by cksum_filter
+        for (const auto& ptr : data.buffers()) {
+          hash.Update(reinterpret_cast<const unsigned char*>(ptr.c_str()),
+                      ptr.length());
+        }
+      }
       op_ret = filter->process(std::move(data), ofs);
       if (op_ret < 0) {
         return;
@@ -7224,6 +7235,7 @@ void RGWCompleteMultipart::execute(optional_yield y)
     return;
   }
 
+  const auto complete_start = ceph::mono_clock::now();
   op_ret =
     upload->complete(this, y, s->cct, parts->parts, remove_objs, accounted_size,
                      compressed, cs_info, ofs, s->req_id, s->owner, olh_epoch,
@@ -7232,6 +7244,12 @@ void RGWCompleteMultipart::execute(optional_yield y)
     ldpp_dout(this, 0) << "ERROR: upload complete failed ret=" << op_ret << dendl;
     return;
   }
+  if (perfcounter) {
+    const auto lat = ceph::mono_clock::now() - complete_start;
+    perfcounter->tinc(l_rgw_mpu_complete_lat, lat);
+    perfcounter->hinc(l_rgw_mpu_complete_lat_parts_hist,
+                      std::chrono::nanoseconds(lat).count(), parts->parts.size());
+  }
 
   // size is logged in stadared mode
   int ret = rgw::bucketlogging::log_record(driver, rgw::bucketlogging::LoggingType::Standard, s->object.get(), s, canonical_name(), "", ofs, this, y, true, false);
@@ -7661,8 +7679,10 @@ void RGWDeleteMultiObj::handle_individual_object(const RGWMultiDelObject& object
   del_op->params.if_match = object.get_if_match();
   del_op->params.size_match = object.get_size_match();
 
+  // the index removals of all keys are batched per bucket index shard
   op_ret = del_op->delete_obj(dpp, y,
-                              rgw::sal::FLAG_LOG_OP | (skip_olh_obj_update ? rgw::sal::FLAG_SKIP_UPDATE_OLH : 0));
+                              rgw::sal::FLAG_LOG_OP | rgw::sal::FLAG_BATCH_INDEX |
+                              (skip_olh_obj_update ? rgw::sal::FLAG_SKIP_UPDATE_OLH : 0));
   if (op_ret == -ENOENT) {
     op_ret = 0;
   }
@@ -8281,7 +8301,7 @@ int RGWBulkUploadOp::handle_file(const std::string_view path,
       ldpp_dout(this, 1) << "Cannot load plugin for rgw_compression_type "
           << compression_type << dendl;
     } else {
-      compressor.emplace(s->cct, plugin, filter);
+      compressor.emplace(s->cct, plugin, filter, y);
       filter = &*compressor;
     }
   }
@@ -8301,7 +8321,10 @@ int RGWBulkUploadOp::handle_file(const std::string_view path,
       op_ret = len;
       return op_ret;
     } else if (len > 0) {
-      hash.Update((const unsigned char *)data.c_str(), data.length());
+      for (const auto& ptr : data.buffers()) {
+        hash.Update(reinterpret_cast<const unsigned char*>(ptr.c_str()),
+                    ptr.length());
+      }
       op_ret = filter->process(std::move(data), ofs);
       if (op_ret < 0) {
         ldpp_dout(this, 20) << "filter->process() returned ret=" << op_ret << dendl;
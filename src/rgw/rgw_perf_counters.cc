@@ -31,6 +31,10 @@ void add_rgw_frontend_counters(PerfCountersBuilder *pcb) {
   pcb->add_u64_counter(l_rgw_keystone_token_cache_miss, "keystone_token_cache_miss", "Keystone token cache miss");
 
   pcb->add_u64_counter(l_rgw_gc_retire, "gc_retire_object", "GC object retires");
+  pcb->add_u64_counter(l_rgw_gc_tail_delete, "gc_tail_delete", "GC tail object deletions");
+  pcb->add_time_avg(l_rgw_gc_tail_delete_lat, "gc_tail_delete_lat", "GC tail object deletion latency");
+  pcb->add_u64(l_rgw_gc_io_window, "gc_io_window", "GC concurrent tail deletions allowed");
+  pcb->add_u64(l_rgw_gc_oldest_entry_age, "gc_oldest_entry_age", "Seconds the oldest expired GC entry has been waiting");
 
   pcb->add_u64_counter(l_rgw_lc_expire_current, "lc_expire_current",
 		      "Lifecycle current expiration");
@@ -58,11 +62,47 @@ void add_rgw_frontend_counters(PerfCountersBuilder *pcb) {
   
   pcb->add_u64_counter(l_rgw_lua_script_ok, "lua_script_ok", "Successful executions of Lua scripts");
   pcb->add_u64_counter(l_rgw_lua_script_fail, "lua_script_fail", "Failed executions of Lua scripts");
+  pcb->add_time_avg(l_rgw_lua_script_lat, "lua_script_lat", "Execution time of Lua request and data scripts");
   pcb->add_u64(l_rgw_lua_current_vms, "lua_current_vms", "Number of Lua VMs currently being executed");
 
   pcb->add_u64_counter(l_rgw_d4n_cache_hits, "d4n_cache_hits", "D4N cache hits");
   pcb->add_u64_counter(l_rgw_d4n_cache_misses, "d4n_cache_misses", "D4N cache misses");
   pcb->add_u64_counter(l_rgw_d4n_cache_evictions, "d4n_cache_evictions", "D4N cache evictions");
+  pcb->add_u64_counter(l_rgw_d4n_peer_hits, "d4n_peer_hits", "D4N cache blocks read through the cache of a peer");
+
+  pcb->add_u64_counter(l_rgw_reshard_blocked_writes, "reshard_blocked_writes",
+		      "Bucket index writes blocked by a reshard");
+  pcb->add_time_avg(l_rgw_reshard_block_lat, "reshard_block_lat",
+		   "Time bucket index writes spent blocked by a reshard");
+
+  pcb->add_u64_counter(l_rgw_send_zerocopy_bytes, "send_zerocopy_bytes",
+		      "Response body bytes written from buffer lists without copying");
+  pcb->add_u64_counter(l_rgw_send_copied_bytes, "send_copied_bytes",
+		      "Response body bytes copied before being written");
+
+  // Latency axis configuration for the multipart complete histogram, values
+  // are in nanoseconds
+  PerfHistogramCommon::axis_config_d mpu_lat_axis_config{
+    "Latency (usec)",
+    PerfHistogramCommon::SCALE_LOG2, ///< Latency in logarithmic scale
+    0,                               ///< Start at 0
+    1000000,                         ///< Quantization unit is 1ms
+    20,                              ///< Enough to cover client timeouts
+  };
+  // Part count axis configuration for the multipart complete histogram
+  PerfHistogramCommon::axis_config_d mpu_parts_axis_config{
+    "Parts",
+    PerfHistogramCommon::SCALE_LOG2, ///< Part count in logarithmic scale
+    0,                               ///< Start at 0
+    1,                               ///< Quantization unit is 1 part
+    16,                              ///< Enough to cover the 10000 part limit
+  };
+  pcb->add_time_avg(l_rgw_mpu_complete_lat, "mpu_complete_lat",
+		   "Latency of completing multipart uploads");
+  pcb->add_u64_counter_histogram(l_rgw_mpu_complete_lat_parts_hist,
+				 "mpu_complete_lat_parts_histogram",
+				 mpu_lat_axis_config, mpu_parts_axis_config,
+				 "Histogram of multipart upload completion latency by part count");
 }
 
 void add_rgw_op_counters(PerfCountersBuilder *lpcb) {
@@ -100,6 +140,9 @@ void add_rgw_topic_counters(PerfCountersBuilder *lpcb) {
 
   lpcb->add_u64(l_rgw_persistent_topic_len, "persistent_topic_len", "Persistent topic queue length");
   lpcb->add_u64(l_rgw_persistent_topic_size, "persistent_topic_size", "Persistent topic queue size");
+  lpcb->add_u64_counter(l_rgw_persistent_topic_pushed, "persistent_topic_pushed", "Notifications pushed from the persistent topic queue");
+  lpcb->add_u64_counter(l_rgw_persistent_topic_failed, "persistent_topic_failed", "Failed pushes of notifications from the persistent topic queue");
+  lpcb->add_u64(l_rgw_persistent_topic_lag, "persistent_topic_lag", "Seconds the oldest notification in the persistent topic queue has been waiting");
 
 }
 
@@ -226,6 +269,10 @@ void CountersManager::set(int idx, uint64_t v) {
   topic_counters->set(idx, v);
 }
 
+void CountersManager::inc(int idx, uint64_t v) {
+  topic_counters->inc(idx, v);
+}
+
 CountersManager::~CountersManager() {
   cct->get_perfcounters_collection()->remove(topic_counters.get());
 }
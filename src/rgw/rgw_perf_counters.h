@@ -27,6 +27,10 @@ enum {
   l_rgw_keystone_token_cache_miss,
 
   l_rgw_gc_retire,
+  l_rgw_gc_tail_delete,
+  l_rgw_gc_tail_delete_lat,
+  l_rgw_gc_io_window,
+  l_rgw_gc_oldest_entry_age,
 
   l_rgw_lc_expire_current,
   l_rgw_lc_expire_noncurrent,
@@ -48,10 +52,21 @@ enum {
   l_rgw_lua_current_vms,
   l_rgw_lua_script_ok,
   l_rgw_lua_script_fail,
+  l_rgw_lua_script_lat,
 
   l_rgw_d4n_cache_hits,
   l_rgw_d4n_cache_misses,
   l_rgw_d4n_cache_evictions,
+  l_rgw_d4n_peer_hits,
+
+  l_rgw_reshard_blocked_writes,
+  l_rgw_reshard_block_lat,
+
+  l_rgw_send_zerocopy_bytes,
+  l_rgw_send_copied_bytes,
+
+  l_rgw_mpu_complete_lat,
+  l_rgw_mpu_complete_lat_parts_hist,
 
   l_rgw_last,
 };
@@ -92,6 +107,9 @@ enum {
 
   l_rgw_persistent_topic_len,
   l_rgw_persistent_topic_size,
+  l_rgw_persistent_topic_pushed,
+  l_rgw_persistent_topic_failed,
+  l_rgw_persistent_topic_lag,
 
   l_rgw_topic_last
 };
@@ -124,6 +142,8 @@ public:
 
   void set(int idx, uint64_t v);
 
+  void inc(int idx, uint64_t v);
+
   ~CountersManager();
 
 };
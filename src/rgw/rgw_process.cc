@@ -47,6 +47,33 @@ void RGWProcess::RGWWQ::_dump_queue()
   }
 } /* RGWProcess::RGWWQ::_dump_queue */
 
+// requests are scheduled before authentication, so the tenant is what the
+// request claims: the tenant in the url, else its S3 access key
+static std::string dmclock_tenant(const req_state* s)
+{
+  if (!s->bucket_tenant.empty()) {
+    return s->bucket_tenant;
+  }
+  std::string_view key;
+  if (const char* auth = s->info.env->get("HTTP_AUTHORIZATION"); auth) {
+    std::string_view v{auth};
+    if (auto p = v.find("Credential="); p != v.npos) {
+      // AWS4-HMAC-SHA256 Credential=<key>/<scope>, ...
+      key = v.substr(p + 11);
+      key = key.substr(0, key.find('/'));
+    } else if (v.starts_with("AWS ")) {
+      // AWS <key>:<signature>
+      key = v.substr(4);
+      key = key.substr(0, key.find(':'));
+    }
+  } else if (const auto& cred = s->info.args.get("X-Amz-Credential"); !cred.empty()) {
+    return cred.substr(0, cred.find('/'));
+  } else {
+    return s->info.args.get("AWSAccessKeyId");
+  }
+  return std::string{key};
+}
+
 auto schedule_request(Scheduler *scheduler, req_state *s, RGWOp *op)
 {
   using rgw::dmclock::SchedulerCompleter;
@@ -61,7 +88,7 @@ auto schedule_request(Scheduler *scheduler, req_state *s, RGWOp *op)
 		     << " client=" << static_cast<int>(client)
 		     << " cost=" << cost << dendl;
   }
-  return scheduler->schedule_request(client, {},
+  return scheduler->schedule_request(client, dmclock_tenant(s), {},
                                      req_state::Clock::to_double(s->time),
                                      cost,
                                      s->yield);
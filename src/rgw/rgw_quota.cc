@@ -21,6 +21,7 @@
 #include "common/RefCountedObj.h"
 #include "common/Thread.h"
 #include "common/ceph_mutex.h"
+#include "common/errno.h"
 
 #include "rgw_common.h"
 #include "rgw_sal.h"
@@ -28,10 +29,14 @@
 #include "rgw_quota.h"
 #include "rgw_bucket.h"
 #include "rgw_user.h"
+#include "rgw_quota_deltas.h"
+#include "rgw_tools.h"
 
 #include "services/svc_sys_obj.h"
+#include "services/svc_zone.h"
 
 #include <atomic>
+#include <optional>
 
 #define dout_context g_ceph_context
 #define dout_subsys ceph_subsys_rgw
@@ -222,7 +227,59 @@ void RGWQuotaCache<T>::adjust_stats(const rgw_owner& owner, rgw_bucket& bucket,
   data_modified(owner, bucket);
 }
 
+/// the full stats of a bucket and the published deltas they include, which
+/// later stats are derived from until the next reconcile
+struct RGWBucketStatsBaseline {
+  RGWStorageStats stats; //< read from the bucket index shard headers
+  rgwrados::quota::instance_deltas deltas; //< published deltas read just before
+  rgwrados::quota::stats_delta local; //< this gateway's total at that time
+  utime_t time;
+};
+
 class RGWBucketStatsCache : public RGWQuotaCache<rgw_bucket> {
+  using BaselineRef = std::shared_ptr<const RGWBucketStatsBaseline>;
+
+  std::unique_ptr<rgwrados::quota::DeltaAggregator> deltas;
+  lru_map<rgw_bucket, BaselineRef> baselines;
+  std::atomic<bool> down_flag = { false };
+
+  /* thread, publish the local stats deltas periodically */
+  class DeltaFlushThread : public Thread {
+    CephContext *cct;
+    RGWBucketStatsCache *stats;
+
+    ceph::mutex lock = ceph::make_mutex("RGWBucketStatsCache::DeltaFlushThread");
+    ceph::condition_variable cond;
+  public:
+    DeltaFlushThread(CephContext *_cct, RGWBucketStatsCache *_s) : cct(_cct), stats(_s) {}
+
+    void *entry() override {
+      ldout(cct, 20) << "DeltaFlushThread: start" << dendl;
+      const DoutPrefix dp(cct, dout_subsys, "rgw quota delta flush thread: ");
+      do {
+        const auto interval = std::max<uint64_t>(1,
+            cct->_conf.get_val<uint64_t>("rgw_bucket_quota_delta_flush_interval"));
+        const auto reconcile = std::chrono::seconds(
+            cct->_conf.get_val<uint64_t>("rgw_bucket_quota_reconcile_interval"));
+        {
+          std::unique_lock l{lock};
+          cond.wait_for(l, std::chrono::seconds(interval));
+        }
+        // flush once more when going down
+        stats->deltas->flush(&dp, null_yield, reconcile);
+      } while (!stats->going_down());
+      ldout(cct, 20) << "DeltaFlushThread: done" << dendl;
+
+      return NULL;
+    }
+
+    void stop() {
+      std::lock_guard l{lock};
+      cond.notify_all();
+    }
+  };
+  DeltaFlushThread* flush_thread = nullptr;
+
 protected:
   bool map_find(const rgw_owner& owner, const rgw_bucket& bucket, RGWQuotaCacheStats& qs) override {
     return stats_map.find(bucket, qs);
@@ -239,13 +296,134 @@ protected:
   int fetch_stats_from_storage(const rgw_owner& owner, const rgw_bucket& bucket, RGWStorageStats& stats, optional_yield y, const DoutPrefixProvider *dpp) override;
 
 public:
-  explicit RGWBucketStatsCache(rgw::sal::Driver* _driver) : RGWQuotaCache<rgw_bucket>(_driver, _driver->ctx()->_conf->rgw_bucket_quota_cache_size) {
+  RGWBucketStatsCache(const DoutPrefixProvider *dpp, rgw::sal::Driver* _driver, bool quota_threads);
+  ~RGWBucketStatsCache() override {
+    stop();
   }
 
   int init_refresh(const rgw_owner& owner, const rgw_bucket& bucket,
                    boost::intrusive_ptr<RefCountedWaitObject> waiter) override;
+
+  bool going_down() {
+    return down_flag;
+  }
+
+  void stop() {
+    down_flag = true;
+    if (flush_thread) {
+      flush_thread->stop();
+      flush_thread->join();
+      delete flush_thread;
+      flush_thread = nullptr;
+    }
+  }
+
+  /// add a local change of a bucket with a baseline to the published deltas
+  void record_delta(const rgw_bucket& bucket, int objs_delta,
+                    uint64_t added_bytes, uint64_t removed_bytes);
+
+  /// the current stats of a bucket, from its baseline plus the changes that
+  /// were published since
+  RGWStorageStats estimate(const rgw_bucket& bucket,
+                           const RGWBucketStatsBaseline& baseline,
+                           rgwrados::quota::instance_deltas cur);
+
+  void set_baseline(const DoutPrefixProvider *dpp, const rgw_bucket& bucket,
+                    const RGWStorageStats& stats,
+                    rgwrados::quota::instance_deltas&& published,
+                    const rgwrados::quota::stats_delta& local);
 };
 
+RGWBucketStatsCache::RGWBucketStatsCache(const DoutPrefixProvider *dpp,
+                                         rgw::sal::Driver* _driver,
+                                         bool quota_threads)
+  : RGWQuotaCache<rgw_bucket>(_driver, _driver->ctx()->_conf->rgw_bucket_quota_cache_size),
+    baselines(_driver->ctx()->_conf->rgw_bucket_quota_cache_size)
+{
+  auto cct = driver->ctx();
+  if (!quota_threads ||
+      !cct->_conf.get_val<bool>("rgw_bucket_quota_delta_aggregation")) {
+    return;
+  }
+  auto rados = dynamic_cast<rgw::sal::RadosStore*>(driver);
+  if (!rados) {
+    ldpp_dout(dpp, 1) << "WARNING: rgw_bucket_quota_delta_aggregation "
+        "requires the rados driver" << dendl;
+    return;
+  }
+  librados::IoCtx ioctx;
+  int r = rgw_init_ioctx(dpp, rados->getRados()->get_rados_handle(),
+                         rados->svc()->zone->get_zone_params().log_pool,
+                         ioctx, true, true);
+  if (r < 0) {
+    ldpp_dout(dpp, 0) << "ERROR: failed to open the log pool for quota deltas: "
+        << cpp_strerror(r) << dendl;
+    return;
+  }
+  deltas = std::make_unique<rgwrados::quota::DeltaAggregator>(
+      std::move(ioctx), rados->getRados()->instance_id(),
+      cct->_conf.get_val<uint64_t>("rgw_bucket_quota_delta_shards"));
+  flush_thread = new DeltaFlushThread(cct, this);
+  flush_thread->create("rgw_quota_delta");
+}
+
+void RGWBucketStatsCache::record_delta(const rgw_bucket& bucket, int objs_delta,
+                                       uint64_t added_bytes, uint64_t removed_bytes)
+{
+  BaselineRef baseline;
+  if (!deltas || !baselines.find(bucket, baseline)) {
+    return;
+  }
+  rgwrados::quota::stats_delta d;
+  d.num_objects = objs_delta;
+  d.size = static_cast<int64_t>(added_bytes) - static_cast<int64_t>(removed_bytes);
+  d.size_rounded = static_cast<int64_t>(rgw_rounded_objsize(added_bytes)) -
+      static_cast<int64_t>(rgw_rounded_objsize(removed_bytes));
+  deltas->add(bucket, d);
+}
+
+RGWStorageStats RGWBucketStatsCache::estimate(const rgw_bucket& bucket,
+                                              const RGWBucketStatsBaseline& baseline,
+                                              rgwrados::quota::instance_deltas cur)
+{
+  // our own changes are taken from the local total, which includes those
+  // that weren't published yet
+  auto before = baseline.deltas;
+  before.erase(deltas->get_instance());
+  cur.erase(deltas->get_instance());
+
+  auto d = rgwrados::quota::difference(before, cur);
+  auto local = deltas->local_total(bucket);
+  local -= baseline.local;
+  d += local;
+
+  RGWStorageStats stats = baseline.stats;
+  rgwrados::quota::apply(d, stats);
+  return stats;
+}
+
+void RGWBucketStatsCache::set_baseline(const DoutPrefixProvider *dpp,
+                                       const rgw_bucket& bucket,
+                                       const RGWStorageStats& stats,
+                                       rgwrados::quota::instance_deltas&& published,
+                                       const rgwrados::quota::stats_delta& local)
+{
+  // live gateways republish every reconcile interval, at the next flush
+  const auto& conf = driver->ctx()->_conf;
+  const auto reconcile = std::chrono::seconds(std::max(
+      conf.get_val<uint64_t>("rgw_bucket_quota_reconcile_interval"),
+      conf.get_val<uint64_t>("rgw_bucket_quota_delta_flush_interval")));
+  deltas->trim(dpp, bucket, published, 2 * reconcile);
+
+  auto baseline = std::make_shared<RGWBucketStatsBaseline>();
+  baseline->stats = stats;
+  baseline->deltas = std::move(published);
+  baseline->local = local;
+  baseline->time = ceph_clock_now();
+  BaselineRef ref = std::move(baseline);
+  baselines.add(bucket, ref);
+}
+
 int RGWBucketStatsCache::fetch_stats_from_storage(const rgw_owner& owner, const rgw_bucket& _b, RGWStorageStats& stats, optional_yield y, const DoutPrefixProvider *dpp)
 {
   std::unique_ptr<rgw::sal::Bucket> bucket;
@@ -263,6 +441,22 @@ int RGWBucketStatsCache::fetch_stats_from_storage(const rgw_owner& owner, const
     return 0;
   }
 
+  // read the published deltas before the shard headers, so the changes that
+  // race with the read are taken from the deltas later. they may count twice
+  // until the next reconcile, but are never missed
+  std::optional<rgwrados::quota::instance_deltas> published;
+  rgwrados::quota::stats_delta local;
+  if (deltas) {
+    published.emplace();
+    local = deltas->local_total(_b);
+    r = deltas->read(dpp, _b, *published, y);
+    if (r < 0) {
+      ldpp_dout(dpp, 1) << "WARNING: could not read quota deltas for bucket="
+          << _b << " r=" << r << dendl;
+      published.reset();
+    }
+  }
+
   string bucket_ver;
   string master_ver;
 
@@ -283,6 +477,10 @@ int RGWBucketStatsCache::fetch_stats_from_storage(const rgw_owner& owner, const
     stats.num_objects += s.num_objects;
   }
 
+  if (published) {
+    set_baseline(dpp, _b, stats, std::move(*published), local);
+  }
+
   return 0;
 }
 
@@ -291,22 +489,78 @@ class BucketAsyncRefreshHandler : public rgw::sal::ReadStatsCB {
   boost::intrusive_ptr<RefCountedWaitObject> waiter;
   rgw_owner owner;
   rgw_bucket bucket;
+  // with delta aggregation, the deltas read before the shard headers
+  std::optional<rgwrados::quota::instance_deltas> published;
+  rgwrados::quota::stats_delta local;
 public:
   BucketAsyncRefreshHandler(RGWBucketStatsCache* cache,
                             boost::intrusive_ptr<RefCountedWaitObject> waiter,
                             const rgw_owner& owner, const rgw_bucket& bucket)
     : cache(cache), waiter(std::move(waiter)), owner(owner), bucket(bucket) {}
 
+  void set_published(rgwrados::quota::instance_deltas&& deltas,
+                     const rgwrados::quota::stats_delta& l) {
+    published = std::move(deltas);
+    local = l;
+  }
+
   void handle_response(int r, const RGWStorageStats& stats) override {
     if (r < 0) {
       cache->async_refresh_fail(owner, bucket);
       return;
     }
 
+    if (published) {
+      const DoutPrefix dp(g_ceph_context, dout_subsys, "rgw bucket async refresh handler: ");
+      cache->set_baseline(&dp, bucket, stats, std::move(*published), local);
+    }
     cache->async_refresh_response(owner, bucket, stats);
   }
 };
 
+/// refresh with the published deltas, and start a full read of the shard
+/// headers when the bucket is due for a reconcile
+class BucketDeltasRefreshHandler : public rgwrados::quota::ReadDeltasCB {
+  RGWBucketStatsCache* cache;
+  boost::intrusive_ptr<RefCountedWaitObject> waiter;
+  rgw_owner owner;
+  std::unique_ptr<rgw::sal::Bucket> bucket;
+  std::shared_ptr<const RGWBucketStatsBaseline> baseline;
+  rgwrados::quota::stats_delta local;
+public:
+  BucketDeltasRefreshHandler(RGWBucketStatsCache* cache,
+                             boost::intrusive_ptr<RefCountedWaitObject> waiter,
+                             const rgw_owner& owner,
+                             std::unique_ptr<rgw::sal::Bucket> bucket,
+                             std::shared_ptr<const RGWBucketStatsBaseline> baseline,
+                             const rgwrados::quota::stats_delta& local)
+    : cache(cache), waiter(std::move(waiter)), owner(owner),
+      bucket(std::move(bucket)), baseline(std::move(baseline)), local(local) {}
+
+  void handle_response(int r, rgwrados::quota::instance_deltas&& deltas) override {
+    rgw_bucket b = bucket->get_key();
+    if (r < 0) {
+      cache->async_refresh_fail(owner, b);
+      return;
+    }
+
+    if (baseline) {
+      cache->async_refresh_response(owner, b, cache->estimate(b, *baseline, std::move(deltas)));
+      return;
+    }
+
+    const DoutPrefix dp(g_ceph_context, dout_subsys, "rgw bucket async refresh handler: ");
+    boost::intrusive_ptr handler = new BucketAsyncRefreshHandler(
+        cache, waiter, owner, b);
+    handler->set_published(std::move(deltas), local);
+    r = bucket->read_stats_async(&dp, bucket->get_info().get_current_index(),
+                                 RGW_NO_SHARD, std::move(handler));
+    if (r < 0) {
+      ldpp_dout(&dp, 0) << "could not get bucket stats for bucket=" << b.name << dendl;
+    }
+  }
+};
+
 
 int RGWBucketStatsCache::init_refresh(const rgw_owner& owner, const rgw_bucket& bucket,
                                      boost::intrusive_ptr<RefCountedWaitObject> waiter)
@@ -327,6 +581,29 @@ int RGWBucketStatsCache::init_refresh(const rgw_owner& owner, const rgw_bucket&
     return 0;
   }
 
+  if (deltas) {
+    // read the published deltas first. a bucket whose baseline is older
+    // than rgw_bucket_quota_reconcile_interval reads its shard headers next
+    BaselineRef baseline;
+    if (baselines.find(bucket, baseline)) {
+      utime_t due = baseline->time;
+      due += driver->ctx()->_conf.get_val<uint64_t>("rgw_bucket_quota_reconcile_interval");
+      if (ceph_clock_now() >= due) {
+        baseline.reset();
+      }
+    }
+    const auto local = deltas->local_total(bucket);
+    boost::intrusive_ptr handler = new BucketDeltasRefreshHandler(
+        this, std::move(waiter), owner, std::move(rbucket),
+        std::move(baseline), local);
+    r = deltas->read_async(&dp, bucket, std::move(handler));
+    if (r < 0) {
+      ldpp_dout(&dp, 0) << "could not read quota deltas for bucket=" << bucket.name << dendl;
+      return r;
+    }
+    return 0;
+  }
+
   boost::intrusive_ptr handler = new BucketAsyncRefreshHandler(
       this, std::move(waiter), owner, bucket);
 
@@ -927,7 +1204,7 @@ class RGWQuotaHandlerImpl : public RGWQuotaHandler {
   }
 public:
   RGWQuotaHandlerImpl(const DoutPrefixProvider *dpp, rgw::sal::Driver* _driver, bool quota_threads) : driver(_driver),
-                                    bucket_stats_cache(_driver),
+                                    bucket_stats_cache(dpp, _driver, quota_threads),
                                     owner_stats_cache(dpp, _driver, quota_threads) {}
 
   int check_quota(const DoutPrefixProvider *dpp,
@@ -977,6 +1254,7 @@ public:
 
   void update_stats(const rgw_owner& owner, rgw_bucket& bucket, int obj_delta, uint64_t added_bytes, uint64_t removed_bytes) override {
     bucket_stats_cache.adjust_stats(owner, bucket, obj_delta, added_bytes, removed_bytes);
+    bucket_stats_cache.record_delta(bucket, obj_delta, added_bytes, removed_bytes);
     owner_stats_cache.adjust_stats(owner, bucket, obj_delta, added_bytes, removed_bytes);
   }
 }; // class RGWQuotaHandlerImpl
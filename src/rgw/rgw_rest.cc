@@ -783,9 +783,7 @@ void dump_range(req_state* const s,
 }
 
 
-int dump_body(req_state* const s,
-              const char* const buf,
-              const size_t len)
+static void ratelimit_body(req_state* const s, const size_t len)
 {
   bool healthcheck = false;
   // we dont want to limit health checks
@@ -797,6 +795,13 @@ int dump_body(req_state* const s,
     if(!rgw::sal::Bucket::empty(s->bucket.get()))
       s->ratelimit_data->decrease_bytes(method, s->ratelimit_bucket_marker, len, &s->bucket_ratelimit);
   }
+}
+
+int dump_body(req_state* const s,
+              const char* const buf,
+              const size_t len)
+{
+  ratelimit_body(s, len);
   try {
     return RESTFUL_IO(s)->send_body(buf, len);
   } catch (rgw::io::Exception& e) {
@@ -804,9 +809,22 @@ int dump_body(req_state* const s,
   }
 }
 
+int dump_body(req_state* const s,
+              const ceph::buffer::list& bl,
+              const size_t ofs,
+              const size_t len)
+{
+  ratelimit_body(s, len);
+  try {
+    return RESTFUL_IO(s)->send_body_buffers(bl, ofs, len);
+  } catch (rgw::io::Exception& e) {
+    return -e.code().value();
+  }
+}
+
 int dump_body(req_state* const s, /* const */ ceph::buffer::list& bl)
 {
-  return dump_body(s, bl.c_str(), bl.length());
+  return dump_body(s, bl, 0, bl.length());
 }
 
 int dump_body(req_state* const s, const std::string& str)
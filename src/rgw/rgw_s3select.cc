@@ -291,7 +291,8 @@ RGWSelectObj_ObjStore_S3::RGWSelectObj_ObjStore_S3():
   m_requested_range(0),
   m_scan_offset(1024),
   m_skip_next_chunk(false),
-  m_is_trino_request(false)
+  m_is_trino_request(false),
+  m_align_scan_range(false)
 {
   set_get_data(true);
   fp_get_obj_size = [&]() {
@@ -377,6 +378,10 @@ int RGWSelectObj_ObjStore_S3::get_params(optional_yield y)
       }
     }
   }
+  //record aligned scan-ranges let a client split an object into ranges and query them concurrently
+  m_align_scan_range = m_is_trino_request ||
+    s->cct->_conf.get_val<bool>("rgw_s3select_scan_range_align_records");
+  m_scan_offset = s->cct->_conf.get_val<Option::size_t>("rgw_s3select_scan_range_overread");
 
   int status = handle_aws_cli_parameters(m_sql_query);
   if (status<0) {
@@ -780,7 +785,7 @@ void RGWSelectObj_ObjStore_S3::execute(optional_yield y)
 
 	  m_requested_range = (m_end_scan_sz - m_start_scan_sz);
 	    
-	  if (m_is_trino_request){
+	  if (m_align_scan_range){
 	  // fetch more than requested(m_scan_offset), that additional bytes are scanned for end of row, 
 	  // thus the additional length will be processed, and no broken row for Trino.
 	  // assumption: row is smaller than m_scan_offset. (a different approach is to request for additional range)
@@ -823,7 +828,7 @@ int RGWSelectObj_ObjStore_S3::parquet_processing(bufferlist& bl, off_t ofs, off_
 
 void RGWSelectObj_ObjStore_S3::shape_chunk_per_trino_requests(const char* it_cp, off_t& ofs, off_t& len)
 {
-//in case it is a scan range request and sent by Trino client.
+//in case it is a scan range request sent by Trino client, or record alignment is configured.
 //this routine chops the start/end of chunks.
 //the purpose is to return "perfect" results, with no broken or missing lines.
 
@@ -900,6 +905,19 @@ int RGWSelectObj_ObjStore_S3::csv_processing(bufferlist& bl, off_t ofs, off_t le
     if (status<0){
       return -EINVAL;
     }
+  } else if (!m_align_scan_range && bl.get_num_buffers() > 1 && uint64_t(ofs) < bl.length()) {
+    //a chunk read from rados consists of many small segments, and each engine call
+    //carries its own setup, continuation and progress messages.
+    //the CSV reader keeps rows split between calls, so the whole chunk is processed at once.
+    m_csv_batch.clear();
+    bl.begin(ofs).copy(bl.length() - ofs, m_csv_batch);
+    ldpp_dout(this, 10) << "s3select: chunk of " << bl.get_num_buffers() << " segments: ofs = " << ofs
+                        << " length = " << m_csv_batch.size() << " m_object_size_for_processing = " << m_object_size_for_processing << dendl;
+    m_aws_response_handler.update_processed_size(bl.length());
+    status = run_s3select_on_csv(m_sql_query.c_str(), m_csv_batch.data(), m_csv_batch.size());
+    if (status<0) {
+      return -EINVAL;
+    }
   } else {
     auto bl_len = bl.get_num_buffers();
     int buff_no=0;
@@ -919,7 +937,7 @@ int RGWSelectObj_ObjStore_S3::csv_processing(bufferlist& bl, off_t ofs, off_t le
 	ofs = 0;
       }
 
-    if (m_is_trino_request){
+    if (m_align_scan_range){
       //TODO replace len with it.length() ? ; test Trino flow with compressed objects.
       //is it possible to send get-by-ranges? in parallel?
       shape_chunk_per_trino_requests(&(it)[0], ofs, len); 
@@ -230,6 +230,8 @@ private:
   //a request for range may satisfy by several calls to send_response_date;
   size_t m_request_range;
   std::string requested_buffer;
+  //the segments of a CSV chunk, concatenated into a single engine input
+  std::string m_csv_batch;
   std::string range_req_str;
   std::function<int(std::string&)> fp_result_header_format;
   std::function<int(std::string&)> fp_s3select_result_format;
@@ -248,6 +250,7 @@ public:
   size_t m_scan_offset;
   bool m_skip_next_chunk;
   bool m_is_trino_request;
+  bool m_align_scan_range;
 
   RGWSelectObj_ObjStore_S3();
   virtual ~RGWSelectObj_ObjStore_S3();
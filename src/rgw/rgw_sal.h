@@ -164,6 +164,9 @@ static constexpr uint32_t FLAG_PREVENT_VERSIONING = 0x0002;
 // delete object where head object is missing)
 static constexpr uint32_t FLAG_FORCE_OP = 0x0004;
 static constexpr uint32_t FLAG_SKIP_UPDATE_OLH = 0x0008;
+// the bucket index update may wait briefly to be sent along with others for
+// the same index shard (e.g., the deletes of a multi-object delete)
+static constexpr uint32_t FLAG_BATCH_INDEX = 0x0010;
 
 enum class RGWRestoreStatus : uint8_t {
   None  = 0,
@@ -1672,6 +1675,25 @@ public:
   virtual int put_head(const DoutPrefixProvider* dpp, optional_yield y,
                        const std::string& oid, const LCHead& head) = 0;
 
+  /** Get the listing positions saved while processing the bucket of an
+   * entry, so that processing can resume from there */
+  virtual int get_bucket_progress(const DoutPrefixProvider* dpp, optional_yield y,
+                                  const std::string& bucket,
+                                  std::map<std::string, rgw_obj_key>& markers) {
+    return -EOPNOTSUPP;
+  }
+  /** Save listing positions of a bucket being processed, keeping the others */
+  virtual int set_bucket_progress(const DoutPrefixProvider* dpp, optional_yield y,
+                                  const std::string& bucket,
+                                  const std::map<std::string, rgw_obj_key>& markers) {
+    return -EOPNOTSUPP;
+  }
+  /** Drop the saved positions once the bucket was processed completely */
+  virtual int rm_bucket_progress(const DoutPrefixProvider* dpp, optional_yield y,
+                                 const std::string& bucket) {
+    return -EOPNOTSUPP;
+  }
+
   /** Get a serializer for lifecycle */
   virtual std::unique_ptr<LCSerializer> get_serializer(const std::string& lock_name,
 						       const std::string& oid,
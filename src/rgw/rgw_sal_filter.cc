@@ -1449,6 +1449,29 @@ int FilterLifecycle::put_head(const DoutPrefixProvider* dpp, optional_yield y,
   return next->put_head(dpp, y, oid, head);
 }
 
+int FilterLifecycle::get_bucket_progress(const DoutPrefixProvider* dpp,
+                                         optional_yield y,
+                                         const std::string& bucket,
+                                         std::map<std::string, rgw_obj_key>& markers)
+{
+  return next->get_bucket_progress(dpp, y, bucket, markers);
+}
+
+int FilterLifecycle::set_bucket_progress(const DoutPrefixProvider* dpp,
+                                         optional_yield y,
+                                         const std::string& bucket,
+                                         const std::map<std::string, rgw_obj_key>& markers)
+{
+  return next->set_bucket_progress(dpp, y, bucket, markers);
+}
+
+int FilterLifecycle::rm_bucket_progress(const DoutPrefixProvider* dpp,
+                                        optional_yield y,
+                                        const std::string& bucket)
+{
+  return next->rm_bucket_progress(dpp, y, bucket);
+}
+
 std::unique_ptr<LCSerializer> FilterLifecycle::get_serializer(
 					      const std::string& lock_name,
 					      const std::string& oid,
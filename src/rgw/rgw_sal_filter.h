@@ -1056,6 +1056,14 @@ public:
                        const std::string& oid, LCHead& head) override;
   virtual int put_head(const DoutPrefixProvider* dpp, optional_yield y,
                        const std::string& oid, const LCHead& head) override;
+  virtual int get_bucket_progress(const DoutPrefixProvider* dpp, optional_yield y,
+                                  const std::string& bucket,
+                                  std::map<std::string, rgw_obj_key>& markers) override;
+  virtual int set_bucket_progress(const DoutPrefixProvider* dpp, optional_yield y,
+                                  const std::string& bucket,
+                                  const std::map<std::string, rgw_obj_key>& markers) override;
+  virtual int rm_bucket_progress(const DoutPrefixProvider* dpp, optional_yield y,
+                                 const std::string& bucket) override;
   virtual std::unique_ptr<LCSerializer> get_serializer(const std::string& lock_name,
 						       const std::string& oid,
 						       const std::string& cookie) override;
@@ -3,7 +3,10 @@
 
 #include "rgw_sal_rados.h"
 
+#include <boost/asio/io_context.hpp>
+
 #include "include/types.h"
+#include "common/async/spawn_throttle.h"
 #include "rgw_user.h"
 
 // until everything is moved from rgw_common
@@ -13,9 +16,80 @@
 
 using namespace std;
 
+static int sync_bucket_stats(const DoutPrefixProvider *dpp,
+                             optional_yield y, rgw::sal::Driver* driver,
+                             RGWBucketEnt& ent)
+{
+  std::unique_ptr<rgw::sal::Bucket> bucket;
+  int ret = driver->load_bucket(dpp, ent.bucket, &bucket, y);
+  if (ret < 0) {
+    ldpp_dout(dpp, 0) << "ERROR: could not read bucket info: bucket=" << ent.bucket << " ret=" << ret << dendl;
+    return 0;
+  }
+  ret = bucket->sync_owner_stats(dpp, y, &ent);
+  if (ret < 0) {
+    ldpp_dout(dpp, 0) << "ERROR: could not sync bucket stats: ret=" << ret << dendl;
+    return ret;
+  }
+  ret = bucket->check_bucket_shards(dpp, ent.count, y);
+  if (ret < 0) {
+    ldpp_dout(dpp, 0) << "ERROR in check_bucket_shards: " << cpp_strerror(-ret)<< dendl;
+  }
+  return 0;
+}
+
+/* sync a page of buckets with up to max_aio of them in flight, returning the
+ * first error */
+static int sync_bucket_stats(const DoutPrefixProvider *dpp,
+                             optional_yield y, rgw::sal::Driver* driver,
+                             std::vector<RGWBucketEnt>& buckets,
+                             int max_aio)
+{
+  int ret = 0;
+  if (max_aio <= 1) {
+    for (auto& ent : buckets) {
+      ret = sync_bucket_stats(dpp, y, driver, ent);
+      if (ret < 0) {
+        return ret;
+      }
+    }
+    return 0;
+  }
+
+  auto sync_all = [&] (boost::asio::yield_context yield) {
+    auto throttle = ceph::async::spawn_throttle{yield, size_t(max_aio)};
+    for (auto& ent : buckets) {
+      if (ret < 0) {
+        break;
+      }
+      throttle.spawn([&] (boost::asio::yield_context yield) {
+        int r = sync_bucket_stats(dpp, yield, driver, ent);
+        if (r < 0 && ret == 0) {
+          ret = r;
+        }
+      });
+    }
+    throttle.wait();
+  };
+
+  // if we're not running in a coroutine, spawn one
+  if (!y) {
+    boost::asio::io_context context;
+    boost::asio::spawn(context, sync_all,
+        [] (std::exception_ptr eptr) {
+          if (eptr) std::rethrow_exception(eptr);
+        });
+    context.run();
+  } else {
+    sync_all(y.get_yield_context());
+  }
+  return ret;
+}
+
 int rgw_sync_all_stats(const DoutPrefixProvider *dpp,
                        optional_yield y, rgw::sal::Driver* driver,
-                       const rgw_owner& owner, const std::string& tenant)
+                       const rgw_owner& owner, const std::string& tenant,
+                       int max_aio)
 {
   size_t max_entries = dpp->get_cct()->_conf->rgw_list_buckets_max_chunk;
 
@@ -29,22 +103,9 @@ int rgw_sync_all_stats(const DoutPrefixProvider *dpp,
       return ret;
     }
 
-    for (auto& ent : listing.buckets) {
-      std::unique_ptr<rgw::sal::Bucket> bucket;
-      ret = driver->load_bucket(dpp, ent.bucket, &bucket, y);
-      if (ret < 0) {
-        ldpp_dout(dpp, 0) << "ERROR: could not read bucket info: bucket=" << bucket << " ret=" << ret << dendl;
-        continue;
-      }
-      ret = bucket->sync_owner_stats(dpp, y, &ent);
-      if (ret < 0) {
-        ldpp_dout(dpp, 0) << "ERROR: could not sync bucket stats: ret=" << ret << dendl;
-        return ret;
-      }
-      ret = bucket->check_bucket_shards(dpp, ent.count, y);
-      if (ret < 0) {
-	ldpp_dout(dpp, 0) << "ERROR in check_bucket_shards: " << cpp_strerror(-ret)<< dendl;
-      }
+    ret = sync_bucket_stats(dpp, y, driver, listing.buckets, max_aio);
+    if (ret < 0) {
+      return ret;
     }
   } while (!listing.next_marker.empty());
 
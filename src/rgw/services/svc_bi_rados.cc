@@ -931,6 +931,7 @@ struct ListReader : rgwrados::shard_io::RadosReader {
   uint32_t num_entries;
   bool list_versions;
   std::map<int, rgw_cls_list_ret>& results;
+  const std::map<int, uint32_t>* shard_num_entries;
 
   ListReader(const DoutPrefixProvider& dpp,
              boost::asio::any_io_executor ex,
@@ -939,23 +940,32 @@ struct ListReader : rgwrados::shard_io::RadosReader {
              const std::string& prefix,
              const std::string& delimiter,
              uint32_t num_entries, bool list_versions,
-             std::map<int, rgw_cls_list_ret>& results)
+             std::map<int, rgw_cls_list_ret>& results,
+             const std::map<int, uint32_t>* shard_num_entries)
     : RadosReader(dpp, std::move(ex), ioctx),
       start_obj(start_obj), prefix(prefix), delimiter(delimiter),
       num_entries(num_entries), list_versions(list_versions),
-      results(results)
+      results(results), shard_num_entries(shard_num_entries)
   {}
   void prepare_read(int shard, librados::ObjectReadOperation& op) override {
     // set the marker depending on whether we've already queried this
     // shard and gotten a RGWBIAdvanceAndRetryError (defined
-    // constant) return value; if we have use the marker in the return
-    // to advance the search, otherwise use the marker passed in by the
+    // constant) return value, or the caller is resuming this shard
+    // from where an earlier listing left it; if so use that marker to
+    // advance the search, otherwise use the marker passed in by the
     // caller
     auto& result = results[shard];
     const cls_rgw_obj_key& marker =
         result.marker.empty() ? start_obj : result.marker;
+    uint32_t n = num_entries;
+    if (shard_num_entries) {
+      if (auto i = shard_num_entries->find(shard);
+          i != shard_num_entries->end()) {
+        n = i->second;
+      }
+    }
     cls_rgw_bucket_list_op(op, marker, prefix, delimiter,
-                           num_entries, list_versions, &result);
+                           n, list_versions, &result);
   }
   Result on_complete(int, boost::system::error_code ec) override {
     if (ec.value() == -RGWBIAdvanceAndRetryError) {
@@ -978,7 +988,8 @@ int RGWSI_BucketIndex_RADOS::list_objects(const DoutPrefixProvider* dpp, optiona
                                           const std::string& prefix,
                                           const std::string& delimiter,
                                           uint32_t num_entries, bool list_versions,
-                                          std::map<int, rgw_cls_list_ret>& results)
+                                          std::map<int, rgw_cls_list_ret>& results,
+                                          const std::map<int, uint32_t>* shard_num_entries)
 {
   const size_t max_aio = cct->_conf->rgw_bucket_index_max_aio;
   boost::system::error_code ec;
@@ -987,14 +998,16 @@ int RGWSI_BucketIndex_RADOS::list_objects(const DoutPrefixProvider* dpp, optiona
     auto yield = y.get_yield_context();
     auto ex = yield.get_executor();
     auto reader = ListReader{*dpp, ex, index_pool, start_obj, prefix, delimiter,
-                             num_entries, list_versions, results};
+                             num_entries, list_versions, results,
+                             shard_num_entries};
 
     rgwrados::shard_io::async_reads(reader, bucket_objs, max_aio, yield[ec]);
   } else {
     // run a strand on the system executor and block on a condition variable
     auto ex = boost::asio::make_strand(boost::asio::system_executor{});
     auto reader = ListReader{*dpp, ex, index_pool, start_obj, prefix, delimiter,
-                             num_entries, list_versions, results};
+                             num_entries, list_versions, results,
+                             shard_num_entries};
 
     maybe_warn_about_blocking(dpp);
     rgwrados::shard_io::async_reads(reader, bucket_objs, max_aio,
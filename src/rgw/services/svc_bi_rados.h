@@ -157,6 +157,9 @@ public:
                     const RGWBucketInfo& bucket_info);
 
   /// Read the requested number of entries from each index shard object.
+  /// A shard whose entry in results already has a marker is read from
+  /// that marker instead of start_obj, and a shard present in
+  /// shard_num_entries reads that many entries instead of num_entries.
   int list_objects(const DoutPrefixProvider* dpp, optional_yield y,
                    librados::IoCtx& index_pool,
                    const std::map<int, std::string>& bucket_objs,
@@ -164,7 +167,8 @@ public:
                    const std::string& prefix,
                    const std::string& delimiter,
                    uint32_t num_entries, bool list_versions,
-                   std::map<int, rgw_cls_list_ret>& results);
+                   std::map<int, rgw_cls_list_ret>& results,
+                   const std::map<int, uint32_t>* shard_num_entries = nullptr);
 
   int handle_overwrite(const DoutPrefixProvider *dpp, const RGWBucketInfo& info,
                        const RGWBucketInfo& orig_info,
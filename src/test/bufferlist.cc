@@ -25,6 +25,10 @@
 #include <sys/uio.h>
 
 #include <iostream> // for std::cout
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #include "include/buffer.h"
 #include "include/buffer_raw.h"
@@ -148,6 +152,103 @@ TEST(Buffer, BenchAlloc) {
   bench_buffer_alloc(4, 1000000);
 }
 
+TEST(Buffer, Slab) {
+  buffer::use_slab(true);
+  auto& idle = mempool::get_pool(mempool::mempool_buffer_slab);
+  {
+    std::vector<bufferptr> ptrs;
+    for (unsigned len : {1u, 100u, 1000u, 3000u, 4000u, 10000u}) {
+      bufferptr p = buffer::create(len, 'x');
+      EXPECT_EQ(len, p.length());
+      EXPECT_EQ(0u, (uintptr_t)p.c_str() % sizeof(size_t));
+      ptrs.push_back(std::move(p));
+    }
+    // freed on the allocating thread: kept for reuse
+    const char *data = ptrs[1].c_str();
+    ptrs[1] = bufferptr();
+    EXPECT_LT(0, idle.allocated_bytes());
+    bufferptr again = buffer::create(100);
+    EXPECT_EQ(data, again.c_str());
+  }
+  {
+    // freed by another thread, after the allocating thread is gone
+    std::vector<bufferptr> ptrs;
+    std::thread producer([&] {
+      for (int i = 0; i < 1000; ++i) {
+	ptrs.push_back(buffer::create(i % 2000, 'y'));
+      }
+    });
+    producer.join();
+    std::thread consumer([&] {
+      for (auto& p : ptrs) {
+	EXPECT_EQ('y', p.length() ? p[0] : 'y');
+      }
+      ptrs.clear();
+    });
+    consumer.join();
+  }
+  buffer::use_slab(false);
+}
+
+// a receiving messenger thread allocates header, front, data and footer
+// buffers per message and hands the message to a worker thread that
+// decodes and drops it, so nearly every buffer is freed remotely
+static double bench_decode_path(bool slab, int num)
+{
+  buffer::use_slab(slab);
+  std::mutex lock;
+  std::condition_variable cond;
+  std::deque<bufferlist> queue;
+  bool done = false;
+  utime_t start = ceph_clock_now();
+  std::thread worker([&] {
+    uint64_t sum = 0;
+    std::unique_lock l(lock);
+    while (!done || !queue.empty()) {
+      if (queue.empty()) {
+	cond.wait(l);
+	continue;
+      }
+      bufferlist bl = std::move(queue.front());
+      queue.pop_front();
+      l.unlock();
+      for (const auto& p : bl.buffers()) {
+	sum += p.c_str()[0];
+      }
+      bl.clear();
+      l.lock();
+    }
+    EXPECT_LT(0u, sum);
+  });
+  for (int i = 0; i < num; ++i) {
+    bufferlist bl;
+    bl.append(buffer::create(53, 'h'));
+    bl.append(buffer::create(150 + i % 200, 'f'));
+    bl.append(buffer::create(512 << (i % 3), 'd'));
+    bl.append(buffer::create(21, 't'));
+    std::lock_guard l(lock);
+    queue.push_back(std::move(bl));
+    cond.notify_one();
+  }
+  {
+    std::lock_guard l(lock);
+    done = true;
+    cond.notify_one();
+  }
+  worker.join();
+  utime_t end = ceph_clock_now();
+  buffer::use_slab(false);
+  return (double)(end - start);
+}
+
+TEST(Buffer, BenchSlabDecode) {
+  constexpr int num = 1000000;
+  double malloc_time = bench_decode_path(false, num);
+  double slab_time = bench_decode_path(true, num);
+  cout << num << " messages: allocator " << malloc_time
+       << "s, slab " << slab_time << "s" << std::endl;
+}
+
 TEST(BufferRaw, ostream) {
   bufferptr ptr(1);
   std::ostringstream stream;
@@ -2574,6 +2675,53 @@ TEST(BufferList, crc32c) {
   EXPECT_EQ((unsigned)0x5FA5C0CC, crc);
 }
 
+TEST(BufferList, set_crc32c) {
+  bufferlist bl;
+  bl.append(buffer::create(4096, 'x'));
+  const uint32_t crc = ceph_crc32c(-1, (unsigned char*)bl.c_str(), bl.length());
+  bl.set_crc32c(-1, 0x12345678);
+  // the recorded value is trusted as-is ...
+  EXPECT_EQ(0x12345678u, bl.crc32c(-1));
+  // ... and adjusted for a different seed
+  bl.set_crc32c(-1, crc);
+  EXPECT_EQ(ceph_crc32c(7, (unsigned char*)bl.c_str(), bl.length()),
+	    bl.crc32c(7));
+
+  // lists of more than one buffer are left alone
+  bufferlist bl2;
+  bl2.append(buffer::create(10, 'a'));
+  bl2.append(buffer::create(10, 'b'));
+  const uint32_t crc2 = bl2.crc32c(-1);
+  bl2.set_crc32c(-1, 0x12345678);
+  EXPECT_EQ(crc2, bl2.crc32c(-1));
+}
+
+TEST(BufferList, crc32c_fragments) {
+  // a mix of small and large uncached fragments, with a cached one in
+  // the middle, must crc the same as the flat buffer
+  bufferlist frags;
+  for (int i = 0; i < 50; ++i) {
+    bufferptr p(buffer::create(rand() % 700));
+    for (unsigned j = 0; j < p.length(); ++j) {
+      p[j] = rand();
+    }
+    if (i == 25) {
+      bufferlist one;
+      one.append(p);
+      one.crc32c(rand());
+    }
+    frags.append(p);
+  }
+  bufferlist copy(frags);
+  bufferlist flat(frags);
+  flat.rebuild();
+  const uint32_t seed = rand();
+  const uint32_t expected = flat.crc32c(seed);
+  ASSERT_EQ(expected, frags.crc32c(seed));
+  // and again, from the cache
+  ASSERT_EQ(expected, copy.crc32c(seed));
+}
+
 TEST(BufferList, crc32c_append) {
   bufferlist bl1;
   bufferlist bl2;
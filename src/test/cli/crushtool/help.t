@@ -107,6 +107,7 @@
      --show-mappings       show mappings
      --show-bad-mappings   show bad mappings
      --show-choose-tries   show choose tries histogram
+     --show-bench          time the mappings and show mappings per second
      --output-name name
                            prepend the data file(s) generated during the
                            testing routine with name
@@ -341,12 +341,15 @@
                                        object deletions by not involving GC
      --inconsistent-index              when specified with bucket deletion and bypass-gc set to true,
                                        ignores bucket index consistency
+     --benchmark                       when specified with bucket list, time the ordered listing
+                                       and report index shard ops per page instead of the entries
      --min-rewrite-size                min object size for bucket rewrite (default 4M)
      --max-rewrite-size                max object size for bucket rewrite (default ULLONG_MAX)
      --min-rewrite-stripe-size         min stripe size for object rewrite (default 0)
      --trim-delay-ms                   time interval in msec to limit the frequency of sync error log entries trimming operations,
                                        the trimming process will sleep the specified msec for every 1000 entries trimmed
-     --max-concurrent-ios              maximum concurrent ios for bucket operations (default: 32)
+     --max-concurrent-ios              maximum concurrent ios for bucket operations, bucket
+                                       stats and user stats --sync-stats (default: 32)
      --enable-feature                  enable a zone/zonegroup feature
      --disable-feature                 disable a zone/zonegroup feature
   
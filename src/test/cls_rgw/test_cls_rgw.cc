@@ -442,6 +442,65 @@ TEST_F(cls_rgw, index_suggest_complete)
  * return all validate utf8 objnames and filter out those
  * in BI_PREFIX_CHAR private namespace.
  */
+TEST_F(cls_rgw, index_complete_batch)
+{
+  string bucket_oid = "bucket_complete_batch";
+
+  ObjectWriteOperation op;
+  cls_rgw_bucket_init_index(op);
+  ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+
+  uint64_t obj_size = 1024;
+  uint64_t total_size = 0;
+  std::vector<rgw_cls_obj_complete_op> ops;
+
+  for (int i = 0; i < NUM_OBJS; i++) {
+    cls_rgw_obj_key obj = str_int("obj", i);
+    string tag = str_int("tag", i);
+    string loc = str_int("loc", i);
+
+    index_prepare(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, obj, loc);
+
+    auto& call = ops.emplace_back();
+    call.op = CLS_RGW_OP_ADD;
+    call.tag = tag;
+    call.key = obj;
+    call.locator = loc;
+    call.ver.pool = ioctx.get_id();
+    call.ver.epoch = i + 1;
+    call.meta.category = RGWObjCategory::None;
+    call.meta.size = call.meta.accounted_size = i * obj_size;
+    total_size += i * obj_size;
+  }
+
+  /* two ops on the same key are refused */
+  {
+    auto dup = ops;
+    dup.push_back(ops.front());
+    ObjectWriteOperation op;
+    cls_rgw_bucket_complete_op_batch(op, dup);
+    ASSERT_EQ(-EINVAL, ioctx.operate(bucket_oid, &op));
+  }
+  test_stats(ioctx, bucket_oid, RGWObjCategory::None, 0, 0);
+
+  /* complete all of them at once */
+  {
+    ObjectWriteOperation op;
+    cls_rgw_bucket_complete_op_batch(op, ops);
+    ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+  }
+  test_stats(ioctx, bucket_oid, RGWObjCategory::None, NUM_OBJS, total_size);
+
+  /* the entries no longer have pending ops */
+  rgw_cls_list_ret listing;
+  list_entries(ioctx, bucket_oid, 1000, listing);
+  ASSERT_EQ(NUM_OBJS, (int)listing.dir.m.size());
+  for (const auto& [name, entry] : listing.dir.m) {
+    ASSERT_TRUE(entry.exists);
+    ASSERT_TRUE(entry.pending_map.empty());
+  }
+}
+
 TEST_F(cls_rgw, index_list)
 {
   string bucket_oid = str_int("bucket", 4);
@@ -505,7 +564,8 @@ TEST_F(cls_rgw, index_list)
 
 /*
  * This case is used to test when bucket index list that includes a
- * delimiter can handle the first chunk ending in a delimiter.
+ * delimiter can handle chunks ending in a delimiter, and seeks past
+ * large "subdirectories" rather than reading through them.
  */
 TEST_F(cls_rgw, index_list_delimited)
 {
@@ -563,18 +623,18 @@ TEST_F(cls_rgw, index_list_delimited)
   list_entries(ioctx, bucket_oid, 1000, listing, start_key, delimiter);
   auto id_entry_map = listing.dir.m;
 
-  // the cls code will make 4 tries to get 1000 entries; however
-  // because each of the subdirectories is so large, each attempt will
-  // only retrieve the first part of the subdirectory
+  // each of the subdirectories is larger than a single read, but the
+  // cls code seeks past each one once its first entry is seen, so a
+  // single call returns everything
 
-  ASSERT_EQ(48u, id_entry_map.size()) <<
-    "We should get 40 top-level entries and the tops of 8 \"subdirectories\".";
-  ASSERT_EQ(true, listing.is_truncated) << "We did not get all entries.";
+  ASSERT_EQ(65u, id_entry_map.size()) <<
+    "We should get 55 top-level entries and the tops of 10 \"subdirectories\".";
+  ASSERT_EQ(false, listing.is_truncated) << "We should have all entries.";
 
   ASSERT_EQ("a-0", id_entry_map.cbegin()->first);
-  ASSERT_EQ("p/", id_entry_map.crbegin()->first);
+  ASSERT_EQ("u-4", id_entry_map.crbegin()->first);
 
-  // now let's get the rest of the entries
+  // listing after a subdirectory marker returns the rest of the entries
 
   listing = {};
   cls_rgw_obj_key start_key2("p/", "");
@@ -1438,6 +1498,66 @@ TEST_F(cls_rgw, reshardlog_num)
   reshardlog_entries(ioctx, bucket_oid, 2u);
 }
 
+TEST_F(cls_rgw, reshardlog_trim_entries)
+{
+  string bucket_oid = str_int("reshard3", 0);
+
+  ObjectWriteOperation op;
+  cls_rgw_bucket_init_index(op);
+  ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+
+  set_reshard_status(ioctx, bucket_oid, cls_rgw_reshard_status::IN_LOGRECORD);
+
+  cls_rgw_obj_key obj1 = str_int("obj1", 0);
+  cls_rgw_obj_key obj2 = str_int("obj2", 0);
+  string tag = str_int("tag-prepare", 0);
+  string loc = str_int("loc", 0);
+  rgw_bucket_dir_entry_meta meta;
+  index_prepare(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, obj1, loc);
+  index_complete(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, 1, obj1, meta);
+  index_prepare(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, obj2, loc);
+  index_complete(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, 1, obj2, meta);
+  reshardlog_entries(ioctx, bucket_oid, 2u);
+
+  bool is_truncated = false;
+  std::list<rgw_cls_bi_entry> entries;
+  ASSERT_EQ(0, reshardlog_list(ioctx, bucket_oid, &entries, &is_truncated));
+  ASSERT_EQ(2u, entries.size());
+
+  // overwrite the log entry of obj2 after it was listed
+  index_prepare(ioctx, bucket_oid, CLS_RGW_OP_DEL, tag, obj2, loc);
+  index_complete(ioctx, bucket_oid, CLS_RGW_OP_DEL, tag, 2, obj2, meta);
+  reshardlog_entries(ioctx, bucket_oid, 3u);
+
+  // only the entry of obj1 is unchanged and gets trimmed
+  {
+    ObjectWriteOperation trim;
+    cls_rgw_bucket_reshard_log_trim_entries(
+        trim, {entries.begin(), entries.end()});
+    ASSERT_EQ(0, ioctx.operate(bucket_oid, &trim));
+  }
+  reshardlog_entries(ioctx, bucket_oid, 2u);
+
+  std::list<rgw_cls_bi_entry> remaining;
+  ASSERT_EQ(0, reshardlog_list(ioctx, bucket_oid, &remaining, &is_truncated));
+  ASSERT_EQ(1u, remaining.size());
+  ASSERT_EQ(entries.back().idx, remaining.front().idx);
+  ASSERT_EQ(BIIndexType::ReshardDeleted, remaining.front().type);
+
+  // trimming the current entry empties the log and resets the count
+  {
+    ObjectWriteOperation trim;
+    cls_rgw_bucket_reshard_log_trim_entries(
+        trim, {remaining.begin(), remaining.end()});
+    ASSERT_EQ(0, ioctx.operate(bucket_oid, &trim));
+  }
+  reshardlog_entries(ioctx, bucket_oid, 0u);
+
+  remaining.clear();
+  ASSERT_EQ(0, reshardlog_list(ioctx, bucket_oid, &remaining, &is_truncated));
+  ASSERT_EQ(0u, remaining.size());
+}
+
 TEST_F(cls_rgw, bi_put_entries)
 {
   const string src_bucket = str_int("bi_put_entries", 0);
@@ -0,0 +1,94 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include "common/StridedReadahead.h"
+#include "gtest/gtest.h"
+
+using extents = std::vector<StridedReadahead::extent_t>;
+
+TEST(StridedReadahead, forward) {
+  StridedReadahead r;
+  ASSERT_EQ(extents{}, r.update(0, 10, 10000));
+  ASSERT_EQ(extents{}, r.update(100, 10, 10000));
+  ASSERT_EQ((extents{{300, 10}, {400, 10}}), r.update(200, 10, 10000));
+  // one of two prefetched strides was read: refill to twice as deep
+  ASSERT_EQ((extents{{500, 10}, {600, 10}, {700, 10}}),
+            r.update(300, 10, 10000));
+  ASSERT_EQ((extents{{800, 10}, {900, 10}, {1000, 10}, {1100, 10}, {1200, 10}}),
+            r.update(400, 10, 10000));
+  ASSERT_EQ(2u, r.get_hits());
+  ASSERT_EQ(0u, r.get_wasted_bytes());
+}
+
+TEST(StridedReadahead, reverse) {
+  StridedReadahead r;
+  ASSERT_EQ(extents{}, r.update(1000, 10, 10000));
+  ASSERT_EQ(extents{}, r.update(900, 10, 10000));
+  ASSERT_EQ((extents{{700, 10}, {600, 10}}), r.update(800, 10, 10000));
+}
+
+TEST(StridedReadahead, sequential_and_random) {
+  StridedReadahead r;
+  // sequential reads are Readahead's
+  ASSERT_EQ(extents{}, r.update(0, 10, 10000));
+  ASSERT_EQ(extents{}, r.update(10, 10, 10000));
+  ASSERT_EQ(extents{}, r.update(20, 10, 10000));
+  // as are reads of different sizes
+  ASSERT_EQ(extents{}, r.update(100, 20, 10000));
+  ASSERT_EQ(extents{}, r.update(200, 30, 10000));
+  ASSERT_EQ(extents{}, r.update(300, 40, 10000));
+}
+
+TEST(StridedReadahead, interleaved) {
+  StridedReadahead r;
+  ASSERT_EQ(extents{}, r.update(0, 10, 100000));
+  ASSERT_EQ(extents{}, r.update(50000, 10, 100000));
+  ASSERT_EQ(extents{}, r.update(100, 10, 100000));
+  ASSERT_EQ(extents{}, r.update(50200, 10, 100000));
+  ASSERT_EQ((extents{{300, 10}, {400, 10}}), r.update(200, 10, 100000));
+  ASSERT_EQ((extents{{50600, 10}, {50800, 10}}), r.update(50400, 10, 100000));
+  ASSERT_EQ((extents{{500, 10}, {600, 10}, {700, 10}}),
+            r.update(300, 10, 100000));
+  ASSERT_EQ((extents{{51000, 10}, {51200, 10}, {51400, 10}}),
+            r.update(50600, 10, 100000));
+  ASSERT_EQ(2u, r.get_hits());
+}
+
+TEST(StridedReadahead, limit) {
+  StridedReadahead r;
+  ASSERT_EQ(extents{}, r.update(0, 10, 305));
+  ASSERT_EQ(extents{}, r.update(100, 10, 305));
+  ASSERT_EQ((extents{{300, 5}}), r.update(200, 10, 305));
+  ASSERT_EQ(extents{}, r.update(300, 10, 305));
+}
+
+TEST(StridedReadahead, max_size) {
+  StridedReadahead r;
+  r.set_max_readahead_size(10);
+  ASSERT_EQ(extents{}, r.update(0, 10, 10000));
+  ASSERT_EQ(extents{}, r.update(100, 10, 10000));
+  ASSERT_EQ((extents{{300, 10}}), r.update(200, 10, 10000));
+  ASSERT_EQ((extents{{400, 10}}), r.update(300, 10, 10000));
+}
+
+TEST(StridedReadahead, wasted) {
+  StridedReadahead r;
+  r.set_max_streams(1);
+  ASSERT_EQ(extents{}, r.update(0, 10, 10000));
+  ASSERT_EQ(extents{}, r.update(100, 10, 10000));
+  ASSERT_EQ((extents{{300, 10}, {400, 10}}), r.update(200, 10, 10000));
+  // a new stream replaces the only one, whose prefetches were never read
+  ASSERT_EQ(extents{}, r.update(5000, 10, 10000));
+  ASSERT_EQ(extents{}, r.update(5003, 10, 10000));
+  ASSERT_EQ((extents{{5009, 10}}), r.update(5006, 10, 10000));
+  ASSERT_EQ(20u, r.get_wasted_bytes());
+  ASSERT_EQ(0u, r.get_hits());
+}
+
+TEST(StridedReadahead, disabled) {
+  StridedReadahead r;
+  r.set_max_streams(0);
+  ASSERT_EQ(extents{}, r.update(0, 10, 10000));
+  ASSERT_EQ(extents{}, r.update(100, 10, 10000));
+  ASSERT_EQ(extents{}, r.update(200, 10, 10000));
+}
@@ -0,0 +1,93 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "common/ceph_mutex.h"
+#ifndef CEPH_DEBUG_MUTEX
+#include "common/mutex_contention.h"
+#endif
+
+TEST(AdaptiveMutex, exclusion)
+{
+  auto mutex = ceph::make_adaptive_mutex("adaptive::exclusion");
+  uint64_t n = 0;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 100000; j++) {
+        std::lock_guard l{mutex};
+        ++n;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(400000u, n);
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(AdaptiveMutex, condition_variable)
+{
+  auto mutex = ceph::make_adaptive_mutex("adaptive::cond");
+  ceph::adaptive_condition_variable cond;
+  bool ready = false;
+  std::thread waiter([&] {
+    std::unique_lock l{mutex};
+    cond.wait(l, [&] { return ready; });
+  });
+  {
+    std::lock_guard l{mutex};
+    ready = true;
+  }
+  cond.notify_all();
+  waiter.join();
+}
+
+#ifndef CEPH_DEBUG_MUTEX
+TEST(AdaptiveMutex, contention_profile)
+{
+  auto mutex = ceph::make_adaptive_mutex("adaptive::profile");
+  auto stats = ceph::mutex_contention::get("adaptive::profile");
+  stats->reset();
+
+  // not profiled
+  {
+    std::lock_guard l{mutex};
+  }
+  ASSERT_EQ(0u, stats->locks);
+
+  ceph::adaptive_mutex::set_profiling(true);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 10000; j++) {
+        std::lock_guard l{mutex};
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ceph::adaptive_mutex::set_profiling(false);
+
+  ASSERT_EQ(40000u, stats->locks);
+  ASSERT_LE(stats->contended, stats->locks);
+  uint64_t held = 0, waited = 0;
+  for (unsigned i = 0; i < ceph::mutex_contention_stats::NUM_BUCKETS; i++) {
+    held += stats->hold_ns[i];
+    waited += stats->wait_ns[i];
+  }
+  ASSERT_EQ(40000u, held);
+  ASSERT_EQ(stats->contended, waited);
+
+  ASSERT_EQ(0u, ceph::mutex_contention_stats::bucket(0));
+  ASSERT_EQ(1u, ceph::mutex_contention_stats::bucket(1));
+  ASSERT_EQ(11u, ceph::mutex_contention_stats::bucket(1024));
+  ASSERT_EQ(ceph::mutex_contention_stats::NUM_BUCKETS - 1,
+            ceph::mutex_contention_stats::bucket(UINT64_MAX));
+}
+#endif
@@ -0,0 +1,262 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <thread>
+#include <vector>
+
+#include "common/Finisher.h"
+#include "global/global_context.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+struct C_Record : public Context {
+  std::vector<int> *out;
+  int v;
+  C_Record(std::vector<int> *out, int v) : out(out), v(v) {}
+  void finish(int r) override {
+    out->push_back(v + r);
+  }
+};
+
+struct C_Count : public Context {
+  std::atomic<uint64_t> *n;
+  explicit C_Count(std::atomic<uint64_t> *n) : n(n) {}
+  void finish(int) override {
+    ++*n;
+  }
+};
+
+/// the mutex and vector queue Finisher used before it went lock-free,
+/// kept here to benchmark against
+class LockedFinisher {
+  ceph::mutex lock = ceph::make_mutex("LockedFinisher::lock");
+  ceph::condition_variable cond;
+  ceph::condition_variable empty_cond;
+  bool stopping = false;
+  bool running = false;
+  std::vector<std::pair<Context*,int>> q, in_progress;
+  std::thread t;
+
+  void entry() {
+    std::unique_lock l(lock);
+    while (!stopping) {
+      while (!q.empty()) {
+	in_progress.swap(q);
+	running = true;
+	l.unlock();
+	for (auto p : in_progress) {
+	  p.first->complete(p.second);
+	}
+	in_progress.clear();
+	l.lock();
+	running = false;
+      }
+      empty_cond.notify_all();
+      if (stopping)
+	break;
+      cond.wait(l);
+    }
+  }
+public:
+  void start() {
+    t = std::thread([this] { entry(); });
+  }
+  void stop() {
+    {
+      std::lock_guard l(lock);
+      stopping = true;
+      cond.notify_one();
+    }
+    t.join();
+  }
+  void queue(Context *c, int r = 0) {
+    std::lock_guard l(lock);
+    const bool should_notify = q.empty() && !running;
+    q.emplace_back(c, r);
+    if (should_notify) {
+      cond.notify_one();
+    }
+  }
+  void wait_for_empty() {
+    std::unique_lock l(lock);
+    empty_cond.wait(l, [this] { return q.empty() && !running; });
+  }
+};
+
+template <typename F>
+double bench(F& f, unsigned producers, unsigned per_producer,
+	     std::atomic<uint64_t>& done)
+{
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < producers; ++i) {
+    threads.emplace_back([&] {
+      for (unsigned j = 0; j < per_producer; ++j) {
+	f.queue(new C_Count(&done));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  f.wait_for_empty();
+  std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+  return d.count();
+}
+
+} // anonymous namespace
+
+TEST(Finisher, Order)
+{
+  Finisher f(g_ceph_context);
+  std::vector<int> out;
+  f.start();
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 10 == 0) {
+      std::list<Context*> ls;
+      ls.push_back(new C_Record(&out, i * 10));
+      ls.push_back(new C_Record(&out, i * 10 + 1));
+      f.queue(ls);
+      ASSERT_TRUE(ls.empty());
+    } else {
+      f.queue(new C_Record(&out, i * 10), 5);
+    }
+  }
+  f.wait_for_empty();
+  ASSERT_TRUE(f.is_empty());
+  ASSERT_EQ(1100u, out.size());
+  size_t n = 0;
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 10 == 0) {
+      ASSERT_EQ(i * 10, out[n++]);
+      ASSERT_EQ(i * 10 + 1, out[n++]);
+    } else {
+      ASSERT_EQ(i * 10 + 5, out[n++]);
+    }
+  }
+  f.stop();
+}
+
+TEST(Finisher, ManyProducers)
+{
+  Finisher f(g_ceph_context);
+  std::atomic<uint64_t> done = 0;
+  f.start();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 10000; ++j) {
+	f.queue(new C_Count(&done));
+	if (j % 1000 == 0) {
+	  // let the finisher go to sleep now and then
+	  f.wait_for_empty();
+	}
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  f.wait_for_empty();
+  ASSERT_EQ(80000u, done);
+  f.stop();
+}
+
+TEST(Finisher, Benchmark)
+{
+  constexpr unsigned per_producer = 200000;
+  for (unsigned producers : {1u, 4u, 16u}) {
+    std::atomic<uint64_t> done = 0;
+    LockedFinisher locked;
+    locked.start();
+    double locked_t = bench(locked, producers, per_producer, done);
+    locked.stop();
+    ASSERT_EQ(producers * per_producer, done);
+
+    done = 0;
+    Finisher f(g_ceph_context);
+    f.start();
+    double t = bench(f, producers, per_producer, done);
+    f.stop();
+    ASSERT_EQ(producers * per_producer, done);
+
+    std::cout << producers << " producers: "
+	      << (producers * per_producer / locked_t / 1000000) << " Mops/s locked, "
+	      << (producers * per_producer / t / 1000000) << " Mops/s lock-free"
+	      << std::endl;
+  }
+}
+
+TEST(ContextQueue, Basic)
+{
+  ceph::mutex lock = ceph::make_mutex("ContextQueue::Basic");
+  ceph::condition_variable cond;
+  ContextQueue q(lock, cond);
+  std::vector<int> out;
+  ASSERT_TRUE(q.empty());
+
+  std::list<Context*> ls;
+  q.queue(ls);
+  ASSERT_TRUE(q.empty());
+  for (int b = 0; b < 3; ++b) {
+    for (int i = 0; i < 3; ++i) {
+      ls.push_back(new C_Record(&out, b * 3 + i));
+    }
+    q.queue(ls);
+    ASSERT_TRUE(ls.empty());
+    ASSERT_FALSE(q.empty());
+  }
+
+  q.move_to(ls);
+  ASSERT_TRUE(q.empty());
+  ASSERT_EQ(9u, ls.size());
+  for (auto c : ls) {
+    c->complete(0);
+  }
+  for (int i = 0; i < 9; ++i) {
+    ASSERT_EQ(i, out[i]);
+  }
+}
+
+TEST(ContextQueue, Wakeup)
+{
+  ceph::mutex lock = ceph::make_mutex("ContextQueue::Wakeup");
+  ceph::condition_variable cond;
+  ContextQueue q(lock, cond);
+  std::atomic<uint64_t> done = 0;
+  constexpr uint64_t total = 4 * 10000;
+
+  std::thread consumer([&] {
+    std::list<Context*> ls;
+    while (done < total) {
+      {
+	std::unique_lock l(lock);
+	cond.wait_for(l, std::chrono::milliseconds(100),
+		      [&] { return !q.empty(); });
+      }
+      q.move_to(ls);
+      for (auto c : ls) {
+	c->complete(0);
+      }
+    }
+  });
+  std::vector<std::thread> producers;
+  for (int i = 0; i < 4; ++i) {
+    producers.emplace_back([&] {
+      for (int j = 0; j < 10000; ++j) {
+	std::list<Context*> ls{new C_Count(&done)};
+	q.queue(ls);
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  consumer.join();
+  ASSERT_EQ(total, done);
+}
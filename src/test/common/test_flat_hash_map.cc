@@ -0,0 +1,180 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "include/btree_map.h"
+#include "include/flat_hash_map.h"
+#include "include/mempool.h"
+#include "gtest/gtest.h"
+
+TEST(FlatHashMap, basic)
+{
+  ceph::flat_hash_map<uint64_t, std::string> m;
+  ASSERT_TRUE(m.empty());
+  ASSERT_EQ(m.end(), m.find(1));
+  ASSERT_EQ(0u, m.erase(1));
+  ASSERT_EQ(m.begin(), m.end());
+
+  m[1] = "one";
+  ASSERT_TRUE(m.insert({2, "two"}).second);
+  ASSERT_FALSE(m.insert({2, "deux"}).second);
+  ASSERT_TRUE(m.try_emplace(3, "three").second);
+  ASSERT_FALSE(m.emplace(3, "trois").second);
+  ASSERT_EQ(3u, m.size());
+  ASSERT_EQ("two", m.at(2));
+  ASSERT_EQ("three", m[3]);
+  ASSERT_TRUE(m.contains(1));
+  ASSERT_EQ(1u, m.count(1));
+  ASSERT_THROW(m.at(4), std::out_of_range);
+
+  auto copy = m;
+  ASSERT_TRUE(copy == m);
+  ASSERT_EQ(1u, m.erase(2));
+  ASSERT_FALSE(copy == m);
+  ASSERT_EQ(m.end(), m.find(2));
+  ASSERT_EQ(3u, copy.size());
+
+  auto moved = std::move(copy);
+  ASSERT_TRUE(copy.empty());
+  ASSERT_EQ(3u, moved.size());
+  moved.clear();
+  ASSERT_TRUE(moved.empty());
+  ASSERT_EQ(moved.begin(), moved.end());
+}
+
+TEST(FlatHashMap, random_ops)
+{
+  ceph::flat_hash_map<uint64_t, uint64_t> m;
+  std::unordered_map<uint64_t, uint64_t> ref;
+  std::mt19937_64 rng(42);
+  for (int i = 0; i < 200000; ++i) {
+    // keys with shared low bits, to exercise collisions
+    uint64_t k = (rng() % 5000) << 12;
+    switch (rng() % 3) {
+    case 0:
+      m[k] = i;
+      ref[k] = i;
+      break;
+    case 1:
+      ASSERT_EQ(ref.erase(k), m.erase(k));
+      break;
+    case 2:
+      {
+        auto p = m.find(k);
+        auto q = ref.find(k);
+        ASSERT_EQ(q == ref.end(), p == m.end());
+        if (p != m.end()) {
+          ASSERT_EQ(q->second, p->second);
+        }
+      }
+      break;
+    }
+    ASSERT_EQ(ref.size(), m.size());
+  }
+  size_t n = 0;
+  for (auto& [k, v] : m) {
+    ASSERT_EQ(ref[k], v);
+    ++n;
+  }
+  ASSERT_EQ(ref.size(), n);
+}
+
+TEST(FlatHashMap, erase_while_iterating)
+{
+  ceph::flat_hash_map<uint64_t, uint64_t> m;
+  for (uint64_t i = 0; i < 10000; ++i) {
+    m[i * 7] = i;
+  }
+  size_t visited = 0;
+  for (auto p = m.begin(); p != m.end();) {
+    ++visited;
+    if (p->second % 2) {
+      p = m.erase(p);
+    } else {
+      ++p;
+    }
+  }
+  ASSERT_EQ(10000u, visited);
+  ASSERT_EQ(5000u, m.size());
+  for (auto& [k, v] : m) {
+    ASSERT_EQ(0u, v % 2);
+    ASSERT_EQ(k, v * 7);
+  }
+}
+
+TEST(FlatHashMap, mempool)
+{
+  size_t before = mempool::osd::allocated_bytes();
+  {
+    mempool::osd::flat_hash_map<uint64_t, uint64_t> m;
+    for (uint64_t i = 0; i < 1000; ++i) {
+      m[i] = i;
+    }
+    ASSERT_LT(before, mempool::osd::allocated_bytes());
+  }
+  ASSERT_EQ(before, mempool::osd::allocated_bytes());
+
+  {
+    mempool::osd::btree_map<uint64_t, uint64_t> m;
+    for (uint64_t i = 0; i < 1000; ++i) {
+      m[i] = i;
+    }
+    ASSERT_LT(before, mempool::osd::allocated_bytes());
+  }
+  ASSERT_EQ(before, mempool::osd::allocated_bytes());
+}
+
+namespace {
+
+template <typename M>
+void bench(const char *name, const std::vector<uint64_t>& keys)
+{
+  size_t before = mempool::osd::allocated_bytes();
+  M m;
+  auto start = std::chrono::steady_clock::now();
+  for (auto k : keys) {
+    m[k] = k;
+  }
+  auto inserted = std::chrono::steady_clock::now();
+  uint64_t sum = 0;
+  for (int round = 0; round < 4; ++round) {
+    for (auto k : keys) {
+      sum += m.find(k)->second;
+    }
+  }
+  auto looked_up = std::chrono::steady_clock::now();
+  size_t bytes = mempool::osd::allocated_bytes() - before;
+  std::chrono::duration<double, std::nano> ins = inserted - start;
+  std::chrono::duration<double, std::nano> lookup = looked_up - inserted;
+  std::cout << name << ": " << (double)bytes / keys.size() << " bytes/entry, "
+            << ins.count() / keys.size() << " ns/insert, "
+            << lookup.count() / keys.size() / 4 << " ns/lookup"
+            << " (" << sum << ")" << std::endl;
+}
+
+} // anonymous namespace
+
+TEST(FlatHashMap, benchmark)
+{
+  std::mt19937_64 rng(1);
+  for (size_t n : {1000u, 100000u, 1000000u}) {
+    std::vector<uint64_t> keys(n);
+    for (auto& k : keys) {
+      k = rng();
+    }
+    std::cout << n << " entries" << std::endl;
+    bench<mempool::osd::unordered_map<uint64_t, uint64_t>>(
+      "  unordered_map", keys);
+    bench<mempool::osd::flat_hash_map<uint64_t, uint64_t>>(
+      "  flat_hash_map", keys);
+    bench<mempool::osd::map<uint64_t, uint64_t>>("  map", keys);
+    bench<mempool::osd::btree_map<uint64_t, uint64_t>>("  btree_map", keys);
+  }
+}
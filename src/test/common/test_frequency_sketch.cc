@@ -0,0 +1,48 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include <string>
+
+#include "common/FrequencySketch.h"
+#include "gtest/gtest.h"
+
+TEST(FrequencySketch, uninitialized)
+{
+  ceph::FrequencySketch sketch;
+  sketch.increment("a");
+  ASSERT_EQ(0u, sketch.estimate("a"));
+}
+
+TEST(FrequencySketch, estimate)
+{
+  ceph::FrequencySketch sketch(1024);
+  ASSERT_EQ(0u, sketch.estimate("a"));
+  for (int i = 0; i < 3; i++) {
+    sketch.increment("a");
+  }
+  sketch.increment("b");
+  // count-min estimates never undercount
+  ASSERT_LE(3u, sketch.estimate("a"));
+  ASSERT_LE(1u, sketch.estimate("b"));
+  ASSERT_LT(sketch.estimate("b"), sketch.estimate("a"));
+
+  // counters saturate at 15
+  for (int i = 0; i < 100; i++) {
+    sketch.increment("c");
+  }
+  ASSERT_EQ(15u, sketch.estimate("c"));
+}
+
+TEST(FrequencySketch, aging)
+{
+  ceph::FrequencySketch sketch(1024);
+  for (int i = 0; i < 20; i++) {
+    sketch.increment("old");
+  }
+  ASSERT_EQ(15u, sketch.estimate("old"));
+  // 10 additions per counter of a row halve all the counters
+  for (int i = 0; i < 10 * 1024; i++) {
+    sketch.increment(std::to_string(i));
+  }
+  ASSERT_GT(15u, sketch.estimate("old"));
+}
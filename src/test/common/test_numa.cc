@@ -1,6 +1,8 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
 // vim: ts=8 sw=2 sts=2 expandtab
 
+#include <cerrno>
+
 #include "gtest/gtest.h"
 #include "common/numa.h"
 
@@ -70,3 +72,18 @@ TEST(cpu_set, round_trip_list)
   }
 }
 
+
+#if defined(__linux__)
+TEST(numa, node_count)
+{
+  int r = get_numa_node_count();
+  if (r == -ENOENT) {
+    GTEST_SKIP() << "no numa topology exposed in sysfs";
+  }
+  ASSERT_GT(r, 0);
+  // every reported node up to the count has a (possibly empty) cpu list
+  size_t size;
+  cpu_set_t cpu_set;
+  ASSERT_EQ(0, get_numa_node_cpu_set(0, &size, &cpu_set));
+}
+#endif
@@ -1558,3 +1558,45 @@ TEST_F(CRUSHTest, msr_multi_root) {
     }
   }
 }
+
+TEST_F(CRUSHTest, straw2_simd_matches_scalar) {
+  // the vectorized straw2 hash must pick exactly the same items as
+  // the scalar one, including for bucket sizes that leave a scalar tail
+  // and for zero weight items
+  for (int n : {16, 37, 203}) {
+    std::unique_ptr<CrushWrapper> c(new CrushWrapper);
+    const int ROOT_TYPE = 1;
+    c->set_type_name(ROOT_TYPE, "root");
+    const int OSD_TYPE = 0;
+    c->set_type_name(OSD_TYPE, "osd");
+
+    vector<int> items(n), weights(n);
+    for (int i = 0; i < n; ++i) {
+      items[i] = i;
+      weights[i] = (i % 7 == 3) ? 0 : 0x10000 + (i * 0x1357) % 0x30000;
+    }
+    c->set_max_devices(n);
+
+    int root;
+    crush_bucket *b = crush_make_bucket(c->get_crush_map(),
+					CRUSH_BUCKET_STRAW2, CRUSH_HASH_RJENKINS1,
+					ROOT_TYPE, n, &items[0], &weights[0]);
+    EXPECT_EQ(0, crush_add_bucket(c->get_crush_map(), 0, b, &root));
+    EXPECT_EQ(0, c->set_item_name(root, "root"));
+    int rule = c->add_simple_rule("rule", "root", "osd", "",
+				  "firstn", pg_pool_t::TYPE_REPLICATED);
+    EXPECT_EQ(0, rule);
+    c->finalize();
+
+    vector<unsigned> reweight(n, 0x10000);
+    for (int x = 0; x < 10000; ++x) {
+      vector<int> scalar, simd;
+      crush_set_straw2_simd(0);
+      c->do_rule(rule, x, scalar, 3, reweight, 0);
+      crush_set_straw2_simd(1);
+      c->do_rule(rule, x, simd, 3, reweight, 0);
+      ASSERT_EQ(scalar, simd) << "n " << n << " x " << x;
+    }
+  }
+  crush_set_straw2_simd(1);
+}
@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+#
+# Print encode/decode throughput of the generated test instances of some
+# commonly used types, e.g.
+#
+#   bench.sh                      # default types, 100000 iterations
+#   bench.sh 10000 pg_info_t OSDMap
+#
+set -e
+
+iterations=${1:-100000}
+shift || true
+types=${@:-"pg_log_entry_t pg_info_t pg_stat_t object_info_t SnapSet
+  SnapContext bluestore_onode_t bluestore_blob_t bluestore_extent_ref_map_t
+  bluestore_pextent_t osd_reqid_t eversion_t utime_t"}
+
+for type in $types; do
+    num=$(ceph-dencoder type $type count_tests)
+    for n in $(seq 1 1 $num 2>/dev/null); do
+        echo -n "$type $n: "
+        ceph-dencoder type $type select_test $n bench $iterations
+    done
+done
@@ -297,6 +297,51 @@ TEST_P(PluginTest,ZeroInZeroOut)
       " but test indicates support is possible for this configuration";
   }
 }
+TEST_P(PluginTest,EncodeChunksBatch)
+{
+  // Test that encode_chunks_batch produces the same parity as one
+  // encode_chunks call per range, including ranges of different sizes and
+  // ranges with an absent (implicitly zero) data shard.
+  initialize();
+  if (!(erasure_code->get_supported_optimizations() &
+      ErasureCodeInterface::FLAG_EC_PLUGIN_OPTIMIZED_SUPPORTED)) {
+    GTEST_SKIP() << "Plugin does not support optimized EC";
+  }
+  const unsigned ranges = 3;
+  vector<shard_id_map<bufferptr>> in(ranges,
+    shard_id_map<bufferptr>(get_k_plus_m()));
+  vector<shard_id_map<bufferptr>> out(ranges,
+    shard_id_map<bufferptr>(get_k_plus_m()));
+  vector<shard_id_map<bufferptr>> expected(ranges,
+    shard_id_map<bufferptr>(get_k_plus_m()));
+  for (unsigned r = 0; r < ranges; ++r) {
+    unsigned len = chunk_size * (r + 1);
+    for (shard_id_t i; i < get_k_plus_m(); ++i) {
+      if (i < get_k()) {
+        if (r == 1 && i == shard_id_t(0)) {
+          continue;
+        }
+        bufferlist bl;
+        for (unsigned c = 0; c <= r; ++c) {
+          generate_chunk(bl);
+        }
+        bl.rebuild_aligned(4096);
+        in[r][i] = bl.front();
+      } else {
+        out[r][i] = buffer::create_aligned(len, 4096);
+        expected[r][i] = buffer::create_aligned(len, 4096);
+      }
+    }
+    EXPECT_EQ(0, erasure_code->encode_chunks(in[r], expected[r]));
+  }
+  EXPECT_EQ(0, erasure_code->encode_chunks_batch(in, out));
+  for (unsigned r = 0; r < ranges; ++r) {
+    for (auto &&[shard, ptr] : out[r]) {
+      EXPECT_EQ(0, memcmp(ptr.c_str(), expected[r].at(shard).c_str(),
+                          ptr.length())) << "range " << r << " shard " << shard;
+    }
+  }
+}
 TEST_P(PluginTest,ParityDelta_SingleDeltaSingleParity)
 {
   // Test erasure code plugin can perform parity delta writes
@@ -59,7 +59,8 @@ int ErasureCodeBench::setup(int argc, char** argv) {
     ("plugin,p", po::value<string>()->default_value("isa"),
      "erasure code plugin name")
     ("workload,w", po::value<string>()->default_value("encode"),
-     "run either encode or decode")
+     "run either encode, decode or delta (update one data chunk of a stripe "
+     "with encode_delta and apply_delta)")
     ("erasures,e", po::value<int>()->default_value(1),
      "number of erasures when decoding")
     ("erased", po::value<vector<int> >(),
@@ -71,6 +72,9 @@ int ErasureCodeBench::setup(int argc, char** argv) {
      " the first chunk, then the second etc.)")
     ("parameter,P", po::value<vector<string> >(),
      "add a parameter to the erasure code profile")
+    ("batch,b", po::value<int>()->default_value(0),
+     "when encoding, split the buffer into this many stripes and encode "
+     "them all with a single encode_chunks_batch call")
     ;
 
   po::variables_map vm;
@@ -123,6 +127,7 @@ int ErasureCodeBench::setup(int argc, char** argv) {
   plugin = vm["plugin"].as<string>();
   workload = vm["workload"].as<string>();
   erasures = vm["erasures"].as<int>();
+  batch = vm["batch"].as<int>();
   if (vm.count("erasures-generation") > 0 &&
       vm["erasures-generation"].as<string>() == "exhaustive")
     exhaustive_erasures = true;
@@ -158,6 +163,8 @@ int ErasureCodeBench::run() {
 
   if (workload == "encode")
     return encode();
+  else if (workload == "delta")
+    return delta();
   else
     return decode();
 }
@@ -175,6 +182,9 @@ int ErasureCodeBench::encode()
     return code;
   }
 
+  if (batch > 0)
+    return encode_batch(erasure_code);
+
   bufferlist in;
   in.append(string(in_size, 'X'));
   in.rebuild_aligned(ErasureCode::SIMD_ALIGN);
@@ -194,6 +204,83 @@ int ErasureCodeBench::encode()
   return 0;
 }
 
+int ErasureCodeBench::encode_batch(ErasureCodeInterfaceRef erasure_code)
+{
+  unsigned chunk_size = erasure_code->get_chunk_size(in_size / batch);
+  unsigned data_chunks = erasure_code->get_data_chunk_count();
+  vector<shard_id_map<bufferptr>> in(batch,
+    shard_id_map<bufferptr>(erasure_code->get_chunk_count()));
+  vector<shard_id_map<bufferptr>> out(batch,
+    shard_id_map<bufferptr>(erasure_code->get_chunk_count()));
+  for (int b = 0; b < batch; b++) {
+    for (shard_id_t i; i < k + m; ++i) {
+      bufferptr ptr = buffer::create_aligned(chunk_size, ErasureCode::SIMD_ALIGN);
+      if (i < k) {
+	memset(ptr.c_str(), 'X', chunk_size);
+	in[b].emplace(i, ptr);
+      } else {
+	out[b].emplace(i, ptr);
+      }
+    }
+  }
+  utime_t begin_time = ceph_clock_now();
+  for (int i = 0; i < max_iterations; i++) {
+    int code = erasure_code->encode_chunks_batch(in, out);
+    if (code)
+      return code;
+  }
+  utime_t end_time = ceph_clock_now();
+  uint64_t encoded_kb = (uint64_t)batch * chunk_size * data_chunks / 1024;
+  cout << (end_time - begin_time) << "\t" << (max_iterations * encoded_kb) << std::endl;
+  return 0;
+}
+
+int ErasureCodeBench::delta()
+{
+  ErasureCodePluginRegistry &instance = ErasureCodePluginRegistry::instance();
+  ErasureCodeInterfaceRef erasure_code;
+  stringstream messages;
+  int code = instance.factory(plugin,
+			      g_conf().get_val<std::string>("erasure_code_dir"),
+			      profile, &erasure_code, &messages);
+  if (code) {
+    cerr << messages.str() << std::endl;
+    return code;
+  }
+  if (!(erasure_code->get_supported_optimizations() &
+	ErasureCodeInterface::FLAG_EC_PLUGIN_PARITY_DELTA_OPTIMIZATION)) {
+    cerr << "plugin " << plugin << " does not support parity delta writes"
+	 << std::endl;
+    return -EOPNOTSUPP;
+  }
+
+  // each iteration rewrites the first data chunk of a stripe of in_size
+  // bytes and updates all the coding chunks from its delta
+  unsigned chunk_size = erasure_code->get_chunk_size(in_size);
+  bufferptr old_data = buffer::create_aligned(chunk_size, ErasureCode::SIMD_ALIGN);
+  bufferptr new_data = buffer::create_aligned(chunk_size, ErasureCode::SIMD_ALIGN);
+  bufferptr delta = buffer::create_aligned(chunk_size, ErasureCode::SIMD_ALIGN);
+  memset(old_data.c_str(), 'X', chunk_size);
+  memset(new_data.c_str(), 'Y', chunk_size);
+  shard_id_map<bufferptr> in(erasure_code->get_chunk_count());
+  shard_id_map<bufferptr> out(erasure_code->get_chunk_count());
+  in[shard_id_t(0)] = delta;
+  for (shard_id_t i(k); i < k + m; ++i) {
+    bufferptr parity = buffer::create_aligned(chunk_size, ErasureCode::SIMD_ALIGN);
+    parity.zero();
+    in[i] = parity;
+    out[i] = parity;
+  }
+  utime_t begin_time = ceph_clock_now();
+  for (int i = 0; i < max_iterations; i++) {
+    erasure_code->encode_delta(old_data, new_data, &delta);
+    erasure_code->apply_delta(in, out);
+  }
+  utime_t end_time = ceph_clock_now();
+  cout << (end_time - begin_time) << "\t" << (max_iterations * (chunk_size / 1024)) << std::endl;
+  return 0;
+}
+
 static void display_chunks(const shard_id_map<bufferlist> &chunks,
 			   unsigned int chunk_count) {
   cout << "chunks ";
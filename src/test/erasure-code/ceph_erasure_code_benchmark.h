@@ -35,6 +35,7 @@ class ErasureCodeBench {
   int in_size;
   int max_iterations;
   int erasures;
+  int batch;
   int k;
   int m;
 
@@ -58,6 +59,8 @@ public:
 		      ErasureCodeInterfaceRef erasure_code);
   int decode();
   int encode();
+  int encode_batch(ErasureCodeInterfaceRef erasure_code);
+  int delta();
 };
 
 #endif
@@ -233,3 +233,17 @@ TEST_F(TestSimplePolicy, test_evict_list_10) {
     m_promoted_lru.erase(m_promoted_lru.begin());
   }
 }
+
+TEST(TestSimplePolicyAdmission, test_admission_filter) {
+  SimplePolicy policy(g_ceph_context, 10, 128, 0.5, true);
+  for (uint64_t i = 0; i < 6; i++) {
+    ASSERT_EQ(OBJ_CACHE_NONE, policy.lookup_object(generate_file_name(i)));
+    policy.update_status(generate_file_name(i), OBJ_CACHE_PROMOTED, 1);
+  }
+  // above the water mark: not read more often than the next to evict
+  ASSERT_EQ(OBJ_CACHE_SKIP, policy.lookup_object("read_once"));
+  ASSERT_EQ(OBJ_CACHE_NONE, policy.get_status("read_once"));
+  ASSERT_EQ(OBJ_CACHE_SKIP, policy.lookup_object("read_twice"));
+  ASSERT_EQ(OBJ_CACHE_NONE, policy.lookup_object("read_twice"));
+  ASSERT_EQ(OBJ_CACHE_SKIP, policy.get_status("read_twice"));
+}
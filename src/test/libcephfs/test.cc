@@ -4525,3 +4525,86 @@ TEST(LibCephFS, ConcurrentWriteAndFsync) {
   ASSERT_EQ(0, ceph_unmount(cmount));
   ceph_shutdown(cmount);
 }
+
+TEST(LibCephFS, LlBatchOps) {
+  struct ceph_mount_info *cmount;
+  ASSERT_EQ(0, ceph_create(&cmount, NULL));
+  ASSERT_EQ(0, ceph_conf_read_file(cmount, NULL));
+  ASSERT_EQ(0, ceph_conf_parse_env(cmount, NULL));
+  ASSERT_EQ(0, ceph_mount(cmount, "/"));
+
+  char dirname[PATH_MAX];
+  sprintf(dirname, "/batch_%d", getpid());
+  ASSERT_EQ(0, ceph_mkdir(cmount, dirname, 0777));
+
+  UserPerm *perms = ceph_mount_perms(cmount);
+  struct ceph_statx stx;
+  Inode *dir;
+  ASSERT_EQ(0, ceph_ll_walk(cmount, dirname, &dir, &stx, 0, 0, perms));
+
+  const size_t count = 100;
+  std::vector<std::string> names;
+  std::vector<const char*> cnames;
+  for (size_t i = 0; i < count; i++) {
+    names.push_back(fmt::format("file_{}", i));
+  }
+  for (const auto& name : names) {
+    cnames.push_back(name.c_str());
+  }
+  // one name twice
+  cnames.push_back(cnames[0]);
+
+  std::vector<Inode*> ins(count + 1);
+  std::vector<int> results(count + 1);
+  ASSERT_EQ(0, ceph_ll_mknod_batch(cmount, dir, cnames.data(), count + 1,
+                                   S_IFREG | 0644, 0, 8, ins.data(),
+                                   results.data(), perms));
+  int failed = 0;
+  for (size_t i = 0; i < count + 1; i++) {
+    if (results[i] == 0) {
+      ASSERT_NE(nullptr, ins[i]);
+    } else {
+      ASSERT_EQ(-EEXIST, results[i]);
+      ASSERT_EQ(nullptr, ins[i]);
+      failed++;
+    }
+  }
+  ASSERT_EQ(1, failed);
+  // keep the created inodes only
+  std::vector<Inode*> created;
+  for (auto in : ins) {
+    if (in) {
+      created.push_back(in);
+    }
+  }
+  ASSERT_EQ(count, created.size());
+
+  std::vector<struct ceph_statx> stxs(count);
+  for (auto& s : stxs) {
+    s.stx_mode = 0600;
+  }
+  ASSERT_EQ(0, ceph_ll_setattr_batch(cmount, created.data(), count,
+                                     stxs.data(), CEPH_SETATTR_MODE, 8,
+                                     results.data(), perms));
+  for (size_t i = 0; i < count; i++) {
+    ASSERT_EQ(0, results[i]);
+  }
+
+  ASSERT_EQ(0, ceph_ll_getattr_batch(cmount, created.data(), count,
+                                     stxs.data(), CEPH_STATX_MODE, 0, 8,
+                                     results.data(), perms));
+  for (size_t i = 0; i < count; i++) {
+    ASSERT_EQ(0, results[i]);
+    ASSERT_EQ((mode_t)(S_IFREG | 0600), (mode_t)stxs[i].stx_mode);
+  }
+
+  for (auto in : created) {
+    ceph_ll_put(cmount, in);
+  }
+  ceph_ll_put(cmount, dir);
+  for (const auto& name : names) {
+    ASSERT_EQ(0, ceph_unlink(cmount, fmt::format("{}/{}", dirname, name).c_str()));
+  }
+  ASSERT_EQ(0, ceph_rmdir(cmount, dirname));
+  ceph_shutdown(cmount);
+}
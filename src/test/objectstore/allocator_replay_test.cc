@@ -29,6 +29,7 @@ void usage(const string &name) {
           "assess_free <alloc_unit>|"
           "try_alloc <count> <want> <alloc_unit>|"
           "replay_alloc <alloc_list_file|"
+          "compare_alloc <alloc_list_file>|"
           "export_binary <out_file>|"
           "free_histogram [<alloc_unit>] [<num_buckets>]"
        << std::endl;
@@ -41,6 +42,12 @@ void usage_replay_alloc(const string &name) {
   cerr << "Allocation request format (space separated, optional parameters are 0 if not given): want unit [max] [hint]" << std::endl;
 }
 
+void usage_compare_alloc(const string &name) {
+  cerr << "Detailed compare_alloc usage: " << name << " <allocator_dump_JSON> compare_alloc <alloc_list_file>" << std::endl;
+  cerr << "Loads the free extents of the dump into each allocator type, replays the allocation requests of \"alloc_list_file\" "
+          "(same format as for replay_alloc) and prints the results as JSON." << std::endl;
+}
+
 struct binary_alloc_map_t {
   std::vector<std::pair<uint64_t, uint64_t>> free_extents;
 
@@ -430,6 +437,98 @@ void dump_alloc(Allocator* alloc, const string& aname)
   }
 }
 
+int compare_allocators(char* fname, char* alloc_list_fname)
+{
+  int64_t capacity = 0;
+  int64_t alloc_unit = 0;
+  std::vector<std::pair<uint64_t, uint64_t>> free_extents;
+  auto create_fn = [&](std::string_view alloc_type,
+                       int64_t _capacity,
+                       int64_t _alloc_unit,
+                       std::string_view alloc_name) {
+    capacity = _capacity;
+    alloc_unit = _alloc_unit;
+  };
+  auto add_fn = [&](uint64_t offset,
+                    uint64_t len) {
+    free_extents.emplace_back(offset, len);
+  };
+  int r = replay_free_dump_and_apply_raw(fname, create_fn, add_fn);
+  if (r < 0) {
+    return r;
+  }
+
+  struct alloc_request_t {
+    uint64_t want = 0, unit = 0, max = 0;
+    int64_t hint = -1;
+  };
+  std::vector<alloc_request_t> requests;
+  FILE *f_alloc_list = fopen(alloc_list_fname, "r");
+  if (!f_alloc_list) {
+    std::cerr << "error: unable to open " << alloc_list_fname << std::endl;
+    return -1;
+  }
+  char s[4096];
+  while (fgets(s, sizeof(s), f_alloc_list) != nullptr) {
+    alloc_request_t q;
+    if (std::sscanf(s, "%ji %ji %ji %ji", &q.want, &q.unit, &q.max, &q.hint) < 2) {
+      cerr << "Error: malformed allocation request:" << std::endl;
+      cerr << s << std::endl;
+      continue;
+    }
+    requests.push_back(q);
+  }
+  fclose(f_alloc_list);
+
+  ceph::JSONFormatter jf(true);
+  jf.open_array_section("allocators");
+  for (const char* type : {"bitmap", "avl", "btree", "hybrid", "hybrid_btree2"}) {
+    unique_ptr<Allocator> a(
+      Allocator::create(g_ceph_context, type, capacity, alloc_unit, type));
+    if (!a) {
+      continue;
+    }
+    for (auto& [offset, length] : free_extents) {
+      a->init_add_free(offset, length);
+    }
+    uint64_t failed = 0, allocated = 0, fragments = 0;
+    ceph::timespan total_lat = ceph::timespan::zero();
+    ceph::timespan max_lat = ceph::timespan::zero();
+    for (auto& q : requests) {
+      PExtentVector extents;
+      auto t0 = ceph::mono_clock::now();
+      auto res = a->allocate(q.want, q.unit, q.max, q.hint, &extents);
+      auto lat = ceph::mono_clock::now() - t0;
+      total_lat += lat;
+      max_lat = std::max(max_lat, lat);
+      if (res < 0) {
+        ++failed;
+      } else {
+        allocated += res;
+        fragments += extents.size();
+      }
+    }
+    jf.open_object_section("allocator");
+    jf.dump_string("type", type);
+    jf.dump_unsigned("requests", requests.size());
+    jf.dump_unsigned("failed", failed);
+    jf.dump_unsigned("allocated", allocated);
+    jf.dump_unsigned("fragments", fragments);
+    jf.dump_float("avg_latency_ns", requests.empty() ? 0.0 :
+                  (double)total_lat.count() / requests.size());
+    jf.dump_unsigned("max_latency_ns", max_lat.count());
+    jf.dump_float("fragmentation", a->get_fragmentation());
+    jf.dump_float("fragmentation_score", a->get_fragmentation_score());
+    jf.dump_unsigned("free", a->get_free());
+    jf.close_section();
+    a->shutdown();
+  }
+  jf.close_section();
+  jf.flush(std::cout);
+  std::cout << std::endl;
+  return 0;
+}
+
 int export_as_binary(char* fname, char* target_fname)
 {
   int fd = creat(target_fname, 0);
@@ -795,6 +894,14 @@ int main(int argc, char **argv)
           });
 	return 0;
     });
+  } else if (strcmp(argv[2], "compare_alloc") == 0) {
+    if (argc < 4) {
+      std::cerr << "Error: insufficient arguments for \"compare_alloc\" option."
+                << std::endl;
+      usage_compare_alloc(argv[0]);
+      return 1;
+    }
+    return compare_allocators(argv[1], argv[3]);
   } else if (strcmp(argv[2], "export_binary") == 0) {
     return export_as_binary(argv[1], argv[3]);
   } else if (strcmp(argv[2], "duplicates") == 0) {
@@ -10043,6 +10043,358 @@ TEST_P(StoreTestSpecificAUSize, fsckOnUnalignedDevice2) {
   store->mount();
 }
 
+TEST_P(StoreTestSpecificAUSize, BluestoreReadahead) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  SetVal(g_conf(), "bluestore_readahead_max_bytes", "1048576");
+  SetVal(g_conf(), "bluestore_readahead_min_bytes", "131072");
+  SetVal(g_conf(), "bluestore_readahead_trigger_requests", "2");
+  StartDeferred(0x10000);
+
+  int r;
+  coll_t cid;
+  ghobject_t hoid(hobject_t(sobject_t("Object", CEPH_NOSNAP)));
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  const size_t obj_size = 4 << 20;
+  const size_t chunk = 0x10000;
+  bufferlist data;
+  for (size_t i = 0; i < obj_size / chunk; ++i) {
+    data.append(string(chunk, 'a' + i % 26));
+  }
+  {
+    // one write per chunk so that the object spans many blobs
+    for (size_t off = 0; off < obj_size; off += chunk) {
+      ObjectStore::Transaction t;
+      bufferlist bl;
+      bl.substr_of(data, off, chunk);
+      t.write(cid, hoid, off, chunk, bl, CEPH_OSD_OP_FLAG_FADVISE_DONTNEED);
+      r = queue_transaction(store, ch, std::move(t));
+      ASSERT_EQ(r, 0);
+    }
+  }
+  // drop whatever the writes left in the cache
+  ch.reset();
+  ASSERT_EQ(store->umount(), 0);
+  ASSERT_EQ(store->mount(), 0);
+  ch = store->open_collection(cid);
+
+  const PerfCounters* logger = store->get_perf_counters();
+  for (size_t off = 0; off < obj_size; off += chunk) {
+    bufferlist bl, expected;
+    r = store->read(ch, hoid, off, chunk, bl);
+    ASSERT_EQ(r, (int)chunk);
+    expected.substr_of(data, off, chunk);
+    ASSERT_TRUE(bl_eq(expected, bl));
+    // give queued prefetches a chance to complete
+    usleep(10000);
+  }
+  ASSERT_GT(logger->get(l_bluestore_readahead_ops), 0u);
+  ASSERT_GT(logger->get(l_bluestore_readahead_hit_bytes), 0u);
+
+  // random access doesn't trigger prefetch
+  uint64_t ops = logger->get(l_bluestore_readahead_ops);
+  for (size_t i = 0; i < 16; ++i) {
+    bufferlist bl;
+    r = store->read(ch, hoid, ((i * 7) % 64) * chunk, chunk, bl,
+		    CEPH_OSD_OP_FLAG_FADVISE_RANDOM);
+    ASSERT_EQ(r, (int)chunk);
+  }
+  ASSERT_EQ(logger->get(l_bluestore_readahead_ops), ops);
+}
+
+TEST_P(StoreTestSpecificAUSize, BluestoreOmapBloom) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  SetVal(g_conf(), "bluestore_omap_bloom_max_keys", "1000");
+  StartDeferred(0x10000);
+
+  int r;
+  coll_t cid;
+  ghobject_t hoid(hobject_t(sobject_t("Object", CEPH_NOSNAP)));
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    map<string, bufferlist> m;
+    for (int i = 0; i < 100; ++i) {
+      m["key" + stringify(i)].append("value" + stringify(i));
+    }
+    t.touch(cid, hoid);
+    t.omap_setkeys(cid, hoid, m);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  const PerfCounters* logger = store->get_perf_counters();
+  auto lookup = [&](const set<string>& keys) {
+    map<string, bufferlist> out;
+    EXPECT_EQ(0, store->omap_get_values(ch, hoid, keys, &out));
+    set<string> found;
+    for (auto& [k, v] : out) {
+      found.insert(k);
+    }
+    set<string> checked;
+    EXPECT_EQ(0, store->omap_check_keys(ch, hoid, keys, &checked));
+    EXPECT_EQ(found, checked);
+    return found;
+  };
+  set<string> missing;
+  for (int i = 0; i < 100; ++i) {
+    missing.insert("nokey" + stringify(i));
+  }
+  ASSERT_EQ(set<string>{"key7"}, lookup({"key7", "nokey"}));
+  ASSERT_EQ(logger->get(l_bluestore_omap_bloom_builds), 1u);
+  ASSERT_TRUE(lookup(missing).empty());
+  ASSERT_GT(logger->get(l_bluestore_omap_bloom_skipped), 50u);
+
+  // keys set after the filter was built are found
+  {
+    ObjectStore::Transaction t;
+    map<string, bufferlist> m;
+    m["nokey1"].append("x");
+    t.omap_setkeys(cid, hoid, m);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  ASSERT_EQ(set<string>{"nokey1"}, lookup({"nokey1", "nokey2"}));
+
+  // removed keys are gone, even if the filter still matches them
+  {
+    ObjectStore::Transaction t;
+    t.omap_rmkeys(cid, hoid, set<string>{"key7"});
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  ASSERT_TRUE(lookup({"key7"}).empty());
+
+  // clear drops the filter, and it is rebuilt from the new keys
+  {
+    ObjectStore::Transaction t;
+    t.omap_clear(cid, hoid);
+    map<string, bufferlist> m;
+    m["key8"].append("y");
+    t.omap_setkeys(cid, hoid, m);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  ASSERT_EQ(set<string>{"key8"}, lookup({"key8", "key9", "nokey1"}));
+  ASSERT_EQ(logger->get(l_bluestore_omap_bloom_builds), 2u);
+}
+
+TEST_P(StoreTestSpecificAUSize, BluestoreOnodePrefetch) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  SetVal(g_conf(), "bluestore_onode_prefetch_threads", "2");
+  StartDeferred(0x10000);
+
+  int r;
+  coll_t cid;
+  auto ch = store->create_new_collection(cid);
+  vector<ghobject_t> objs;
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    for (int i = 0; i < 16; ++i) {
+      ghobject_t hoid(hobject_t(sobject_t("Object" + stringify(i),
+					  CEPH_NOSNAP)));
+      bufferlist bl;
+      bl.append("attr");
+      t.touch(cid, hoid);
+      t.setattr(cid, hoid, "a", bl);
+      objs.push_back(hoid);
+    }
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  // start with a cold onode cache
+  ch.reset();
+  ASSERT_EQ(store->umount(), 0);
+  ASSERT_EQ(store->mount(), 0);
+  ch = store->open_collection(cid);
+
+  const PerfCounters* logger = store->get_perf_counters();
+  uint64_t misses = logger->get(l_bluestore_onode_misses);
+  for (auto& o : objs) {
+    store->prefetch_object(ch, o);
+  }
+  ASSERT_EQ(logger->get(l_bluestore_onode_prefetch), objs.size());
+  for (int i = 0; i < 1000; ++i) {
+    if (logger->get(l_bluestore_onode_misses) - misses >= objs.size()) {
+      break;
+    }
+    usleep(10000);
+  }
+  // the accesses find everything cached
+  misses = logger->get(l_bluestore_onode_misses);
+  for (auto& o : objs) {
+    bufferptr bp;
+    ASSERT_EQ(0, store->getattr(ch, o, "a", bp));
+  }
+  ASSERT_EQ(logger->get(l_bluestore_onode_misses), misses);
+}
+
+TEST_P(StoreTestSpecificAUSize, BluestoreKVSubmitThreads) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  SetVal(g_conf(), "bluestore_kv_submit_threads", "3");
+  StartDeferred(0x10000);
+
+  const int num_colls = 4;
+  const int num_txcs = 50;
+  vector<coll_t> cids;
+  vector<ObjectStore::CollectionHandle> chs;
+  for (int i = 0; i < num_colls; ++i) {
+    coll_t cid(spg_t(pg_t(i, 1), shard_id_t::NO_SHARD));
+    auto ch = store->create_new_collection(cid);
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    ASSERT_EQ(queue_transaction(store, ch, std::move(t)), 0);
+    cids.push_back(cid);
+    chs.push_back(ch);
+  }
+  ghobject_t hoid(hobject_t(sobject_t("Object", CEPH_NOSNAP)));
+  // keep all collections busy at once; within a collection the last
+  // write must win
+  vector<std::unique_ptr<C_SaferCond>> done;
+  for (int j = 0; j < num_txcs; ++j) {
+    for (int i = 0; i < num_colls; ++i) {
+      ObjectStore::Transaction t;
+      bufferlist bl;
+      bl.append(stringify(j));
+      t.write(cids[i], hoid, 0, bl.length(), bl);
+      map<string, bufferlist> m;
+      m["key" + stringify(j)] = bl;
+      t.omap_setkeys(cids[i], hoid, m);
+      done.emplace_back(new C_SaferCond);
+      t.register_on_commit(done.back().get());
+      ASSERT_EQ(store->queue_transaction(chs[i], std::move(t)), 0);
+    }
+  }
+  for (auto& c : done) {
+    c->wait();
+  }
+  chs.clear();
+  ASSERT_EQ(store->umount(), 0);
+  ASSERT_EQ(store->fsck(false), 0);
+  ASSERT_EQ(store->mount(), 0);
+  for (auto& cid : cids) {
+    auto ch = store->open_collection(cid);
+    bufferlist bl;
+    string last = stringify(num_txcs - 1);
+    ASSERT_EQ(store->read(ch, hoid, 0, last.size(), bl), (int)last.size());
+    ASSERT_EQ(last, bl.to_str());
+    set<string> keys;
+    ASSERT_EQ(store->omap_get_keys(ch, hoid, &keys), 0);
+    ASSERT_EQ(keys.size(), (size_t)num_txcs);
+  }
+}
+
+TEST_P(StoreTestSpecificAUSize, CompressionThreadsTest) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  SetVal(g_conf(), "bluestore_compression_threads", "2");
+  SetVal(g_conf(), "bluestore_compression_algorithm", "snappy");
+  SetVal(g_conf(), "bluestore_compression_mode", "force");
+  StartDeferred(0x10000);
+  doCompressionTest();
+  const PerfCounters* logger = store->get_perf_counters();
+  ASSERT_GT(logger->get(l_bluestore_compress_success_count), 0u);
+}
+
+TEST_P(StoreTestSpecificAUSize, BluestoreAllocSnapshot) {
+  if (string(GetParam()) != "bluestore")
+    return;
+
+  // keep allocations in the bitmap freelist
+  SetVal(g_conf(), "bluestore_allocation_from_file", "false");
+  SetVal(g_conf(), "bluestore_alloc_snapshot", "true");
+  SetVal(g_conf(), "bluestore_alloc_snapshot_region_size", "16777216");
+  SetVal(g_conf(),
+    "bluestore_debug_inject_allocation_from_file_failure", "0");
+  StartDeferred(0x1000);
+
+  BlueStore* bstore = dynamic_cast<BlueStore*> (store.get());
+  int r;
+  coll_t cid;
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  auto obj = [](char c, size_t i) {
+    return ghobject_t(hobject_t(sobject_t(string(1, c) + stringify(i), CEPH_NOSNAP)));
+  };
+  // object "<c><i>" is 0x20000 bytes filled with c
+  auto write_objects = [&](char c, size_t count) {
+    bufferlist bl;
+    bl.append(string(0x20000, c));
+    for (size_t i = 0; i < count; ++i) {
+      ObjectStore::Transaction t;
+      t.write(cid, obj(c, i), 0, bl.length(), bl);
+      r = queue_transaction(store, ch, std::move(t));
+      ASSERT_EQ(r, 0);
+    }
+  };
+  auto verify_objects = [&](char c, size_t count, size_t step) {
+    bufferlist expected;
+    expected.append(string(0x20000, c));
+    for (size_t i = 0; i < count; i += step) {
+      bufferlist bl;
+      r = store->read(ch, obj(c, i), 0, expected.length(), bl);
+      ASSERT_EQ(r, (int)expected.length());
+      ASSERT_TRUE(bl_eq(expected, bl));
+    }
+  };
+  auto remount = [&]() {
+    ch.reset();
+    ASSERT_EQ(store->umount(), 0);
+    ASSERT_EQ(store->fsck(false), 0);
+    ASSERT_EQ(store->mount(), 0);
+    ch = store->open_collection(cid);
+  };
+
+  cerr << "clean umount" << std::endl;
+  write_objects('a', 64);
+  remount();
+
+  cerr << "lost snapshot" << std::endl;
+  write_objects('b', 64);
+  {
+    ObjectStore::Transaction t;
+    for (size_t i = 1; i < 64; i += 2) {
+      t.remove(cid, obj('a', i));
+    }
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  bstore->inject_alloc_snapshot_loss();
+  remount();
+
+  cerr << "clean umount after recovery" << std::endl;
+  // would overwrite live data if the allocator came back wrong
+  write_objects('c', 64);
+  remount();
+  verify_objects('a', 64, 2);
+  verify_objects('b', 64, 1);
+  verify_objects('c', 64, 1);
+  ch.reset();
+  ASSERT_EQ(store->umount(), 0);
+  ASSERT_EQ(store->fsck(true), 0);
+  ASSERT_EQ(store->mount(), 0);
+}
+
 namespace {
   ghobject_t make_object(const char* name, int64_t pool) {
     sobject_t soid{name, CEPH_NOSNAP};
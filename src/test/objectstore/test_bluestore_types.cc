@@ -7,6 +7,7 @@
 #include "include/stringify.h"
 #include "common/ceph_time.h"
 #include "os/bluestore/BlueStore.h"
+#include "os/bluestore/OnodeColdCache.h"
 #include "os/bluestore/simple_bitmap.h"
 #include "os/bluestore/AvlAllocator.h"
 #include "common/ceph_argparse.h"
@@ -2476,6 +2477,69 @@ INSTANTIATE_TEST_SUITE_P(
 );
 
 
+TEST(ExtentMap, decode_bench)
+{
+  BlueStore store(g_ceph_context, "", 4096);
+  std::unique_ptr<BlueStore::OnodeCacheShard> oc{
+      BlueStore::OnodeCacheShard::create(g_ceph_context, "lru", NULL)};
+  std::unique_ptr<BlueStore::BufferCacheShard> bc{
+      BlueStore::BufferCacheShard::create(&store, "lru", NULL)};
+  auto coll = ceph::make_ref<BlueStore::Collection>(&store, oc.get(), bc.get(), coll_t());
+
+  // a shard shaped like a 4MB rbd object written in 64K chunks
+  BlueStore::OnodeRef onode(new BlueStore::Onode(coll.get(), ghobject_t(), ""));
+  BlueStore::ExtentMap &em = onode->extent_map;
+  const uint32_t blob_len = 0x10000;
+  const unsigned num_blobs = 64;
+  for (unsigned i = 0; i < num_blobs; ++i) {
+    BlueStore::BlobRef b = coll->new_blob();
+    auto &bb = b->dirty_blob();
+    bb.init_csum(Checksummer::CSUM_CRC32C, 12, blob_len);
+    for (size_t j = 0; j < bb.get_csum_count(); j++) {
+      *(bb.get_csum_item_ptr(j)) = i * 1000 + j;
+    }
+    PExtentVector pextents;
+    pextents.emplace_back(0x10000000ull + i * 3 * blob_len, blob_len);
+    bb.allocated(0, blob_len, pextents);
+    auto *e = new BlueStore::Extent(i * blob_len, 0, blob_len, b);
+    em.extent_map.insert(*e);
+    b->get_ref(coll.get(), e->blob_offset, e->length);
+    bb.mark_used(e->blob_offset, e->length);
+  }
+  bufferlist bl;
+  unsigned n = 0;
+  ASSERT_FALSE(em.encode_some(0, OBJECT_MAX_SIZE, bl, &n, false, false));
+  ASSERT_EQ(num_blobs, n);
+  bl.rebuild();
+
+  int count = 2000;
+  BlueStore::OnodeRef onode2(new BlueStore::Onode(coll.get(), ghobject_t(), ""));
+  ceph::mono_clock::time_point start = ceph::mono_clock::now();
+  for (int i = 0; i < count; ++i) {
+    onode2->extent_map.clear();
+    ASSERT_EQ(num_blobs, onode2->extent_map.decode_some(bl));
+  }
+  ceph::mono_clock::time_point end = ceph::mono_clock::now();
+  auto dur = std::chrono::duration_cast<ceph::timespan>(end - start);
+  cout << "decoded " << count << " shards of " << bl.length() << " bytes, "
+       << dur << ", " << (double)count * 1000000000.0 / (double)dur.count()
+       << " shards/sec" << std::endl;
+
+  ASSERT_EQ(num_blobs, onode2->extent_map.extent_map.size());
+  auto p = em.extent_map.begin();
+  for (auto& e : onode2->extent_map.extent_map) {
+    ASSERT_EQ(p->logical_offset, e.logical_offset);
+    ASSERT_EQ(p->length, e.length);
+    ASSERT_EQ(p->blob->get_blob().get_extents(),
+              e.blob->get_blob().get_extents());
+    ASSERT_EQ(p->blob->get_blob().get_csum_item(3),
+              e.blob->get_blob().get_csum_item(3));
+    ++p;
+  }
+  onode2->extent_map.clear();
+  em.clear();
+}
+
 TEST(ExtentMap, dup_extent_map)
 {
   BlueStore store(g_ceph_context, "", 4096);
@@ -4010,6 +4074,88 @@ TEST(bluestore_blob_use_tracker_t, mempool_stats_test) {
   }
 }
 
+TEST(OnodeColdCache, basic) {
+  OnodeColdCache cache(g_ceph_context, 4);
+  bufferlist v, out;
+  v.append(std::string(200, 'a'));
+
+  // disabled until sized
+  cache.put("k1", v);
+  ASSERT_FALSE(cache.get("k1", &out));
+  ASSERT_EQ(0u, cache.get_num_entries());
+
+  cache.set_max_bytes(1 << 20);
+  cache.put("k1", v);
+  ASSERT_TRUE(cache.get("k1", &out));
+  ASSERT_TRUE(out.contents_equal(v));
+
+  // replace keeps a single entry with the new value
+  bufferlist v2;
+  v2.append(std::string(100, 'b'));
+  cache.put("k1", v2);
+  ASSERT_EQ(1u, cache.get_num_entries());
+  ASSERT_TRUE(cache.get("k1", &out));
+  ASSERT_TRUE(out.contents_equal(v2));
+  ASSERT_EQ(2 + 100 + OnodeColdCache::ENTRY_OVERHEAD, cache.get_bytes());
+
+  cache.erase("k1");
+  ASSERT_FALSE(cache.get("k1", &out));
+  ASSERT_EQ(0u, cache.get_bytes());
+}
+
+TEST(OnodeColdCache, trim) {
+  OnodeColdCache cache(g_ceph_context, 1);
+  bufferlist v;
+  v.append(std::string(100, 'x'));
+  size_t cost = 2 + 100 + OnodeColdCache::ENTRY_OVERHEAD;
+  cache.set_max_bytes(cost * 3);
+  cache.put("k0", v);
+  cache.put("k1", v);
+  cache.put("k2", v);
+  bufferlist out;
+  // touch k0 so k1 becomes the oldest
+  ASSERT_TRUE(cache.get("k0", &out));
+  cache.put("k3", v);
+  ASSERT_EQ(3u, cache.get_num_entries());
+  ASSERT_FALSE(cache.get("k1", &out));
+  ASSERT_TRUE(cache.get("k0", &out));
+  ASSERT_TRUE(cache.get("k2", &out));
+  ASSERT_TRUE(cache.get("k3", &out));
+
+  cache.set_max_bytes(cost);
+  ASSERT_EQ(1u, cache.get_num_entries());
+  ASSERT_TRUE(cache.get("k3", &out));
+
+  cache.set_max_bytes(0);
+  ASSERT_EQ(0u, cache.get_num_entries());
+}
+
+TEST(OnodeColdCache, compressed) {
+  auto c = Compressor::create(g_ceph_context, "zlib");
+  if (!c) {
+    GTEST_SKIP() << "zlib compressor not available";
+  }
+  OnodeColdCache cache(g_ceph_context, 2);
+  cache.set_compressor(c);
+  cache.set_max_bytes(1 << 20);
+  bufferlist v;
+  v.append(std::string(4000, 'z'));
+  cache.put("k", v);
+  ASSERT_EQ(4000u, cache.get_raw_bytes_compressed());
+  ASSERT_LT(cache.get_bytes(), 4000u);
+  bufferlist out;
+  ASSERT_TRUE(cache.get("k", &out));
+  ASSERT_TRUE(out.contents_equal(v));
+
+  // incompressible values are kept as-is
+  bufferlist r;
+  r.append("ab", 2);
+  cache.put("r", r);
+  ASSERT_EQ(4000u, cache.get_raw_bytes_compressed());
+  ASSERT_TRUE(cache.get("r", &out));
+  ASSERT_TRUE(out.contents_equal(r));
+}
+
 int main(int argc, char **argv) {
   auto args = argv_to_vec(argc, argv);
   auto cct =
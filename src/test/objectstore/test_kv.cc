@@ -26,6 +26,7 @@
 #include "global/global_init.h"
 #include "common/Cond.h"
 #include "common/errno.h"
+#include "include/scope_guard.h"
 #include "include/stringify.h"
 #include <gtest/gtest.h>
 
@@ -505,6 +506,67 @@ TEST_P(KVTest, RocksDBShardingIteratorTest) {
   fini();
 }
 
+TEST_P(KVTest, RocksDBIteratorPool) {
+  if(string(GetParam()) != "rocksdb")
+    GTEST_SKIP();
+
+  auto pool_size = g_conf().get_val<uint64_t>("rocksdb_iterator_pool_size");
+  auto restore_pool_size = make_scope_guard([pool_size] {
+    g_conf().set_val_or_die("rocksdb_iterator_pool_size", stringify(pool_size));
+  });
+  g_conf().set_val_or_die("rocksdb_iterator_pool_size", "4");
+  std::string cfs("A");
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_rocksdb_options));
+  ASSERT_EQ(0, db->create_and_open(cout, cfs));
+  auto put = [&](int from, int to) {
+    KeyValueDB::Transaction t = db->get_transaction();
+    for (int v = from; v <= to; v++) {
+      bufferlist val;
+      val.append(to_string(v));
+      t->set("A", to_string(v), val);
+    }
+    ASSERT_EQ(0, db->submit_transaction_sync(t));
+  };
+  auto count = [&](int lower, int upper) {
+    KeyValueDB::IteratorBounds bounds;
+    bounds.lower_bound = to_string(lower);
+    bounds.upper_bound = to_string(upper);
+    KeyValueDB::Iterator it = db->get_iterator("A", 0, std::move(bounds));
+    int n = 0;
+    for (it->lower_bound(to_string(lower)); it->valid(); it->next()) {
+      EXPECT_LE(to_string(lower), it->key());
+      EXPECT_LT(it->key(), to_string(upper));
+      ++n;
+    }
+    return n;
+  };
+  put(100, 199);
+  ASSERT_EQ(100, count(100, 200));
+  // reused iterator picks up new bounds ...
+  ASSERT_EQ(10, count(150, 160));
+  // ... and writes made since it was pooled
+  put(200, 299);
+  ASSERT_EQ(150, count(150, 300));
+  {
+    // two live iterators must not share one rocksdb iterator
+    KeyValueDB::IteratorBounds b1, b2;
+    b1.lower_bound = "100";
+    b1.upper_bound = "200";
+    b2.lower_bound = "200";
+    b2.upper_bound = "300";
+    auto i1 = db->get_iterator("A", 0, std::move(b1));
+    auto i2 = db->get_iterator("A", 0, std::move(b2));
+    i1->seek_to_first();
+    i2->seek_to_first();
+    ASSERT_TRUE(i1->valid());
+    ASSERT_TRUE(i2->valid());
+    ASSERT_EQ("100", i1->key());
+    ASSERT_EQ("200", i2->key());
+  }
+  ASSERT_EQ(100, count(200, 300));
+  fini();
+}
+
 TEST_P(KVTest, RocksDBCFMerge) {
   if(string(GetParam()) != "rocksdb")
     return;
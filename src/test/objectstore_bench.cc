@@ -2,18 +2,22 @@
 // vim: ts=8 sw=2 sts=2 expandtab
 
 #include <dirent.h>
+#include <sys/resource.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cassert>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <random>
 #include <thread>
 
 #include "os/ObjectStore.h"
 
 #include "global/global_init.h"
 
+#include "common/ceph_time.h"
 #include "common/debug.h"
 #include "common/strtol.h"
 #include "common/ceph_argparse.h"
@@ -35,7 +39,14 @@ static void usage()
       "	 --threads\n"
       "	       number of threads to carry out this workload\n"
       "	 --multi-object\n"
-    "	       have each thread write to a separate object\n" << std::endl;
+      "	       have each thread write to a separate object\n"
+      "	 --random\n"
+      "	       write blocks at random offsets instead of sequentially\n"
+      "	 --omap-keys\n"
+      "	       number of omap keys set along with each write\n"
+      "	 --sync\n"
+      "	       wait for each write to commit before the next one, and\n"
+      "	       report the latency distribution of the writes\n" << std::endl;
   generic_server_usage();
 }
 
@@ -79,10 +90,14 @@ struct Config {
   int repeats;
   int threads;
   bool multi_object;
+  bool random;
+  int omap_keys;
+  bool sync;
   Config()
     : size(1048576), block_size(4096),
       repeats(1), threads(1),
-      multi_object(false) {}
+      multi_object(false), random(false),
+      omap_keys(0), sync(false) {}
 };
 
 class C_NotifyCond : public Context {
@@ -99,12 +114,33 @@ public:
   }
 };
 
+// queue the transactions and wait for the last one to commit
+static void queue_and_wait(ObjectStore *os, ObjectStore::CollectionHandle &ch,
+                           vector<ObjectStore::Transaction> &tls)
+{
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool done = false;
+
+  tls.back().register_on_commit(new C_NotifyCond(&mutex, &cond, &done));
+  os->queue_transactions(ch, tls);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  cond.wait(lock, [&done](){ return done; });
+}
+
 void osbench_worker(ObjectStore *os, const Config &cfg,
                     const coll_t cid, const ghobject_t oid,
-                    uint64_t starting_offset)
+                    uint64_t starting_offset,
+                    std::vector<uint64_t> *latencies)
 {
   bufferlist data;
   data.append(buffer::create(cfg.block_size));
+  bufferlist omap_value;
+  omap_value.append(std::string(64, 'v'));
+  // seeded by the starting offset, so that runs are reproducible
+  std::mt19937_64 rng(starting_offset);
+  const uint64_t blocks = cfg.size / cfg.block_size;
 
   dout(0) << "Writing " << cfg.size
       << " in blocks of " << cfg.block_size << dendl;
@@ -124,11 +160,28 @@ void osbench_worker(ObjectStore *os, const Config &cfg,
     std::cout << "Write cycle " << i << std::endl;
     while (len) {
       size_t count = len < cfg.block_size ? len : (size_t)cfg.block_size;
+      uint64_t write_offset = offset;
+      if (cfg.random && blocks) {
+        write_offset = (rng() % blocks) * cfg.block_size;
+      }
 
-      auto t = new ObjectStore::Transaction;
-      t->write(cid, oid, offset, count, data);
-      tls.push_back(std::move(*t));
-      delete t;
+      ObjectStore::Transaction t;
+      t.write(cid, oid, write_offset, count, data);
+      if (cfg.omap_keys > 0) {
+        map<string, bufferlist> keys;
+        for (int k = 0; k < cfg.omap_keys; ++k) {
+          keys.emplace("osbench." + std::to_string(write_offset) + "." +
+                       std::to_string(k), omap_value);
+        }
+        t.omap_setkeys(cid, oid, keys);
+      }
+      tls.push_back(std::move(t));
+      if (cfg.sync) {
+        auto start = ceph::mono_clock::now();
+        queue_and_wait(os, ch, tls);
+        latencies->push_back((ceph::mono_clock::now() - start).count());
+        tls.clear();
+      }
 
       offset += count;
       if (offset > cfg.size)
@@ -136,17 +189,9 @@ void osbench_worker(ObjectStore *os, const Config &cfg,
       len -= count;
     }
 
-    // set up the finisher
-    std::mutex mutex;
-    std::condition_variable cond;
-    bool done = false;
-
-    tls.back().register_on_commit(new C_NotifyCond(&mutex, &cond, &done));
-    os->queue_transactions(ch, tls);
-
-    std::unique_lock<std::mutex> lock(mutex);
-    cond.wait(lock, [&done](){ return done; });
-    lock.unlock();
+    if (!tls.empty()) {
+      queue_and_wait(os, ch, tls);
+    }
   }
 }
 
@@ -193,6 +238,12 @@ int main(int argc, const char *argv[])
       cfg.threads = atoi(val.c_str());
     } else if (ceph_argparse_flag(args, i, "--multi-object", (char*)nullptr)) {
       cfg.multi_object = true;
+    } else if (ceph_argparse_flag(args, i, "--random", (char*)nullptr)) {
+      cfg.random = true;
+    } else if (ceph_argparse_witharg(args, i, &val, "--omap-keys", (char*)nullptr)) {
+      cfg.omap_keys = atoi(val.c_str());
+    } else if (ceph_argparse_flag(args, i, "--sync", (char*)nullptr)) {
+      cfg.sync = true;
     } else {
       derr << "Error: can't understand argument: " << *i << "\n" << dendl;
       exit(1);
@@ -209,6 +260,9 @@ int main(int argc, const char *argv[])
   dout(0) << "block-size " << cfg.block_size << dendl;
   dout(0) << "repeats " << cfg.repeats << dendl;
   dout(0) << "threads " << cfg.threads << dendl;
+  dout(0) << "random " << cfg.random << dendl;
+  dout(0) << "omap-keys " << cfg.omap_keys << dendl;
+  dout(0) << "sync " << cfg.sync << dendl;
 
   auto os =
       ObjectStore::create(g_ceph_context,
@@ -301,16 +355,22 @@ int main(int argc, const char *argv[])
   std::vector<std::thread> workers;
   workers.reserve(cfg.threads);
 
+  std::vector<std::vector<uint64_t>> latencies(cfg.threads);
+
   using namespace std::chrono;
+  struct rusage ru1, ru2;
+  getrusage(RUSAGE_SELF, &ru1);
   auto t1 = high_resolution_clock::now();
   for (int i = 0; i < cfg.threads; i++) {
     const auto &oid = cfg.multi_object ? oids[i] : oids[0];
     workers.emplace_back(osbench_worker, os.get(), std::ref(cfg),
-                         cid, oid, i * cfg.size / cfg.threads);
+                         cid, oid, i * cfg.size / cfg.threads,
+                         &latencies[i]);
   }
   for (auto &worker : workers)
     worker.join();
   auto t2 = high_resolution_clock::now();
+  getrusage(RUSAGE_SELF, &ru2);
   workers.clear();
 
   auto duration = duration_cast<microseconds>(t2 - t1);
@@ -321,6 +381,36 @@ int main(int argc, const char *argv[])
       << duration.count() << "us, at a rate of " << rate << "/s and "
       << iops << " iops" << dendl;
 
+  // cpu time of the whole process, including the store's own threads
+  auto cpu_us = [](const struct rusage &ru) {
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000LL +
+      ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+  };
+  size_t ops = total / cfg.block_size;
+  if (ops) {
+    dout(0) << "CPU " << (cpu_us(ru2) - cpu_us(ru1)) / ops << "us per write"
+            << dendl;
+  }
+
+  if (cfg.sync) {
+    std::vector<uint64_t> all;
+    for (auto &l : latencies)
+      all.insert(all.end(), l.begin(), l.end());
+    std::sort(all.begin(), all.end());
+    if (!all.empty()) {
+      auto pct = [&all](double p) {
+        return all[std::min(all.size() - 1, (size_t)(p * all.size()))] / 1000;
+      };
+      uint64_t sum = 0;
+      for (auto l : all)
+        sum += l;
+      dout(0) << "Write latency (us): avg " << sum / all.size() / 1000
+              << " p50 " << pct(0.5) << " p99 " << pct(0.99)
+              << " p99.9 " << pct(0.999) << " max " << all.back() / 1000
+              << dendl;
+    }
+  }
+
   // remove the objects
   ObjectStore::Transaction t;
   for (const auto &oid : oids)
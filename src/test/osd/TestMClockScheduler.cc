@@ -294,3 +294,38 @@ TEST_F(mClockSchedulerTest, TestSlowDequeue) {
   }
   ASSERT_TRUE(q.empty());
 }
+
+TEST(mClockCapacityEstimatorTest, SamplesSaturatedWindowsOnly) {
+  CapacityEstimator e;
+  auto t0 = ceph::mono_clock::now();
+
+  // the first call only opens a window
+  ASSERT_FALSE(e.maybe_close_window(t0, 1.0));
+  e.note_dequeue(SchedulerClass::client, 1000, true);
+  e.note_dequeue(SchedulerClass::background_recovery, 1000, true);
+  ASSERT_FALSE(e.maybe_close_window(t0 + 500ms, 1.0));
+  ASSERT_TRUE(e.maybe_close_window(t0 + 2s, 1.0));
+  ASSERT_DOUBLE_EQ(1000.0, e.get_estimate());
+  ASSERT_DOUBLE_EQ(500.0, e.get_achieved(SchedulerClass::client));
+  ASSERT_DOUBLE_EQ(500.0, e.get_achieved(SchedulerClass::background_recovery));
+
+  // the queue ran dry: achieved rates move, the estimate does not
+  e.note_dequeue(SchedulerClass::client, 4000, false);
+  ASSERT_FALSE(e.maybe_close_window(t0 + 4s, 1.0));
+  ASSERT_DOUBLE_EQ(1000.0, e.get_estimate());
+  ASSERT_DOUBLE_EQ(2000.0, e.get_achieved(SchedulerClass::client));
+  ASSERT_DOUBLE_EQ(0.0, e.get_achieved(SchedulerClass::background_recovery));
+
+  // mClock held work back for a limit: not a sample either
+  e.note_dequeue(SchedulerClass::client, 4000, true);
+  e.note_throttled();
+  ASSERT_FALSE(e.maybe_close_window(t0 + 6s, 1.0));
+  ASSERT_DOUBLE_EQ(1000.0, e.get_estimate());
+
+  // a new sample is blended into the estimate
+  e.note_dequeue(SchedulerClass::client, 6000, true);
+  ASSERT_TRUE(e.maybe_close_window(t0 + 8s, 1.0));
+  ASSERT_DOUBLE_EQ(
+    (1 - CapacityEstimator::alpha) * 1000.0 + CapacityEstimator::alpha * 3000.0,
+    e.get_estimate());
+}
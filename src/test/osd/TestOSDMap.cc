@@ -545,6 +545,51 @@ TEST_F(OSDMapTest, MapFunctionsMatch) {
   EXPECT_EQ(acting_osds, acting_osds_two);
 }
 
+TEST_F(OSDMapTest, IncrementalMappingMatchesFull) {
+  set_up_map();
+  mapping.update(osdmap);
+
+  // mark an osd down and add an upmap on an unrelated pg
+  OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+  inc.new_state[0] = CEPH_OSD_UP;
+  pg_t upmap_pg(0, my_rep_pool);
+  vector<int> up;
+  osdmap.pg_to_raw_up(upmap_pg, &up, nullptr);
+  ASSERT_FALSE(up.empty());
+  for (int i = 0; i < (int)get_num_osds(); ++i) {
+    if (std::find(up.begin(), up.end(), i) == up.end()) {
+      inc.new_pg_upmap_items[upmap_pg] = {{up[0], i}};
+      break;
+    }
+  }
+  ASSERT_EQ(0, osdmap.apply_incremental(inc));
+  mapping.note_incremental(inc);
+
+  ThreadPool tp(g_ceph_context, "IncrementalMapping::tp", "inc_map_tp", 4);
+  ParallelPGMapper mapper(g_ceph_context, &tp);
+  tp.start();
+  auto job = mapping.start_update(osdmap, mapper, 64, true);
+  job->wait();
+  tp.stop();
+  ASSERT_TRUE(job->incremental);
+  ASSERT_EQ(osdmap.get_epoch(), mapping.get_epoch());
+
+  for (auto& [pool_id, pool] : osdmap.get_pools()) {
+    for (unsigned ps = 0; ps < pool.get_pg_num(); ++ps) {
+      pg_t pgid(ps, pool_id);
+      vector<int> up, up2, acting, acting2;
+      int up_primary, up_primary2, acting_primary, acting_primary2;
+      osdmap.pg_to_up_acting_osds(pgid, &up, &up_primary,
+				  &acting, &acting_primary);
+      mapping.get(pgid, &up2, &up_primary2, &acting2, &acting_primary2);
+      ASSERT_EQ(up, up2);
+      ASSERT_EQ(up_primary, up_primary2);
+      ASSERT_EQ(acting, acting2);
+      ASSERT_EQ(acting_primary, acting_primary2);
+    }
+  }
+}
+
 /** This test must be removed or modified appropriately when we allow
  * other ways to specify a primary. */
 TEST_F(OSDMapTest, PrimaryIsFirst) {
@@ -2756,6 +2756,34 @@ TEST_F(PGLogTrimTest, TestPartialTrim)
 }
 
 
+TEST_F(PGLogTrimTest, TestObjectIndexFollowsNewestEntry) {
+  SetUp(20);
+  PGLog::IndexedLog log;
+  log.head = mk_evt(24, 0);
+  log.skip_can_rollback_to_to_head();
+  log.head = mk_evt(9, 0);
+
+  log.add(mk_ple_mod(mk_obj(1), mk_evt(10, 100), mk_evt(8, 70)));
+  log.add(mk_ple_mod(mk_obj(2), mk_evt(15, 150), mk_evt(10, 100)));
+  log.add(mk_ple_mod(mk_obj(1), mk_evt(19, 160), mk_evt(10, 100)));
+
+  // the index key refers to the soid of the newest entry for the object
+  auto p = log.objects.find(mk_obj(1));
+  ASSERT_NE(log.objects.end(), p);
+  EXPECT_EQ(&p->second->soid, &p->first.get());
+  EXPECT_EQ(mk_evt(19, 160), p->second->version);
+
+  // so trimming the older entry leaves a valid key behind
+  log.trim(cct, mk_evt(15, 150), nullptr, nullptr, nullptr);
+  EXPECT_EQ(1u, log.log.size());
+  EXPECT_EQ(1u, log.objects.size());
+  p = log.objects.find(mk_obj(1));
+  ASSERT_NE(log.objects.end(), p);
+  EXPECT_EQ(mk_obj(1), p->first.get());
+  EXPECT_EQ(&log.log.back(), p->second);
+}
+
+
 TEST_F(PGLogTrimTest, TestTrimNoTrimmed) {
   SetUp(20);
   PGLog::IndexedLog log;
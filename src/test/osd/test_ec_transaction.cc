@@ -465,4 +465,57 @@ TEST(ectransaction, delete_and_write_misaligned) {
   ref_write[shard_id_t(1)].insert(0, 2*EC_ALIGN_SIZE);
   ref_write[shard_id_t(2)].insert(0, 2*EC_ALIGN_SIZE);
   ASSERT_EQ(ref_write, plan.will_write);
-}
\ No newline at end of file
+}
+TEST(ectransaction, parity_delta_write_with_extent_cache)
+{
+  hobject_t h;
+  PGTransaction::ObjectOperation op;
+  bufferlist a;
+
+  // Overwrite the first chunk of a single full stripe object.
+  a.append_zero(EC_ALIGN_SIZE);
+  op.buffer_updates.insert(0, a.length(), PGTransaction::ObjectOperation::BufferUpdate::Write{a, 0});
+
+  pg_pool_t pool;
+  pool.set_flag(pg_pool_t::FLAG_EC_OPTIMIZATIONS);
+  ECUtil::stripe_info_t sinfo(4, 2, 4 * EC_ALIGN_SIZE, &pool, std::vector<shard_id_t>(0));
+  object_info_t oi;
+  oi.size = 4 * EC_ALIGN_SIZE;
+  shard_id_set shards;
+  shards.insert_range(shard_id_t(0), 6);
+
+  // PDW reads shards 0, 4 and 5, a conventional write shards 1, 2 and 3.
+  ECUtil::shard_extent_set_t pdw_read(sinfo.get_k_plus_m());
+  pdw_read[shard_id_t(0)].insert(0, EC_ALIGN_SIZE);
+  pdw_read[shard_id_t(4)].insert(0, EC_ALIGN_SIZE);
+  pdw_read[shard_id_t(5)].insert(0, EC_ALIGN_SIZE);
+
+  // Object in the cache, but nothing known about its contents.
+  {
+    ECTransaction::WritePlanObj plan(
+      h, op, sinfo, shards, shards, true, oi.size, oi, std::nullopt, 0);
+    ASSERT_FALSE(plan.do_parity_delta_write);
+  }
+
+  // The cache can supply everything a conventional write has to read.
+  {
+    ECUtil::shard_extent_set_t cached(sinfo.get_k_plus_m());
+    for (shard_id_t s(1); s < 4; ++s) {
+      cached[s].insert(0, EC_ALIGN_SIZE);
+    }
+    ECTransaction::WritePlanObj plan(
+      h, op, sinfo, shards, shards, true, oi.size, oi, std::nullopt, 0,
+      &cached);
+    ASSERT_FALSE(plan.do_parity_delta_write);
+  }
+
+  // The cache holds the old data and parity: PDW needs no reads at all.
+  {
+    ECUtil::shard_extent_set_t cached(pdw_read);
+    ECTransaction::WritePlanObj plan(
+      h, op, sinfo, shards, shards, true, oi.size, oi, std::nullopt, 0,
+      &cached);
+    ASSERT_TRUE(plan.do_parity_delta_write);
+    ASSERT_EQ(pdw_read, plan.to_read);
+  }
+}
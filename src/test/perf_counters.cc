@@ -698,3 +698,53 @@ TEST(PerfCounters, TestLabelStrings) {
 
   g_ceph_context->get_perfcounters_collection()->clear();
 }
+
+enum {
+  TEST_PERFCOUNTERS5_ELEMENT_FIRST = 500,
+  TEST_PERFCOUNTERS5_ELEMENT_OPS,
+  TEST_PERFCOUNTERS5_ELEMENT_LAT,
+  TEST_PERFCOUNTERS5_ELEMENT_GAUGE,
+  TEST_PERFCOUNTERS5_ELEMENT_LAST,
+};
+
+TEST(PerfCounters, Sharded) {
+  g_ceph_context->_conf.set_val_or_die("perf_counters_sharded", "true");
+  PerfCountersBuilder bld(g_ceph_context, "test_perfcounter_5",
+      TEST_PERFCOUNTERS5_ELEMENT_FIRST, TEST_PERFCOUNTERS5_ELEMENT_LAST);
+  bld.add_u64_counter(TEST_PERFCOUNTERS5_ELEMENT_OPS, "ops");
+  bld.add_time_avg(TEST_PERFCOUNTERS5_ELEMENT_LAT, "lat");
+  bld.add_u64(TEST_PERFCOUNTERS5_ELEMENT_GAUGE, "gauge");
+  std::unique_ptr<PerfCounters> pc(bld.create_perf_counters());
+  g_ceph_context->_conf.set_val_or_die("perf_counters_sharded", "false");
+
+  constexpr int num_threads = 8;
+  constexpr int num_incs = 10000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < num_incs; ++j) {
+	pc->inc(TEST_PERFCOUNTERS5_ELEMENT_OPS);
+	pc->tinc(TEST_PERFCOUNTERS5_ELEMENT_LAT, ceph::timespan(1));
+	pc->inc(TEST_PERFCOUNTERS5_ELEMENT_GAUGE);
+	// sum and count move together within every shard
+	auto [sum, count] = pc->get_tavg_ns(TEST_PERFCOUNTERS5_ELEMENT_LAT);
+	ASSERT_EQ(sum, count);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  const uint64_t total = num_threads * num_incs;
+  ASSERT_EQ(total, pc->get(TEST_PERFCOUNTERS5_ELEMENT_OPS));
+  ASSERT_EQ(total, pc->get(TEST_PERFCOUNTERS5_ELEMENT_GAUGE));
+  ASSERT_EQ(std::make_pair(total, total),
+	    pc->get_tavg_ns(TEST_PERFCOUNTERS5_ELEMENT_LAT));
+
+  pc->set(TEST_PERFCOUNTERS5_ELEMENT_OPS, 5);
+  ASSERT_EQ(5u, pc->get(TEST_PERFCOUNTERS5_ELEMENT_OPS));
+  pc->reset();
+  ASSERT_EQ(0u, pc->get(TEST_PERFCOUNTERS5_ELEMENT_OPS));
+  ASSERT_EQ(std::make_pair(uint64_t(0), uint64_t(0)),
+	    pc->get_tavg_ns(TEST_PERFCOUNTERS5_ELEMENT_LAT));
+}
@@ -274,6 +274,8 @@ POTENTIAL_OBJ_SIZE=(64*KB)
 RADOS_OBJ_SIZE=(4*MB)
 MULTIPART_SIZE=(16*MB)
 default_config = TransferConfig(multipart_threshold=MULTIPART_SIZE, multipart_chunksize=MULTIPART_SIZE)
+# keep the objects single part, multipart objects are skipped by chunk dedup
+chunk_config = TransferConfig(multipart_threshold=64*MB, multipart_chunksize=64*MB)
 ETAG_ATTR="user.rgw.etag"
 POOLNAME="default.rgw.buckets.data"
 
@@ -2751,6 +2753,114 @@ def test_dedup_dry_large_scale():
         cleanup_all_buckets(bucket_names, conns)
 
 
+#-------------------------------------------------------------------------------
+def set_chunk_dedup(enabled):
+    val = 'true' if enabled else 'false'
+    result = bash([test_path + 'test-rgw-call.sh', 'call_ceph', 'noname', 'config',
+                   'set', 'client', 'rgw_dedup_chunk_enabled', val])
+    assert result[1] == 0
+
+
+#-------------------------------------------------------------------------------
+def read_chunk_dedup_stats():
+    result = admin(['dedup', 'stats'])
+    assert result[1] == 0
+    jstats=json.loads(result[0])
+    key='md5_stats'
+    if key in jstats and 'chunk dedup' in jstats[key]:
+        return jstats[key]['chunk dedup']
+
+    return {}
+
+
+#-------------------------------------------------------------------------------
+def count_fp_index_keys():
+    result = rados(['-p', 'default.rgw.log', '-N', 'dedup', 'ls'])
+    assert result[1] == 0
+    count = 0
+    for name in result[0].split():
+        if name.startswith('dedup.fp_index.'):
+            keys = rados(['-p', 'default.rgw.log', '-N', 'dedup', 'listomapkeys', name])
+            assert keys[1] == 0
+            count += len(keys[0].split())
+
+    return count
+
+
+#-------------------------------------------------------------------------------
+def verify_object_content(conn, bucket_name, key, filename):
+    full_filename = OUT_DIR + filename
+    tmpfile = OUT_DIR + "chunk_tmp"
+    conn.download_file(bucket_name, key, tmpfile, Config=chunk_config)
+    result = bash(['cmp', tmpfile, full_filename])
+    assert result[1] == 0, "Files %s and %s differ!!" % (key, tmpfile)
+    os.remove(tmpfile)
+
+
+#-------------------------------------------------------------------------------
+@pytest.mark.basic_test
+def test_chunk_dedup():
+    # 1) upload two singleton objects sharing all but their last tail object
+    # 2) execute DEDUP with chunk dedup enabled
+    #    verify that a single object was deduped, releasing its 3 shared tails
+    #    verify that the fingerprint index was populated
+    # 3) execute DEDUP again and verify nothing else is released
+    # 4) remove the objects one by one and verify that GC keeps the shared
+    #    tails for the surviving object and frees them with the last one
+    if full_dedup_is_disabled():
+        return
+
+    prepare_test()
+    bucket_name = gen_bucket_name()
+    log.debug("test_chunk_dedup: connect to AWS ...")
+    conn=get_single_connection()
+    set_chunk_dedup(True)
+    try:
+        conn.create_bucket(Bucket=bucket_name)
+        os.mkdir(OUT_DIR)
+        size = 5*RADOS_OBJ_SIZE
+        filename_a = "chunk_obj_a"
+        filename_b = "chunk_obj_b"
+        write_file(filename_a, size)
+        with open(OUT_DIR + filename_a, "rb") as fin:
+            data = bytearray(fin.read())
+        data[size-KB:] = os.urandom(KB)
+        with open(OUT_DIR + filename_b, "wb") as fout:
+            fout.write(data)
+
+        conn.upload_file(OUT_DIR + filename_a, bucket_name, filename_a, Config=chunk_config)
+        conn.upload_file(OUT_DIR + filename_b, bucket_name, filename_b, Config=chunk_config)
+        # a head and 4 tail objects for each
+        assert count_object_parts_in_all_buckets() == 10
+
+        exec_dedup_internal(Dedup_Stats(), False, 5*60)
+        chunk_stats = read_chunk_dedup_stats()
+        assert chunk_stats['Deduped Obj'] == 1
+        assert chunk_stats['Released Tail Objs'] == 3
+        assert count_object_parts_in_all_buckets() == 7
+        assert count_fp_index_keys() > 0
+        verify_object_content(conn, bucket_name, filename_a, filename_a)
+        verify_object_content(conn, bucket_name, filename_b, filename_b)
+
+        # the deduped object has an explicit manifest and is not rescanned
+        exec_dedup_internal(Dedup_Stats(), False, 5*60)
+        chunk_stats = read_chunk_dedup_stats()
+        assert chunk_stats.get('Deduped Obj', 0) == 0
+        assert count_object_parts_in_all_buckets() == 7
+
+        conn.delete_object(Bucket=bucket_name, Key=filename_a)
+        result = admin(['gc', 'process', '--include-all'])
+        assert result[1] == 0
+        verify_object_content(conn, bucket_name, filename_b, filename_b)
+
+        conn.delete_object(Bucket=bucket_name, Key=filename_b)
+        verify_pool_is_empty()
+    finally:
+        set_chunk_dedup(False)
+        # cleanup must be executed even after a failure
+        cleanup(bucket_name, conn)
+
+
 #-------------------------------------------------------------------------------
 @pytest.mark.basic_test
 def test_cleanup():
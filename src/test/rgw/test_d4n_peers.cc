@@ -0,0 +1,81 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+#include "driver/d4n/d4n_peers.h"
+
+#include <map>
+
+#include <fmt/format.h>
+
+#include <gtest/gtest.h>
+
+using rgw::d4n::HashRing;
+
+static std::vector<std::string> make_keys(size_t count)
+{
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < count; ++i) {
+    keys.push_back(fmt::format("bucket-id_version_object#{}_0_4194304", i));
+  }
+  return keys;
+}
+
+TEST(HashRing, Empty)
+{
+  HashRing ring{{}};
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(HashRing, SingleNode)
+{
+  HashRing ring{{"http://a:8000"}};
+  ASSERT_FALSE(ring.empty());
+  for (const auto& key : make_keys(100)) {
+    EXPECT_EQ("http://a:8000", ring.owner(key));
+  }
+}
+
+TEST(HashRing, Balanced)
+{
+  const std::vector<std::string> nodes = {
+    "http://a:8000", "http://b:8000", "http://c:8000"};
+  HashRing ring{nodes};
+  std::map<std::string, size_t> owned;
+  const auto keys = make_keys(3000);
+  for (const auto& key : keys) {
+    ++owned[ring.owner(key)];
+  }
+  ASSERT_EQ(nodes.size(), owned.size());
+  for (const auto& [node, count] : owned) {
+    EXPECT_GT(count, keys.size() / 5) << node;
+    EXPECT_LT(count, keys.size() / 2) << node;
+  }
+}
+
+TEST(HashRing, IndependentOfOrder)
+{
+  // every gateway parses its own copy of rgw_d4n_cache_peers
+  HashRing ring1{{"http://a:8000", "http://b:8000", "http://c:8000"}};
+  HashRing ring2{{"http://c:8000", "http://a:8000", "http://b:8000"}};
+  for (const auto& key : make_keys(1000)) {
+    EXPECT_EQ(ring1.owner(key), ring2.owner(key)) << key;
+  }
+}
+
+TEST(HashRing, AddNodeMovesOnlyToIt)
+{
+  HashRing before{{"http://a:8000", "http://b:8000", "http://c:8000"}};
+  HashRing after{{"http://a:8000", "http://b:8000", "http://c:8000",
+                  "http://d:8000"}};
+  size_t moved = 0;
+  const auto keys = make_keys(3000);
+  for (const auto& key : keys) {
+    const auto& owner = after.owner(key);
+    if (owner != before.owner(key)) {
+      EXPECT_EQ("http://d:8000", owner) << key;
+      ++moved;
+    }
+  }
+  EXPECT_GT(moved, 0u);
+  EXPECT_LT(moved, keys.size() / 2);
+}
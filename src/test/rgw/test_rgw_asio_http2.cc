@@ -0,0 +1,296 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ */
+
+#include "rgw_asio_http2.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <optional>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/spawn.hpp>
+#include <nghttp2/nghttp2.h>
+
+#include <gtest/gtest.h>
+
+#include "global/global_context.h"
+
+namespace http2 = rgw::asio::http2;
+using namespace std::chrono_literals;
+
+namespace {
+
+// an nghttp2 client session that exchanges frames with the server session
+// in memory
+struct Client {
+  nghttp2_session* session = nullptr;
+  std::map<int32_t, uint32_t> closed; // error code by stream id
+  std::string body; // request body of the data provider
+  std::string response; // response body of all streams
+
+  static int on_stream_close(nghttp2_session*, int32_t stream_id,
+                             uint32_t error_code, void* user_data)
+  {
+    static_cast<Client*>(user_data)->closed[stream_id] = error_code;
+    return 0;
+  }
+
+  static int on_data_chunk_recv(nghttp2_session*, uint8_t, int32_t,
+                                const uint8_t* data, size_t len,
+                                void* user_data)
+  {
+    static_cast<Client*>(user_data)->response.append(
+        reinterpret_cast<const char*>(data), len);
+    return 0;
+  }
+
+  static ssize_t read_body(nghttp2_session*, int32_t, uint8_t* buf,
+                           size_t length, uint32_t* data_flags,
+                           nghttp2_data_source*, void* user_data)
+  {
+    auto self = static_cast<Client*>(user_data);
+    const size_t n = std::min(length, self->body.size());
+    std::copy_n(self->body.data(), n, buf);
+    self->body.erase(0, n);
+    if (self->body.empty()) {
+      *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+    }
+    return n;
+  }
+
+  Client() {
+    nghttp2_session_callbacks* callbacks = nullptr;
+    nghttp2_session_callbacks_new(&callbacks);
+    nghttp2_session_callbacks_set_on_stream_close_callback(
+        callbacks, on_stream_close);
+    nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
+        callbacks, on_data_chunk_recv);
+    nghttp2_session_client_new(&session, callbacks, this);
+    nghttp2_session_callbacks_del(callbacks);
+    nghttp2_submit_settings(session, NGHTTP2_FLAG_NONE, nullptr, 0);
+  }
+  ~Client() {
+    nghttp2_session_del(session);
+  }
+
+  int32_t request(std::string_view method, std::string_view path,
+                  const std::map<std::string, std::string>& headers = {},
+                  bool with_body = false)
+  {
+    auto nv = [] (std::string_view name, std::string_view value) {
+      return nghttp2_nv{
+        reinterpret_cast<uint8_t*>(const_cast<char*>(name.data())),
+        reinterpret_cast<uint8_t*>(const_cast<char*>(value.data())),
+        name.size(), value.size(), NGHTTP2_NV_FLAG_NONE};
+    };
+    std::vector<nghttp2_nv> nva = {
+      nv(":method", method), nv(":path", path),
+      nv(":scheme", "http"), nv(":authority", "localhost"),
+    };
+    for (const auto& [name, value] : headers) {
+      nva.push_back(nv(name, value));
+    }
+    nghttp2_data_provider prd;
+    prd.read_callback = read_body;
+    return nghttp2_submit_request(session, nullptr, nva.data(), nva.size(),
+                                  with_body ? &prd : nullptr, nullptr);
+  }
+
+  std::string output() {
+    std::string out;
+    const uint8_t* data = nullptr;
+    ssize_t n;
+    while ((n = nghttp2_session_mem_send(session, &data)) > 0) {
+      out.append(reinterpret_cast<const char*>(data), n);
+    }
+    return out;
+  }
+
+  void receive(const std::string& in) {
+    ASSERT_EQ(static_cast<ssize_t>(in.size()),
+              nghttp2_session_mem_recv(
+                  session, reinterpret_cast<const uint8_t*>(in.data()),
+                  in.size()));
+  }
+};
+
+std::shared_ptr<http2::Session> make_session(boost::asio::io_context& ctx,
+                                             const http2::Settings& settings = {})
+{
+  const auto endpoint = boost::asio::ip::tcp::endpoint{
+      boost::asio::ip::make_address("127.0.0.1"), 80};
+  auto session = std::make_shared<http2::Session>(
+      g_ceph_context, ctx.get_executor(), settings, false,
+      endpoint, endpoint);
+  EXPECT_EQ(0, session->init());
+  return session;
+}
+
+std::string server_output(http2::Session& session)
+{
+  std::string out;
+  EXPECT_EQ(0, session.output(out, std::numeric_limits<size_t>::max()));
+  return out;
+}
+
+} // anonymous namespace
+
+TEST(HTTP2Session, Settings)
+{
+  boost::asio::io_context ctx;
+  auto session = make_session(ctx);
+  // the server connection preface starts with a SETTINGS frame
+  const auto out = server_output(*session);
+  ASSERT_GE(out.size(), 9u);
+  EXPECT_EQ(NGHTTP2_SETTINGS, static_cast<uint8_t>(out[3]));
+  EXPECT_TRUE(session->idle());
+  EXPECT_FALSE(session->done());
+}
+
+TEST(HTTP2Session, Request)
+{
+  boost::asio::io_context ctx;
+  auto session = make_session(ctx);
+  Client client;
+  const int32_t id = client.request("GET", "/bucket/key?versionId=1",
+                                    {{"x-amz-date", "20260101T000000Z"}});
+  const auto in = client.output();
+  ASSERT_EQ(0, session->receive(in.data(), in.size()));
+
+  auto requests = session->take_requests();
+  ASSERT_EQ(1u, requests.size());
+  const auto& s = requests.front();
+  EXPECT_EQ(id, s->get_id());
+  EXPECT_EQ("GET", s->get_method());
+  EXPECT_EQ("/bucket/key?versionId=1", s->get_path());
+  EXPECT_EQ("20260101T000000Z", s->get_header("x-amz-date"));
+  EXPECT_EQ("", s->get_header("range"));
+  EXPECT_FALSE(session->idle());
+  EXPECT_TRUE(session->take_requests().empty());
+}
+
+TEST(HTTP2Session, HeaderLimit)
+{
+  boost::asio::io_context ctx;
+  http2::Settings settings;
+  settings.header_limit = 64;
+  auto session = make_session(ctx, settings);
+  Client client;
+  client.receive(server_output(*session));
+  const int32_t id = client.request("GET", "/bucket/key",
+                                    {{"x-amz-meta-big", std::string(128, 'x')}});
+  const auto in = client.output();
+  ASSERT_EQ(0, session->receive(in.data(), in.size()));
+  EXPECT_TRUE(session->take_requests().empty());
+
+  client.receive(server_output(*session));
+  ASSERT_EQ(1u, client.closed.count(id));
+  EXPECT_NE(NGHTTP2_NO_ERROR, client.closed[id]);
+}
+
+TEST(HTTP2Session, RecvBody)
+{
+  boost::asio::io_context ctx;
+  auto session = make_session(ctx);
+  Client client;
+  client.body = "hello world";
+  client.request("PUT", "/bucket/key", {{"content-length", "11"}}, true);
+  const auto in = client.output();
+  ASSERT_EQ(0, session->receive(in.data(), in.size()));
+  auto requests = session->take_requests();
+  ASSERT_EQ(1u, requests.size());
+
+  std::string body;
+  boost::asio::spawn(ctx, [&, s = requests.front()] (boost::asio::yield_context yield) {
+      s->set_yield(yield);
+      char buf[4];
+      while (size_t n = s->recv_body(buf, sizeof(buf))) {
+        body.append(buf, n);
+      }
+    }, [] (std::exception_ptr eptr) {
+      if (eptr) std::rethrow_exception(eptr);
+    });
+  ctx.run();
+  EXPECT_EQ("hello world", body);
+}
+
+TEST(HTTP2Session, RecvBodyTimeout)
+{
+  boost::asio::io_context ctx;
+  http2::Settings settings;
+  settings.stream_timeout = 10ms;
+  auto session = make_session(ctx, settings);
+  Client client;
+  client.receive(server_output(*session));
+  // a body that never arrives
+  const int32_t id = client.request("PUT", "/bucket/key",
+                                    {{"content-length", "11"}}, true);
+  client.body = "hello world";
+  auto in = client.output();
+  // drop the DATA frame, keep the preface, SETTINGS and HEADERS
+  ASSERT_GT(in.size(), 9u + 11u);
+  in.resize(in.size() - 9 - 11);
+  ASSERT_EQ(0, session->receive(in.data(), in.size()));
+  auto requests = session->take_requests();
+  ASSERT_EQ(1u, requests.size());
+
+  std::optional<int> error;
+  boost::asio::spawn(ctx, [&, s = requests.front()] (boost::asio::yield_context yield) {
+      s->set_yield(yield);
+      char buf[16];
+      try {
+        s->recv_body(buf, sizeof(buf));
+      } catch (const rgw::io::Exception& e) {
+        error = e.code().value();
+      }
+    }, [] (std::exception_ptr eptr) {
+      if (eptr) std::rethrow_exception(eptr);
+    });
+  ctx.run();
+  ASSERT_TRUE(error);
+  EXPECT_EQ(ETIMEDOUT, *error);
+
+  // the stream was reset
+  client.receive(server_output(*session));
+  ASSERT_EQ(1u, client.closed.count(id));
+  EXPECT_EQ(NGHTTP2_CANCEL, client.closed[id]);
+}
+
+TEST(HTTP2Session, Shutdown)
+{
+  boost::asio::io_context ctx;
+  auto session = make_session(ctx);
+  Client client;
+  client.request("GET", "/bucket/key");
+  const auto in = client.output();
+  ASSERT_EQ(0, session->receive(in.data(), in.size()));
+  auto requests = session->take_requests();
+  ASSERT_EQ(1u, requests.size());
+
+  session->shutdown();
+  EXPECT_TRUE(session->done());
+
+  bool reset = false;
+  boost::asio::spawn(ctx, [&, s = requests.front()] (boost::asio::yield_context yield) {
+      s->set_yield(yield);
+      try {
+        s->send_body("x", 1);
+      } catch (const rgw::io::Exception& e) {
+        reset = e.code().value() == ECONNRESET;
+      }
+    }, [] (std::exception_ptr eptr) {
+      if (eptr) std::rethrow_exception(eptr);
+    });
+  ctx.run();
+  EXPECT_TRUE(reset);
+}
@@ -969,6 +969,51 @@ TEST_F(CksumCombinerFixture, Test1) {
   }
 } /* CksumCombinerFixture, Test1 */
 
+struct NullProcessor : public rgw::sal::DataProcessor {
+  uint64_t bytes{0};
+  int process(ceph::buffer::list&& data, uint64_t offset) override {
+    bytes += data.length();
+    return 0;
+  }
+};
+
+TEST(RGWCksum, PipeEtagHash)
+{
+  /* segments larger and smaller than the fused block */
+  std::string data;
+  while (data.size() < 300 * 1024) {
+    data += dolor;
+  }
+  ceph::buffer::list bl;
+  bl.append(data.data(), 100);
+  bl.append(data.data() + 100, 200 * 1024);
+  bl.append(data.data() + 100 + 200 * 1024, data.size() - 100 - 200 * 1024);
+
+  for (auto t : {t3, t6, t7}) {
+    NullProcessor sink;
+    auto hdr = rgw::putobj::cksum_algorithm_hdr(t);
+    rgw::putobj::RGWPutObj_Cksum cksum_filter(&sink, t, 0, std::move(hdr));
+    ceph::crypto::MD5 fused_md5;
+    cksum_filter.set_etag_hash(&fused_md5);
+    ASSERT_EQ(cksum_filter.process(ceph::buffer::list(bl), 0), 0);
+    ASSERT_EQ(sink.bytes, data.size());
+
+    ceph::crypto::MD5 md5;
+    md5.Update((const unsigned char*)data.data(), data.size());
+    unsigned char m1[CEPH_CRYPTO_MD5_DIGESTSIZE];
+    unsigned char m2[CEPH_CRYPTO_MD5_DIGESTSIZE];
+    fused_md5.Final(m1);
+    md5.Final(m2);
+    ASSERT_EQ(memcmp(m1, m2, sizeof(m1)), 0);
+
+    DigestVariant dv = rgw::cksum::digest_factory(t);
+    Digest* digest = get_digest(dv);
+    digest->Update((const unsigned char*)data.data(), data.size());
+    auto cksum = rgw::cksum::finalize_digest(digest, t);
+    ASSERT_EQ(cksum_filter.finalize().to_string(), cksum.to_string());
+  }
+}
+
 
 int main(int argc, char *argv[])
 {
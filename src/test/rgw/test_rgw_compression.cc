@@ -123,7 +123,7 @@ TEST(Compress, LimitedChunkSize)
     bl.append(bp);
 
     ut_put_sink c_sink;
-    RGWPutObj_Compress compressor(g_ceph_context, plugin, &c_sink);
+    RGWPutObj_Compress compressor(g_ceph_context, plugin, &c_sink, null_yield);
     compressor.process(std::move(bl), 0);
     compressor.process({}, s); // flush
 
@@ -155,7 +155,7 @@ TEST(Compress, BillionZeros)
   ut_put_sink c_sink;
   plugin = Compressor::create(g_ceph_context, Compressor::COMP_ALG_ZLIB);
   ASSERT_NE(plugin.get(), nullptr);
-  RGWPutObj_Compress compressor(g_ceph_context, plugin, &c_sink);
+  RGWPutObj_Compress compressor(g_ceph_context, plugin, &c_sink, null_yield);
 
   constexpr size_t size = 1000000;
   bufferptr bp(size);
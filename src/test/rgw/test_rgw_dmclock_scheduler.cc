@@ -17,6 +17,7 @@
 
 #include "rgw_dmclock_sync_scheduler.h"
 #include "rgw_dmclock_async_scheduler.h"
+#include "rgw_dmclock_tenant_scheduler.h"
 
 #include <optional>
 #include <boost/asio/spawn.hpp>
@@ -428,4 +429,32 @@ TEST(Queue, SpawnAsyncRequest)
   EXPECT_TRUE(context.stopped());
 }
 
+TEST(Queue, TenantRequest)
+{
+  boost::asio::io_context context;
+  TenantScheduler queue(g_ceph_context, context, nullptr);
+
+  std::optional<error_code> ec1, ec2, ec3;
+  std::optional<PhaseType> p1, p2, p3;
+
+  auto now = get_time();
+  queue.async_request(client_id::data, "tenant1", {}, now, 1, capture(ec1, p1));
+  queue.async_request(client_id::data, "tenant1", {}, now, 1, capture(ec2, p2));
+  queue.async_request(client_id::data, "tenant2", {}, now, 1, capture(ec3, p3));
+
+  context.run_for(std::chrono::milliseconds(50));
+  EXPECT_TRUE(context.stopped());
+
+  ASSERT_TRUE(ec1);
+  EXPECT_EQ(boost::system::errc::success, *ec1);
+  ASSERT_TRUE(ec2);
+  EXPECT_EQ(boost::system::errc::success, *ec2);
+  ASSERT_TRUE(ec3);
+  EXPECT_EQ(boost::system::errc::success, *ec3);
+
+  queue.request_complete();
+  queue.request_complete();
+  queue.request_complete();
+}
+
 } // namespace rgw::dmclock
@@ -314,6 +314,35 @@ TEST(TestRGWLua, SetResponse)
   ASSERT_EQ(rc, 0);
 }
 
+TEST(TestRGWLua, CompiledScriptReused)
+{
+  const std::string script = R"(
+    assert(Counter == nil)
+    Counter = 1
+    Request.Response.Message = "seen " .. Request.Response.RGWCode
+  )";
+
+  // the second run loads the chunk compiled by the first one, but still
+  // runs in a fresh state against its own request
+  for (auto code : {1000, 2000}) {
+    DEFINE_REQ_STATE;
+    s.err.ret = code;
+
+    const auto rc = lua::request::execute(nullptr, nullptr, &s, nullptr, script);
+    ASSERT_EQ(rc, 0);
+    ASSERT_EQ(s.err.message, "seen " + std::to_string(code));
+  }
+
+  // a changed script is compiled again
+  const std::string changed = R"(
+    Request.Response.Message = "changed"
+  )";
+  DEFINE_REQ_STATE;
+  const auto rc = lua::request::execute(nullptr, nullptr, &s, nullptr, changed);
+  ASSERT_EQ(rc, 0);
+  ASSERT_EQ(s.err.message, "changed");
+}
+
 TEST(TestRGWLua, RGWIdNotWriteable)
 {
   const std::string script = R"(
@@ -0,0 +1,151 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab ft=cpp
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * Copyright contributors to the Ceph project
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation. See file COPYING.
+ *
+ */
+
+#include "driver/rados/rgw_quota_deltas.h"
+
+#include "rgw_common.h"
+
+#include <gtest/gtest.h>
+
+using namespace rgwrados::quota;
+using namespace std::chrono_literals;
+
+static stats_delta make_delta(int64_t objects, int64_t size)
+{
+  return stats_delta{objects, size, size};
+}
+
+static size_t count_keys(const delta_writes& writes)
+{
+  size_t count = 0;
+  for (const auto& [oid, vals] : writes) {
+    count += vals.size();
+  }
+  return count;
+}
+
+TEST(QuotaDeltas, Difference)
+{
+  const auto now = ceph::real_clock::now();
+  const instance_deltas before = {
+    {"a", {make_delta(10, 100), now}},
+    {"b", {make_delta(5, 50), now}},
+  };
+  const instance_deltas after = {
+    {"a", {make_delta(12, 150), now}}, // +2, +50
+    {"b", {make_delta(5, 50), now}},   // unchanged
+    {"c", {make_delta(1, 10), now}},   // new since before
+  };
+  const auto d = difference(before, after);
+  EXPECT_EQ(3, d.num_objects);
+  EXPECT_EQ(60, d.size);
+  EXPECT_EQ(60, d.size_rounded);
+}
+
+TEST(QuotaDeltas, DifferenceMissingAfter)
+{
+  const auto now = ceph::real_clock::now();
+  const instance_deltas before = {{"a", {make_delta(10, 100), now}}};
+  const auto d = difference(before, {});
+  EXPECT_EQ(0, d.num_objects);
+  EXPECT_EQ(0, d.size);
+}
+
+TEST(QuotaDeltas, ApplyClamps)
+{
+  RGWStorageStats stats;
+  stats.num_objects = 3;
+  stats.size = 30;
+  stats.size_rounded = 4096;
+  apply(make_delta(-5, 10), stats);
+  EXPECT_EQ(0u, stats.num_objects);
+  EXPECT_EQ(40u, stats.size);
+  EXPECT_EQ(4106u, stats.size_rounded);
+}
+
+TEST(QuotaDeltas, StaleKeys)
+{
+  const auto now = ceph::real_clock::now();
+  const rgw_bucket bucket{"tenant", "bucket", "id"};
+  const instance_deltas deltas = {
+    {"self", {make_delta(1, 1), now - 2h}},
+    {"old", {make_delta(1, 1), now - 2h}},
+    {"live", {make_delta(1, 1), now - 10min}},
+  };
+  const auto keys = stale_keys(bucket, deltas, "self", now - 1h);
+  ASSERT_EQ(1u, keys.size());
+  const auto& key = *keys.begin();
+  EXPECT_EQ(bucket.get_key() + "/old", key);
+}
+
+TEST(QuotaDeltas, CollectDirty)
+{
+  DeltaAggregator deltas{librados::IoCtx{}, 1, 4};
+  const rgw_bucket b1{"", "b1", "id1"};
+  const rgw_bucket b2{"", "b2", "id2"};
+  deltas.add(b1, make_delta(1, 10));
+  deltas.add(b2, make_delta(2, 20));
+
+  const auto now = ceph::real_clock::now();
+  delta_writes writes;
+  EXPECT_EQ(2u, deltas.collect(now, 1h, writes).size());
+  EXPECT_EQ(2u, count_keys(writes));
+
+  // nothing changed since
+  writes.clear();
+  EXPECT_TRUE(deltas.collect(now + 1s, 1h, writes).empty());
+  EXPECT_TRUE(writes.empty());
+
+  // only the changed bucket
+  deltas.add(b2, make_delta(1, 5));
+  writes.clear();
+  const auto collected = deltas.collect(now + 2s, 1h, writes);
+  ASSERT_EQ(1u, collected.size());
+  EXPECT_EQ(b2, collected.front());
+  ASSERT_EQ(1u, count_keys(writes));
+
+  const auto& vals = writes.begin()->second;
+  const auto& [key, bl] = *vals.begin();
+  EXPECT_EQ(b2.get_key() + "/" + deltas.get_instance(), key);
+  instance_delta published;
+  auto p = bl.cbegin();
+  decode(published, p);
+  EXPECT_EQ(3, published.delta.num_objects);
+  EXPECT_EQ(25, published.delta.size);
+  EXPECT_EQ(now + 2s, published.updated);
+}
+
+TEST(QuotaDeltas, CollectRepublishes)
+{
+  DeltaAggregator deltas{librados::IoCtx{}, 1, 4};
+  const rgw_bucket bucket{"", "bucket", "id"};
+  deltas.add(bucket, make_delta(1, 10));
+
+  const auto now = ceph::real_clock::now();
+  delta_writes writes;
+  EXPECT_EQ(1u, deltas.collect(now, 1h, writes).size());
+
+  writes.clear();
+  EXPECT_TRUE(deltas.collect(now + 59min, 1h, writes).empty());
+
+  // unchanged totals are published again once per interval, so their key
+  // never looks stale to the other gateways
+  writes.clear();
+  EXPECT_EQ(1u, deltas.collect(now + 1h, 1h, writes).size());
+  EXPECT_EQ(1u, count_keys(writes));
+
+  writes.clear();
+  EXPECT_TRUE(deltas.collect(now + 1h + 1s, 1h, writes).empty());
+}
@@ -101,6 +101,33 @@ TEST(Aio_Throttle, CostOverWindow)
   EXPECT_EQ(-EDEADLK, c.front().result);
 }
 
+TEST(Aio_Throttle, SharedBudget)
+{
+  ThrottleBudget budget;
+  budget.set_limit(2);
+  BlockingAioThrottle throttle1(4, &budget);
+  BlockingAioThrottle throttle2(4, &budget);
+  auto obj = make_obj(__PRETTY_FUNCTION__);
+  {
+    scoped_completion op1;
+    auto c1 = throttle1.get(obj, wait_on(op1), 1, 0);
+    EXPECT_TRUE(c1.empty());
+    scoped_completion op2;
+    auto c2 = throttle1.get(obj, wait_on(op2), 1, 0);
+    EXPECT_TRUE(c2.empty());
+    EXPECT_EQ(2u, budget.get_used());
+    EXPECT_FALSE(budget.has_room(1));
+    // a throttle with nothing in flight may always issue one op
+    scoped_completion op3;
+    auto c3 = throttle2.get(obj, wait_on(op3), 1, 0);
+    EXPECT_TRUE(c3.empty());
+    EXPECT_EQ(3u, budget.get_used());
+  }
+  EXPECT_EQ(2u, throttle1.drain().size());
+  EXPECT_EQ(1u, throttle2.drain().size());
+  EXPECT_EQ(0u, budget.get_used());
+}
+
 TEST(Aio_Throttle, ThrottleOverMax)
 {
   constexpr uint64_t window = 4;
@@ -26,6 +26,8 @@
 #include "gtest/gtest.h"
 
 #include "include/denc.h"
+#include "include/object.h"
+#include "include/utime.h"
 
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
@@ -181,6 +183,57 @@ TEST(denc, simple)
   test_denc((int64_t)-11);
 }
 
+TEST(denc, varint)
+{
+  std::vector<uint64_t> values = {0, 1, 0x7f, 0x80, 0x3fff, 0x4000};
+  for (int bits = 8; bits <= 64; ++bits) {
+    uint64_t top = bits == 64 ? ~0ull : (1ull << bits) - 1;
+    values.push_back(top);
+    values.push_back(top >> 1);
+    values.push_back((top >> 1) + 1);
+    values.push_back(top & 0x5555555555555555ull);
+  }
+  // exercise both the word-at-a-time and the byte-wise decoder by varying
+  // how much buffer follows the encoded value
+  for (auto v : values) {
+    for (unsigned pad = 0; pad < 10; ++pad) {
+      bufferlist bl;
+      {
+	auto a = bl.get_contiguous_appender(16 + pad);
+	denc_varint(v, a);
+	denc_varint_lowz(v, a);
+	for (unsigned i = 0; i < pad; ++i) {
+	  get_pos_add<uint8_t>(a) = 0xff;
+	}
+      }
+      bl.rebuild();
+      auto p = bl.front().begin();
+      uint64_t d = 0, dz = 0;
+      denc_varint(d, p);
+      denc_varint_lowz(dz, p);
+      ASSERT_EQ(v, d) << "pad " << pad;
+      ASSERT_EQ(v, dz) << "pad " << pad;
+      ASSERT_EQ(pad, bl.length() - p.get_offset());
+    }
+  }
+  // narrower destination types
+  bufferlist bl;
+  {
+    auto a = bl.get_contiguous_appender(32);
+    denc_varint((uint32_t)0xdeadbeef, a);
+    denc_varint((uint16_t)0xbeef, a);
+    denc_varint((uint64_t)0, a);
+  }
+  bl.rebuild();
+  auto p = bl.front().begin();
+  uint32_t v32;
+  uint16_t v16;
+  denc_varint(v32, p);
+  denc_varint(v16, p);
+  ASSERT_EQ(0xdeadbeefu, v32);
+  ASSERT_EQ(0xbeefu, v16);
+}
+
 TEST(denc, string)
 {
   string a, b("hi"), c("multi\nline\n");
@@ -276,6 +329,101 @@ TEST(denc, vector)
   }
 }
 
+struct flat_t {
+  ceph_le32 a;
+  ceph_le16 b;
+  uint8_t c = 0;
+  uint8_t d = 0;
+  DENC(flat_t, v, p) {
+    denc(v.a, p);
+    denc(v.b, p);
+    denc(v.c, p);
+    denc(v.d, p);
+  }
+  bool operator==(const flat_t& o) const {
+    return a == o.a && b == o.b && c == o.c && d == o.d;
+  }
+};
+WRITE_CLASS_DENC_FLAT(flat_t)
+
+TEST(denc, flat_vector)
+{
+  static_assert(denc_flat<ceph_le64>);
+  static_assert(denc_flat<uint8_t>);
+  static_assert(!denc_flat<bool>);
+  static_assert(!denc_flat<std::string>);
+  if constexpr (std::endian::native == std::endian::little) {
+    static_assert(denc_flat<uint32_t>);
+    static_assert(denc_flat<flat_t>);
+  }
+
+  vector<flat_t> v(1000);
+  for (unsigned i = 0; i < v.size(); ++i) {
+    v[i].a = i * 1000003;
+    v[i].b = i;
+    v[i].c = i % 7;
+    v[i].d = i % 13;
+  }
+  bufferlist bl;
+  encode(v, bl);
+
+  // same bytes as encoding the elements one at a time
+  bufferlist expected;
+  encode((uint32_t)v.size(), expected);
+  for (auto& e : v) {
+    encode(e, expected);
+  }
+  ASSERT_EQ(expected, bl);
+
+  vector<flat_t> out;
+  decode(out, bl);
+  ASSERT_EQ(v, out);
+
+  // truncated
+  bufferlist cut;
+  cut.substr_of(bl, 0, bl.length() - 1);
+  auto p = cut.cbegin();
+  ASSERT_THROW(decode(out, p), buffer::end_of_buffer);
+
+  // a count larger than the data must not be trusted for resizing
+  bufferlist bogus;
+  encode((uint32_t)0xffffffff, bogus);
+  encode((uint32_t)1, bogus);
+  vector<uint32_t> ints;
+  p = bogus.cbegin();
+  ASSERT_THROW(decode(ints, p), buffer::end_of_buffer);
+}
+
+TEST(denc, flat_vector_segmented)
+{
+  vector<uint64_t> v(5000);
+  std::iota(v.begin(), v.end(), 1);
+  bufferlist bl;
+  encode(v, bl);
+
+  // split into many small segments so the non-contiguous decode is used
+  bufferlist fragmented;
+  for (unsigned off = 0; off < bl.length(); off += 100) {
+    bufferlist piece;
+    piece.substr_of(bl, off, std::min(100u, bl.length() - off));
+    fragmented.append(buffer::copy(piece.c_str(), piece.length()));
+  }
+  ASSERT_GT(fragmented.get_num_buffers(), 1u);
+  vector<uint64_t> out;
+  auto p = fragmented.cbegin();
+  decode(out, p);
+  ASSERT_EQ(v, out);
+  ASSERT_TRUE(p.end());
+
+  vector<utime_t> times;
+  for (unsigned i = 0; i < 100; ++i) {
+    times.emplace_back(i, i * 1000);
+  }
+  test_denc(times);
+  vector<snapid_t> snaps(v.begin(), v.begin() + 100);
+  test_denc(snaps);
+}
+
 template<typename T>
 using default_list = std::list<T>;
 
@@ -16,6 +16,8 @@
 
 #include <errno.h>
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <iomanip>
 
@@ -62,6 +64,7 @@ void usage(ostream &out)
   out << "  count_tests         print number of generated test objects (to stdout)\n";
   out << "  select_test <n>     select generated test object as in-memory object\n";
   out << "  is_deterministic    exit w/ success if type encodes deterministically\n";
+  out << "  bench <n>           time <n> encodes and decodes of in-memory object\n";
 }
 
 vector<DencoderPlugin> load_plugins()
@@ -205,6 +208,42 @@ int main(int argc, const char **argv)
       jf.flush(cout);
       cout << std::endl;
 
+    } else if (*i == string("bench")) {
+      ++i;
+      if (i == args.end()) {
+	cerr << "expecting iteration count" << std::endl;
+	return 1;
+      }
+      if (!den) {
+	cerr << "must first select type with 'type <name>'" << std::endl;
+	return 1;
+      }
+      const int n = std::max(1, atoi(*i));
+      bufferlist bl;
+      auto start = std::chrono::steady_clock::now();
+      for (int k = 0; k < n; ++k) {
+	bl.clear();
+	den->encode(bl, features | CEPH_FEATURE_RESERVED);
+      }
+      std::chrono::duration<double> enc = std::chrono::steady_clock::now() - start;
+      start = std::chrono::steady_clock::now();
+      for (int k = 0; k < n; ++k) {
+	err = den->decode(bl, 0);
+	if (err.length()) {
+	  break;
+	}
+      }
+      std::chrono::duration<double> dec = std::chrono::steady_clock::now() - start;
+      if (err.length()) {
+	cerr << "error: " << err << std::endl;
+	return 1;
+      }
+      const double bytes = (double)bl.length() * n;
+      cout << bl.length() << " bytes"
+	   << " encode " << enc.count() * 1e9 / n << " ns "
+	   << bytes / enc.count() / MB(1) << " MB/s"
+	   << " decode " << dec.count() * 1e9 / n << " ns "
+	   << bytes / dec.count() / MB(1) << " MB/s" << std::endl;
     } else if (*i == string("hexdump")) {
       encbl.hexdump(cout);
     } else if (*i == string("get_struct_v")) {
@@ -476,6 +476,9 @@ MESSAGE(MOSDPGLog)
 #include "messages/MOSDPGNotify.h"
 MESSAGE(MOSDPGNotify)
 
+#include "messages/MOSDPGPeeringBatch.h"
+MESSAGE(MOSDPGPeeringBatch)
+
 #include "messages/MOSDPGQuery.h"
 MESSAGE(MOSDPGQuery)
 
@@ -587,6 +590,9 @@ MESSAGE(MOSDRepOp)
 #include "messages/MOSDRepOpReply.h"
 MESSAGE(MOSDRepOpReply)
 
+#include "messages/MOSDRepOpBatch.h"
+MESSAGE(MOSDRepOpBatch)
+
 #include "messages/MRecoveryReserve.h"
 MESSAGE(MRecoveryReserve)
 
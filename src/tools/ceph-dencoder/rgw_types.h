@@ -64,6 +64,7 @@ TYPE(rgw_zone_set)
 TYPE(cls_rgw_lc_get_entry_ret)
 TYPE(rgw_cls_obj_prepare_op)
 TYPE(rgw_cls_obj_complete_op)
+TYPE(rgw_cls_obj_complete_batch_op)
 TYPE(rgw_cls_list_op)
 TYPE(rgw_cls_list_ret)
 TYPE(cls_rgw_gc_defer_entry_op)
@@ -100,6 +101,7 @@ TYPE(rgw_cls_bi_list_op)
 TYPE(rgw_cls_bi_list_ret)
 TYPE(rgw_cls_bi_put_op)
 TYPE(rgw_cls_bi_put_entries_op)
+TYPE(rgw_cls_reshard_log_trim_entries_op)
 TYPE(rgw_cls_obj_check_attrs_prefix)
 TYPE(rgw_cls_obj_remove_op)
 TYPE(rgw_cls_obj_store_pg_ver_op)
@@ -892,54 +892,70 @@ int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj
   if (ret < 0)
     return ret;
 
-  uint64_t offset = 0;
+  // only the allocated extents of sparse objects are exported. the last
+  // byte is always exported so that import restores the object size
+  map<uint64_t, uint64_t> extents;
+  if (total > 0) {
+    ret = store->fiemap(ch, obj, 0, total, extents);
+    if (ret < 0) {
+      extents.clear();
+      extents[0] = total;
+    }
+    if (extents.empty() ||
+        extents.rbegin()->first + extents.rbegin()->second < total) {
+      extents[total - 1] = 1;
+    }
+  }
+
   bufferlist rawdatabl;
-  while(total > 0) {
-    rawdatabl.clear();
-    mysize_t len = max_read;
-    if (len > total)
-      len = total;
+  for (auto [offset, ext_len] : extents) {
+    while(ext_len > 0) {
+      rawdatabl.clear();
+      mysize_t len = max_read;
+      if (len > ext_len)
+        len = ext_len;
 
-    ret = store->read(ch, obj, offset, len, rawdatabl);
+      ret = store->read(ch, obj, offset, len, rawdatabl);
 
-    ret = ret == 0 ? -EINVAL : ret;
-    if (ret < 0) {
-      if (!force) {
-        cerr << "read failure: " << cpp_strerror(ret)
-             << " at obj:" << obj
-             << std::hex << ", read 0x" << offset << "~" << len << std::dec
-             << std::endl;
-        return ret;
-      }
-      // re-read using minimal disk block to minimize error footprint.
-      auto o = offset;
-      const size_t block_size = 4096;
-      while(o < offset + len) {
-        bufferlist bl;
-        int r = store->read(ch, obj, o, block_size, bl);
-        if (r <= 0) {
-          rawdatabl.append_zero(block_size);
-          cerr << "read failure: " << cpp_strerror(r == 0 ? -EINVAL : r)
-               << " at obj:" << obj << std::hex
-               << ", read 0x" << o << "~" << block_size
-               << std::dec << std::endl;
-        } else {
-          rawdatabl.claim_append(bl);
+      ret = ret == 0 ? -EINVAL : ret;
+      if (ret < 0) {
+        if (!force) {
+          cerr << "read failure: " << cpp_strerror(ret)
+               << " at obj:" << obj
+               << std::hex << ", read 0x" << offset << "~" << len << std::dec
+               << std::endl;
+          return ret;
         }
-        o += block_size;
+        // re-read using minimal disk block to minimize error footprint.
+        auto o = offset;
+        const size_t block_size = 4096;
+        while(o < offset + len) {
+          bufferlist bl;
+          int r = store->read(ch, obj, o, block_size, bl);
+          if (r <= 0) {
+            rawdatabl.append_zero(block_size);
+            cerr << "read failure: " << cpp_strerror(r == 0 ? -EINVAL : r)
+                 << " at obj:" << obj << std::hex
+                 << ", read 0x" << o << "~" << block_size
+                 << std::dec << std::endl;
+          } else {
+            rawdatabl.claim_append(bl);
+          }
+          o += block_size;
+        }
+        ret = len;
       }
-      ret = len;
-    }
 
-    data_section dblock(offset, len, rawdatabl);
-    if (debug)
-      cerr << "data section offset=" << offset << " len=" << len << std::endl;
+      data_section dblock(offset, len, rawdatabl);
+      if (debug)
+        cerr << "data section offset=" << offset << " len=" << len << std::endl;
 
-    total -= ret;
-    offset += ret;
+      ext_len -= ret;
+      offset += ret;
 
-    ret = write_section(TYPE_DATA, dblock, file_fd);
-    if (ret) return ret;
+      ret = write_section(TYPE_DATA, dblock, file_fd);
+      if (ret) return ret;
+    }
   }
 
   //Handle attrs for this object
@@ -1749,6 +1749,78 @@ void PeerReplayer::RemoteSync::finish_sync() {
   }
 }
 
+PeerReplayer::FileSyncQueue::FileSyncQueue(uint64_t max_files, uint64_t max_bytes)
+  : m_max_files(max_files),
+    m_max_bytes(max_bytes) {
+}
+
+PeerReplayer::FileSyncQueue::~FileSyncQueue() {
+  {
+    std::scoped_lock locker(m_lock);
+    m_stopping = true;
+    m_cond.notify_all();
+  }
+  for (auto &t : m_threads) {
+    t.join();
+  }
+}
+
+int PeerReplayer::FileSyncQueue::queue(uint64_t bytes, std::function<int ()> &&op) {
+  if (m_max_files <= 1) {
+    return op();
+  }
+
+  std::unique_lock locker(m_lock);
+  // a file larger than the byte window goes alone
+  m_cond.wait(locker, [this, bytes] {
+    return m_r < 0 || m_inflight_files == 0 ||
+      (m_inflight_files < m_max_files && m_inflight_bytes + bytes <= m_max_bytes);
+  });
+  if (m_r < 0) {
+    return m_r;
+  }
+
+  ++m_inflight_files;
+  m_inflight_bytes += bytes;
+  m_ops.emplace_back(bytes, std::move(op));
+  if (m_threads.size() < m_inflight_files) {
+    m_threads.push_back(make_named_thread("mirror_filesync",
+                                          &FileSyncQueue::run, this));
+  }
+  m_cond.notify_all();
+  return 0;
+}
+
+int PeerReplayer::FileSyncQueue::wait() {
+  std::unique_lock locker(m_lock);
+  m_cond.wait(locker, [this] { return m_inflight_files == 0; });
+  return m_r;
+}
+
+void PeerReplayer::FileSyncQueue::run() {
+  std::unique_lock locker(m_lock);
+  while (true) {
+    m_cond.wait(locker, [this] { return m_stopping || !m_ops.empty(); });
+    if (m_ops.empty()) {
+      break;
+    }
+
+    auto [bytes, op] = std::move(m_ops.front());
+    m_ops.pop_front();
+    if (m_r == 0) {
+      locker.unlock();
+      int r = op();
+      locker.lock();
+      if (r < 0 && m_r == 0) {
+        m_r = r;
+      }
+    }
+    --m_inflight_files;
+    m_inflight_bytes -= bytes;
+    m_cond.notify_all();
+  }
+}
+
 int PeerReplayer::do_synchronize(const std::string &dir_root, const Snapshot &current,
                                  boost::optional<Snapshot> prev) {
   dout(20) << ": dir_root=" << dir_root << ", current=" << current << dendl;
@@ -1790,6 +1862,12 @@ int PeerReplayer::do_synchronize(const std::string &dir_root, const Snapshot &cu
     return r;
   }
 
+  // directories are created as the tree is traversed, files are
+  // synchronized in parallel behind it.
+  FileSyncQueue file_syncs(
+    g_ceph_context->_conf.get_val<uint64_t>("cephfs_mirror_max_concurrent_file_syncs"),
+    g_ceph_context->_conf.get_val<Option::size_t>("cephfs_mirror_max_inflight_sync_bytes"));
+
   // starting from this point we shouldn't care about manual closing of fh.c_fd,
   // it will be closed automatically when bound tdirp is closed.
   while (true) {
@@ -1825,28 +1903,41 @@ int PeerReplayer::do_synchronize(const std::string &dir_root, const Snapshot &cu
         break;
       }
     } else {
-      bool need_data_sync = true;
-      bool need_attr_sync = true;
-      if (sync_check) {
-        r = should_sync_entry(epath, stx, fh,
-                              &need_data_sync, &need_attr_sync);
-        if (r < 0) {
-          break;
+      uint64_t bytes = S_ISREG(stx.stx_mode) ? stx.stx_size : 0;
+      r = file_syncs.queue(bytes, [this, syncm, &dir_root, &fh, epath, stx, sync_check]() {
+        bool need_data_sync = true;
+        bool need_attr_sync = true;
+        if (sync_check) {
+          int r = should_sync_entry(epath, stx, fh,
+                                    &need_data_sync, &need_attr_sync);
+          if (r < 0) {
+            return r;
+          }
         }
-      }
 
-      dout(5) << ": entry=" << epath << ", data_sync=" << need_data_sync
-              << ", attr_sync=" << need_attr_sync << dendl;
-      if (need_data_sync || need_attr_sync) {
-        r = remote_file_op(syncm, dir_root, epath, stx, sync_check, fh, need_data_sync, need_attr_sync);
-        if (r < 0) {
-          break;
+        dout(5) << ": entry=" << epath << ", data_sync=" << need_data_sync
+                << ", attr_sync=" << need_attr_sync << dendl;
+        if (need_data_sync || need_attr_sync) {
+          int r = remote_file_op(syncm, dir_root, epath, stx, sync_check, fh,
+                                 need_data_sync, need_attr_sync);
+          if (r < 0) {
+            return r;
+          }
         }
+        dout(10) << ": done for epath=" << epath << dendl;
+        return 0;
+      });
+      if (r < 0) {
+        break;
       }
-      dout(10) << ": done for epath=" << epath << dendl;
     }
   }
 
+  int wr = file_syncs.wait();
+  if (r >= 0 && wr < 0) {
+    r = wr;
+  }
+
   syncm->finish_sync();
   delete syncm;
 
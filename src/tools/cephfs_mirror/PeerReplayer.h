@@ -10,7 +10,9 @@
 #include "ServiceDaemon.h"
 #include "Types.h"
 
+#include <deque>
 #include <stack>
+#include <thread>
 #include <boost/optional.hpp>
 
 namespace cephfs {
@@ -235,6 +237,37 @@ private:
     std::map<std::string, std::set<std::string>> m_deleted;
   };
 
+  // synchronizes the files of a snapshot on a pool of threads while the
+  // tree is traversed, keeping at most max_files files and max_bytes bytes
+  // in flight. with max_files of 1, files are synchronized in queue().
+  class FileSyncQueue {
+  public:
+    FileSyncQueue(uint64_t max_files, uint64_t max_bytes);
+    ~FileSyncQueue();
+
+    // waits for room in the window and queues op. returns the error of
+    // a failed op, after which nothing more is run.
+    int queue(uint64_t bytes, std::function<int ()> &&op);
+
+    // waits for the queued ops and returns the first error
+    int wait();
+
+  private:
+    void run();
+
+    const uint64_t m_max_files;
+    const uint64_t m_max_bytes;
+
+    ceph::mutex m_lock = ceph::make_mutex("cephfs::mirror::PeerReplayer::FileSyncQueue");
+    ceph::condition_variable m_cond;
+    std::deque<std::pair<uint64_t, std::function<int ()>>> m_ops;
+    uint64_t m_inflight_files = 0; // queued or running
+    uint64_t m_inflight_bytes = 0;
+    int m_r = 0;
+    bool m_stopping = false;
+    std::vector<std::thread> m_threads;
+  };
+
   // stats sent to service daemon
   struct ServiceDaemonStats {
     uint64_t failed_dir_count = 0;
@@ -88,7 +88,9 @@ ObjectCacheStore::ObjectCacheStore(CephContext *cct)
     cache_watermark = 0.9;
   }
   m_policy = new SimplePolicy(m_cct, cache_max_size, max_inflight_ops,
-                              cache_watermark);
+                              cache_watermark,
+                              m_cct->_conf.get_val<bool>(
+                                "immutable_object_cache_admission_filter"));
 }
 
 ObjectCacheStore::~ObjectCacheStore() {
@@ -15,14 +15,23 @@
 namespace ceph {
 namespace immutable_obj_cache {
 
+// objects of the default rbd object size that fit in the cache, which sizes
+// the frequency sketch
+static uint64_t sketch_entries(uint64_t cache_size) {
+  return cache_size >> 22;
+}
+
 SimplePolicy::SimplePolicy(CephContext *cct, uint64_t cache_size,
-                           uint64_t max_inflight, double watermark)
-  : cct(cct), m_watermark(watermark), m_max_inflight_ops(max_inflight),
-    m_max_cache_size(cache_size) {
+                           uint64_t max_inflight, double watermark,
+                           bool admission_filter)
+  : cct(cct), m_watermark(watermark), m_admission_filter(admission_filter),
+    m_max_inflight_ops(max_inflight), m_max_cache_size(cache_size),
+    m_sketch(sketch_entries(cache_size)) {
 
   ldout(cct, 20) << "max cache size= " << m_max_cache_size
                  << " ,watermark= " << m_watermark
-                 << " ,max inflight ops= " << m_max_inflight_ops << dendl;
+                 << " ,max inflight ops= " << m_max_inflight_ops
+                 << " ,admission filter= " << m_admission_filter << dendl;
 
   m_cache_size = 0;
 
@@ -48,6 +57,22 @@ cache_status_t SimplePolicy::alloc_entry(std::string file_name) {
     return OBJ_CACHE_SKIP;
   }
 
+  // once objects are being evicted, only promote an object that was looked
+  // up more often lately than the next one to evict, so that objects read
+  // once don't push out the ones that all clones read
+  if (m_admission_filter &&
+      (double)m_cache_size > m_max_cache_size * m_watermark) {
+    Entry* victim =
+      reinterpret_cast<Entry*>(m_promoted_lru.lru_get_next_expire());
+    if (victim != nullptr) {
+      std::lock_guard locker{m_sketch_lock};
+      if (m_sketch.estimate(file_name) <= m_sketch.estimate(victim->file_name)) {
+        ldout(cct, 20) << "not admitting: " << file_name << dendl;
+        return OBJ_CACHE_SKIP;
+      }
+    }
+  }
+
   if ((m_cache_size < m_max_cache_size) &&
       (inflight_ops < m_max_inflight_ops)) {
     Entry* entry = new Entry();
@@ -65,6 +90,11 @@ cache_status_t SimplePolicy::alloc_entry(std::string file_name) {
 cache_status_t SimplePolicy::lookup_object(std::string file_name) {
   ldout(cct, 20) << "lookup: " << file_name << dendl;
 
+  if (m_admission_filter) {
+    std::lock_guard locker{m_sketch_lock};
+    m_sketch.increment(file_name);
+  }
+
   std::shared_lock rlocker{m_cache_map_lock};
 
   auto entry_it = m_cache_map.find(file_name);
@@ -6,6 +6,7 @@
 
 #include "common/ceph_context.h"
 #include "common/ceph_mutex.h"
+#include "common/FrequencySketch.h"
 #include "include/lru.h"
 #include "Policy.h"
 
@@ -18,7 +19,7 @@ namespace immutable_obj_cache {
 class SimplePolicy : public Policy {
  public:
   SimplePolicy(CephContext *cct, uint64_t block_num, uint64_t max_inflight,
-               double watermark);
+               double watermark, bool admission_filter = false);
   ~SimplePolicy();
 
   cache_status_t lookup_object(std::string file_name);
@@ -50,6 +51,7 @@ class SimplePolicy : public Policy {
 
   CephContext* cct;
   double m_watermark;
+  bool m_admission_filter;
   uint64_t m_max_inflight_ops;
   uint64_t m_max_cache_size;
   std::atomic<uint64_t> inflight_ops = 0;
@@ -61,6 +63,11 @@ class SimplePolicy : public Policy {
   std::atomic<uint64_t> m_cache_size;
 
   LRU m_promoted_lru;
+
+  // approximate count of recent lookups of each object
+  ceph::FrequencySketch m_sketch;
+  ceph::mutex m_sketch_lock =
+    ceph::make_mutex("rbd::cache::SimplePolicy::m_sketch_lock");
 };
 
 }  // namespace immutable_obj_cache
@@ -26,6 +26,7 @@
 #include "mon/health_check.h"
 #include <time.h>
 #include <algorithm>
+#include <thread>
 #include <unordered_map>
 
 #include "global/global_init.h"
@@ -69,6 +70,8 @@ void usage()
   cout << "   --upmap-active          Act like an active balancer, keep applying changes until balanced" << std::endl;
   cout << "   --dump <format>         displays the map in plain text when <format> is 'plain', 'json' if specified format is not supported" << std::endl;
   cout << "   --tree                  displays a tree of the map" << std::endl;
+  cout << "   --test-map-pgs-threads <n>" << std::endl;
+  cout << "                           map pgs of --test-map-pgs[-dump] on <n> threads [default: 1]" << std::endl;
   cout << "   --test-crush [--range-first <first> --range-last <last>] map pgs to acting osds" << std::endl;
   cout << "   --adjust-crush-weight <osdid:weight>[,<osdid:weight>,<...>] change <osdid> CRUSH <weight> (but do not persist)" << std::endl;
   cout << "   --save                  write modified osdmap with upmap or crush-adjust changes" << std::endl;
@@ -185,6 +188,7 @@ int main(int argc, const char **argv)
 
   int64_t pg_num = -1;
   bool test_map_pgs_dump_all = false;
+  int test_map_pgs_threads = 1;
   bool save = false;
   bool vstart = false;
   bool osd_size_aware = false;
@@ -255,6 +259,15 @@ int main(int argc, const char **argv)
       test_map_pgs_dump = true;
     } else if (ceph_argparse_flag(args, i, "--test-map-pgs-dump-all", (char*)NULL)) {
       test_map_pgs_dump_all = true;
+    } else if (ceph_argparse_witharg(args, i, &test_map_pgs_threads, err, "--test-map-pgs-threads", (char*)NULL)) {
+      if (!err.str().empty()) {
+        cerr << err.str() << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      if (test_map_pgs_threads < 1) {
+        cerr << "--test-map-pgs-threads must be at least 1" << std::endl;
+        exit(EXIT_FAILURE);
+      }
     } else if (ceph_argparse_flag(args, i, "--test-random", (char*)NULL)) {
       test_random = true;
     } else if (ceph_argparse_flag(args, i, "--clobber", (char*)NULL)) {
@@ -782,6 +795,28 @@ skip_upmap:
       
       cout << "pool " << p->first
 	   << " pg_num " << p->second.get_pg_num() << std::endl;
+
+      // the mappings of large pools are computed up front on several
+      // threads; CRUSH mapping of a const map is thread-safe
+      vector<pair<vector<int>, int>> mapped;
+      const bool parallel = test_map_pgs_threads > 1 && !test_random &&
+	!test_map_pgs_dump_all;
+      if (parallel) {
+	mapped.resize(p->second.get_pg_num());
+	vector<std::thread> threads;
+	for (int t = 0; t < test_map_pgs_threads; ++t) {
+	  threads.emplace_back([&, t] {
+	    for (unsigned i = t; i < mapped.size(); i += test_map_pgs_threads) {
+	      osdmap.pg_to_acting_osds(pg_t(i, p->first),
+				       &mapped[i].first, &mapped[i].second);
+	    }
+	  });
+	}
+	for (auto& t : threads) {
+	  t.join();
+	}
+      }
+
       for (unsigned i = 0; i < p->second.get_pg_num(); ++i) {
 	pg_t pgid = pg_t(i, p->first);
 
@@ -799,6 +834,9 @@ skip_upmap:
                                       &acting, &acting_primary);
 	  osds = acting;
 	  primary = acting_primary;
+        } else if (parallel) {
+	  osds = std::move(mapped[i].first);
+	  primary = mapped[i].second;
         } else {
 	  osdmap.pg_to_acting_osds(pgid, &osds, &primary);
 	}
@@ -238,6 +238,8 @@ void usage(ostream& out)
 "   --all\n"
 "        Use with ls to list objects in all namespaces\n"
 "        Put in CEPH_ARGS environment variable to make this the default\n"
+"   --list-concurrency N\n"
+"        Use with ls to list N placement groups at a time; output is unordered\n"
 "   --default\n"
 "        Use with ls to list objects in default namespace\n"
 "        Takes precedence over --all in case --all is in environment\n"
@@ -410,14 +412,14 @@ int remove([[maybe_unused]] IoCtx& io_ctx, const std::string& oid, [[maybe_unuse
   return io_ctx.remove(oid);
 }
 
-std::string get_oid(librados::NObjectIterator& i, [[maybe_unused]] const bool use_striper)
+std::string get_oid(const std::string& oid, [[maybe_unused]] const bool use_striper)
 {
 #ifdef WITH_LIBRADOSSTRIPER
   if (use_striper)
-    return i->get_oid().substr(0, i->get_oid().length()-17);
+    return oid.substr(0, oid.length()-17);
 #endif
 
-  return i->get_oid();
+  return oid;
 }
 
 int stat([[maybe_unused]] IoCtx& io_ctx, const std::string& oid, uint64_t& size, time_t& mtime, [[maybe_unused]] const bool use_striper)
@@ -440,16 +442,16 @@ int stat2([[maybe_unused]] IoCtx& io_ctx, const std::string& oid, uint64_t& size
   return io_ctx.stat2(oid, &size, &mtime);
 }
 
-void dump_name(Formatter *formatter, const librados::NObjectIterator& i, [[maybe_unused]] const bool use_striper)
+void dump_name(Formatter *formatter, const std::string& oid, [[maybe_unused]] const bool use_striper)
 {
 #ifdef WITH_LIBRADOSSTRIPER
   if (use_striper) {
-     formatter->dump_string("name", i->get_oid().substr(0, i->get_oid().length()-17));
+     formatter->dump_string("name", oid.substr(0, oid.length()-17));
      return;
   }
 #endif
 
-  formatter->dump_string("name", i->get_oid());
+  formatter->dump_string("name", oid);
 }
 
 } // namespace detail
@@ -1927,6 +1929,7 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
   unsigned op_size = default_op_size;
   unsigned object_size = 0;
   unsigned max_objects = 0;
+  unsigned list_concurrency = 1;
   uint64_t obj_offset = 0;
   bool obj_offset_specified = false;
   bool block_size_specified = false;
@@ -2034,6 +2037,12 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
       return -EINVAL;
     }
   }
+  i = opts.find("list-concurrency");
+  if (i != opts.end()) {
+    if (rados_sistrtoll(i, &list_concurrency)) {
+      return -EINVAL;
+    }
+  }
   i = opts.find("offset");
   if (i != opts.end()) {
     if (rados_sistrtoll(i, &obj_offset)) {
@@ -2517,22 +2526,68 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
       if (formatter) {
         formatter->open_array_section("objects");
       }
-      try {
-	librados::NObjectIterator i = pgid ? io_ctx.nobjects_begin(pgid->ps()) : io_ctx.nobjects_begin();
-	const librados::NObjectIterator i_end = io_ctx.nobjects_end();
-	for (; i != i_end; ++i) {
+      auto print_object = [&](const std::string& nspace,
+			      const std::string& oid,
+			      const std::string& locator) {
 #ifdef WITH_LIBRADOSSTRIPER
-	  if (use_striper) {
-	    // in case of --striper option, we only list striped
-	    // objects, so we only display the first object of
-	    // each, without its suffix '.000...000'
-	    size_t l = i->get_oid().length();
-	    if (l <= 17 ||
-		(0 != i->get_oid().compare(l-17, 17,".0000000000000000"))) {
-	      continue;
-	    }
+	if (use_striper) {
+	  // in case of --striper option, we only list striped
+	  // objects, so we only display the first object of
+	  // each, without its suffix '.000...000'
+	  size_t l = oid.length();
+	  if (l <= 17 ||
+	      (0 != oid.compare(l-17, 17,".0000000000000000"))) {
+	    return;
 	  }
+	}
 #endif // WITH_LIBRADOSSTRIPER
+	if (!formatter) {
+	  // Only include namespace in output when wildcard specified
+	  if (wildcard) {
+	    *outstream << nspace << "\t";
+	  }
+	  *outstream << detail::get_oid(oid, use_striper);
+	  if (locator.size()) {
+	    *outstream << "\t" << locator;
+	  }
+	  *outstream << std::endl;
+	} else {
+	  formatter->open_object_section("object");
+	  formatter->dump_string("namespace", nspace);
+
+	  detail::dump_name(formatter.get(), oid, use_striper);
+
+	  if (locator.size()) {
+	    formatter->dump_string("locator", locator);
+	  }
+	  formatter->close_section(); //object
+
+	  constexpr int TARGET_BYTES_PER_FLUSH = 4096;
+	  if (formatter->get_len() >= TARGET_BYTES_PER_FLUSH) {
+	    formatter->flush(*outstream);
+	  }
+	}
+      };
+      if (list_concurrency > 1 && !pgid) {
+	// unordered, several pgs at a time
+	ret = io_ctx.object_list_parallel(
+	  io_ctx.object_list_begin(), io_ctx.object_list_end(),
+	  list_concurrency * 8, list_concurrency, 1000, {}, nullptr,
+	  [&](size_t, std::vector<librados::ObjectItem>& items,
+	      const librados::ObjectCursor&) {
+	    for (auto& i : items) {
+	      print_object(i.nspace, i.oid, i.locator);
+	    }
+	    return 0;
+	  });
+	if (ret < 0) {
+	  cerr << "error listing objects: " << cpp_strerror(ret) << std::endl;
+	  return 1;
+	}
+      } else try {
+	librados::NObjectIterator i = pgid ? io_ctx.nobjects_begin(pgid->ps()) : io_ctx.nobjects_begin();
+	const librados::NObjectIterator i_end = io_ctx.nobjects_end();
+	for (; i != i_end; ++i) {
           if (pgid) {
             uint32_t ps;
             if (const auto& key = i->get_locator().size() ? i->get_locator() : i->get_oid();
@@ -2540,32 +2595,7 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
               break;
 	    }
           }
-	  if (!formatter) {
-	    // Only include namespace in output when wildcard specified
-	    if (wildcard) {
-	      *outstream << i->get_nspace() << "\t";
-	    }
-	    *outstream << detail::get_oid(i, use_striper);
-	    if (i->get_locator().size()) {
-	      *outstream << "\t" << i->get_locator();
-	    }
-	    *outstream << std::endl;
-	  } else {
-	    formatter->open_object_section("object");
-	    formatter->dump_string("namespace", i->get_nspace());
-
-	    detail::dump_name(formatter.get(), i, use_striper);
-
-	    if (i->get_locator().size()) {
-	      formatter->dump_string("locator", i->get_locator());
-	    }
-	    formatter->close_section(); //object
-
-	    constexpr int TARGET_BYTES_PER_FLUSH = 4096;
-	    if (formatter->get_len() >= TARGET_BYTES_PER_FLUSH) {
-	      formatter->flush(*outstream);
-	    }
-	  }
+	  print_object(i->get_nspace(), i->get_oid(), i->get_locator());
 	}
       }
       catch (const std::exception& e) {
@@ -4255,6 +4285,8 @@ int main(int argc, const char **argv)
       opts["block-size"] = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--object-size", (char*)nullptr)) {
       opts["object-size"] = val;
+    } else if (ceph_argparse_witharg(args, i, &val, "--list-concurrency", (char*)nullptr)) {
+      opts["list-concurrency"] = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--max-objects", (char*)nullptr)) {
       opts["max-objects"] = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--offset", (char*)nullptr)) {
@@ -49,6 +49,7 @@
 #include <iostream>
 #include <memory>
 #include <regex>
+#include <vector>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -281,7 +282,9 @@ private:
     cond.notify_all();
   }
 
-  IOContext *wait_io_finish()
+  // wait for finished requests and take all of them, so that their
+  // replies go out together
+  bool wait_io_finish(std::vector<std::unique_ptr<IOContext>> *ctxs)
   {
     std::unique_lock l{lock};
     cond.wait(l, [this] {
@@ -290,12 +293,13 @@ private:
                  });
 
     if (io_finished.empty())
-      return NULL;
-
-    IOContext *ret = io_finished.front();
-    io_finished.pop_front();
+      return false;
 
-    return ret;
+    while (!io_finished.empty()) {
+      ctxs->emplace_back(io_finished.front());
+      io_finished.pop_front();
+    }
+    return true;
   }
 
   void wait_clean()
@@ -319,6 +323,44 @@ private:
     ceph_assert(io_finished.empty());
   }
 
+  // requests are read from the socket in large chunks, so that a burst
+  // of them takes a few reads instead of one or two per request
+  static constexpr size_t READ_BUFFER_SIZE = 128 << 10;
+  std::unique_ptr<char[]> read_buf{new char[READ_BUFFER_SIZE]};
+  size_t read_buf_begin = 0;
+  size_t read_buf_end = 0;
+
+  // like safe_read_exact(), from the read buffer first
+  int read_exact(void *buf, size_t count)
+  {
+    char *p = static_cast<char *>(buf);
+    while (count > 0) {
+      if (read_buf_begin == read_buf_end) {
+        if (count >= READ_BUFFER_SIZE) {
+          return safe_read_exact(fd, p, count);
+        }
+        ssize_t r = ::read(fd, read_buf.get(), READ_BUFFER_SIZE);
+        if (r < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return -errno;
+        }
+        if (r == 0) {
+          return -EDOM;
+        }
+        read_buf_begin = 0;
+        read_buf_end = r;
+      }
+      size_t n = std::min(count, read_buf_end - read_buf_begin);
+      memcpy(p, read_buf.get() + read_buf_begin, n);
+      read_buf_begin += n;
+      p += n;
+      count -= n;
+    }
+    return 0;
+  }
+
   static void aio_callback(librbd::completion_t cb, void *arg)
   {
     librbd::RBD::AioCompletion *aio_completion =
@@ -367,29 +409,32 @@ private:
       std::unique_ptr<IOContext> ctx(new IOContext());
       ctx->server = this;
 
-      dout(20) << __func__ << ": waiting for nbd request" << dendl;
+      int r;
+      if (read_buf_begin == read_buf_end) {
+        dout(20) << __func__ << ": waiting for nbd request" << dendl;
 
-      int r = poll(poll_fds, 2, -1);
-      if (r == -1) {
-        if (errno == EINTR) {
-          continue;
+        r = poll(poll_fds, 2, -1);
+        if (r == -1) {
+          if (errno == EINTR) {
+            continue;
+          }
+          r = -errno;
+          derr << "failed to poll nbd: " << cpp_strerror(r) << dendl;
+          goto error;
         }
-        r = -errno;
-        derr << "failed to poll nbd: " << cpp_strerror(r) << dendl;
-        goto error;
-      }
 
-      if ((poll_fds[1].revents & POLLIN) != 0) {
-        dout(0) << __func__ << ": terminate received" << dendl;
-        goto signal;
-      }
+        if ((poll_fds[1].revents & POLLIN) != 0) {
+          dout(0) << __func__ << ": terminate received" << dendl;
+          goto signal;
+        }
 
-      if ((poll_fds[0].revents & POLLIN) == 0) {
-        dout(20) << __func__ << ": nothing to read" << dendl;
-        continue;
+        if ((poll_fds[0].revents & POLLIN) == 0) {
+          dout(20) << __func__ << ": nothing to read" << dendl;
+          continue;
+        }
       }
 
-      r = safe_read_exact(fd, &ctx->request, sizeof(struct nbd_request));
+      r = read_exact(&ctx->request, sizeof(struct nbd_request));
       if (r < 0) {
 	derr << "failed to read nbd request header: " << cpp_strerror(r)
 	     << dendl;
@@ -420,7 +465,7 @@ private:
           goto signal;
         case NBD_CMD_WRITE:
           bufferptr ptr(ctx->request.len);
-	  r = safe_read_exact(fd, ptr.c_str(), ctx->request.len);
+	  r = read_exact(ptr.c_str(), ctx->request.len);
           if (r < 0) {
 	    derr << *ctx << ": failed to read nbd request data: "
 		 << cpp_strerror(r) << dendl;
@@ -474,31 +519,36 @@ signal:
 
   void writer_entry()
   {
+    std::vector<std::unique_ptr<IOContext>> ctxs;
     while (true) {
       dout(20) << __func__ << ": waiting for io request" << dendl;
-      std::unique_ptr<IOContext> ctx(wait_io_finish());
-      if (!ctx) {
+      ctxs.clear();
+      if (!wait_io_finish(&ctxs)) {
 	dout(20) << __func__ << ": no io requests, terminating" << dendl;
         goto done;
       }
 
-      dout(20) << __func__ << ": got: " << *ctx << dendl;
+      // the replies of all the finished requests go out in one writev()
+      // where they fit
+      bufferlist bl;
+      for (auto &ctx : ctxs) {
+        dout(20) << __func__ << ": got: " << *ctx << dendl;
+        bl.append(reinterpret_cast<const char *>(&ctx->reply),
+                  sizeof(struct nbd_reply));
+        if (ctx->command == NBD_CMD_READ && ctx->reply.error == htonl(0)) {
+          bl.claim_append(ctx->data);
+        }
+      }
 
-      int r = safe_write(fd, &ctx->reply, sizeof(struct nbd_reply));
+      int r = bl.write_fd(fd);
       if (r < 0) {
-	derr << *ctx << ": failed to write reply header: " << cpp_strerror(r)
-	     << dendl;
+	derr << "failed to write " << ctxs.size() << " replies: "
+	     << cpp_strerror(r) << dendl;
         goto error;
       }
-      if (ctx->command == NBD_CMD_READ && ctx->reply.error == htonl(0)) {
-	r = ctx->data.write_fd(fd);
-        if (r < 0) {
-	  derr << *ctx << ": failed to write replay data: " << cpp_strerror(r)
-	       << dendl;
-          goto error;
-	}
+      for (auto &ctx : ctxs) {
+        dout(20) << *ctx << ": finish" << dendl;
       }
-      dout(20) << *ctx << ": finish" << dendl;
     }
   error:
     wait_clean();